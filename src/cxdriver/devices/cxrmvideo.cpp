@@ -216,6 +216,16 @@
 // during the relpy to LOADTARGETS.
 // 11dec2024-- Mod LoadTargets() to send new parameter RMVTGTDEF.fDotDisp, which specifies stereo dot disparity in
 // visual deg. Applicable to the target types that draw dots.
+// 16oct2026-- RMVideo v12 introduced RMV_CMD_UPDATEFRAMEC, a compact encoding of RMV_CMD_UPDATEFRAME that sends only
+// the motion vectors that changed since the previous frame, in variable-width fields. OpenEx() now accepts any RMVideo
+// version in [RMV_MINVERSION..RMV_CURRENTVERSION], and UpdateAnimation() uses the compact encoding only if the RMVideo
+// server supports it. GetVersion() returns the version reported by RMVideo rather than RMV_CURRENTVERSION.
+// 16oct2026-- DownloadMediaFile() uses the RMV_CMD_PUTFILEX sequence (RMVideo v13) when available: the transfer is
+// skipped if RMVideo already has the file's content, resumes where an interrupted transfer of the same content left
+// off, and keeps up to RMV_PUTX_WINDOW chunks of RMV_PUTX_CHUNKSZ bytes in flight instead of waiting for each 2KB
+// chunk to be acknowledged. See putFileWindowed().
+// 16oct2026-- Mod LoadTargets() to send RMVTGTDEF.iSeed for an RMV_MOVIE target, where it is the zero-based index of
+// the first frame played. An RMVideo server that predates the start frame ignores it.
 //=====================================================================================================================
 
 #include <winsock2.h>                  // we need this for all TCP/IP socket calls, including WSA extensions
@@ -279,6 +289,9 @@ CCxRMVideo::CCxRMVideo() : CDevice(BLANKDEV, 1)
    m_iState = STATE_IDLE;
    m_nTargets = 0;
 
+   m_iVersion = 0;
+   m_bCompactUpd = FALSE;
+
    m_bDisabled = FALSE;
 
    m_nDupEvents = 0;
@@ -301,12 +314,25 @@ CCxRMVideo::~CCxRMVideo()
 
 /**
  * Get the RMVideo application version number. 
- * NOTE that during startup, we verify that the version number of the RMVideo server matches the version number on the
- * Maestro side. See OpenEx().
+ * NOTE that during startup, we verify that the version number of the RMVideo server is one that the Maestro side
+ * supports, ie, in [RMV_MINVERSION..RMV_CURRENTVERSION]. See OpenEx().
  *
- * @return The current version number (strictly positive); or -1 if RMVideo is currently unavailable.
+ * @return The version number reported by RMVideo (strictly positive); or -1 if RMVideo is currently unavailable.
  */
-int RTFCNDCL CCxRMVideo::GetVersion() { return(IsOn() ? RMV_CURRENTVERSION : -1); }
+int RTFCNDCL CCxRMVideo::GetVersion() { return(IsOn() ? m_iVersion : -1); }
+
+/**
+ * Scale a component of a target motion vector by RMV_TGTVEC_F2I_F and round the result to the nearest integer, as is
+ * required to send the motion vector to RMVideo.
+ *
+ * @param f The motion vector component.
+ * @return The scaled and rounded value.
+ */
+int RTFCNDCL CCxRMVideo::ScaleTgtVecComponent(float f)
+{
+   float fTemp = f * RMV_TGTVEC_F2I_F;
+   return( int( (fTemp>0.0f) ? floor(fTemp+0.5f) : ceil(fTemp-0.5f) ) );
+}
 
 /** 
  * Get RMVideo monitor frame period in seconds, with nanosecond precision. This is the frame period as measured over a 
@@ -918,6 +944,8 @@ BOOL RTFCNDCL CCxRMVideo::LoadTargets()
          case RMV_MOVIE:
             m_commandBuf[iCmdIdx++] = RMV_TGTDEF_FLAGS;
             m_commandBuf[iCmdIdx++] = pTgt->iFlags;
+            m_commandBuf[iCmdIdx++] = RMV_TGTDEF_SEED;           // for a movie, the index of the first frame played
+            m_commandBuf[iCmdIdx++] = pTgt->iSeed;
             
             m_commandBuf[iCmdIdx++] = RMV_TGTDEF_FOLDER;
             ::memset(&(m_commandBuf[iCmdIdx]), 0, 32);
@@ -1071,6 +1099,9 @@ BOOL RTFCNDCL CCxRMVideo::StartAnimation(RMVTGTVEC* pVecsFrame0, RMVTGTVEC* pVec
       m_commandBuf[iCmdIdx++] = int( (fTemp>0.0f) ? floor(fTemp+0.5f) : ceil(fTemp-0.5f) );
       fTemp = pVecsFrame1[i].vPat * RMV_TGTVEC_F2I_F;
       m_commandBuf[iCmdIdx++] = int( (fTemp>0.0f) ? floor(fTemp+0.5f) : ceil(fTemp-0.5f) );
+
+      // remember the frame 1 vectors: the first RMV_CMD_UPDATEFRAMEC only sends the ones that change from frame 1
+      for(int j=0; j<4; j++) m_lastTgtVec[i][j] = m_commandBuf[iCmdIdx-4+j];
    }
 
    // now send the prepared command to RMVideo without waiting for a reply.  If we cannot send the command (comm link
@@ -1180,29 +1211,35 @@ BOOL RTFCNDCL CCxRMVideo::UpdateAnimation(RMVTGTVEC* pVecs, BOOL bSync, int& fra
    // is the vertical sync spot flash to be triggered on this frame? Spot size must be non-zero.
    BOOL bEnaFlash = BOOL(bSync && (m_syncFlashSize > 0));
 
-   // prepare the RMV_CMD_UPDATEFRAME command: UPDATEFRAME, SYNC?, N, V0(0), ..., V0(N-1), where each "V" is the target
-   // index followed by the five parameters in the RMVTGTVEC structure...
-   m_commandBuf[1] = RMV_CMD_UPDATEFRAME;
-   m_commandBuf[2] = bEnaFlash ? 1 : 0;
-   m_commandBuf[3] = m_nTargets;
-   int iCmdIdx = 4;
-   for( int i=0; i<m_nTargets; i++ )
+   // if RMVideo supports it, prepare the compact RMV_CMD_UPDATEFRAMEC command. Otherwise, prepare the RMV_CMD_UPDATEFRAME
+   // command: UPDATEFRAME, SYNC?, N, V0(0), ..., V0(N-1), where each "V" is the target index followed by the five 
+   // parameters in the RMVTGTVEC structure...
+   if(m_bCompactUpd)
+      m_commandBuf[0] = PrepareCompactUpdate(pVecs, bEnaFlash);
+   else
    {
-      m_commandBuf[iCmdIdx++] = i;
-      m_commandBuf[iCmdIdx++] = (pVecs[i].bOn ) ? 1 : 0;
-      fTemp = pVecs[i].hWin * RMV_TGTVEC_F2I_F;
-      m_commandBuf[iCmdIdx++] = int( (fTemp>0.0f) ? floor(fTemp+0.5f) : ceil(fTemp-0.5f) );
-      fTemp = pVecs[i].vWin * RMV_TGTVEC_F2I_F;
-      m_commandBuf[iCmdIdx++] = int( (fTemp>0.0f) ? floor(fTemp+0.5f) : ceil(fTemp-0.5f) );
-      fTemp = pVecs[i].hPat * RMV_TGTVEC_F2I_F;
-      m_commandBuf[iCmdIdx++] = int( (fTemp>0.0f) ? floor(fTemp+0.5f) : ceil(fTemp-0.5f) );
-      fTemp = pVecs[i].vPat * RMV_TGTVEC_F2I_F;
-      m_commandBuf[iCmdIdx++] = int( (fTemp>0.0f) ? floor(fTemp+0.5f) : ceil(fTemp-0.5f) );
+      m_commandBuf[1] = RMV_CMD_UPDATEFRAME;
+      m_commandBuf[2] = bEnaFlash ? 1 : 0;
+      m_commandBuf[3] = m_nTargets;
+      int iCmdIdx = 4;
+      for( int i=0; i<m_nTargets; i++ )
+      {
+         m_commandBuf[iCmdIdx++] = i;
+         m_commandBuf[iCmdIdx++] = (pVecs[i].bOn ) ? 1 : 0;
+         fTemp = pVecs[i].hWin * RMV_TGTVEC_F2I_F;
+         m_commandBuf[iCmdIdx++] = int( (fTemp>0.0f) ? floor(fTemp+0.5f) : ceil(fTemp-0.5f) );
+         fTemp = pVecs[i].vWin * RMV_TGTVEC_F2I_F;
+         m_commandBuf[iCmdIdx++] = int( (fTemp>0.0f) ? floor(fTemp+0.5f) : ceil(fTemp-0.5f) );
+         fTemp = pVecs[i].hPat * RMV_TGTVEC_F2I_F;
+         m_commandBuf[iCmdIdx++] = int( (fTemp>0.0f) ? floor(fTemp+0.5f) : ceil(fTemp-0.5f) );
+         fTemp = pVecs[i].vPat * RMV_TGTVEC_F2I_F;
+         m_commandBuf[iCmdIdx++] = int( (fTemp>0.0f) ? floor(fTemp+0.5f) : ceil(fTemp-0.5f) );
+      }
+      m_commandBuf[0] = iCmdIdx-1;
    }
 
    // now send the prepared command to RMVideo without waiting for a reply.  Return error indication if we could not
    // send command, but don't change state.
-   m_commandBuf[0] = iCmdIdx-1;
    if(!sendRMVCommand()) { return(FALSE); }
 
    // check if there's a signal from RMVideo (without blocking). If we get an "error", "ping", or "duplicate frame" 
@@ -1246,6 +1283,77 @@ BOOL RTFCNDCL CCxRMVideo::UpdateAnimation(RMVTGTVEC* pVecs, BOOL bSync, int& fra
    return(bOk);
 }
 
+/** PrepareCompactUpdate ==============================================================================================
+Prepare the compact RMV_CMD_UPDATEFRAMEC command in the command buffer (see RMVIDEO_COMMON.H for the command format).
+
+The "on" flag of every target is packed into the on-mask. The remaining components of a target's motion vector are
+sent only if one or more of them differ from the values last sent for that target, in which case the target's bit is
+set in the changed-mask. A descriptor byte followed by the non-zero components, each in the fewest of 2, 3, or 4 bytes
+that will hold it, are then appended to the command's byte sequence. In a typical trial, most targets are either
+stationary or move at constant velocity, so the command is usually a fraction of the size of RMV_CMD_UPDATEFRAME.
+
+The components last sent for each target are updated here. They are initialized with the frame 1 motion vectors in
+StartAnimation(). NOTE that the command buffer is large enough for the worst case, in which all components of every
+target change and require 4 bytes: 1 + 17*RMV_MAXTARGETS bytes of data, versus 4*6*RMV_MAXTARGETS for UPDATEFRAME.
+
+@param pVecs [in] Target motion vectors for all loaded targets for the next display frame of the animation sequence.
+@param bEnaFlash [in] TRUE if the vertical sync spot flash should be started during the next display frame.
+@return The length of the prepared command in 32-bit integers, NOT including the length itself.
+*/
+int RTFCNDCL CCxRMVideo::PrepareCompactUpdate(RMVTGTVEC* pVecs, BOOL bEnaFlash)
+{
+   // UPDATEFRAMEC, SYNC?, N, ONMASK[M], CHGMASK[M], followed by the byte sequence
+   int nMaskWords = (m_nTargets + 31) / 32;
+   m_commandBuf[1] = RMV_CMD_UPDATEFRAMEC;
+   m_commandBuf[2] = bEnaFlash ? 1 : 0;
+   m_commandBuf[3] = m_nTargets;
+   unsigned int* pOnMask = (unsigned int*) &(m_commandBuf[4]);
+   unsigned int* pChgMask = pOnMask + nMaskWords;
+   for(int i=0; i<nMaskWords; i++) pOnMask[i] = pChgMask[i] = 0;
+
+   unsigned char* pBytes = (unsigned char*) &(m_commandBuf[4 + 2*nMaskWords]);
+   int nBytes = 0;
+   for(int i=0; i<m_nTargets; i++)
+   {
+      unsigned int bit = 1u << (i % 32);
+      if(pVecs[i].bOn) pOnMask[i/32] |= bit;
+
+      int vec[4];
+      vec[0] = ScaleTgtVecComponent(pVecs[i].hWin);
+      vec[1] = ScaleTgtVecComponent(pVecs[i].vWin);
+      vec[2] = ScaleTgtVecComponent(pVecs[i].hPat);
+      vec[3] = ScaleTgtVecComponent(pVecs[i].vPat);
+      if(vec[0] == m_lastTgtVec[i][0] && vec[1] == m_lastTgtVec[i][1] && vec[2] == m_lastTgtVec[i][2] &&
+            vec[3] == m_lastTgtVec[i][3])
+         continue;
+
+      pChgMask[i/32] |= bit;
+      int iDesc = nBytes++;
+      int desc = 0;
+      for(int j=0; j<4; j++)
+      {
+         int v = vec[j];
+         m_lastTgtVec[i][j] = v;
+
+         int w, nb;
+         if(v == 0) { w = RMV_UPDC_W_ZERO; nb = 0; }
+         else if(v >= -32768 && v <= 32767) { w = RMV_UPDC_W_16; nb = 2; }
+         else if(v >= -8388608 && v <= 8388607) { w = RMV_UPDC_W_24; nb = 3; }
+         else { w = RMV_UPDC_W_32; nb = 4; }
+         desc |= (w << (2*j));
+
+         unsigned int u = (unsigned int) v;
+         for(int b=0; b<nb; b++) pBytes[nBytes++] = (unsigned char) ((u >> (8*b)) & 0x0FF);
+      }
+      pBytes[iDesc] = (unsigned char) desc;
+   }
+
+   // pad byte sequence with zeros to a multiple of 4 bytes
+   while((nBytes % 4) != 0) pBytes[nBytes++] = 0;
+
+   return(3 + 2*nMaskWords + nBytes/4);
+}
+
 /** StopAnimation =====================================================================================================
 Stop an ongoing RMVideo target animation sequence.
 
@@ -1609,7 +1717,9 @@ BOOL RTFCNDCL CCxRMVideo::DeleteMediaFile(LPCTSTR strFolder, LPCTSTR strFile)
 
 /**
  * Download a file to the RMVideo's media store. This method will take an indefinite period of time to finish, 
- * depending on the size of the file to be downloaded. It may only be used in the idle state.
+ * depending on the size of the file to be downloaded. It may only be used in the idle state. If RMVideo supports 
+ * RMV_CMD_PUTFILEX, the transfer is skipped when RMVideo already has the file's content, and an interrupted transfer is 
+ * resumed where it left off.
  *
  * @param srcPath File system pathname for the media file to be downloaded. If this file does not exist or is not a 
  * video or image file that RMVideo can handle, the operation fails.
@@ -1644,7 +1754,8 @@ BOOL RTFCNDCL CCxRMVideo::DownloadMediaFile(LPCTSTR srcPath, LPCTSTR strFolder,
       return(FALSE);
    }
 
-   return(putFile(srcPath, strFolder, strFile));
+   return((m_iVersion >= RMV_PUTFILEXVERSION) ? putFileWindowed(srcPath, strFolder, strFile) :
+         putFile(srcPath, strFolder, strFile));
 }
 
 
@@ -1730,9 +1841,11 @@ BOOL RTFCNDCL CCxRMVideo::OpenEx(CCxMasterIO *pIO)
       return(FALSE);
    }
 
-   // if RMVideo version is not what we expect, disconnect.
-   if(ver == RMV_CURRENTVERSION)
+   // if RMVideo version is not one we support, disconnect. Older versions lack the compact frame update command.
+   if(ver >= RMV_MINVERSION && ver <= RMV_CURRENTVERSION)
    {
+      m_iVersion = ver;
+      m_bCompactUpd = BOOL(ver >= RMV_COMPACTUPDVERSION);
       ::sprintf_s(m_errMsg, "==> Verified RMVideo version: %d", ver);
       pIO->Message(m_errMsg);
    }
@@ -2249,6 +2362,243 @@ BOOL RTFCNDCL CCxRMVideo::putFile(LPCTSTR srcPath, LPCTSTR mvDir, LPCTSTR mvFile
    return(bOk);
 }
 
+//=== putFileWindowed =================================================================================================
+// Helper method handles a file download from Maestro to RMVideo using the RMV_CMD_PUTFILEX, _PUTFILECHUNK, 
+// _PUTFILEDONE command sequence (RMVideo v13 or later). The file's size and content hash are sent with PUTFILEX. If
+// RMVideo already has that content, no file data is sent at all. Otherwise, the file is sent starting at the byte
+// offset RMVideo specifies (nonzero when resuming an interrupted transfer), with up to RMV_PUTX_WINDOW chunks in
+// flight so that the transfer is not throttled by the round-trip time of the Maestro-RMVideo link.
+//
+// If RMVideo rejects a chunk, no more chunks are sent, and RMVideo discards those still in flight without reply.
+// PUTFILEDONE(0) is then sent to end the transfer; RMVideo replies with CMDERR. On a local read error, the acks for any
+// chunks in flight are collected, then PUTFILEDONE(0) is sent; RMVideo replies with CMDACK.
+//
+// @param srcPath The media file's source path on host machine.
+// @param mvDir Name of destination media folder.
+// @param mvFile Name of destination media file.
+// @return TRUE if successful, FALSE otherwise (device error message set)
+BOOL RTFCNDCL CCxRMVideo::putFileWindowed(LPCTSTR srcPath, LPCTSTR mvDir, LPCTSTR mvFile)
+{
+   // check arguments
+   char path[256];
+   BOOL bOk = (mvDir != NULL) && (mvFile != NULL) && (srcPath != NULL) && (::strlen(srcPath) < 256);
+   if(bOk)
+   {
+      size_t len = ::strlen(mvDir);
+      bOk = (len > 0) && (len <= RMV_MVF_LEN) && (len == ::strspn(mvDir, RMV_MVF_CHARS));
+   }
+   if(bOk)
+   {
+      size_t len = ::strlen(mvFile);
+      bOk = (len > 0) && (len <= RMV_MVF_LEN) && (len == ::strspn(mvFile, RMV_MVF_CHARS));
+   }
+   if(!bOk)
+   {
+      SetDeviceError("RMVideo file download failed: Bad source path, or bad media folder or file name!");
+      return(FALSE);
+   }
+   else
+      ::strcpy_s(path, srcPath);
+
+   // open the file and compute its content ID
+   HANDLE hFile = ::CreateFile(path, GENERIC_READ, 0, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+   if(hFile == INVALID_HANDLE_VALUE)
+   {
+      SetDeviceError("RMVideo file download failed: Unable to open source file!");
+      return(FALSE);
+   }
+   ULONGLONG fileSize = 0, fileHash = 0;
+   if(!computeContentHash(hFile, fileSize, fileHash))
+   {
+      ::CloseHandle(hFile);
+      SetDeviceError("RMVideo file download failed: IO error occurred while reading file on Maestro host!");
+      return(FALSE);
+   }
+
+   // send RMV_CMD_PUTFILEX to initiate file transfer. RMVideo may need to hash a file of the same size already in its 
+   // media store, so allow plenty of time for the reply.
+   int dirLen = (int) (::strlen(mvDir) + 1);
+   int fileLen = (int) (::strlen(mvFile) + 1);
+   int nBytes = dirLen + fileLen;
+   while((nBytes % 4) != 0) nBytes++;
+   m_commandBuf[0] = 5 + (nBytes/4);
+   m_commandBuf[1] = RMV_CMD_PUTFILEX;
+   m_commandBuf[2] = (int) (fileSize & 0x0FFFFFFFFULL);
+   m_commandBuf[3] = (int) (fileSize >> 32);
+   m_commandBuf[4] = (int) (fileHash & 0x0FFFFFFFFULL);
+   m_commandBuf[5] = (int) (fileHash >> 32);
+   for(int i=0; i<(nBytes/4); i++) m_commandBuf[6+i] = 0;
+   char* pStr = (char*) &(m_commandBuf[6]);
+   ::strcpy_s(pStr, dirLen, mvDir);
+   pStr += dirLen;
+   ::strcpy_s(pStr, fileLen, mvFile);
+
+   bOk = sendRMVCommand();
+   if(bOk) bOk = receiveRMVReply(30000);
+   if(!bOk)
+   {
+      // communications failure. Device error already set. Resync may be attempted.
+      ::CloseHandle(hFile);
+      return(FALSE);
+   }
+   else bOk = (m_replyBuf[0] == 4) && (m_replyBuf[1] == RMV_SIG_CMDACK) && 
+         (m_replyBuf[2] == RMV_PUTX_SEND || m_replyBuf[2] == RMV_PUTX_EXISTS || m_replyBuf[2] == RMV_PUTX_COPIED);
+
+   if(!bOk)
+   {
+      ::CloseHandle(hFile);
+      if(m_replyBuf[0] == 1 && m_replyBuf[1] == RMV_SIG_CMDERR)
+         SetDeviceError(CCxRMVideo::EMSG_CMDERROR);
+      else
+         disableOnError(CCxRMVideo::EMSG_BADREPLY);
+      return(FALSE);
+   }
+
+   // RMVideo already has the file content: we're done
+   if(m_replyBuf[2] != RMV_PUTX_SEND)
+   {
+      ::CloseHandle(hFile);
+      ClearDeviceError();
+      return(TRUE);
+   }
+
+   // seek to the byte offset at which RMVideo wants the transfer to start
+   LARGE_INTEGER liOffset {};
+   liOffset.QuadPart = (LONGLONG) ((((ULONGLONG) (unsigned int) m_replyBuf[4]) << 32) | 
+         ((ULONGLONG) (unsigned int) m_replyBuf[3]));
+   // a failure here is reported only after the transfer is ended, since every exchange with RMVideo resets the device
+   // error message
+   LPCTSTR strReadErr = "RMVideo file download failed: IO error occurred while reading file on Maestro host!";
+   LPCTSTR strErr = NULL;
+   BOOL sendCancel = (((ULONGLONG) liOffset.QuadPart) > fileSize) || 
+         !::SetFilePointerEx(hFile, liOffset, NULL, FILE_BEGIN);
+   if(sendCancel) strErr = strReadErr;
+
+   // send file contents in chunks using RMV_CMD_PUTFILECHUNK, keeping up to RMV_PUTX_WINDOW unacknowledged chunks in 
+   // flight. Acks are collected without blocking while the window is open, and we wait for one when it's full.
+   int nInFlight = 0;
+   BOOL bEOF = FALSE;
+   BOOL bChunkErr = FALSE;
+   BOOL bGotReply = FALSE;
+   char* pBytes = (char*) &(m_commandBuf[3]);
+   while(bOk && (nInFlight > 0 || !(bEOF || sendCancel || bChunkErr)))
+   {
+      bGotReply = FALSE;
+      if(nInFlight < RMV_PUTX_WINDOW && !(bEOF || sendCancel || bChunkErr))
+      {
+         // 23may2016: IMPORTANT - The Win32 ReadFile() call FAILS to behave as advertised when EOF is reached. See 
+         // putFile(). Thus, we verify that dwBytesRead is in (0,RMV_PUTX_CHUNKSZ] before sending bytes to RMVideo!
+         DWORD dwBytesRead = 0;
+         if(!::ReadFile(hFile, (LPVOID) pBytes, (DWORD) RMV_PUTX_CHUNKSZ, &dwBytesRead, NULL))
+         {
+            strErr = strReadErr;
+            sendCancel = TRUE;
+         }
+         else if(dwBytesRead <= 0 || dwBytesRead > RMV_PUTX_CHUNKSZ)
+            bEOF = TRUE;
+         else
+         {
+            m_commandBuf[1] = RMV_CMD_PUTFILECHUNK;
+            m_commandBuf[2] = (int) dwBytesRead;
+            while(dwBytesRead % 4 != 0) pBytes[dwBytesRead++] = 0;
+            m_commandBuf[0] = 2 + (dwBytesRead/4);
+            bOk = sendRMVCommand();
+            if(bOk) ++nInFlight;
+         }
+         if(bOk && nInFlight > 0) bOk = receiveRMVReply(0, bGotReply);
+      }
+      else
+      {
+         bOk = receiveRMVReply(2000, bGotReply);
+      }
+
+      if(bOk && bGotReply)
+      {
+         --nInFlight;
+         if(m_replyBuf[0] == 1 && m_replyBuf[1] == RMV_SIG_CMDERR)
+         {
+            // RMVideo silently discards any chunks that follow the one rejected, so no more replies are expected
+            strErr = CCxRMVideo::EMSG_CMDERROR;
+            bChunkErr = TRUE;
+            nInFlight = 0;
+         }
+         else if(!(m_replyBuf[0] == 1 && m_replyBuf[1] == RMV_SIG_CMDACK))
+         {
+            disableOnError(CCxRMVideo::EMSG_BADREPLY);
+            bOk = FALSE;
+         }
+      }
+   }
+
+   ::CloseHandle(hFile);
+
+   // communications failure. Device error already set. RMVideo keeps what it got so far.
+   if(!bOk) return(FALSE);
+
+   // all chunks have been acknowledged. End the transfer with RMV_CMD_PUTFILEDONE -- cancelling it if a chunk was 
+   // rejected or we could not read the file. RMVideo verifies and installs the file before replying.
+   BOOL bCancel = bChunkErr || sendCancel;
+   m_commandBuf[0] = 2;
+   m_commandBuf[1] = RMV_CMD_PUTFILEDONE;
+   m_commandBuf[2] = bCancel ? 0 : 1;
+   bOk = sendRMVCommand();
+   if(bOk) bOk = receiveRMVReply(30000);
+   if(!bOk) return(FALSE);
+   if(bCancel)
+   {
+      SetDeviceError(strErr);
+      return(FALSE);
+   }
+
+   bOk = (m_replyBuf[0] == 1) && (m_replyBuf[1] == RMV_SIG_CMDACK);
+   if(!bOk)
+   {
+      if(m_replyBuf[0] == 1 && m_replyBuf[1] == RMV_SIG_CMDERR)
+         SetDeviceError("RMVideo file download failed: File corrupted in transfer, or RMVideo could not read it!");
+      else
+         disableOnError(CCxRMVideo::EMSG_BADREPLY);
+      return(FALSE);
+   }
+
+   ClearDeviceError();
+   return(TRUE);
+}
+
+//=== computeContentHash ==============================================================================================
+// Compute the size and content hash of a file IAW the definition of RMV_CONTENTHASH in RMVIDEO_COMMON.H. The file is
+// read from start to finish, and the file pointer is left at EOF.
+//
+// @param hFile Handle to the open file.
+// @param size [out] The file size in bytes.
+// @param hash [out] The file's content hash.
+// @return TRUE if successful, FALSE if an IO error occurred while reading the file.
+BOOL RTFCNDCL CCxRMVideo::computeContentHash(HANDLE hFile, ULONGLONG& size, ULONGLONG& hash)
+{
+   // read in blocks that are a multiple of 8 bytes, so only the last word of the file may be partial
+   static unsigned char buf[65536];
+
+   ULONGLONG h = RMV_CONTENTHASH_BASIS;
+   ULONGLONG n = 0;
+   while(TRUE)
+   {
+      DWORD dwBytesRead = 0;
+      if(!::ReadFile(hFile, (LPVOID) buf, (DWORD) sizeof(buf), &dwBytesRead, NULL)) return(FALSE);
+      if(dwBytesRead <= 0 || dwBytesRead > sizeof(buf)) break;  // EOF (see putFile())
+
+      n += dwBytesRead;
+      for(DWORD i = 0; i < dwBytesRead; i += 8)
+      {
+         ULONGLONG w = 0;
+         for(DWORD j = 0; j < 8 && i + j < dwBytesRead; j++) w |= ((ULONGLONG) buf[i + j]) << (8*j);
+         h = (h ^ w) * RMV_CONTENTHASH_PRIME;
+      }
+   }
+
+   size = n;
+   hash = (h ^ n) * RMV_CONTENTHASH_PRIME;
+   return(TRUE);
+}
+
 //=== sendRMVCommand ==================================================================================================
 // Send the (already prepared) command buffer to the RMVideo server.
 // 
@@ -143,6 +143,15 @@ private:
    int m_nTargets;                                       // number of targets currently defined
    RMVTGTDEF m_TargDefs[RMV_MAXTARGETS] {};                 // target definition buffer
 
+   int m_iVersion;                                       // version of the RMVideo server (verified in OpenEx())
+   BOOL m_bCompactUpd;                                   // if set, send frame updates as RMV_CMD_UPDATEFRAMEC
+   int m_lastTgtVec[RMV_MAXTARGETS][4] {};               // last sent (hWin,vWin,hPat,vPat) for each target, scaled
+
+   // scale a motion vector component by RMV_TGTVEC_F2I_F and round to the nearest integer
+   static int RTFCNDCL ScaleTgtVecComponent(float f);
+   // prepare RMV_CMD_UPDATEFRAMEC in the command buffer (returns length of command in ints)
+   int RTFCNDCL PrepareCompactUpdate(RMVTGTVEC* pVecs, BOOL bEnaFlash);
+
    BOOL m_bDisabled;                                     // mark device as permanently disabled by prior error
 
    // duplicate frame events: Store up to 100 events. For each event, store [N,M], where N is the frame index at which
@@ -177,6 +186,10 @@ private:
 
    BOOL RTFCNDCL putFile(                                // helper method that handles file transfer sequencer for 
       LPCTSTR srcPath, LPCTSTR mvDir, LPCTSTR mvFile);   // downloading a movie file or the RMVideo executable file
+   BOOL RTFCNDCL putFileWindowed(                        // same, but windowed, resumable and deduplicating (requires
+      LPCTSTR srcPath, LPCTSTR mvDir, LPCTSTR mvFile);   // RMVideo v13)
+   static BOOL RTFCNDCL computeContentHash(              // compute size and content hash of a file, as required by 
+      HANDLE hFile, ULONGLONG& size, ULONGLONG& hash);   // RMV_CMD_PUTFILEX
 
    BOOL RTFCNDCL sendRMVCommand();                       // send command (already prepared) to RMVideo
    BOOL RTFCNDCL receiveRMVReply(int timeOut,            // receive reply from RMVideo
@@ -241,6 +241,8 @@
 // 11dec2024-- Updated to support new "stereo disparity" feature in the RMVideo dot targets RMV_POINT, RMV_RANDOMDOTS,
 //             and RMV_FLOWFIELD. A field was added to RMVTGTDEF to specify the stereo disparity in visual deg.
 //             Schema version 10, a/o Maestro 5.0.2.
+// 16oct2026-- RMV_MOVIE now uses RMVTGTDEF.iSeed as the zero-based index of the first frame played (0 = start of the
+//             file). It is now serialized for RMV_MOVIE targets. Schema version 11.
 //=====================================================================================================================
 
 
@@ -259,7 +261,7 @@ static char THIS_FILE[] = __FILE__;
 #endif
 
 
-IMPLEMENT_SERIAL( CCxTarget, CTreeObj, 10 | VERSIONABLE_SCHEMA )
+IMPLEMENT_SERIAL( CCxTarget, CTreeObj, 11 | VERSIONABLE_SCHEMA )
 
 
 //=====================================================================================================================
@@ -757,6 +759,9 @@ BOOL CCxTarget::SetParams( PU_TGPARMS pTgt, BOOL& bChanged )
          if( pRMV->fSigma[1] < 0.0f ) {pRMV->fSigma[1] = 0.0f; bOK = FALSE; }
       }
 
+      // the first frame played by a movie cannot precede the start of the file
+      if(pRMV->iType == RMV_MOVIE && pRMV->iSeed < 0) { pRMV->iSeed = 0; bOK = FALSE; }
+
       // if media folder or file name is invalid, replace it with defaults "folderName", "mediaName"
       if(pRMV->iType == RMV_MOVIE || pRMV->iType == RMV_IMAGE)
       {
@@ -825,6 +830,8 @@ BOOL CCxTarget::SetParams( PU_TGPARMS pTgt, BOOL& bChanged )
 //          CCxDoc takes care of removing these objects and any dependencies on them. Howver, any attempt to serialize an
 //          XYScope target will fail.
 //      10: Added dot disparity field to RMVTGTDEF. Effective Maestro 5.0.2.
+//      11: RMVTGTDEF.iSeed is serialized for RMV_MOVIE, where it is the index of the first frame played. For schema
+//          10 and earlier, it is set to 0, so the movie starts at the first frame as before.
 //
 //    ARGS:       ar -- [in] the serialization archive.
 //
@@ -895,6 +902,7 @@ void CCxTarget::Serialize( CArchive& ar )
                ar << str;
                str = pRMV->strFile;
                ar << str;
+               ar << pRMV->iSeed;
                break;
             case RMV_IMAGE :
                str = pRMV->strFolder;
@@ -914,7 +922,7 @@ void CCxTarget::Serialize( CArchive& ar )
    }
    else                                                                          // read from archive:
    {
-      if( nSchema < 1 || nSchema > 10 )                                           // unsupported version
+      if( nSchema < 1 || nSchema > 11 )                                           // unsupported version
          ::AfxThrowArchiveException( CArchiveException::badSchema );
 
       ASSERT( ValidTargetType( m_type ) );                                       // validate target obj type
@@ -1048,6 +1056,10 @@ void CCxTarget::Serialize( CArchive& ar )
                      if(str.GetLength() > RMV_MVF_LEN) 
                         ::AfxThrowArchiveException(CArchiveException::badSchema, "Media file name too long!");
                      ::strncpy_s(pRMV->strFile, (LPCTSTR) str, 32);
+
+                     // as of schema 11, defn includes the index of the first frame played
+                     if(nSchema >= 11) ar >> pRMV->iSeed;
+                     else pRMV->iSeed = 0;
                      break;
                   case RMV_IMAGE :
                      if(nSchema < 8) ::AfxThrowArchiveException( CArchiveException::badSchema );
@@ -1377,6 +1389,7 @@ void CCxTarget::Dump( CDumpContext& dc ) const
                   ((pRMV->iFlags & RMV_F_PAUSEWHENOFF) != 0) ? "true" : "false",
                   ((pRMV->iFlags & RMV_F_ATDISPRATE) != 0) ? "true" : "false");
                dc << str;
+               dc << "  start frame = " << pRMV->iSeed << "\n";
                break;
             case RMV_IMAGE :
                dc << "RMV_IMAGE with:\n";
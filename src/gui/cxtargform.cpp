@@ -213,6 +213,9 @@
 // 16oct2024-- As of Maestro 5.0, there is no support for XYScope targets. Only an RMVideo target can be displayed and
 // modified on this form.
 // 11dec2024-- Mods to support new "stereo disparity" parameter for RMVideo dot targets. Exposed in num edit ctrl.
+// 16oct2026-- IDC_TARGF_RANDSEED now also exposes the index of the first frame played by an RMV_MOVIE target, which is
+// stored in RMVTGTDEF.iSeed. Its label (IDC_TARGF_SEEDLBL) is changed dynamically. The start frame is reset to 0 when
+// the target type is changed to RMV_MOVIE, so a random-dot seed is never mistaken for a start frame.
 //=====================================================================================================================
 
 
@@ -449,6 +452,7 @@ void CCxTargForm::OnChange( UINT id )
          
       case IDC_TARGF_TYPE :                                          //    target type
          iValue = m_cbType.GetCurSel();
+         if(iValue == RMV_MOVIE && m_tgParms.rmv.iType != RMV_MOVIE) m_tgParms.rmv.iSeed = 0;
          m_tgParms.rmv.iType = iValue;
          bRestuff = TRUE;
          break;
@@ -605,7 +609,8 @@ void CCxTargForm::OnChange( UINT id )
          m_tgParms.rmv.fSigma[1] = fValue;
          break;
 
-      case IDC_TARGF_RANDSEED:                                       //    seed for random-dot generation
+      case IDC_TARGF_RANDSEED:                                       //    seed for random-dot generation, or
+                                                                     //    first frame played by a movie
          m_tgParms.rmv.iSeed = iValue;
          break;
 
@@ -1381,7 +1386,7 @@ VOID CCxTargForm::UpdateControls()
       GetNumEdit(IDC_TARGF_GRAT2_PH)->EnableWindow(t==RMV_PLAID);
       GetNumEdit(IDC_TARGF_XSIGMA)->EnableWindow(t==RMV_SPOT || t==RMV_RANDOMDOTS || t==RMV_GRATING || t==RMV_PLAID);
       GetNumEdit(IDC_TARGF_YSIGMA)->EnableWindow(t==RMV_SPOT || t==RMV_RANDOMDOTS || t==RMV_GRATING || t==RMV_PLAID);
-      GetNumEdit(IDC_TARGF_RANDSEED)->EnableWindow(t==RMV_RANDOMDOTS || t==RMV_FLOWFIELD);
+      GetNumEdit(IDC_TARGF_RANDSEED)->EnableWindow(t==RMV_RANDOMDOTS || t==RMV_FLOWFIELD || t==RMV_MOVIE);
       GetNumEdit(IDC_TARGF_FLICKON)->EnableWindow(TRUE);
       GetNumEdit(IDC_TARGF_FLICKOFF)->EnableWindow(TRUE);
       GetNumEdit(IDC_TARGF_FLICKDELAY)->EnableWindow(TRUE);
@@ -1413,6 +1418,11 @@ VOID CCxTargForm::UpdateControls()
       if(m_tgParms.rmv.iType==RMV_BAR)
          strLbl = _T("Drift Axis");
       SetDlgItemText( IDC_TARGF_IRLBL, strLbl );
+
+      strLbl = _T("seed");
+      if(m_tgParms.rmv.iType==RMV_MOVIE)
+         strLbl = _T("start");
+      SetDlgItemText( IDC_TARGF_SEEDLBL, strLbl );
       
       // text of this button reflects the per-dot speed noise algorithm chosen. Button disabled when not applicable.
       strLbl = _T("additive");
@@ -1892,7 +1902,7 @@ VOID CCxTargForm::Propagate(UINT cid, U_TGPARMS oldParms)
                dstParms.rmv.fSigma[1] = m_tgParms.rmv.fSigma[1];
             break;
 
-         // seed for random-dot generation
+         // seed for random-dot generation, or first frame played by a movie
          case IDC_TARGF_RANDSEED : 
             if(bModify || (dstParms.rmv.iSeed == oldParms.rmv.iSeed))
                dstParms.rmv.iSeed = m_tgParms.rmv.iSeed;
@@ -122,6 +122,7 @@
 #define IDC_RMV_SRC                     1210
 #define IDC_RMV_FOLDER                  1211
 #define IDC_RMV_FILE                    1212
+#define IDC_TARGF_SEEDLBL               1213
 #define IDC_RMV_DELFOLDER               1220
 #define IDC_RMV_DELFILE                 1221
 #define IDC_RMV_DOWNLOAD                1222
@@ -359,7 +360,7 @@
 #define _APS_3D_CONTROLS                     1
 #define _APS_NEXT_RESOURCE_VALUE        173
 #define _APS_NEXT_COMMAND_VALUE         33020
-#define _APS_NEXT_CONTROL_VALUE         1212
+#define _APS_NEXT_CONTROL_VALUE         1214
 #define _APS_NEXT_SYMED_VALUE           104
 #endif
 #endif
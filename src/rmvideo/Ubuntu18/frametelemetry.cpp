@@ -0,0 +1,230 @@
+/*=====================================================================================================================
+ frametelemetry.cpp : Helper class CFrameTelemetry, a per-frame timing record of RMVideo animation sequences.
+
+ AUTHOR:  saruffner.
+
+ BACKGROUND:
+ During an animation sequence, CRMVRenderer::animate() measures the actual elapsed time T at the start of each display
+ frame and compares it to the expected elapsed time N*P in order to detect duplicate frames. But it only reports the
+ duplicate frames themselves (and a once-per-second elapsed frame count) to Maestro. When a trial is aborted because
+ RMVideo dropped a frame, there is no record of which stage of the animation loop -- target update, rendering, the
+ buffer swap, or command retrieval -- blew the frame budget, nor which target was the most costly to update.
+
+ DESCRIPTION:
+ CFrameTelemetry keeps a timing record for each iteration of the animation loop in a fixed-size ring buffer, along
+ with the update cost of each animated target. The ring is allocated when first needed and grown (between animation
+ sequences) only if the target count exceeds its current per-target capacity, so recording a frame involves no memory
+ allocation, no locking, and no system calls -- just a few stores. If an animation sequence runs longer than CAPACITY
+ frames, the oldest records are overwritten.
+
+ After a sequence ends, the renderer may summarize the retained records in response to RMV_CMD_GETFRAMESTATS (see
+ getSummary()), and may append them to a CSV file (see dumpCSV()).
+
+ USAGE:
+ Call begin() before each animation sequence and record() once per iteration of the animation loop. All methods must
+ be called on the same thread; the per-target costs passed to record() must already be complete, ie, any worker
+ threads that contributed to them must have finished.
+
+ REVISION HISTORY:
+ 16oct2026-- Initial version, introduced to record per-frame timing telemetry in CRMVRenderer::animate().
+ 16oct2026-- Added FLAG_LATCHED, set when the next command arrived during a late-latch wait in animate().
+//===================================================================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "rmvideo_common.h"
+#include "frametelemetry.h"
+
+
+CFrameTelemetry::CFrameTelemetry()
+{
+   m_pRecords = NULL;
+   m_pTgtUS = NULL;
+   m_nTgtCap = 0;
+   m_nTgts = 0;
+   m_nFrames = 0;
+}
+
+CFrameTelemetry::~CFrameTelemetry()
+{
+   if(m_pRecords != NULL) { ::free(m_pRecords); m_pRecords = NULL; }
+   if(m_pTgtUS != NULL) { ::free(m_pTgtUS); m_pTgtUS = NULL; }
+   m_nTgtCap = 0;
+}
+
+/**
+ Reset the telemetry record in preparation for an animation sequence. Any records from the previous sequence are
+ discarded. The record ring is allocated on the first call, and per-target storage is reallocated if the number of
+ targets exceeds the current capacity. This is NOT a time-critical method.
+
+ @param nTgts The number of targets participating in the animation sequence.
+ @return True if successful; false if memory allocation failed. In the latter case, a brief error message is printed
+ to stderr and record() will have no effect until the next successful call to this method.
+*/
+bool CFrameTelemetry::begin(int nTgts)
+{
+   m_nFrames = 0;
+   m_nTgts = 0;
+   if(nTgts < 0) nTgts = 0;
+
+   if(m_pRecords == NULL)
+   {
+      m_pRecords = (Record*) ::calloc(CAPACITY, sizeof(Record));
+      if(m_pRecords == NULL)
+      {
+         ::fprintf(stderr, "ERROR(CFrameTelemetry): Memory allocation failed. Frame telemetry disabled.\n");
+         return(false);
+      }
+   }
+
+   if(nTgts > m_nTgtCap)
+   {
+      if(m_pTgtUS != NULL) ::free(m_pTgtUS);
+      m_pTgtUS = (float*) ::calloc(CAPACITY * nTgts, sizeof(float));
+      m_nTgtCap = (m_pTgtUS != NULL) ? nTgts : 0;
+      if(m_pTgtUS == NULL)
+      {
+         ::free(m_pRecords);
+         m_pRecords = NULL;
+         ::fprintf(stderr, "ERROR(CFrameTelemetry): Memory allocation failed. Frame telemetry disabled.\n");
+         return(false);
+      }
+   }
+
+   m_nTgts = nTgts;
+   return(true);
+}
+
+/**
+ Append a timing record for the latest iteration of the animation loop. If the ring is full, the oldest record is
+ overwritten. No action is taken if the telemetry record was not successfully prepared by begin().
+
+ @param rec The timing record.
+ @param pTgtUpdateUS The update cost of each target participating in the animation sequence, in microseconds. Must
+ contain at least as many elements as the target count passed to begin(). May be NULL, in which case all costs are
+ recorded as zero.
+*/
+void CFrameTelemetry::record(const Record& rec, const float* pTgtUpdateUS)
+{
+   if(m_pRecords == NULL) return;
+
+   int idx = m_nFrames % CAPACITY;
+   m_pRecords[idx] = rec;
+   if(m_nTgts > 0)
+   {
+      float* pDst = &(m_pTgtUS[idx * m_nTgtCap]);
+      if(pTgtUpdateUS != NULL) ::memcpy(pDst, pTgtUpdateUS, m_nTgts * sizeof(float));
+      else ::memset(pDst, 0, m_nTgts * sizeof(float));
+   }
+   ++m_nFrames;
+}
+
+/**
+ Summarize the retained telemetry records IAW the reply format specified for RMV_CMD_GETFRAMESTATS. All times are
+ rounded to the nearest microsecond.
+
+ @param pStats [out] Must have room for RMV_FRAMESTATS_LEN integers. If there are no retained records, all elements are
+ set to zero, except the index of the slowest target, which is set to -1.
+*/
+void CFrameTelemetry::getSummary(int* pStats)
+{
+   ::memset(pStats, 0, RMV_FRAMESTATS_LEN * sizeof(int));
+   pStats[RMV_FRAMESTATS_SLOWTGT] = -1;
+
+   int n = (m_pRecords != NULL) ? getNumRetained() : 0;
+   pStats[RMV_FRAMESTATS_NFRAMES] = (m_pRecords != NULL) ? m_nFrames : 0;
+   pStats[RMV_FRAMESTATS_NKEPT] = n;
+   if(n == 0) return;
+
+   double sum[4] = {0, 0, 0, 0};
+   float maxVal[4] = {0, 0, 0, 0};
+   float maxDrift = 0;
+   float worstCost = -1;
+   int iWorst = 0;
+   int nSkips = 0, nMissed = 0;
+   for(int i=0; i<n; i++)
+   {
+      const Record& r = m_pRecords[ringIndex(i)];
+      float val[4] = {r.updateUS, r.drawUS, r.swapUS, r.cmdUS};
+      for(int j=0; j<4; j++)
+      {
+         sum[j] += val[j];
+         if(val[j] > maxVal[j]) maxVal[j] = val[j];
+      }
+      if(fabsf(r.driftUS) > maxDrift) maxDrift = fabsf(r.driftUS);
+      if(r.updateUS + r.drawUS > worstCost)
+      {
+         worstCost = r.updateUS + r.drawUS;
+         iWorst = i;
+      }
+      nSkips += r.nSkips;
+      if((r.flags & FLAG_MISSEDCMD) != 0) ++nMissed;
+   }
+
+   pStats[RMV_FRAMESTATS_NSKIPS] = nSkips;
+   pStats[RMV_FRAMESTATS_NMISSED] = nMissed;
+   for(int j=0; j<4; j++)
+   {
+      pStats[RMV_FRAMESTATS_UPDAVG + 2*j] = int(::round(sum[j] / n));
+      pStats[RMV_FRAMESTATS_UPDAVG + 2*j + 1] = int(::roundf(maxVal[j]));
+   }
+   pStats[RMV_FRAMESTATS_MAXDRIFT] = int(::roundf(maxDrift));
+
+   int idx = ringIndex(iWorst);
+   pStats[RMV_FRAMESTATS_WORSTFRAME] = m_pRecords[idx].frame;
+   pStats[RMV_FRAMESTATS_WORSTCOST] = int(::roundf(worstCost));
+   if(m_nTgts > 0)
+   {
+      const float* pCosts = &(m_pTgtUS[idx * m_nTgtCap]);
+      int iSlow = 0;
+      for(int k=1; k<m_nTgts; k++) if(pCosts[k] > pCosts[iSlow]) iSlow = k;
+      pStats[RMV_FRAMESTATS_SLOWTGT] = iSlow;
+      pStats[RMV_FRAMESTATS_SLOWTGTCOST] = int(::roundf(pCosts[iSlow]));
+   }
+}
+
+/**
+ Append the retained telemetry records to the specified CSV file, oldest first. The records are preceded by a comment
+ line (starting with '#') identifying the sequence and the number of frames and targets, and a column header line.
+ Each record then occupies one line: frame, update, draw, swap, cmd, drift, period, skips, flags, followed by the
+ update cost of each target. All times are in microseconds. This is NOT a time-critical method.
+
+ @param path The file path. The file is created if it does not exist.
+ @param iSeq An index identifying the animation sequence.
+ @return True if successful, false otherwise. In the latter case, a brief error message is printed to stderr.
+*/
+bool CFrameTelemetry::dumpCSV(const char* path, int iSeq)
+{
+   if(m_pRecords == NULL) return(true);
+
+   FILE* fp = ::fopen(path, "a");
+   if(fp == NULL)
+   {
+      ::fprintf(stderr, "ERROR(CFrameTelemetry): Unable to open telemetry file %s\n", path);
+      return(false);
+   }
+
+   int n = getNumRetained();
+   ::fprintf(fp, "# sequence %d: %d frames (%d retained), %d targets\n", iSeq, m_nFrames, n, m_nTgts);
+   ::fprintf(fp, "frame,update,draw,swap,cmd,drift,period,skips,flags");
+   for(int k=0; k<m_nTgts; k++) ::fprintf(fp, ",tgt%d", k);
+   ::fprintf(fp, "\n");
+
+   for(int i=0; i<n; i++)
+   {
+      int idx = ringIndex(i);
+      const Record& r = m_pRecords[idx];
+      ::fprintf(fp, "%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.3f,%d,%d", r.frame, r.updateUS, r.drawUS, r.swapUS, r.cmdUS,
+            r.driftUS, r.periodUS, int(r.nSkips), int(r.flags));
+      for(int k=0; k<m_nTgts; k++) ::fprintf(fp, ",%.1f", m_pTgtUS[idx * m_nTgtCap + k]);
+      ::fprintf(fp, "\n");
+   }
+
+   bool bOk = (::ferror(fp) == 0);
+   if(::fclose(fp) != 0) bOk = false;
+   if(!bOk) ::fprintf(stderr, "ERROR(CFrameTelemetry): Failed to write telemetry file %s\n", path);
+   return(bOk);
+}
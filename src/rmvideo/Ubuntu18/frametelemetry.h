@@ -0,0 +1,66 @@
+//=====================================================================================================================
+//
+// frametelemetry.h : Helper class CFrameTelemetry, a per-frame timing record of RMVideo animation sequences.
+//
+//=====================================================================================================================
+
+
+#if !defined(FRAMETELEMETRY_H_INCLUDED_)
+#define FRAMETELEMETRY_H_INCLUDED_
+
+
+class CFrameTelemetry
+{
+public:
+   // timing record for one iteration of the animation loop in CRMVRenderer::animate(). All times in microseconds.
+   struct Record
+   {
+      int frame;                       // # of display frames elapsed at the end of the iteration, including skips
+      float updateUS;                  // target update stage (motion vector retrieval and target updates)
+      float drawUS;                    // render stage (draw all targets on the backbuffer)
+      float swapUS;                    // buffer swap and wait for the vertical blanking interval
+      float cmdUS;                     // retrieval of the next command from Maestro
+      float driftUS;                   // actual minus expected elapsed time (T - N*P) after accounting for skips
+      float periodUS;                  // the estimate of the refresh period P in effect for the iteration
+      short nSkips;                    // # of duplicate frames due to a rendering delay
+      short flags;                     // FLAG_* bits
+   };
+
+   static const int FLAG_UPDATED = (1<<0);      // targets were updated for this frame (else it repeats the last one)
+   static const int FLAG_MISSEDCMD = (1<<1);    // the next target update was not received in time
+   static const int FLAG_LATCHED = (1<<2);      // the next command arrived while waiting for it (late-latch mode)
+
+   static const int CAPACITY = 8192;   // max # of records retained; once full, the oldest records are overwritten
+
+   CFrameTelemetry();
+   ~CFrameTelemetry();
+
+   // reset telemetry in preparation for an animation sequence involving the specified number of targets
+   bool begin(int nTgts);
+
+   // append a record for the latest iteration of the animation loop, along with the update cost of each target (us)
+   void record(const Record& rec, const float* pTgtUpdateUS);
+
+   // # of records appended since begin(), and # of those that are still retained
+   int getNumFrames() { return(m_nFrames); }
+   int getNumRetained() { return(m_nFrames < CAPACITY ? m_nFrames : CAPACITY); }
+
+   // summarize the retained records in RMV_FRAMESTATS_LEN integers, as specified for RMV_CMD_GETFRAMESTATS
+   void getSummary(int* pStats);
+
+   // append the retained records to a CSV file, preceded by a one-line header identifying the sequence
+   bool dumpCSV(const char* path, int iSeq);
+
+private:
+   Record* m_pRecords;                 // the record ring (allocated on first use)
+   float* m_pTgtUS;                    // per-target update costs: CAPACITY rows of m_nTgtCap floats
+   int m_nTgtCap;                      // # of targets for which per-target storage is currently allocated
+   int m_nTgts;                        // # of targets in the current animation sequence
+   int m_nFrames;                      // # of records appended since begin()
+
+   // index in the record ring of the i-th retained record, where i=0 is the oldest
+   int ringIndex(int i) { return((m_nFrames <= CAPACITY ? i : m_nFrames + i) % CAPACITY); }
+};
+
+
+#endif // !defined(FRAMETELEMETRY_H_INCLUDED_)
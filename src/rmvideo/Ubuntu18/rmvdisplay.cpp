@@ -186,6 +186,29 @@ I used it to get the video sync counter before and after a 550-frame epoch; the
  eligible to run on more than one CPU.
  16dec2024-- Modified openDisplay() to first request a double-buffered visual with stereo support, in which case stereo
  mode is enabled. This should only work if the NVidia card supports stereo. For Priebe lab.
+ 16oct2026-- Added headless mode for benchmarking and regression-testing RMVideo's rendering on machines without a
+ display: rendering is done on an offscreen EGL pbuffer surface, the command session is always emulated (CRMVIoSim),
+ and each animation frame is read back, hashed, and logged along with its render cost. See enableHeadlessMode(), 
+ openHeadlessDisplay(), and captureFrame(). Also, checkGLExtension() now falls back to glGetStringi() when the 
+ context does not support glGetString(GL_EXTENSIONS), as is the case for the Core Profile context in headless mode.
+ Added getGLProcAddress(), so that GL functions resolved at runtime are obtained from EGL in headless mode.
+ 16oct2026-- Added support for RMV_CMD_GETFRAMESTATS, which reports frame-timing statistics for the most recent
+ animation sequence. See getFrameStats().
+ 16oct2026-- Added support for RMV_CMD_GETIMGCACHESTATS, handled by the media store manager.
+ 16oct2026-- Added optional event-driven command ingestion (see enableEventDrivenIO()), in which the network link
+ receives Maestro commands on a dedicated thread. In the idle state, we now wait on the IO link for up to 2ms between
+ commands (CRMVIo::waitForCommand()) rather than sleeping for 2ms, so a command is processed as soon as it arrives.
+ Added support for RMV_CMD_GETCMDLATENCY, which reports the command receive-to-retrieval latency. See 
+ getCommandLatency().
+ 16oct2026-- Added support for RMV_CMD_PUTFILEX, the windowed, resumable and deduplicating version of RMV_CMD_PUTFILE,
+ handled by the media store manager.
+ 16oct2026-- The media store manager no longer preloads the image cache while loading the media store. Instead, it is
+ preloaded on a background thread started once the Maestro communication link is ready; that thread is suspended
+ during animation sequences and stopped before RMVideo exits.
+ 16oct2026-- In the idle state, when no command is pending, the renderer's texture pool is trimmed to its budget and
+ pre-warmed for the next target list (CRMVRenderer::maintainTexturePool()). Added setTexturePoolBudget().
+ 16oct2026-- Added enableSinglePassStereo() and hasStereoBuffers(). In headless mode, stereo mode may now be emulated
+ when single-pass stereo rendering is requested, with both eyes captured side by side in each frame.
 */
 
 #include <stdio.h>
@@ -194,6 +217,7 @@ I used it to get the video sync counter before and after a 550-frame epoch; the
 #include <math.h>
 #include <time.h>
 #include <unistd.h>
+#include <errno.h>
 #include <sys/stat.h>
 #include <pthread.h>             // to verify primary thread is eligible to run on more than one CPU
 
@@ -207,6 +231,9 @@ const int CRMVDisplay::STATE_OFF       = 0;
 const int CRMVDisplay::STATE_IDLE      = 1;
 const int CRMVDisplay::STATE_ANIMATE   = 2;
 
+const char* CRMVDisplay::FRAMELOGFILE = "rmvframes.txt";
+const char* CRMVDisplay::FRAMEIMGDIR = "rmvframes";
+
 
 //=== CRMVDisplay (constructor) =======================================================================================
 //
@@ -221,6 +248,8 @@ CRMVDisplay::CRMVDisplay()
    m_blankCursor = (Cursor) -1;
    m_pXVInfo = NULL;
    m_bStereoEnabled = false;
+   m_bStereoBuffers = false;
+   m_bEmulateStereo = false;
 
    m_bAltVideoModesSupported = false;
    m_pScreenRes = NULL;
@@ -235,7 +264,20 @@ CRMVDisplay::CRMVDisplay()
    m_iHeightPix = 768;
 
    m_pIOLink = NULL;
+   m_bEventDrivenIO = false;
+   m_bBusyPollIO = false;
    m_iState = STATE_OFF;
+
+   m_bHeadless = false;
+   m_bSaveFrameImages = false;
+   m_iHeadlessRateHz = 60;
+   m_eglDisplay = EGL_NO_DISPLAY;
+   m_eglSurface = EGL_NO_SURFACE;
+   m_eglContext = EGL_NO_CONTEXT;
+   m_pFrameLog = NULL;
+   m_pFrameBuf = NULL;
+   m_nAnimSeqs = 0;
+   m_nFramesCaptured = 0;
 }
 
 //=== ~CRMVDisplay (destructor) =======================================================================================
@@ -269,11 +311,13 @@ CRMVDisplay::~CRMVDisplay()
 //                               testing purposes.  The emulator will process a text file describing the targets to
 //                               animate and the frame-by-frame target motion info during the animation sequence.  The
 //                               emulator will deliver a series of Maestro commands to drive RMVideo through the
-//                               animation.
+//                               animation. Always true in headless mode.
 //    RETURNS:    NONE.
 //
 void CRMVDisplay::start( bool useEmulator )
 {
+   if(m_bHeadless) useEmulator = true;
+
    // load media store
    if(!mediaMgr.load()) return;
    
@@ -283,7 +327,12 @@ void CRMVDisplay::start( bool useEmulator )
    // set up communication link with Maestro, or use an emulator that delivers a command sequence stored in a file
    m_pIOLink = NULL;
    if(useEmulator) m_pIOLink = new CRMVIoSim();
-   else m_pIOLink = new CRMVIoNet();
+   else
+   {
+      CRMVIoNet* pNetLink = new CRMVIoNet();
+      if(pNetLink != NULL) pNetLink->setEventDrivenMode(m_bEventDrivenIO, m_bBusyPollIO);
+      m_pIOLink = pNetLink;
+   }
    if(m_pIOLink == NULL || !m_pIOLink->init())
    {
       fprintf(stderr, "ERROR: Unable to set up Maestro communication interface!\n");
@@ -295,6 +344,9 @@ void CRMVDisplay::start( bool useEmulator )
       return;
    }
 
+   // preload the image cache in the background. Not fatal if this fails -- images are cached as they are used.
+   mediaMgr.startImagePreload();
+
    // run until we're told to die.  We also die if a really bad error occurs.
    while(m_iState > STATE_DYING)
    {
@@ -315,7 +367,10 @@ void CRMVDisplay::start( bool useEmulator )
             idle();
          if(m_iState == STATE_ANIMATE)
          {
+            m_nFramesCaptured = 0;
+            mediaMgr.suspendImagePreload(true);
             int res = m_renderer.animate();
+            mediaMgr.suspendImagePreload(false);
             if(res==1) m_iState = STATE_IDLE;
             else if(res==0) m_iState = STATE_OFF;
             else m_iState = STATE_DYING;
@@ -332,6 +387,9 @@ void CRMVDisplay::start( bool useEmulator )
       m_pIOLink->closeSession();
    }
 
+   // stop the image preload thread if it is still running
+   mediaMgr.stopImagePreload();
+
    // release the communication interface
    if(m_pIOLink != NULL)
    {
@@ -385,6 +443,9 @@ bool CRMVDisplay::openDisplay()
    // just for safety  -- we should only call this once
    if(m_pDisplay != NULL) return( true );
 
+   // in headless mode, there's no X display -- just an offscreen surface
+   if(m_bHeadless) return(openHeadlessDisplay());
+
    // we require high-res timing support.  Fail if it is not available.
    if( !CElapsedTime::isSupported() )
    {
@@ -478,12 +539,12 @@ bool CRMVDisplay::openDisplay()
          fprintf(stderr, "ERROR: Graphics doesn't support 24-bit RGB color with alpha channel and double-buffering\n");
          return(false);
       }
-      m_bStereoEnabled = false;
+      m_bStereoEnabled = m_bStereoBuffers = false;
       fprintf(stderr, "===> Stereo Mode NOT available.\n");
    }
    else
    {
-      m_bStereoEnabled = true;
+      m_bStereoEnabled = m_bStereoBuffers = true;
       fprintf(stderr, "Stereo Mode ENABLED!!\n");
    }
 
@@ -839,6 +900,12 @@ void CRMVDisplay::createFullscreenWindow()
 //    RETURNS:    NONE.
 void CRMVDisplay::closeDisplay()
 {
+   if(m_bHeadless)
+   {
+      closeHeadlessDisplay();
+      return;
+   }
+
    // release current GLX context (if in fact there is one)
    if(m_pDisplay != NULL) glXMakeCurrent(m_pDisplay, None, NULL);
 
@@ -899,6 +966,266 @@ void CRMVDisplay::closeDisplay()
    }
 }
 
+/**
+ Configure the display manager to run "headless", without an X display. All rendering is done on an offscreen EGL
+ pbuffer surface with the given dimensions, the Maestro communication link is always emulated by CRMVIoSim, and each
+ display frame rendered during an animation sequence is captured. The purpose of headless mode is to benchmark and
+ regression-test RMVideo's rendering on machines without a monitor, or even a GPU. See openHeadlessDisplay() and 
+ captureFrame() for details.
+
+ This method must be called before start(). It has no effect once the display has been opened.
+
+ @param w, h [in] Dimensions of the offscreen surface in pixels. Silently corrected to at least 1024x768.
+ @param rateHz [in] The nominal refresh rate in Hz. There is no vertical sync offscreen, so the frame period reported
+ to Maestro (and used to compute per-frame target motion) is based on this value. Silently corrected to [60..500].
+ @param bSaveImages [in] If set, each captured frame is also saved as an image file.
+*/
+void CRMVDisplay::enableHeadlessMode(int w, int h, int rateHz, bool bSaveImages)
+{
+   if(m_eglDisplay != EGL_NO_DISPLAY || m_pDisplay != NULL) return;
+
+   m_bHeadless = true;
+   m_iWidthPix = (w < 1024) ? 1024 : w;
+   m_iHeightPix = (h < 768) ? 768 : h;
+   m_iHeadlessRateHz = (rateHz < 60) ? 60 : ((rateHz > 500) ? 500 : rateHz);
+   m_bSaveFrameImages = bSaveImages;
+}
+
+/**
+ Swap the front and back buffers of the RMVideo display. In headless mode, the frame just rendered is captured first,
+ but only during an animation sequence. See captureFrame().
+*/
+void CRMVDisplay::swap()
+{
+   if(!m_bHeadless)
+   {
+      glXSwapBuffers(m_pDisplay, m_window);
+      return;
+   }
+
+   if(m_iState == STATE_ANIMATE) captureFrame();
+   eglSwapBuffers(m_eglDisplay, m_eglSurface);
+}
+
+/**
+ Headless mode counterpart to openDisplay(): Create an offscreen EGL pbuffer surface with an OpenGL 3.3 Core Profile
+ rendering context, and have the renderer allocate its GL resources in that context.
+
+ We prefer the Mesa "surfaceless" EGL platform, which needs neither an X server nor a GPU (rendering is done in 
+ software, eg, llvmpipe), falling back to the default EGL display. Video mode switching and gamma correction are not
+ available in headless mode. Since there is no vertical sync to measure, the frame period is set to the nominal refresh
+ period specified in enableHeadlessMode().
+
+ There are no stereo backbuffers in headless mode. However, if single-pass stereo rendering was requested (see
+ enableSinglePassStereo()), stereo mode is emulated: the renderer draws both eyes offscreen and places them side by 
+ side in the captured frame. If the renderer cannot support single-pass stereo, stereo mode is disabled.
+
+ The frame capture log FRAMELOGFILE is created in the current working directory -- which is where CRMVIoSim expects
+ to find its command file. If frame images are to be saved, the FRAMEIMGDIR folder is created there as well.
+
+ @return True if successful, false otherwise. In the latter case, an error message is printed to stderr, and RMVideo
+ should exit.
+*/
+bool CRMVDisplay::openHeadlessDisplay()
+{
+   if(m_eglDisplay != EGL_NO_DISPLAY) return(true);
+
+   if(!CElapsedTime::isSupported())
+   {
+      fprintf(stderr, "ERROR: High-res timing support not available!\n");
+      return(false);
+   }
+
+   // get the EGL display, preferably on the surfaceless platform
+   const char* clientExts = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+   PFNEGLGETPLATFORMDISPLAYEXTPROC pGetPlatformDisplay = 
+         (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+   if(pGetPlatformDisplay != NULL && clientExts != NULL && strstr(clientExts, "EGL_MESA_platform_surfaceless") != NULL)
+      m_eglDisplay = (*pGetPlatformDisplay)(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+   if(m_eglDisplay == EGL_NO_DISPLAY) m_eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+   EGLint major = 0, minor = 0;
+   if(m_eglDisplay == EGL_NO_DISPLAY || !eglInitialize(m_eglDisplay, &major, &minor))
+   {
+      fprintf(stderr, "ERROR: Could not initialize EGL display for headless mode\n");
+      m_eglDisplay = EGL_NO_DISPLAY;
+      return(false);
+   }
+
+   // an offscreen pbuffer surface with 24-bit color and alpha channel, renderable by desktop OpenGL
+   EGLint configAttrs[] =
+   {
+      EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+      EGL_RED_SIZE, 8,
+      EGL_GREEN_SIZE, 8,
+      EGL_BLUE_SIZE, 8,
+      EGL_ALPHA_SIZE, 8,
+      EGL_NONE
+   };
+   EGLConfig config;
+   EGLint nConfigs = 0;
+   if(!eglChooseConfig(m_eglDisplay, configAttrs, &config, 1, &nConfigs) || nConfigs < 1)
+   {
+      fprintf(stderr, "ERROR: No EGL configuration supports an offscreen surface with 24-bit RGB color\n");
+      closeHeadlessDisplay();
+      return(false);
+   }
+
+   EGLint surfaceAttrs[] = { EGL_WIDTH, m_iWidthPix, EGL_HEIGHT, m_iHeightPix, EGL_NONE };
+   m_eglSurface = eglCreatePbufferSurface(m_eglDisplay, config, surfaceAttrs);
+
+   EGLint contextAttrs[] =
+   {
+      EGL_CONTEXT_MAJOR_VERSION, 3,
+      EGL_CONTEXT_MINOR_VERSION, 3,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+      EGL_NONE
+   };
+   if(m_eglSurface != EGL_NO_SURFACE && eglBindAPI(EGL_OPENGL_API))
+      m_eglContext = eglCreateContext(m_eglDisplay, config, EGL_NO_CONTEXT, contextAttrs);
+   if(m_eglContext == EGL_NO_CONTEXT || !eglMakeCurrent(m_eglDisplay, m_eglSurface, m_eglSurface, m_eglContext))
+   {
+      fprintf(stderr, "ERROR: Could not create offscreen surface with an OpenGL 3.3 rendering context\n");
+      closeHeadlessDisplay();
+      return(false);
+   }
+   m_bWindowCreated = true;
+
+   fprintf(stderr, "Headless mode: EGL %d.%d, %s; offscreen W,H = %d, %d pixels\n", major, minor, 
+         (const char*) glGetString(GL_RENDERER), m_iWidthPix, m_iHeightPix);
+
+   // our renderer must successfully allocate various OpenGL resources it needs
+   m_bStereoBuffers = false;
+   m_bStereoEnabled = m_bEmulateStereo;
+   if(!m_renderer.createResources(this))
+   {
+      fprintf(stderr, "ERROR: Failed to create OpenGL rendering resources in headless mode\n");
+      closeHeadlessDisplay();
+      return(false);
+   }
+   if(m_bStereoEnabled && m_renderer.getSinglePassStereoMode() == CRMVRenderer::STEREO_TWOPASS)
+   {
+      m_bStereoEnabled = false;
+      fprintf(stderr, "===> Emulated stereo mode NOT available.\n");
+   }
+
+   // prepare for frame capture
+   m_pFrameBuf = (unsigned char*) ::calloc(m_iWidthPix * m_iHeightPix * 3, sizeof(unsigned char));
+   m_pFrameLog = ::fopen(FRAMELOGFILE, "w");
+   if(m_pFrameBuf == NULL || m_pFrameLog == NULL)
+   {
+      fprintf(stderr, "ERROR: Unable to prepare for frame capture in headless mode\n");
+      closeHeadlessDisplay();
+      return(false);
+   }
+   ::fprintf(m_pFrameLog, "# RMVideo headless frame capture: %d x %d @ %d Hz (nominal)\n", m_iWidthPix, m_iHeightPix,
+         m_iHeadlessRateHz);
+   ::fprintf(m_pFrameLog, "# seq frame renderMS hash\n");
+   if(m_bSaveFrameImages && ::mkdir(FRAMEIMGDIR, 0755) != 0 && errno != EEXIST)
+   {
+      fprintf(stderr, "WARNING: Unable to create folder '%s'; frame images will not be saved\n", FRAMEIMGDIR);
+      m_bSaveFrameImages = false;
+   }
+   glPixelStorei(GL_PACK_ALIGNMENT, 1);
+   m_nAnimSeqs = 0;
+   m_nFramesCaptured = 0;
+
+   m_renderer.setFramePeriod(1.0 / double(m_iHeadlessRateHz));
+   fprintf(stderr, "Nominal refresh rate = %d Hz. Frame capture log: %s\n", m_iHeadlessRateHz, FRAMELOGFILE);
+   return(true);
+}
+
+/** Headless mode counterpart to closeDisplay(): Release all resources allocated in openHeadlessDisplay(). */
+void CRMVDisplay::closeHeadlessDisplay()
+{
+   if(m_bWindowCreated)
+   {
+      m_renderer.releaseResources();
+      m_bWindowCreated = false;
+   }
+
+   if(m_eglDisplay != EGL_NO_DISPLAY)
+   {
+      eglMakeCurrent(m_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+      if(m_eglContext != EGL_NO_CONTEXT) eglDestroyContext(m_eglDisplay, m_eglContext);
+      if(m_eglSurface != EGL_NO_SURFACE) eglDestroySurface(m_eglDisplay, m_eglSurface);
+      eglTerminate(m_eglDisplay);
+   }
+   m_eglContext = EGL_NO_CONTEXT;
+   m_eglSurface = EGL_NO_SURFACE;
+   m_eglDisplay = EGL_NO_DISPLAY;
+
+   if(m_pFrameLog != NULL)
+   {
+      ::fclose(m_pFrameLog);
+      m_pFrameLog = NULL;
+   }
+   if(m_pFrameBuf != NULL)
+   {
+      ::free(m_pFrameBuf);
+      m_pFrameBuf = NULL;
+   }
+}
+
+/**
+ Headless mode only: Capture the display frame just rendered on the back buffer. Called by swap() during an animation
+ sequence, so the capture includes the few background-only frames presented to sync up before frame 0.
+
+ The frame is read back as packed 8-bit RGB, and a single line is appended to the frame capture log: the animation
+ sequence number (starting at 1), the frame index within that sequence, the render cost in milliseconds, and a 64-bit
+ FNV-1a hash of the pixel data. The render cost is the elapsed time since the previous frame was captured, up to the
+ point at which the GPU has finished rendering the frame (we call glFinish() first); thus it covers the target update
+ and drawing for the frame, but not the readback and logging of the previous frame. Two runs of the same command file
+ on the same renderer should produce identical hash sequences, so the log may be compared against a known-good log to
+ detect visual regressions; the render costs serve as a benchmark.
+
+ If enabled, the frame is also saved as a binary PPM image, FRAMEIMGDIR/sSSS_fNNNNN.ppm, for visual inspection.
+*/
+void CRMVDisplay::captureFrame()
+{
+   if(m_pFrameBuf == NULL || m_pFrameLog == NULL) return;
+
+   if(m_nFramesCaptured == 0) 
+   {
+      ++m_nAnimSeqs;
+      m_frameTimer.reset();
+   }
+
+   glFinish();
+   double tRenderMS = m_frameTimer.get() * 1000.0;
+
+   int w = m_iWidthPix;
+   int h = m_iHeightPix;
+   glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, m_pFrameBuf);
+
+   unsigned long long hash = 14695981039346656037ULL;
+   int nBytes = w * h * 3;
+   for(int i = 0; i < nBytes; i++)
+   {
+      hash ^= (unsigned long long) m_pFrameBuf[i];
+      hash *= 1099511628211ULL;
+   }
+   ::fprintf(m_pFrameLog, "%d %d %.3f %016llx\n", m_nAnimSeqs, m_nFramesCaptured, tRenderMS, hash);
+
+   if(m_bSaveFrameImages)
+   {
+      char path[256];
+      ::sprintf(path, "%s/s%03d_f%05d.ppm", FRAMEIMGDIR, m_nAnimSeqs, m_nFramesCaptured);
+      FILE* fd = ::fopen(path, "wb");
+      if(fd != NULL)
+      {
+         // PPM rows run top to bottom; GL rows run bottom to top
+         ::fprintf(fd, "P6\n%d %d\n255\n", w, h);
+         for(int row = h-1; row >= 0; row--) ::fwrite(m_pFrameBuf + row*w*3, 1, w*3, fd);
+         ::fclose(fd);
+      }
+   }
+
+   ++m_nFramesCaptured;
+   m_frameTimer.reset();
+}
+
 //=== showDisplay =====================================================================================================
 //
 //    Show or hide the OpenGL fullscreen display window in which RMVideo targets are animated.
@@ -1014,7 +1341,20 @@ bool CRMVDisplay::checkGLExtension( const char* extName )
    if( where || *extName == '\0' )
       return( false );
 
+   // in a Core Profile context, the extensions must be queried one at a time
    availExts = glGetString(GL_EXTENSIONS);
+   if(availExts == NULL)
+   {
+      glGetError();                 // clear the GL_INVALID_ENUM error
+      GLint n = 0;
+      glGetIntegerv(GL_NUM_EXTENSIONS, &n);
+      for(GLint i = 0; i < n; i++)
+      {
+         const char* ext = (const char*) glGetStringi(GL_EXTENSIONS, i);
+         if(ext != NULL && strcmp(ext, extName) == 0) return(true);
+      }
+      return(false);
+   }
    start = availExts;
    for( ;; )
    {
@@ -1031,6 +1371,20 @@ bool CRMVDisplay::checkGLExtension( const char* extName )
    return( false );
 }
 
+//=== getGLProcAddress ================================================================================================
+//
+//    Get the address of a GL function that must be resolved at runtime, such as glBufferStorage(). In headless mode,
+//    the GL context is an EGL context, so the function must be resolved by eglGetProcAddress() rather than
+//    glXGetProcAddress().
+//
+//    ARGS:       procName -- [in] name of the GL function.
+//    RETURNS:    The function address, or NULL if it could not be resolved.
+void* CRMVDisplay::getGLProcAddress( const char* procName )
+{
+   if(m_bHeadless) return( (void*) eglGetProcAddress(procName) );
+   return( (void*) glXGetProcAddress((const GLubyte*) procName) );
+}
+
 /**
  Helper method for openDisplay(). It uses the GLX_EXT_swap_control extension to verify that "SyncToVBlank" is enabled,
  with a swap interval of one. If not, it will attempt to set the swap interval. If unable to verify that the swap 
@@ -1142,6 +1496,16 @@ void CRMVDisplay::idle()
             case RMV_CMD_SETGAMMA :
                setGamma();
                break;
+
+            // report frame-timing statistics for the most recent animation sequence
+            case RMV_CMD_GETFRAMESTATS :
+               getFrameStats();
+               break;
+
+            // report command receive-to-retrieval latency statistics
+            case RMV_CMD_GETCMDLATENCY :
+               getCommandLatency();
+               break;
             
             // update parameters governing vertical sync spot flash in TL corner of screen (during animations)
             case RMV_CMD_SETSYNC :
@@ -1186,6 +1550,11 @@ void CRMVDisplay::idle()
                mediaMgr.replyGetMediaInfo(m_pIOLink);
                break;
 
+            // report statistics on the media store's image cache
+            case RMV_CMD_GETIMGCACHESTATS :
+               mediaMgr.replyGetImageCacheStats(m_pIOLink);
+               break;
+
             // permanently remove a particular file or an entire folder from the media store
             case RMV_CMD_DELETEMEDIA :
                mediaMgr.replyDeleteMediaFile(m_pIOLink);
@@ -1195,6 +1564,11 @@ void CRMVDisplay::idle()
             case RMV_CMD_PUTFILE :
                mediaMgr.downloadMediaFile(m_pIOLink);
                break;
+
+            // same, but with multiple chunks in flight. Transfer is skipped if content is already in media store.
+            case RMV_CMD_PUTFILEX :
+               mediaMgr.downloadMediaFileEx(m_pIOLink);
+               break;
             
             // we should NEVER see these here, as this would indicate they were sent before a download was initiated
             case RMV_CMD_PUTFILECHUNK :
@@ -1245,9 +1619,15 @@ void CRMVDisplay::idle()
          if(iSig != 0) m_pIOLink->sendSignal(iSig);
       }
 
-      // sleep for 2ms between commands so we don't hog machine
+      // no command pending: use the idle time to maintain the renderer's texture pool. If there's more to do, check
+      // for the next command right away rather than waiting.
+      else if(m_renderer.maintainTexturePool())
+         continue;
+
+      // wait up to 2ms for the next command so we don't hog machine. The IO link may return as soon as a command
+      // arrives, rather than sleeping for the full 2ms.
       if(m_iState == STATE_IDLE)
-         usleep( 2000 );
+         m_pIOLink->waitForCommand( 2000 );
    }
 }
 
@@ -1404,11 +1784,37 @@ void CRMVDisplay::setCurrentVideoMode()
    m_pIOLink->sendData(2, reply);
 }
 
+//=== getFrameStats() =================================================================================================
+//    Helper method that replies to the RMV_CMD_GETFRAMESTATS command (in idle state only).
+void CRMVDisplay::getFrameStats()
+{
+   int reply[RMV_FRAMESTATS_LEN + 1];
+   reply[0] = RMV_SIG_CMDACK;
+   m_renderer.getFrameStats(&(reply[1]));
+   m_pIOLink->sendData(RMV_FRAMESTATS_LEN + 1, reply);
+}
+
+//=== getCommandLatency() =============================================================================================
+//    Helper method that replies to the RMV_CMD_GETCMDLATENCY command (in idle state only).
+void CRMVDisplay::getCommandLatency()
+{
+   int reply[RMV_CMDLATENCY_LEN + 1];
+   reply[0] = RMV_SIG_CMDACK;
+   m_pIOLink->getCommandLatencyStats(&(reply[1]));
+   m_pIOLink->sendData(RMV_CMDLATENCY_LEN + 1, reply);
+}
+
 //=== getGamma(), setGamma() ==========================================================================================
 //    Helper methods that reply to the RMV_CMD_GETGAMMA and RMV_CMD_SETGAMMA commands (in idle state only). Note that
 //    gamma correction factors for _SETGAMMA are restricted to [RMV_MINGAMMA .. RMV_MAXGAMMA].
 void CRMVDisplay::getGamma()
 {
+   if(m_bHeadless)
+   {
+      m_pIOLink->sendSignal(RMV_SIG_CMDERR);
+      return;
+   }
+
    XF86VidModeGamma gamma;
    if(XF86VidModeGetGamma(m_pDisplay, m_pXVInfo->screen, &gamma))
    {
@@ -1428,6 +1834,12 @@ void CRMVDisplay::setGamma()
    int r = m_pIOLink->getCommandArg(0);
    int g = m_pIOLink->getCommandArg(1);
    int b = m_pIOLink->getCommandArg(2);
+   if(m_bHeadless)
+   {
+      fprintf(stderr, "[CRMVDisplay::setGamma] Monitor gamma cannot be adjusted in headless mode.\n");
+      m_pIOLink->sendSignal(RMV_SIG_CMDERR);
+      return;
+   }
    if(r < RMV_MINGAMMA || r > RMV_MAXGAMMA || g < RMV_MINGAMMA || g > RMV_MAXGAMMA ||
       b < RMV_MINGAMMA || b > RMV_MAXGAMMA)
    {
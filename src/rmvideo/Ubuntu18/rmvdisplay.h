@@ -18,6 +18,9 @@
 #endif
 #include <GL/glx.h>
 
+#include <EGL/egl.h>          // EGL -- for the offscreen rendering surface in headless mode
+#include <EGL/eglext.h>
+
 #include <X11/Xlib.h>
 #include <X11/extensions/Xrandr.h>
 #include <X11/extensions/xf86vmode.h>
@@ -39,11 +42,45 @@ public:
    int getScreenHeight() { return(m_iHeightPix); }
 
    CRMVIo* getIOLink() { return(m_pIOLink); }
-   void swap() { glXSwapBuffers(m_pDisplay, m_window); }
+   void swap();                                                // swap buffers (capture frame in headless mode)
 
    CRMVMediaMgr* getMediaStoreManager() { return(&mediaMgr); }
 
    bool isStereoEnabled() { return(m_bStereoEnabled); }        // is stereo mode enabled for dot disparity feature?
+   bool hasStereoBuffers() { return(m_bStereoBuffers); }       // does the GL visual have L and R backbuffers?
+
+   bool checkGLExtension( const char* extName );               // check availability of a GL extension on host machine
+   void* getGLProcAddress( const char* procName );             // resolve a GL entry point (via EGL in headless mode)
+
+   void enablePipelinedRendering(bool b) { m_renderer.setPipelinedMode(b); }   // must call before start()
+   void enableGPUDotEngine(bool b) { m_renderer.setGPUDotEngineMode(b); }       // must call before start()
+   void enableTelemetryExport(bool b) { m_renderer.enableTelemetryExport(b); }  // export frame telemetry to file
+   void enableZeroCopyMovies(bool b) { m_renderer.setZeroCopyMovieMode(b); }    // must call before start()
+   void enableAnalyticApertures(bool b) { m_renderer.setAnalyticApertureMode(b); }  // must call before start()
+   void setImageCacheBudget(int nMB) { mediaMgr.setImageCacheBudget(nMB); }     // must call before start()
+   void setTexturePoolBudget(int nMB) { m_renderer.setTexturePoolBudget(nMB); } // must call before start()
+   void enableDiskImageCache(bool b) { mediaMgr.enableDiskImageCache(b); }     // must call before start()
+
+   // render both eyes in one pass in stereo mode (CRMVRenderer::STEREO_*). In headless mode, this also enables an
+   // emulated stereo mode, with the two eyes captured side by side. Must call before start()
+   void enableSinglePassStereo(int mode)
+   {
+      m_renderer.setSinglePassStereoMode(mode);
+      m_bEmulateStereo = (mode != CRMVRenderer::STEREO_TWOPASS);
+   }
+
+   // receive Maestro commands on a dedicated thread, optionally busy-polling; also enables the renderer's late-latch
+   // mode. Applies only to the network communication link; must call before start()
+   void enableEventDrivenIO(bool b, bool bBusyPoll)
+   {
+      m_bEventDrivenIO = b;
+      m_bBusyPollIO = b && bBusyPoll;
+      m_renderer.setLateLatchMode(b);
+   }
+
+   // render offscreen without an X display, capturing animation frames; must call before start()
+   void enableHeadlessMode(int w, int h, int rateHz, bool bSaveImages);
+   bool isHeadless() { return(m_bHeadless); }
 
 private:
    static const int STATE_OFF;                                 // op state: off, waiting for start of cmd session
@@ -62,6 +99,8 @@ private:
    GLXContext m_glxContext;                                    // the GLX rendering context assoc. with window
    XVisualInfo* m_pXVInfo;                                     // video configuration
    bool m_bStereoEnabled;                                      // true if stereo mode enabled
+   bool m_bStereoBuffers;                                      // true if GL visual has L and R backbuffers
+   bool m_bEmulateStereo;                                      // true to emulate stereo mode in headless mode
 
    struct VideoMode                                            // information on a video mode
    {
@@ -83,16 +122,34 @@ private:
    int m_iHeightPix;
 
    CRMVIo* m_pIOLink;                                          // communication link with Maestro
+   bool m_bEventDrivenIO;                                      // network link receives cmds on a dedicated thread
+   bool m_bBusyPollIO;                                         //    and busy-polls rather than sleeping
    int m_iState;                                               // current operational state
 
+   static const char* FRAMELOGFILE;                            // headless mode: frame capture log, in working dir
+   static const char* FRAMEIMGDIR;                             // headless mode: folder for captured frame images
+   bool m_bHeadless;                                           // true if rendering to an offscreen EGL surface
+   bool m_bSaveFrameImages;                                    // headless mode: save each captured frame as PPM image
+   int m_iHeadlessRateHz;                                      // headless mode: nominal refresh rate in Hz
+   EGLDisplay m_eglDisplay;                                    // headless mode: EGL display, pbuffer surface and
+   EGLSurface m_eglSurface;                                    //    rendering context
+   EGLContext m_eglContext;
+   FILE* m_pFrameLog;                                          // headless mode: the frame capture log
+   unsigned char* m_pFrameBuf;                                 // headless mode: buffer for frame readback
+   int m_nAnimSeqs;                                            // headless mode: # of animation sequences thus far
+   int m_nFramesCaptured;                                      // headless mode: # frames captured in current sequence
+   CElapsedTime m_frameTimer;                                  // headless mode: time since last frame was captured
+
    bool openDisplay();                                         // create all resources needed to run fullscreen display
    void enumerateVideoModes();                                 // get available video modes using RandR
    void createFullscreenWindow();                              // creates the fullscreen display window
    void closeDisplay();                                        // free all previously created resources
+   bool openHeadlessDisplay();                                 // create offscreen EGL surface and context (headless)
+   void closeHeadlessDisplay();                                // free resources allocated in openHeadlessDisplay()
+   void captureFrame();                                        // read back, hash, and log frame (headless)
    void showDisplay(bool bShow);                               // show/hide our fullscreen display window
 
    bool checkGLXExtension( const char* extName );              // check availability of a GLX extension on host machine
-   bool checkGLExtension( const char* extName );               // check availability of a GL extension on host machine
    bool enableSyncToVBlank();                                  // SyncToVBlank must be enabled for proper operation
 
    void idle();                                                // runtime loop in idle state
@@ -101,6 +158,8 @@ private:
    void setCurrentVideoMode();
    void getGamma();
    void setGamma();
+   void getFrameStats();
+   void getCommandLatency();
 };
 
 
@@ -0,0 +1,343 @@
+//=====================================================================================================================
+//
+// rmvdotkernel.cpp : Implementation of class CRMVDotKernel, the per-frame CPU update kernel for the RMV_RANDOMDOTS
+// target.
+//
+// AUTHOR:  saruffner.
+//
+// DESCRIPTION:
+// CRMVDotKernel holds the dot motion, recycling and aperture/Gaussian alpha code for the RMV_RANDOMDOTS target. It was
+// split out of CRMVTarget so that it has no dependence on OpenGL or the rest of RMVideo; CRMVTarget owns the per-dot
+// buffers and the random-number generators and passes them to CRMVDotKernel::update() once per frame. The standalone
+// test rmvdotstest.cpp runs the SSE2 and scalar paths of the kernel, along with a copy of the prior two-pass scalar
+// implementation, on the same seeds and checks the numerical equivalence bounds documented in update().
+//
+// REVISION HISTORY:
+// 16oct2026-- Initial version. Moved here from CRMVTarget::updateRandomDots() and its helpers.
+//=====================================================================================================================
+
+#include <math.h>
+
+#include "rmvdotkernel.h"
+
+
+/**
+ Advance the dots of a RMV_RANDOMDOTS target by one frame: move, recycle or randomly reposition each dot IAW the target
+ definition and the motion vector for this frame, and compute each dot's alpha. The new dot positions are left in the
+ SoA lanes of the dot state, and the interleaved vertex attribute array is refreshed for upload.
+
+ For details, see implementation notes for RMV_RANDOMDOTS in the header of rmvtarget.cpp.
+
+ Implementation: The dot state is kept in structure-of-arrays "lanes" (X, Y, and the per-dot displacement
+ coefficients C, S) rather than in the interleaved {x,y,Tx,Ty} vertex layout. Dots are processed in blocks of
+ DOTBLOCKSZ in a single sweep that fuses the motion, recycling and aperture/Gaussian alpha computations:
+    1) The candidate position of each dot in the block -- where it would be if it moved with its (possibly noisy)
+ velocity -- is computed 4-wide with SSE2. Per-dot noise enters only via the C,S lanes, which are refreshed when the
+ noise update interval expires. For direction noise, C=cos(noise) and S=sin(noise), so the rotated displacement is
+ obtained by angle addition without any per-frame trig calls; for speed noise, C is the speed scale factor and S=0;
+ with no noise C=1 and S=0, so the displacement is exactly the pattern displacement.
+    2) Then, in dot order, the RNG-dependent events are applied: the coherence test, dotlife expiration, and recycling
+ of dots that leave the aperture's bounding rectangle. These consume the same random numbers in the same order as
+ always, so a given seed still reproduces the same dot pattern.
+    3) The per-dot alpha is computed 4-wide from the final positions, and the block is transposed into the
+ interleaved vertex layout, ready for upload.
+ When SSE2 is not available, when bUseSIMD is false, and for the trailing dots that don't fill a complete block,
+ equivalent scalar code is used. The SSE2 and scalar paths compute the same dot positions bit for bit; the alpha
+ values differ only in the Gaussian, by at most EXPPS_MAXULP.
+
+ Equivalence with the prior two-pass scalar implementation: With no per-dot noise, dot positions are bit-for-bit
+ identical. With noise, the displacement is computed in single rather than double precision, so positions may differ
+ by up to POSNOISE_MAXULP per frame, where the ULP is that of the aperture's outer half-width or half-height (ie, on
+ the order of 1e-6 deg); and a dot lying within ~1 ULP of an oval aperture boundary may be classified differently.
+ Whether or not noise is enabled, the argument of the Gaussian window is computed in single precision, so its relative
+ error grows with its magnitude: the Gaussian alpha A differs by at most ALPHA_MAXULP * max(1, |ln A|) ULP. None of
+ this is visible onscreen. These bounds are checked by the standalone test rmvdotstest, which runs this kernel
+ alongside a copy of the prior implementation.
+
+ @param tgtDef The target definition.
+ @param tElapsed Elapsed time since the last update, in milliseconds.
+ @param pVec The target's motion vector for this update.
+ @param st [in/out] The target's per-dot state.
+ @param bUseSIMD If false, the scalar code path is used for all dots, even when SSE2 is available. For testing only.
+*/
+void CRMVDotKernel::update(const RMVTGTDEF& tgtDef, float tElapsed, PRMVTGTVEC pVec, DotState& st, bool bUseSIMD)
+{
+   // which special features, if any, are enabled?
+   bool bEnaCoherence = (tgtDef.iPctCoherent < 100);
+   bool bEnaNoise = (tgtDef.iNoiseUpdIntv > 0 && tgtDef.iNoiseLimit > 0);
+   bool bEnaDotLife = (tgtDef.fDotLife != 0.0f);
+   bool bIsDirNoise = bEnaNoise && ((tgtDef.iFlags & RMV_F_DIRNOISE) != 0);
+   bool bIsSpdLog2 = (!bIsDirNoise) && ((tgtDef.iFlags & RMV_F_SPDLOG2) != 0);
+   bool bWrtScreen = ((tgtDef.iFlags & RMV_F_WRTSCREEN) != 0);
+
+   // aperture outer half-width, half-height
+   float fOuterHalfW = tgtDef.fOuterW / 2.0f;
+   float fOuterHalfH = tgtDef.fOuterH / 2.0f;
+
+   // buffer pointers: interleaved vertex attributes (upload layout only) and the SoA dot state lanes
+   int nDots = st.nDots;
+   float* pfDots = st.pfDots;
+   float* pfX = st.pfX;
+   float* pfY = st.pfY;
+   float* pfC = st.pfC;
+   float* pfS = st.pfS;
+   float* pfDotNoise = st.pfDotNoise;
+   float* pfDotLives = st.pfDotLives;
+
+   // pattern displacement for this update, in Cartesian form. Each dot's displacement is (ax*C - ay*S, ay*C + ax*S).
+   float ax = pVec->hPat;
+   float ay = pVec->vPat;
+
+   // if per-dot noise enabled: (1) calculate the polar form of pattern velocity vector, and (2) choose new random
+   // noise factor for each dot whenever the noise update interval expires. We do this even if the target is off
+   // and/or not moving! Whenever the noise factors change, the per-dot displacement coefficients are recomputed.
+   if(bEnaNoise)
+   {
+      double dPatVecAmpl = ::sqrt(pVec->hPat * pVec->hPat + pVec->vPat * pVec->vPat);
+      double dPatVecTheta = cMath::atan2Deg(pVec->vPat, pVec->hPat);
+      ax = float(dPatVecAmpl * cMath::cosDeg(dPatVecTheta));
+      ay = float(dPatVecAmpl * cMath::sinDeg(dPatVecTheta));
+
+      st.tUntilNoiseUpdate -= tElapsed;
+      if(st.tUntilNoiseUpdate <= 0.0f)
+      {
+         st.tUntilNoiseUpdate += float(tgtDef.iNoiseUpdIntv);
+
+         // this factor is the expected value of 2^X, where X is a uniform r.v chosen over (-N..N). It is needed only
+         // in the implementation of multiplicative per-dot speed noise: Rdot = (Rpat * 2^X) / E(2^X).
+         double log2Fac = 1.0;
+         if(bIsSpdLog2)
+         {
+            log2Fac = pow(2.0, double(tgtDef.iNoiseLimit)) - pow(2.0, double(-tgtDef.iNoiseLimit));
+            log2Fac /= 2 * double(tgtDef.iNoiseLimit) * log(2.0);
+         }
+
+         for(int i = 0; i < nDots; i++)
+         {
+            double dNoise = st.pNoiseRNG->generate();              // (0..1)
+            dNoise *= 2.0 * double(tgtDef.iNoiseLimit);         // (0..2N), where N is the noise range limit
+            dNoise -= double(tgtDef.iNoiseLimit);               // (-N..N)
+            pfDotNoise[i] = float(dNoise);
+
+            if(bIsDirNoise)
+            {
+               // for dir noise, pat vel theta is offset by noise factor in deg
+               pfC[i] = cMath::cosDeg(pfDotNoise[i]);
+               pfS[i] = cMath::sinDeg(pfDotNoise[i]);
+            }
+            else if(!bIsSpdLog2)
+            {
+               // for additive speed noise, pat vel R is offset by a pct based noise factor
+               pfC[i] = float(1.0 + double(pfDotNoise[i]) / 100.0);
+               pfS[i] = 0.0f;
+            }
+            else
+            {
+               // (as of v2.1.3) for multiplicative speed noise, Rdot = (R*2^X)/E, where E is the mean of 2^X when X
+               // is a uniform r.v. in (-N..N)
+               pfC[i] = float(pow(2.0, double(pfDotNoise[i])) / log2Fac);
+               pfS[i] = 0.0f;
+            }
+         }
+      }
+   }
+
+   // (as of v2.5.2) if target pattern displacement is WRT screen rather than target window, then we must convert to
+   // window frame of reference by subtracting the window displacement during this update.
+   float wx = bWrtScreen ? pVec->hWin : 0.0f;
+   float wy = bWrtScreen ? pVec->vWin : 0.0f;
+
+   // if finite dotlife enabled, determine the change in dotlife for this update -- either elasped time in ms or
+   // distance travelled in degrees. We do this even if the target is off.
+   float fDotLifeDelta = 0.0f;
+   if(bEnaDotLife)
+   {
+      if(tgtDef.iFlags & RMV_F_LIFEINMS) fDotLifeDelta = tElapsed;
+      else fDotLifeDelta = ::sqrt(pVec->hPat * pVec->hPat + pVec->vPat * pVec->vPat);
+   }
+
+   // alpha component of each dot's RGBA color depends on the target aperture: If dot is outside aperture, A=0, else
+   // A=exp( -[x*x/(2*SX*SX) + y*y/(2*SY*SY)] ), where SX,SY are the standard deviations of the elliptical Gaussian
+   // window in X and Y (if SX=SY=0, A=1).
+   AlphaParams ap;
+   initAlphaParams(tgtDef, ap);
+
+   // UPDATE INDIVIDUAL DOTS, one block at a time
+   float candX[DOTBLOCKSZ];
+   float candY[DOTBLOCKSZ];
+   for(int iBlk = 0; iBlk < nDots; iBlk += DOTBLOCKSZ)
+   {
+      int nInBlk = cMath::min(DOTBLOCKSZ, nDots - iBlk);
+      bool bFullBlk = (nInBlk == DOTBLOCKSZ);
+
+      // (1) candidate positions assuming every dot in block moves with its velocity
+#if defined(__SSE2__)
+      if(bFullBlk && bUseSIMD) for(int k = 0; k < DOTBLOCKSZ; k += 4)
+      {
+         __m128 c = _mm_loadu_ps(pfC + iBlk + k);
+         __m128 s = _mm_loadu_ps(pfS + iBlk + k);
+         __m128 vax = _mm_set1_ps(ax);
+         __m128 vay = _mm_set1_ps(ay);
+         __m128 dx = _mm_sub_ps(_mm_mul_ps(vax, c), _mm_mul_ps(vay, s));
+         __m128 dy = _mm_add_ps(_mm_mul_ps(vay, c), _mm_mul_ps(vax, s));
+         _mm_storeu_ps(candX + k, _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(pfX + iBlk + k), dx), _mm_set1_ps(wx)));
+         _mm_storeu_ps(candY + k, _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(pfY + iBlk + k), dy), _mm_set1_ps(wy)));
+      }
+      else
+#endif
+      for(int k = 0; k < nInBlk; k++)
+      {
+         int i = iBlk + k;
+         candX[k] = (pfX[i] + (ax*pfC[i] - ay*pfS[i])) - wx;
+         candY[k] = (pfY[i] + (ay*pfC[i] + ax*pfS[i])) - wy;
+      }
+
+      // (2) in dot order, apply the events that consume random numbers
+      for(int k = 0; k < nInBlk; k++)
+      {
+         int i = iBlk + k;
+
+         // flag gets set if dot position was randomized on this frame
+         bool bWasDotLocRandomized = false;
+
+         // if coherence feature in play, on each update we randomly select a percentage of dots to be randomly
+         // repositioned w/in target window
+         if(bEnaCoherence)
+         {
+            double dTest = st.pDotRNG->generate() * 100.0;
+            if(dTest >= tgtDef.iPctCoherent)
+            {
+               bWasDotLocRandomized = true;
+               randomizeDotPos(tgtDef, st.pDotRNG, pfX[i], pfY[i]);
+            }
+         }
+
+         // if finite dotlife in play, decrement the dot's current lifetime and randomly repos dot if its lifetime
+         // expired
+         if(bEnaDotLife)
+         {
+            pfDotLives[i] -= fDotLifeDelta;
+            if(pfDotLives[i] < 0.0f)
+            {
+               pfDotLives[i] = tgtDef.fDotLife;
+               if(!bWasDotLocRandomized)
+               {
+                  bWasDotLocRandomized = true;
+                  randomizeDotPos(tgtDef, st.pDotRNG, pfX[i], pfY[i]);
+               }
+            }
+         }
+
+         if(bWasDotLocRandomized) continue;
+
+         // The code below implements an algorithm for recycling a dot that has just moved out of "bounds", ie,
+         // beyond the outer bounds of the aperture. The idea here is to relocate the dot in a sensible way so that
+         // the target acts like a window on a random-dot pattern of infinite extent. Dots are "recycled" when they
+         // leave the aperture's bounding rectangle (which is larger than the visible window for all apertures
+         // except "rect"!). If the dot has just advanced past the right edge of the rectangle by X degrees, then the
+         // algorithm here will "recycle" the dot X degrees left of the window's left edge, with the y-coord
+         // randomized since we don't want the same pattern to "wrap" around the window edges.
+         float fx = candX[k];
+         float fy = candY[k];
+         float fRem;
+         if(cMath::abs(fx) > fOuterHalfW)
+         {
+            fRem = ::fmodf(cMath::abs(fx) - fOuterHalfW, fOuterHalfW);
+            if((fx - pfX[i]) > 0)
+               fx = -fOuterHalfW + fRem;
+            else
+               fx = fOuterHalfW - fRem;
+
+            fy = float( st.pDotRNG->generate() * tgtDef.fOuterH ) - fOuterHalfH;
+         }
+         else if(cMath::abs(fy) > fOuterHalfH)
+         {
+            fRem = ::fmodf(cMath::abs(fy) - fOuterHalfH, fOuterHalfH);
+            if((fy - pfY[i]) > 0)
+               fy = -fOuterHalfH + fRem;
+            else
+               fy = fOuterHalfH - fRem;
+
+            fx = float( st.pDotRNG->generate() * tgtDef.fOuterW ) - fOuterHalfW;
+         }
+
+         pfX[i] = fx;
+         pfY[i] = fy;
+      }
+
+      // (3) compute per-dot alpha and interleave into the vertex attribute layout {x,y,Tx,Ty}.
+      // NOTE: We store each dot's alpha in the vertex attribute "Tx", which otherwise represents the X-coordinate of
+      // the texel location. We don't use an alpha texture with RMV_RANDOMDOTS. "Ty" is unused.
+#if defined(__SSE2__)
+      if(bFullBlk && bUseSIMD) for(int k = 0; k < DOTBLOCKSZ; k += 4)
+      {
+         __m128 x = _mm_loadu_ps(pfX + iBlk + k);
+         __m128 y = _mm_loadu_ps(pfY + iBlk + k);
+         __m128 a = computeAlphaPS(ap, x, y);
+         __m128 t = _mm_set1_ps(1.0f);
+         _MM_TRANSPOSE4_PS(x, y, a, t);
+         float* pfVtx = pfDots + 4*(iBlk + k);
+         _mm_storeu_ps(pfVtx, x);
+         _mm_storeu_ps(pfVtx + 4, y);
+         _mm_storeu_ps(pfVtx + 8, a);
+         _mm_storeu_ps(pfVtx + 12, t);
+      }
+      else
+#endif
+      for(int k = 0; k < nInBlk; k++)
+      {
+         int i = iBlk + k;
+         pfDots[4*i] = pfX[i];
+         pfDots[4*i+1] = pfY[i];
+         pfDots[4*i+2] = computeAlpha(ap, pfX[i], pfY[i]);
+         pfDots[4*i+3] = 1.0f;
+      }
+   }
+}
+
+/**
+ Pick a new random point within the rectangle bounding the aperture of a RMV_RANDOMDOTS target. By definition, the
+ coordinates are with respect to the target center. Units are visual degrees subtended at the eye.
+
+ @param tgtDef The target definition.
+ @param pRNG The random-number generator for randomizing dot positions.
+ @param x [out] horizontal coordinate of point.
+ @param y [out] vertical coordinate of point.
+*/
+void CRMVDotKernel::randomizeDotPos(const RMVTGTDEF& tgtDef, CRandomNG* pRNG, float& x, float& y)
+{
+   double dH = pRNG->generate();                                           // pick random coords in (0..1)
+   double dV = pRNG->generate();
+
+   dH = (dH-0.5) * tgtDef.fOuterW;                                         // map to dims of bounding rectangle
+   dV = (dV-0.5) * tgtDef.fOuterH;
+
+   x = float(dH);                                                          // return coords by reference
+   y = float(dV);
+}
+
+/**
+ Compute the parameters for the per-dot aperture/Gaussian alpha computation. They are constant for the life of the
+ target, but it's cheaper to recompute them once per frame than to store them.
+
+ @param tgtDef The target definition.
+ @param ap [out] The alpha parameters.
+*/
+void CRMVDotKernel::initAlphaParams(const RMVTGTDEF& tgtDef, AlphaParams& ap)
+{
+   float fOuterHalfW = tgtDef.fOuterW / 2.0f;
+   float fOuterHalfH = tgtDef.fOuterH / 2.0f;
+   float fInnerHalfW = tgtDef.fInnerW / 2.0f;
+   float fInnerHalfH = tgtDef.fInnerH / 2.0f;
+
+   ap.iAperture = tgtDef.iAperture;
+   ap.bDoGauss = (tgtDef.fSigma[0] > 0.0f || tgtDef.fSigma[1] > 0.0f);
+   ap.fInnerHalfW = fInnerHalfW;
+   ap.fInnerHalfH = fInnerHalfH;
+   ap.fInvASq = 1.0f / (fOuterHalfW*fOuterHalfW);
+   ap.fInvBSq = 1.0f / (fOuterHalfH*fOuterHalfH);
+   ap.fInvCSq = (tgtDef.iAperture == RMV_OVALANNU) ? 1.0f / (fInnerHalfW*fInnerHalfW) : 0.0f;
+   ap.fInvDSq = (tgtDef.iAperture == RMV_OVALANNU) ? 1.0f / (fInnerHalfH*fInnerHalfH) : 0.0f;
+   ap.fGaussX = (tgtDef.fSigma[0]>0.0f) ? float(-1.0/(2.0 * tgtDef.fSigma[0] * tgtDef.fSigma[0])) : 0.0f;
+   ap.fGaussY = (tgtDef.fSigma[1]>0.0f) ? float(-1.0/(2.0 * tgtDef.fSigma[1] * tgtDef.fSigma[1])) : 0.0f;
+}
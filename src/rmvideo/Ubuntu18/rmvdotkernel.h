@@ -0,0 +1,208 @@
+//=====================================================================================================================
+//
+// rmvdotkernel.h : Declaration of class CRMVDotKernel, the per-frame CPU update kernel for the RMV_RANDOMDOTS target.
+//
+//=====================================================================================================================
+
+
+#if !defined(RMVDOTKERNEL_H_INCLUDED_)
+#define RMVDOTKERNEL_H_INCLUDED_
+
+#if defined(__SSE2__)
+#include <emmintrin.h>                 // SSE2 intrinsics
+#endif
+#include "utilities.h"                 // utility classes
+#include "rmvideo_common.h"            // basic constants/definitions shared w/Maestro
+
+
+//=====================================================================================================================
+// Declaration of class CRMVDotKernel
+//
+// This class is not intended for instantiation. It holds the dot motion, recycling and aperture/Gaussian alpha code
+// for the RMV_RANDOMDOTS target, which CRMVTarget invokes once per frame. It has no dependence on OpenGL, so it can be
+// exercised by a standalone test (see rmvdotstest.cpp).
+//=====================================================================================================================
+
+class CRMVDotKernel
+{
+public:
+   // # dots processed per block in the fused update kernel
+   static const int DOTBLOCKSZ = 8;
+
+   // equivalence bounds, in ULP: expNonPositivePS() vs libm exp(); per-frame dot position (with per-dot noise) and
+   // Gaussian alpha A (per unit of |ln A|) vs the prior double-precision implementation. See update().
+   static const int EXPPS_MAXULP = 2;
+   static const int POSNOISE_MAXULP = 2;
+   static const int ALPHA_MAXULP = 4;
+
+   // the per-dot state of a RMV_RANDOMDOTS target. All buffers are owned by the target; the kernel only updates them.
+   struct DotState
+   {
+      int nDots;                          // number of dots
+      float* pfDots;                      // vertex attrs {x, y, Tx, Ty} per dot (the upload layout only)
+      float* pfX;                         // per-dot state in SoA lanes: X, Y, and displacement coefficients C, S
+      float* pfY;
+      float* pfC;
+      float* pfS;
+      float* pfDotNoise;                  // current per-dot noise factors (NULL if per-dot noise disabled)
+      float* pfDotLives;                  // current per-dot lifetimes (NULL if finite dotlife disabled)
+      float tUntilNoiseUpdate;            // time until per-dot noise factors are next updated, in ms
+      CRandomNG* pDotRNG;                 // for randomizing dot pos and coherence test
+      CRandomNG* pNoiseRNG;               // for per-dot noise factors (NULL if per-dot noise disabled)
+   };
+
+   // parameters for the per-dot aperture/Gaussian alpha computation
+   struct AlphaParams
+   {
+      int iAperture;                      // aperture shape
+      bool bDoGauss;                      // is the Gaussian window enabled?
+      float fInnerHalfW;                  // inner half-width, half-height (RMV_RECTANNU)
+      float fInnerHalfH;
+      float fInvASq;                      // 1/(outer half-width)^2, 1/(outer half-height)^2 (RMV_OVAL, _OVALANNU)
+      float fInvBSq;
+      float fInvCSq;                      // 1/(inner half-width)^2, 1/(inner half-height)^2 (RMV_OVALANNU)
+      float fInvDSq;
+      float fGaussX;                      // -1/(2*SX*SX) and -1/(2*SY*SY), or 0 if corresponding sigma is 0
+      float fGaussY;
+   };
+
+   // advance the dots by one frame. If !bUseSIMD, the scalar code path is used for all dots.
+   static void update(const RMVTGTDEF& tgtDef, float tElapsed, PRMVTGTVEC pVec, DotState& st, bool bUseSIMD = true);
+
+   // pick a random dot location within the rectangle bounding the target aperture
+   static void randomizeDotPos(const RMVTGTDEF& tgtDef, CRandomNG* pRNG, float& x, float& y);
+
+   // compute the aperture/Gaussian alpha parameters for a target
+   static void initAlphaParams(const RMVTGTDEF& tgtDef, AlphaParams& ap);
+
+   // per-dot alpha for the dot at (x,y): scalar reference version
+   static float computeAlpha(const AlphaParams& ap, float x, float y);
+
+#if defined(__SSE2__)
+   // SSE2 approximation of exp(x) for x <= 0, on 4 floats at once
+   static __m128 expNonPositivePS(__m128 x);
+
+   // SSE2 version of computeAlpha(), on 4 dots at once
+   static __m128 computeAlphaPS(const AlphaParams& ap, __m128 x, __m128 y);
+#endif
+};
+
+
+/**
+ Scalar version of the per-dot alpha computation for RMV_RANDOMDOTS: If the dot at (x,y) is outside the aperture,
+ A=0. Else A=exp( -[x*x/(2*SX*SX) + y*y/(2*SY*SY)] ) if the Gaussian window is enabled, or 1 otherwise. This is the
+ reference implementation for the SSE2 version, and it handles the trailing dots that don't fill a complete block.
+*/
+inline float CRMVDotKernel::computeAlpha(const AlphaParams& ap, float x, float y)
+{
+   bool isInside = true;
+   float xSq = x*x;
+   float ySq = y*y;
+   switch(ap.iAperture)
+   {
+      case RMV_RECTANNU :
+         isInside = (::fabsf(x) > ap.fInnerHalfW) || (::fabsf(y) > ap.fInnerHalfH);
+         break;
+      case RMV_OVAL :
+         isInside = (xSq*ap.fInvASq + ySq*ap.fInvBSq <= 1.0f);
+         break;
+      case RMV_OVALANNU :
+         isInside = (xSq*ap.fInvASq + ySq*ap.fInvBSq <= 1.0f) && (xSq*ap.fInvCSq + ySq*ap.fInvDSq > 1.0f);
+         break;
+      default :
+         break;
+   }
+
+   if(!isInside) return(0.0f);
+   if(!ap.bDoGauss) return(1.0f);
+   return((float) cMath::rangeLimit(::exp(double(xSq*ap.fGaussX + ySq*ap.fGaussY)), 0.0, 1.0));
+}
+
+#if defined(__SSE2__)
+/**
+ SSE2 approximation of exp(x) for x <= 0, evaluated on 4 floats at once. This is the classic Cephes expf() algorithm:
+ range reduction to x = n*ln(2) + r, with |r| <= ln(2)/2, followed by a degree-6 polynomial for exp(r) and scaling by
+ 2^n via the float exponent bits. Over [-87..0], the result is within EXPPS_MAXULP of the correctly rounded libm
+ result (verified by rmvdotstest). Arguments below -87 are clamped so 2^n never underflows the exponent field; the
+ result there is ~1e-38, which is indistinguishable from 0 for an alpha value.
+*/
+inline __m128 CRMVDotKernel::expNonPositivePS(__m128 x)
+{
+   const __m128 one = _mm_set1_ps(1.0f);
+   x = _mm_min_ps(x, _mm_setzero_ps());
+   x = _mm_max_ps(x, _mm_set1_ps(-87.0f));
+
+   // n = floor(x*log2(e) + 0.5)
+   __m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+   __m128 tmp = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+   fx = _mm_sub_ps(tmp, _mm_and_ps(_mm_cmpgt_ps(tmp, fx), one));
+
+   // r = x - n*ln(2), with ln(2) split in two parts for extra precision
+   x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(0.693359375f)));
+   x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(-2.12194440e-4f)));
+
+   __m128 z = _mm_mul_ps(x, x);
+   __m128 y = _mm_set1_ps(1.9875691500e-4f);
+   y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+   y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+   y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+   y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+   y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+   y = _mm_add_ps(_mm_mul_ps(y, z), _mm_add_ps(x, one));
+
+   // scale by 2^n
+   __m128i n = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(0x7f)), 23);
+   return(_mm_mul_ps(y, _mm_castsi128_ps(n)));
+}
+
+/**
+ SSE2 version of computeAlpha(), operating on 4 dots at once. Inside/outside tests are computed as lane masks rather
+ than branches, so the aperture shape costs the same regardless how many dots are inside. The masks are computed with
+ exactly the same single-precision operations as computeAlpha(), so both classify a given dot identically; only the
+ Gaussian differs, by at most EXPPS_MAXULP.
+*/
+inline __m128 CRMVDotKernel::computeAlphaPS(const AlphaParams& ap, __m128 x, __m128 y)
+{
+   const __m128 one = _mm_set1_ps(1.0f);
+   __m128 xSq = _mm_mul_ps(x, x);
+   __m128 ySq = _mm_mul_ps(y, y);
+
+   __m128 inside;
+   switch(ap.iAperture)
+   {
+      case RMV_RECTANNU :
+      {
+         const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+         inside = _mm_or_ps(_mm_cmpgt_ps(_mm_and_ps(x, absMask), _mm_set1_ps(ap.fInnerHalfW)),
+                            _mm_cmpgt_ps(_mm_and_ps(y, absMask), _mm_set1_ps(ap.fInnerHalfH)));
+         break;
+      }
+      case RMV_OVAL :
+         inside = _mm_cmple_ps(_mm_add_ps(_mm_mul_ps(xSq, _mm_set1_ps(ap.fInvASq)),
+                                          _mm_mul_ps(ySq, _mm_set1_ps(ap.fInvBSq))), one);
+         break;
+      case RMV_OVALANNU :
+         inside = _mm_and_ps(
+               _mm_cmple_ps(_mm_add_ps(_mm_mul_ps(xSq, _mm_set1_ps(ap.fInvASq)),
+                                       _mm_mul_ps(ySq, _mm_set1_ps(ap.fInvBSq))), one),
+               _mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(xSq, _mm_set1_ps(ap.fInvCSq)),
+                                       _mm_mul_ps(ySq, _mm_set1_ps(ap.fInvDSq))), one));
+         break;
+      default :
+         inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+         break;
+   }
+
+   __m128 a = one;
+   if(ap.bDoGauss)
+   {
+      a = expNonPositivePS(_mm_add_ps(_mm_mul_ps(xSq, _mm_set1_ps(ap.fGaussX)),
+                                      _mm_mul_ps(ySq, _mm_set1_ps(ap.fGaussY))));
+      a = _mm_min_ps(a, one);
+   }
+   return(_mm_and_ps(inside, a));
+}
+#endif   // defined(__SSE2__)
+
+
+#endif   // !defined(RMVDOTKERNEL_H_INCLUDED_)
@@ -0,0 +1,624 @@
+//=====================================================================================================================
+//
+// rmvdotstest.cpp : A standalone test of the RMV_RANDOMDOTS update kernel, CRMVDotKernel.  For testing only.
+//
+// AUTHOR:  saruffner.
+//
+// DESCRIPTION:
+// This program animates a set of RMV_RANDOMDOTS targets three times over, each time starting from the same seed: once
+// with the SSE2 path of CRMVDotKernel::update(), once with its scalar path, and once with a copy of the two-pass scalar
+// implementation that CRMVTarget::updateRandomDots() used before the fused SoA/SSE2 kernel was introduced. The test
+// targets cover every aperture shape, with and without the Gaussian window, each per-dot noise mode (direction,
+// additive speed, multiplicative log2 speed), coherence below 100%, finite dotlife in ms and in deg travelled, and
+// pattern motion WRT screen. The dot count is not a multiple of the kernel's block size, so the scalar tail of each
+// sweep is exercised as well.
+//
+// After every frame, the program checks the equivalence guarantees documented in CRMVDotKernel::update():
+//    1) SSE2 vs scalar path: dot positions and lifetimes are bit-for-bit identical; alpha is identically classified as
+// inside/outside the aperture, and the Gaussian alpha is within CRMVDotKernel::EXPPS_MAXULP.
+//    2) SSE2 path vs prior implementation: with no per-dot noise, dot positions are bit-for-bit identical. With noise,
+// each position is within CRMVDotKernel::POSNOISE_MAXULP of the prior result, measured in ULP of the aperture's outer
+// half-width (for x) or half-height (for y). To keep the per-frame error from accumulating, the prior implementation's
+// dot positions are then reset to the kernel's before the next frame.
+//    3) SSE2 path vs prior implementation: with the prior implementation's alpha computed at the kernel's dot
+// positions, the Gaussian alpha A is within CRMVDotKernel::ALPHA_MAXULP * max(1, |ln A|) ULP. A dot may be classified
+// differently only if it lies within ~1 ULP of an oval aperture boundary.
+// Alpha values below FLT_MIN are treated as 0 throughout, since expNonPositivePS() deliberately clamps its argument.
+//
+// Finally, CRMVDotKernel::expNonPositivePS() is compared against libm exp() over its entire domain [-87..0].
+//
+// USAGE:  ./rmvdotstest
+// Exits with status 0 if the test passes, 1 otherwise. The worst-case error observed for each target is reported.
+//
+// REVISION HISTORY:
+// 16oct2026-- Initial version, introduced when the RMV_RANDOMDOTS update kernel was moved to CRMVDotKernel.
+//=====================================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#include "rmvdotkernel.h"
+
+static const int NDOTS = 1003;                           // # dots per test target; NOT a multiple of DOTBLOCKSZ
+static const int NFRAMES = 300;                          // # of frame updates per test target
+static const float FRAMEPER = 1000.0f / 144.0f;          // frame period in ms
+
+// the noise modes
+static const int NOISE_NONE = 0;
+static const int NOISE_DIR = 1;
+static const int NOISE_SPDADD = 2;
+static const int NOISE_SPDLOG2 = 3;
+static const char* NOISENAMES[] = { "none", "dir", "speed", "log2speed" };
+static const char* APERNAMES[] = { "rect", "oval", "rectannu", "ovalannu" };
+
+//=====================================================================================================================
+// The prior implementation of CRMVTarget::updateRandomDots(), kept here as the reference. The only changes are that
+// the target state is passed in a RefState rather than being held in CRMVTarget members, the alpha computation is
+// split off into refDotAlpha(), and the vertex data upload is omitted.
+//=====================================================================================================================
+
+struct RefState
+{
+   float* pfDots;                                        // vertex attrs {x, y, Tx, Ty}; alpha is stored in Tx
+   float* pfDotNoise;
+   float* pfDotLives;
+   float tUntilNoiseUpdate;
+   CUniformRNG dotRNG;
+   CUniformRNG noiseRNG;
+};
+
+static void refMoveDots(const RMVTGTDEF& tgtDef, float tElapsed, PRMVTGTVEC pVec, RefState& r)
+{
+   // which special features, if any, are enabled?
+   bool bEnaCoherence = (tgtDef.iPctCoherent < 100);
+   bool bEnaNoise = (tgtDef.iNoiseUpdIntv > 0 && tgtDef.iNoiseLimit > 0);
+   bool bEnaDotLife = (tgtDef.fDotLife != 0.0f);
+
+   // pattern velocity in polar form
+   double dPatVecAmpl = 0.0;
+   double dPatVecTheta = 0.0;
+
+   // aperture outer half-width, half-height
+   float fOuterHalfW = tgtDef.fOuterW / 2.0f;
+   float fOuterHalfH = tgtDef.fOuterH / 2.0f;
+
+   // buffer pointers
+   float* pfDots = r.pfDots;
+   float* pfDotNoise = r.pfDotNoise;
+   float* pfDotLives = r.pfDotLives;
+
+   if(bEnaNoise)
+   {
+      dPatVecAmpl = ::sqrt(pVec->hPat * pVec->hPat + pVec->vPat * pVec->vPat);
+      dPatVecTheta = cMath::atan2Deg(pVec->vPat, pVec->hPat);
+      r.tUntilNoiseUpdate -= tElapsed;
+      if(r.tUntilNoiseUpdate <= 0.0f)
+      {
+         r.tUntilNoiseUpdate += float(tgtDef.iNoiseUpdIntv);
+         for(int i = 0; i < tgtDef.nDots; i++)
+         {
+            double dNoise = r.noiseRNG.generate();
+            dNoise *= 2.0 * double(tgtDef.iNoiseLimit);
+            dNoise -= double(tgtDef.iNoiseLimit);
+            pfDotNoise[i] = float(dNoise);
+         }
+      }
+   }
+
+   float fDotLifeDelta = 0.0f;
+   if(bEnaDotLife)
+   {
+      if(tgtDef.iFlags & RMV_F_LIFEINMS) fDotLifeDelta = tElapsed;
+      else fDotLifeDelta = ::sqrt(pVec->hPat * pVec->hPat + pVec->vPat * pVec->vPat);
+   }
+
+   int xyIndex = 0;
+   bool bIsDirNoise = bEnaNoise && ((tgtDef.iFlags & RMV_F_DIRNOISE) != 0);
+   bool bIsSpdLog2 = (!bIsDirNoise) && ((tgtDef.iFlags & RMV_F_SPDLOG2) != 0);
+   bool bWrtScreen = ((tgtDef.iFlags & RMV_F_WRTSCREEN) != 0);
+
+   double log2Fac = 1.0;
+   if(bIsSpdLog2)
+   {
+      log2Fac = pow(2.0, double(tgtDef.iNoiseLimit)) - pow(2.0, double(-tgtDef.iNoiseLimit));
+      log2Fac /= 2 * double(tgtDef.iNoiseLimit) * log(2.0);
+   }
+
+   for(int i = 0; i < tgtDef.nDots; i++)
+   {
+      bool bWasDotLocRandomized = false;
+      if(bEnaCoherence)
+      {
+         double dTest = r.dotRNG.generate() * 100.0;
+         if(dTest >= tgtDef.iPctCoherent)
+         {
+            bWasDotLocRandomized = true;
+            CRMVDotKernel::randomizeDotPos(tgtDef, &r.dotRNG, pfDots[xyIndex], pfDots[xyIndex+1]);
+         }
+      }
+
+      if(bEnaDotLife)
+      {
+         pfDotLives[i] -= fDotLifeDelta;
+         if(pfDotLives[i] < 0.0f)
+         {
+            pfDotLives[i] = tgtDef.fDotLife;
+            if(!bWasDotLocRandomized)
+            {
+               bWasDotLocRandomized = true;
+               CRMVDotKernel::randomizeDotPos(tgtDef, &r.dotRNG, pfDots[xyIndex], pfDots[xyIndex+1]);
+            }
+         }
+      }
+
+      if(!bWasDotLocRandomized)
+      {
+         float fx = pfDots[xyIndex];
+         float fy = pfDots[xyIndex+1];
+         if(!bEnaNoise)
+         {
+            fx += pVec->hPat;
+            fy += pVec->vPat;
+         }
+         else if(bIsDirNoise)
+         {
+            double dDir = dPatVecTheta + pfDotNoise[i];
+            fx += float( dPatVecAmpl * cMath::cosDeg(dDir) );
+            fy += float( dPatVecAmpl * cMath::sinDeg(dDir) );
+         }
+         else if(!bIsSpdLog2)
+         {
+            double dAmp = dPatVecAmpl * pfDotNoise[i] / 100.0f;
+            dAmp += dPatVecAmpl;
+            fx += float( dAmp * cMath::cosDeg(dPatVecTheta) );
+            fy += float( dAmp * cMath::sinDeg(dPatVecTheta) );
+         }
+         else
+         {
+            double dAmp = dPatVecAmpl*pow(2.0, pfDotNoise[i]);
+            dAmp /= log2Fac;
+            fx += float( dAmp * cMath::cosDeg(dPatVecTheta) );
+            fy += float( dAmp * cMath::sinDeg(dPatVecTheta) );
+         }
+
+         if(bWrtScreen)
+         {
+            fx -= pVec->hWin;
+            fy -= pVec->vWin;
+         }
+
+         float fRem;
+         if(cMath::abs(fx) > fOuterHalfW)
+         {
+            fRem = ::fmodf(cMath::abs(fx) - fOuterHalfW, fOuterHalfW);
+            if((fx - pfDots[xyIndex]) > 0)
+               fx = -fOuterHalfW + fRem;
+            else
+               fx = fOuterHalfW - fRem;
+
+            fy = float( r.dotRNG.generate() * tgtDef.fOuterH ) - fOuterHalfH;
+         }
+         else if(cMath::abs(fy) > fOuterHalfH)
+         {
+            fRem = ::fmodf(cMath::abs(fy) - fOuterHalfH, fOuterHalfH);
+            if((fy - pfDots[xyIndex+1]) > 0)
+               fy = -fOuterHalfH + fRem;
+            else
+               fy = fOuterHalfH - fRem;
+
+            fx = float( r.dotRNG.generate() * tgtDef.fOuterW ) - fOuterHalfW;
+         }
+
+         pfDots[xyIndex] = fx;
+         pfDots[xyIndex+1] = fy;
+      }
+
+      xyIndex += 4;
+   }
+}
+
+static void refDotAlpha(const RMVTGTDEF& tgtDef, RefState& r)
+{
+   float fOuterHalfW = tgtDef.fOuterW / 2.0f;
+   float fOuterHalfH = tgtDef.fOuterH / 2.0f;
+   float fInnerHalfW = tgtDef.fInnerW / 2.0f;
+   float fInnerHalfH = tgtDef.fInnerH / 2.0f;
+   float* pfDots = r.pfDots;
+
+   double dInvTwoSigSqX = (tgtDef.fSigma[0]>0.0f) ? -1.0/(2.0 * tgtDef.fSigma[0] * tgtDef.fSigma[0]) : 0.0f;
+   double dInvTwoSigSqY = (tgtDef.fSigma[1]>0.0f) ? -1.0/(2.0 * tgtDef.fSigma[1] * tgtDef.fSigma[1]) : 0.0f;
+   bool bDoGauss = (tgtDef.fSigma[0] > 0.0f || tgtDef.fSigma[1] > 0.0f);
+   double dASq = fOuterHalfW*fOuterHalfW;
+   double dBSq = fOuterHalfH*fOuterHalfH;
+   double dCSq = fInnerHalfW*fInnerHalfW;
+   double dDSq = fInnerHalfH*fInnerHalfH;
+   if(tgtDef.iAperture != RMV_RECT || bDoGauss) for( int i=0; i<tgtDef.nDots; i++ )
+   {
+      double x = pfDots[4*i];
+      double y = pfDots[4*i+1];
+
+      bool isInside = false;
+      switch( tgtDef.iAperture )
+      {
+         case RMV_RECT :
+            isInside = true;
+            break;
+         case RMV_RECTANNU :
+            if((fabs(x)>fInnerHalfW) || (fabs(y)>fInnerHalfH))
+               isInside = true;
+            break;
+         case RMV_OVAL :
+            if( x*x/dASq + y*y/dBSq <= 1.0 )
+               isInside = true;
+            break;
+         case RMV_OVALANNU :
+            if( (x*x/dASq + y*y/dBSq <= 1.0) && (x*x/dCSq + y*y/dDSq > 1.0) )
+               isInside = true;
+            break;
+      }
+
+      if(!isInside) pfDots[4*i+2] = 0.0f;
+      else if(!bDoGauss) pfDots[4*i+2] = 1.0f;
+      else pfDots[4*i+2] = (float) cMath::rangeLimit(exp(x*x*dInvTwoSigSqX + y*y*dInvTwoSigSqY), 0.0, 1.0);
+   }
+}
+
+//=====================================================================================================================
+// Test support
+//=====================================================================================================================
+
+// the kernel's per-dot state and its buffers; mirrors what CRMVTarget::prepare() allocates and initializes
+struct KernelTarget
+{
+   CRMVDotKernel::DotState st;
+   float* pfLanes;
+   CUniformRNG dotRNG;
+   CUniformRNG noiseRNG;
+};
+
+// distance between two finite floats of the same sign, in ULP
+static unsigned int ulpDiff(float a, float b)
+{
+   int ia, ib;
+   memcpy(&ia, &a, sizeof(float));
+   memcpy(&ib, &b, sizeof(float));
+   return( (unsigned int) ((ia > ib) ? (ia - ib) : (ib - ia)) );
+}
+
+// the ULP of a positive float f: the gap between f and the next larger float
+static float ulpOf(float f)
+{
+   return( ::nextafterf(f, FLT_MAX) - f );
+}
+
+// distance between two alpha values in ULP, where values below FLT_MIN are taken as 0. Returns -1 if exactly one of
+// them is (effectively) 0, ie, they were classified differently.
+static int alphaDiff(float a, float b)
+{
+   if(a < FLT_MIN) a = 0.0f;
+   if(b < FLT_MIN) b = 0.0f;
+   if(a == b) return(0);
+   if(a == 0.0f || b == 0.0f) return(-1);
+   return( int(ulpDiff(a, b)) );
+}
+
+// the dot at (x,y) lies within ~1 ULP of an oval aperture's outer or inner boundary
+static bool isOnOvalBoundary(const RMVTGTDEF& tgtDef, float x, float y)
+{
+   if(tgtDef.iAperture != RMV_OVAL && tgtDef.iAperture != RMV_OVALANNU) return(false);
+   double a = tgtDef.fOuterW / 2.0, b = tgtDef.fOuterH / 2.0;
+   double q = double(x)*x/(a*a) + double(y)*y/(b*b);
+   if(::fabs(q - 1.0) < 4.0*FLT_EPSILON) return(true);
+   if(tgtDef.iAperture != RMV_OVALANNU) return(false);
+   a = tgtDef.fInnerW / 2.0;
+   b = tgtDef.fInnerH / 2.0;
+   q = double(x)*x/(a*a) + double(y)*y/(b*b);
+   return(::fabs(q - 1.0) < 4.0*FLT_EPSILON);
+}
+
+// the test target definition
+static void getTestTarget(int iAper, bool bGauss, int noise, bool bExtras, RMVTGTDEF& tgtDef)
+{
+   memset(&tgtDef, 0, sizeof(RMVTGTDEF));
+   tgtDef.iType = RMV_RANDOMDOTS;
+   tgtDef.iAperture = iAper;
+   tgtDef.fOuterW = 10.0f;
+   tgtDef.fOuterH = 7.5f;
+   tgtDef.fInnerW = 4.0f;
+   tgtDef.fInnerH = 3.0f;
+   tgtDef.nDots = NDOTS;
+   tgtDef.nDotSize = 2;
+   tgtDef.iSeed = 8675309 + 37*iAper + 11*noise + (bGauss ? 5 : 0) + (bExtras ? 3 : 0);
+   tgtDef.iPctCoherent = 100;
+   if(bGauss)
+   {
+      tgtDef.fSigma[0] = 2.5f;
+      tgtDef.fSigma[1] = 1.5f;
+   }
+
+   if(noise != NOISE_NONE)
+   {
+      tgtDef.iNoiseUpdIntv = 50;
+      if(noise == NOISE_DIR) { tgtDef.iFlags |= RMV_F_DIRNOISE; tgtDef.iNoiseLimit = 90; }
+      else if(noise == NOISE_SPDADD) tgtDef.iNoiseLimit = 60;
+      else { tgtDef.iFlags |= RMV_F_SPDLOG2; tgtDef.iNoiseLimit = 3; }
+   }
+
+   // the "extras": coherence < 100%, finite dotlife (in ms for half the targets, deg travelled for the rest), and
+   // pattern motion WRT screen
+   if(bExtras)
+   {
+      tgtDef.iPctCoherent = 70;
+      tgtDef.fDotLife = ((iAper + noise) % 2 == 0) ? 120.0f : 1.5f;
+      if((iAper + noise) % 2 == 0) tgtDef.iFlags |= RMV_F_LIFEINMS;
+      tgtDef.iFlags |= RMV_F_WRTSCREEN;
+   }
+}
+
+// the test motion vector for the specified frame: pattern velocity varies in speed and direction
+static void getTestVector(int frame, RMVTGTVEC& vec)
+{
+   vec.bOn = 1;
+   vec.hWin = 0.03f;
+   vec.vWin = -0.02f;
+   vec.hPat = float(0.15 * ::cos(frame * 0.05));
+   vec.vPat = float(0.11 * ::sin(frame * 0.037) + 0.02);
+}
+
+// allocate and initialize the kernel's dot state as CRMVTarget::prepare() does
+static void initKernelTarget(const RMVTGTDEF& tgtDef, KernelTarget& t)
+{
+   int n = tgtDef.nDots;
+   bool bEnaNoise = (tgtDef.iNoiseUpdIntv > 0 && tgtDef.iNoiseLimit > 0);
+   bool bEnaDotLife = (tgtDef.fDotLife != 0.0f);
+
+   t.pfLanes = new float[n*4];
+   t.st.nDots = n;
+   t.st.pfDots = new float[n*4];
+   t.st.pfX = t.pfLanes;
+   t.st.pfY = t.st.pfX + n;
+   t.st.pfC = t.st.pfY + n;
+   t.st.pfS = t.st.pfC + n;
+   t.st.pfDotNoise = bEnaNoise ? new float[n] : NULL;
+   t.st.pfDotLives = bEnaDotLife ? new float[n] : NULL;
+   t.st.tUntilNoiseUpdate = 0.0f;
+   t.st.pDotRNG = &t.dotRNG;
+   t.st.pNoiseRNG = bEnaNoise ? &t.noiseRNG : NULL;
+
+   t.dotRNG.setSeed(tgtDef.iSeed);
+   t.noiseRNG.setSeed(tgtDef.iSeed);
+   for(int i = 0; i < n; i++)
+   {
+      CRMVDotKernel::randomizeDotPos(tgtDef, &t.dotRNG, t.st.pfX[i], t.st.pfY[i]);
+      t.st.pfC[i] = 1.0f;
+      t.st.pfS[i] = 0.0f;
+      t.st.pfDots[i*4] = t.st.pfX[i];
+      t.st.pfDots[i*4 + 1] = t.st.pfY[i];
+      t.st.pfDots[i*4 + 2] = t.st.pfDots[i*4 + 3] = 1.0f;
+   }
+   if(bEnaDotLife) for(int i = 0; i < n; i++)
+      t.st.pfDotLives[i] = float(t.dotRNG.generate() * tgtDef.fDotLife);
+}
+
+static void freeKernelTarget(KernelTarget& t)
+{
+   delete [] t.pfLanes;
+   delete [] t.st.pfDots;
+   if(t.st.pfDotNoise != NULL) delete [] t.st.pfDotNoise;
+   if(t.st.pfDotLives != NULL) delete [] t.st.pfDotLives;
+}
+
+// initialize the reference state from a freshly initialized kernel target, which consumed the same random numbers
+static void initRefState(const RMVTGTDEF& tgtDef, const KernelTarget& t, RefState& r)
+{
+   int n = tgtDef.nDots;
+   r.pfDots = new float[n*4];
+   memcpy(r.pfDots, t.st.pfDots, n*4*sizeof(float));
+   r.pfDotNoise = (t.st.pfDotNoise != NULL) ? new float[n] : NULL;
+   r.pfDotLives = NULL;
+   if(t.st.pfDotLives != NULL)
+   {
+      r.pfDotLives = new float[n];
+      memcpy(r.pfDotLives, t.st.pfDotLives, n*sizeof(float));
+   }
+   r.tUntilNoiseUpdate = 0.0f;
+   r.dotRNG = t.dotRNG;
+   r.noiseRNG = t.noiseRNG;
+}
+
+static void freeRefState(RefState& r)
+{
+   delete [] r.pfDots;
+   if(r.pfDotNoise != NULL) delete [] r.pfDotNoise;
+   if(r.pfDotLives != NULL) delete [] r.pfDotLives;
+}
+
+//=====================================================================================================================
+// The tests
+//=====================================================================================================================
+
+// animate one test target with the kernel's SSE2 path, its scalar path and the prior implementation, checking the
+// equivalence guarantees after every frame. Returns the number of failed checks.
+static int testTarget(int iAper, bool bGauss, int noise, bool bExtras)
+{
+   RMVTGTDEF tgtDef;
+   getTestTarget(iAper, bGauss, noise, bExtras, tgtDef);
+   int n = tgtDef.nDots;
+
+   KernelTarget simd, scalar;
+   RefState ref;
+   initKernelTarget(tgtDef, simd);
+   initKernelTarget(tgtDef, scalar);
+   initRefState(tgtDef, simd, ref);
+
+   float fUlpX = ulpOf(tgtDef.fOuterW / 2.0f);
+   float fUlpY = ulpOf(tgtDef.fOuterH / 2.0f);
+   int nErrs = 0;
+   int maxAlphaUlpScalar = 0;
+   double maxAlphaRef = 0.0;
+   double maxPosUlpRef = 0.0;
+   int nBoundary = 0;
+
+   for(int f = 0; f < NFRAMES && nErrs < 10; f++)
+   {
+      RMVTGTVEC vec;
+      getTestVector(f, vec);
+      CRMVDotKernel::update(tgtDef, FRAMEPER, &vec, simd.st, true);
+      CRMVDotKernel::update(tgtDef, FRAMEPER, &vec, scalar.st, false);
+      refMoveDots(tgtDef, FRAMEPER, &vec, ref);
+
+      // SSE2 vs scalar path: identical positions and lifetimes; alpha identically classified, and Gaussian alpha within
+      // the expNonPositivePS() error bound
+      if(memcmp(simd.pfLanes, scalar.pfLanes, 2*n*sizeof(float)) != 0 ||
+         (simd.st.pfDotLives != NULL && memcmp(simd.st.pfDotLives, scalar.st.pfDotLives, n*sizeof(float)) != 0))
+      {
+         fprintf(stderr, "  frame %d: SSE2 and scalar dot positions or lifetimes differ\n", f);
+         ++nErrs;
+      }
+      for(int i = 0; i < n; i++)
+      {
+         int d = alphaDiff(simd.st.pfDots[4*i+2], scalar.st.pfDots[4*i+2]);
+         if(d < 0 || d > CRMVDotKernel::EXPPS_MAXULP)
+         {
+            fprintf(stderr, "  frame %d, dot %d: SSE2 alpha=%.9g, scalar alpha=%.9g\n", f, i,
+                    simd.st.pfDots[4*i+2], scalar.st.pfDots[4*i+2]);
+            ++nErrs;
+            break;
+         }
+         if(d > maxAlphaUlpScalar) maxAlphaUlpScalar = d;
+      }
+
+      // SSE2 path vs prior implementation: dot positions
+      for(int i = 0; i < n; i++)
+      {
+         float x = simd.st.pfX[i], y = simd.st.pfY[i];
+         float xRef = ref.pfDots[4*i], yRef = ref.pfDots[4*i+1];
+         if(noise == NOISE_NONE)
+         {
+            if(x != xRef || y != yRef)
+            {
+               fprintf(stderr, "  frame %d, dot %d: (%.9g, %.9g) != prior (%.9g, %.9g)\n", f, i, x, y, xRef, yRef);
+               ++nErrs;
+               break;
+            }
+         }
+         else
+         {
+            double dUlp = cMath::max(::fabs(double(x) - xRef) / fUlpX, ::fabs(double(y) - yRef) / fUlpY);
+            if(dUlp > CRMVDotKernel::POSNOISE_MAXULP)
+            {
+               fprintf(stderr, "  frame %d, dot %d: (%.9g, %.9g) vs prior (%.9g, %.9g) -- %.1f ULP\n", f, i, x, y,
+                       xRef, yRef, dUlp);
+               ++nErrs;
+               break;
+            }
+            if(dUlp > maxPosUlpRef) maxPosUlpRef = dUlp;
+         }
+         if(ref.pfDotLives != NULL && ref.pfDotLives[i] != simd.st.pfDotLives[i])
+         {
+            fprintf(stderr, "  frame %d, dot %d: dot lifetime differs from prior\n", f, i);
+            ++nErrs;
+            break;
+         }
+      }
+
+      // SSE2 path vs prior implementation: alpha, computed at the kernel's dot positions
+      for(int i = 0; i < n; i++)
+      {
+         ref.pfDots[4*i] = simd.st.pfX[i];
+         ref.pfDots[4*i+1] = simd.st.pfY[i];
+      }
+      refDotAlpha(tgtDef, ref);
+      for(int i = 0; i < n; i++)
+      {
+         int d = alphaDiff(simd.st.pfDots[4*i+2], ref.pfDots[4*i+2]);
+         if(d < 0 && isOnOvalBoundary(tgtDef, simd.st.pfX[i], simd.st.pfY[i]))
+         {
+            ++nBoundary;
+            continue;
+         }
+         double dLimit = CRMVDotKernel::ALPHA_MAXULP * cMath::max(1.0, -::log(double(ref.pfDots[4*i+2])));
+         if(d < 0 || d > dLimit)
+         {
+            fprintf(stderr, "  frame %d, dot %d at (%.9g, %.9g): alpha=%.9g, prior alpha=%.9g\n", f, i,
+                    simd.st.pfX[i], simd.st.pfY[i], simd.st.pfDots[4*i+2], ref.pfDots[4*i+2]);
+            ++nErrs;
+            break;
+         }
+         if(d / dLimit > maxAlphaRef) maxAlphaRef = d / dLimit;
+      }
+   }
+
+   printf("%-8s %-5s noise=%-9s %-6s: alpha vs scalar %d ULP; vs prior: pos %.0f ULP, alpha %.2f of limit, "
+          "%d on boundary%s\n", APERNAMES[iAper], bGauss ? "gauss" : "", NOISENAMES[noise], bExtras ? "extras" : "",
+          maxAlphaUlpScalar, maxPosUlpRef, maxAlphaRef, nBoundary, (nErrs > 0) ? " -- FAILED" : "");
+
+   freeKernelTarget(simd);
+   freeKernelTarget(scalar);
+   freeRefState(ref);
+   return(nErrs);
+}
+
+// compare expNonPositivePS() against libm exp() over [-87..0], sampling every 16th float, plus the clamped region.
+// Returns the number of failed checks.
+static int testExp()
+{
+#if defined(__SSE2__)
+   unsigned int maxUlp = 0;
+   float fWorst = 0.0f;
+   int nErrs = 0;
+   float fLimit = -87.0f;
+   unsigned int uLimit;
+   memcpy(&uLimit, &fLimit, sizeof(float));
+
+   float in[4], out[4];
+   int nIn = 0;
+   for(unsigned int u = 0x80000000u; u <= uLimit; u += 16)
+   {
+      memcpy(&in[nIn++], &u, sizeof(float));
+      if(nIn < 4 && u + 16 <= uLimit) continue;
+      _mm_storeu_ps(out, CRMVDotKernel::expNonPositivePS(_mm_loadu_ps(in)));
+      for(int k = 0; k < nIn; k++)
+      {
+         unsigned int d = ulpDiff(out[k], float(::exp(double(in[k]))));
+         if(d > maxUlp) { maxUlp = d; fWorst = in[k]; }
+      }
+      nIn = 0;
+   }
+   if(maxUlp > (unsigned int) CRMVDotKernel::EXPPS_MAXULP) ++nErrs;
+
+   // below -87 the argument is clamped: the result must be positive, but no more than exp(-87)
+   float fClamp = float(::exp(-87.0));
+   float clamped[4] = { -87.5f, -100.0f, -1.0e4f, -FLT_MAX };
+   _mm_storeu_ps(out, CRMVDotKernel::expNonPositivePS(_mm_loadu_ps(clamped)));
+   for(int k = 0; k < 4; k++) if(!(out[k] > 0.0f && out[k] <= fClamp)) ++nErrs;
+
+   // positive arguments are clamped to 0
+   float pos[4] = { 0.0f, FLT_MIN, 1.0f, 100.0f };
+   _mm_storeu_ps(out, CRMVDotKernel::expNonPositivePS(_mm_loadu_ps(pos)));
+   for(int k = 0; k < 4; k++) if(out[k] != 1.0f) ++nErrs;
+
+   printf("expNonPositivePS vs libm exp over [-87..0]: max error %u ULP (at x=%.9g)%s\n", maxUlp, fWorst,
+          (nErrs > 0) ? " -- FAILED" : "");
+   return(nErrs);
+#else
+   printf("expNonPositivePS: SSE2 not available, test skipped\n");
+   return(0);
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+   int nErrs = testExp();
+   for(int iAper = RMV_RECT; iAper <= RMV_OVALANNU; iAper++)
+      for(int g = 0; g < 2; g++)
+         for(int noise = NOISE_NONE; noise <= NOISE_SPDLOG2; noise++)
+            for(int x = 0; x < 2; x++)
+               nErrs += testTarget(iAper, g != 0, noise, x != 0);
+
+   printf("%s\n", (nErrs == 0) ? "PASSED" : "FAILED");
+   return((nErrs == 0) ? 0 : 1);
+}
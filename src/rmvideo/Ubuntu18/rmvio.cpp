@@ -80,9 +80,18 @@
 // same flag to request the flash start on any subsequent frame. RMVIo implementations already must process these 
 // commands to get the motion update vectors for each animation frame; they must be updated to get the sync flash
 // request flag and expose its value via isSyncFlashRequested().
+// 16oct2026-- Added waitForCommand(), which CRMVDisplay calls between polls for the next command rather than sleeping
+// for a fixed interval, and getCommandLatencyStats() in support of RMV_CMD_GETCMDLATENCY. Both have default 
+// implementations here, so implementing classes need only override them if they can do better.
+// 16oct2026-- Added downloadFileWindowed() for the windowed, resumable file transfer initiated by RMV_CMD_PUTFILEX. The
+// int arguments of RMV_CMD_PUTFILEX (file size and content hash) are available via getCommandArg(). The default
+// implementation fails the transfer; it need only be overridden by implementations that deliver RMV_CMD_PUTFILEX.
 //=====================================================================================================================
 
 
+#include <unistd.h>
+#include <string.h>
+
 #include "rmvio.h"
 
 //=== init ============================================================================================================
@@ -156,11 +165,46 @@
 //
 //int getNextCommand();
 
+//=== waitForCommand ==================================================================================================
+//
+//    Wait until a command from Maestro may be available, or until the specified time has elapsed, whichever comes
+//    first. CRMVDisplay calls this method between calls to getNextCommand() in the idle state, and -- if the renderer's
+//    late-latch mode is enabled -- while waiting for a late RMV_CMD_UPDATEFRAME during an animation sequence. It does
+//    NOT retrieve the command; the caller must still call getNextCommand(). Implementations that can be notified when
+//    a command arrives should override this method so that the command is retrieved as soon as possible.
+//
+//    The default implementation simply sleeps for the specified time.
+//
+//    ARGS:       maxUS -- [in] The maximum time to wait, in microseconds. If non-positive, the method returns at once.
+//    RETURNS:    True if a command may be available; false if the wait timed out and no command has arrived. The
+//                default implementation always returns true.
+//
+bool CRMVIo::waitForCommand(int maxUS)
+{
+   if(maxUS > 0) ::usleep(maxUS);
+   return(true);
+}
+
+//=== getCommandLatencyStats ==========================================================================================
+//
+//    Report statistics on the latency between the arrival of each Maestro command and its retrieval via 
+//    getNextCommand(), IAW the reply format specified for RMV_CMD_GETCMDLATENCY. 
+//
+//    The default implementation does not timestamp commands as they arrive, so it reports all zeros.
+//
+//    ARGS:       pStats -- [out] Must have room for RMV_CMDLATENCY_LEN integers.
+//    RETURNS:    NONE.
+//
+void CRMVIo::getCommandLatencyStats(int* pStats)
+{
+   ::memset(pStats, 0, RMV_CMDLATENCY_LEN * sizeof(int));
+}
+
 //=== getCommandArg ===================================================================================================
 //
 //    Retrieve one of the 32-bit integer arguments accompanying the most recent command. CRMVDisplay will only invoke
 //    this method immediately after retrieving one of these commands (all of which have a short list of int args):
-//    RMV_CMD_RESTART, _SETBKGCOLOR, _SETGEOMETRY, _SETGAMMA, _SETSYNC, and _SETCURRVIDEOMODE.
+//    RMV_CMD_RESTART, _SETBKGCOLOR, _SETGEOMETRY, _SETGAMMA, _SETSYNC, _SETCURRVIDEOMODE, and _PUTFILEX.
 //
 //    ARGS:       pos -- [in] The ordinal position of the command argument requested.
 //    RETURNS:    The argument requested; -1 if invalid request (not relevant to last command or invalid arg pos).
@@ -281,6 +325,35 @@
 //
 //bool downloadFile(FILE* fd);
 
+//=== downloadFileWindowed ============================================================================================
+//
+//    Like downloadFile(), but for the windowed transfer initiated by RMV_CMD_PUTFILEX (see RMVIDEO_COMMON.H). The 
+//    file chunks are processed and acknowledged in the same way, but Maestro does not wait for each acknowledgement
+//    before sending the next chunk. So, if a chunk cannot be processed, send RMV_SIG_CMDERR once and then discard all
+//    remaining chunks until RMV_CMD_PUTFILEDONE arrives, replying RMV_SIG_CMDERR to that command as well. Any other 
+//    command terminates the download immediately with RMV_SIG_CMDERR. Regardless the outcome, close the file before
+//    returning.
+//
+//    If the connection to Maestro is lost during the transfer, set the bLinkLost flag. The caller keeps the bytes
+//    received so far in that case, so that the transfer can be resumed later.
+//
+//    The default implementation closes the file, sends RMV_SIG_CMDERR and fails. Only implementations that deliver 
+//    the RMV_CMD_PUTFILEX command to CRMVDisplay need override it.
+//
+//    ARGS:       fd -- File descriptor of the open file to which the transferred content should be appended. This
+//                file descriptor must be closed upon returning from this method.
+//                bLinkLost -- [out] Set if the transfer failed because the connection to Maestro was lost.
+//    RETURNS:    True if file transfer completed successfully, in which case Maestro is still waiting for a response 
+//                to the RMV_CMD_PUTFILEDONE command. False if an error occurred or if Maestro cancelled the transfer.
+//
+bool CRMVIo::downloadFileWindowed(FILE* fd, bool& bLinkLost)
+{
+   bLinkLost = false;
+   if(fd != NULL) ::fclose(fd);
+   sendSignal(RMV_SIG_CMDERR);
+   return(false);
+}
+
 //=== sendData ========================================================================================================
 //
 //    CRMVDisplay invokes this method to send command replies or signals back to Maestro. Most replies and all signals
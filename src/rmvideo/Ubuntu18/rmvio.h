@@ -24,6 +24,8 @@ public:
    virtual void closeSession() = 0;                               // issue RMV_SIG_BYE, then close connex w/Maestro
 
    virtual int getNextCommand() = 0;                              // get next command from Maestro, if any
+   virtual bool waitForCommand(int maxUS);                        // wait (up to maxUS) for a command to arrive
+   virtual void getCommandLatencyStats(int* pStats);              // command receive-to-retrieval latency statistics
    virtual int getCommandArg(int pos) = 0;                        // to retrieve 32-bit int arguments of selected cmds
    
    virtual int getNumTargets() = 0;                               // get # of target defns in "load targets" cmd
@@ -35,6 +37,7 @@ public:
    virtual const char* getMediaFolder() = 0;                      // get media folder name from selected commands
    virtual const char* getMediaFile() = 0;                        // get media file name from selected commands
    virtual bool downloadFile(FILE* fd) = 0;                       // download a file over the communication interface
+   virtual bool downloadFileWindowed(FILE* fd, bool& bLinkLost);  // same, for windowed transfer (RMV_CMD_PUTFILEX)
    
    virtual void sendData(int len, int* pPayload) = 0;             // send information back to Maestro
    void sendSignal(int sig);                                      // send a 32-bit signal to Maestro
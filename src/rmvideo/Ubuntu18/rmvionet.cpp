@@ -44,6 +44,20 @@
 //             included with the _STARTANIMATE and _UPDATEFRAME commands.
 // 08may2019-- Updated parseLoadTargets() to handle new RMVTGTDEF parameters defining the new "flicker" feature.
 // 11dec2024-- Updated parseLoadTargets() to handle new parameter RMVTGTDEF.fDotDisp.
+// 16oct2026-- Adding support for RMV_CMD_GETFRAMESTATS.
+// 16oct2026-- Adding support for RMV_CMD_GETIMGCACHESTATS.
+// 16oct2026-- Added optional event-driven mode (see setEventDrivenMode()). Rather than polling the session socket each
+//             time the display thread asks for the next command, a dedicated receive thread blocks in epoll_wait() on
+//             the socket, reads each command as soon as it arrives, timestamps it, and appends it to a lock-free
+//             single-producer, single-consumer queue. The display thread dequeues commands without any system calls,
+//             and can block in waitForCommand() until a command arrives instead of sleeping for a fixed interval. The 
+//             receive-to-retrieval latency is reported by the new command RMV_CMD_GETCMDLATENCY.
+// 16oct2026-- Adding support for RMV_CMD_UPDATEFRAMEC, the compact encoding of RMV_CMD_UPDATEFRAME introduced in
+//             RMVideo v12. It is reported to CRMVDisplay as RMV_CMD_UPDATEFRAME. Also added setNetworkAddresses() so
+//             that a test client can run a command session over the loopback interface (see rmvnettest.cpp).
+// 16oct2026-- Adding support for RMV_CMD_PUTFILEX (RMVideo v13), which initiates a windowed file transfer handled by
+//             downloadFileWindowed(). Its file size and content hash are exposed via getCommandArg(), which now
+//             supports up to MAXCMDARGS arguments.
 //=====================================================================================================================
 
 #include <unistd.h>
@@ -57,6 +71,11 @@
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 #include "rmvionet.h"
 
@@ -65,9 +84,7 @@ const int CRMVIoNet::DEF_RAWBUFGROWSZ = 2048;                    // default and
 
 CRMVIoNet::CRMVIoNet()
 {
-   m_args[0] = -1;
-   m_args[1] = -1;
-   m_args[2] = -1;
+   for(int i=0; i<MAXCMDARGS; i++) m_args[i] = -1;
 
    for(int i=0;i<RMV_MVF_LEN+1; i++)
    {
@@ -84,11 +101,29 @@ CRMVIoNet::CRMVIoNet()
    m_bSyncFlashRequested = false;
 
    m_sessionSocket = -1;
+   setNetworkAddresses(RMVNET_RMVADDR, RMVNET_MAESTROADDR);
 
    m_pRcvBuf = NULL;
    m_iRcvBufSize = 0;
    m_iRcvLenBytes = 0;
 
+   m_bEventDriven = false;
+   m_bBusyPoll = false;
+   for(int i=0; i<CMDQSZ; i++)
+   {
+      m_cmdQ[i].pBuf = NULL;
+      m_cmdQ[i].bufSize = 0;
+      m_cmdQ[i].len = 0;
+      m_cmdQ[i].tRcvUS = 0;
+   }
+   m_nQueued = 0;
+   m_nDequeued = 0;
+   m_bRcvFailed = false;
+   m_bRcvThreadOn = false;
+   m_epollFD = -1;
+   m_cmdEventFD = -1;
+   m_stopEventFD = -1;
+   resetLatencyStats();
 }
 
 CRMVIoNet::~CRMVIoNet()
@@ -226,7 +261,7 @@ bool CRMVIoNet::openSession()
    memset( &listenAddr, 0, sizeof(struct sockaddr_in) );
    listenAddr.sin_family = AF_INET;
    listenAddr.sin_port = htons(RMVNET_RMVPORT);
-   listenAddr.sin_addr.s_addr = inet_addr(RMVNET_RMVADDR);
+   listenAddr.sin_addr.s_addr = inet_addr(m_strRMVAddr);
    if( 0 > bind(listenSocket, (struct sockaddr *) &listenAddr, sizeof(struct sockaddr)) )
    {
       perror("RMVideo(IONet) bind");
@@ -269,7 +304,7 @@ bool CRMVIoNet::openSession()
    // ok, we've established a connection.  Close our listening socket.  Then verify that the client's IP address is
    // what we expect.  If not, fail.
    close(listenSocket);
-   if( strcmp(RMVNET_MAESTROADDR, inet_ntoa(clientAddr.sin_addr)) != 0 )
+   if( strcmp(m_strMaestroAddr, inet_ntoa(clientAddr.sin_addr)) != 0 )
    {
       fprintf( stderr, "RMVideo(IONet): Got connection from unexpected host (%s)\n", inet_ntoa(clientAddr.sin_addr) );
       close(gotSocket);
@@ -296,10 +331,23 @@ bool CRMVIoNet::openSession()
       return(false);
    }
 
-   // the accepted socket becomes our session socket.  Now all we have to do is wait for the RMV_CMD_STARTINGUP command
-   // from the Maestro client.  If this is NOT the first command we get, or if we do not get it within 10 seconds, then
+   // in busy-poll mode, ask the kernel to busy-poll the device queue for incoming packets on a blocking receive. This
+   // requires CAP_NET_ADMIN if the requested timeout exceeds the system default, so failure is not fatal.
+   if( m_bBusyPoll )
+   {
+      int busyPollUS = 50;
+      if( 0 > setsockopt(gotSocket, SOL_SOCKET, SO_BUSY_POLL, &busyPollUS, sizeof(int)) )
+         perror("RMVideo(IONet) setsockopt(SO_BUSY_POLL) -- ignored");
+   }
+
+   // the accepted socket becomes our session socket.  In event-driven mode, start the receive thread; if that fails, 
+   // we fall back to polling the socket.  Now all we have to do is wait for the RMV_CMD_STARTINGUP command from the
+   // Maestro client.  If this is NOT the first command we get, or if we do not get it within 10 seconds, then
    // something is VERY wrong.
    m_sessionSocket = gotSocket;
+   resetLatencyStats();
+   if( m_bEventDriven && !startReceiver() )
+      fprintf(stderr, "RMVideo(IONet): Unable to start command receive thread; polling session socket instead.\n");
    int command = RMV_CMD_NONE;
    int nTries = 0;
    while( (command == RMV_CMD_NONE) && (nTries < 1000) )
@@ -311,6 +359,7 @@ bool CRMVIoNet::openSession()
    if( command != RMV_CMD_STARTINGUP )
    {
       fprintf(stderr, "RMVideo(IONet): Did not get 'starting up' message from Maestro client!\n");
+      stopReceiver();
       close(m_sessionSocket);
       m_sessionSocket = -1;
       return(false);
@@ -339,6 +388,7 @@ void CRMVIoNet::closeSession()
    // tell Maestro we're closing the connection on this side
    sendSignal(RMV_SIG_BYE);
 
+   stopReceiver();
    close(m_sessionSocket);
    m_sessionSocket = -1;
 }
@@ -356,9 +406,8 @@ int CRMVIoNet::getNextCommand()
    // just to be safe
    if( !sessionInProgress() ) return( RMV_CMD_NONE-1 );
 
-   // poll socket connection for next (count,body) command block.  This will read a single command in one go IF the
-   // entire block is ready and waiting.
-   int cmd = pollSocketForCommand();
+   // get the next (count,body) command block, if there is one
+   int cmd = receiveCommand();
 
    // if a command was received, process it as needed.
    if( cmd > RMV_CMD_NONE )
@@ -369,11 +418,423 @@ int CRMVIoNet::getNextCommand()
 
 int CRMVIoNet::getCommandArg(int pos)
 {
-   int arg = (pos >= 0 && pos < 3) ? m_args[pos] : -1;
+   int arg = (pos >= 0 && pos < MAXCMDARGS) ? m_args[pos] : -1;
    return(arg);
 }
 
 
+//=== setEventDrivenMode ==============================================================================================
+//
+//    Enable or disable event-driven command ingestion. When disabled (the default), the session socket is polled for
+//    the next command each time getNextCommand() is called. When enabled, a dedicated receive thread waits on the
+//    session socket and queues each command as soon as it arrives; getNextCommand() simply dequeues the next command.
+//
+//    In busy-poll mode, the receive thread polls the socket continuously instead of sleeping in epoll_wait(), the
+//    socket's SO_BUSY_POLL option is set, and waitForCommand() spins on the command queue. This minimizes the latency
+//    with which a command is seen, but the receive thread will fully occupy one CPU core throughout the session.
+//
+//    The mode takes effect at the start of the next command session; call it before openSession().
+//
+//    ARGS:       bEnable -- [in] True to enable event-driven mode.
+//                bBusyPoll -- [in] True to busy-poll. Ignored unless event-driven mode is enabled.
+//    RETURNS:    NONE.
+//
+void CRMVIoNet::setEventDrivenMode(bool bEnable, bool bBusyPoll)
+{
+   m_bEventDriven = bEnable;
+   m_bBusyPoll = bEnable && bBusyPoll;
+}
+
+//=== setNetworkAddresses =============================================================================================
+//
+//    Override the IP addresses of the RMVideo and Maestro hosts on the dedicated private network (RMVNET_RMVADDR and
+//    RMVNET_MAESTROADDR by default). This is intended only for testing: eg, a test client can run a command session
+//    on the loopback interface by specifying "127.0.0.1" for both. Takes effect on the next call to openSession().
+//
+//    ARGS:       rmvAddr -- [in] IP address (dotted-decimal) on which we listen for a connection. If NULL, empty or
+//                   too long, the default is used.
+//                maestroAddr -- [in] IP address (dotted-decimal) from which the connection must come. If NULL, empty
+//                   or too long, the default is used.
+//    RETURNS:    NONE.
+//
+void CRMVIoNet::setNetworkAddresses(const char* rmvAddr, const char* maestroAddr)
+{
+   const char* addr = (rmvAddr != NULL && ::strlen(rmvAddr) > 0 && ::strlen(rmvAddr) < 16) ? rmvAddr : RMVNET_RMVADDR;
+   ::strcpy(m_strRMVAddr, addr);
+   addr = (maestroAddr != NULL && ::strlen(maestroAddr) > 0 && ::strlen(maestroAddr) < 16) ?
+         maestroAddr : RMVNET_MAESTROADDR;
+   ::strcpy(m_strMaestroAddr, addr);
+}
+
+//=== waitForCommand ==================================================================================================
+//
+//    Wait until a command from Maestro may be available, or until the specified time has elapsed.
+//
+//    In event-driven mode, we return immediately if the command queue is not empty. Otherwise, we block on the eventfd
+//    that the receive thread signals each time it queues a command (or spin on the queue in busy-poll mode). The
+//    eventfd may still be signaled for commands that were already dequeued; in that case we reset it and wait again
+//    for the time remaining. Without the receive thread, we block until the session socket is readable.
+//
+//    ARGS:       maxUS -- [in] The maximum time to wait, in microseconds.
+//    RETURNS:    True if a command may be available; false if the wait timed out with no command available.
+//
+bool CRMVIoNet::waitForCommand(int maxUS)
+{
+   if( !sessionInProgress() ) return( true );
+
+   struct pollfd pfd;
+   pfd.events = POLLIN;
+   pfd.revents = 0;
+   struct timespec tsWait;
+   if( !m_bRcvThreadOn )
+   {
+      if( maxUS <= 0 ) return( false );
+      pfd.fd = m_sessionSocket;
+      tsWait.tv_sec = maxUS / 1000000;
+      tsWait.tv_nsec = (maxUS % 1000000) * 1000;
+      return( ppoll(&pfd, 1, &tsWait, NULL) != 0 );
+   }
+
+   double tEndUS = getTimeUS() + maxUS;
+   while( (!m_bRcvFailed) && (m_nQueued == m_nDequeued) )
+   {
+      double tLeftUS = tEndUS - getTimeUS();
+      if( tLeftUS <= 0 ) return( false );
+      if( m_bBusyPoll ) continue;
+
+      pfd.fd = m_cmdEventFD;
+      tsWait.tv_sec = time_t(tLeftUS / 1.0e6);
+      tsWait.tv_nsec = long((tLeftUS - tsWait.tv_sec * 1.0e6) * 1000.0);
+      int res = ppoll(&pfd, 1, &tsWait, NULL);
+      if( res < 0 && errno != EINTR ) return( true );
+
+      // reset the eventfd counter; commands queued after this point will signal it again
+      uint64_t count;
+      if( res > 0 && read(m_cmdEventFD, &count, sizeof(uint64_t)) < 0 ) { /* nothing to do */ }
+   }
+   return( true );
+}
+
+//=== getCommandLatencyStats ==========================================================================================
+//
+//    Report statistics on the latency between each command's arrival and its retrieval, IAW the reply format for the
+//    RMV_CMD_GETCMDLATENCY command. The statistics cover all commands retrieved since the last RMV_CMD_STARTANIMATE,
+//    or since the start of the session if there has been no animation sequence. Latencies are only measured in
+//    event-driven mode, when the receive thread timestamps each command as it arrives; otherwise, all zeros.
+//
+//    ARGS:       pStats -- [out] Must have room for RMV_CMDLATENCY_LEN integers.
+//    RETURNS:    NONE.
+//
+void CRMVIoNet::getCommandLatencyStats(int* pStats)
+{
+   memset(pStats, 0, RMV_CMDLATENCY_LEN * sizeof(int));
+   if( !m_bRcvThreadOn ) return;
+
+   pStats[RMV_CMDLATENCY_ENABLED] = 1;
+   pStats[RMV_CMDLATENCY_NCMDS] = m_nLatency;
+   if( m_nLatency > 0 ) pStats[RMV_CMDLATENCY_AVGUS] = int(m_dLatencySumUS / m_nLatency + 0.5);
+   pStats[RMV_CMDLATENCY_MAXUS] = int(m_dLatencyMaxUS + 0.5);
+   pStats[RMV_CMDLATENCY_MAXQUEUED] = m_nMaxQueued;
+   for(int i=0; i<RMV_CMDLATENCY_NBINS; i++) pStats[RMV_CMDLATENCY_HIST + i] = m_latencyHist[i];
+}
+
+//=== resetLatencyStats, getTimeUS ====================================================================================
+//
+//    Helper methods for gathering command latency statistics. Commands are timestamped on the receive thread and
+//    again on the display thread, so we use the system-wide monotonic clock.
+//
+void CRMVIoNet::resetLatencyStats()
+{
+   m_nLatency = 0;
+   m_dLatencySumUS = 0;
+   m_dLatencyMaxUS = 0;
+   m_nMaxQueued = 0;
+   for(int i=0; i<RMV_CMDLATENCY_NBINS; i++) m_latencyHist[i] = 0;
+}
+
+double CRMVIoNet::getTimeUS()
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return( double(ts.tv_sec) * 1.0e6 + double(ts.tv_nsec) * 1.0e-3 );
+}
+
+//=== startReceiver, stopReceiver =====================================================================================
+//
+//    Start the command receive thread for the current session socket, or stop it and release all resources allocated
+//    to it. The receive thread waits on an epoll instance that monitors both the session socket and an eventfd which
+//    stopReceiver() signals to make the thread exit. A second eventfd is signaled by the receive thread each time it
+//    queues a command; waitForCommand() blocks on it. The command queue buffers are allocated here, so that no
+//    allocation is required on the receive thread unless a command is larger than DEF_RAWBUFGROWSZ bytes.
+//
+//    startReceiver() returns false if any resource could not be allocated, in which case an error message is printed
+//    to stderr, all resources are released, and the session socket is polled instead.
+//
+bool CRMVIoNet::startReceiver()
+{
+   if( m_bRcvThreadOn ) return( true );
+
+   m_nQueued = 0;
+   m_nDequeued = 0;
+   m_bRcvFailed = false;
+
+   bool bOk = true;
+   for(int i=0; bOk && i<CMDQSZ; i++)
+   {
+      m_cmdQ[i].pBuf = (char*) malloc( DEF_RAWBUFGROWSZ*sizeof(char) );
+      bOk = (m_cmdQ[i].pBuf != NULL);
+      m_cmdQ[i].bufSize = bOk ? DEF_RAWBUFGROWSZ : 0;
+      m_cmdQ[i].len = 0;
+   }
+
+   if( bOk )
+   {
+      m_cmdEventFD = eventfd(0, EFD_NONBLOCK);
+      m_stopEventFD = eventfd(0, EFD_NONBLOCK);
+      m_epollFD = epoll_create1(0);
+      bOk = (m_cmdEventFD >= 0) && (m_stopEventFD >= 0) && (m_epollFD >= 0);
+      if( !bOk ) perror("RMVideo(IONet) eventfd/epoll_create1");
+   }
+
+   if( bOk )
+   {
+      struct epoll_event ev;
+      memset(&ev, 0, sizeof(struct epoll_event));
+      ev.events = EPOLLIN;
+      ev.data.fd = m_sessionSocket;
+      bOk = (0 == epoll_ctl(m_epollFD, EPOLL_CTL_ADD, m_sessionSocket, &ev));
+      if( bOk )
+      {
+         ev.data.fd = m_stopEventFD;
+         bOk = (0 == epoll_ctl(m_epollFD, EPOLL_CTL_ADD, m_stopEventFD, &ev));
+      }
+      if( !bOk ) perror("RMVideo(IONet) epoll_ctl");
+   }
+
+   if( bOk )
+   {
+      int res = pthread_create(&m_rcvThread, NULL, CRMVIoNet::receiverEntry, (void*) this);
+      bOk = (res == 0);
+      if( !bOk ) fprintf(stderr, "RMVideo(IONet): Failed to create receive thread (error=%d)\n", res);
+   }
+
+   m_bRcvThreadOn = bOk;
+   if( !bOk ) stopReceiver();
+   return( bOk );
+}
+
+void CRMVIoNet::stopReceiver()
+{
+   if( m_bRcvThreadOn )
+   {
+      uint64_t one = 1;
+      if( write(m_stopEventFD, &one, sizeof(uint64_t)) < 0 ) perror("RMVideo(IONet) write(eventfd)");
+      pthread_join(m_rcvThread, NULL);
+      m_bRcvThreadOn = false;
+   }
+
+   if( m_epollFD >= 0 ) { close(m_epollFD); m_epollFD = -1; }
+   if( m_cmdEventFD >= 0 ) { close(m_cmdEventFD); m_cmdEventFD = -1; }
+   if( m_stopEventFD >= 0 ) { close(m_stopEventFD); m_stopEventFD = -1; }
+
+   for(int i=0; i<CMDQSZ; i++)
+   {
+      if( m_cmdQ[i].pBuf != NULL ) free( (void*) m_cmdQ[i].pBuf );
+      m_cmdQ[i].pBuf = NULL;
+      m_cmdQ[i].bufSize = 0;
+      m_cmdQ[i].len = 0;
+   }
+   m_nQueued = 0;
+   m_nDequeued = 0;
+}
+
+//=== receiverEntry, runReceiver ======================================================================================
+//
+//    The command receive thread. It frames each (count,body) command block exactly as pollSocketForCommand() does,
+//    but reads the body directly into the buffer of the next free slot in the command queue. Once a command is
+//    complete, it is timestamped and published to the display thread by advancing m_nQueued (after a full memory
+//    barrier, so the slot contents are visible first), and the command eventfd is signaled.
+//
+//    The thread reads all the data available on the socket each time it wakes. If the command queue is full --
+//    which should never happen, since Maestro does not get more than a few frames ahead of RMVideo -- it stops
+//    reading until the display thread dequeues a command. If the connection fails or Maestro sends an illegal
+//    command length, the thread sets m_bRcvFailed, signals the command eventfd, and exits; getNextCommand() then
+//    reports the failure after any commands still in the queue have been retrieved.
+//
+void* CRMVIoNet::receiverEntry(void* pThis)
+{
+   ((CRMVIoNet*) pThis)->runReceiver();
+   return( NULL );
+}
+
+void CRMVIoNet::runReceiver()
+{
+   bool bGotCount = false;                                     // set once we got the cmd byte count
+   int cmdLen = 0;                                             // the cmd byte count
+   int nBytesRemaining = RMVNET_CMDCNTSZ;                      // #bytes still to get
+   char* pBufEnd = (char*) &cmdLen;                            // current position in buffer of what's been rcvd
+   uint64_t one = 1;
+
+   bool bQuit = false;
+   while( !bQuit )
+   {
+      // wait for the session socket to become readable or for the stop signal. If the command queue is full, don't
+      // read the socket until there's room.
+      bool bReadable = false;
+      if( m_nQueued - m_nDequeued >= (unsigned int) CMDQSZ )
+      {
+         struct pollfd pfd;
+         pfd.fd = m_stopEventFD;
+         pfd.events = POLLIN;
+         pfd.revents = 0;
+         if( poll(&pfd, 1, 1) > 0 ) bQuit = true;
+         continue;
+      }
+
+      struct epoll_event events[2];
+      int nEvents = epoll_wait(m_epollFD, events, 2, m_bBusyPoll ? 0 : -1);
+      if( nEvents < 0 && errno != EINTR )
+      {
+         perror("RMVideo(IONet) epoll_wait");
+         m_bRcvFailed = true;
+         break;
+      }
+      for(int i=0; i<nEvents; i++)
+      {
+         if( events[i].data.fd == m_stopEventFD ) bQuit = true;
+         else if( events[i].data.fd == m_sessionSocket ) bReadable = true;
+      }
+      if( bQuit || !bReadable ) continue;
+
+      // receive all data we can without blocking, queuing each command as it is completed
+      bool bMoreData = true;
+      while( bMoreData && !m_bRcvFailed )
+      {
+         QueuedCmd& slot = m_cmdQ[m_nQueued % CMDQSZ];
+         int nBytesReceived = recv(m_sessionSocket, pBufEnd, nBytesRemaining, 0);
+         if( nBytesReceived < 0 )
+         {
+            bMoreData = false;
+            if( errno != EWOULDBLOCK && errno != EINTR )
+            {
+               perror("RMVideo(IONet) recv");
+               m_bRcvFailed = true;
+            }
+         }
+         else if( nBytesReceived == 0 )
+         {
+            fprintf(stderr, "RMVideo(IONet): Maestro client closed TCP/IP connection unexpectedly!\n");
+            m_bRcvFailed = true;
+         }
+         else if( nBytesReceived < nBytesRemaining )
+         {
+            nBytesRemaining -= nBytesReceived;
+            pBufEnd += nBytesReceived;
+         }
+         else if( !bGotCount )
+         {
+            // got the command byte count. Make sure it's positive and a multiple of 4, grow the slot buffer if needed,
+            // then prepare to get the command body.
+            if( (cmdLen <= 0) || (cmdLen % 4 != 0) )
+            {
+               fprintf(stderr, "RMVideo(IONet): Illegal Maestro command length (%d bytes)!\n", cmdLen);
+               m_bRcvFailed = true;
+            }
+            else if( cmdLen > slot.bufSize )
+            {
+               int iNewSize = ((cmdLen / DEF_RAWBUFGROWSZ) + 1) * DEF_RAWBUFGROWSZ;
+               char* pBiggerBuf = (char*) realloc( (void*)slot.pBuf, iNewSize*sizeof(char) );
+               if( pBiggerBuf == NULL )
+                  m_bRcvFailed = true;
+               else
+               {
+                  slot.pBuf = pBiggerBuf;
+                  slot.bufSize = iNewSize;
+               }
+            }
+
+            if( !m_bRcvFailed )
+            {
+               bGotCount = true;
+               nBytesRemaining = cmdLen;
+               pBufEnd = slot.pBuf;
+            }
+         }
+         else
+         {
+            // got the command body: timestamp it and publish it to the display thread
+            slot.len = cmdLen;
+            slot.tRcvUS = getTimeUS();
+            __sync_synchronize();
+            m_nQueued = m_nQueued + 1;
+            if( write(m_cmdEventFD, &one, sizeof(uint64_t)) < 0 ) { /* counter saturated; reader will drain */ }
+
+            bGotCount = false;
+            cmdLen = 0;
+            nBytesRemaining = RMVNET_CMDCNTSZ;
+            pBufEnd = (char*) &cmdLen;
+
+            // if the queue is now full, stop reading
+            if( m_nQueued - m_nDequeued >= (unsigned int) CMDQSZ ) bMoreData = false;
+         }
+      }
+
+      if( m_bRcvFailed ) bQuit = true;
+   }
+
+   // wake the display thread if it is waiting, so it sees the failure
+   if( m_bRcvFailed && write(m_cmdEventFD, &one, sizeof(uint64_t)) < 0 ) { /* nothing to do */ }
+}
+
+//=== receiveCommand ==================================================================================================
+//
+//    Get the next complete (count,body) command block. Without the receive thread, this simply polls the session
+//    socket via pollSocketForCommand(). Otherwise, it dequeues the next command, if any. Rather than copying the
+//    command, we swap the queue slot's buffer with the receive buffer m_pRcvBuf, from which the command is processed
+//    just as if it were read from the socket. The command's receive-to-retrieval latency is added to the latency
+//    statistics; those statistics are reset when an RMV_CMD_STARTANIMATE is retrieved, so they cover the most recent
+//    animation sequence.
+//
+//    ARGS:       NONE.
+//    RETURNS:    The next command ID, RMV_CMD_NONE if no command is pending, or RMV_CMD_NONE-1 if there's a fatal
+//                error in the communication interface.
+//
+int CRMVIoNet::receiveCommand()
+{
+   if( !m_bRcvThreadOn ) return( pollSocketForCommand() );
+
+   unsigned int nQueued = m_nQueued;
+   if( nQueued == m_nDequeued ) return( m_bRcvFailed ? RMV_CMD_NONE-1 : RMV_CMD_NONE );
+   __sync_synchronize();
+
+   QueuedCmd& slot = m_cmdQ[m_nDequeued % CMDQSZ];
+   char* pBuf = m_pRcvBuf;
+   int bufSize = m_iRcvBufSize;
+   m_pRcvBuf = slot.pBuf;
+   m_iRcvBufSize = slot.bufSize;
+   m_iRcvLenBytes = slot.len;
+   slot.pBuf = pBuf;
+   slot.bufSize = bufSize;
+   double latencyUS = getTimeUS() - slot.tRcvUS;
+   int nWaiting = int(nQueued - m_nDequeued);
+
+   __sync_synchronize();
+   m_nDequeued = m_nDequeued + 1;
+
+   int cmd = ((int*) m_pRcvBuf)[0];
+   if( cmd == RMV_CMD_STARTANIMATE ) resetLatencyStats();
+
+   ++m_nLatency;
+   m_dLatencySumUS += latencyUS;
+   if( latencyUS > m_dLatencyMaxUS ) m_dLatencyMaxUS = latencyUS;
+   if( nWaiting > m_nMaxQueued ) m_nMaxQueued = nWaiting;
+   int iBin = 0;
+   for(double limitUS = 1.0; iBin < RMV_CMDLATENCY_NBINS-1 && latencyUS >= limitUS; limitUS *= 2.0) ++iBin;
+   ++m_latencyHist[iBin];
+
+   return( cmd );
+}
+
 //=== pollSocketForCommand ============================================================================================
 //
 //    This helper function polls the open session socket, reading in the next Maestro command if it is there -- in
@@ -524,7 +985,7 @@ int CRMVIoNet::processNextCommand()
    int i;
 
    // reset integer command args that are relevant only to selected commands
-   for(i=0; i<3; i++) m_args[i] = -1;
+   for(i=0; i<MAXCMDARGS; i++) m_args[i] = -1;
    
    // we assume there are no byte ordering issues to worry about, so we can cast our byte buffer to an int32 buffer
    // to recover the actual command sequence from Maestro!
@@ -596,6 +1057,9 @@ int CRMVIoNet::processNextCommand()
       case RMV_CMD_GETCURRVIDEOMODE :
       case RMV_CMD_GETALLVIDEOMODES :
       case RMV_CMD_GETGAMMA :
+      case RMV_CMD_GETFRAMESTATS :
+      case RMV_CMD_GETIMGCACHESTATS :
+      case RMV_CMD_GETCMDLATENCY :
       case RMV_CMD_STOPANIMATE :
          bCmdErr = (iCmdLen == 1) ? false : true;
          break;
@@ -611,12 +1075,18 @@ int CRMVIoNet::processNextCommand()
       case RMV_CMD_UPDATEFRAME :
          bCmdErr = !parseUpdateFrame();
          break;
+
+      case RMV_CMD_UPDATEFRAMEC :
+         bCmdErr = !parseUpdateFrameCompact();
+         cmd = RMV_CMD_UPDATEFRAME;
+         break;
       
       case RMV_CMD_GETMEDIADIRS :
       case RMV_CMD_GETMEDIAFILES :
       case RMV_CMD_GETMEDIAINFO :
       case RMV_CMD_DELETEMEDIA :
       case RMV_CMD_PUTFILE :
+      case RMV_CMD_PUTFILEX :
       case RMV_CMD_PUTFILECHUNK :
       case RMV_CMD_PUTFILEDONE :
          bCmdErr = !parseMediaAndFileCommands();
@@ -930,14 +1400,87 @@ bool CRMVIoNet::parseUpdateFrame()
    return( true );
 }
 
+//=== parseUpdateFrameCompact =========================================================================================
+//
+//    Parse the motion vectors for the next frame from the compact RMV_CMD_UPDATEFRAMEC command. The "on" flag of each
+//    target is always sent. The other fields of a target's motion vector are sent only if they changed since the
+//    previous frame; otherwise, the fields parsed from the previous RMV_CMD_UPDATEFRAME, _UPDATEFRAMEC, or frame 1 of
+//    RMV_CMD_STARTANIMATE are left as is in the motion vector buffer. The changed fields are packed in a little-endian
+//    byte sequence, each in 0, 2, 3, or 4 bytes as indicated by a per-target descriptor byte. See RMVIDEO_COMMON.H for
+//    the details. As with the legacy command, the motion vector buffer may be partially updated if the command is 
+//    badly formatted; Maestro must terminate the animation sequence in that case.
+//
+//    ARGS:       NONE.
+//    RETURNS:    True if successful; false if the command is incorrectly formatted.
+//
+bool CRMVIoNet::parseUpdateFrameCompact()
+{
+   int iCmdLen = m_iRcvLenBytes / 4;
+   int* pCmdBuf = (int*) m_pRcvBuf;
+
+   // validate command length and verify # of targets equals the number loaded. Unused bits in the on-mask and
+   // changed-mask must be clear.
+   int nMaskWords = (m_nTargets + 31) / 32;
+   if(iCmdLen < 3 + 2*nMaskWords) return(false);
+   if(pCmdBuf[2] != m_nTargets) return(false);
+
+   const unsigned int* pOnMask = (const unsigned int*) &(pCmdBuf[3]);
+   const unsigned int* pChgMask = pOnMask + nMaskWords;
+   if(m_nTargets % 32 != 0)
+   {
+      unsigned int unused = ~((1u << (m_nTargets % 32)) - 1u);
+      if(((pOnMask[nMaskWords-1] | pChgMask[nMaskWords-1]) & unused) != 0) return(false);
+   }
+
+   // the sync spot flash request flag
+   m_bSyncFlashRequested = (pCmdBuf[1] != 0);
+
+   // parse the byte sequence holding the fields of the changed motion vectors
+   const unsigned char* pBytes = (const unsigned char*) &(pCmdBuf[3 + 2*nMaskWords]);
+   int nBytes = (iCmdLen - 3 - 2*nMaskWords) * 4;
+   int k = 0;
+   for(int i=0; i<m_nTargets; i++)
+   {
+      unsigned int bit = 1u << (i % 32);
+      m_pMotionVecs[i].bOn = ((pOnMask[i/32] & bit) != 0);
+      if((pChgMask[i/32] & bit) == 0) continue;
+
+      if(k >= nBytes) return(false);
+      int desc = pBytes[k++];
+      float* pFields[4] = { &(m_pMotionVecs[i].hWin), &(m_pMotionVecs[i].vWin), &(m_pMotionVecs[i].hPat), 
+         &(m_pMotionVecs[i].vPat) };
+      for(int j=0; j<4; j++)
+      {
+         int w = (desc >> (2*j)) & 0x03;
+         int nb = (w == RMV_UPDC_W_ZERO) ? 0 : w + 1;
+         if(k + nb > nBytes) return(false);
+
+         // assemble little-endian value and sign-extend it to 32 bits
+         unsigned int u = 0;
+         for(int b=0; b<nb; b++) u |= ((unsigned int) pBytes[k+b]) << (8*b);
+         if(nb > 0 && nb < 4 && (u & (1u << (8*nb - 1))) != 0) u |= ~0u << (8*nb);
+         k += nb;
+
+         *(pFields[j]) = ((float) ((int) u)) / RMV_TGTVEC_F2I_F;
+      }
+   }
+
+   // whatever remains must be zero padding, less than 4 bytes
+   if(nBytes - k > 3) return(false);
+   for(; k<nBytes; k++) if(pBytes[k] != 0) return(false);
+
+   return( true );
+}
+
 //=== parseMediaAndFileCommands =======================================================================================
 //
 //    This helper method handles the Maestro commands RMV_CMD_GETMEDIADIRS, _GETMEDIAFILES, _GETMEDIAINFO,
-//    _DELETEMEDIA, _PUTFILE, _PUTFILECHUNK, and _PUTFILEDONE.
+//    _DELETEMEDIA, _PUTFILE, _PUTFILEX, _PUTFILECHUNK, and _PUTFILEDONE.
 //
 //    The method returns false if the command is found to be incorrectly formatted. Media folder and file names, if
 //    relevant to the command, are copied to m_strMediaFolder and m_strMediaFile. These character strings are emptied
-//    otherwise. For details on the content of each of these Maestro commands, see RMVIDEO_COMMON.H.
+//    otherwise. The int arguments of RMV_CMD_PUTFILEX are saved in m_args[]. For details on the content of each of 
+//    these Maestro commands, see RMVIDEO_COMMON.H.
 //
 bool CRMVIoNet::parseMediaAndFileCommands()
 {
@@ -952,6 +1495,7 @@ bool CRMVIoNet::parseMediaAndFileCommands()
    ::memset((void*) m_strMediaFile, (int) '\0', RMV_MVF_LEN + 1);
    
    bool ok = false;
+   int iStart = 4;                     // byte offset of folder name, for commands that include folder & file names
    switch(cmd)
    {
       case RMV_CMD_GETMEDIADIRS :
@@ -967,6 +1511,13 @@ bool CRMVIoNet::parseMediaAndFileCommands()
             if(ok) ::strcpy(m_strMediaFolder, folderName);
          }
          break;
+      case RMV_CMD_PUTFILEX :
+         // four int args (file size and content hash), followed by the destination media folder & file names as in
+         // RMV_CMD_PUTFILE. NOTE: FALL THROUGH!
+         ok = (iCmdLen >= 1 + MAXCMDARGS + 2);
+         if(!ok) break;
+         for(int i=0; i<MAXCMDARGS; i++) m_args[i] = pCmdBuf[i+1];
+         iStart = 4 * (1 + MAXCMDARGS);
       case RMV_CMD_PUTFILE : 
          // either no command arguments (downloading RMVideo executable), or the destination media folder & file names.
          // NOTE: FALL THROUGH IN THE LATTER CASE!
@@ -976,16 +1527,16 @@ bool CRMVIoNet::parseMediaAndFileCommands()
             break;
          }
       case RMV_CMD_GETMEDIAINFO :
-         ok = (m_iRcvLenBytes >= 8);
+         ok = (m_iRcvLenBytes >= iStart + 4);
          if(ok)
          {
-            char* folderName = &(m_pRcvBuf[4]);
+            char* folderName = &(m_pRcvBuf[iStart]);
             int n = ::strlen(folderName);
             ok = (n > 0) && (n <= RMV_MVF_LEN) && (n == ::strspn(folderName, RMV_MVF_CHARS));
-            if(ok) ok = (n + 5 < m_iRcvLenBytes);
+            if(ok) ok = (iStart + n + 1 < m_iRcvLenBytes);
             if(ok)
             {
-               char* fileName = &(m_pRcvBuf[n+5]);
+               char* fileName = &(m_pRcvBuf[iStart+n+1]);
                int m = ::strlen(fileName);
                ok = (m > 0) && (m <= RMV_MVF_LEN) && (m == ::strspn(fileName, RMV_MVF_CHARS));
                if(ok)
@@ -1117,7 +1668,7 @@ bool CRMVIoNet::downloadFile(FILE* fd)
    bool cancelled = false;
    while(!done)
    {
-      int nextCmd = pollSocketForCommand();
+      int nextCmd = receiveCommand();
 
       if(nextCmd < RMV_CMD_NONE)
       {
@@ -1172,6 +1723,99 @@ bool CRMVIoNet::downloadFile(FILE* fd)
          ok = false;
          done = true;
       }
+      else
+         waitForCommand(2000);
+   }
+   
+   ::fclose(fd);
+   if(!ok) sendSignal(cancelled ? RMV_SIG_CMDACK : RMV_SIG_CMDERR);
+   return(ok);
+}
+
+// This method processes the windowed stream of RMV_CMD_PUTFILECHUNK commands followed by a single RMV_CMD_PUTFILEDONE
+// that completes a transfer initiated by RMV_CMD_PUTFILEX. Each chunk is acknowledged as in downloadFile(), but Maestro
+// may have several chunks in flight. So, once a chunk fails, RMV_SIG_CMDERR is sent and all remaining chunks are 
+// discarded until RMV_CMD_PUTFILEDONE arrives, and that command also gets RMV_SIG_CMDERR. The file descriptor is closed
+// before returning, regardless the outcome.
+bool CRMVIoNet::downloadFileWindowed(FILE* fd, bool& bLinkLost)
+{
+   bLinkLost = false;
+   if(!sessionInProgress())
+   {
+      fprintf(stderr, "File download failed -- no session in progress!\n");
+      if(fd != NULL) ::fclose(fd);
+      bLinkLost = true;
+      return(false);
+   }
+   
+   if(fd == NULL)
+   {
+      fprintf(stderr, "File download failed -- NULL file descriptor!\n");
+      sendSignal(RMV_SIG_CMDERR);
+      return(false);
+   }
+
+   bool done = false;
+   bool ok = true;
+   bool cancelled = false;
+   while(!done)
+   {
+      int nextCmd = receiveCommand();
+
+      if(nextCmd < RMV_CMD_NONE)
+      {
+         fprintf(stderr, "(CRMVIoNet::downloadFileWindowed) Connection failed during file download!\n");
+         ::fclose(fd);
+         bLinkLost = true;
+         return(false);
+      }
+      else if(nextCmd == RMV_CMD_PUTFILECHUNK)
+      {
+         // once a chunk has failed, discard the rest without reply
+         if(!ok) continue;
+
+         int* pCmdBuf = (int*) m_pRcvBuf;
+         ok = (m_iRcvLenBytes > 8) && (pCmdBuf[1] > 0) && (pCmdBuf[1] <= RMV_PUTX_CHUNKSZ);
+         if(ok) ok = (m_iRcvLenBytes - 8 >= pCmdBuf[1]);
+         if(!ok)
+            fprintf(stderr, "(CRMVIoNet::downloadFileWindowed) Download failed on bad file chunk command!\n");
+         else
+         {
+            ok = (1 == ::fwrite((void*) &(m_pRcvBuf[8]), pCmdBuf[1], 1, fd));
+            if(!ok) ::perror("(CRMVIoNet::downloadFileWindowed) Download failed on file write error!\n");
+         }
+         
+         sendSignal(ok ? RMV_SIG_CMDACK : RMV_SIG_CMDERR);
+      }
+      else if(nextCmd == RMV_CMD_PUTFILEDONE)
+      {
+         int len = m_iRcvLenBytes / 4;
+         int* pCmdBuf = (int*) m_pRcvBuf;
+         if(ok)
+         {
+            ok = (len == 2);
+            if(ok)
+            {
+               cancelled = (pCmdBuf[1] == 0);
+               if(cancelled) 
+               {
+                  ok = false;
+                  fprintf(stderr, "(CRMVIoNet::downloadFileWindowed) Download cancelled by Maestro!\n");
+               }
+            }
+            else
+               fprintf(stderr, "(CRMVIoNet::downloadFileWindowed) Download failed on bad file done command!\n");
+         }
+         done = true;
+      }
+      else if(nextCmd != RMV_CMD_NONE)
+      {
+         fprintf(stderr, "(CRMVIoNet::downloadFileWindowed) Download failed on invalid command (%d)!\n", nextCmd);
+         ok = false;
+         done = true;
+      }
+      else
+         waitForCommand(2000);
    }
    
    ::fclose(fd);
@@ -9,6 +9,7 @@
 #if !defined(RMVIONET_H_INCLUDED_)
 #define RMVIONET_H_INCLUDED_
 
+#include <pthread.h>
 #include "rmvio.h"                                          // base class CRMVIo
 
 
@@ -23,7 +24,16 @@ public:
    bool openSession();                                      // open connection session with Maestro [BLOCKS]
    void closeSession();                                     // issue RMV_SIG_BYE, then close connex w/Maestro client
 
+   // receive commands on a dedicated thread (and, optionally, busy-poll the session socket). Call before openSession()
+   void setEventDrivenMode(bool bEnable, bool bBusyPoll);
+   bool isEventDrivenMode() { return(m_bEventDriven); }
+
+   // override the dedicated IP addresses of the RMVideo and Maestro hosts (for testing). Call before openSession()
+   void setNetworkAddresses(const char* rmvAddr, const char* maestroAddr);
+
    int getNextCommand();                                    // get next command from Maestro, if any
+   bool waitForCommand(int maxUS);                          // wait (up to maxUS) for a command to arrive
+   void getCommandLatencyStats(int* pStats);                // command receive-to-retrieval latency statistics
    int getCommandArg(int pos);                              // to retrieve 32-bit int arguments of selected cmds
 
    int getNumTargets();                                     // get # of target defns accompanying "load targets" cmd
@@ -35,11 +45,13 @@ public:
    const char* getMediaFolder();                            // get media folder name from selected commands
    const char* getMediaFile();                              // get media file name from selected commands
    bool downloadFile(FILE* fd);                             // download a file over the communication interface
+   bool downloadFileWindowed(FILE* fd, bool& bLinkLost);    // same, for windowed transfer (RMV_CMD_PUTFILEX)
 
    void sendData(int len, int* pPayload);                   // send information back to Maestro
 
 private:
-   int m_args[3];                                           // args specified with last command, if applicable
+   static const int MAXCMDARGS = 4;
+   int m_args[MAXCMDARGS];                                  // args specified with last command, if applicable
 
    char m_strMediaFolder[RMV_MVF_LEN+1];                    // media folder name from last relevant cmd
    char m_strMediaFile[RMV_MVF_LEN+1];                      // media file name from last relevant cmd
@@ -60,6 +72,8 @@ private:
 
    int m_sessionSocket;                                     // active socket descriptor for receiving commands from
                                                             // and sending signals to Maestro
+   char m_strRMVAddr[16];                                   // IP address on which we listen for Maestro connection
+   char m_strMaestroAddr[16];                               // IP address from which Maestro must connect
 
    static const int DEF_RAWBUFGROWSZ;                       // default and grow size for network receive buffer
    int m_iRcvBufSize;                                       // size of network receive buffer in bytes
@@ -71,12 +85,51 @@ private:
       return( m_sessionSocket != -1 );
    }
 
+   // event-driven mode: a dedicated receive thread waits on the session socket (via epoll), reads each complete
+   // (count,body) command block as soon as it arrives, timestamps it, and appends it to a lock-free single-producer,
+   // single-consumer queue. The display thread dequeues commands in getNextCommand().
+   bool m_bEventDriven;                                     // true if event-driven mode is enabled
+   bool m_bBusyPoll;                                        // if set, busy-poll rather than sleep in the receive 
+                                                            // thread and in waitForCommand()
+   static const int CMDQSZ = 64;                            // capacity of the command queue
+   struct QueuedCmd                                         // a command in the queue:
+   {
+      char* pBuf;                                           //    command byte buffer (swapped with m_pRcvBuf upon
+      int bufSize;                                          //    retrieval, so the command is never copied)
+      int len;                                              //    length of command in bytes
+      double tRcvUS;                                        //    time at which command was received, in us
+   };
+   QueuedCmd m_cmdQ[CMDQSZ];
+   volatile unsigned int m_nQueued;                         // # of commands queued (written by receive thread only)
+   volatile unsigned int m_nDequeued;                       // # of commands dequeued (written by display thread only)
+   volatile bool m_bRcvFailed;                              // set by receive thread if comm link fails
+   bool m_bRcvThreadOn;                                     // true while the receive thread is running
+   pthread_t m_rcvThread;                                   // the receive thread
+   int m_epollFD;                                           // epoll instance on which the receive thread waits
+   int m_cmdEventFD;                                        // eventfd signaled when a command is queued
+   int m_stopEventFD;                                       // eventfd signaled to stop the receive thread
+
+   int m_nLatency;                                          // receive-to-retrieval latency stats for the commands
+   double m_dLatencySumUS;                                  // retrieved since the last RMV_CMD_STARTANIMATE (or
+   double m_dLatencyMaxUS;                                  // start of session)
+   int m_nMaxQueued;
+   int m_latencyHist[RMV_CMDLATENCY_NBINS];
+
+   bool startReceiver();                                    // start receive thread for the current session socket
+   void stopReceiver();                                     // stop receive thread and release its resources
+   static void* receiverEntry(void* pThis);                 // receive thread entry point
+   void runReceiver();                                      // receive thread runtime loop
+   void resetLatencyStats();                                // reset command latency statistics
+   static double getTimeUS();                               // current time (CLOCK_MONOTONIC) in microseconds
+
+   int receiveCommand();                                    // get next (count,body) command block from queue or socket
    int pollSocketForCommand();                              // polls session socket for (count,body) command block
    int processNextCommand();                                // process a command just received, IAW CRMVIo contract
    bool parseLoadTargets();                                 // helper method parses the RMV_CMD_LOADTARGETS command
    bool parseStartAnimateFrame0();                          // parses frame 0 motion vectors from STARTANIMATE cmd
    bool parseStartAnimateFrame1();                          // parses frame 1 motion vectors from STARTANIMATE cmd
    bool parseUpdateFrame();                                 // parses motion vectors from RMV_CMD_UPDATEFRAME cmd
+   bool parseUpdateFrameCompact();                          // parses motion vectors from RMV_CMD_UPDATEFRAMEC cmd
    bool parseMediaAndFileCommands();                        // parses media store & file-related commands
 };
 
@@ -61,6 +61,9 @@
 //                   scaled by a factor of 1000. All must lie in [800..3000].
 //    ==> Set the current monitor gamma correction factors for R, G, and B guns.
 //
+//    getframestats  (none)
+//    ==> Get frame-timing statistics for the most recent animation sequence.
+//
 //    getallvmodes   (none)
 //    ==> Get a listing of all supported video modes that are at least 1024x768 @ 75Hz or better.
 //
@@ -89,6 +92,13 @@
 //                   file path is limited to 50 characters and cannot include whitespace.
 //    ==> Emulate downloading a media file (copies the specified source file).
 //
+//    getimgcachestats  (none)
+//    ==> Get hit, miss and eviction statistics for RMVideo's image cache.
+//
+//    getcmdlatency  (none)
+//    ==> Get command receive-to-retrieval latency statistics. Always zero here, since the emulator does not use a
+//    receive thread; the command exercises the reply path only.
+//
 //    putexec        Source file path, limited to 50 characters and no whitespace.
 //    ==> Emulate downloading the RMVideo executable file (copies the specified source file). NOTE -- This is no longer
 //    supported as of May 2016.
@@ -207,6 +217,10 @@
 // 26mar2019-- Modified IAW changes in Maestro-RMVideo communication protocol during animate mode (for version 9).
 // 07may2019-- Added support for target flicker parameters (for version 10).
 // 11dec2024-- Added support for stereo dot disparity parameter, RMVTGTDEF.fDotDisp (for version 11).
+// 16oct2026-- Added "getframestats" command to exercise new command RMV_CMD_GETFRAMESTATS.
+// 16oct2026-- Added "getimgcachestats" command to exercise new command RMV_CMD_GETIMGCACHESTATS.
+// 16oct2026-- Added "getcmdlatency" command to exercise new command RMV_CMD_GETCMDLATENCY.
+// 16oct2026-- The "getframestats" reply now includes texture pool statistics.
 //=====================================================================================================================
 
 #include <unistd.h>
@@ -659,6 +673,48 @@ void CRMVIoSim::sendData(int len, int* pPayload)
          double b = ((double) pPayload[3]) / 1000.0;
          fprintf(stderr, "Current monitor gamma: r=%.2f, g=%.2f, b=%.2f\n", r, g, b);
       }
+      else if(lastCmd == RMV_CMD_GETFRAMESTATS && pPayload[0] == RMV_SIG_CMDACK && len > RMV_FRAMESTATS_LEN)
+      {
+         const int* pStats = &(pPayload[1]);
+         fprintf(stderr, "Frame stats for last animation: %d frames recorded (%d retained), %d dupes, %d missed.\n",
+            pStats[RMV_FRAMESTATS_NFRAMES], pStats[RMV_FRAMESTATS_NKEPT], pStats[RMV_FRAMESTATS_NSKIPS],
+            pStats[RMV_FRAMESTATS_NMISSED]);
+         fprintf(stderr, "  avg/max us: update=%d/%d, draw=%d/%d, swap=%d/%d, cmd=%d/%d; max drift=%d us\n",
+            pStats[RMV_FRAMESTATS_UPDAVG], pStats[RMV_FRAMESTATS_UPDMAX], pStats[RMV_FRAMESTATS_DRAWAVG],
+            pStats[RMV_FRAMESTATS_DRAWMAX], pStats[RMV_FRAMESTATS_SWAPAVG], pStats[RMV_FRAMESTATS_SWAPMAX],
+            pStats[RMV_FRAMESTATS_CMDAVG], pStats[RMV_FRAMESTATS_CMDMAX], pStats[RMV_FRAMESTATS_MAXDRIFT]);
+         fprintf(stderr, "  worst update+draw=%d us at frame %d; slowest target=%d (%d us)\n",
+            pStats[RMV_FRAMESTATS_WORSTCOST], pStats[RMV_FRAMESTATS_WORSTFRAME], pStats[RMV_FRAMESTATS_SLOWTGT],
+            pStats[RMV_FRAMESTATS_SLOWTGTCOST]);
+         fprintf(stderr, "  texture pool: %d textures, %d of %d KB; %d hits, %d allocations, %d evictions\n",
+            pStats[RMV_FRAMESTATS_TEXCOUNT], pStats[RMV_FRAMESTATS_TEXKB], pStats[RMV_FRAMESTATS_TEXBUDGETKB],
+            pStats[RMV_FRAMESTATS_TEXHITS], pStats[RMV_FRAMESTATS_TEXALLOCS], pStats[RMV_FRAMESTATS_TEXEVICTS]);
+      }
+      else if(lastCmd == RMV_CMD_GETIMGCACHESTATS && pPayload[0] == RMV_SIG_CMDACK && len > RMV_IMGCACHESTATS_LEN)
+      {
+         const int* pStats = &(pPayload[1]);
+         fprintf(stderr, "Image cache: %d images, %d of %d KB; %d hits, %d misses, %d evictions", 
+            pStats[RMV_IMGCACHESTATS_NIMAGES], pStats[RMV_IMGCACHESTATS_SIZEKB], pStats[RMV_IMGCACHESTATS_BUDGETKB],
+            pStats[RMV_IMGCACHESTATS_HITS], pStats[RMV_IMGCACHESTATS_MISSES], pStats[RMV_IMGCACHESTATS_EVICTIONS]);
+         if(pStats[RMV_IMGCACHESTATS_DISKENA] != 0) 
+            fprintf(stderr, "; %d loaded from disk cache.\n", pStats[RMV_IMGCACHESTATS_DISKHITS]);
+         else
+            fprintf(stderr, "; disk cache disabled.\n");
+      }
+      else if(lastCmd == RMV_CMD_GETCMDLATENCY && pPayload[0] == RMV_SIG_CMDACK && len > RMV_CMDLATENCY_LEN)
+      {
+         const int* pStats = &(pPayload[1]);
+         if(pStats[RMV_CMDLATENCY_ENABLED] == 0)
+            fprintf(stderr, "Command latency: not measured (no command receive thread).\n");
+         else
+         {
+            fprintf(stderr, "Command latency: %d cmds, avg=%d us, max=%d us, max queued=%d. Histogram:", 
+               pStats[RMV_CMDLATENCY_NCMDS], pStats[RMV_CMDLATENCY_AVGUS], pStats[RMV_CMDLATENCY_MAXUS],
+               pStats[RMV_CMDLATENCY_MAXQUEUED]);
+            for(int j=0; j<RMV_CMDLATENCY_NBINS; j++) fprintf(stderr, " %d", pStats[RMV_CMDLATENCY_HIST + j]);
+            fprintf(stderr, "\n");
+         }
+      }
       else if(lastCmd == RMV_CMD_GETMEDIADIRS && pPayload[0] == RMV_SIG_CMDACK)
       {
          // list media folders on stderr...
@@ -804,6 +860,8 @@ int CRMVIoSim::processIdleCommand()
       }
       else if(0 == ::strcasecmp(cmdName, "getgamma"))
          nextCmd = RMV_CMD_GETGAMMA;
+      else if(0 == ::strcasecmp(cmdName, "getframestats"))
+         nextCmd = RMV_CMD_GETFRAMESTATS;
       else if( 0 == ::strcasecmp(cmdName, "setgamma") )
       {
          bParsed = (4 == ::sscanf(m_nextLine," %24s %d %d %d", &(cmdName[0]), &i, &i1, &i2));
@@ -828,6 +886,10 @@ int CRMVIoSim::processIdleCommand()
             m_args[0] = i;
          }
       }
+      else if(0 == ::strcasecmp(cmdName, "getimgcachestats"))
+         nextCmd = RMV_CMD_GETIMGCACHESTATS;
+      else if(0 == ::strcasecmp(cmdName, "getcmdlatency"))
+         nextCmd = RMV_CMD_GETCMDLATENCY;
       else if(0 == ::strcasecmp(cmdName, "getmovdirs"))
          nextCmd = RMV_CMD_GETMEDIADIRS;
       else if(0 == ::strcasecmp(cmdName, "getmovfiles"))
@@ -13,6 +13,33 @@
  28jan2020-- Removed call to mlockall() -- we no longer lock all process memory to avoid page faults. With this 
  change, plus the fact that the primary thread now runs with normal SCHED_OTHER priority, means that RMVideo no
  longer requires root privileges to run.
+ 16oct2026-- Added optional command-line argument "pipelined", which enables the renderer's pipelined vertex streaming
+ mode during animation sequences. It may appear with or without "connect", eg: "rmvideo connect pipelined".
+ 16oct2026-- Added optional command-line argument "gpudots", which animates RMV_RANDOMDOTS and RMV_FLOWFIELD targets
+ with the renderer's GPU dot engine rather than on the CPU.
+ 16oct2026-- Added optional command-line arguments "headless[=WxH@R]" and "capture". The first runs RMVideo without
+ an X display, rendering offscreen at W x H pixels with a nominal refresh rate of R Hz (default 1920x1080@60Hz); the
+ command session is always emulated, and every animation frame is hashed and logged. The second also saves each
+ captured frame as an image. Eg: "rmvideo headless=1280x1024@144 capture".
+ 16oct2026-- Added optional command-line argument "telemetry", which appends the per-frame timing records for each
+ animation sequence to rmvtelemetry.csv in the current working directory.
+ 16oct2026-- Added optional command-line argument "zerocopy", which enables the renderer's zero-copy movie mode: 
+ RMV_MOVIE frames are decoded directly into persistently mapped pixel buffers. Also added "vidbench=<path>", which 
+ does not start RMVideo at all; instead, it streams the specified video file through CVidBuffer with and without 
+ zero-copy storage and reports the bytes copied and time spent per frame. Eg: "rmvideo vidbench=/tmp/movie1080.mp4".
+ 16oct2026-- Added optional command-line arguments "imgcache=<MB>", which sets the capacity of the media store's image
+ cache (default 300MB), and "pixcache", which enables the on-disk cache of decoded image pixels in the media store.
+ 16oct2026-- Added optional command-line argument "apertures", which enables the renderer's analytic aperture mode: the
+ apertures and Gaussian windows of spot, grating and plaid targets are computed in the fragment shader, so no alpha 
+ mask textures are built when targets are loaded. See the load-latency benchmark at the end of msimcmds.txt.
+ 16oct2026-- Added optional command-line arguments "eventio" and "busypoll". The first receives Maestro commands on a 
+ dedicated thread (network link only) and enables late latching of target updates during animation; the second also
+ busy-polls for commands, dedicating a CPU core to the receive thread. Eg: "rmvideo connect eventio busypoll".
+ 16oct2026-- Added optional command-line argument "texpool=<MB>", which sets the texture memory budget of the 
+ renderer's texture pool (default 50MB).
+ 16oct2026-- Added optional command-line arguments "stereopass" and "stereopass=sbs", which enable single-pass stereo
+ rendering -- via a layered framebuffer if supported (else side by side), or side by side only, respectively. In 
+ headless mode, either also enables an emulated stereo mode in which both eyes are captured side by side.
 */
 
 #include <unistd.h>
@@ -22,6 +49,7 @@
 #include <stdlib.h>
 #include <sys/mman.h>
 #include "rmvdisplay.h"
+#include "vidbuffer.h"
 
 /**
  SIGINT handler. This overly simplistic handler rudely exits the process. No cleanup or anything. The only reason it's
@@ -39,13 +67,71 @@ int main( int argc, char **argv )
 {
    signal(SIGINT, sigIntHandler);
 
-   // we emulate the communication link with Maestro unless the argument "connect" is passed to RMVideo
+   // we emulate the communication link with Maestro unless the argument "connect" is passed to RMVideo. The optional
+   // argument "pipelined" enables pipelined vertex streaming in the renderer, and "gpudots" enables its GPU dot engine.
+   // The argument "headless" runs RMVideo offscreen, always with the emulated link; add "capture" to save frame images.
+   // The argument "telemetry" exports per-frame timing records to a CSV file after each animation sequence.
+   // The argument "zerocopy" decodes movie frames directly into persistently mapped pixel buffers. Finally, the
+   // argument "vidbench=<path>" runs the video streaming benchmark on the specified file and exits. The argument 
+   // "imgcache=<MB>" sets the image cache capacity, and "pixcache" enables the on-disk cache of decoded images. The
+   // argument "apertures" computes target apertures and Gaussian windows in the fragment shader instead of alpha masks.
+   // The argument "eventio" receives Maestro commands on a dedicated thread, and "busypoll" busy-polls for them.
+   // The argument "texpool=<MB>" sets the texture memory budget of the renderer's texture pool. The argument
+   // "stereopass" renders both eyes in one pass in stereo mode, and "stereopass=sbs" forces the side-by-side variant.
    bool bEmulate = true;
-   if( argc > 1 )
+   bool bPipelined = false;
+   bool bGPUDots = false;
+   bool bHeadless = false;
+   bool bCapture = false;
+   bool bTelemetry = false;
+   bool bZeroCopy = false;
+   bool bPixCache = false;
+   bool bAnalyticAp = false;
+   bool bEventIO = false;
+   bool bBusyPoll = false;
+   int imgCacheMB = 0;
+   int texPoolMB = 0;
+   int stereoPass = CRMVRenderer::STEREO_TWOPASS;
+   int wHeadless = 1920, hHeadless = 1080, rateHeadless = 60;
+   for( int i=1; i<argc; i++ )
    {
-      if( strcmp("connect", argv[1]) == 0 )
+      if( strcmp("connect", argv[i]) == 0 )
          bEmulate = false;
+      else if( strcmp("pipelined", argv[i]) == 0 )
+         bPipelined = true;
+      else if( strcmp("gpudots", argv[i]) == 0 )
+         bGPUDots = true;
+      else if( strncmp("headless", argv[i], 8) == 0 )
+      {
+         bHeadless = true;
+         if( argv[i][8] == '=' ) sscanf(&(argv[i][9]), "%dx%d@%d", &wHeadless, &hHeadless, &rateHeadless);
+      }
+      else if( strcmp("capture", argv[i]) == 0 )
+         bCapture = true;
+      else if( strcmp("telemetry", argv[i]) == 0 )
+         bTelemetry = true;
+      else if( strcmp("zerocopy", argv[i]) == 0 )
+         bZeroCopy = true;
+      else if( strncmp("imgcache=", argv[i], 9) == 0 )
+         imgCacheMB = atoi(&(argv[i][9]));
+      else if( strncmp("texpool=", argv[i], 8) == 0 )
+         texPoolMB = atoi(&(argv[i][8]));
+      else if( strcmp("stereopass", argv[i]) == 0 )
+         stereoPass = CRMVRenderer::STEREO_LAYERED;
+      else if( strcmp("stereopass=sbs", argv[i]) == 0 )
+         stereoPass = CRMVRenderer::STEREO_SIDEBYSIDE;
+      else if( strcmp("pixcache", argv[i]) == 0 )
+         bPixCache = true;
+      else if( strcmp("apertures", argv[i]) == 0 )
+         bAnalyticAp = true;
+      else if( strcmp("eventio", argv[i]) == 0 )
+         bEventIO = true;
+      else if( strcmp("busypoll", argv[i]) == 0 )
+         bBusyPoll = true;
+      else if( strncmp("vidbench=", argv[i], 9) == 0 )
+         return( CVidBuffer::benchmark(&(argv[i][9]), 0) ? 0 : 1 );
    }
+   if( bHeadless ) bEmulate = true;
 
    fprintf(stderr, "Starting RMVideo, version=%d. Using %s...\n\n", RMV_CURRENTVERSION, 
             bEmulate ? "emulated command session" : "network communication link");
@@ -63,6 +149,18 @@ int main( int argc, char **argv )
       exit(1);
    }
 
+   pRMVDisplay->enablePipelinedRendering(bPipelined);
+   pRMVDisplay->enableGPUDotEngine(bGPUDots);
+   pRMVDisplay->enableTelemetryExport(bTelemetry);
+   pRMVDisplay->enableZeroCopyMovies(bZeroCopy);
+   if( imgCacheMB > 0 ) pRMVDisplay->setImageCacheBudget(imgCacheMB);
+   if( texPoolMB > 0 ) pRMVDisplay->setTexturePoolBudget(texPoolMB);
+   pRMVDisplay->enableDiskImageCache(bPixCache);
+   pRMVDisplay->enableAnalyticApertures(bAnalyticAp);
+   pRMVDisplay->enableSinglePassStereo(stereoPass);
+   pRMVDisplay->enableEventDrivenIO(bEventIO, bBusyPoll);
+   if( bHeadless ) pRMVDisplay->enableHeadlessMode(wHeadless, hHeadless, rateHeadless, bCapture);
+
    // run the display manager until a fatal error occurs or RMVideo is "told" to die.
    pRMVDisplay->start(bEmulate);
 
@@ -39,6 +39,31 @@
 // loaded at startup. Cache capacity is about 300MB. Max image dimension is now 5120 pixels.
 // 18sep2019-- Refactor: CRMVTarget::getVideoInfo() moved to new class CVidBuffer.
 // 06nov2019-- Fixing compiler warnings when trying to build RMVideo on Lubuntu 18.04 using g++ 7.4.0...
+// 16oct2026-- Reworked the image cache, which thrashed and stalled target loading when the media store held hundreds
+// of 2560x1440 images. Lookups were linear string-compare walks of a singly-linked list, and eviction was oldest-
+// first regardless of use. The cache is now a hash table (keyed on folder and file name) threaded by an LRU list, so
+// lookup is O(1) and the least recently used image is evicted first. A cached image is discarded if its source 
+// file's modification time has changed. The capacity is configurable (setImageCacheBudget(); default 300MB). An 
+// optional on-disk cache of decoded pixels (enableDiskImageCache()) lets a miss memory-map the raw RGBA image instead
+// of decoding it again. Cache hit/miss/eviction counters are reported via RMV_CMD_GETIMGCACHESTATS. Also fixed a bug
+// in removeImageFromCache(), which did not update the cache's image count and size.
+// 16oct2026-- Added downloadMediaFileEx() to handle RMV_CMD_PUTFILEX (RMVideo v13). Maestro identifies the file's
+// content by size and hash; the transfer is skipped if the destination already holds that content, or replaced by a
+// local copy if another file in the store does. Otherwise the file is received in PARTIALDIR, where it stays if the
+// connection is lost, so a later RMV_CMD_PUTFILEX for the same content resumes where it left off. Content hashes of
+// media files are computed only when needed and cached in the TOC. Factored out addDownloadedMedia(), which validates
+// a downloaded file and adds it to the TOC, from downloadMediaFile(). Reserved folder names PIXCACHEDIR and PARTIALDIR
+// are no longer accepted as download destinations.
+// 16oct2026-- Faster startup with a large media store. load() no longer probes every media file with FFMPEG or 
+// STB_IMAGE, nor preloads the image cache, on the startup path. Instead, a persistent index of the store (INDEXFILE)
+// records the size, modification time, media info and content hash of each file; only new or changed files are 
+// probed, and those in parallel on a CWorkerPool. The index is rewritten whenever the TOC changes. The image cache is
+// now preloaded on a background thread (startImagePreload()), which idles during animation sequences, never evicts an
+// image, and stops once the cache is full. The image cache is guarded by a mutex shared with that thread; images are
+// decoded outside the mutex.
+// 16oct2026-- getImage() may be called from several threads at once (CRMVRenderer::loadTargets() prepares targets in
+// parallel). A caller that holds on to the image buffer while other threads retrieve images may pin the image, so that
+// it is not evicted until unpinImage() is called.
 //=====================================================================================================================
 
 #include <unistd.h>
@@ -49,6 +74,9 @@
 #include <sys/types.h>
 #include <dirent.h>
 #include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 
 // this is a single-file header-style library providing support for loading basic image files in select formats. Here
 // I tailor it to include code supporting JPG, PNG, BMP, PSD, and GIF formats. It only supports the most common
@@ -62,12 +90,21 @@
 #include "stb_image.h"
 
 #include "vidbuffer.h"         // for static helper function CVidBuffer::getVideoInfo()
+#include "utilities.h"         // for CElapsedTime
+#include "workerpool.h"        // for CWorkerPool, to probe new media files in parallel
 #include "rmvmediamgr.h"
 
 const char* CRMVMediaMgr::MEDIASTOREDIR = "media";
 const char* CRMVMediaMgr::OLDSTOREDIR = "movies";
-const unsigned long CRMVMediaMgr::MAX_IMGCACHESZ = 300000000L;
+const char* CRMVMediaMgr::PARTIALDIR = ".partial";
+const char* CRMVMediaMgr::INDEXFILE = ".index";
+const char* CRMVMediaMgr::INDEXTAG = "RMVMEDIAINDEX 1";
+const unsigned long CRMVMediaMgr::DEF_IMGCACHESZ = 300000000L;
+const int CRMVMediaMgr::MIN_IMGCACHEMB = 16;
+const int CRMVMediaMgr::MAX_IMGCACHEMB = 16000;
 const unsigned long CRMVMediaMgr::MAX_IMAGEDIM = 5120;
+const char* CRMVMediaMgr::PIXCACHEDIR = ".pixcache";
+const int CRMVMediaMgr::PIXCACHEMAGIC = 0x50564d52;
 
 /**
  Construct the RMVideo media store manager, initially empty. Call load() to scan the dedicated media directory and
@@ -83,7 +120,26 @@ CRMVMediaMgr::CRMVMediaMgr()
 
    m_nCachedImages = 0;
    m_nCacheSize = 0L;
-   m_pImageCache = NULL;
+   m_nCacheBudget = DEF_IMGCACHESZ;
+   for(int i=0; i<IMGHASHSZ; i++) m_imgHash[i] = NULL;
+   m_pLRUHead = NULL;
+   m_pLRUTail = NULL;
+   m_bDiskCache = false;
+   m_nCacheHits = 0;
+   m_nCacheMisses = 0;
+   m_nCacheEvictions = 0;
+   m_nDiskCacheHits = 0;
+
+   m_pIgnored = NULL;
+   m_nIgnored = 0;
+   m_bIndexDirty = false;
+
+   ::pthread_mutex_init(&m_cacheMutex, NULL);
+   m_bPreloading = false;
+   m_bPreloadStop = false;
+   m_bPreloadSuspended = false;
+   m_pPreloadList = NULL;
+   m_nPreload = 0;
 }
 
 /**
@@ -92,6 +148,8 @@ CRMVMediaMgr::CRMVMediaMgr()
 */
 CRMVMediaMgr::~CRMVMediaMgr()
 {
+   stopImagePreload();
+
    if(m_pReplyBuf != NULL)
    {
       ::free(m_pReplyBuf);
@@ -112,8 +170,18 @@ CRMVMediaMgr::~CRMVMediaMgr()
       ::free(pFolder); 
    }
    m_nMediaFolders = 0;
+
+   if(m_pIgnored != NULL)
+   {
+      ::free(m_pIgnored);
+      m_pIgnored = NULL;
+      m_nIgnored = 0;
+   }
    
+   ::pthread_mutex_lock(&m_cacheMutex);
    releaseImageCache();
+   ::pthread_mutex_unlock(&m_cacheMutex);
+   ::pthread_mutex_destroy(&m_cacheMutex);
 
    m_bLoaded = false;
 }
@@ -143,11 +211,16 @@ CRMVMediaMgr::~CRMVMediaMgr()
  and RMV_MVF_LIMIT media files per folder. This method will stop scanning the contents of a particular folder once it
  has found RMV_MVF_LIMIT files, and it will stop scanning altogether once it has found RMV_MVF_LIMIT media folders!
 
- As the media store is scanned and the TOC constructed, an internal image cache is also preloaded with any images
- found in the store -- until the cache's maximum capacity is reached. If the store contains only a few small images,
- it is likely that all images will be cached. The cache is also updated as new images are uploaded from Maestro, or
- existing images deleted. This internal image cache exists to speed up loading of RMV_IMAGE targets, since reading a 
- large image in from disk can take a significant amount of time.
+ Probing every file in a large media store takes a long time, so the store's persistent index, INDEXFILE, is read
+ first. A file listed in the index with the same size and modification time is not opened at all; its TOC entry is
+ taken from the index. All other files are probed in parallel on a pool of worker threads. Files that are not supported
+ media files are also listed in the index, so they are not probed again. The index is rewritten if it was stale.
+
+ The image cache is NOT preloaded here. Call startImagePreload() once RMVideo is otherwise ready to go.
+
+ If the on-disk pixel cache is enabled, its directory PIXCACHEDIR is created within the media store if necessary. That
+ directory is never treated as a media folder, and neither is PARTIALDIR, which holds partially downloaded files.
+ INDEXFILE, a regular file, is likewise reserved.
 
  All other CRMVMediaMgr methods fail until this method is called successfully. Since it may open a fair number of
  files, it will take an indeterminate amount of time to execute. Invoke only during RMVideo startup.
@@ -199,6 +272,16 @@ bool CRMVMediaMgr::load()
       fprintf(stderr, "(CRMVMediaMgr) Unable to verify existence of media store directory!\n");
       return(false);
    }
+
+   // if on-disk pixel cache is enabled, make sure its directory exists. If not, disable the feature.
+   char dirPath[255];
+   if(m_bDiskCache)
+   {
+      ::sprintf(dirPath, "%.50s/%.100s", MEDIASTOREDIR, PIXCACHEDIR);
+      if(0 == ::stat(dirPath, &statInfo)) m_bDiskCache = S_ISDIR(statInfo.st_mode);
+      else m_bDiskCache = (0 == ::mkdir(dirPath, 0777));
+      if(!m_bDiskCache) fprintf(stderr, "(CRMVMediaMgr) Unable to create on-disk pixel cache; feature disabled.\n");
+   }
    
    // scan all directories in the media store directory. Append an empty media "folder" to our TOC corresponding to
    // each directory whose name is RMV_MVF_LEN characters long or less and includes only allowed ASCII characters. Of 
@@ -211,11 +294,11 @@ bool CRMVMediaMgr::load()
       return(false);
    }
    
-   char dirPath[255];
    pDirEntry = ::readdir(pStoreDir);
    while(pDirEntry != NULL)
    {
-      bool append = (0 != ::strcmp(pDirEntry->d_name, ".")) && (0 != ::strcmp(pDirEntry->d_name, ".."));
+      bool append = (0 != ::strcmp(pDirEntry->d_name, ".")) && (0 != ::strcmp(pDirEntry->d_name, "..")) &&
+            !isReservedFolderName(pDirEntry->d_name);
       if(append) 
       {
          int len = ::strlen(pDirEntry->d_name);
@@ -246,22 +329,127 @@ bool CRMVMediaMgr::load()
    }
    ::closedir(pStoreDir);
    
-   // scan each media folder and append all valid and supported media files therein. Images are preloaded into an
-   // internal image cache to optimize access to large (fullscreen) images. THIS COULD TAKE A WHILE if the media
-   // store contains many large images.
-   int nTotalMediaFiles = 0;
+   // list the candidate files in each media folder, then look up each file in the persistent index. Any file that
+   // is not in the index, or has changed since it was indexed, must be probed.
+   CElapsedTime eTime;
+   int nIndex = 0;
+   ScanEntry* pIndex = CRMVMediaMgr::readIndex(nIndex);
+   ScanEntry* pEntries = NULL;
+   int nEntries = 0;
+   int nCap = 0;
    MediaFolder* pFolder = m_pFirstMediaFolder;
    while(pFolder != NULL)
    {
-      if(!scanMediaFolder(pFolder)) return(false);
-      nTotalMediaFiles += pFolder->nMediaFiles;
+      if(!scanMediaFolder(pFolder, pEntries, nEntries, nCap))
+      {
+         if(pIndex != NULL) ::free(pIndex);
+         if(pEntries != NULL) ::free(pEntries);
+         return(false);
+      }
       pFolder = pFolder->pNext;
    }
-   
-   fprintf(stderr, "(CRMVMediaMgr) Found %d media files in %d folders; %d images cached.\n", 
-      nTotalMediaFiles, m_nMediaFolders, m_nCachedImages);
+
+   int nProbe = 0;
+   for(int i=0; i<nEntries; i++)
+   {
+      ScanEntry* pEntry = &(pEntries[i]);
+      ScanEntry* pMatch = (pIndex == NULL) ? NULL : 
+            (ScanEntry*) ::bsearch(pEntry, pIndex, nIndex, sizeof(ScanEntry), CRMVMediaMgr::compareScanEntries);
+      if(pMatch != NULL && pMatch->size == pEntry->size && pMatch->mtime == pEntry->mtime)
+      {
+         pEntry->type = pMatch->type;
+         pEntry->width = pMatch->width;
+         pEntry->height = pMatch->height;
+         pEntry->rate = pMatch->rate;
+         pEntry->dur = pMatch->dur;
+         pEntry->bHashed = pMatch->bHashed;
+         pEntry->contentHash = pMatch->contentHash;
+      }
+      else
+      {
+         pEntry->bProbe = true;
+         ++nProbe;
+      }
+   }
+   if(pIndex != NULL) ::free(pIndex);
+   m_bIndexDirty = (nProbe > 0) || (nIndex != nEntries - nProbe);
+
+   // probe new and changed files in parallel. If the worker pool is unavailable, probe them on this thread.
+   if(nProbe > 0)
+   {
+      CWorkerPool pool;
+      if(pool.start(0))
+      {
+         pool.dispatch(CRMVMediaMgr::probeMediaFile, (void*) pEntries, nEntries);
+         pool.waitForCompletion();
+         pool.stop();
+      }
+      else for(int i=0; i<nEntries; i++) CRMVMediaMgr::probeMediaFile((void*) pEntries, i);
+   }
+
+   // append a TOC entry for each supported media file, in the order scanned (which is folder by folder). Remember the
+   // unsupported files, so they are not probed again.
+   int nTotalMediaFiles = 0;
+   int iEntry = 0;
+   for(pFolder = m_pFirstMediaFolder; pFolder != NULL; pFolder = pFolder->pNext)
+   {
+      MediaInfo* pPrev = NULL;
+      for(; iEntry < nEntries && 0 == ::strcmp(pEntries[iEntry].folder, pFolder->name); iEntry++)
+      {
+         ScanEntry* pEntry = &(pEntries[iEntry]);
+         if(pEntry->type < 0)
+         {
+            pEntries[m_nIgnored++] = *pEntry;
+            continue;
+         }
+         if(pFolder->nMediaFiles == RMV_MVF_LIMIT)
+         {
+            fprintf(stderr, "(CRMVMediaMgr) Media folder '%s' is full. Ignoring '%s'.\n", pFolder->name, 
+                  pEntry->file);
+            continue;
+         }
+
+         MediaInfo* pInfo = (MediaInfo*) ::malloc(sizeof(MediaInfo));
+         if(pInfo == NULL)
+         {
+            ::perror("(CRMVMediaMgr) Memory allocation failed!\n");
+            ::free(pEntries);
+            m_nIgnored = 0;
+            return(false);
+         }
+         ::strcpy(pInfo->filename, pEntry->file);
+         pInfo->pNext = NULL;
+         pInfo->isVideo = (pEntry->type == 1);
+         pInfo->width = pEntry->width;
+         pInfo->height = pEntry->height;
+         pInfo->rate = pEntry->rate;
+         pInfo->dur = pEntry->dur;
+         pInfo->fileSize = pEntry->size;
+         pInfo->mtime = pEntry->mtime;
+         pInfo->bHashed = pEntry->bHashed;
+         pInfo->contentHash = pEntry->contentHash;
+
+         if(pPrev == NULL) pFolder->pFirstMedia = pInfo;
+         else pPrev->pNext = pInfo;
+         pPrev = pInfo;
+         ++(pFolder->nMediaFiles);
+      }
+      nTotalMediaFiles += pFolder->nMediaFiles;
+   }
+
+   // the unsupported files were compacted at the start of the scan list, which we keep for the index
+   if(m_nIgnored > 0)
+   {
+      m_pIgnored = pEntries;
+      pEntries = NULL;
+   }
+   if(pEntries != NULL) ::free(pEntries);
+
+   fprintf(stderr, "(CRMVMediaMgr) Found %d media files in %d folders (%d files probed) in %.2f seconds.\n", 
+      nTotalMediaFiles, m_nMediaFolders, nProbe, eTime.get());
 
    m_bLoaded = true;
+   flushIndex();
    return(true);
 }
 
@@ -542,13 +730,19 @@ void CRMVMediaMgr::replyDeleteMediaFile(CRMVIo* pIOLink)
       }
    
       // if removed file was an image file, make sure the image has been removed from internal image cache
-      if(!pInfo->isVideo) removeImageFromCache(dirName, fName);
+      if(!pInfo->isVideo)
+      {
+         ::pthread_mutex_lock(&m_cacheMutex);
+         removeImageFromCache(dirName, fName);
+         ::pthread_mutex_unlock(&m_cacheMutex);
+      }
      
       // remove entry for file from the TOC
       if(pBef != NULL) pBef->pNext = pInfo->pNext;
       else pFolder->pFirstMedia = pInfo->pNext;
       ::free(pInfo);
       --(pFolder->nMediaFiles);
+      m_bIndexDirty = true;
       
       // if media folder is now empty, try to remove corresponding file system directory. If this fails, the directory
       // may contain some non-media files. Leave the empty folder in our TOC in this case; else remove it. In either
@@ -587,12 +781,18 @@ void CRMVMediaMgr::replyDeleteMediaFile(CRMVIo* pIOLink)
          }
          
          // if removed file was an image file, make sure the image has been removed from internal image cache
-         if(!pInfo->isVideo) removeImageFromCache(dirName, pInfo->filename);
+         if(!pInfo->isVideo)
+         {
+            ::pthread_mutex_lock(&m_cacheMutex);
+            removeImageFromCache(dirName, pInfo->filename);
+            ::pthread_mutex_unlock(&m_cacheMutex);
+         }
 
          // remove entry for file from the TOC
          pFolder->pFirstMedia = pInfo->pNext;
          --(pFolder->nMediaFiles);
          ::free(pInfo);
+         m_bIndexDirty = true;
       }
 
       // now remove the folder. Again, this could fail if there are any non-movie files still in the directory.
@@ -601,6 +801,7 @@ void CRMVMediaMgr::replyDeleteMediaFile(CRMVIo* pIOLink)
       {
          fprintf(stderr, "(CRMVMediaMgr::replyDeleteMediaFile) WARNING: Unable to remove directory corres to\n");
          fprintf(stderr, "   now-empty media folder '%s'. Directory may contain other non-media files\n", path);
+         flushIndex();
          pIOLink->sendSignal(RMV_SIG_CMDERR);
          return;
       }
@@ -612,6 +813,7 @@ void CRMVMediaMgr::replyDeleteMediaFile(CRMVIo* pIOLink)
       ::free(pFolder);
    }
    
+   flushIndex();
    pIOLink->sendSignal(RMV_SIG_CMDACK);
 }
 
@@ -654,6 +856,12 @@ void CRMVMediaMgr::downloadMediaFile(CRMVIo* pIOLink)
       pIOLink->sendSignal(RMV_SIG_CMDERR);
       return;
    }
+   if(isReservedFolderName(dirName))
+   {
+      ::fprintf(stderr, "(CRMVMediaMgr::downloadMediaFile) Folder name '%s' is reserved!\n", dirName);
+      pIOLink->sendSignal(RMV_SIG_CMDERR);
+      return;
+   }
 
    // allocate a TOC entry for the file to be downloaded
    MediaInfo* pNewInfo = (MediaInfo*) ::malloc(sizeof(MediaInfo));
@@ -773,17 +981,323 @@ void CRMVMediaMgr::downloadMediaFile(CRMVIo* pIOLink)
    }
    
    // file was successfully downloaded. Now ensure that RMVideo recognizes it as an image or video file that it can
-   // handle, and extract some info about the video or image for inclusion in the TOC. Preload and cache an image.
+   // handle and add it to the TOC. On failure, the file (and the folder, if we created it) has been removed.
+   ::strcpy(pNewInfo->filename, fName);
+   pNewInfo->bHashed = false;
+   if(!addDownloadedMedia(pFolder, folderCreated, filePath, pNewInfo))
+   {
+      pIOLink->sendSignal(RMV_SIG_CMDERR);
+      return;
+   }
+   pIOLink->sendSignal(RMV_SIG_CMDACK);
+}
+
+/**
+ Download a media file over the Maestro-RMVideo communication link in response to the RMV_CMD_PUTFILEX command. It is
+ assumed that RMV_CMD_PUTFILEX was just received. The names of the destination file and its parent folder are 
+ available via CRMVIo::getMediaFile() and getMediaFolder(), and the file size and content hash via the first four
+ command arguments (CRMVIo::getCommandArg()).
+
+ The destination is checked as in downloadMediaFile(), with one exception: if the destination file already exists and
+ has the same size and content hash, the operation succeeds at once with status RMV_PUTX_EXISTS. Otherwise, if any
+ other file in the media store has the same size and content hash, a copy of it (a hard link, if possible) is installed
+ at the destination and the operation succeeds with status RMV_PUTX_COPIED -- without transferring the file.
+
+ Otherwise the file content is received in a file in PARTIALDIR named for the content size and hash, and the reply 
+ status is RMV_PUTX_SEND. If that file already exists -- from an earlier transfer of the same content that was cut 
+ short by a lost connection -- the transfer resumes at its current length. CRMVIo::downloadFileWindowed() handles the
+ transfer itself. If it succeeds, the size and content hash of the received file are verified before the file is moved
+ to its destination, validated as a media file, and added to the TOC. If the connection is lost, the partial file is
+ kept; if the transfer fails for any other reason or is cancelled, it is removed.
+
+ @param pIOLink The Maestro-RMVideo comm link over which media file download will occur.
+*/
+void CRMVMediaMgr::downloadMediaFileEx(CRMVIo* pIOLink)
+{
+   const char* dirName = pIOLink->getMediaFolder();
+   const char* fName = pIOLink->getMediaFile();
+   uint64_t fileSize = ((uint64_t) ((unsigned int) pIOLink->getCommandArg(1)) << 32) | 
+         (uint64_t) ((unsigned int) pIOLink->getCommandArg(0));
+   uint64_t fileHash = ((uint64_t) ((unsigned int) pIOLink->getCommandArg(3)) << 32) | 
+         (uint64_t) ((unsigned int) pIOLink->getCommandArg(2));
+
+   if(!m_bLoaded) 
+   {
+      ::fprintf(stderr, "(CRMVMediaMgr::downloadMediaFileEx) Media store not initialized!\n");
+      pIOLink->sendSignal(RMV_SIG_CMDERR);
+      return;
+   }
+   if(isReservedFolderName(dirName))
+   {
+      ::fprintf(stderr, "(CRMVMediaMgr::downloadMediaFileEx) Folder name '%s' is reserved!\n", dirName);
+      pIOLink->sendSignal(RMV_SIG_CMDERR);
+      return;
+   }
+   if(!ensureSufficientReplyBufSize(4))
+   {
+      ::perror("(CRMVMediaMgr::downloadMediaFileEx) Memory allocation failed!\n");
+      pIOLink->sendSignal(RMV_SIG_CMDERR);
+      return;
+   }
+   m_pReplyBuf[0] = RMV_SIG_CMDACK;
+   m_pReplyBuf[2] = m_pReplyBuf[3] = 0;
+
+   // if the destination file exists, succeed only if it has the same content
+   MediaFolder* pFolder = findMediaFolder(dirName);
+   MediaInfo* pInfo = (pFolder != NULL) ? findMediaFile(pFolder, fName) : NULL;
+   if(pInfo != NULL)
+   {
+      uint64_t sz = 0, h = 0;
+      if(getContentID(pFolder, pInfo, sz, h) && sz == fileSize && h == fileHash)
+      {
+         ::fprintf(stderr, "(CRMVMediaMgr::downloadMediaFileEx) '%s/%s' is already up to date.\n", dirName, fName);
+         m_pReplyBuf[1] = RMV_PUTX_EXISTS;
+         flushIndex();
+         pIOLink->sendData(4, m_pReplyBuf);
+      }
+      else
+      {
+         ::fprintf(stderr, "(CRMVMediaMgr::downloadMediaFileEx) Destination file '%s/%s' already exists!\n", 
+               dirName, fName);
+         pIOLink->sendSignal(RMV_SIG_CMDERR);
+      }
+      return;
+   }
+
+   // make sure there's room for the file (and its folder)
+   if((pFolder == NULL && m_nMediaFolders == RMV_MVF_LIMIT) || 
+         (pFolder != NULL && pFolder->nMediaFiles == RMV_MVF_LIMIT))
+   {
+      ::fprintf(stderr, "(CRMVMediaMgr::downloadMediaFileEx) No room in media store for '%s/%s'!\n", dirName, fName);
+      pIOLink->sendSignal(RMV_SIG_CMDERR);
+      return;
+   }
+
+   // allocate a TOC entry for the new file, and the folder if necessary
+   MediaInfo* pNewInfo = (MediaInfo*) ::malloc(sizeof(MediaInfo));
+   bool folderCreated = (pFolder == NULL);
+   if(folderCreated && pNewInfo != NULL)
+   {
+      pFolder = (MediaFolder*) ::malloc(sizeof(MediaFolder));
+      if(pFolder != NULL)
+      {
+         ::strcpy(pFolder->name, dirName);
+         pFolder->nMediaFiles = 0;
+         pFolder->pFirstMedia = NULL;
+         pFolder->pNext = NULL;
+      }
+   }
+   if(pNewInfo == NULL || pFolder == NULL)
+   {
+      ::perror("(CRMVMediaMgr::downloadMediaFileEx) Memory allocation failed!\n");
+      if(pNewInfo != NULL) ::free(pNewInfo);
+      pIOLink->sendSignal(RMV_SIG_CMDERR);
+      return;
+   }
    ::strcpy(pNewInfo->filename, fName);
+   pNewInfo->bHashed = true;
+   pNewInfo->contentHash = fileHash;
+
+   char dirPath[256];
+   char filePath[256];
+   ::sprintf(dirPath, "%s/%s", MEDIASTOREDIR, dirName);
+   ::sprintf(filePath, "%s/%s/%s", MEDIASTOREDIR, dirName, fName);
+   if(folderCreated && 0 != ::mkdir(dirPath, 0777))
+   {
+      ::fprintf(stderr, "(CRMVMediaMgr::downloadMediaFileEx) Unable to create directory at '%s'\n", dirPath);
+      ::free(pFolder);
+      ::free(pNewInfo);
+      pIOLink->sendSignal(RMV_SIG_CMDERR);
+      return;
+   }
+
+   // if the same content is elsewhere in the store, install a copy of it at the destination
+   MediaFolder* pSrcFolder = NULL;
+   MediaInfo* pSrcInfo = findContent(fileSize, fileHash, pSrcFolder);
+   if(pSrcInfo != NULL)
+   {
+      char srcPath[256];
+      ::sprintf(srcPath, "%s/%s/%s", MEDIASTOREDIR, pSrcFolder->name, pSrcInfo->filename);
+      bool bOk = (0 == ::link(srcPath, filePath)) || copyFile(srcPath, filePath);
+      if(bOk) bOk = addDownloadedMedia(pFolder, folderCreated, filePath, pNewInfo);
+      else
+      {
+         ::fprintf(stderr, "(CRMVMediaMgr::downloadMediaFileEx) Failed to copy '%s' to '%s'\n", srcPath, filePath);
+         if(folderCreated)
+         {
+            ::free(pFolder);
+            ::rmdir(dirPath);
+         }
+         ::free(pNewInfo);
+      }
+
+      if(bOk)
+      {
+         ::fprintf(stderr, "(CRMVMediaMgr::downloadMediaFileEx) Installed copy of '%s' at '%s'\n", srcPath, filePath);
+         m_pReplyBuf[1] = RMV_PUTX_COPIED;
+         pIOLink->sendData(4, m_pReplyBuf);
+      }
+      else pIOLink->sendSignal(RMV_SIG_CMDERR);
+      return;
+   }
+
+   // otherwise, open the partial download file for this content, creating it if it does not yet exist. If it's 
+   // somehow longer than the file, start over. 
+   char partPath[256];
+   struct stat statInfo;
+   ::sprintf(partPath, "%s/%s", MEDIASTOREDIR, PARTIALDIR);
+   if(0 != ::stat(partPath, &statInfo)) ::mkdir(partPath, 0777);
+   ::sprintf(partPath, "%s/%s/%016llx_%llu.part", MEDIASTOREDIR, PARTIALDIR, (unsigned long long) fileHash,
+         (unsigned long long) fileSize);
+   uint64_t offset = 0;
+   if(0 == ::stat(partPath, &statInfo) && S_ISREG(statInfo.st_mode)) offset = (uint64_t) statInfo.st_size;
+   FILE* fd = ::fopen(partPath, (offset <= fileSize) ? "ab" : "wb");
+   if(offset > fileSize) offset = 0;
+   if(fd == NULL)
+   {
+      ::fprintf(stderr, "(CRMVMediaMgr::downloadMediaFileEx) Failed to open partial download file '%s'\n", partPath);
+      if(folderCreated)
+      {
+         ::free(pFolder);
+         ::rmdir(dirPath);
+      }
+      ::free(pNewInfo);
+      pIOLink->sendSignal(RMV_SIG_CMDERR);
+      return;
+   }
+   if(offset > 0)
+      ::fprintf(stderr, "(CRMVMediaMgr::downloadMediaFileEx) Resuming download of '%s/%s' at byte %llu of %llu.\n",
+            dirName, fName, (unsigned long long) offset, (unsigned long long) fileSize);
+
+   // tell Maestro where to start, then download the rest of the file. The file descriptor is closed regardless.
+   m_pReplyBuf[1] = RMV_PUTX_SEND;
+   m_pReplyBuf[2] = (int) (offset & 0x0FFFFFFFFULL);
+   m_pReplyBuf[3] = (int) (offset >> 32);
+   pIOLink->sendData(4, m_pReplyBuf);
+
+   bool bLinkLost = false;
+   bool bOk = pIOLink->downloadFileWindowed(fd, bLinkLost);
+   if(!bOk)
+   {
+      if(!bLinkLost) ::remove(partPath);
+      if(folderCreated)
+      {
+         ::free(pFolder);
+         ::rmdir(dirPath);
+      }
+      ::free(pNewInfo);
+      return;
+   }
+
+   // verify the file received, move it to its destination (without replacing an existing file), validate it and add 
+   // it to the TOC. Maestro is waiting for the reply to RMV_CMD_PUTFILEDONE.
+   uint64_t sz = 0, h = 0;
+   bOk = computeContentHash(partPath, sz, h) && (sz == fileSize) && (h == fileHash);
+   if(!bOk) ::fprintf(stderr, "(CRMVMediaMgr::downloadMediaFileEx) Downloaded file failed size or hash check!\n");
+   else
+   {
+      bOk = (0 == ::link(partPath, filePath));
+      if(!bOk) ::fprintf(stderr, "(CRMVMediaMgr::downloadMediaFileEx) Failed to install file at '%s'\n", filePath);
+   }
+   ::remove(partPath);
+   if(!bOk)
+   {
+      if(folderCreated)
+      {
+         ::free(pFolder);
+         ::rmdir(dirPath);
+      }
+      ::free(pNewInfo);
+      pIOLink->sendSignal(RMV_SIG_CMDERR);
+      return;
+   }
+
+   if(!addDownloadedMedia(pFolder, folderCreated, filePath, pNewInfo))
+   {
+      pIOLink->sendSignal(RMV_SIG_CMDERR);
+      return;
+   }
+   pIOLink->sendSignal(RMV_SIG_CMDACK);
+}
+
+/**
+ Is the specified name reserved for one of the media store's internal files or directories -- PIXCACHEDIR, PARTIALDIR
+ or INDEXFILE? These are never treated as media folders, and media files may not be downloaded to them.
+ @param name The folder name.
+ @return True if name is reserved.
+*/
+bool CRMVMediaMgr::isReservedFolderName(const char* name)
+{
+   return((0 == ::strcmp(name, PIXCACHEDIR)) || (0 == ::strcmp(name, PARTIALDIR)) || (0 == ::strcmp(name, INDEXFILE)));
+}
+
+/**
+ Find the named media folder in the media store TOC.
+ @param name The folder name.
+ @return The folder's TOC entry, or NULL if not found.
+*/
+CRMVMediaMgr::MediaFolder* CRMVMediaMgr::findMediaFolder(const char* name)
+{
+   MediaFolder* pFolder = m_pFirstMediaFolder;
+   while(pFolder != NULL && ::strcmp(name, pFolder->name) != 0) pFolder = pFolder->pNext;
+   return(pFolder);
+}
+
+/**
+ Find the named media file in the specified media folder's TOC.
+ @param pFolder The media folder.
+ @param name The file name.
+ @return The file's TOC entry, or NULL if not found.
+*/
+CRMVMediaMgr::MediaInfo* CRMVMediaMgr::findMediaFile(MediaFolder* pFolder, const char* name)
+{
+   MediaInfo* pInfo = pFolder->pFirstMedia;
+   while(pInfo != NULL && ::strcmp(name, pInfo->filename) != 0) pInfo = pInfo->pNext;
+   return(pInfo);
+}
+
+/**
+ Validate a media file just installed in the media store and add it to the TOC -- along with its parent folder, if that
+ folder was created for it. RMVideo must recognize the file as an image or video that it can handle; an image file is
+ preloaded into the image cache. On success, a brief summary of the file is printed to stderr, and the persistent
+ media index is updated.
+
+ On failure, the file is removed. If the folder was created for the file, the folder's TOC entry is freed and the 
+ (now empty) directory is removed. The media file's TOC entry is freed as well.
+
+ @param pFolder The TOC entry for the destination folder.
+ @param folderCreated True if the folder was created for this file and is not yet in the TOC.
+ @param filePath Path to the media file.
+ @param pNewInfo The TOC entry for the media file; the file name and content hash fields must be set. Remaining 
+ fields are set here.
+ @return True if successful; false otherwise.
+*/
+bool CRMVMediaMgr::addDownloadedMedia(MediaFolder* pFolder, bool folderCreated, const char* filePath, 
+      MediaInfo* pNewInfo)
+{
    pNewInfo->pNext = NULL;
    pNewInfo->isVideo = false;
    pNewInfo->width = pNewInfo->height = pNewInfo->rate = pNewInfo->dur = 0;
+   pNewInfo->fileSize = 0;
+   pNewInfo->mtime = 0;
+   struct stat statInfo;
+   if(0 == ::stat(filePath, &statInfo))
+   {
+      pNewInfo->fileSize = (uint64_t) statInfo.st_size;
+      pNewInfo->mtime = statInfo.st_mtime;
+   }
+
    bool bOk = true;
    if(CRMVMediaMgr::getImageInfo(filePath, pNewInfo->width, pNewInfo->height))
    {
       bOk = (pNewInfo->width > 0) && (pNewInfo->width <= MAX_IMAGEDIM) && 
             (pNewInfo->height > 0) && (pNewInfo->height <= MAX_IMAGEDIM);
-      if(bOk) bOk = (NULL != addImageToCache(dirName, fName));
+      if(bOk)
+      {
+         ::pthread_mutex_lock(&m_cacheMutex);
+         bOk = (NULL != addImageToCache(pFolder->name, pNewInfo->filename));
+         ::pthread_mutex_unlock(&m_cacheMutex);
+      }
    }
    else if(CVidBuffer::getVideoInfo(filePath, pNewInfo->width, pNewInfo->height, pNewInfo->rate, pNewInfo->dur, true))
    {
@@ -794,29 +1308,28 @@ void CRMVMediaMgr::downloadMediaFile(CRMVIo* pIOLink)
    
    if(!bOk)
    {
-      ::fprintf(stderr, "(CRMVMediaMgr::downloadMediaFile) Cannot read downloaded media file, or file format is \n");
+      ::fprintf(stderr, "(CRMVMediaMgr::addDownloadedMedia) Cannot read downloaded media file, or file format is \n");
       ::fprintf(stderr, "   not supported, or image W or H exceeds %ld. Deleting %s...\n", MAX_IMAGEDIM, filePath);
       ::remove(filePath);
       if(folderCreated)
       {
+         char dirPath[256];
+         ::sprintf(dirPath, "%s/%s", MEDIASTOREDIR, pFolder->name);
          ::free(pFolder);
          ::rmdir(dirPath);
       }
       ::free(pNewInfo);
-      pIOLink->sendSignal(RMV_SIG_CMDERR);
-      return;
+      return(false);
    }
-      
-   pIOLink->sendSignal(RMV_SIG_CMDACK);
 
-   ::fprintf(stderr, "(CRMVMediaMgr::downloadMediaFile) Media file successfully downloaded to %s. Stats:\n", filePath);
+   ::fprintf(stderr, "(CRMVMediaMgr::addDownloadedMedia) Media file successfully downloaded to %s. Stats:\n", filePath);
    if(pNewInfo->isVideo)
       ::fprintf(stderr, "  %d x %d frame size in pixels; %.3f Hz; %.3f seconds.\n", pNewInfo->width, pNewInfo->height,
              ((double) pNewInfo->rate) / 1000.0, ((double) pNewInfo->dur) / 1000.0);
    else
       ::fprintf(stderr, "  %d x %d image size in pixels.\n", pNewInfo->width, pNewInfo->height);
    
-   // success. Add entry to TOC for the new file and, if necessary, a new media folder. Then ack success w/Maestro.
+   // success. Add entry to TOC for the new file and, if necessary, a new media folder.
    if(folderCreated)
    {
       if(m_pFirstMediaFolder == NULL) m_pFirstMediaFolder = pFolder;
@@ -837,51 +1350,282 @@ void CRMVMediaMgr::downloadMediaFile(CRMVIo* pIOLink)
       pLast->pNext = pNewInfo;
    }
    ++(pFolder->nMediaFiles);
+
+   m_bIndexDirty = true;
+   flushIndex();
+   return(true);
 }
 
 /**
- Retrieve an image from the media store. 
-
- NOTE: Images are cached internally by CRMVMediaMgr to optimize access to very large images (e.g., 2560x1440). It is
- imperative that callers never free() the image buffer pointer returned by this method, nor keep a reference to it --
- since the image data could be released at any time if the cache grows too large.
-
- @param folder Name of media folder containing image source file.
- @param file Name of image source file.
- @param width [out] On successful return, contains image width in pixels; else, 0.
- @param height [out] On successful return, contains image height in pixels; else, 0.
- @return A pointer to the image data buffer. Returns NULL on failure, in which case a very brief error description is 
- printed to stderr. 
+ Get the content ID -- size and content hash (see RMV_CONTENTHASH in rmvideo_common.h) -- of a media file in the media
+ store. The hash is computed on first request and cached in the file's TOC entry (and, eventually, in the persistent
+ media index); it is recomputed if the file's size or modification time has changed since.
+ @param pFolder The media folder.
+ @param pInfo The TOC entry for the media file.
+ @param size [out] The file size in bytes.
+ @param hash [out] The file's content hash.
+ @return True if successful; false if the file could not be read.
 */
-unsigned char* CRMVMediaMgr::getImage(const char* folder, const char* file, int& width, int& height)
+bool CRMVMediaMgr::getContentID(MediaFolder* pFolder, MediaInfo* pInfo, uint64_t& size, uint64_t& hash)
 {
-   // try the image cache first. If it's not cached, load the image and cache it
-   CachedImage* cachedImg = retrieveImageFromCache(folder, file);
-   if(cachedImg == NULL) cachedImg = addImageToCache(folder, file);
+   char path[256];
+   struct stat statInfo;
+   ::sprintf(path, "%s/%s/%s", MEDIASTOREDIR, pFolder->name, pInfo->filename);
+   if(0 != ::stat(path, &statInfo)) return(false);
 
-   if(cachedImg == NULL)
+   if(!(pInfo->bHashed && pInfo->mtime == statInfo.st_mtime && pInfo->fileSize == (uint64_t) statInfo.st_size))
    {
-      width = height = 0;
-      return(NULL);
+      pInfo->bHashed = false;
+      if(!computeContentHash(path, pInfo->fileSize, pInfo->contentHash)) return(false);
+      pInfo->bHashed = true;
+      pInfo->mtime = statInfo.st_mtime;
+      m_bIndexDirty = true;
    }
-   
-   width = cachedImg->wPix;
-   height = cachedImg->hPix;
-   return(cachedImg->pImgBuf);
+   size = pInfo->fileSize;
+   hash = pInfo->contentHash;
+   return(true);
 }
 
 /**
- Reallocate the integer reply buffer if it is not large enough to accommodate the requested size.
- @param sz The reply buffer size needed.
- @return True if reply buffer was already large enough or was reallocated to accommodate the specified size. If it
- was not reallocated successfully, the reply buffer will be NULL and false is returned.
+ Search the media store for a file with the specified content ID. Only files of the specified size are hashed.
+ @param size The file size in bytes.
+ @param hash The file's content hash.
+ @param pFolder [out] The media folder containing the matching file; undefined if there is no match.
+ @return The TOC entry of the matching file, or NULL if there is none.
 */
-bool CRMVMediaMgr::ensureSufficientReplyBufSize(int sz)
+CRMVMediaMgr::MediaInfo* CRMVMediaMgr::findContent(uint64_t size, uint64_t hash, MediaFolder*& pFolder)
 {
-   if(sz < m_nReplyBufSz) return(true);
-
-   if(m_pReplyBuf != NULL) ::free(m_pReplyBuf);
-   m_nReplyBufSz = 0;
+   char path[256];
+   struct stat statInfo;
+   for(pFolder = m_pFirstMediaFolder; pFolder != NULL; pFolder = pFolder->pNext)
+   {
+      for(MediaInfo* pInfo = pFolder->pFirstMedia; pInfo != NULL; pInfo = pInfo->pNext)
+      {
+         ::sprintf(path, "%s/%s/%s", MEDIASTOREDIR, pFolder->name, pInfo->filename);
+         if(0 != ::stat(path, &statInfo) || (uint64_t) statInfo.st_size != size) continue;
+
+         uint64_t sz = 0, h = 0;
+         if(getContentID(pFolder, pInfo, sz, h) && sz == size && h == hash) return(pInfo);
+      }
+   }
+   return(NULL);
+}
+
+/**
+ Compute the size and content hash of a file IAW the definition of RMV_CONTENTHASH in rmvideo_common.h.
+ @param path Path to the file.
+ @param size [out] The file size in bytes.
+ @param hash [out] The file's content hash.
+ @return True if successful; false if the file could not be read.
+*/
+bool CRMVMediaMgr::computeContentHash(const char* path, uint64_t& size, uint64_t& hash)
+{
+   static const size_t BLKSZ = 1024*1024;
+
+   FILE* fd = ::fopen(path, "rb");
+   unsigned char* pBuf = (fd != NULL) ? (unsigned char*) ::malloc(BLKSZ) : NULL;
+   if(pBuf == NULL)
+   {
+      if(fd != NULL) ::fclose(fd);
+      return(false);
+   }
+
+   // file is read in blocks that are a multiple of 8 bytes, so only the last word of the file may be partial
+   uint64_t h = RMV_CONTENTHASH_BASIS;
+   uint64_t n = 0;
+   size_t nRead;
+   while((nRead = ::fread(pBuf, 1, BLKSZ, fd)) > 0)
+   {
+      n += nRead;
+      for(size_t i = 0; i < nRead; i += 8)
+      {
+         uint64_t w = 0;
+         for(size_t j = 0; j < 8 && i + j < nRead; j++) w |= ((uint64_t) pBuf[i + j]) << (8*j);
+         h = (h ^ w) * RMV_CONTENTHASH_PRIME;
+      }
+   }
+   bool bOk = (0 == ::ferror(fd));
+   ::fclose(fd);
+   ::free(pBuf);
+
+   h = (h ^ n) * RMV_CONTENTHASH_PRIME;
+   size = n;
+   hash = h;
+   return(bOk);
+}
+
+/**
+ Copy a file. The destination file must not already exist.
+ @param src Path to the source file.
+ @param dst Path to the destination file.
+ @return True if successful. On failure, the destination file is removed.
+*/
+bool CRMVMediaMgr::copyFile(const char* src, const char* dst)
+{
+   int fdSrc = ::open(src, O_RDONLY);
+   if(fdSrc < 0) return(false);
+   int fdDst = ::open(dst, O_WRONLY | O_CREAT | O_EXCL, 0666);
+   if(fdDst < 0)
+   {
+      ::close(fdSrc);
+      return(false);
+   }
+
+   char buf[65536];
+   bool bOk = true;
+   ssize_t n;
+   while(bOk && (n = ::read(fdSrc, buf, sizeof(buf))) != 0)
+   {
+      bOk = (n > 0) && (n == ::write(fdDst, buf, n));
+   }
+   ::close(fdSrc);
+   if(0 != ::close(fdDst)) bOk = false;
+   if(!bOk) ::remove(dst);
+   return(bOk);
+}
+
+/**
+ Retrieve an image from the media store. 
+
+ NOTE: Images are cached internally by CRMVMediaMgr to optimize access to very large images (e.g., 2560x1440). It is
+ imperative that callers never free() the image buffer pointer returned by this method, nor keep a reference to it --
+ since the image data could be released at any time if the cache grows too large.
+
+ A cached image is used only if its source file's modification time has not changed since it was cached; otherwise 
+ it is reloaded. Each call counts as a hit or a miss in the image cache statistics. On a miss, the image is decoded 
+ without holding the image cache mutex, so the image preload thread is not blocked in the meantime. Only this method
+ evicts images from the cache, so the returned buffer remains valid at least until the next call.
+
+ This method may be called from several threads at once, in which case another thread's call could evict the image 
+ returned. To prevent that, pin the image and call unpinImage() once the image buffer is no longer needed. A pinned
+ image is never evicted (even if that means the cache temporarily exceeds its capacity), nor is it reloaded if its
+ source file changes in the meantime. Pins should only be held briefly.
+
+ @param folder Name of media folder containing image source file.
+ @param file Name of image source file.
+ @param width [out] On successful return, contains image width in pixels; else, 0.
+ @param height [out] On successful return, contains image height in pixels; else, 0.
+ @param bPin If set, the image is pinned in the cache until the next call to unpinImage(). Default = false.
+ @return A pointer to the image data buffer. Returns NULL on failure, in which case a very brief error description is 
+ printed to stderr. 
+*/
+unsigned char* CRMVMediaMgr::getImage(const char* folder, const char* file, int& width, int& height, bool bPin)
+{
+   char path[100];
+   ::sprintf(path, "%s/%s/%s", MEDIASTOREDIR, folder, file);
+   struct stat statInfo;
+   bool bExists = (0 == ::stat(path, &statInfo));
+
+   // try the image cache first, discarding the cached image if source file has changed
+   ::pthread_mutex_lock(&m_cacheMutex);
+   CachedImage* cachedImg = retrieveImageFromCache(folder, file);
+   if(cachedImg != NULL && cachedImg->nPins == 0 && !(bExists && statInfo.st_mtime == cachedImg->mtime))
+   {
+      removeImageFromCache(folder, file);
+      cachedImg = NULL;
+   }
+   if(cachedImg != NULL)
+   {
+      ++m_nCacheHits;
+      touchCachedImage(cachedImg);
+      if(bPin) ++cachedImg->nPins;
+   }
+   else ++m_nCacheMisses;
+   ::pthread_mutex_unlock(&m_cacheMutex);
+
+   // if it's not cached, load the image and cache it
+   if(cachedImg == NULL)
+   {
+      time_t mtime = 0;
+      int w = 0, h = 0;
+      size_t mapSz = 0;
+      bool bDiskHit = false;
+      unsigned char* buf = decodeImage(folder, file, mtime, w, h, mapSz, bDiskHit);
+      if(buf == NULL)
+      {
+         width = height = 0;
+         return(NULL);
+      }
+
+      ::pthread_mutex_lock(&m_cacheMutex);
+      if(bDiskHit) ++m_nDiskCacheHits;
+      cachedImg = insertCachedImage(folder, file, mtime, w, h, buf, mapSz);
+      if(cachedImg != NULL && bPin) ++cachedImg->nPins;
+      ::pthread_mutex_unlock(&m_cacheMutex);
+      if(cachedImg == NULL)
+      {
+         width = height = 0;
+         return(NULL);
+      }
+   }
+
+   width = cachedImg->wPix;
+   height = cachedImg->hPix;
+   return(cachedImg->pImgBuf);
+}
+
+/**
+ Release a pin on an image that was pinned in the image cache by getImage(). Once all pins on the image are released,
+ it may be evicted from the cache again. No action is taken if the image is not cached or not pinned.
+
+ @param folder Name of media folder containing image source file.
+ @param file Name of image source file.
+*/
+void CRMVMediaMgr::unpinImage(const char* folder, const char* file)
+{
+   ::pthread_mutex_lock(&m_cacheMutex);
+   CachedImage* cachedImg = retrieveImageFromCache(folder, file);
+   if(cachedImg != NULL && cachedImg->nPins > 0) --cachedImg->nPins;
+   ::pthread_mutex_unlock(&m_cacheMutex);
+}
+
+/**
+ Set the capacity of the internal image cache. The default is 300MB. Should be called before startImagePreload(), since
+ the cache is preloaded with images from the media store until it reaches capacity.
+ @param nMB The cache capacity in MB. Range-limited to [MIN_IMGCACHEMB..MAX_IMGCACHEMB].
+*/
+void CRMVMediaMgr::setImageCacheBudget(int nMB)
+{
+   if(nMB < MIN_IMGCACHEMB) nMB = MIN_IMGCACHEMB;
+   else if(nMB > MAX_IMGCACHEMB) nMB = MAX_IMGCACHEMB;
+   m_nCacheBudget = ((unsigned long) nMB) * 1000000L;
+}
+
+/**
+ Reply to the Maestro command RMV_CMD_GETIMGCACHESTATS, sending back the image cache statistics IAW the expected format
+ for the reply payload. See RMVIDEO_COMMON.H. It is assumed that the RMV_CMD_GETIMGCACHESTATS command was just received.
+
+ @param pIOLink The Maestro-RMVideo comm link. Reply is sent over this link.
+*/
+void CRMVMediaMgr::replyGetImageCacheStats(CRMVIo* pIOLink)
+{
+   int reply[RMV_IMGCACHESTATS_LEN + 1];
+   ::pthread_mutex_lock(&m_cacheMutex);
+   reply[0] = RMV_SIG_CMDACK;
+   reply[1 + RMV_IMGCACHESTATS_NIMAGES] = (int) m_nCachedImages;
+   reply[1 + RMV_IMGCACHESTATS_SIZEKB] = (int) (m_nCacheSize / 1024L);
+   reply[1 + RMV_IMGCACHESTATS_BUDGETKB] = (int) (m_nCacheBudget / 1024L);
+   reply[1 + RMV_IMGCACHESTATS_HITS] = (int) m_nCacheHits;
+   reply[1 + RMV_IMGCACHESTATS_MISSES] = (int) m_nCacheMisses;
+   reply[1 + RMV_IMGCACHESTATS_EVICTIONS] = (int) m_nCacheEvictions;
+   reply[1 + RMV_IMGCACHESTATS_DISKHITS] = (int) m_nDiskCacheHits;
+   reply[1 + RMV_IMGCACHESTATS_DISKENA] = m_bDiskCache ? 1 : 0;
+   ::pthread_mutex_unlock(&m_cacheMutex);
+   pIOLink->sendData(RMV_IMGCACHESTATS_LEN + 1, reply);
+}
+
+/**
+ Reallocate the integer reply buffer if it is not large enough to accommodate the requested size.
+ @param sz The reply buffer size needed.
+ @return True if reply buffer was already large enough or was reallocated to accommodate the specified size. If it
+ was not reallocated successfully, the reply buffer will be NULL and false is returned.
+*/
+bool CRMVMediaMgr::ensureSufficientReplyBufSize(int sz)
+{
+   if(sz < m_nReplyBufSz) return(true);
+
+   if(m_pReplyBuf != NULL) ::free(m_pReplyBuf);
+   m_nReplyBufSz = 0;
       
    m_pReplyBuf = (int*) ::calloc(sz + 100, sizeof(int));
    if(m_pReplyBuf == NULL) return(false);
@@ -932,20 +1676,19 @@ bool CRMVMediaMgr::appendMediaFolder(const char* folderName)
 }
 
 /**
- Helper method for load(). Scans all files in the specified media folder and appends an entry in the TOC for each
- such file that can is recognized either as a supported video file (via CVidBuffer::getVideoInfo()) or as a supported
- image file (via CRMVMediaMgr::getImageInfo()). Assumes that the directory corresponding to the folder already exists 
- in the media store. Scan stops once RMV_MVF_LIMIT media files have been found in the directory.
-
- To optimize access to very large (fullscreen) images, the method preloads images into an internal cache (until that
- cache reaches capacity). Since image loading is relatively slow (1-2 seconds for a 2560x1440 image), this method 
- could take some to complete if the media folder contains many large images.
+ Helper method for load(). Lists all files in the specified media folder that are candidate media files -- regular
+ files with valid names --, appending an entry for each to the scan list. Each entry records the file name, its parent
+ folder, and the file's size and modification time; the remaining fields are cleared. The files themselves are not
+ opened; see probeMediaFile(). Assumes that the directory corresponding to the folder already exists in the media 
+ store.
  
  @param pFolder The media folder to scan.
+ @param pEntries [in/out] The scan list. It is reallocated as needed.
+ @param nEntries [in/out] The number of entries in the scan list.
+ @param nCap [in/out] The capacity of the scan list.
  @return True if successful, false if memory allocation failed or unable to scan directory (msg printed to stderr).
- Does not fail if an unrecognized file is encountered; such files are simply "skipped over".
  */
-bool CRMVMediaMgr::scanMediaFolder(MediaFolder* pFolder)
+bool CRMVMediaMgr::scanMediaFolder(MediaFolder* pFolder, ScanEntry*& pEntries, int& nEntries, int& nCap)
 {
    char path[255];
    ::sprintf(path, "%.50s/%.100s", MEDIASTOREDIR, pFolder->name);
@@ -957,15 +1700,6 @@ bool CRMVMediaMgr::scanMediaFolder(MediaFolder* pFolder)
       return(false);
    }
    
-   // find the last media file currently in the TOC for the folder (if any). If the folder is already full, do not scan.
-   if(pFolder->nMediaFiles == RMV_MVF_LIMIT)
-   {
-      ::closedir(pDir);
-      return(true);
-   }
-   MediaInfo* pPrev = pFolder->pFirstMedia;
-   if(pPrev != NULL) while(pPrev->pNext != NULL) pPrev = pPrev->pNext;
-   
    struct stat statInfo;
    struct dirent* pDirEntry = ::readdir(pDir);
    while(pDirEntry != NULL)
@@ -985,78 +1719,216 @@ bool CRMVMediaMgr::scanMediaFolder(MediaFolder* pFolder)
          append = (0 == ::stat(path, &statInfo));
          if(append) append = S_ISREG(statInfo.st_mode);
       }
-      
-      // check that file is a supported image or video file
-      int type = -1;   // 0 = image, 1 = video
-      int width = 0, height = 0, rate = 0, dur = 0;
-      if(append)
+
+      // grow the scan list as needed
+      if(append && nEntries == nCap)
       {
-         if(CRMVMediaMgr::getImageInfo(path, width, height) && width > 0 && height > 0)
+         int nNewCap = (nCap == 0) ? 256 : 2*nCap;
+         ScanEntry* pNew = (ScanEntry*) ::realloc(pEntries, nNewCap * sizeof(ScanEntry));
+         if(pNew == NULL)
          {
-            type = 0;
-            if(width > MAX_IMAGEDIM || height > MAX_IMAGEDIM)
-            {
-               append = false;
-               fprintf(stderr, "(CRMVMediaMgr::scanMediaFolder) Ignoring file '%s': Image is too large.\n", path);
-            }
-         }
-         else if(CVidBuffer::getVideoInfo(path, width, height, rate, dur, false)) type = 1;
-         else
-         {
-            append = false;
-            fprintf(stderr, "(CRMVMediaMgr::scanMediaFolder) Ignoring file '%s': Not a supported media file.\n", path);
+            ::perror("(CRMVMediaMgr::scanMediaFolder) Memory allocation failed!\n");
+            ::closedir(pDir);
+            return(false);
          }
+         pEntries = pNew;
+         nCap = nNewCap;
+      }
+
+      if(append)
+      {
+         ScanEntry* pEntry = &(pEntries[nEntries++]);
+         ::memset(pEntry, 0, sizeof(ScanEntry));
+         ::strcpy(pEntry->folder, pFolder->name);
+         ::strcpy(pEntry->file, pDirEntry->d_name);
+         pEntry->size = (uint64_t) statInfo.st_size;
+         pEntry->mtime = statInfo.st_mtime;
+         pEntry->type = -1;
       }
       
-      // if it's a supported image file, preload the image unless the image cache has reached capacity. If we are unable
-      // to load image, that's an indication the image file is not valid.
-      if(append && type==0 && ((m_nCacheSize + width*height*4) < MAX_IMGCACHESZ))
+      pDirEntry = ::readdir(pDir);
+   }
+   ::closedir(pDir);
+
+   return(true);
+}
+
+/**
+ Helper method for load(). Probes a file found in the media store to determine whether it is a supported image file 
+ (via CRMVMediaMgr::getImageInfo()) or a supported video file (via CVidBuffer::getVideoInfo()), and retrieves the 
+ image or video frame size -- plus frame rate and duration for a video. An image that exceeds MAX_IMAGEDIM in either
+ dimension is not supported. This is a CWorkerPool job function; it may run concurrently with other probes.
+
+ @param pArg The scan list (an array of ScanEntry).
+ @param iJob Index of the entry to probe. No action is taken if the entry's bProbe flag is not set.
+*/
+void CRMVMediaMgr::probeMediaFile(void* pArg, int iJob)
+{
+   ScanEntry* pEntry = &(((ScanEntry*) pArg)[iJob]);
+   if(!pEntry->bProbe) return;
+
+   char path[255];
+   ::sprintf(path, "%.50s/%.100s/%.100s", MEDIASTOREDIR, pEntry->folder, pEntry->file);
+   int width = 0, height = 0, rate = 0, dur = 0;
+   pEntry->type = -1;
+   if(CRMVMediaMgr::getImageInfo(path, width, height) && width > 0 && height > 0)
+   {
+      if(width > (int) MAX_IMAGEDIM || height > (int) MAX_IMAGEDIM)
+         fprintf(stderr, "(CRMVMediaMgr::probeMediaFile) Ignoring file '%s': Image is too large.\n", path);
+      else pEntry->type = 0;
+   }
+   else if(CVidBuffer::getVideoInfo(path, width, height, rate, dur, true)) pEntry->type = 1;
+   else fprintf(stderr, "(CRMVMediaMgr::probeMediaFile) Ignoring file '%s': Not a supported media file.\n", path);
+
+   if(pEntry->type < 0) width = height = rate = dur = 0;
+   pEntry->width = width;
+   pEntry->height = height;
+   pEntry->rate = rate;
+   pEntry->dur = dur;
+   pEntry->bHashed = false;
+   pEntry->contentHash = 0;
+}
+
+/**
+ Read the persistent media index, INDEXFILE in the media store. The index is a text file. The first line is INDEXTAG,
+ and each remaining line describes one file in the media store: folder and file name, file size in bytes, modification
+ time (seconds since the epoch), type (0 = image, 1 = video, -1 = not a supported media file), width, height, frame 
+ rate (milliHz), duration (ms), a flag that is set if the content hash is known, and the content hash in hexadecimal. 
+ Malformed lines are skipped. The index is only a cache -- a file that is missing from it is simply probed again --,
+ so this method never fails outright.
+
+ @param n [out] The number of index entries read.
+ @return The index entries, sorted by folder and file name (see compareScanEntries()). Returns NULL if the index does
+ not exist, is not recognized, or could not be read. Caller is responsible for freeing the array.
+*/
+CRMVMediaMgr::ScanEntry* CRMVMediaMgr::readIndex(int& n)
+{
+   n = 0;
+   char path[256];
+   ::sprintf(path, "%.50s/%.20s", MEDIASTOREDIR, INDEXFILE);
+   FILE* fp = ::fopen(path, "r");
+   if(fp == NULL) return(NULL);
+
+   char line[256];
+   bool bOk = (NULL != ::fgets(line, sizeof(line), fp));
+   if(bOk)
+   {
+      line[::strcspn(line, "\r\n")] = '\0';
+      bOk = (0 == ::strcmp(line, INDEXTAG));
+      if(!bOk) fprintf(stderr, "(CRMVMediaMgr) Media index format not recognized; rebuilding index.\n");
+   }
+
+   ScanEntry* pEntries = NULL;
+   int nCap = 0;
+   while(bOk && NULL != ::fgets(line, sizeof(line), fp))
+   {
+      char folder[64], file[64];
+      unsigned long long sz = 0, hash = 0;
+      long long t = 0;
+      int type = 0, w = 0, h = 0, rate = 0, dur = 0, hashed = 0;
+      if(11 != ::sscanf(line, "%63s %63s %llu %lld %d %d %d %d %d %d %llx", folder, file, &sz, &t, &type, &w, &h, 
+            &rate, &dur, &hashed, &hash)) 
+         continue;
+      if(::strlen(folder) > RMV_MVF_LEN || ::strlen(file) > RMV_MVF_LEN || type < -1 || type > 1) continue;
+
+      if(n == nCap)
       {
-         CachedImage* pCachedImg = addImageToCache(pFolder->name, pDirEntry->d_name);
-         if(pCachedImg == NULL)
+         int nNewCap = (nCap == 0) ? 256 : 2*nCap;
+         ScanEntry* pNew = (ScanEntry*) ::realloc(pEntries, nNewCap * sizeof(ScanEntry));
+         if(pNew == NULL)
          {
-            fprintf(stderr, "(CRMVMediaMgr::scanMediaFolder) Ignoring image '%s': Failed to load image data.\n", path);
-            append = false;
+            bOk = false;
+            break;
          }
+         pEntries = pNew;
+         nCap = nNewCap;
       }
 
-      // if we've found a supported media file, append a TOC entry for it
-      if(append)
+      ScanEntry* pEntry = &(pEntries[n++]);
+      ::strcpy(pEntry->folder, folder);
+      ::strcpy(pEntry->file, file);
+      pEntry->size = (uint64_t) sz;
+      pEntry->mtime = (time_t) t;
+      pEntry->type = type;
+      pEntry->width = w;
+      pEntry->height = h;
+      pEntry->rate = rate;
+      pEntry->dur = dur;
+      pEntry->bHashed = (hashed != 0);
+      pEntry->contentHash = (uint64_t) hash;
+      pEntry->bProbe = false;
+   }
+   if(::ferror(fp)) bOk = false;
+   ::fclose(fp);
+
+   if(!bOk)
+   {
+      if(pEntries != NULL) ::free(pEntries);
+      n = 0;
+      return(NULL);
+   }
+   if(n > 0) ::qsort(pEntries, n, sizeof(ScanEntry), CRMVMediaMgr::compareScanEntries);
+   return(pEntries);
+}
+
+/**
+ Comparison function for sorting and searching the persistent media index: entries are ordered by folder name, then
+ file name.
+*/
+int CRMVMediaMgr::compareScanEntries(const void* p1, const void* p2)
+{
+   const ScanEntry* pE1 = (const ScanEntry*) p1;
+   const ScanEntry* pE2 = (const ScanEntry*) p2;
+   int res = ::strcmp(pE1->folder, pE2->folder);
+   return((res != 0) ? res : ::strcmp(pE1->file, pE2->file));
+}
+
+/**
+ Rewrite the persistent media index (see readIndex() for the file format) if it has changed. It lists every media file
+ in the TOC, plus the unsupported files found by load(). To ensure that a partially written index is never read, the
+ file is written under a temporary name, then renamed. On failure, a warning is printed to stderr; the index remains 
+ dirty, so another attempt is made the next time this method is called.
+*/
+void CRMVMediaMgr::flushIndex()
+{
+   if(!m_bIndexDirty) return;
+
+   char path[256];
+   char tmpPath[260];
+   ::sprintf(path, "%.50s/%.20s", MEDIASTOREDIR, INDEXFILE);
+   ::sprintf(tmpPath, "%s.tmp", path);
+
+   FILE* fp = ::fopen(tmpPath, "w");
+   bool bOk = (fp != NULL);
+   if(bOk)
+   {
+      ::fprintf(fp, "%s\n", INDEXTAG);
+      for(MediaFolder* pFolder = m_pFirstMediaFolder; pFolder != NULL; pFolder = pFolder->pNext)
       {
-         MediaInfo* pInfo = (MediaInfo*) ::malloc(sizeof(MediaInfo));
-         if(pInfo == NULL)
+         for(MediaInfo* pInfo = pFolder->pFirstMedia; pInfo != NULL; pInfo = pInfo->pNext)
          {
-            ::perror("(CRMVMediaMgr::scanMediaFolder) Memory allocation failed!\n");
-            ::closedir(pDir);
-            return(false);
+            ::fprintf(fp, "%s %s %llu %lld %d %d %d %d %d %d %016llx\n", pFolder->name, pInfo->filename, 
+                  (unsigned long long) pInfo->fileSize, (long long) pInfo->mtime, pInfo->isVideo ? 1 : 0, 
+                  pInfo->width, pInfo->height, pInfo->rate, pInfo->dur, pInfo->bHashed ? 1 : 0, 
+                  (unsigned long long) pInfo->contentHash);
          }
-         
-         ::strcpy(pInfo->filename, pDirEntry->d_name);
-         pInfo->pNext = NULL;
-         pInfo->isVideo = (type == 1) ? true : false;
-         pInfo->width = width;
-         pInfo->height = height;
-         pInfo->rate = rate;
-         pInfo->dur = dur;
-         
-         if(pPrev == NULL) pFolder->pFirstMedia = pInfo;
-         else pPrev->pNext = pInfo;
-         pPrev = pInfo;
-         
-         ++(pFolder->nMediaFiles);
       }
-      
-      // proceed to next file, unless we've reached capacity for this folder
-      pDirEntry = ::readdir(pDir);
-      if(pDirEntry != NULL && pFolder->nMediaFiles == RMV_MVF_LIMIT)
+      for(int i=0; i<m_nIgnored; i++)
       {
-         fprintf(stderr, "(CRMVMediaMgr::scanMediaFolder) Media folder '%s' is full.\n", pFolder->name);
-         break;
+         ScanEntry* pEntry = &(m_pIgnored[i]);
+         ::fprintf(fp, "%s %s %llu %lld -1 0 0 0 0 0 %016llx\n", pEntry->folder, pEntry->file, 
+               (unsigned long long) pEntry->size, (long long) pEntry->mtime, 0ULL);
       }
+      bOk = (0 == ::ferror(fp));
+      if(0 != ::fclose(fp)) bOk = false;
+   }
+   if(bOk) bOk = (0 == ::rename(tmpPath, path));
+   if(bOk) m_bIndexDirty = false;
+   else
+   {
+      ::remove(tmpPath);
+      fprintf(stderr, "(CRMVMediaMgr) WARNING: Failed to write media index %s\n", path);
    }
-   ::closedir(pDir);
-
-   return(true);
 }
 
 /**
@@ -1110,22 +1982,24 @@ void CRMVMediaMgr::freeImageData(unsigned char* pImgData)
 /** Empty the internal image cache. Be sure to call this before RMVideo exits. */
 void CRMVMediaMgr::releaseImageCache()
 {
-   while(m_pImageCache != NULL)
+   while(m_pLRUHead != NULL)
    {
-      CachedImage* pDead = m_pImageCache;
-      m_pImageCache = pDead->pNext;
-      pDead->pNext = NULL;
+      CachedImage* pDead = m_pLRUHead;
+      m_pLRUHead = pDead->pLRUNext;
 
-      CRMVMediaMgr::freeImageData(pDead->pImgBuf);
+      CRMVMediaMgr::freeCachedImageData(pDead);
       ::free(pDead);
       pDead = NULL;
    }
+   m_pLRUTail = NULL;
+   for(int i=0; i<IMGHASHSZ; i++) m_imgHash[i] = NULL;
    m_nCachedImages = 0;
    m_nCacheSize = 0L;
 }
 
 /**
- Retrieve the specified image from the internal, in-memory image cache.
+ Retrieve the specified image from the internal, in-memory image cache. The image's position in the cache's LRU list
+ is NOT changed; see touchCachedImage().
 
  @param folder [in] The name of the media store folder containing the image source file.
  @param file [in] The name of the image source file.
@@ -1133,23 +2007,18 @@ void CRMVMediaMgr::releaseImageCache()
 */
 CRMVMediaMgr::CachedImage* CRMVMediaMgr::retrieveImageFromCache(const char* folder, const char* file)
 {
-   CachedImage* pFound = m_pImageCache;
+   CachedImage* pFound = m_imgHash[CRMVMediaMgr::hashImageKey(folder, file)];
    while(pFound != NULL)
    {
-      if(::strcmp(pFound->folderName, folder)==0 && ::strcmp(pFound->fileName, file)==0) break;
-      pFound = pFound->pNext;
+      if(::strcmp(pFound->fileName, file)==0 && ::strcmp(pFound->folderName, folder)==0) break;
+      pFound = pFound->pNextInBucket;
    }
    return(pFound);
 }
 
 /**
- Load an image from the specified source file in the media store and add it to an internal, in-memory cache.
-
- The image cache is implemented as a singly-linked list of image "slots", with new images appended to the end of the 
- list. The cache will grow until it reaches a total capacity of MAX_IMGCACHESZ, at which point the oldest image(s) are
- removed from the head of the cache until there's room for the specified image.
-
- See also: CRMVMediaMgr::loadImageData().
+ Load an image from the specified source file in the media store and add it to the internal, in-memory image cache.
+ The caller must hold the image cache mutex. See decodeImage() and insertCachedImage().
 
  @param folder [in] The name of the media store folder containing the image source file.
  @param file [in] The name of the image source file.
@@ -1161,82 +2030,476 @@ CRMVMediaMgr::CachedImage* CRMVMediaMgr::addImageToCache(const char* folder, con
    CachedImage* pCached = retrieveImageFromCache(folder, file);
    if(pCached != NULL) return(pCached);
 
-   // load the image data -- abort if we can't
+   time_t mtime = 0;
+   int w = 0, h = 0;
+   size_t mapSz = 0;
+   bool bDiskHit = false;
+   unsigned char* buf = decodeImage(folder, file, mtime, w, h, mapSz, bDiskHit);
+   if(buf == NULL) return(NULL);
+   if(bDiskHit) ++m_nDiskCacheHits;
+   return(insertCachedImage(folder, file, mtime, w, h, buf, mapSz));
+}
+
+/**
+ Load an image from the specified source file in the media store, ready for insertion into the image cache. This 
+ method does not access the in-memory image cache, so it may be called without holding the image cache mutex.
+
+ If the on-disk pixel cache is enabled, the decoded image is retrieved from that cache by memory-mapping the cache
+ file, so long as that file is consistent with the image source file's current modification time. Otherwise, the 
+ image is decoded from its source file and then written to the on-disk cache.
+
+ See also: CRMVMediaMgr::loadImageData().
+
+ @param folder [in] The name of the media store folder containing the image source file.
+ @param file [in] The name of the image source file.
+ @param mtime [out] The modification time of the image source file.
+ @param w, h [out] The image width and height in pixels.
+ @param mapSz [out] If the image was mapped from the on-disk pixel cache, the size of the mapped region; else 0.
+ @param bDiskHit [out] Set if the image was mapped from the on-disk pixel cache.
+ @return The image buffer -- or, if mapSz is nonzero, the start of the mapped region --, or NULL if operation fails.
+*/
+unsigned char* CRMVMediaMgr::decodeImage(const char* folder, const char* file, time_t& mtime, int& w, int& h, 
+      size_t& mapSz, bool& bDiskHit)
+{
+   mapSz = 0;
+   bDiskHit = false;
+
+   // get source file's modification time -- abort if we can't
    char path[100];
    ::sprintf(path, "%s/%s/%s", MEDIASTOREDIR, folder, file);
+   struct stat statInfo;
+   if(0 != ::stat(path, &statInfo))
+   {
+      ::fprintf(stderr, "(CRMVMediaMgr::decodeImage) Image source file not found: %s\n", path);
+      return(NULL);
+   }
+   mtime = statInfo.st_mtime;
 
-   int w = 0, h = 0;
-   unsigned char *buf = CRMVMediaMgr::loadImageData(path, w, h);
-   if(buf == NULL) return(NULL);
+   // load the image data, from the on-disk pixel cache if possible -- abort if we can't
+   unsigned char *buf = NULL;
+   if(m_bDiskCache)
+   {
+      buf = mapPixCacheFile(folder, file, mtime, w, h, mapSz);
+      bDiskHit = (buf != NULL);
+   }
+   if(buf == NULL)
+   {
+      buf = CRMVMediaMgr::loadImageData(path, w, h);
+      if(buf == NULL) return(NULL);
+      if(m_bDiskCache) writePixCacheFile(folder, file, mtime, w, h, buf);
+   }
+   return(buf);
+}
+
+/**
+ Insert an image loaded by decodeImage() into the internal, in-memory image cache. The caller must hold the image 
+ cache mutex. If the image is already cached -- because another thread loaded it in the meantime --, the image buffer
+ supplied is released and the cached image is returned instead.
 
-   // if adding image would cause cache to exceed capacity, remove the oldest images in the cache (at HEAD of list)
-   // until there's enough room.
-   while(m_nCacheSize + w*h*4 > MAX_IMGCACHESZ)
+ The image cache is a hash table keyed on the folder and file names, with each cached image also linked into a list 
+ ordered by most recent use. The newly added image is the most recently used. The cache will grow until it reaches
+ its capacity (see setImageCacheBudget()), at which point the least recently used image(s) are evicted until there's
+ room for the specified image. If the image by itself exceeds the capacity, it is still cached, but all other images 
+ are evicted. Pinned images are never evicted, so the cache may temporarily exceed its capacity.
+
+ @param folder [in] The name of the media store folder containing the image source file.
+ @param file [in] The name of the image source file.
+ @param mtime [in] The modification time of the image source file when the image was loaded.
+ @param w, h [in] The image width and height in pixels.
+ @param buf [in] The image buffer, as returned by decodeImage(). The cache takes ownership of it.
+ @param mapSz [in] The size of the mapped region if the image buffer was mapped from the on-disk pixel cache; else 0.
+ @return NULL if memory allocation failed (the image buffer is released); else the cached image object.
+*/
+CRMVMediaMgr::CachedImage* CRMVMediaMgr::insertCachedImage(const char* folder, const char* file, time_t mtime, 
+      int w, int h, unsigned char* buf, size_t mapSz)
+{
+   CachedImage* pImg = retrieveImageFromCache(folder, file);
+   if(pImg != NULL)
    {
-      CachedImage* pDead = m_pImageCache; 
-      m_pImageCache = pDead->pNext;
-      --m_nCachedImages;
-      m_nCacheSize -= ((unsigned long) pDead->wPix) * ((unsigned long) pDead->hPix) * 4L;
+      if(mapSz > 0) ::munmap(buf, mapSz);
+      else CRMVMediaMgr::freeImageData(buf);
+      return(pImg);
+   }
 
-      CRMVMediaMgr::freeImageData(pDead->pImgBuf);
-      ::free(pDead);
-      pDead = NULL;
+   // if adding image would cause cache to exceed capacity, evict the least recently used images until there's room
+   unsigned long imgSz = ((unsigned long) w) * ((unsigned long) h) * 4L;
+   CachedImage* pVictim = m_pLRUHead;
+   while(pVictim != NULL && m_nCacheSize + imgSz > m_nCacheBudget)
+   {
+      CachedImage* pNext = pVictim->pLRUNext;
+      if(pVictim->nPins == 0)
+      {
+         evictCachedImage(pVictim);
+         ++m_nCacheEvictions;
+      }
+      pVictim = pNext;
    }
 
-   // append new image at the end of the cache
-   CachedImage* pImg = (CachedImage*) ::malloc(sizeof(CachedImage));
+   pImg = (CachedImage*) ::malloc(sizeof(CachedImage));
    if(pImg == NULL)
    {
-      CRMVMediaMgr::freeImageData(buf);
-      ::perror("(CRMVMediaMgr::addImageToCache) Memory allocation failed!\n");
+      if(mapSz > 0) ::munmap(buf, mapSz);
+      else CRMVMediaMgr::freeImageData(buf);
+      ::perror("(CRMVMediaMgr::insertCachedImage) Memory allocation failed!\n");
       return(NULL);
    }
    ::strcpy(pImg->folderName, folder); 
    ::strcpy(pImg->fileName, file);
+   pImg->mtime = mtime;
    pImg->wPix = w;
    pImg->hPix = h;
-   pImg->pImgBuf = buf;
-   pImg->pNext = NULL;
+   pImg->pImgBuf = (mapSz > 0) ? (buf + PIXCACHEHDRSZ) : buf;
+   pImg->mapSz = mapSz;
+   pImg->nPins = 0;
+
+   // insert at head of its hash bucket, and at the most recently used end of the LRU list
+   int iBucket = CRMVMediaMgr::hashImageKey(folder, file);
+   pImg->pNextInBucket = m_imgHash[iBucket];
+   m_imgHash[iBucket] = pImg;
+
+   pImg->pLRUNext = NULL;
+   pImg->pLRUPrev = m_pLRUTail;
+   if(m_pLRUTail != NULL) m_pLRUTail->pLRUNext = pImg;
+   else m_pLRUHead = pImg;
+   m_pLRUTail = pImg;
 
-   if(m_pImageCache == NULL) m_pImageCache = pImg;
-   else
-   {
-      CachedImage* pBefore = m_pImageCache;
-      while(pBefore->pNext != NULL) pBefore = pBefore->pNext;
-      pBefore->pNext = pImg;
-   }
    ++m_nCachedImages;
-   m_nCacheSize += ((unsigned long) w) * ((unsigned long) h) * 4L;
+   m_nCacheSize += imgSz;
 
    return(pImg);
 }
 
 /**
- Remove the specified image from the in-memory image cache, if it is there.
+ Remove the specified image from the in-memory image cache, if it is there and not pinned. Its counterpart in the 
+ on-disk pixel cache, if any, is also removed.
 
  @param folder [in] The name of the media store folder containing the image source file.
  @param file [in] The name of the image source file.
 */
 void CRMVMediaMgr::removeImageFromCache(const char* folder, const char* file)
 {
-   // find the cached image, if it's there
-   CachedImage* pBefore = NULL;
-   CachedImage* pRmv = m_pImageCache;
-   while(pRmv != NULL)
+   if(m_bDiskCache)
    {
-      if(::strcmp(pRmv->folderName, folder)==0 && ::strcmp(pRmv->fileName, file)==0) break;
-      pBefore = pRmv;
-      pRmv = pRmv->pNext;
+      char path[256];
+      getPixCachePath(folder, file, path);
+      ::remove(path);
    }
-   if(pRmv == NULL) return;
 
-   // excise the slot for the image to be removed
-   if(pBefore == NULL) m_pImageCache = pRmv->pNext;
-   else pBefore->pNext = pRmv->pNext;
-   pRmv->pNext = NULL;
+   CachedImage* pRmv = retrieveImageFromCache(folder, file);
+   if(pRmv != NULL && pRmv->nPins == 0) evictCachedImage(pRmv);
+}
+
+/**
+ Remove the specified image slot from the in-memory image cache and release it.
+ @param pImg [in] The image slot. It must currently be in the cache.
+*/
+void CRMVMediaMgr::evictCachedImage(CachedImage* pImg)
+{
+   // excise the slot from its hash bucket
+   int iBucket = CRMVMediaMgr::hashImageKey(pImg->folderName, pImg->fileName);
+   if(m_imgHash[iBucket] == pImg) m_imgHash[iBucket] = pImg->pNextInBucket;
+   else
+   {
+      CachedImage* pBefore = m_imgHash[iBucket];
+      while(pBefore != NULL && pBefore->pNextInBucket != pImg) pBefore = pBefore->pNextInBucket;
+      if(pBefore != NULL) pBefore->pNextInBucket = pImg->pNextInBucket;
+   }
+
+   // excise the slot from the LRU list
+   if(pImg->pLRUPrev != NULL) pImg->pLRUPrev->pLRUNext = pImg->pLRUNext;
+   else m_pLRUHead = pImg->pLRUNext;
+   if(pImg->pLRUNext != NULL) pImg->pLRUNext->pLRUPrev = pImg->pLRUPrev;
+   else m_pLRUTail = pImg->pLRUPrev;
+
+   --m_nCachedImages;
+   m_nCacheSize -= ((unsigned long) pImg->wPix) * ((unsigned long) pImg->hPix) * 4L;
+
+   CRMVMediaMgr::freeCachedImageData(pImg);
+   ::free(pImg);
+}
+
+/**
+ Mark the specified image slot as the most recently used image in the image cache.
+ @param pImg [in] The image slot. It must currently be in the cache.
+*/
+void CRMVMediaMgr::touchCachedImage(CachedImage* pImg)
+{
+   if(pImg == m_pLRUTail) return;
+
+   if(pImg->pLRUPrev != NULL) pImg->pLRUPrev->pLRUNext = pImg->pLRUNext;
+   else m_pLRUHead = pImg->pLRUNext;
+   pImg->pLRUNext->pLRUPrev = pImg->pLRUPrev;
 
-   CRMVMediaMgr::freeImageData(pRmv->pImgBuf);
-   ::free(pRmv);
-   pRmv = NULL;
+   pImg->pLRUNext = NULL;
+   pImg->pLRUPrev = m_pLRUTail;
+   m_pLRUTail->pLRUNext = pImg;
+   m_pLRUTail = pImg;
 }
 
+/**
+ Compute the image cache hash table bucket for the specified image (FNV-1a hash of the folder and file names).
+ @param folder [in] The name of the media store folder containing the image source file.
+ @param file [in] The name of the image source file.
+ @return The bucket index, in [0..IMGHASHSZ-1].
+*/
+int CRMVMediaMgr::hashImageKey(const char* folder, const char* file)
+{
+   unsigned int hash = 2166136261u;
+   for(const char* p = folder; *p != '\0'; p++) hash = (hash ^ ((unsigned char) *p)) * 16777619u;
+   hash = (hash ^ ((unsigned char) '/')) * 16777619u;
+   for(const char* p = file; *p != '\0'; p++) hash = (hash ^ ((unsigned char) *p)) * 16777619u;
+   return((int) (hash % ((unsigned int) IMGHASHSZ)));
+}
+
+/**
+ Release the image data buffer of an image cache slot: unmap it if it lies in a memory-mapped pixel cache file, else
+ free it. The slot itself is not freed.
+ @param pImg [in] The image slot.
+*/
+void CRMVMediaMgr::freeCachedImageData(CachedImage* pImg)
+{
+   if(pImg->pImgBuf == NULL) return;
+   if(pImg->mapSz > 0) ::munmap(pImg->pImgBuf - PIXCACHEHDRSZ, pImg->mapSz);
+   else CRMVMediaMgr::freeImageData(pImg->pImgBuf);
+   pImg->pImgBuf = NULL;
+   pImg->mapSz = 0;
+}
+
+/**
+ Get the path of the on-disk pixel cache file for the specified image. All such files are stored in PIXCACHEDIR 
+ within the media store. Since '@' is not a valid character in media folder or file names, the file name formed from
+ the two names is unique.
+ @param folder [in] The name of the media store folder containing the image source file.
+ @param file [in] The name of the image source file.
+ @param path [out] Receives the path, relative to RMVideo's installation directory. Must be at least 256 chars long.
+*/
+void CRMVMediaMgr::getPixCachePath(const char* folder, const char* file, char* path)
+{
+   ::sprintf(path, "%.50s/%.20s/%.40s@%.40s.rgba", MEDIASTOREDIR, PIXCACHEDIR, folder, file);
+}
+
+/**
+ Memory-map the on-disk pixel cache file for the specified image. A pixel cache file consists of a PIXCACHEHDRSZ-byte
+ header -- magic number, image width and height (all 32-bit ints), and the source file's modification time (64-bit) --
+ followed by the image data in GL_RGBA format as prepared by loadImageData(). The file is rejected if its header is 
+ invalid, its size is wrong, or the recorded modification time does not match that of the image source file.
+
+ @param folder [in] The name of the media store folder containing the image source file.
+ @param file [in] The name of the image source file.
+ @param mtime [in] The image source file's current modification time.
+ @param w [out] On success, the image width in pixels.
+ @param h [out] On success, the image height in pixels.
+ @param mapSz [out] On success, the size of the mapped region, which includes the header.
+ @return Pointer to the start of the mapped region (ie, the file header), or NULL if the pixel cache file does not
+ exist, is invalid or stale, or could not be mapped.
+*/
+unsigned char* CRMVMediaMgr::mapPixCacheFile(const char* folder, const char* file, time_t mtime, int& w, int& h, 
+   size_t& mapSz)
+{
+   char path[256];
+   getPixCachePath(folder, file, path);
+   int fd = ::open(path, O_RDONLY);
+   if(fd < 0) return(NULL);
+
+   int hdr[PIXCACHEHDRSZ/sizeof(int)];
+   bool ok = (PIXCACHEHDRSZ == ::read(fd, hdr, PIXCACHEHDRSZ));
+   if(ok)
+   {
+      int64_t t = 0;
+      ::memcpy(&t, &(hdr[4]), sizeof(int64_t));
+      ok = (hdr[0] == PIXCACHEMAGIC) && (hdr[1] > 0) && (hdr[1] <= (int) MAX_IMAGEDIM) && (hdr[2] > 0) && 
+            (hdr[2] <= (int) MAX_IMAGEDIM) && (t == (int64_t) mtime);
+   }
+   struct stat statInfo;
+   size_t sz = ok ? (PIXCACHEHDRSZ + ((size_t) hdr[1]) * ((size_t) hdr[2]) * 4) : 0;
+   if(ok) ok = (0 == ::fstat(fd, &statInfo)) && (statInfo.st_size == (off_t) sz);
+
+   unsigned char* pMap = NULL;
+   if(ok)
+   {
+      void* pv = ::mmap(NULL, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(pv != MAP_FAILED) pMap = (unsigned char*) pv;
+   }
+   ::close(fd);
+
+   if(pMap != NULL)
+   {
+      w = hdr[1];
+      h = hdr[2];
+      mapSz = sz;
+   }
+   return(pMap);
+}
+
+/**
+ Write the specified image to the on-disk pixel cache (see mapPixCacheFile() for the file format). To ensure that a 
+ partially written file is never mapped, the file is written under a temporary name unique to the calling thread, then
+ renamed. On failure, a 
+ warning is printed to stderr, but the image is still available from the in-memory cache.
+
+ @param folder [in] The name of the media store folder containing the image source file.
+ @param file [in] The name of the image source file.
+ @param mtime [in] The image source file's modification time.
+ @param w, h [in] The image width and height in pixels.
+ @param pImg [in] The image data in GL_RGBA format.
+*/
+void CRMVMediaMgr::writePixCacheFile(const char* folder, const char* file, time_t mtime, int w, int h, 
+   unsigned char* pImg)
+{
+   char path[256];
+   char tmpPath[300];
+   getPixCachePath(folder, file, path);
+   ::sprintf(tmpPath, "%s.%lx.tmp", path, (unsigned long) ::pthread_self());
+
+   int hdr[PIXCACHEHDRSZ/sizeof(int)];
+   ::memset(hdr, 0, PIXCACHEHDRSZ);
+   hdr[0] = PIXCACHEMAGIC;
+   hdr[1] = w;
+   hdr[2] = h;
+   int64_t t = (int64_t) mtime;
+   ::memcpy(&(hdr[4]), &t, sizeof(int64_t));
+
+   size_t imgSz = ((size_t) w) * ((size_t) h) * 4;
+   FILE* fp = ::fopen(tmpPath, "wb");
+   bool ok = (fp != NULL);
+   if(ok) ok = (1 == ::fwrite(hdr, PIXCACHEHDRSZ, 1, fp)) && (1 == ::fwrite(pImg, imgSz, 1, fp));
+   if(fp != NULL && ::fclose(fp) != 0) ok = false;
+   if(ok) ok = (0 == ::rename(tmpPath, path));
+   if(!ok)
+   {
+      ::remove(tmpPath);
+      ::fprintf(stderr, "(CRMVMediaMgr) WARNING: Failed to write pixel cache file %s\n", path);
+   }
+}
+
+/**
+ Start preloading the image cache on a background thread, so that the first use of each image in the media store need
+ not wait for it to be decoded. The thread works through a snapshot of the images listed in the TOC, loading each one
+ that is not already cached, and exits when the list is exhausted or the cache is full. It never evicts an image, so 
+ image buffers already returned by getImage() remain valid. While preloading is suspended (see suspendImagePreload()),
+ the thread idles, so that it does not compete with an animation sequence for CPU time.
+
+ The media store must be loaded. No action is taken if the preload thread is already running, or there are no images
+ in the media store.
+
+ @return True if successful (or no action was needed); false if the preload thread could not be launched, in which case
+ an error message is printed to stderr. Images are still cached as they are used.
+*/
+bool CRMVMediaMgr::startImagePreload()
+{
+   if(!m_bLoaded || m_bPreloading) return(true);
+
+   int nImages = 0;
+   for(MediaFolder* pFolder = m_pFirstMediaFolder; pFolder != NULL; pFolder = pFolder->pNext)
+   {
+      for(MediaInfo* pInfo = pFolder->pFirstMedia; pInfo != NULL; pInfo = pInfo->pNext) 
+         if(!pInfo->isVideo) ++nImages;
+   }
+   if(nImages == 0) return(true);
+
+   m_pPreloadList = (char (*)[2][RMV_MVF_LEN+1]) ::malloc(nImages * sizeof(*m_pPreloadList));
+   if(m_pPreloadList == NULL)
+   {
+      ::perror("(CRMVMediaMgr::startImagePreload) Memory allocation failed!\n");
+      return(false);
+   }
+   m_nPreload = 0;
+   for(MediaFolder* pFolder = m_pFirstMediaFolder; pFolder != NULL; pFolder = pFolder->pNext)
+   {
+      for(MediaInfo* pInfo = pFolder->pFirstMedia; pInfo != NULL; pInfo = pInfo->pNext) if(!pInfo->isVideo)
+      {
+         ::strcpy(m_pPreloadList[m_nPreload][0], pFolder->name);
+         ::strcpy(m_pPreloadList[m_nPreload][1], pInfo->filename);
+         ++m_nPreload;
+      }
+   }
+
+   m_bPreloadStop = false;
+   if(0 != ::pthread_create(&m_preloadThread, NULL, CRMVMediaMgr::preloadEntryPoint, (void*) this))
+   {
+      ::fprintf(stderr, "(CRMVMediaMgr::startImagePreload) Unable to launch image preload thread!\n");
+      ::free(m_pPreloadList);
+      m_pPreloadList = NULL;
+      m_nPreload = 0;
+      return(false);
+   }
+   m_bPreloading = true;
+   return(true);
+}
+
+/** Stop the image preload thread, if it is running, and wait for it to exit. Invoked in the destructor. */
+void CRMVMediaMgr::stopImagePreload()
+{
+   if(!m_bPreloading) return;
+
+   m_bPreloadStop = true;
+   ::pthread_join(m_preloadThread, NULL);
+   m_bPreloading = false;
+
+   ::free(m_pPreloadList);
+   m_pPreloadList = NULL;
+   m_nPreload = 0;
+}
+
+void* CRMVMediaMgr::preloadEntryPoint(void* thisPtr)
+{
+   ((CRMVMediaMgr*) thisPtr)->preloadImages();
+   return(NULL);
+}
+
+/**
+ Runtime loop for the image preload thread; see startImagePreload(). Each image is decoded without holding the image
+ cache mutex. It is then cached only if there's room for it, it was not cached by another thread in the meantime, and
+ its source file has not changed or been removed since it was decoded; otherwise it is discarded.
+*/
+void CRMVMediaMgr::preloadImages()
+{
+   CElapsedTime eTime;
+   int nLoaded = 0;
+   bool bFull = false;
+   for(int i=0; i<m_nPreload && !bFull; i++)
+   {
+      while(m_bPreloadSuspended && !m_bPreloadStop) ::usleep(10000);
+      if(m_bPreloadStop) break;
+
+      const char* folder = m_pPreloadList[i][0];
+      const char* file = m_pPreloadList[i][1];
+      ::pthread_mutex_lock(&m_cacheMutex);
+      bool bCached = (NULL != retrieveImageFromCache(folder, file));
+      ::pthread_mutex_unlock(&m_cacheMutex);
+      if(bCached) continue;
+
+      time_t mtime = 0;
+      int w = 0, h = 0;
+      size_t mapSz = 0;
+      bool bDiskHit = false;
+      unsigned char* buf = decodeImage(folder, file, mtime, w, h, mapSz, bDiskHit);
+      if(buf == NULL) continue;
+
+      char path[100];
+      ::sprintf(path, "%s/%s/%s", MEDIASTOREDIR, folder, file);
+      struct stat statInfo;
+      unsigned long imgSz = ((unsigned long) w) * ((unsigned long) h) * 4L;
+
+      ::pthread_mutex_lock(&m_cacheMutex);
+      bool bInsert = (NULL == retrieveImageFromCache(folder, file)) && (0 == ::stat(path, &statInfo)) && 
+            (statInfo.st_mtime == mtime);
+      bFull = bInsert && (m_nCacheSize + imgSz > m_nCacheBudget);
+      if(bInsert && !bFull)
+      {
+         if(bDiskHit) ++m_nDiskCacheHits;
+         if(NULL != insertCachedImage(folder, file, mtime, w, h, buf, mapSz)) ++nLoaded;
+         buf = NULL;
+      }
+      ::pthread_mutex_unlock(&m_cacheMutex);
+
+      if(buf != NULL)
+      {
+         if(mapSz > 0) ::munmap(buf, mapSz);
+         else CRMVMediaMgr::freeImageData(buf);
+      }
+   }
+
+   ::fprintf(stderr, "(CRMVMediaMgr) Image preload %s: %d images cached in %.2f seconds%s.\n", 
+         m_bPreloadStop ? "stopped" : "done", nLoaded, eTime.get(), bFull ? " (cache is full)" : "");
+}
@@ -7,6 +7,9 @@
 #if !defined(MEDIAMGR_H__INCLUDED_)
 #define MEDIAMGR_H__INCLUDED_
 
+#include <time.h>
+#include <stdint.h>
+#include <pthread.h>
 #include "rmvio.h"                     // CRMVIo -- Defines the communication link with Maestro.
 #include "rmvideo_common.h"            // common defns shared by Maestro and RMVideo
 
@@ -29,13 +32,33 @@ public:
    void replyGetMediaInfo(CRMVIo* pIOLink);
    void replyDeleteMediaFile(CRMVIo* pIOLink);
    void downloadMediaFile(CRMVIo* pIOLink);
+   void downloadMediaFileEx(CRMVIo* pIOLink);
    
-   // retrieve a GL_RGBA-formatted image from the media store (checks image cache first for fast retrieval)
-   unsigned char* getImage(const char* folder, const char* file, int& width, int& height);
+   // retrieve a GL_RGBA-formatted image from the media store (checks image cache first for fast retrieval). If pinned,
+   // the image is not evicted from the cache until unpinned.
+   unsigned char* getImage(const char* folder, const char* file, int& width, int& height, bool bPin = false);
+   void unpinImage(const char* folder, const char* file);
+
+   // configure the image cache: capacity in MB, and an optional on-disk cache of decoded pixels. Call before load().
+   void setImageCacheBudget(int nMB);
+   void enableDiskImageCache(bool b) { m_bDiskCache = b; }
+
+   // handle Maestro command requesting image cache statistics
+   void replyGetImageCacheStats(CRMVIo* pIOLink);
+
+   // preload the image cache on a background thread after load(); suspend preloading during animation sequences
+   bool startImagePreload();
+   void stopImagePreload();
+   void suspendImagePreload(bool b) { m_bPreloadSuspended = b; }
 
 private:
    // name of subdirectory in which video files were stored in RMVideo version 6 or earlier
    static const char* OLDSTOREDIR;
+   // subdirectory of media store holding partially downloaded files (RMV_CMD_PUTFILEX), kept so they can be resumed
+   static const char* PARTIALDIR;
+   // file in media store holding the persistent media index, so that unchanged media files are not probed at startup
+   static const char* INDEXFILE;
+   static const char* INDEXTAG;                       // first line of the index file: format tag and version
    
    bool ensureSufficientReplyBufSize(int sz);         // to reallocate reply buffer as needed
    
@@ -48,6 +71,10 @@ private:
       int height;                                     // height of image or video frame in pixels; 0 if unknown
       int rate;                                       // video frame rate in milliHz; 0 if unknown
       int dur;                                        // approximate video duration in ms; 0 if unknown
+      uint64_t fileSize;                              // file size and modification time when the file was probed
+      time_t mtime;                                   // (or its content hash computed)
+      bool bHashed;                                   // if set, the file's content hash is known
+      uint64_t contentHash;                           // see RMV_CONTENTHASH
       MediaInfo* pNext;
    };
    
@@ -60,9 +87,43 @@ private:
       MediaFolder* pNext;
    };
    
+   // a file found in the media store during load(), or an entry in the persistent media index
+   struct ScanEntry
+   {
+      char folder[RMV_MVF_LEN+1];
+      char file[RMV_MVF_LEN+1];
+      uint64_t size;                                  // file size and modification time
+      time_t mtime;
+      int type;                                       // 0 = image, 1 = video, -1 = not a supported media file
+      int width, height, rate, dur;                   // as in MediaInfo
+      bool bHashed;
+      uint64_t contentHash;
+      bool bProbe;                                    // if set, file must be probed to determine type and info
+   };
+
    // helper methods for load()
    bool appendMediaFolder(const char* folderName);
-   bool scanMediaFolder(MediaFolder* pFolder);
+   bool scanMediaFolder(MediaFolder* pFolder, ScanEntry*& pEntries, int& nEntries, int& nCap);
+   static void probeMediaFile(void* pArg, int iJob);
+
+   // helper methods maintaining the persistent media index
+   static ScanEntry* readIndex(int& n);
+   static int compareScanEntries(const void* p1, const void* p2);
+   void flushIndex();
+
+   ScanEntry* m_pIgnored;                             // files in media store that are not supported media files; kept
+   int m_nIgnored;                                    // in the index so they need not be probed again
+   bool m_bIndexDirty;                                // set whenever the persistent media index must be rewritten
+
+   // helper methods for downloading media files
+   static bool isReservedFolderName(const char* folderName);
+   MediaFolder* findMediaFolder(const char* folderName);
+   static MediaInfo* findMediaFile(MediaFolder* pFolder, const char* fileName);
+   bool addDownloadedMedia(MediaFolder* pFolder, bool folderCreated, const char* filePath, MediaInfo* pNewInfo);
+   bool getContentID(MediaFolder* pFolder, MediaInfo* pInfo, uint64_t& size, uint64_t& hash);
+   MediaInfo* findContent(uint64_t size, uint64_t hash, MediaFolder*& pFolder);
+   static bool computeContentHash(const char* path, uint64_t& size, uint64_t& hash);
+   static bool copyFile(const char* srcPath, const char* dstPath);
 
    bool m_bLoaded;                                    // flag set once we've scanned media store contents
    int m_nMediaFolders;                               // number of folders currently in media store
@@ -75,29 +136,75 @@ private:
    static unsigned char* loadImageData(const char* path, int& width, int& height);
    static void freeImageData(unsigned char* pImgData);
 
-   // one slot in the singly-linked list of images cached in memory for fast retrieval
+   // one slot in the image cache. Each slot is linked into a hash bucket list and into the cache's LRU list.
    struct CachedImage
    {
       char folderName[RMV_MVF_LEN+1];            // media store folder name for image source file
       char fileName[RMV_MVF_LEN+1];              // image source filename
+      time_t mtime;                              // modification time of image source file when image was loaded
       int wPix;                                  // image width in pixels
       int hPix;                                  // image height in pixels
-      unsigned char* pImgBuf;                    // the image buffer, as prepared by loadImageData()
-      CachedImage* pNext;                        // points to next image slot in cache
+      unsigned char* pImgBuf;                    // the image buffer, as prepared by loadImageData() -- or, if mapSz
+      size_t mapSz;                              // is nonzero, in a memory-mapped disk cache file of that size
+      int nPins;                                 // # of outstanding pins; a pinned image is never evicted
+      CachedImage* pNextInBucket;                // points to next image slot in the same hash bucket
+      CachedImage* pLRUPrev;                     // points to the next less recently used image slot
+      CachedImage* pLRUNext;                     // points to the next more recently used image slot
    };
 
-   static const unsigned long MAX_IMGCACHESZ;    // max amount of memory allocated to cached images (in bytes)
+   static const unsigned long DEF_IMGCACHESZ;    // default max amount of memory allocated to cached images (in bytes)
+   static const int MIN_IMGCACHEMB;              // allowed range for the image cache capacity, in MB
+   static const int MAX_IMGCACHEMB;
    static const unsigned long MAX_IMAGEDIM;      // max allowed width or height of an image
+   static const int IMGHASHSZ = 256;             // # of buckets in the image cache hash table
+   static const char* PIXCACHEDIR;               // subdirectory of media store holding the on-disk pixel cache
+   static const int PIXCACHEMAGIC;               // identifies a pixel cache file
+   static const int PIXCACHEHDRSZ = 32;          // size of pixel cache file header, in bytes
 
-   // managing internal image cache to speed up retrieval of very large (e.g., 2560x1440) images
+   // managing internal image cache to speed up retrieval of very large (e.g., 2560x1440) images. Except for 
+   // decodeImage(), these methods require that the caller hold the cache mutex.
    void releaseImageCache();
    CachedImage* retrieveImageFromCache(const char* folder, const char* file);
    CachedImage* addImageToCache(const char* folder, const char* file);
+   unsigned char* decodeImage(const char* folder, const char* file, time_t& mtime, int& w, int& h, size_t& mapSz, 
+         bool& bDiskHit);
+   CachedImage* insertCachedImage(const char* folder, const char* file, time_t mtime, int w, int h, 
+         unsigned char* buf, size_t mapSz);
    void removeImageFromCache(const char* folder, const char* file);
+   void evictCachedImage(CachedImage* pImg);
+   void touchCachedImage(CachedImage* pImg);
+   static int hashImageKey(const char* folder, const char* file);
+   static void freeCachedImageData(CachedImage* pImg);
+
+   // managing the optional on-disk cache of decoded image pixels
+   void getPixCachePath(const char* folder, const char* file, char* path);
+   unsigned char* mapPixCacheFile(const char* folder, const char* file, time_t mtime, int& w, int& h, size_t& mapSz);
+   void writePixCacheFile(const char* folder, const char* file, time_t mtime, int w, int h, unsigned char* pImg);
 
    unsigned int m_nCachedImages;                 // number of images stored in cache
    unsigned long m_nCacheSize;                   // total size of image cache in bytes
-   CachedImage* m_pImageCache;                   // pointer to first image in cache
+   unsigned long m_nCacheBudget;                 // the cache capacity in bytes
+   CachedImage* m_imgHash[IMGHASHSZ];            // the image cache hash table (heads of bucket lists)
+   CachedImage* m_pLRUHead;                      // the least recently used image in cache
+   CachedImage* m_pLRUTail;                      // the most recently used image in cache
+   bool m_bDiskCache;                            // if set, decoded image pixels are also cached on disk
+
+   unsigned int m_nCacheHits;                    // image cache statistics since startup: retrievals satisfied by the
+   unsigned int m_nCacheMisses;                  // cache, retrievals that required loading the image, images evicted
+   unsigned int m_nCacheEvictions;               // to make room, and misses satisfied by the on-disk pixel cache
+   unsigned int m_nDiskCacheHits;
+
+   pthread_mutex_t m_cacheMutex;                 // guards the image cache, shared with the image preload thread
+   pthread_t m_preloadThread;                    // the image preload thread, and whether or not it is running
+   bool m_bPreloading;
+   volatile bool m_bPreloadStop;                 // set to stop the image preload thread
+   volatile bool m_bPreloadSuspended;            // while set, the image preload thread is idle
+   char (*m_pPreloadList)[2][RMV_MVF_LEN+1];     // the images to be preloaded: folder and file name of each
+   int m_nPreload;
+
+   // runtime loop for the image preload thread
+   void preloadImages();
+   static void* preloadEntryPoint(void* thisPtr);
 };
 
 
@@ -0,0 +1,411 @@
+//=====================================================================================================================
+//
+// rmvnettest.cpp : A standalone test of the RMVideo command session over the loopback interface.  For testing only.
+//
+// AUTHOR:  saruffner.
+//
+// DESCRIPTION:
+// This program runs CRMVIoNet -- the network implementation of RMVideo's command link -- on a server thread listening
+// on 127.0.0.1, while the main thread plays the part of Maestro (CCxRMVideo), connecting to it and issuing a short
+// command session:  RMV_CMD_STARTINGUP, _GETVERSION, _LOADTARGETS, and then two animation sequences, each followed
+// by RMV_CMD_STOPANIMATE.  Frame updates in the first sequence are sent with the legacy RMV_CMD_UPDATEFRAME; the
+// second sequence repeats the same trajectories using the compact RMV_CMD_UPDATEFRAMEC (RMVideo v12).  The session
+// ends with RMV_CMD_SHUTTINGDN.
+//
+// The server thread does not render anything; in place of CRMVDisplay, it simply retrieves each target update and
+// records the motion vectors.  The client verifies that RMVideo recovered exactly the motion vectors it sent in both
+// encodings, and reports the average number of bytes sent per frame update with each encoding.  The trajectories
+// include stationary targets, targets moving at constant velocity, a target that blinks on and off, and a target with
+// large, ever-changing pattern displacements, so that all field widths of the compact encoding are exercised.
+//
+// The compact encoder here mirrors CCxRMVideo::PrepareCompactUpdate() on the Maestro side.
+//
+// USAGE:  ./rmvnettest [eventio]
+//    eventio -- if specified, CRMVIoNet runs in event-driven mode (see CRMVIoNet::setEventDrivenMode()).
+// Exits with status 0 if the test passes, 1 otherwise.  NOTE that CRMVIoNet::openSession() polls for a connection
+// once per second, so the test takes a second or two to get started.
+//
+// REVISION HISTORY:
+// 16oct2026-- Initial version, introduced along with RMV_CMD_UPDATEFRAMEC.
+//=====================================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "rmvionet.h"
+
+static const char* TESTADDR = "127.0.0.1";
+static const int NTGTS = 8;                              // # of targets in the test animation sequences
+static const int NFRAMES = 500;                          // # of frame updates per animation sequence
+static const int MAXLOG = 2 + NFRAMES;                   // frame 0, frame 1, and the frame updates
+
+// the motion vectors retrieved by the server thread for the current animation sequence
+static RMVTGTVEC g_rcvdVecs[MAXLOG][NTGTS];
+static int g_nRcvdFrames = 0;
+static volatile bool g_bServerOk = true;
+static volatile int g_nSeqDone = 0;                      // incremented by server upon each RMV_CMD_STOPANIMATE
+static bool g_bEventIO = false;
+
+// the Maestro side: socket connection to RMVideo and the command buffer
+static int g_sock = -1;
+static const int MAXCMDSIZE = 2053;                      // same as RMV_MAXCMDSIZE in CCxRMVideo
+static int g_cmdBuf[MAXCMDSIZE];
+static long g_nBytesSent = 0;
+static int g_lastVec[NTGTS][4];
+
+static int scaleComponent(float f)
+{
+   float fTemp = f * RMV_TGTVEC_F2I_F;
+   return( int( (fTemp>0.0f) ? floor(fTemp+0.5f) : ceil(fTemp-0.5f) ) );
+}
+
+// the test trajectories
+static void getTestVector(int frame, int iTgt, RMVTGTVEC& vec)
+{
+   vec.bOn = 1;
+   vec.hWin = vec.vWin = vec.hPat = vec.vPat = 0.0f;
+   switch(iTgt)
+   {
+      case 0 : case 1 : case 2 :                         // stationary
+         break;
+      case 3 :                                           // constant velocity window
+         vec.hWin = 0.125f;
+         vec.vWin = -0.03125f;
+         break;
+      case 4 :                                           // constant velocity window and pattern
+         vec.hWin = -0.2f;
+         vec.hPat = 1.5f;
+         vec.vPat = 0.37f;
+         break;
+      case 5 :                                           // blinks on and off every 50 frames
+         vec.bOn = ((frame / 50) % 2 == 0) ? 1 : 0;
+         break;
+      case 6 :                                           // window changes velocity now and then
+         vec.hWin = (frame < 200) ? 0.1f : -0.05f;
+         vec.vWin = (frame < 300) ? 0.0f : 0.3f;
+         break;
+      default :                                          // large, ever-changing pattern displacements
+         vec.hPat = 40.0f * sinf(0.05f * float(frame));
+         vec.vPat = (frame % 2 == 0) ? 900.0f : -0.5f;
+         break;
+   }
+}
+
+//=== The RMVideo side ================================================================================================
+
+static void* serverEntry(void* pArg)
+{
+   CRMVIoNet ioNet;
+   ioNet.setNetworkAddresses(TESTADDR, TESTADDR);
+   ioNet.setEventDrivenMode(g_bEventIO, false);
+   if(!ioNet.init() || !ioNet.openSession())
+   {
+      fprintf(stderr, "SERVER: Failed to start command session\n");
+      g_bServerOk = false;
+      return(NULL);
+   }
+
+   RMVTGTVEC vec;
+   bool bDone = false;
+   while(!bDone && g_bServerOk)
+   {
+      int cmd = ioNet.getNextCommand();
+      switch(cmd)
+      {
+         case RMV_CMD_NONE :
+            ioNet.waitForCommand(2000);
+            break;
+         case RMV_CMD_STARTINGUP :
+            break;
+         case RMV_CMD_GETVERSION :
+            ioNet.sendSignal(RMV_CURRENTVERSION);
+            break;
+         case RMV_CMD_LOADTARGETS :
+            ioNet.sendSignal((ioNet.getNumTargets() == NTGTS) ? RMV_SIG_CMDACK : RMV_SIG_CMDERR);
+            break;
+         case RMV_CMD_STARTANIMATE :
+         case RMV_CMD_UPDATEFRAME :
+            if(cmd == RMV_CMD_STARTANIMATE) g_nRcvdFrames = 0;
+            for(int n=0; n<((cmd == RMV_CMD_STARTANIMATE) ? 2 : 1); n++)
+            {
+               if(g_nRcvdFrames >= MAXLOG) { g_bServerOk = false; break; }
+               for(int i=0; i<NTGTS; i++)
+               {
+                  if(!ioNet.getMotionVector(i, vec)) { g_bServerOk = false; break; }
+                  g_rcvdVecs[g_nRcvdFrames][i] = vec;
+               }
+               ++g_nRcvdFrames;
+            }
+            break;
+         case RMV_CMD_STOPANIMATE :
+            __sync_fetch_and_add(&g_nSeqDone, 1);
+            break;
+         case RMV_CMD_SHUTTINGDN :
+            bDone = true;
+            break;
+         default :
+            fprintf(stderr, "SERVER: Unexpected command (%d)\n", cmd);
+            g_bServerOk = false;
+            break;
+      }
+   }
+
+   ioNet.closeSession();
+   ioNet.cleanup();
+   return(NULL);
+}
+
+//=== The Maestro side ================================================================================================
+
+// send the command in g_cmdBuf, where g_cmdBuf[0] is the command length in ints (as in CCxRMVideo::sendRMVCommand())
+static bool sendCommand()
+{
+   int nCmdBytes = g_cmdBuf[0] * sizeof(int);
+   g_cmdBuf[0] = nCmdBytes;
+   const char* pBytes = (const char*) g_cmdBuf;
+   int nSent = 0;
+   while(nSent < nCmdBytes + (int) sizeof(int))
+   {
+      int n = send(g_sock, pBytes + nSent, nCmdBytes + sizeof(int) - nSent, MSG_NOSIGNAL);
+      if(n < 0) { perror("CLIENT send"); return(false); }
+      nSent += n;
+   }
+   g_nBytesSent += nSent;
+   return(true);
+}
+
+// receive a reply: a byte count (in ints) followed by the reply itself
+static bool receiveReply(int* pReply, int maxLen)
+{
+   int len = 0;
+   if(recv(g_sock, &len, sizeof(int), MSG_WAITALL) != sizeof(int) || len <= 0 || len > maxLen) return(false);
+   return(recv(g_sock, pReply, len*sizeof(int), MSG_WAITALL) == (ssize_t) (len*sizeof(int)));
+}
+
+static int appendVector(int iCmdIdx, int iTgt, const RMVTGTVEC& vec)
+{
+   g_cmdBuf[iCmdIdx++] = iTgt;
+   g_cmdBuf[iCmdIdx++] = vec.bOn ? 1 : 0;
+   g_cmdBuf[iCmdIdx++] = scaleComponent(vec.hWin);
+   g_cmdBuf[iCmdIdx++] = scaleComponent(vec.vWin);
+   g_cmdBuf[iCmdIdx++] = scaleComponent(vec.hPat);
+   g_cmdBuf[iCmdIdx++] = scaleComponent(vec.vPat);
+   for(int j=0; j<4; j++) g_lastVec[iTgt][j] = g_cmdBuf[iCmdIdx-4+j];
+   return(iCmdIdx);
+}
+
+static bool sendStartAnimate()
+{
+   RMVTGTVEC vec;
+   g_cmdBuf[1] = RMV_CMD_STARTANIMATE;
+   g_cmdBuf[2] = 0;
+   int iCmdIdx = 3;
+   for(int n=0; n<2; n++)
+   {
+      g_cmdBuf[iCmdIdx++] = NTGTS;
+      for(int i=0; i<NTGTS; i++)
+      {
+         getTestVector(n, i, vec);
+         iCmdIdx = appendVector(iCmdIdx, i, vec);
+      }
+   }
+   g_cmdBuf[0] = iCmdIdx - 1;
+   return(sendCommand());
+}
+
+static bool sendUpdate(int frame, bool bCompact)
+{
+   RMVTGTVEC vec;
+   if(!bCompact)
+   {
+      g_cmdBuf[1] = RMV_CMD_UPDATEFRAME;
+      g_cmdBuf[2] = 0;
+      g_cmdBuf[3] = NTGTS;
+      int iCmdIdx = 4;
+      for(int i=0; i<NTGTS; i++)
+      {
+         getTestVector(frame, i, vec);
+         iCmdIdx = appendVector(iCmdIdx, i, vec);
+      }
+      g_cmdBuf[0] = iCmdIdx - 1;
+      return(sendCommand());
+   }
+
+   int nMaskWords = (NTGTS + 31) / 32;
+   g_cmdBuf[1] = RMV_CMD_UPDATEFRAMEC;
+   g_cmdBuf[2] = 0;
+   g_cmdBuf[3] = NTGTS;
+   unsigned int* pOnMask = (unsigned int*) &(g_cmdBuf[4]);
+   unsigned int* pChgMask = pOnMask + nMaskWords;
+   for(int i=0; i<nMaskWords; i++) pOnMask[i] = pChgMask[i] = 0;
+
+   unsigned char* pBytes = (unsigned char*) &(g_cmdBuf[4 + 2*nMaskWords]);
+   int nBytes = 0;
+   for(int i=0; i<NTGTS; i++)
+   {
+      getTestVector(frame, i, vec);
+      unsigned int bit = 1u << (i % 32);
+      if(vec.bOn) pOnMask[i/32] |= bit;
+
+      int v[4] = { scaleComponent(vec.hWin), scaleComponent(vec.vWin), scaleComponent(vec.hPat),
+         scaleComponent(vec.vPat) };
+      if(::memcmp(v, g_lastVec[i], sizeof(v)) == 0) continue;
+
+      pChgMask[i/32] |= bit;
+      int iDesc = nBytes++;
+      int desc = 0;
+      for(int j=0; j<4; j++)
+      {
+         g_lastVec[i][j] = v[j];
+         int w, nb;
+         if(v[j] == 0) { w = RMV_UPDC_W_ZERO; nb = 0; }
+         else if(v[j] >= -32768 && v[j] <= 32767) { w = RMV_UPDC_W_16; nb = 2; }
+         else if(v[j] >= -8388608 && v[j] <= 8388607) { w = RMV_UPDC_W_24; nb = 3; }
+         else { w = RMV_UPDC_W_32; nb = 4; }
+         desc |= (w << (2*j));
+         for(int b=0; b<nb; b++) pBytes[nBytes++] = (unsigned char) ((((unsigned int) v[j]) >> (8*b)) & 0x0FF);
+      }
+      pBytes[iDesc] = (unsigned char) desc;
+   }
+   while((nBytes % 4) != 0) pBytes[nBytes++] = 0;
+
+   g_cmdBuf[0] = 3 + 2*nMaskWords + nBytes/4;
+   return(sendCommand());
+}
+
+// run one animation sequence, then verify that RMVideo recovered all motion vectors exactly. Reports the average number
+// of bytes sent per frame update.
+static bool runSequence(bool bCompact)
+{
+   int nSeqDone = g_nSeqDone;
+   if(!sendStartAnimate()) return(false);
+   g_nBytesSent = 0;
+   for(int f=2; f<2+NFRAMES; f++)
+   {
+      if(!sendUpdate(f, bCompact)) return(false);
+      usleep(200);
+   }
+   long nUpdBytes = g_nBytesSent;
+
+   g_cmdBuf[0] = 1;
+   g_cmdBuf[1] = RMV_CMD_STOPANIMATE;
+   if(!sendCommand()) return(false);
+   for(int i=0; i<500 && g_nSeqDone == nSeqDone && g_bServerOk; i++) usleep(10000);
+   if(g_nSeqDone == nSeqDone)
+   {
+      fprintf(stderr, "CLIENT: RMVideo failed to process all %s updates\n", bCompact ? "compact" : "legacy");
+      return(false);
+   }
+
+   int nErrs = 0;
+   if(g_nRcvdFrames != 2 + NFRAMES)
+   {
+      fprintf(stderr, "CLIENT: RMVideo received %d frames, expected %d\n", g_nRcvdFrames, 2 + NFRAMES);
+      ++nErrs;
+   }
+   // each received vector component must be exactly what RMVideo recovers from the scaled integer value sent
+   RMVTGTVEC vec;
+   for(int f=0; f<g_nRcvdFrames && nErrs < 10; f++) for(int i=0; i<NTGTS; i++)
+   {
+      getTestVector(f, i, vec);
+      const RMVTGTVEC& got = g_rcvdVecs[f][i];
+      bool bMatch = ((vec.bOn != 0) == (got.bOn != 0)) &&
+            (got.hWin == float(scaleComponent(vec.hWin)) / RMV_TGTVEC_F2I_F) &&
+            (got.vWin == float(scaleComponent(vec.vWin)) / RMV_TGTVEC_F2I_F) &&
+            (got.hPat == float(scaleComponent(vec.hPat)) / RMV_TGTVEC_F2I_F) &&
+            (got.vPat == float(scaleComponent(vec.vPat)) / RMV_TGTVEC_F2I_F);
+      if(!bMatch)
+      {
+         fprintf(stderr, "CLIENT: Mismatch at frame %d, target %d\n", f, i);
+         ++nErrs;
+      }
+   }
+
+   printf("%s: %d frame updates, %.1f bytes/update, %s\n", bCompact ? "RMV_CMD_UPDATEFRAMEC" : "RMV_CMD_UPDATEFRAME ",
+         NFRAMES, double(nUpdBytes) / NFRAMES, (nErrs == 0) ? "all vectors verified" : "FAILED");
+   return(nErrs == 0);
+}
+
+static bool runClient()
+{
+   // connect to the server, which polls for a connection once per second
+   g_sock = socket(AF_INET, SOCK_STREAM, 0);
+   struct sockaddr_in addr;
+   ::memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+   addr.sin_port = htons(RMVNET_RMVPORT);
+   addr.sin_addr.s_addr = inet_addr(TESTADDR);
+   bool bConnected = false;
+   for(int i=0; i<50 && !bConnected && g_bServerOk; i++)
+   {
+      bConnected = (connect(g_sock, (struct sockaddr*) &addr, sizeof(addr)) == 0);
+      if(!bConnected) usleep(100000);
+   }
+   if(!bConnected) { fprintf(stderr, "CLIENT: Unable to connect to RMVideo\n"); return(false); }
+   int enable = 1;
+   setsockopt(g_sock, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(int));
+
+   g_cmdBuf[0] = 1;
+   g_cmdBuf[1] = RMV_CMD_STARTINGUP;
+   if(!sendCommand()) return(false);
+
+   int reply[8];
+   g_cmdBuf[0] = 1;
+   g_cmdBuf[1] = RMV_CMD_GETVERSION;
+   if(!sendCommand() || !receiveReply(reply, 8)) return(false);
+   bool bCompactOk = (reply[0] >= RMV_COMPACTUPDVERSION);
+   printf("RMVideo version %d\n", reply[0]);
+
+   // load targets: each is just an RMV_SPOT
+   int iCmdIdx = 1;
+   g_cmdBuf[iCmdIdx++] = RMV_CMD_LOADTARGETS;
+   g_cmdBuf[iCmdIdx++] = NTGTS;
+   for(int i=0; i<NTGTS; i++)
+   {
+      g_cmdBuf[iCmdIdx++] = RMV_TGTDEF_TYPE;
+      g_cmdBuf[iCmdIdx++] = RMV_SPOT;
+      g_cmdBuf[iCmdIdx++] = RMV_TGTDEF_END;
+   }
+   g_cmdBuf[0] = iCmdIdx - 1;
+   if(!sendCommand() || !receiveReply(reply, 8) || reply[0] != RMV_SIG_CMDACK)
+   {
+      fprintf(stderr, "CLIENT: Target load failed\n");
+      return(false);
+   }
+
+   bool bOk = runSequence(false);
+   if(bOk && bCompactOk) bOk = runSequence(true);
+
+   g_cmdBuf[0] = 1;
+   g_cmdBuf[1] = RMV_CMD_SHUTTINGDN;
+   sendCommand();
+   return(bOk && g_bServerOk);
+}
+
+int main(int argc, char* argv[])
+{
+   g_bEventIO = (argc > 1) && (::strcmp(argv[1], "eventio") == 0);
+
+   pthread_t server;
+   if(pthread_create(&server, NULL, serverEntry, NULL) != 0)
+   {
+      fprintf(stderr, "Unable to start server thread\n");
+      return(1);
+   }
+
+   bool bOk = runClient();
+   if(!bOk) g_bServerOk = false;
+   if(g_sock >= 0) close(g_sock);
+   pthread_join(server, NULL);
+
+   printf("%s\n", bOk ? "PASSED" : "FAILED");
+   return(bOk ? 0 : 1);
+}
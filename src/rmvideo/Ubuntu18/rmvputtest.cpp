@@ -0,0 +1,561 @@
+//=====================================================================================================================
+//
+// rmvputtest.cpp : A standalone test of media file downloads to RMVideo over the loopback interface.  For testing only.
+//
+// AUTHOR:  saruffner.
+//
+// DESCRIPTION:
+// This program runs CRMVIoNet and the media store manager CRMVMediaMgr on a server thread listening on 127.0.0.1, while
+// the main thread plays the part of Maestro (CCxRMVideo), downloading image files to the media store.  The server does
+// not render anything; in place of CRMVDisplay, it simply dispatches the media store commands to CRMVMediaMgr, and it
+// opens a new command session whenever the link to Maestro is lost.
+//
+// The client generates several large BMP images with pseudorandom pixels and runs these tests:
+//    1) Legacy download: One image is sent with RMV_CMD_PUTFILE, waiting for each 2KB chunk to be acknowledged, as
+//       in CCxRMVideo::putFile().
+//    2) Windowed download: Another image of the same size is sent with RMV_CMD_PUTFILEX (RMVideo v13), with up to
+//       RMV_PUTX_WINDOW chunks of RMV_PUTX_CHUNKSZ bytes in flight, as in CCxRMVideo::putFileWindowed().  The transfer
+//       rates of (1) and (2) are reported, both overall and for the exchange of file chunks alone -- the overall time
+//       includes RMVideo's validation of the downloaded file, which involves decoding the image.
+//    3) Deduplication: The image from (2) is sent again to the same destination, then to a different one.  RMVideo
+//       must reply RMV_PUTX_EXISTS and RMV_PUTX_COPIED, respectively, without any file content being sent.
+//    4) Resume: A third image is sent with RMV_CMD_PUTFILEX, but the client drops the connection about halfway
+//       through.  After reconnecting, the client sends RMV_CMD_PUTFILEX again; RMVideo must ask for the file starting
+//       at the byte offset where the first attempt left off.
+// After each download, the file installed in the media store is compared byte for byte with the source.  The content
+// hash computation here is an independent implementation of RMV_CONTENTHASH, so (2)-(4) also verify that RMVideo
+// computes the same hash.
+//
+// The test runs in a temporary directory, which becomes RMVideo's "home" directory in which the media store is created.
+// The directory is removed when the test is done.
+//
+// USAGE:  ./rmvputtest [eventio]
+//    eventio -- if specified, CRMVIoNet runs in event-driven mode (see CRMVIoNet::setEventDrivenMode()).
+// Exits with status 0 if the test passes, 1 otherwise.  NOTE that CRMVIoNet::openSession() polls for a connection
+// once per second, so each (re)connection takes up to a second.
+//
+// REVISION HISTORY:
+// 16oct2026-- Initial version, introduced along with RMV_CMD_PUTFILEX.
+//=====================================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "rmvionet.h"
+#include "rmvmediamgr.h"
+
+static const char* TESTADDR = "127.0.0.1";
+static const int IMGDIM = 2000;                          // test images are IMGDIM x IMGDIM, 24-bit color
+static const char* SRCLEGACY = "legacy.bmp";             // source files for the test images, in the test directory
+static const char* SRCWINDOWED = "windowed.bmp";
+static const char* SRCRESUMED = "resumed.bmp";
+
+static volatile bool g_bServerOk = true;
+static volatile bool g_bQuit = false;
+static bool g_bEventIO = false;
+
+// the Maestro side: socket connection to RMVideo and the command buffer
+static int g_sock = -1;
+static const int MAXCMDSIZE = 2053;                      // same as RMV_MAXCMDSIZE in CCxRMVideo
+static int g_cmdBuf[MAXCMDSIZE];
+static double g_tChunks = 0;                             // time spent in the last file chunk exchange, in seconds
+
+static double getElapsedSecs(const struct timespec& tStart)
+{
+   struct timespec tNow;
+   clock_gettime(CLOCK_MONOTONIC, &tNow);
+   return(double(tNow.tv_sec - tStart.tv_sec) + 1.0e-9 * double(tNow.tv_nsec - tStart.tv_nsec));
+}
+
+//=== The RMVideo side ================================================================================================
+
+static void* serverEntry(void* pArg)
+{
+   CRMVIoNet ioNet;
+   CRMVMediaMgr mediaMgr;
+   ioNet.setNetworkAddresses(TESTADDR, TESTADDR);
+   ioNet.setEventDrivenMode(g_bEventIO, false);
+   if(!ioNet.init() || !mediaMgr.load())
+   {
+      fprintf(stderr, "SERVER: Failed to initialize\n");
+      g_bServerOk = false;
+      return(NULL);
+   }
+
+   // like CRMVDisplay, open a new session whenever the last one ends, until told to quit
+   while(!g_bQuit && g_bServerOk)
+   {
+      if(!ioNet.openSession())
+      {
+         fprintf(stderr, "SERVER: Failed to start command session\n");
+         g_bServerOk = false;
+         break;
+      }
+
+      bool bDone = false;
+      while(!bDone && g_bServerOk)
+      {
+         int cmd = ioNet.getNextCommand();
+         switch(cmd)
+         {
+            case RMV_CMD_NONE :
+               ioNet.waitForCommand(2000);
+               break;
+            case RMV_CMD_STARTINGUP :
+               break;
+            case RMV_CMD_GETVERSION :
+               ioNet.sendSignal(RMV_CURRENTVERSION);
+               break;
+            case RMV_CMD_PUTFILE :
+               mediaMgr.downloadMediaFile(&ioNet);
+               break;
+            case RMV_CMD_PUTFILEX :
+               mediaMgr.downloadMediaFileEx(&ioNet);
+               break;
+            case RMV_CMD_SHUTTINGDN :
+               g_bQuit = true;
+               bDone = true;
+               break;
+            default :
+               if(cmd < RMV_CMD_NONE) bDone = true;
+               else
+               {
+                  fprintf(stderr, "SERVER: Unexpected command (%d)\n", cmd);
+                  g_bServerOk = false;
+               }
+               break;
+         }
+      }
+      ioNet.closeSession();
+   }
+
+   ioNet.cleanup();
+   return(NULL);
+}
+
+//=== The Maestro side ================================================================================================
+
+// send the command in g_cmdBuf, where g_cmdBuf[0] is the command length in ints (as in CCxRMVideo::sendRMVCommand())
+static bool sendCommand()
+{
+   int nCmdBytes = g_cmdBuf[0] * sizeof(int);
+   g_cmdBuf[0] = nCmdBytes;
+   const char* pBytes = (const char*) g_cmdBuf;
+   int nSent = 0;
+   while(nSent < nCmdBytes + (int) sizeof(int))
+   {
+      int n = send(g_sock, pBytes + nSent, nCmdBytes + sizeof(int) - nSent, MSG_NOSIGNAL);
+      if(n < 0) { perror("CLIENT send"); return(false); }
+      nSent += n;
+   }
+   return(true);
+}
+
+// receive a reply: its length (in ints) followed by the reply itself. If timeoutMS is zero, return immediately with
+// bGotReply=false if no reply is pending.
+static bool receiveReply(int* pReply, int maxLen, int timeoutMS, bool& bGotReply)
+{
+   bGotReply = false;
+   struct pollfd pfd;
+   pfd.fd = g_sock;
+   pfd.events = POLLIN;
+   pfd.revents = 0;
+   int res = poll(&pfd, 1, timeoutMS);
+   if(res < 0) return(false);
+   else if(res == 0) return(timeoutMS == 0);
+
+   int len = 0;
+   if(recv(g_sock, &len, sizeof(int), MSG_WAITALL) != sizeof(int) || len <= 0 || len > maxLen) return(false);
+   bGotReply = (recv(g_sock, pReply, len*sizeof(int), MSG_WAITALL) == (ssize_t) (len*sizeof(int)));
+   return(bGotReply);
+}
+
+static bool receiveReply(int* pReply, int maxLen, int timeoutMS)
+{
+   bool bGotReply = false;
+   return(receiveReply(pReply, maxLen, timeoutMS, bGotReply) && bGotReply);
+}
+
+// connect to the server, which polls for a connection once per second, and start a command session
+static bool connectToServer()
+{
+   g_sock = socket(AF_INET, SOCK_STREAM, 0);
+   struct sockaddr_in addr;
+   ::memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+   addr.sin_port = htons(RMVNET_RMVPORT);
+   addr.sin_addr.s_addr = inet_addr(TESTADDR);
+   bool bConnected = false;
+   for(int i=0; i<50 && !bConnected && g_bServerOk; i++)
+   {
+      bConnected = (connect(g_sock, (struct sockaddr*) &addr, sizeof(addr)) == 0);
+      if(!bConnected) usleep(100000);
+   }
+   if(!bConnected) { fprintf(stderr, "CLIENT: Unable to connect to RMVideo\n"); return(false); }
+   int enable = 1;
+   setsockopt(g_sock, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(int));
+
+   g_cmdBuf[0] = 1;
+   g_cmdBuf[1] = RMV_CMD_STARTINGUP;
+   return(sendCommand());
+}
+
+static void disconnectFromServer()
+{
+   if(g_sock >= 0) close(g_sock);
+   g_sock = -1;
+}
+
+// write a 24-bit BMP image of IMGDIM x IMGDIM pseudorandom pixels
+static bool writeTestImage(const char* path, unsigned int seed)
+{
+   FILE* fp = fopen(path, "wb");
+   if(fp == NULL) return(false);
+
+   uint32_t rowBytes = IMGDIM * 3;                       // multiple of 4, so no row padding
+   unsigned char hdr[54];
+   ::memset(hdr, 0, sizeof(hdr));
+   uint32_t fields[][2] = { {2, 54 + rowBytes*IMGDIM}, {10, 54}, {14, 40}, {18, IMGDIM}, {22, IMGDIM},
+      {34, rowBytes*IMGDIM} };
+   hdr[0] = 'B';
+   hdr[1] = 'M';
+   for(unsigned int i=0; i<sizeof(fields)/sizeof(fields[0]); i++)
+      for(int b=0; b<4; b++) hdr[fields[i][0] + b] = (unsigned char) ((fields[i][1] >> (8*b)) & 0x0FF);
+   hdr[26] = 1;                                          // # of planes
+   hdr[28] = 24;                                         // bits per pixel
+   bool bOk = (fwrite(hdr, sizeof(hdr), 1, fp) == 1);
+
+   unsigned char* pRow = (unsigned char*) malloc(rowBytes);
+   unsigned int x = seed;
+   for(int r=0; bOk && pRow != NULL && r<IMGDIM; r++)
+   {
+      for(uint32_t i=0; i<rowBytes; i++)
+      {
+         x = x * 1664525u + 1013904223u;
+         pRow[i] = (unsigned char) (x >> 24);
+      }
+      bOk = (fwrite(pRow, rowBytes, 1, fp) == 1);
+   }
+   if(pRow == NULL) bOk = false;
+   free(pRow);
+   if(fclose(fp) != 0) bOk = false;
+   return(bOk);
+}
+
+// read an entire file into memory
+static unsigned char* readFile(const char* path, uint64_t& size)
+{
+   size = 0;
+   FILE* fp = fopen(path, "rb");
+   if(fp == NULL) return(NULL);
+   fseek(fp, 0, SEEK_END);
+   long n = ftell(fp);
+   fseek(fp, 0, SEEK_SET);
+   unsigned char* pBuf = (n > 0) ? (unsigned char*) malloc(n) : NULL;
+   if(pBuf != NULL && fread(pBuf, n, 1, fp) != 1)
+   {
+      free(pBuf);
+      pBuf = NULL;
+   }
+   fclose(fp);
+   if(pBuf != NULL) size = (uint64_t) n;
+   return(pBuf);
+}
+
+// content hash IAW the definition of RMV_CONTENTHASH
+static uint64_t getContentHash(const unsigned char* pBuf, uint64_t size)
+{
+   uint64_t h = RMV_CONTENTHASH_BASIS;
+   for(uint64_t i=0; i<size; i+=8)
+   {
+      uint64_t w = 0;
+      for(uint64_t j=0; j<8 && i+j<size; j++) w |= ((uint64_t) pBuf[i+j]) << (8*j);
+      h = (h ^ w) * RMV_CONTENTHASH_PRIME;
+   }
+   return((h ^ size) * RMV_CONTENTHASH_PRIME);
+}
+
+// verify that a file in the media store is identical to its source
+static bool verifyInstalledFile(const char* srcPath, const char* folder, const char* file)
+{
+   char path[256];
+   snprintf(path, sizeof(path), "%s/%s/%s", CRMVMediaMgr::MEDIASTOREDIR, folder, file);
+   uint64_t szSrc = 0, szDst = 0;
+   unsigned char* pSrc = readFile(srcPath, szSrc);
+   unsigned char* pDst = readFile(path, szDst);
+   bool bOk = (pSrc != NULL) && (pDst != NULL) && (szSrc == szDst) && (::memcmp(pSrc, pDst, szSrc) == 0);
+   free(pSrc);
+   free(pDst);
+   if(!bOk) fprintf(stderr, "CLIENT: Installed file %s does not match source %s\n", path, srcPath);
+   return(bOk);
+}
+
+// prepare the media folder and file names in the command buffer starting at index iStart; returns command length
+static int appendNames(int iStart, const char* folder, const char* file)
+{
+   int dirLen = (int) strlen(folder) + 1;
+   int fileLen = (int) strlen(file) + 1;
+   int nBytes = dirLen + fileLen;
+   while((nBytes % 4) != 0) nBytes++;
+   for(int i=0; i<nBytes/4; i++) g_cmdBuf[iStart+i] = 0;
+   char* pStr = (char*) &(g_cmdBuf[iStart]);
+   strcpy(pStr, folder);
+   strcpy(pStr + dirLen, file);
+   return(iStart - 1 + nBytes/4);
+}
+
+// download a file using the legacy RMV_CMD_PUTFILE sequence, as in CCxRMVideo::putFile()
+static bool putFile(const char* srcPath, const char* folder, const char* file)
+{
+   uint64_t size = 0;
+   unsigned char* pFile = readFile(srcPath, size);
+   if(pFile == NULL) return(false);
+
+   int reply[8];
+   g_cmdBuf[1] = RMV_CMD_PUTFILE;
+   g_cmdBuf[0] = appendNames(2, folder, file);
+   bool bOk = sendCommand() && receiveReply(reply, 8, 2000) && reply[0] == RMV_SIG_CMDACK;
+
+   struct timespec tStart;
+   clock_gettime(CLOCK_MONOTONIC, &tStart);
+   char* pBytes = (char*) &(g_cmdBuf[3]);
+   for(uint64_t off = 0; bOk && off < size; off += 2048)
+   {
+      int n = (size - off < 2048) ? int(size - off) : 2048;
+      memcpy(pBytes, pFile + off, n);
+      g_cmdBuf[1] = RMV_CMD_PUTFILECHUNK;
+      g_cmdBuf[2] = n;
+      while(n % 4 != 0) pBytes[n++] = 0;
+      g_cmdBuf[0] = 2 + n/4;
+      bOk = sendCommand() && receiveReply(reply, 8, 2000) && reply[0] == RMV_SIG_CMDACK;
+   }
+   g_tChunks = getElapsedSecs(tStart);
+   free(pFile);
+
+   if(bOk)
+   {
+      g_cmdBuf[0] = 2;
+      g_cmdBuf[1] = RMV_CMD_PUTFILEDONE;
+      g_cmdBuf[2] = 1;
+      bOk = sendCommand() && receiveReply(reply, 8, 10000) && reply[0] == RMV_SIG_CMDACK;
+   }
+   if(!bOk) fprintf(stderr, "CLIENT: RMV_CMD_PUTFILE download of %s failed\n", srcPath);
+   return(bOk);
+}
+
+// download a file using the RMV_CMD_PUTFILEX sequence, as in CCxRMVideo::putFileWindowed(). The status in RMVideo's
+// reply to RMV_CMD_PUTFILEX, and the byte offset at which it asked the transfer to start, are returned. If nDropAfter
+// is positive, the connection is dropped after that many chunks have been acknowledged.
+static bool putFileWindowed(const char* srcPath, const char* folder, const char* file, int& status, uint64_t& offset,
+      int nDropAfter)
+{
+   status = -1;
+   offset = 0;
+   uint64_t size = 0;
+   unsigned char* pFile = readFile(srcPath, size);
+   if(pFile == NULL) return(false);
+   uint64_t hash = getContentHash(pFile, size);
+
+   int reply[8];
+   g_cmdBuf[1] = RMV_CMD_PUTFILEX;
+   g_cmdBuf[2] = (int) (size & 0x0FFFFFFFFULL);
+   g_cmdBuf[3] = (int) (size >> 32);
+   g_cmdBuf[4] = (int) (hash & 0x0FFFFFFFFULL);
+   g_cmdBuf[5] = (int) (hash >> 32);
+   g_cmdBuf[0] = appendNames(6, folder, file);
+   bool bOk = sendCommand() && receiveReply(reply, 8, 30000) && reply[0] == RMV_SIG_CMDACK;
+   if(bOk)
+   {
+      status = reply[1];
+      offset = (((uint64_t) (unsigned int) reply[3]) << 32) | ((uint64_t) (unsigned int) reply[2]);
+      bOk = (offset <= size);
+   }
+   if(!bOk || status != RMV_PUTX_SEND)
+   {
+      free(pFile);
+      if(!bOk) fprintf(stderr, "CLIENT: RMV_CMD_PUTFILEX for %s failed\n", srcPath);
+      return(bOk);
+   }
+
+   struct timespec tStart;
+   clock_gettime(CLOCK_MONOTONIC, &tStart);
+   int nInFlight = 0;
+   int nAcked = 0;
+   uint64_t off = offset;
+   char* pBytes = (char*) &(g_cmdBuf[3]);
+   while(bOk && (nInFlight > 0 || off < size))
+   {
+      bool bGotReply = false;
+      bool bSend = (nInFlight < RMV_PUTX_WINDOW) && (off < size) &&
+            (nDropAfter <= 0 || nAcked + nInFlight < nDropAfter);
+      if(bSend)
+      {
+         int n = (size - off < (uint64_t) RMV_PUTX_CHUNKSZ) ? int(size - off) : RMV_PUTX_CHUNKSZ;
+         memcpy(pBytes, pFile + off, n);
+         off += n;
+         g_cmdBuf[1] = RMV_CMD_PUTFILECHUNK;
+         g_cmdBuf[2] = n;
+         while(n % 4 != 0) pBytes[n++] = 0;
+         g_cmdBuf[0] = 2 + n/4;
+         bOk = sendCommand();
+         if(bOk) ++nInFlight;
+         if(bOk) bOk = receiveReply(reply, 8, 0, bGotReply);
+      }
+      else if(nInFlight > 0)
+         bOk = receiveReply(reply, 8, 2000, bGotReply) && bGotReply;
+      else
+         break;
+
+      if(bOk && bGotReply)
+      {
+         --nInFlight;
+         ++nAcked;
+         bOk = (reply[0] == RMV_SIG_CMDACK);
+      }
+   }
+   g_tChunks = getElapsedSecs(tStart);
+   free(pFile);
+
+   if(nDropAfter > 0)
+   {
+      disconnectFromServer();
+      return(bOk);
+   }
+
+   if(bOk)
+   {
+      g_cmdBuf[0] = 2;
+      g_cmdBuf[1] = RMV_CMD_PUTFILEDONE;
+      g_cmdBuf[2] = 1;
+      bOk = sendCommand() && receiveReply(reply, 8, 30000) && reply[0] == RMV_SIG_CMDACK;
+   }
+   if(!bOk) fprintf(stderr, "CLIENT: RMV_CMD_PUTFILEX download of %s failed\n", srcPath);
+   return(bOk);
+}
+
+static bool runClient()
+{
+   if(!(writeTestImage(SRCLEGACY, 1) && writeTestImage(SRCWINDOWED, 2) && writeTestImage(SRCRESUMED, 3)))
+   {
+      fprintf(stderr, "CLIENT: Unable to write test images\n");
+      return(false);
+   }
+   if(!connectToServer()) return(false);
+
+   int reply[8];
+   g_cmdBuf[0] = 1;
+   g_cmdBuf[1] = RMV_CMD_GETVERSION;
+   if(!sendCommand() || !receiveReply(reply, 8, 5000)) return(false);
+   printf("RMVideo version %d\n", reply[0]);
+   if(reply[0] < RMV_PUTFILEXVERSION)
+   {
+      fprintf(stderr, "CLIENT: RMVideo does not support RMV_CMD_PUTFILEX\n");
+      return(false);
+   }
+   double mb = double(54 + 3*IMGDIM*IMGDIM) / (1024.0*1024.0);
+
+   // (1) legacy download
+   struct timespec tStart;
+   clock_gettime(CLOCK_MONOTONIC, &tStart);
+   if(!putFile(SRCLEGACY, "test", "legacy.bmp")) return(false);
+   double tLegacy = getElapsedSecs(tStart);
+   if(!verifyInstalledFile(SRCLEGACY, "test", "legacy.bmp")) return(false);
+   printf("RMV_CMD_PUTFILE : %.1f MB in %.3f s (%.1f MB/s); file chunks alone: %.3f s (%.1f MB/s)\n", mb, tLegacy,
+         mb / tLegacy, g_tChunks, mb / g_tChunks);
+
+   // (2) windowed download
+   int status;
+   uint64_t offset;
+   clock_gettime(CLOCK_MONOTONIC, &tStart);
+   if(!putFileWindowed(SRCWINDOWED, "test", "windowed.bmp", status, offset, 0)) return(false);
+   double tWindowed = getElapsedSecs(tStart);
+   if(status != RMV_PUTX_SEND || offset != 0 || !verifyInstalledFile(SRCWINDOWED, "test", "windowed.bmp"))
+   {
+      fprintf(stderr, "CLIENT: Windowed download failed (status=%d, offset=%llu)\n", status,
+            (unsigned long long) offset);
+      return(false);
+   }
+   printf("RMV_CMD_PUTFILEX: %.1f MB in %.3f s (%.1f MB/s); file chunks alone: %.3f s (%.1f MB/s)\n", mb, tWindowed,
+         mb / tWindowed, g_tChunks, mb / g_tChunks);
+
+   // (3) deduplication
+   clock_gettime(CLOCK_MONOTONIC, &tStart);
+   if(!putFileWindowed(SRCWINDOWED, "test", "windowed.bmp", status, offset, 0)) return(false);
+   double tExists = getElapsedSecs(tStart);
+   if(status != RMV_PUTX_EXISTS)
+   {
+      fprintf(stderr, "CLIENT: Expected RMV_PUTX_EXISTS, got status %d\n", status);
+      return(false);
+   }
+   clock_gettime(CLOCK_MONOTONIC, &tStart);
+   if(!putFileWindowed(SRCWINDOWED, "copies", "windowed.bmp", status, offset, 0)) return(false);
+   double tCopied = getElapsedSecs(tStart);
+   if(status != RMV_PUTX_COPIED || !verifyInstalledFile(SRCWINDOWED, "copies", "windowed.bmp"))
+   {
+      fprintf(stderr, "CLIENT: Expected RMV_PUTX_COPIED, got status %d\n", status);
+      return(false);
+   }
+   printf("Deduplication   : same destination -> EXISTS in %.3f s; new destination -> COPIED in %.3f s\n",
+         tExists, tCopied);
+
+   // (4) resume after the connection is lost midway through a transfer
+   int nChunks = (int) ((54 + 3*IMGDIM*IMGDIM + RMV_PUTX_CHUNKSZ - 1) / RMV_PUTX_CHUNKSZ);
+   if(!putFileWindowed(SRCRESUMED, "test", "resumed.bmp", status, offset, nChunks/2)) return(false);
+   if(!connectToServer()) return(false);
+   if(!putFileWindowed(SRCRESUMED, "test", "resumed.bmp", status, offset, 0)) return(false);
+   uint64_t expected = (uint64_t) (nChunks/2) * RMV_PUTX_CHUNKSZ;
+   if(status != RMV_PUTX_SEND || offset != expected || !verifyInstalledFile(SRCRESUMED, "test", "resumed.bmp"))
+   {
+      fprintf(stderr, "CLIENT: Resumed download failed (status=%d, offset=%llu, expected %llu)\n", status,
+            (unsigned long long) offset, (unsigned long long) expected);
+      return(false);
+   }
+   printf("Resume          : reconnected and resumed at byte %llu of %llu\n", (unsigned long long) offset,
+         (unsigned long long) (54 + 3*IMGDIM*IMGDIM));
+
+   g_cmdBuf[0] = 1;
+   g_cmdBuf[1] = RMV_CMD_SHUTTINGDN;
+   sendCommand();
+   return(g_bServerOk);
+}
+
+int main(int argc, char* argv[])
+{
+   g_bEventIO = (argc > 1) && (::strcmp(argv[1], "eventio") == 0);
+
+   char testDir[] = "/tmp/rmvputtestXXXXXX";
+   if(mkdtemp(testDir) == NULL || chdir(testDir) != 0)
+   {
+      fprintf(stderr, "Unable to create test directory\n");
+      return(1);
+   }
+
+   pthread_t server;
+   if(pthread_create(&server, NULL, serverEntry, NULL) != 0)
+   {
+      fprintf(stderr, "Unable to start server thread\n");
+      return(1);
+   }
+
+   // on failure, the server may be waiting for a new session, so we don't wait for it to finish
+   bool bOk = runClient();
+   disconnectFromServer();
+   if(bOk) pthread_join(server, NULL);
+
+   char cmd[100];
+   snprintf(cmd, sizeof(cmd), "rm -rf %s", testDir);
+   if(chdir("/") != 0 || system(cmd) != 0) fprintf(stderr, "Unable to remove test directory %s\n", testDir);
+
+   printf("%s\n", bOk ? "PASSED" : "FAILED");
+   return(bOk ? 0 : 1);
+}
@@ -105,10 +105,65 @@ greater.
  500-frame measurement.
  16dec2024-- Changes to support "stereo mode" (Priebe lab) in measureFramePeriod(), redrawIdleBackground(), and
  animate().
+ 16oct2026-- The target update stage of animate() is now parallelized via a persistent pool of worker threads
+ (CWorkerPool). See updateTargets().
+ 16oct2026-- Added optional pipelined mode (see setPipelinedMode()): when GL4.4 or ARB_buffer_storage is available,
+ the shared vertex buffer is allocated as immutable storage and persistently mapped, so that per-frame dot vertex
+ uploads are a simple memory copy. The glFinish() after each buffer swap is retained. See uploadVertexData().
+ 16oct2026-- Added the GPU dot engine, an optional alternative to the CPU-side animation of RMV_RANDOMDOTS and
+ RMV_FLOWFIELD. Dot state stays resident on the GPU and is advanced each frame by a transform feedback pass of a
+ dedicated vertex shader (DOTENGINESHADERSRC). See runGPUDotEngine().
+ 16oct2026-- animate() now records the duration of each stage of the animation loop (target update, draw, buffer swap,
+ command retrieval), the drift T-N*P, and the update cost of each target for every frame (CFrameTelemetry). A summary
+ is available via RMV_CMD_GETFRAMESTATS, and the records may be exported to a CSV file after each sequence. See
+ enableTelemetryExport().
+ 16oct2026-- Movie frames decoded to planar YUV 4:2:0 are now converted to RGB in the fragment shader (special == 3)
+ rather than by CVidBuffer on the CPU. Added a fourth texture pool type, YUVIMAGETEX, a single-component texture that
+ holds all three planes of a frame. See prepareYUVFrameTexture(), uploadMovieFrameToTexture() and 
+ updateYUVFrameUniforms().
+ 16oct2026-- Added optional zero-copy movie mode (see setZeroCopyMovieMode()). Each RMV_MOVIE target's frame queue
+ lives in a persistently mapped pixel buffer created by createMovieFrameStore(), and CVidBuffer decodes directly into
+ it. Requires OpenGL 4.4 or GL_ARB_buffer_storage.
+ 16oct2026-- The locations of the RMVideo shader's per-target uniforms are now resolved once, after the program is
+ linked, instead of on every uniform update. The "special", "nGrats" and "tgtC" uniforms are uploaded only when their
+ values change. See resolveTargetUniforms().
+ 16oct2026-- The monolithic fragment shader, which selected the rendering path for every fragment via the uniforms
+ "special", "nGrats" and "isSine", is now compiled into 8 specialized target programs, one per class of target, by
+ prepending macro definitions to the shader source. Each CRMVTarget selects its program at the start of draw(); targets
+ are still drawn in load order, and the program is switched only when consecutive targets need different programs.
+ See createTargetPrograms() and useTargetProgram(). updateCommonUniforms() no longer takes the target type, since
+ the program selected by useTargetProgram() already reflects it.
+ 16oct2026-- Added optional analytic aperture mode (see setAnalyticApertureMode()): the aperture and Gaussian window of
+ RMV_SPOT, _GRATING and _PLAID targets are computed per fragment, with analytic antialiasing, by dedicated target
+ programs. No alpha mask is built when such targets are loaded. In the default mode, each alpha mask texture in the
+ pool now remembers its mask parameters, so an identical mask is reused without recomputation. When telemetry export
+ is enabled, loadTargets() reports its latency.
+ 16oct2026-- Added optional late-latch mode (see setLateLatchMode()). If the RMV_CMD_UPDATEFRAME for the next frame has
+ not arrived at the start of a frame, animate() now waits for it on the IO link for as long as the frame can still be
+ updated and rendered before the next vertical blank, instead of immediately giving up and repeating the frame.
+ 16oct2026-- loadTargets() now prepares targets in parallel. The CPU-side work of target initialization -- image
+ decoding, video stream open and pre-roll, alpha mask computation, dot pattern generation -- runs on the worker pool,
+ and only the GL resource allocations and uploads are serialized on the GL thread. See CRMVTarget::prepare(). When
+ telemetry export is enabled, the load latency report includes a per-stage and per-target breakdown.
+ 16oct2026-- Reworked the texture pool. Textures are grouped in size classes (type, w, h) found by hashing, each with
+ a list of its unused textures, and a second hash table maps texture ID to pool node, so neither a texture request nor
+ releaseTexture() scans the pool. The hard-coded 50MB limit, enforced by culling unused textures in the middle of 
+ loadTargets(), is replaced by a configurable budget (setTexturePoolBudget()) enforced in idle time by evicting the 
+ least recently released textures; the pool is also pre-warmed with any textures needed by the most recently loaded 
+ target list that were evicted. See maintainTexturePool(). Pool statistics are reported via RMV_CMD_GETFRAMESTATS.
+ 16oct2026-- Added optional single-pass stereo rendering (setSinglePassStereoMode()). Instead of drawing every target
+ twice, once per backbuffer, each target is drawn once with an instanced draw call: instance 0 is the left eye and 
+ instance 1 the right, the vertex shader applying the per-eye dot disparity (uniform 'eyeDx'). The two views go to an
+ offscreen framebuffer -- a 2-layer texture array if gl_Layer can be written from the vertex shader, else a texture
+ twice the screen width with each eye clipped to its half -- which is then blitted to the L and R backbuffers. With
+ no stereo backbuffers (headless mode), the two views are placed side by side in the one backbuffer. All frame 
+ rendering now goes through renderFrame(). See also createStereoFramebuffer(), resolveStereoFrame().
 */
 
 #include "stdio.h"
 #include "unistd.h"
+#include <stdlib.h>
+#include <string.h>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -128,19 +183,47 @@ greater.
  NOTES: (1) For the RMV_RANDOMDOTS target's "two-color constrast mode", one half the dots are rendered in one color, 
  and the other half in the second color. So the dot patch is rendered in two parts in that mode. (2) Targets which 
  don't really need a texture are bound to a tiny alpha texture with alpha=1.0 for all texels.
+
+ Like the fragment shader, the source is not compiled as is: a "#version" line and a definition of the macro STEREO
+ are prepended. STEREO is nonzero in single-pass stereo mode, in which every primitive is drawn as two instances, one
+ per eye, and the uniform "eyeDx" holds the target's stereo disparity in normalized coordinates. With STEREO == 1 
+ (layered), each eye is routed to its own layer of the framebuffer via gl_Layer, which requires the extension 
+ GL_ARB_shader_viewport_layer_array or GL_AMD_vertex_shader_layer. With STEREO == 2 (side-by-side), each eye is clipped
+ to the normal viewport and then squeezed into its half of a framebuffer twice the screen width; the fragment shader
+ needs the left edge of that half, "eyeX0", to recover screen coordinates. See createTargetPrograms().
 */
-const char* CRMVRenderer::VERTEXSHADERSRC="#version 330 core\n"
+const char* CRMVRenderer::VERTEXSHADERSRC=
 "layout (location=0) in vec2 aPos;        // The vertex location (x,y) in 2D space.\n"
 "layout (location=1) in vec2 aTexCoord;   // Corresponding texture coordinates.\n"
 "uniform mat4 xfm;                        // Transforms vertex to normalized space.\n"
 "uniform vec3 tgtC;                       // The target RGB color applied to the vertex.\n"
 "out vec3 rgb;                            // RGB color forwarded to the fragment shader.\n"
 "out vec2 TexCoord;                       // texture coordinates forwarded to the fragment shader.\n"
+"#if STEREO\n"
+"uniform float eyeDx;                     // stereo disparity (right eye WRT left) in normalized coordinates\n"
+"#endif\n"
+"#if STEREO == 2\n"
+"uniform float eyeW;                      // width of each eye's half of the framebuffer, in pixels\n"
+"flat out float eyeX0;                    // left edge of this eye's half of the framebuffer, in pixels\n"
+"#endif\n"
 "void main()\n"
 "{\n"
 "   gl_Position = xfm * vec4(aPos, 0.0, 1.0);\n"
 "   TexCoord = aTexCoord;\n"
 "   rgb = tgtC;\n"
+"#if STEREO\n"
+"   // instance 0 is the left eye, instance 1 the right; each is offset horizontally by half the disparity\n"
+"   float eye = (gl_InstanceID == 0) ? -0.5 : 0.5;\n"
+"   gl_Position.x += eye * eyeDx * gl_Position.w;\n"
+"#if STEREO == 1\n"
+"   gl_Layer = gl_InstanceID;\n"
+"#else\n"
+"   gl_ClipDistance[0] = gl_Position.w + gl_Position.x;\n"
+"   gl_ClipDistance[1] = gl_Position.w - gl_Position.x;\n"
+"   gl_Position.x = 0.5 * gl_Position.x + eye * gl_Position.w;\n"
+"   eyeX0 = float(gl_InstanceID) * eyeW;\n"
+"#endif\n"
+"#endif\n"
 "}\0";
 
 /**
@@ -153,7 +236,11 @@ const char* CRMVRenderer::VERTEXSHADERSRC="#version 330 core\n"
  calculations.
 
  RMV_MOVIE, RMV_IMAGE: Target window is a single quad, as above. Source texture is an RGBA texture containing the
- full image, or an RGB texture holding the video frame. The shader simply maps the texture onto the quad.
+ full image, or an RGB texture holding the video frame. The shader simply maps the texture onto the quad. Movies that
+ decode to YUV 4:2:0 (SPECIAL == 3) are instead held in a single-component texture containing the Y plane, with the U
+ and V planes side by side beneath it (see prepareYUVFrameTexture()); the shader samples all three planes and converts
+ to RGB (ITU-R BT.601, limited or full range). Samples are clamped half a texel inside each plane so that linear 
+ filtering never blends texels from adjacent planes.
 
  RMV_POINT, RMV_FLOWFIELD, RMV_RANDOMDOTS: Vertices define individual dot locations (GL_POINTS) and are updated
  per-frame (for RMV_FLOWFIELD and _RANDOMDOTS, vertices are calculated on CPU side and then transformed in the
@@ -166,18 +253,23 @@ const char* CRMVRenderer::VERTEXSHADERSRC="#version 330 core\n"
  All necessary information is passed via uniform variables. Note that, if a target implementation does not use a
  particular uniform, that variable will not be set by the client. For example, for the RMV_SPOT target, none of the
  uniforms related to the grating calcs apply.
+
+ The source is NOT compiled as is. Rather than selecting the rendering path for every fragment via uniforms -- so that
+ every fragment of every target pays for the texture fetch, both grating sinusoids and the image path -- a separate
+ program is built for each class of target by prepending a "#version" line and definitions of the macros SPECIAL (1
+ for RMV_IMAGE and RGB RMV_MOVIE, 2 for RMV_RANDOMDOTS, 3 for YUV RMV_MOVIE, else 0), NGRATS (2 for plaid, 1 for a 
+ single grating, else 0), ISSINE (nonzero for sinewave gratings) and WINDOW (nonzero if the aperture and Gaussian
+ window are computed analytically rather than sampled from the alpha mask texture). Unused code and uniforms are 
+ compiled out. The macro STEREO is also defined, as for VERTEXSHADERSRC. See createTargetPrograms().
 */
-const char* CRMVRenderer::FRAGMENTSHADERSRC="#version 330 core\n"
+const char* CRMVRenderer::FRAGMENTSHADERSRC=
 "out vec4 FragColor;          // final fragment color, including alpha channel\n"
 "in vec3 rgb;                 // opaque fragment color (forwarded from vertex shader)\n"
 "in vec2 TexCoord;            // texture coordinates (forwarded from vertex shader)\n"
 "// RMV_IMAGE, _MOVIE: image or current video frame. All others: alpha mask implementing aperture and Gaussian blur\n"
 "uniform sampler2D tex;\n"
-"uniform int special;         // 1 for RMV_IMAGE, RMV_MOVIE; 2 for RMV_RANDOMDOTS; else 0\n"
-"uniform int nGrats;          // 2 for plaid, 1 for single grating; 0 otherwise\n"
-"// all uniforms below this line apply only to grating calculations for grating/plaid targets\n"
+"// these uniforms apply only to grating calculations for grating/plaid targets\n"
 "uniform vec2 ctr;            // current target center in screen coords (pixels WRT origin at TL corner)\n"
-"uniform int isSine;          // (grating/plaid targets only) nonzero for sinewave, 0 for squarewave\n"
 "uniform vec3 mean0;          // RGB mean color for grating 0 [0..1]\n"
 "uniform vec3 con0;           // RGB contrast for grating 0 [0..1]\n"
 "uniform vec3 mean1;          // RGB mean color for grating 1\n"
@@ -185,53 +277,275 @@ const char* CRMVRenderer::FRAGMENTSHADERSRC="#version 330 core\n"
 "uniform vec2 dx;             // projection of X spatial period onto line perpendicular to grating 0 and 1, in pixels\n"
 "uniform vec2 dy;             // projection of Y spatial period onto line perpendicular to grating 0 and 1, in pixels\n"
 "uniform vec2 phase;          // spatial phase of gratings 0 and 1, in normalized coordinates\n"
+"// these uniforms apply only to YUV movie frames\n"
+"uniform vec4 yuvDims;        // frame width and height, then chroma plane width and height, in pixels\n"
+"uniform int yuvFullRange;    // nonzero if YUV samples span [0..255]; else Y in [16..235], U,V in [16..240]\n"
+"\n"
+"const float TWOPI = 6.28318531;\n"
 "\n"
-"float when_eq(float x, float y)\n"
+"// fragment location in screen coordinates. In side-by-side stereo, the right eye is offset by the screen width.\n"
+"#if STEREO == 2\n"
+"flat in float eyeX0;\n"
+"#define FRAGXY (gl_FragCoord.xy - vec2(eyeX0, 0.0))\n"
+"#else\n"
+"#define FRAGXY gl_FragCoord.xy\n"
+"#endif\n"
+"\n"
+"#if WINDOW\n"
+"// these uniforms apply only to targets with an analytic aperture and Gaussian window\n"
+"uniform int aperture;         // RMV_RECT = 0, RMV_OVAL = 1, RMV_RECTANNU = 2, RMV_OVALANNU = 3\n"
+"uniform vec4 apDims;          // half-width and half-height of outer, then inner, aperture bounds, in pixels\n"
+"uniform vec2 gaussFac;        // -1/(2*sigma^2) along X and Y, sigma in pixels; 0 if no Gaussian along that axis\n"
+"\n"
+"// fraction of the fragment covered by the rectangle with the given half-dimensions, centered at the origin\n"
+"float rectCoverage(vec2 p, vec2 halfDims)\n"
 "{\n"
-"   return 1.0f - abs(sign(x-y));\n"
+"   vec2 c = clamp(halfDims - abs(p) + 0.5, 0.0, 1.0);\n"
+"   return c.x * c.y;\n"
 "}\n"
 "\n"
-"float when_neq(float x, float y)\n"
+"// fraction of the fragment covered by the ellipse with the given semi-axes, centered at the origin. The normalized\n"
+"// radius r=1 on the boundary; r's screen-space derivative converts the distance to the boundary into pixels.\n"
+"float ovalCoverage(vec2 p, vec2 halfDims)\n"
 "{\n"
-"   return abs(sign(x-y));\n"
+"   float r = length(p / max(halfDims, vec2(0.01)));\n"
+"   return clamp(0.5 + (1.0 - r) / max(fwidth(r), 1.0e-6), 0.0, 1.0);\n"
 "}\n"
 "\n"
-"const float TWOPI = 6.28318531;\n"
+"// fragment alpha IAW the target's aperture and Gaussian window; p is fragment location WRT target center in pixels\n"
+"float windowAlpha(vec2 p)\n"
+"{\n"
+"   float a = 1.0;\n"
+"   if(aperture == 1) a = ovalCoverage(p, apDims.xy);\n"
+"   else if(aperture == 2) a = rectCoverage(p, apDims.xy) * (1.0 - rectCoverage(p, apDims.zw));\n"
+"   else if(aperture == 3) a = ovalCoverage(p, apDims.xy) * (1.0 - ovalCoverage(p, apDims.zw));\n"
+"   return a * exp(dot(p*p, gaussFac));\n"
+"}\n"
+"#endif\n"
+"\n"
+"#if SPECIAL == 3\n"
+"// sample the Y, U and V planes of a YUV 4:2:0 movie frame and convert to RGB (ITU-R BT.601)\n"
+"vec4 yuvToRGBA()\n"
+"{\n"
+"   vec2 texSz = vec2(textureSize(tex, 0));\n"
+"   vec2 pY = clamp(TexCoord * yuvDims.xy, vec2(0.5), yuvDims.xy - 0.5);\n"
+"   vec2 pC = clamp(TexCoord * yuvDims.zw, vec2(0.5), yuvDims.zw - 0.5);\n"
+"   float y = texture(tex, pY / texSz).r;\n"
+"   float u = texture(tex, (pC + vec2(0.0, yuvDims.y)) / texSz).r - 0.5;\n"
+"   float v = texture(tex, (pC + vec2(yuvDims.z, yuvDims.y)) / texSz).r - 0.5;\n"
+"   vec3 c;\n"
+"   if(yuvFullRange != 0)\n"
+"      c = vec3(y + 1.402*v, y - 0.344136*u - 0.714136*v, y + 1.772*u);\n"
+"   else\n"
+"   {\n"
+"      y = 1.164384*(y - 0.062745);\n"
+"      c = vec3(y + 1.596027*v, y - 0.391762*u - 0.812968*v, y + 2.017232*u);\n"
+"   }\n"
+"   return vec4(clamp(c, 0.0, 1.0), 1.0);\n"
+"}\n"
+"#endif\n"
+"\n"
+"#if NGRATS > 0\n"
+"// grating calcs: the spatial period is in pixels, and we need to divide this into the fragment coordinates. So we\n"
+"// leave the fragment coordinates in pixels, but WRT origin at target center.\n"
+"float grating(vec2 p, int i)\n"
+"{\n"
+"   float frac = sin(TWOPI*(p.x*dx[i] + p.y*dy[i]) + phase[i]);\n"
+"#if ISSINE == 0\n"
+"   frac = 2.0*smoothstep(-0.02, 0.02, frac) - 1.0;\n"
+"#endif\n"
+"   return frac;\n"
+"}\n"
+"#endif\n"
 "\n"
 "void main()\n"
 "{\n"
-"   vec2 p;\n"
+"#if SPECIAL == 1\n"
+"   FragColor = texture(tex, TexCoord);\n"
+"#elif SPECIAL == 3\n"
+"   FragColor = yuvToRGBA();\n"
+"#elif SPECIAL == 2\n"
+"   // RMV_RANDOMDOTS: per-dot alpha is in TexCoord.x and alpha mask texture is unused\n"
+"   FragColor = vec4(rgb, TexCoord.x);\n"
+"#else\n"
+"   // the texture is an alpha mask texture, with alpha in the R cmpt\n"
 "   vec3 color = rgb;\n"
-"   vec4 rgba = texture(tex, TexCoord);\n"
+"#if NGRATS > 0\n"
+"   vec2 p = FRAGXY - ctr;\n"
+"   color = mean0 * (1.0 + con0*grating(p, 0));\n"
+"#if NGRATS > 1\n"
+"   color += mean1 * (1.0 + con1*grating(p, 1));\n"
+"#endif\n"
+"   color = clamp(color, 0.0, 1.0);\n"
+"#endif\n"
+"#if WINDOW\n"
+"   FragColor = vec4(color, windowAlpha(FRAGXY - ctr));\n"
+"#else\n"
+"   FragColor = vec4(color, texture(tex, TexCoord).r);\n"
+"#endif\n"
+"#endif\n"
+"}\0";
+
+
+/**
+ Vertex shader source code for the GPU dot engine, an alternative to the CPU-side animation of the RMV_RANDOMDOTS and
+ RMV_FLOWFIELD targets. See runGPUDotEngine().
+
+ The shader never rasterizes anything; it runs with GL_RASTERIZER_DISCARD enabled, and its outputs are captured via
+ transform feedback. Each vertex is one dot. Per-dot state is stored in 8 floats, {x, y, Tx, Ty, life, C, S, 0}: the
+ first 4 are the vertex attributes consumed by the RMVideo shader program, so the buffer written by one pass is both
+ the input to the next pass and the vertex buffer from which the dots are drawn. Here Tx holds the per-dot alpha for
+ RMV_RANDOMDOTS, as in the CPU implementation; life is the dot's remaining lifetime, and C,S are the per-dot noise
+ displacement coefficients. Only {x, y, Tx, Ty} are used for RMV_FLOWFIELD.
+
+ The update algorithms mirror CRMVTarget::updateRandomDots() and updateFlowField(), except that random numbers come 
+ from a counter-based generator: a uniform deviate in (0..1) is a hash of the key (seed, pass #, dot index, stream #),
+ where the stream # distinguishes the different uses within a single pass. Thus a given seed always yields the same
+ animation, but NOT the same one as the CPU implementation (which remains the reference). 
+
+ Pass modes: 0 = initialize RMV_RANDOMDOTS; 1 = update RMV_RANDOMDOTS; 2 = initialize RMV_FLOWFIELD; 3 = update 
+ RMV_FLOWFIELD. Noise modes: 0 = none; 1 = direction; 2 = additive speed; 3 = multiplicative speed (2^X).
+*/
+const char* CRMVRenderer::DOTENGINESHADERSRC="#version 330 core\n"
+"layout (location = 0) in vec2 aPos;\n"
+"layout (location = 1) in vec2 aTexCoord;\n"
+"layout (location = 2) in vec4 aAux;\n"
+"out vec2 outPos;\n"
+"out vec2 outTexCoord;\n"
+"out vec4 outAux;\n"
+"\n"
+"uniform int mode;\n"
+"uniform uint seed;\n"
+"uniform uint pass;\n"
+"uniform int aperture;\n"
+"uniform vec2 outerDims;\n"
+"uniform vec2 innerDims;\n"
+"uniform vec2 gaussFac;\n"
+"uniform vec2 patDisp;\n"
+"uniform vec2 winDisp;\n"
+"uniform float pctCoherent;\n"
+"uniform float dotLife;\n"
+"uniform float dotLifeDelta;\n"
+"uniform int noiseMode;\n"
+"uniform bool noiseUpdate;\n"
+"uniform float noiseLimit;\n"
+"uniform float log2Fac;\n"
+"uniform float flowB;\n"
+"uniform float flowRecycleRate;\n"
+"uniform float flowRecycleDR;\n"
+"\n"
+"uint hash(uint x)\n"
+"{\n"
+"   x ^= x >> 16; x *= 0x7feb352du;\n"
+"   x ^= x >> 15; x *= 0x846ca68bu;\n"
+"   x ^= x >> 16;\n"
+"   return x;\n"
+"}\n"
+"\n"
+"float rnd(uint stream)\n"
+"{\n"
+"   uint h = hash(seed ^ hash(uint(gl_VertexID) ^ hash(pass * 8u + stream)));\n"
+"   return (float(h >> 8) + 0.5) * (1.0 / 16777216.0);\n"
+"}\n"
+"\n"
+"float dotAlpha(vec2 p)\n"
+"{\n"
+"   vec2 o = 0.5 * outerDims;\n"
+"   vec2 i = 0.5 * innerDims;\n"
+"   bool inside = true;\n"
+"   if(aperture == 2) inside = (abs(p.x) > i.x) || (abs(p.y) > i.y);\n"
+"   else if(aperture == 1) inside = dot(p*p, 1.0/(o*o)) <= 1.0;\n"
+"   else if(aperture == 3) inside = (dot(p*p, 1.0/(o*o)) <= 1.0) && (dot(p*p, 1.0/(i*i)) > 1.0);\n"
+"   if(!inside) return 0.0;\n"
+"   return clamp(exp(dot(p*p, gaussFac)), 0.0, 1.0);\n"
+"}\n"
 "\n"
-"   // for targets other than RMV_IMAGE, _MOVIE, the texture is an alpha mask texture, with alpha in the R cmpt\n"
-"   // special case: for RMV_RANDOMDOTS, per-dot alpha is in TexCoord.x and alpha mask texture is unused.\n"
-"   float alpha = when_eq(special, 2)*TexCoord.x + when_neq(special, 2)*rgba.r;\n"
+"vec2 randomDotPos() { return (vec2(rnd(2u), rnd(3u)) - 0.5) * outerDims; }\n"
 "\n"
-"   // grating calcs to compute fragment RGB. The spatial period is in pixels, and we need to divide this into the\n"
-"   // fragment coordinates. So we leave the fragment coordinates in pixels, but WRT origin at target center.\n"
-"   if(nGrats > 0)\n"
+"vec2 randomFlowPos()\n"
+"{\n"
+"   float r = innerDims.x + rnd(2u) * (outerDims.x - innerDims.x);\n"
+"   float th = radians(360.0 * rnd(3u));\n"
+"   return r * vec2(cos(th), sin(th));\n"
+"}\n"
+"\n"
+"void main()\n"
+"{\n"
+"   vec2 p = aPos;\n"
+"   vec4 aux = aAux;\n"
+"   if(mode == 0)\n"
+"   {\n"
+"      p = randomDotPos();\n"
+"      aux = vec4(rnd(5u) * dotLife, 1.0, 0.0, 0.0);\n"
+"   }\n"
+"   else if(mode == 1)\n"
+"   {\n"
+"      if(noiseMode > 0 && noiseUpdate)\n"
+"      {\n"
+"         float n = rnd(4u) * 2.0 * noiseLimit - noiseLimit;\n"
+"         if(noiseMode == 1) aux.yz = vec2(cos(radians(n)), sin(radians(n)));\n"
+"         else if(noiseMode == 2) aux.yz = vec2(1.0 + n / 100.0, 0.0);\n"
+"         else aux.yz = vec2(exp2(n) / log2Fac, 0.0);\n"
+"      }\n"
+"      vec2 cand = p + vec2(patDisp.x*aux.y - patDisp.y*aux.z, patDisp.y*aux.y + patDisp.x*aux.z) - winDisp;\n"
+"\n"
+"      bool randomized = (pctCoherent < 100.0) && (rnd(0u) * 100.0 >= pctCoherent);\n"
+"      if(dotLife != 0.0)\n"
+"      {\n"
+"         aux.x -= dotLifeDelta;\n"
+"         if(aux.x < 0.0) { aux.x = dotLife; randomized = true; }\n"
+"      }\n"
+"\n"
+"      if(randomized) p = randomDotPos();\n"
+"      else\n"
+"      {\n"
+"         vec2 o = 0.5 * outerDims;\n"
+"         if(abs(cand.x) > o.x)\n"
+"         {\n"
+"            float rem = mod(abs(cand.x) - o.x, o.x);\n"
+"            cand.x = (cand.x - p.x > 0.0) ? (rem - o.x) : (o.x - rem);\n"
+"            cand.y = rnd(1u) * outerDims.y - o.y;\n"
+"         }\n"
+"         else if(abs(cand.y) > o.y)\n"
+"         {\n"
+"            float rem = mod(abs(cand.y) - o.y, o.y);\n"
+"            cand.y = (cand.y - p.y > 0.0) ? (rem - o.y) : (o.y - rem);\n"
+"            cand.x = rnd(1u) * outerDims.x - o.x;\n"
+"         }\n"
+"         p = cand;\n"
+"      }\n"
+"   }\n"
+"   else if(mode == 2)\n"
+"      p = randomFlowPos();\n"
+"   else\n"
 "   {\n"
-"      p = gl_FragCoord.xy - ctr;\n"
-"      float frac = sin(TWOPI*(p.x*dx[0] + p.y*dy[0]) + phase[0]);\n"
-"      frac = when_neq(isSine, 0)*frac + when_eq(isSine, 0)*(2.0*smoothstep(-0.02, 0.02, frac) - 1.0);\n"
-"      color = mean0 * (1.0 + con0*frac);\n"
-"      if(nGrats > 1)\n"
+"      float r = length(p);\n"
+"      float th = atan(p.y, p.x);\n"
+"      r += flowB * sin(radians(r)) * cos(radians(r));\n"
+"      if(flowB < 0.0)\n"
 "      {\n"
-"         frac = sin(TWOPI*(p.x*dx[1] + p.y*dy[1]) + phase[1]);\n"
-"         frac = when_neq(isSine, 0)*frac + when_eq(isSine, 0)*(2.0*smoothstep(-0.02, 0.02, frac) - 1.0);\n"
-"         color += mean1 * (1.0 + con1*frac);\n"
+"         float band = innerDims.x + rnd(0u) * (outerDims.x - innerDims.x);\n"
+"         if(r < innerDims.x || (r < band && rnd(1u) <= flowRecycleRate))\n"
+"         {\n"
+"            th = radians(360.0 * rnd(2u));\n"
+"            r = outerDims.x - flowRecycleDR * rnd(3u);\n"
+"         }\n"
+"         p = r * vec2(cos(th), sin(th));\n"
 "      }\n"
-"      color = clamp(color, 0.0, 1.0);\n"
+"      else if(r < outerDims.x) p = r * vec2(cos(th), sin(th));\n"
+"      else p = randomFlowPos();\n"
 "   }\n"
 "\n"
-"    FragColor = vec4(when_eq(special, 1))*rgba + vec4(when_neq(special, 1))*vec4(color, alpha);\n"
+"   outPos = p;\n"
+"   outTexCoord = (mode < 2) ? vec2(dotAlpha(p), 1.0) : vec2(0.5, 0.5);\n"
+"   outAux = aux;\n"
 "}\0";
 
 
 const int CRMVRenderer::ALPHAMASKTEX = 1;
 const int CRMVRenderer::RGBAIMAGETEX = 2;
 const int CRMVRenderer::RGBIMAGETEX = 3;
+const int CRMVRenderer::YUVIMAGETEX = 4;
 
 const int CRMVRenderer::MAXTEXMASKDIM = 512;
 const int CRMVRenderer::MAXNUMVERTS = 50000;
@@ -251,20 +565,62 @@ const int CRMVRenderer::DEF_DISTTOEYE = 800;
 const int CRMVRenderer::DEF_WIDTH_PIX = 1024;
 const int CRMVRenderer::DEF_HEIGHT_PIX = 768;
 
+const int CRMVRenderer::MINPARALLELTGTS = 2;
+
+const int CRMVRenderer::GPUDOT_INITDOTS = 0;
+const int CRMVRenderer::GPUDOT_UPDATEDOTS = 1;
+const int CRMVRenderer::GPUDOT_INITFLOW = 2;
+const int CRMVRenderer::GPUDOT_UPDATEFLOW = 3;
+const char* CRMVRenderer::TELEMETRYFILE = "rmvtelemetry.csv";
+const double CRMVRenderer::LATCHMARGINUS = 1000.0;
+
 CRMVRenderer::CRMVRenderer()
 {
    m_pDisplay = NULL;
-   m_pShader = NULL;
+   for(int i=0; i<NUMTGTPROGS; i++) m_pShaders[i] = NULL;
+   m_iCurrProg = -1;
+   ::memset(m_tgtLoc, -1, NUMTGTPROGS * sizeof(TargetUniforms));
+   for(int i=0; i<NUMTGTPROGS; i++) m_currTgtC[i][0] = m_currTgtC[i][1] = m_currTgtC[i][2] = -1.0f;
+   for(int i=0; i<NUMTGTPROGS; i++) m_currEyeDx[i] = 0.0f;
+   m_bGPUDotsRequested = false;
+   m_idDotEngineProg = 0;
+   ::memset(&m_dotEngineLoc, 0, sizeof(DotEngineUniforms));
    m_NoOpAlphaMaskID = 0;
    m_pMaskTexels = NULL;
-   m_texPoolHead = NULL;
+   for(int i=0; i<TEXHASHSIZE; i++)
+   {
+      m_texClassTable[i] = NULL;
+      m_texIDTable[i] = NULL;
+   }
+   m_texLRUHead = m_texLRUTail = NULL;
    m_texPoolSize = 0;
    m_texPoolBytes = 0.0;
+   m_texPoolBudget = 5.0e7;
+   m_bTexPoolSettled = true;
+   m_bTexPoolRecordWarm = false;
+   m_nTexPoolHits = 0;
+   m_nTexPoolAllocs = 0;
+   m_nTexPoolEvictions = 0;
    m_idVAO = 0;
    m_idVBO = 0;
    m_idxVertexArrayFree = 0;
    m_currBoundTexID = 0;
 
+   m_bPipelined = false;
+   m_pMappedVBO = NULL;
+
+   m_bZeroCopyRequested = false;
+   m_bAnalyticApertures = false;
+   m_nMasksComputed = 0;
+   m_nMasksReused = 0;
+   m_pfnBufferStorage = NULL;
+
+   m_iStereoPassRequested = STEREO_TWOPASS;
+   m_iStereoPass = STEREO_TWOPASS;
+   m_idStereoTex = 0;
+   m_idStereoFBO = 0;
+   m_idStereoReadFBO[0] = m_idStereoReadFBO[1] = 0;
+
    m_dFramePeriod = 0;
 
    updateDisplayGeometry(DEF_WIDTH, DEF_HEIGHT, DEF_DISTTOEYE);
@@ -278,6 +634,18 @@ CRMVRenderer::CRMVRenderer()
 
    m_nTargets = 0;
    m_pTargetList = NULL;
+
+   m_pTgtVecs = NULL;
+   m_pTgtUpdateOK = NULL;
+   m_pOffGLTgts = NULL;
+   m_nOffGLTgts = 0;
+   m_fUpdateElapsedMS = 0.0f;
+   m_pTgtUpdateUS = NULL;
+   m_pLoadJobs = NULL;
+
+   m_bTelemetryExport = false;
+   m_bLateLatch = false;
+   m_nAnimSeqs = 0;
 }
 
 CRMVRenderer::~CRMVRenderer()
@@ -289,9 +657,9 @@ CRMVRenderer::~CRMVRenderer()
 /**
  Create all OpenGL resources required to do all target rendering in RMVideo:
 
- 1) Compile and load the single shader program that is used to do all rendering in RMVideo. The source code for the 
- shaders is defined in static strings VERTEXSHADERSRC and FRAGMENTSHADERSRC. Once loaded successfully, the shader 
- program is bound as the current program, since it never changes.
+ 1) Compile and load the target programs that are used to do all rendering in RMVideo, one per class of target. The
+ source code for the shaders is defined in static strings VERTEXSHADERSRC and FRAGMENTSHADERSRC; the fragment shader is
+ specialized for each program at compile time. See createTargetPrograms().
  2) Allocate buffer used to generate alpha mask textures and load them into GPU texture memory.
  3) Allocate the 50K vertex array/buffer that is used to transfer all vertex data (across all targets) to the vertex 
  shader during an RMVideo animation sequence. 
@@ -302,6 +670,16 @@ CRMVRenderer::~CRMVRenderer()
  which are likely to be used most frequently.
  6) Allocate a memory pool for per-dot parameter storage required by the random-dot target types. This will avoid 
  frequent memory allocations/deallocations associated with those targets. See CRMVTarget::createBufferPool().
+ 7) If requested, build the GPU dot engine's transform feedback program. Failure to do so is not fatal; the random-dot
+ targets are simply animated on the CPU.
+ 8) Launch the pool of worker threads that parallelizes the target update stage during an animation sequence. Failure
+ to do so is not fatal; the targets are simply updated serially on RMVideo's main thread. Like CVidBuffer's thread,
+ the worker threads persist until RMVideo exits.
+
+ Before the target programs are built, the single-pass stereo mode is selected if stereo is enabled and single-pass
+ rendering was requested: STEREO_LAYERED if the GL supports writing gl_Layer from the vertex shader, else 
+ STEREO_SIDEBYSIDE. The offscreen stereo framebuffer for that mode is created here; if that fails, RMVideo falls back to
+ the legacy two-pass stereo rendering.
 
  This method must be called during RMVideo startup, and RMVideo should exit on failure. Error messages are written to
  the console. It also must be called each time RMVideo's fullscreen window is re-created -- which happens on any video
@@ -313,7 +691,7 @@ CRMVRenderer::~CRMVRenderer()
 */
 bool CRMVRenderer::createResources(CRMVDisplay* pDsp)
 {
-   if(m_pShader != NULL) return(true);
+   if(m_pShaders[PROG_MASK] != NULL) return(true);
    if(pDsp == NULL) return(false);
    m_pDisplay = pDsp;
 
@@ -338,10 +716,39 @@ bool CRMVRenderer::createResources(CRMVDisplay* pDsp)
    }
    memset(m_pMaskTexels, 0, MAXTEXMASKDIM*MAXTEXMASKDIM*sizeof(GLubyte));
 
-   // compile and load our monolithic shader program
-   m_pShader = new Shader(CRMVRenderer::VERTEXSHADERSRC, CRMVRenderer::FRAGMENTSHADERSRC, false);
-   bool ok = m_pShader->isUsable();
-   if(!ok) fprintf(stderr, "ERROR(CRMVRenderer): Failed to create GLSL shader program\n");
+   // select the single-pass stereo mode, if requested, and create the offscreen framebuffer it requires. This must
+   // be done before building the target programs, which are specialized IAW the mode.
+   m_iStereoPass = STEREO_TWOPASS;
+   if(m_pDisplay->isStereoEnabled() && m_iStereoPassRequested != STEREO_TWOPASS)
+   {
+      if(m_iStereoPassRequested == STEREO_LAYERED && (m_pDisplay->checkGLExtension("GL_ARB_shader_viewport_layer_array")
+            || m_pDisplay->checkGLExtension("GL_AMD_vertex_shader_layer")))
+      {
+         m_iStereoPass = STEREO_LAYERED;
+         if(!createStereoFramebuffer()) m_iStereoPass = STEREO_TWOPASS;
+      }
+      if(m_iStereoPass == STEREO_TWOPASS)
+      {
+         m_iStereoPass = STEREO_SIDEBYSIDE;
+         if(!createStereoFramebuffer()) m_iStereoPass = STEREO_TWOPASS;
+      }
+
+      if(m_iStereoPass == STEREO_LAYERED) fprintf(stderr, "Single-pass stereo enabled (layered framebuffer).\n");
+      else if(m_iStereoPass == STEREO_SIDEBYSIDE) fprintf(stderr, "Single-pass stereo enabled (side-by-side).\n");
+      else fprintf(stderr, "WARNING(CRMVRenderer): Single-pass stereo unavailable; using two-pass stereo.\n");
+   }
+
+   // compile and load the target programs, one specialization of the RMVideo shader for each class of target. If
+   // the layered stereo specialization fails to build, fall back to the side-by-side variant.
+   bool ok = createTargetPrograms();
+   if(!ok && m_iStereoPass == STEREO_LAYERED)
+   {
+      fprintf(stderr, "WARNING(CRMVRenderer): Layered stereo shaders failed; trying side-by-side stereo.\n");
+      destroyStereoFramebuffer();
+      m_iStereoPass = STEREO_SIDEBYSIDE;
+      if(!createStereoFramebuffer()) m_iStereoPass = STEREO_TWOPASS;
+      ok = createTargetPrograms();
+   }
 
    // create and load the small "no-op" alpha mask texture assigned to all targets that are not an image or movie and
    // that do not need an alpha mask.
@@ -374,14 +781,34 @@ bool CRMVRenderer::createResources(CRMVDisplay* pDsp)
    // create memory pool used for per-dot parameter storage associated with the random-dot target types
    if(ok) ok = CRMVTarget::createBufferPool();
 
+   // if requested, build the GPU dot engine. If that fails, dot targets will be animated on the CPU.
+   if(ok && m_bGPUDotsRequested)
+   {
+      if(createDotEngineProgram()) fprintf(stderr, "GPU dot engine enabled for RMV_RANDOMDOTS and RMV_FLOWFIELD.\n");
+      else fprintf(stderr, "WARNING(CRMVRenderer): GPU dot engine unavailable; dot targets animated on CPU.\n");
+   }
+
+   // if requested, enable zero-copy movie mode. It requires persistently mapped buffers.
+   m_pfnBufferStorage = NULL;
+   if(ok && m_bZeroCopyRequested)
+   {
+      if(::atof((const char*) glGetString(GL_VERSION)) >= 4.4 || m_pDisplay->checkGLExtension("GL_ARB_buffer_storage"))
+         m_pfnBufferStorage = (PFNGLBUFFERSTORAGEPROC) m_pDisplay->getGLProcAddress("glBufferStorage");
+      if(m_pfnBufferStorage != NULL) fprintf(stderr, "Zero-copy movie frame streaming enabled.\n");
+      else fprintf(stderr, "WARNING(CRMVRenderer): Zero-copy movie mode unavailable; frames copied to PBOs.\n");
+   }
+
+   // launch the worker threads that parallelize the target update stage during animation (pool sized to # of cores)
+   if(ok && !m_workerPool.start(0))
+      ::fprintf(stderr, "WARNING(CRMVRenderer): Failed to start worker pool; targets will be updated serially.\n");
+
    // if successful, activate shader now and set the uniform variable that selects texture unit 0. We only use the
    // one shader, and we always use texture unit 0. Also bind the shared vertex array and buffer; since we use that
    // array buffer always, there's no need to bind/unbind repeatedly. Finally, we set the line width and polygon
    // drawing mode, enable blending, and set the blend function now, as these state parameters never change.
    if(ok) 
    {
-      m_pShader->use();
-      m_pShader->setInt("tex", 0);
+      selectTargetProgram(PROG_MASK);
       glActiveTexture(GL_TEXTURE0);
       bindTextureObject(m_NoOpAlphaMaskID);
       glBindVertexArray(m_idVAO);
@@ -392,6 +819,13 @@ bool CRMVRenderer::createResources(CRMVDisplay* pDsp)
       glEnable(GL_BLEND);
       glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+      // in side-by-side stereo mode, each eye's copy of a target is clipped to its half of the stereo framebuffer
+      if(m_iStereoPass == STEREO_SIDEBYSIDE)
+      {
+         glEnable(GL_CLIP_DISTANCE0);
+         glEnable(GL_CLIP_DISTANCE1);
+      }
+
       // set "clear color" to the current bkg color.
       glClearColor((float) m_bkgRGB[0], (float) m_bkgRGB[1], (float) m_bkgRGB[2], 0.0f);
 
@@ -421,6 +855,19 @@ void CRMVRenderer::releaseResources()
 
    destroyTexturePool();
 
+   destroyStereoFramebuffer();
+   glDisable(GL_CLIP_DISTANCE0);
+   glDisable(GL_CLIP_DISTANCE1);
+   m_iStereoPass = STEREO_TWOPASS;
+
+   if(m_pMappedVBO != NULL)
+   {
+      glBindBuffer(GL_ARRAY_BUFFER, m_idVBO);
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+      m_pMappedVBO = NULL;
+   }
+   m_pfnBufferStorage = NULL;
+
    glDisable(GL_BLEND);
    glBindBuffer(GL_ARRAY_BUFFER, 0);
    glBindVertexArray(0);
@@ -438,11 +885,17 @@ void CRMVRenderer::releaseResources()
    m_NoOpAlphaMaskID = 0;
 
    glUseProgram(0);
-   if(m_pShader != NULL)
+   if(m_idDotEngineProg != 0)
+   {
+      glDeleteProgram(m_idDotEngineProg);
+      m_idDotEngineProg = 0;
+   }
+   for(int i=0; i<NUMTGTPROGS; i++) if(m_pShaders[i] != NULL)
    {
-      delete m_pShader;
-      m_pShader = NULL;
+      delete m_pShaders[i];
+      m_pShaders[i] = NULL;
    }
+   m_iCurrProg = -1;
 
    if(m_pMaskTexels != NULL)
    {
@@ -490,6 +943,10 @@ int CRMVRenderer::reserveSharedVertexArraySegment(int n)
  identified by the 'start' and 'count' parameters should have been previously reserved by calling the method
  reserveSharedVertexArraySegment().
 
+ In pipelined mode, if the shared vertex buffer is persistently mapped, the data is simply copied into the mapped
+ buffer. No fence is needed: animate() calls glFinish() after every buffer swap, so the GPU is no longer reading from
+ the buffer by the time targets are updated for the next frame.
+
  @param start [in] The starting index within shared vertex array
  @param count [in] The number of vertices to upload.
  @param pSrc [in] Buffer containing the vertex attributes to be uploaded. There must be 4 float-valued attributes
@@ -498,7 +955,10 @@ int CRMVRenderer::reserveSharedVertexArraySegment(int n)
 void CRMVRenderer::uploadVertexData(int start, int count, float* pSrc)
 {
    if((pSrc == NULL) || (start < DOTSTOREINDEX) || (start + count > MAXNUMVERTS)) return;
-   glBufferSubData(GL_ARRAY_BUFFER, sizeof(float)*start*4, sizeof(float)*count*4, pSrc);
+   if(m_pMappedVBO != NULL)
+      ::memcpy(m_pMappedVBO + start*4, pSrc, sizeof(float)*count*4);
+   else
+      glBufferSubData(GL_ARRAY_BUFFER, sizeof(float)*start*4, sizeof(float)*count*4, pSrc);
 }
 
 /**
@@ -519,7 +979,9 @@ void CRMVRenderer::uploadVertexData(int start, int count, float* pSrc)
 
  To optimize texture memory use, CRMVRenderer maintains an OpenGL texture object pool. If the pool contains an already 
  allocated alpha mask texture object that meets or exceeds the required dimensions, that texture object will be 
- reused. Otherwise, a new alpha mask texture is allocated and added to the pool.
+ reused. Otherwise, a new alpha mask texture is allocated and added to the pool. Furthermore, each alpha mask texture in
+ the pool remembers the parameters of the mask it holds. If an unused texture already holds the requested mask -- as
+ is typical when the same targets are loaded trial after trial -- it is returned as is, without recomputing the mask.
 
  When the texture is no longer needed, callers must release it back to the texture pool by calling releaseTexture().
 
@@ -536,35 +998,44 @@ void CRMVRenderer::uploadVertexData(int start, int count, float* pSrc)
  found that the OGL 1.1 implementation was superior, possibly because that implementation enforces power-of-2 texture
  dimensions not to exceed 512. Decided to do the same here.
 
+ NOTE 4: Since the monolithic shader was replaced by specialized target programs, the aperture and Gaussian window can
+ be computed per fragment without burdening any other target. In analytic aperture mode (setAnalyticApertureMode()),
+ targets do not use this method at all; see updateWindowUniforms().
+
  @param aperture Aperture type. If not a supported type, RMV_RECT is assumed.
  @param w,h The width and height of target window in logical coordinates (visual deg subtended at eye).
  @param iw,ih The width and height of the target hole for an annular aperture (visual deg subtended at eye). Both must
  be nonzero if aperture is RMV_RECTANNU or _OVALANNU.
  @param sigX,sigY The horizontal and vertical standard deviations of the 2D Gaussian blur applied to the target window.
  If both are zero, no blur is applied.
+ @param pTexels If not NULL, the alpha mask as already computed by precomputeAlphaMask() for the same parameters; it is
+ used instead of computing the mask here. Default = NULL.
  @return If successful, the texture object's assigned OpenGL ID; else, 0. In the event of failure, a brief error 
  description is logged to the console window. Note that 0 is also returned if the aperture is RMV_RECT and 
  sigX=sigY=0 -- since no alpha mask is needed in this case.
 */
 unsigned int CRMVRenderer::prepareAlphaMaskTexture(
-   int aperture, double w, double h, double iw, double ih, double sigX, double sigY)
+   int aperture, double w, double h, double iw, double ih, double sigX, double sigY, const unsigned char* pTexels)
 {
    // if no alpha mask needed, there's nothing to do!
    if(aperture==RMV_RECT && sigX <= 0 && sigY <= 0) return((unsigned int) 0);
 
-   // compute texture dimensions in pixels. For better performance, we restrict each dimension to a power of 2 not to 
-   // exceed MAXTEXMASKDIM
-   int texWPix = 8, texHPix = 8;
-
-   while(texWPix < (int)(w/m_dspGeom.degPerPixelX)) texWPix *= 2;
-   if(texWPix > MAXTEXMASKDIM) texWPix = MAXTEXMASKDIM;
-
-   while(texHPix < (int)(h/m_dspGeom.degPerPixelY)) texHPix *= 2;
-   if(texHPix > MAXTEXMASKDIM) texHPix = MAXTEXMASKDIM;
+   // if an unused alpha mask texture in the pool already holds the very same mask, reuse it as is
+   int texWPix = 0, texHPix = 0;
+   getAlphaMaskDims(w, h, texWPix, texHPix);
+   float key[7] = {(float) aperture, (float) w, (float) h, (float) iw, (float) ih, (float) sigX, (float) sigY};
+   TexNode* pNode = findPooledAlphaMask(key, texWPix, texHPix);
+   if(pNode != NULL)
+   {
+      claimTextureNode(pNode);
+      ++m_nTexPoolHits;
+      ++m_nMasksReused;
+      return(pNode->id);
+   }
 
    // get an available alpha max texture object from the texture pool that is large enough to accommodate the
    // desired texture dimensions, allocating a new texture if necessary
-   TexNode* pNode = getTextureNodeFromPool(ALPHAMASKTEX, texWPix, texHPix);
+   pNode = getTextureNodeFromPool(ALPHAMASKTEX, texWPix, texHPix);
    if(pNode == NULL)
    {
       fprintf(stderr, "ERROR(CRMVRenderer): Insufficient texture memory available for %dx%d alpha mask\n", 
@@ -572,7 +1043,94 @@ unsigned int CRMVRenderer::prepareAlphaMaskTexture(
       return((unsigned int) 0);
    }
 
-   // compute the alpha mask texture and store in local array
+   // compute the alpha mask texture and store in local array, unless it was precomputed
+   if(pTexels == NULL)
+   {
+      computeAlphaMask(aperture, w, h, iw, ih, sigX, sigY, texWPix, texHPix, m_pMaskTexels);
+      pTexels = m_pMaskTexels;
+   }
+
+   // load the mask texture [NOTE: Use glTexSubImage2D() because texture is already allocated!]
+   bindTextureObject(pNode->id);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texWPix, texHPix, GL_RED, GL_UNSIGNED_BYTE, (const GLvoid*)pTexels);
+   bindTextureObject(m_NoOpAlphaMaskID);
+   ::memcpy(pNode->maskKey, key, sizeof(key));
+   ++m_nMasksComputed;
+   return(pNode->id);
+}
+
+/**
+ Compute the alpha mask that prepareAlphaMaskTexture() would load into an alpha mask texture for the specified target
+ window, aperture and Gaussian blur. This method makes no GL calls and does not modify the renderer, so it may be called
+ on a worker thread while loadTargets() prepares targets in parallel -- as long as the GL thread is not loading any
+ texture in the meantime. The mask is not computed if an unused texture in the texture pool already holds it.
+
+ @param aperture, w, h, iw, ih, sigX, sigY See prepareAlphaMaskTexture().
+ @return A buffer holding the computed alpha mask, to be passed to prepareAlphaMaskTexture() for the same parameters.
+ The caller must release it with free(). Returns NULL if no alpha mask is needed, if the mask is already available in
+ the texture pool, or if memory allocation failed -- in which case prepareAlphaMaskTexture() computes it as needed.
+*/
+unsigned char* CRMVRenderer::precomputeAlphaMask(
+   int aperture, double w, double h, double iw, double ih, double sigX, double sigY)
+{
+   if(aperture==RMV_RECT && sigX <= 0 && sigY <= 0) return(NULL);
+
+   int texWPix = 0, texHPix = 0;
+   getAlphaMaskDims(w, h, texWPix, texHPix);
+   float key[7] = {(float) aperture, (float) w, (float) h, (float) iw, (float) ih, (float) sigX, (float) sigY};
+   if(findPooledAlphaMask(key, texWPix, texHPix) != NULL) return(NULL);
+
+   unsigned char* pTexels = (unsigned char*) ::malloc(texWPix * texHPix);
+   if(pTexels != NULL) computeAlphaMask(aperture, w, h, iw, ih, sigX, sigY, texWPix, texHPix, pTexels);
+   return(pTexels);
+}
+
+/**
+ Compute the dimensions of the alpha mask texture for a target window of the specified size. For better performance,
+ each dimension is restricted to a power of 2 not to exceed MAXTEXMASKDIM.
+
+ @param w,h The width and height of target window in logical coordinates (visual deg subtended at eye).
+ @param texWPix, texHPix [out] The texture width and height in pixels.
+*/
+void CRMVRenderer::getAlphaMaskDims(double w, double h, int& texWPix, int& texHPix)
+{
+   texWPix = 8;
+   texHPix = 8;
+
+   while(texWPix < (int)(w/m_dspGeom.degPerPixelX)) texWPix *= 2;
+   if(texWPix > MAXTEXMASKDIM) texWPix = MAXTEXMASKDIM;
+
+   while(texHPix < (int)(h/m_dspGeom.degPerPixelY)) texHPix *= 2;
+   if(texHPix > MAXTEXMASKDIM) texHPix = MAXTEXMASKDIM;
+}
+
+/**
+ Find an unused alpha mask texture in the texture pool that already holds the specified mask.
+ @param key The mask parameters {aperture, w, h, iw, ih, sigX, sigY}.
+ @param texWPix, texHPix The texture dimensions, as computed by getAlphaMaskDims().
+ @return The texture pool node, or NULL if there is none.
+*/
+CRMVRenderer::TexNode* CRMVRenderer::findPooledAlphaMask(const float* key, int texWPix, int texHPix)
+{
+   TexClass* pClass = getTextureClass(ALPHAMASKTEX, texWPix, texHPix, false);
+   TexNode* pNode = (pClass != NULL) ? pClass->pFreeHead : NULL;
+   while(pNode != NULL && ::memcmp(pNode->maskKey, key, 7*sizeof(float)) != 0) pNode = pNode->pNextFree;
+   return(pNode);
+}
+
+/**
+ Compute an alpha mask for the specified target window, aperture and Gaussian blur. The mask covers the target window,
+ filling the texel array from bottom-left to top-right. Near an elliptical aperture boundary, each texel is averaged
+ over 5 sample points for a little antialiasing.
+
+ @param aperture, w, h, iw, ih, sigX, sigY See prepareAlphaMaskTexture().
+ @param texWPix, texHPix The mask dimensions in texels.
+ @param pTexels [out] The computed mask. Must have room for texWPix*texHPix texels.
+*/
+void CRMVRenderer::computeAlphaMask(int aperture, double w, double h, double iw, double ih, double sigX, double sigY, 
+      int texWPix, int texHPix, unsigned char* pTexels)
+{
    // the texture array fills from BL->TR, and it is assumed coord system has origin at target center!
    double x = -double(w) / 2.0;
    double y = -double(h) / 2.0;
@@ -650,18 +1208,11 @@ unsigned int CRMVRenderer::prepareAlphaMaskTexture(
          // computation of Gaussian fcn, if necessary
          if(dValue > 0.0 && doGauss) dValue *= exp(x*x*dInvTwoSigSqX + y * y*dInvTwoSigSqY);
 
-         m_pMaskTexels[k + i] = (GLubyte)cMath::rangeLimit(dValue * 255.0 + 0.5, 0.0, 255.0);
+         pTexels[k + i] = (GLubyte)cMath::rangeLimit(dValue * 255.0 + 0.5, 0.0, 255.0);
          x += dXIncr;
       }
       y += dYIncr;
    }
-
-   // load the mask texture [NOTE: Use glTexSubImage2D() because texture is already allocated!]
-   bindTextureObject(pNode->id);
-   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-   glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texWPix, texHPix, GL_RED, GL_UNSIGNED_BYTE, (GLvoid*)m_pMaskTexels);
-   bindTextureObject(m_NoOpAlphaMaskID);
-   return(pNode->id);
 }
 
 /**
@@ -670,13 +1221,26 @@ unsigned int CRMVRenderer::prepareAlphaMaskTexture(
  @param file Name of image source file.
  @param width [out] On successful return, contains image width in pixels; else, 0.
  @param height [out] On successful return, contains image height in pixels; else, 0.
+ @param bPin If set, the image is pinned in the media store's image cache until unpinImage() is called, so the buffer
+ remains valid while other threads retrieve images. Default = false.
  @return A pointer to the image data buffer. Returns NULL on failure, in which case a very brief error description is 
- printed to stderr. DO NOT free() the buffer, nor maintain a reference to it!
+ printed to stderr. DO NOT free() the buffer, nor maintain a reference to it (unless the image is pinned)!
 */
-unsigned char* CRMVRenderer::getImage(const char* folder, const char* file, int& w, int& h)
+unsigned char* CRMVRenderer::getImage(const char* folder, const char* file, int& w, int& h, bool bPin)
 {
    CRMVMediaMgr* pMgr = (m_pDisplay==NULL) ? NULL : m_pDisplay->getMediaStoreManager();
-   return((pMgr==NULL) ? NULL : pMgr->getImage(folder, file, w, h));
+   return((pMgr==NULL) ? NULL : pMgr->getImage(folder, file, w, h, bPin));
+}
+
+/**
+ Release a pin on an image previously retrieved and pinned by getImage().
+ @param folder Name of media folder containing image source file.
+ @param file Name of image source file.
+*/
+void CRMVRenderer::unpinImage(const char* folder, const char* file)
+{
+   CRMVMediaMgr* pMgr = (m_pDisplay==NULL) ? NULL : m_pDisplay->getMediaStoreManager();
+   if(pMgr != NULL) pMgr->unpinImage(folder, file);
 }
 
 /**
@@ -728,6 +1292,36 @@ unsigned int CRMVRenderer::prepareImageTexture(bool rgba, int w, int h, unsigned
    return(pNode->id);
 }
 
+/**
+ Utility method prepares a single-component texture object to hold a movie frame in planar YUV 4:2:0 format. For a
+ W x H frame, the chroma planes are CW x CH, where CW = ceil(W/2) and CH = ceil(H/2). The texture is 2*CW wide and
+ H + CH high: the Y plane occupies the first H rows, and the U and V planes lie side by side in the remaining CH rows.
+ The fragment shader converts the frame to RGB; see updateYUVFrameUniforms().
+
+ Like the other image textures, the texture object is obtained from the renderer's texture pool and must be released
+ by calling releaseTexture() when no longer needed.
+
+ @param w,h Frame width and height in pixels.
+ @return If successful, the texture object's assigned OpenGL ID; else, 0. In the event of failure, a brief error 
+ description is logged to the console window.
+*/
+unsigned int CRMVRenderer::prepareYUVFrameTexture(int w, int h)
+{
+   if(w <= 0 || h <= 0) 
+   {
+      fprintf(stderr, "ERROR(CRMVRenderer): Cannot allocate YUV frame texture with zero width or height!\n");
+      return((unsigned int) 0);
+   }
+
+   TexNode* pNode = getTextureNodeFromPool(YUVIMAGETEX, 2*((w+1)/2), h + (h+1)/2);
+   if(pNode == NULL)
+   {
+      fprintf(stderr, "ERROR(CRMVRenderer): Insufficient texture memory available for %dx%d YUV frame\n", w, h);
+      return((unsigned int) 0);
+   }
+   return(pNode->id);
+}
+
 /**
  Upload a movie frame to the specified OpenGL texture object.
 
@@ -736,15 +1330,79 @@ unsigned int CRMVRenderer::prepareImageTexture(bool rgba, int w, int h, unsigned
 
  @param texID [in] The OpenGL ID of the texture object to which movie frame is to be uploaded.
  @param w,h [in] Frame dimensions in pixels.
- @param pFrame [in] Frame data buffer. Data is expected to be store in GL_RGB format, with 8 bits per color. Use 
- pFrame = NULL to upload frame data from the currently bound pixel buffer.
- component.
+ @param pFrame [in] Frame data buffer. Data is expected to be store in GL_RGB format, with 8 bits per color 
+ component -- or in planar YUV 4:2:0 format if isYUV is set (see CVidBuffer::isVideoYUV()). Use pFrame = NULL to 
+ upload frame data from the currently bound pixel buffer.
+ @param isYUV [in] If set, the frame is in YUV 4:2:0 format, and the texture was prepared by prepareYUVFrameTexture().
 */
-void CRMVRenderer::uploadMovieFrameToTexture(unsigned int texID, int w, int h, unsigned char* pFrame)
+void CRMVRenderer::uploadMovieFrameToTexture(unsigned int texID, int w, int h, unsigned char* pFrame, bool isYUV)
 {
    bindTextureObject(texID);
    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-   glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, (GLvoid*) pFrame);
+   if(!isYUV)
+   {
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, (GLvoid*) pFrame);
+      return;
+   }
+
+   // the three planes are uploaded separately. When uploading from a PBO, pFrame is an offset into the buffer.
+   int cw = (w+1)/2;
+   int ch = (h+1)/2;
+   size_t base = (size_t) pFrame;
+   glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RED, GL_UNSIGNED_BYTE, (GLvoid*) base);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, 0, h, cw, ch, GL_RED, GL_UNSIGNED_BYTE, (GLvoid*) (base + w*h));
+   glTexSubImage2D(GL_TEXTURE_2D, 0, cw, h, cw, ch, GL_RED, GL_UNSIGNED_BYTE, (GLvoid*) (base + w*h + cw*ch));
+}
+
+/**
+ Create a pixel buffer object to hold the entire frame queue of an RMV_MOVIE target in zero-copy movie mode. The 
+ buffer is allocated as immutable storage and persistently mapped for writing, with coherent mapping, so that the 
+ video streamer's worker thread can decode frames directly into it while the GL thread uploads other frames from it.
+
+ It is the caller's responsibility to ensure that a region of the buffer is not overwritten while the GPU may still be
+ reading from it. Note that, during an animation sequence, the GPU has consumed all commands issued for a display 
+ frame by the time animate() begins updating targets for the next frame (it calls glFinish() after each buffer swap).
+
+ The PBO is left unbound. Release it by calling releaseMovieFrameStore(). 
+
+ @param nBytes [in] The buffer size in bytes.
+ @param ppMapped [out] The persistently mapped address of the buffer. Set to NULL on failure.
+ @return The PBO's GL ID, or 0 if zero-copy movie mode is not enabled or the PBO could not be created or mapped.
+*/
+unsigned int CRMVRenderer::createMovieFrameStore(int nBytes, unsigned char** ppMapped)
+{
+   *ppMapped = NULL;
+   if(m_pfnBufferStorage == NULL || nBytes <= 0) return(0);
+
+   unsigned int pboID = 0;
+   glGenBuffers(1, &pboID);
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pboID);
+   GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+   (*m_pfnBufferStorage)(GL_PIXEL_UNPACK_BUFFER, nBytes, NULL, flags);
+   if(glGetError() == GL_NO_ERROR) 
+      *ppMapped = (unsigned char*) glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, nBytes, flags);
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+   if(*ppMapped == NULL)
+   {
+      fprintf(stderr, "ERROR(CRMVRenderer): Failed to create persistently mapped frame store (%d bytes)\n", nBytes);
+      glDeleteBuffers(1, &pboID);
+      pboID = 0;
+   }
+   return(pboID);
+}
+
+/**
+ Release a pixel buffer object previously created by createMovieFrameStore(). The buffer is unmapped and deleted.
+ @param pboID The PBO's GL ID. No action taken if 0.
+*/
+void CRMVRenderer::releaseMovieFrameStore(unsigned int pboID)
+{
+   if(pboID == 0) return;
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pboID);
+   glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+   glDeleteBuffers(1, &pboID);
 }
 
 /**
@@ -754,16 +1412,26 @@ void CRMVRenderer::uploadMovieFrameToTexture(unsigned int texID, int w, int h, u
 */
 void CRMVRenderer::releaseTexture(unsigned int texID)
 {
-   TexNode* pCurr = m_texPoolHead;
-   while(pCurr != NULL )
-   { 
-      if(pCurr->id==texID)
-      {
-         pCurr->inUse = false;
-         return;
-      }
-      pCurr = pCurr->pNext;
-   }
+   TexNode* pNode = m_texIDTable[texID % TEXHASHSIZE];
+   while(pNode != NULL && pNode->id != texID) pNode = pNode->pNextByID;
+   if(pNode == NULL || !pNode->inUse) return;
+
+   // the released texture becomes the most recently released one, both in its size class and in the pool
+   pNode->inUse = false;
+   TexClass* pClass = pNode->pClass;
+   pNode->pPrevFree = NULL;
+   pNode->pNextFree = pClass->pFreeHead;
+   if(pClass->pFreeHead != NULL) pClass->pFreeHead->pPrevFree = pNode;
+   else pClass->pFreeTail = pNode;
+   pClass->pFreeHead = pNode;
+
+   pNode->pNewer = NULL;
+   pNode->pOlder = m_texLRUHead;
+   if(m_texLRUHead != NULL) m_texLRUHead->pNewer = pNode;
+   else m_texLRUTail = pNode;
+   m_texLRUHead = pNode;
+
+   m_bTexPoolSettled = false;
 }
 
 /** 
@@ -805,7 +1473,7 @@ bool CRMVRenderer::measureFramePeriod(int nomRateHz)
    double tInitFP = 0, tLast = 0;
    int nSkips = 0;
 
-   if(!m_pDisplay->isStereoEnabled())
+   if(!m_pDisplay->hasStereoBuffers())
    {
       // need to do this to get in synch with display's refresh cycle, so we can start our timer at the beginning of a
       // refresh period. NOTE, however, that our measurement could be an overestimate if there's a delay out of the
@@ -1044,7 +1712,7 @@ void CRMVRenderer::updateSyncFlashParams(int sz, int dur)
  enabled, the spot patch is always black in the idle state regardless the background color, so the background must
  also be redrawn whenever the sync spot size changes or the display geometry changes (which can effect spot size).
 
- In stereo mode, both L and R backbuffers are cleared to the current background color.
+ In stereo mode, both L and R backbuffers are cleared to the current background color. See renderFrame().
 
  Since the method waits for the next vertical retrace before swapping buffers, it can take as much as one full video
  refresh period to execute.
@@ -1053,23 +1721,8 @@ void CRMVRenderer::redrawIdleBackground()
 {
    if(m_pDisplay == NULL) return;
 
-   if(!m_pDisplay->isStereoEnabled())
-   {
-      glClearColor((float)m_bkgRGB[0], (float)m_bkgRGB[1], (float)m_bkgRGB[2], 0.0f);
-      glClear(GL_COLOR_BUFFER_BIT);
-      drawSyncFlashSpot();
-   }
-   else
-   {
-      glDrawBuffer(GL_BACK_LEFT);
-      glClearColor((float)m_bkgRGB[0], (float)m_bkgRGB[1], (float)m_bkgRGB[2], 0.0f);
-      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-      drawSyncFlashSpot();
-      glDrawBuffer(GL_BACK_RIGHT);
-      glClearColor((float)m_bkgRGB[0], (float)m_bkgRGB[1], (float)m_bkgRGB[2], 0.0f);
-      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-      drawSyncFlashSpot();
-   }
+   glClearColor((float)m_bkgRGB[0], (float)m_bkgRGB[1], (float)m_bkgRGB[2], 0.0f);
+   renderFrame(false);
 
    m_pDisplay->swap();
    glFinish();  // stalls here waiting for vertical blanking interval
@@ -1090,6 +1743,17 @@ void CRMVRenderer::redrawIdleBackground()
  are executed. This will effectively clear the backbuffer, so any "drawing" done during target inits will be erased,
  and the backbuffer is returned to a known state.
 
+ Targets are loaded in three stages. First, all target definitions are retrieved from the IO link and the target 
+ objects are created. Second, the CPU-side preparation of each target (CRMVTarget::prepare()) -- decoding a source 
+ image, opening a video stream and pre-rolling it to the start frame, computing an alpha mask, generating the initial
+ dot pattern -- is farmed out to the worker pool, with the GL thread pitching in while it waits. These are by far the
+ most costly steps, and they are independent of each other. Finally, on the GL thread and in target order, each 
+ target's OpenGL resources are allocated and loaded (CRMVTarget::completeInitialization()). If the worker pool is not
+ running, or there is only one target, the preparation stage runs on the GL thread.
+
+ When telemetry export is enabled, the overall load latency is reported, along with the duration of the preparation and
+ GL stages for each target.
+
  @return True if all defined targets were successfully created and initialized; false otherwise.
 */
 bool CRMVRenderer::loadTargets()
@@ -1098,6 +1762,13 @@ bool CRMVRenderer::loadTargets()
 
    // make sure target list is empty
    unloadTargets();
+   CElapsedTime loadTime;
+   m_nMasksComputed = m_nMasksReused = 0;
+
+   // while loading, record the textures needed by this target list so the texture pool can be pre-warmed for the next
+   for(int i=0; i<TEXHASHSIZE; i++)
+      for(TexClass* pClass = m_texClassTable[i]; pClass != NULL; pClass = pClass->pNext) pClass->nWarm = 0;
+   m_bTexPoolRecordWarm = true;
 
    // get number of targets defined
    m_nTargets = m_pDisplay->getIOLink()->getNumTargets();
@@ -1112,36 +1783,131 @@ bool CRMVRenderer::loadTargets()
    }
    for(int i=0; i<m_nTargets; i++) m_pTargetList[i] = NULL;
 
-   // retrieve each target's defining parameters and create it
+   // allocate per-target storage for motion vectors, update results and update costs, and the list of targets that
+   // can be updated on a worker thread during animation
+   m_pTgtVecs = (RMVTGTVEC*) ::calloc(m_nTargets, sizeof(RMVTGTVEC));
+   m_pTgtUpdateOK = (bool*) ::calloc(m_nTargets, sizeof(bool));
+   m_pOffGLTgts = (int*) ::calloc(m_nTargets, sizeof(int));
+   m_nOffGLTgts = 0;
+   m_pTgtUpdateUS = (float*) ::calloc(m_nTargets, sizeof(float));
+   m_pLoadJobs = (TgtLoadJob*) ::calloc(m_nTargets, sizeof(TgtLoadJob));
+   if(m_pTgtVecs == NULL || m_pTgtUpdateOK == NULL || m_pOffGLTgts == NULL || m_pTgtUpdateUS == NULL || 
+         m_pLoadJobs == NULL)
+   {
+      fprintf(stderr, "ERROR(CRMVRenderer): Memory allocation failed. Cannot create target list.\n");
+      unloadTargets();
+      return(false);
+   }
+
+   // stage 1: retrieve each target's defining parameters and create it. The IO link is accessed on this thread only.
    bool bOk = true;
-   RMVTGTDEF tgtDef;
    for(int i=0; bOk && (i<m_nTargets); i++)
    {
-      ::memset( &tgtDef, 0, sizeof(RMVTGTDEF) );
-      bOk = m_pDisplay->getIOLink()->getTarget(i, tgtDef);
+      bOk = m_pDisplay->getIOLink()->getTarget(i, m_pLoadJobs[i].tgtDef);
       if(bOk)
       {
          m_pTargetList[i] = new CRMVTarget();
          bOk = (m_pTargetList[i] != NULL);
          if(!bOk) fprintf(stderr, "ERROR(CRMVRenderer): Memory allocation failed. Unable to create target object.\n");
-         else bOk = m_pTargetList[i]->initialize(this, tgtDef);
       }
       else fprintf(stderr, "ERROR(CRMVRenderer): Failed to retrieve target definition from RMVideo IO link.\n");
    }
 
-   // redraw idle background, forcing execution of any GL commands issued during target initializations. Since 
-   // backbuffer is cleared, any drawing that happened in target inits gets erased. See comments in method header.;
+   // stage 2: prepare all targets, in parallel on the worker pool if possible
+   bool bParallel = m_workerPool.isRunning() && (m_nTargets > 1);
+   CElapsedTime stageTime;
+   if(bOk)
+   {
+      if(bParallel)
+      {
+         m_workerPool.dispatch(CRMVRenderer::prepareTargetJob, this, m_nTargets);
+         m_workerPool.waitForCompletion();
+      }
+      else for(int i=0; i<m_nTargets; i++) CRMVRenderer::prepareTargetJob(this, i);
+
+      for(int i=0; bOk && i<m_nTargets; i++) bOk = m_pLoadJobs[i].bOk;
+   }
+   double tPrepare = stageTime.getAndReset();
+
+   // stage 3: allocate and load each target's GL resources, in target order
+   for(int i=0; bOk && (i<m_nTargets); i++)
+   {
+      CElapsedTime tGL;
+      bOk = m_pTargetList[i]->completeInitialization();
+      m_pLoadJobs[i].glUS = float(tGL.get() * 1.0e6);
+      if(bOk && m_pTargetList[i]->canUpdateOffGLThread()) m_pOffGLTgts[m_nOffGLTgts++] = i;
+   }
+
+   // redraw idle background, forcing execution of any GL commands issued during target inits. Since backbuffer is
+   // cleared, any drawing that happened in target inits gets erased. See comments in method header.
    redrawIdleBackground();
+   double tGLStage = stageTime.get();
+   m_bTexPoolRecordWarm = false;
+   m_bTexPoolSettled = false;
+
+   // when exporting telemetry, also report the target load latency (from command receipt to idle background redrawn),
+   // broken down by stage and by target
+   if(bOk && m_bTelemetryExport)
+   {
+      fprintf(stderr, "Loaded %d targets in %.2f ms (alpha masks: %d computed, %d reused%s).\n", m_nTargets, 
+            loadTime.get() * 1000.0, m_nMasksComputed, m_nMasksReused, m_bAnalyticApertures ? "; analytic" : "");
+      fprintf(stderr, "   prepare stage %.2f ms (%s), GL stage %.2f ms\n", tPrepare * 1000.0, 
+            bParallel ? "parallel" : "serial", tGLStage * 1000.0);
+      for(int i=0; i<m_nTargets; i++)
+         fprintf(stderr, "   target %d (type %d): prepare %.2f ms, GL %.2f ms\n", i, m_pLoadJobs[i].tgtDef.iType, 
+               m_pLoadJobs[i].prepUS / 1000.0, m_pLoadJobs[i].glUS / 1000.0);
+      fprintf(stderr, "   texture pool: %d textures, %.1f of %.1f MB; %d hits, %d allocations, %d evictions\n", 
+            m_texPoolSize, m_texPoolBytes / 1048576.0, m_texPoolBudget / 1048576.0, m_nTexPoolHits, 
+            m_nTexPoolAllocs, m_nTexPoolEvictions);
+   }
 
-   // clear target list if we failed
+   // the load job list is no longer needed; clear target list if we failed
+   ::free(m_pLoadJobs);
+   m_pLoadJobs = NULL;
    if(!bOk) unloadTargets();
 
    return(bOk);
 }
 
+/**
+ Job function for the worker pool, invoked by loadTargets(). It does the CPU-side preparation of the specified target,
+ recording the outcome and the time it took.
+
+ @param pArg The renderer object.
+ @param iJob Index of the target in the target list.
+*/
+void CRMVRenderer::prepareTargetJob(void* pArg, int iJob)
+{
+   CRMVRenderer* pThis = (CRMVRenderer*) pArg;
+   TgtLoadJob* pJob = &(pThis->m_pLoadJobs[iJob]);
+   CElapsedTime tPrep;
+   pJob->bOk = pThis->m_pTargetList[iJob]->prepare(pThis, pJob->tgtDef);
+   pJob->prepUS = float(tPrep.get() * 1.0e6);
+}
+
+/**
+ Summarize the frame-timing telemetry for the most recent animation sequence, and report texture pool statistics, IAW
+ the reply format specified for RMV_CMD_GETFRAMESTATS. The texture pool counters are cumulative since startup.
+
+ @param pStats [out] Must have room for RMV_FRAMESTATS_LEN integers.
+*/
+void CRMVRenderer::getFrameStats(int* pStats)
+{
+   m_telemetry.getSummary(pStats);
+   pStats[RMV_FRAMESTATS_TEXHITS] = m_nTexPoolHits;
+   pStats[RMV_FRAMESTATS_TEXALLOCS] = m_nTexPoolAllocs;
+   pStats[RMV_FRAMESTATS_TEXEVICTS] = m_nTexPoolEvictions;
+   pStats[RMV_FRAMESTATS_TEXCOUNT] = m_texPoolSize;
+   pStats[RMV_FRAMESTATS_TEXKB] = int(m_texPoolBytes / 1024.0 + 0.5);
+   pStats[RMV_FRAMESTATS_TEXBUDGETKB] = int(m_texPoolBudget / 1024.0 + 0.5);
+}
+
 /** Empty the animated target list prepared for a previous animation sequence.  All target objects destroyed. */
 void CRMVRenderer::unloadTargets()
 {
+   // in zero-copy movie mode, a movie target's frame store is in use while its video stream is buffered
+   m_vidBuffer.stopBuffering();
+
    if(m_nTargets > 0)
    {
       if(m_pTargetList != NULL)
@@ -1159,6 +1925,13 @@ void CRMVRenderer::unloadTargets()
       m_nTargets = 0;
    }
 
+   if(m_pTgtVecs != NULL) { ::free(m_pTgtVecs); m_pTgtVecs = NULL; }
+   if(m_pTgtUpdateOK != NULL) { ::free(m_pTgtUpdateOK); m_pTgtUpdateOK = NULL; }
+   if(m_pOffGLTgts != NULL) { ::free(m_pOffGLTgts); m_pOffGLTgts = NULL; }
+   m_nOffGLTgts = 0;
+   if(m_pTgtUpdateUS != NULL) { ::free(m_pTgtUpdateUS); m_pTgtUpdateUS = NULL; }
+   if(m_pLoadJobs != NULL) { ::free(m_pLoadJobs); m_pLoadJobs = NULL; }
+
    // since there are no targets, then reset the free space index for the shared vertex array
    m_idxVertexArrayFree = DOTSTOREINDEX;
 
@@ -1227,6 +2000,13 @@ void CRMVRenderer::unloadTargets()
  fact, none had occurred. To address this issue, we now recalculate the refresh period as needed over the course of the
  animation sequence.
 
+ 16oct2026: In late-latch mode, if the next UPDATEFRAME has not arrived when we look for it just after the buffer swap,
+ we do not immediately declare a missed update. Instead, we wait on the IO link until the "latch deadline": the start
+ of the current frame, plus the refresh period, less 1.5x a decaying peak estimate of the cost of updating and drawing a
+ frame, less a safety margin (LATCHMARGINUS). If the update arrives by then, the next frame can still be rendered in
+ time. Otherwise, the frame is repeated as before. Updates are never discarded, even if several are queued, because
+ each UPDATEFRAME carries the displacements for one frame only; skipping one would corrupt target trajectories.
+
 @return 1 if returning to idle state, 0 if ending command session because RMV_CMD_SHUTTINGDN was received or because the 
 RMVideo-Maestro IO link failed, -1 if exiting RMVideo because RMV_CMD_EXIT was received.
 */
@@ -1241,13 +2021,7 @@ int CRMVRenderer::animate()
 
    // update targets IAW frame 0 motion vectors. If something goes wrong, report error in response to STARTANIMATE
    // and immediately return to idle state.
-   RMVTGTVEC tgtVec;
-   bool bOk = true;
-   for(int i=0; i<m_nTargets && bOk; i++)
-   {
-      bOk = m_pDisplay->getIOLink()->getMotionVector(i, tgtVec);
-      if(bOk) bOk = m_pTargetList[i]->updateMotion(0, &tgtVec);
-   }
+   bool bOk = updateTargets(0);
    if(!bOk)
    {
       m_pDisplay->getIOLink()->sendSignal(RMV_SIG_CMDERR);
@@ -1284,59 +2058,21 @@ int CRMVRenderer::animate()
    // at this point, we don't know where we are in monitor's refresh cycle. To get sync'd up, we twice clear the back
    // buffer to the current background color and swap. With VSync ON, the glFinish() after the buffer swap should 
    // provide the synchronization. Since the render is simple, hopefully we get close to the start of a refresh cycle.
-   if(!m_pDisplay->isStereoEnabled())
-   {
-      glClearColor((float)m_bkgRGB[0], (float)m_bkgRGB[1], (float)m_bkgRGB[2], 0.0f);
-      glClear(GL_COLOR_BUFFER_BIT);
-      drawSyncFlashSpot();
-      m_pDisplay->swap();
-      glFinish();
-      elapsedTime.reset();
+   // (In legacy two-pass stereo mode, both L and R backbuffers are drawn once; the second swap just exchanges them.)
+   glClearColor((float)m_bkgRGB[0], (float)m_bkgRGB[1], (float)m_bkgRGB[2], 0.0f);
+   renderFrame(false);
+   m_pDisplay->swap();
+   glFinish();
+   elapsedTime.reset();
 
-      glClear(GL_COLOR_BUFFER_BIT);
-      drawSyncFlashSpot();
-      m_pDisplay->swap();
-      glFinish();
-      elapsedTime.reset();
-   }
-   else
-   {
-      glDrawBuffer(GL_BACK_LEFT);
-      glClearColor((float)m_bkgRGB[0], (float)m_bkgRGB[1], (float)m_bkgRGB[2], 0.0f);
-      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-      drawSyncFlashSpot();
-      glDrawBuffer(GL_BACK_RIGHT);
-      glClearColor((float)m_bkgRGB[0], (float)m_bkgRGB[1], (float)m_bkgRGB[2], 0.0f);
-      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-      drawSyncFlashSpot();
-      m_pDisplay->swap();
-      glFinish();
-      elapsedTime.reset();
-
-      m_pDisplay->swap();
-      glFinish();
-      elapsedTime.reset();
-   }
+   if(!m_pDisplay->isStereoEnabled() || m_iStereoPass != STEREO_TWOPASS) renderFrame(false);
+   m_pDisplay->swap();
+   glFinish();
+   elapsedTime.reset();
 
    // render frame 0 on the back buffer. Rendering is simply a matter of drawing each target in order. The sync flash 
    // spot is always drawn last so it appears on top. Coord system in degrees subtended at eye, IAW display geometry.
-   if(!m_pDisplay->isStereoEnabled())
-   {
-      glClear(GL_COLOR_BUFFER_BIT);
-      for(int i = 0; i < m_nTargets; i++) m_pTargetList[i]->draw(0.0);
-      drawSyncFlashSpot();
-   }
-   else
-   {
-      glDrawBuffer(GL_BACK_LEFT);
-      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-      for(int i = 0; i < m_nTargets; i++) m_pTargetList[i]->draw(-0.5);
-      drawSyncFlashSpot();
-      glDrawBuffer(GL_BACK_RIGHT);
-      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-      for(int i = 0; i < m_nTargets; i++) m_pTargetList[i]->draw(0.5);
-      drawSyncFlashSpot();
-   }
+   renderFrame(true);
 
    // swap front and back buffers, then call glFinish() to wait for the vertical blank interval. This is "t=0" in the
    // animation timeline -- display frame 0 is now being drawn to the screen. Signal Maestro that the animation has
@@ -1353,22 +2089,29 @@ int CRMVRenderer::animate()
    // enable video stream buffering now
    m_vidBuffer.startBuffering();
 
+   // we record the duration of each stage of every iteration of the animation loop, along with the drift T-N*P and
+   // the update cost of each target. Recording is cheap and always on; the records are reported after the sequence.
+   m_telemetry.begin(m_nTargets);
+   CFrameTelemetry::Record frameRec;
+   CElapsedTime stageTime;
+
+   // late-latch mode: decaying peak estimate of the cost to update and draw a frame, in us
+   double renderEstUS = 0;
+
    // here's the frame-by-frame animation:
    float fFrameMS = float(m_dFramePeriod * 1000.0);
    bool bUpdateReady = true;                           // motion vectors for frame 1 are included in 'startAnimate'
    int res = 2;                                        // set result code to 1, -1, or 0 when animation sequence ends
    while(res == 2)
    {
+      stageTime.reset();
+      frameRec.flags = bUpdateReady ? CFrameTelemetry::FLAG_UPDATED : 0;
+
       // update target state/position IAW motion vectors supplied for next frame. If we did not get "updateFrame"
       // command in time, we'll essentially redraw previous frame because the targets' state will be left unchanged.
       if(bUpdateReady)
       {
-         bOk = true;
-         for(int i=0; i<m_nTargets && bOk; i++)
-         {
-            bOk = m_pDisplay->getIOLink()->getMotionVector(i, tgtVec);
-            if(bOk) bOk = m_pTargetList[i]->updateMotion(fFrameMS, &tgtVec);
-         }
+         bOk = updateTargets(fFrameMS);
          if(!bOk)
          {
             // this is a catastrophic error, so we signal Maestro to terminate the animation sequence
@@ -1379,24 +2122,15 @@ int CRMVRenderer::animate()
          if(bSyncFlashEnabled && m_pDisplay->getIOLink()->isSyncFlashRequested() && m_syncSpot.nFramesLeft <= 0)
             m_syncSpot.nFramesLeft = m_syncSpot.flashDur;
       }
+      frameRec.updateUS = float(stageTime.getAndReset() * 1.0e6);
 
       // render next frame on backbuffer
-      if(!m_pDisplay->isStereoEnabled())
-      {
-         glClear(GL_COLOR_BUFFER_BIT);
-         for(int i = 0; i < m_nTargets; i++) m_pTargetList[i]->draw(0.0);
-         drawSyncFlashSpot();
-      }
-      else
+      renderFrame(true);
+      frameRec.drawUS = float(stageTime.getAndReset() * 1.0e6);
+      if(bUpdateReady)
       {
-         glDrawBuffer(GL_BACK_LEFT);
-         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-         for(int i = 0; i < m_nTargets; i++) m_pTargetList[i]->draw(-0.5);
-         drawSyncFlashSpot();
-         glDrawBuffer(GL_BACK_RIGHT);
-         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-         for(int i = 0; i < m_nTargets; i++) m_pTargetList[i]->draw(0.5);
-         drawSyncFlashSpot();
+         double costUS = frameRec.updateUS + frameRec.drawUS;
+         renderEstUS = (costUS > renderEstUS) ? costUS : 0.95*renderEstUS + 0.05*costUS;
       }
 
       // backbuffer now holds the next display frame, so swap front and back buffers during the next vertical blanking
@@ -1405,6 +2139,7 @@ int CRMVRenderer::animate()
       // is how we sync the animation timeline to the monitor's refresh period.
       m_pDisplay->swap();
       glFinish();
+      frameRec.swapUS = float(stageTime.get() * 1.0e6);
 
       // at this point, ideally, we are at the start of the next display frame. Get the total elapsed time T, as well
       // as the difference between actual and expected elapsed time N*P, where N is #frames elapsed and P is our
@@ -1430,6 +2165,10 @@ int CRMVRenderer::animate()
          msg[2] = nSkips;
          m_pDisplay->getIOLink()->sendData(3, msg);
       }
+      frameRec.frame = nFrames;
+      frameRec.driftUS = float(tDiff);
+      frameRec.periodUS = float(adjFramePeriodUS);
+      frameRec.nSkips = short(nSkips);
 
       // once per second, notify Maestro of elapsed time since animation sequence began
       if(tNow - tLastPingUS >= 1.0e6)
@@ -1468,7 +2207,22 @@ int CRMVRenderer::animate()
       // we are now ready to work on the next frame; Maestro should have sent us the next "updateFrame" command by now.
       // NOTE that we only retrieve one command per display frame!
       bUpdateReady = false;
+      stageTime.reset();
       int cmd = m_pDisplay->getIOLink()->getNextCommand();
+      if(m_bLateLatch && cmd == RMV_CMD_NONE)
+      {
+         // late latch: wait for the update as long as the next frame can still be rendered in time
+         double tDeadlineUS = tNow + adjFramePeriodUS - 1.5*renderEstUS - LATCHMARGINUS;
+         double tWaitUS = tDeadlineUS - (elapsedTime.get()*1.0e6 - firstFrameOffsetUS);
+         while(cmd == RMV_CMD_NONE && tWaitUS > 0)
+         {
+            m_pDisplay->getIOLink()->waitForCommand(int(tWaitUS));
+            cmd = m_pDisplay->getIOLink()->getNextCommand();
+            tWaitUS = tDeadlineUS - (elapsedTime.get()*1.0e6 - firstFrameOffsetUS);
+         }
+         if(cmd != RMV_CMD_NONE) frameRec.flags |= CFrameTelemetry::FLAG_LATCHED;
+      }
+      frameRec.cmdUS = float(stageTime.get() * 1.0e6);
       if(cmd < RMV_CMD_NONE)
       {
          // the RMVideo-Maestro comm link has failed. Set return code to indicate that command session has ended.
@@ -1503,9 +2257,17 @@ int CRMVRenderer::animate()
          msg[1] = nFrames;
          msg[2] = 0;
          m_pDisplay->getIOLink()->sendData(3, msg);
+         frameRec.flags |= CFrameTelemetry::FLAG_MISSEDCMD;
       }
+
+      bool bUpdated = (frameRec.flags & CFrameTelemetry::FLAG_UPDATED) != 0;
+      m_telemetry.record(frameRec, bUpdated ? m_pTgtUpdateUS : NULL);
    }
 
+   // export frame telemetry if enabled
+   if(m_bTelemetryExport) m_telemetry.dumpCSV(TELEMETRYFILE, m_nAnimSeqs);
+   ++m_nAnimSeqs;
+
    // disable video stream buffering, unload target list and make sure sync spot flash is off
    m_vidBuffer.stopBuffering();
    unloadTargets();
@@ -1515,9 +2277,40 @@ int CRMVRenderer::animate()
 }
 
 /**
- Update the uniform variables in RMVideo's monolithic shader which typically apply to all RMVideo targets: vertex
- transform "xfm", "special" identifier, and number of gratings "nGrats". Each CRMVTarget object will invoke this method
- in its draw() call to update these uniforms IAW its own properties.
+ Select the target program appropriate to the target that is about to be drawn, making it the current program if it is
+ not already. Each CRMVTarget invokes this method at the start of its draw() call, before updating any uniforms.
+
+ Target draw order is significant (a target drawn later is rendered on top of earlier ones, with blending), so the
+ targets are always drawn in the order in which they were loaded. The program is only switched when consecutive
+ targets belong to different classes, so a field of like targets is drawn without any program switches.
+
+ @param type [in] Target type.
+ @param isYUV [in] For RMV_MOVIE only: true if the movie's frames are in YUV 4:2:0 format.
+ @param isSine [in] For RMV_GRATING and RMV_PLAID only: true for sinewave gratings, false for squarewave.
+ @param isWindowed [in] For RMV_SPOT, RMV_GRATING and RMV_PLAID only: true if the target's aperture and Gaussian window
+ are computed analytically (see updateWindowUniforms()). Ignored unless analytic aperture mode is enabled.
+*/
+void CRMVRenderer::useTargetProgram(int type, bool isYUV, bool isSine, bool isWindowed)
+{
+   int iProg = PROG_MASK;
+   if(type == RMV_RANDOMDOTS) iProg = PROG_DOTS;
+   else if(type == RMV_IMAGE) iProg = PROG_IMAGE;
+   else if(type == RMV_MOVIE) iProg = isYUV ? PROG_YUV : PROG_IMAGE;
+   else if(type == RMV_GRATING) iProg = isSine ? PROG_SINEGRAT : PROG_SQGRAT;
+   else if(type == RMV_PLAID) iProg = isSine ? PROG_SINEPLAID : PROG_SQPLAID;
+
+   if(isWindowed && m_bAnalyticApertures)
+   {
+      if(type == RMV_SPOT) iProg = PROG_WINSPOT;
+      else if(type == RMV_GRATING || type == RMV_PLAID) iProg += PROG_WINSQGRAT - PROG_SQGRAT;
+   }
+   selectTargetProgram(iProg);
+}
+
+/**
+ Update the uniform variables in the current target program which apply to all RMVideo targets: the vertex transform
+ "xfm". Each CRMVTarget object will invoke this method in its draw() call, after selecting the target program via
+ useTargetProgram().
 
  The vertex transform prepared here scales, translates and rotates each 2D vertex to its corresponding location in
  normalized screen coordinates. Here are the operations applied:
@@ -1529,45 +2322,204 @@ int CRMVRenderer::animate()
  4) Finally, to get normalized screen coordinates, we scale by (2.0/wDeg, 2.0/hDeg, 1.0), where wDeg and hDeg are the
  screen extents in visual deg.
 
- @param type [in] Target type. The integer uniform "special" =1 for RMV_IMAGE and RMV_MOVIE, =2 for RMV_RANDOMDOTS, and
- =0 otherwise; the integer uniform "nGrats" is set to 0, 1, or 2 IAW the target type.
  @param x,y [in] Target center coordinates in visual degrees subtended at eye, where (0,0) is the screen center.
  @param w,h [in] Target bounding rectangle width and height. If either <= 0, then target lacks a bounding rectangle.
  @param rot [in] Target rotation in degrees CCW.
+ @param disp [in] Target's stereo disparity in visual degrees. Applies only in single-pass stereo mode, in which the
+ left and right eyes are drawn in the same pass, offset horizontally by -disp/2 and +disp/2, respectively. Default 0.
 */
-void CRMVRenderer::updateCommonUniforms(int type, float x, float y, float w, float h, float rot)
+void CRMVRenderer::updateCommonUniforms(float x, float y, float w, float h, float rot, float disp)
 {
-   if(m_pShader==NULL) return;
+   if(m_iCurrProg < 0) return;
+   setStereoDisparityUniform(float(2.0 * disp / m_dspGeom.wDeg));
 
    glm::mat4 xfm(1.0f);
    xfm = glm::scale(xfm, glm::vec3(2.0 / m_dspGeom.wDeg, 2.0 / m_dspGeom.hDeg, 1.0f));
    xfm = glm::translate(xfm, glm::vec3(x, y, 0.0));
    if(rot != 0.0f) xfm = glm::rotate(xfm, glm::radians(rot), glm::vec3(0.0f, 0.0f, 1.0f));
    if(w > 0.0f && h > 0.0f) xfm = glm::scale(xfm, glm::vec3(w, h, 1.0f));
-   m_pShader->setMat4("xfm", xfm);
+   glUniformMatrix4fv(m_tgtLoc[m_iCurrProg].xfm, 1, GL_FALSE, &xfm[0][0]);
+}
+
+/**
+ Update the target program uniforms that apply only to an RMV_MOVIE target whose frames are in YUV 4:2:0 format. The 
+ YUV program must be current; see useTargetProgram().
 
-   m_pShader->setInt("special", (type==RMV_IMAGE || type==RMV_MOVIE) ? 1 : (type==RMV_RANDOMDOTS ? 2:0));
-   m_pShader->setInt("nGrats", type==RMV_GRATING ? 1 : (type==RMV_PLAID ? 2 : 0));
+ @param w,h [in] Frame width and height in pixels.
+ @param fullRange [in] True if YUV samples span the full range [0..255]; false if limited ("MPEG") range.
+*/
+void CRMVRenderer::updateYUVFrameUniforms(int w, int h, bool fullRange)
+{
+   if(m_iCurrProg < 0) return;
+   glUniform4f(m_tgtLoc[m_iCurrProg].yuvDims, (float) w, (float) h, (float) ((w+1)/2), (float) ((h+1)/2));
+   glUniform1i(m_tgtLoc[m_iCurrProg].yuvFullRange, fullRange ? 1 : 0);
 }
 
 /**
- Update the shader program uniform variable holding the target color, "tgtC". Each CRMVTarget will invoke this method
+ Update the target program uniform variable holding the target color, "tgtC". Each CRMVTarget will invoke this method
  (if necessary) in its draw() call to update this uniform's value.
 
  @param r,g,b [in] Target RGB color; each component normalized in [0.0..1.0]. 
 */
 void CRMVRenderer::updateTargetColorUniform(double r, double g, double b)
 {
-   if(m_pShader != NULL) m_pShader->setVec3("tgtC", glm::vec3(r, g, b));
+   if(m_iCurrProg >= 0) setTargetColorUniform((float) r, (float) g, (float) b);
+}
+
+/**
+ Compile and link the target programs, one for each class of target, from the shader sources VERTEXSHADERSRC and 
+ FRAGMENTSHADERSRC. Each program's fragment shader is specialized by prepending definitions of the macros SPECIAL,
+ NGRATS, ISSINE and WINDOW to the fragment shader source; the WINDOW programs are only built in analytic aperture
+ mode. Both shaders are also specialized for the single-pass stereo mode in effect (macro STEREO), so that mode must be
+ decided beforehand. Upon success, the uniform locations of each program are resolved, the sampler uniform "tex" is set
+ to texture unit 0 in every program, and (side-by-side stereo only) the uniform "eyeW" is set to the screen width.
+
+ @return True if successful; false if any program could not be built, in which case an error message is printed to
+ stderr.
+*/
+bool CRMVRenderer::createTargetPrograms()
+{
+   // {SPECIAL, NGRATS, ISSINE, WINDOW} for each target program, indexed by program ID
+   static const int defs[NUMTGTPROGS][4] = {
+      {0, 0, 0, 0}, {2, 0, 0, 0}, {1, 0, 0, 0}, {3, 0, 0, 0}, {0, 1, 0, 0}, {0, 1, 1, 0}, {0, 2, 0, 0}, {0, 2, 1, 0},
+      {0, 0, 0, 1}, {0, 1, 0, 1}, {0, 1, 1, 1}, {0, 2, 0, 1}, {0, 2, 1, 1}
+   };
+
+   // the programs that compute the aperture analytically are built only in analytic aperture mode
+   int nProgs = m_bAnalyticApertures ? NUMTGTPROGS : PROG_WINSPOT;
+
+   int len = ::strlen(FRAGMENTSHADERSRC) + 128;
+   int vsLen = ::strlen(VERTEXSHADERSRC) + 256;
+   char* pSrc = (char*) ::malloc(len);
+   char* pVSSrc = (char*) ::malloc(vsLen);
+   if(pSrc == NULL || pVSSrc == NULL)
+   {
+      if(pSrc != NULL) ::free(pSrc);
+      if(pVSSrc != NULL) ::free(pVSSrc);
+      fprintf(stderr, "ERROR(CRMVRenderer): Memory allocation failed while building target programs\n");
+      return(false);
+   }
+
+   // the vertex shader is the same for all programs. Layered stereo needs an extension to set gl_Layer.
+   const char* ext = (m_iStereoPass != STEREO_LAYERED) ? "" :
+         "#extension GL_ARB_shader_viewport_layer_array : enable\n#extension GL_AMD_vertex_shader_layer : enable\n";
+   ::snprintf(pVSSrc, vsLen, "#version 330 core\n%s#define STEREO %d\n%s", ext, m_iStereoPass, VERTEXSHADERSRC);
+
+   bool ok = true;
+   for(int i=0; ok && i<nProgs; i++)
+   {
+      ::snprintf(pSrc, len, "#version 330 core\n#define SPECIAL %d\n#define NGRATS %d\n#define ISSINE %d\n"
+            "#define WINDOW %d\n#define STEREO %d\n%s", defs[i][0], defs[i][1], defs[i][2], defs[i][3], m_iStereoPass,
+            FRAGMENTSHADERSRC);
+      m_pShaders[i] = new Shader(pVSSrc, pSrc, false);
+      ok = m_pShaders[i]->isUsable();
+      if(!ok) fprintf(stderr, "ERROR(CRMVRenderer): Failed to create GLSL shader program %d\n", i);
+      else
+      {
+         resolveTargetUniforms(i);
+         m_pShaders[i]->use();
+         glUniform1i(glGetUniformLocation(m_pShaders[i]->ID, "tex"), 0);
+         if(m_iStereoPass == STEREO_SIDEBYSIDE) glUniform1f(m_tgtLoc[i].eyeW, (float) m_pDisplay->getScreenWidth());
+      }
+   }
+   ::free(pSrc);
+   ::free(pVSSrc);
+
+   // on failure, discard any programs built so that the caller may try again with a different specialization
+   if(!ok) for(int i=0; i<nProgs; i++) if(m_pShaders[i] != NULL)
+   {
+      delete m_pShaders[i];
+      m_pShaders[i] = NULL;
+   }
+
+   m_iCurrProg = -1;
+   if(ok) selectTargetProgram(PROG_MASK);
+   return(ok);
+}
+
+/**
+ Look up the locations of all per-target uniforms in the specified target program. Must be called once after the 
+ program is successfully linked. Looking up a location by name is relatively costly (the driver must search the
+ program's uniform table), and the draw() of each target sets several uniforms -- twice per frame in stereo mode -- so
+ the locations are resolved once here rather than on every uniform update.
+
+ The last-uploaded value of the program's "tgtC" uniform is also invalidated here, so the next call to 
+ setTargetColorUniform() with the program current always uploads.
+
+ @param iProg [in] The target program ID.
+*/
+void CRMVRenderer::resolveTargetUniforms(int iProg)
+{
+   unsigned int prog = m_pShaders[iProg]->ID;
+   TargetUniforms& loc = m_tgtLoc[iProg];
+   loc.xfm = glGetUniformLocation(prog, "xfm");
+   loc.tgtC = glGetUniformLocation(prog, "tgtC");
+   loc.ctr = glGetUniformLocation(prog, "ctr");
+   loc.mean0 = glGetUniformLocation(prog, "mean0");
+   loc.con0 = glGetUniformLocation(prog, "con0");
+   loc.mean1 = glGetUniformLocation(prog, "mean1");
+   loc.con1 = glGetUniformLocation(prog, "con1");
+   loc.dx = glGetUniformLocation(prog, "dx");
+   loc.dy = glGetUniformLocation(prog, "dy");
+   loc.phase = glGetUniformLocation(prog, "phase");
+   loc.yuvDims = glGetUniformLocation(prog, "yuvDims");
+   loc.yuvFullRange = glGetUniformLocation(prog, "yuvFullRange");
+   loc.aperture = glGetUniformLocation(prog, "aperture");
+   loc.apDims = glGetUniformLocation(prog, "apDims");
+   loc.gaussFac = glGetUniformLocation(prog, "gaussFac");
+   loc.eyeDx = glGetUniformLocation(prog, "eyeDx");
+   loc.eyeW = glGetUniformLocation(prog, "eyeW");
+
+   m_currTgtC[iProg][0] = m_currTgtC[iProg][1] = m_currTgtC[iProg][2] = -1.0f;
+   m_currEyeDx[iProg] = 0.0f;
+}
+
+/**
+ Make the specified target program the current program, unless it is already current. 
+ @param iProg [in] The target program ID.
+*/
+void CRMVRenderer::selectTargetProgram(int iProg)
+{
+   if(iProg == m_iCurrProg) return;
+   m_iCurrProg = iProg;
+   m_pShaders[iProg]->use();
+}
+
+/**
+ Set the "tgtC" uniform in the current target program. Uniform values persist in the program object, and consecutive 
+ targets (eg, a field of dot patches) very often share the same color, so the uniform is only uploaded if its value 
+ differs from the one last uploaded to that program.
+*/
+void CRMVRenderer::setTargetColorUniform(float r, float g, float b)
+{
+   float* pCurr = m_currTgtC[m_iCurrProg];
+   if(r == pCurr[0] && g == pCurr[1] && b == pCurr[2]) return;
+   pCurr[0] = r;
+   pCurr[1] = g;
+   pCurr[2] = b;
+   glUniform3f(m_tgtLoc[m_iCurrProg].tgtC, r, g, b);
+}
+
+/**
+ Set the "eyeDx" uniform in the current target program -- the horizontal offset of the right eye's view of the target
+ relative to the left eye's, in normalized coordinates. It exists only in single-pass stereo mode, and it is only
+ uploaded if its value differs from the one last uploaded to that program.
+*/
+void CRMVRenderer::setStereoDisparityUniform(float dx)
+{
+   if(m_iStereoPass == STEREO_TWOPASS || dx == m_currEyeDx[m_iCurrProg]) return;
+   m_currEyeDx[m_iCurrProg] = dx;
+   glUniform1f(m_tgtLoc[m_iCurrProg].eyeDx, dx);
 }
 
 /**
  Update the various shader program uniform variables that govern the rendering of the gratings in an RMV_GRATING or
- RMV_PLAID target. Note that these uniforms are ignored completely for any other target type and need not be set.
+ RMV_PLAID target. Note that these uniforms are ignored completely for any other target type and need not be set. The
+ grating or plaid program must be current; see useTargetProgram(). Whether the gratings are sinewave or squarewave is
+ determined by the choice of program.
  
  Here is the list of uniforms updated in the fragment shader (rmvtarget.fs):
     vec2 ctr;            // current target center in screen coords (pixels WRT origin at TL corner
-    int isSine;          // nonzero for sinewave, 0 for squarewave
     vec3 mean0;          // RGB mean color for grating 0 [0..1]
     vec3 con0;           // RGB contrast for grating 0 [0..1]
     vec3 mean1;          // RGB mean color for grating 1
@@ -1579,7 +2531,6 @@ void CRMVRenderer::updateTargetColorUniform(double r, double g, double b)
  in radians and spatialPerX,Y are the grating's X and Y spatial periods in pixels.
 
  @param x,y [in] Coordinates of target center in degrees subtended at eye.
- @param isSine [in] True if grating(s) are sinusoidal, false for square-wave.
  @param pMean0 [in] Pointer to 3-element buffer [R,G,B] defining the mean color for the first grating. Each color
  component is assumed to be normalized to [0..1].
  @param pCon0 [in] Pointer to 3-element buffer [Cr, Cg, Cb] defining the per-component contrast for the first grating.
@@ -1590,29 +2541,64 @@ void CRMVRenderer::updateTargetColorUniform(double r, double g, double b)
  pixels) for each grating.
  @param pPhase [in] Pointer to 2-element buffer holding the spatial phase (in deg) for each grating.
 */
-void CRMVRenderer::updateGratingUniforms(float x, float y, bool isSine, double* pMean0, double* pCon0, 
-      double* pMean1, double* pCon1, float* pAngle, float* pPeriodX, float *pPeriodY, float* pPhase)
+void CRMVRenderer::updateGratingUniforms(float x, float y, double* pMean0, double* pCon0, double* pMean1, 
+      double* pCon1, float* pAngle, float* pPeriodX, float *pPeriodY, float* pPhase)
 {
-   if(m_pShader == NULL || m_pDisplay==NULL) return;
+   if(m_iCurrProg < 0 || m_pDisplay==NULL) return;
+   const TargetUniforms& loc = m_tgtLoc[m_iCurrProg];
 
    double xScrn = x*m_pDisplay->getScreenWidth()/m_dspGeom.wDeg + m_pDisplay->getScreenWidth()/2.0;
    double yScrn = y*m_pDisplay->getScreenHeight()/m_dspGeom.hDeg + m_pDisplay->getScreenHeight()/2.0;
-   m_pShader->setVec2("ctr", glm::vec2(xScrn, yScrn));
-   m_pShader->setBool("isSine", isSine);
-   m_pShader->setVec3("mean0", glm::vec3(pMean0[0], pMean0[1], pMean0[2]));
-   m_pShader->setVec3("con0", glm::vec3(pCon0[0], pCon0[1], pCon0[2]));
-   m_pShader->setVec3("mean1", glm::vec3(pMean1[0], pMean1[1], pMean1[2]));
-   m_pShader->setVec3("con1", glm::vec3(pCon1[0], pCon1[1], pCon1[2]));
+   glUniform2f(loc.ctr, (float) xScrn, (float) yScrn);
+   glUniform3f(loc.mean0, (float) pMean0[0], (float) pMean0[1], (float) pMean0[2]);
+   glUniform3f(loc.con0, (float) pCon0[0], (float) pCon0[1], (float) pCon0[2]);
+   glUniform3f(loc.mean1, (float) pMean1[0], (float) pMean1[1], (float) pMean1[2]);
+   glUniform3f(loc.con1, (float) pCon1[0], (float) pCon1[1], (float) pCon1[2]);
 
    double proj0 = (pPeriodX[0]<=0) ? 0 : cMath::cosDeg(pAngle[0])/pPeriodX[0];
    double proj1 = (pPeriodX[1]<=0) ? 0 : cMath::cosDeg(pAngle[1])/pPeriodX[1];
-   m_pShader->setVec2("dx", glm::vec2(proj0, proj1));
+   glUniform2f(loc.dx, (float) proj0, (float) proj1);
 
    proj0 = (pPeriodY[0]<=0) ? 0 : cMath::sinDeg(pAngle[0])/pPeriodY[0];
    proj1 = (pPeriodY[1]<=0) ? 0 : cMath::sinDeg(pAngle[1])/pPeriodY[1];
-   m_pShader->setVec2("dy", glm::vec2(proj0, proj1));
+   glUniform2f(loc.dy, (float) proj0, (float) proj1);
 
-   m_pShader->setVec2("phase", glm::vec2(cMath::toRadians(pPhase[0]), cMath::toRadians(pPhase[1])));
+   glUniform2f(loc.phase, (float) cMath::toRadians(pPhase[0]), (float) cMath::toRadians(pPhase[1]));
+}
+
+/**
+ Update the target program uniforms that implement the aperture and Gaussian window of an RMV_SPOT, RMV_GRATING or 
+ RMV_PLAID target in analytic aperture mode. A windowed target program must be current; see useTargetProgram().
+
+ The fragment shader computes the fraction of each fragment covered by the aperture (so the aperture boundary is 
+ antialiased at any size and display resolution), then scales it by the Gaussian window. This takes the place of the
+ alpha mask texture prepared by prepareAlphaMaskTexture(), so no mask need be computed when the target is loaded.
+ Since the grating and plaid programs also need the target center "ctr", this method must be called BEFORE
+ updateGratingUniforms() -- which sets "ctr" to the same value anyway.
+
+ @param x,y [in] Coordinates of target center in degrees subtended at eye.
+ @param aperture [in] Aperture type: RMV_RECT, RMV_OVAL, RMV_RECTANNU or RMV_OVALANNU.
+ @param w,h [in] Width and height of the target window, in deg.
+ @param iw,ih [in] Width and height of the hole in an annular aperture, in deg.
+ @param sigX,sigY [in] Horizontal and vertical standard deviations of the Gaussian window, in deg. If zero, there is no
+ Gaussian window along the corresponding axis.
+*/
+void CRMVRenderer::updateWindowUniforms(float x, float y, int aperture, float w, float h, float iw, float ih,
+      float sigX, float sigY)
+{
+   if(m_iCurrProg < 0 || m_pDisplay==NULL) return;
+   const TargetUniforms& loc = m_tgtLoc[m_iCurrProg];
+
+   double pixPerDegX = m_pDisplay->getScreenWidth() / m_dspGeom.wDeg;
+   double pixPerDegY = m_pDisplay->getScreenHeight() / m_dspGeom.hDeg;
+   glUniform2f(loc.ctr, (float) (x*pixPerDegX + m_pDisplay->getScreenWidth()/2.0), 
+         (float) (y*pixPerDegY + m_pDisplay->getScreenHeight()/2.0));
+   glUniform1i(loc.aperture, aperture);
+   glUniform4f(loc.apDims, (float) (w*pixPerDegX/2.0), (float) (h*pixPerDegY/2.0), (float) (iw*pixPerDegX/2.0),
+         (float) (ih*pixPerDegY/2.0));
+
+   double sx = sigX * pixPerDegX, sy = sigY * pixPerDegY;
+   glUniform2f(loc.gaussFac, (float) ((sx > 0) ? -1.0/(2.0*sx*sx) : 0.0), (float) ((sy > 0) ? -1.0/(2.0*sy*sy) : 0.0));
 }
 
 /**
@@ -1663,10 +2649,219 @@ void CRMVRenderer::setPointSize(int sz) { glPointSize((GLfloat) sz); }
 void CRMVRenderer::drawPrimitives(bool isPts, bool isLine, int start, int n)
 {
    if(start < 0 || start+n > MAXNUMVERTS) return;
-   glDrawArrays(isPts ? GL_POINTS : (isLine ? GL_LINES : GL_TRIANGLES), start, n);
+   drawArraysPerEye(isPts ? GL_POINTS : (isLine ? GL_LINES : GL_TRIANGLES), start, n);
+}
+
+/**
+ Issue a draw call for the current target program: glDrawArrays(mode, start, n) -- except in single-pass stereo mode,
+ where the primitives are drawn as two instances, one for each eye. See VERTEXSHADERSRC.
+*/
+void CRMVRenderer::drawArraysPerEye(GLenum mode, int start, int n)
+{
+   if(m_iStereoPass == STEREO_TWOPASS) glDrawArrays(mode, start, n);
+   else glDrawArraysInstanced(mode, start, n, 2);
 }
 
 
+/**
+ Create the pair of vertex arrays and backing buffers that hold the per-dot state of a RMV_RANDOMDOTS or RMV_FLOWFIELD
+ target animated by the GPU dot engine. Each buffer stores 8 floats per dot, {x, y, Tx, Ty, life, C, S, 0}. Vertex
+ attributes 0 and 1 are (x,y) and (Tx,Ty), as in the shared vertex array, so either array can be drawn by the RMVideo
+ shader program; attribute 2 is the rest of the dot state, used only by the dot engine. On each update, the engine
+ reads from one buffer and writes to the other, so the two are used in ping-pong fashion.
+
+ Unlike the CPU implementation, a target animated on the GPU does not occupy a segment of the shared vertex array, so
+ the number of dots is not limited by its capacity.
+
+ @param nDots [in] The number of dots.
+ @param pVAOs [out] The IDs of the two vertex arrays.
+ @param pVBOs [out] The IDs of the corresponding buffer objects.
+ @return True if successful, false otherwise. On failure, any GL objects created are released.
+*/
+bool CRMVRenderer::createGPUDotBuffers(int nDots, unsigned int* pVAOs, unsigned int* pVBOs)
+{
+   if(m_idDotEngineProg == 0 || nDots <= 0 || pVAOs == NULL || pVBOs == NULL) return(false);
+
+   glGenVertexArrays(2, pVAOs);
+   glGenBuffers(2, pVBOs);
+   for(int i=0; i<2; i++)
+   {
+      glBindVertexArray(pVAOs[i]);
+      glBindBuffer(GL_ARRAY_BUFFER, pVBOs[i]);
+      glBufferData(GL_ARRAY_BUFFER, sizeof(float)*nDots*8, NULL, GL_DYNAMIC_COPY);
+      glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+      glEnableVertexAttribArray(0);
+      glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(2 * sizeof(float)));
+      glEnableVertexAttribArray(1);
+      glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(4 * sizeof(float)));
+      glEnableVertexAttribArray(2);
+   }
+
+   // restore the shared vertex array and buffer, which are always bound otherwise
+   glBindVertexArray(m_idVAO);
+   glBindBuffer(GL_ARRAY_BUFFER, m_idVBO);
+
+   bool ok = (glGetError() == GL_NO_ERROR);
+   if(!ok) releaseGPUDotBuffers(pVAOs, pVBOs);
+   return(ok);
+}
+
+/**
+ Release the vertex arrays and buffers created by createGPUDotBuffers(). The IDs are reset to 0.
+
+ @param pVAOs [in/out] The IDs of the two vertex arrays.
+ @param pVBOs [in/out] The IDs of the corresponding buffer objects.
+*/
+void CRMVRenderer::releaseGPUDotBuffers(unsigned int* pVAOs, unsigned int* pVBOs)
+{
+   if(pVAOs == NULL || pVBOs == NULL) return;
+   if(pVAOs[0] != 0 || pVAOs[1] != 0) glDeleteVertexArrays(2, pVAOs);
+   if(pVBOs[0] != 0 || pVBOs[1] != 0) glDeleteBuffers(2, pVBOs);
+   pVAOs[0] = pVAOs[1] = pVBOs[0] = pVBOs[1] = 0;
+}
+
+/**
+ Run one pass of the GPU dot engine, which either initializes the dot state of a RMV_RANDOMDOTS or RMV_FLOWFIELD 
+ target, or advances it by one frame. The engine's program is made current, the pass parameters are loaded into its
+ uniforms, and the dots are "drawn" from the source array with rasterization disabled, while transform feedback 
+ captures the updated dot state into the destination buffer. The RMVideo shader program and the shared vertex array
+ are restored afterwards. See DOTENGINESHADERSRC for the details.
+
+ @param params [in] Parameters for this pass.
+ @param srcVAO [in] Vertex array holding the current dot state. Ignored by the initialization passes.
+ @param dstVBO [in] Buffer object that receives the new dot state. It must not back the source vertex array.
+ @param nDots [in] The number of dots.
+*/
+void CRMVRenderer::runGPUDotEngine(const GPUDotPass& params, unsigned int srcVAO, unsigned int dstVBO, int nDots)
+{
+   if(m_idDotEngineProg == 0 || nDots <= 0) return;
+
+   glUseProgram(m_idDotEngineProg);
+   glUniform1i(m_dotEngineLoc.mode, params.mode);
+   glUniform1ui(m_dotEngineLoc.seed, params.seed);
+   glUniform1ui(m_dotEngineLoc.pass, params.pass);
+   glUniform1i(m_dotEngineLoc.aperture, params.aperture);
+   glUniform2f(m_dotEngineLoc.outerDims, params.outerW, params.outerH);
+   glUniform2f(m_dotEngineLoc.innerDims, params.innerW, params.innerH);
+   glUniform2f(m_dotEngineLoc.gaussFac, params.gaussX, params.gaussY);
+   glUniform2f(m_dotEngineLoc.patDisp, params.patX, params.patY);
+   glUniform2f(m_dotEngineLoc.winDisp, params.winX, params.winY);
+   glUniform1f(m_dotEngineLoc.pctCoherent, params.pctCoherent);
+   glUniform1f(m_dotEngineLoc.dotLife, params.dotLife);
+   glUniform1f(m_dotEngineLoc.dotLifeDelta, params.dotLifeDelta);
+   glUniform1i(m_dotEngineLoc.noiseMode, params.noiseMode);
+   glUniform1i(m_dotEngineLoc.noiseUpdate, params.noiseUpdate ? 1 : 0);
+   glUniform1f(m_dotEngineLoc.noiseLimit, params.noiseLimit);
+   glUniform1f(m_dotEngineLoc.log2Fac, params.log2Fac);
+   glUniform1f(m_dotEngineLoc.flowB, params.flowB);
+   glUniform1f(m_dotEngineLoc.flowRecycleRate, params.flowRecycleRate);
+   glUniform1f(m_dotEngineLoc.flowRecycleDR, params.flowRecycleDR);
+
+   glEnable(GL_RASTERIZER_DISCARD);
+   glBindVertexArray(srcVAO);
+   glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, dstVBO);
+   glBeginTransformFeedback(GL_POINTS);
+   glDrawArrays(GL_POINTS, 0, nDots);
+   glEndTransformFeedback();
+   glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+   glDisable(GL_RASTERIZER_DISCARD);
+
+   glBindVertexArray(m_idVAO);
+   if(m_iCurrProg >= 0) glUseProgram(m_pShaders[m_iCurrProg]->ID);
+}
+
+/**
+ Draw a contiguous range of dots from one of the vertex arrays created by createGPUDotBuffers(). Like drawPrimitives(),
+ this is called by a CRMVTarget in its draw() method, after updating the relevant uniforms.
+
+ @param vao [in] The vertex array holding the dot state to be drawn.
+ @param start [in] Index of first dot to draw.
+ @param n [in] The number of dots to draw.
+*/
+void CRMVRenderer::drawGPUDots(unsigned int vao, int start, int n)
+{
+   if(vao == 0 || start < 0 || n <= 0) return;
+   glBindVertexArray(vao);
+   drawArraysPerEye(GL_POINTS, start, n);
+   glBindVertexArray(m_idVAO);
+}
+
+/**
+ Update the state of all targets in the animated target list IAW the next set of motion vectors from Maestro. This is
+ the target update stage of the animation loop in animate().
+
+ The motion vectors are first retrieved from the IO link for all targets, since the IO link may only be accessed on 
+ RMVideo's main thread (the GL thread). If there are at least MINPARALLELTGTS targets that can be updated off the GL 
+ thread -- the dot-patch targets RMV_RANDOMDOTS and RMV_FLOWFIELD, whose per-frame update is CPU-bound and can involve
+ thousands of dots --, those target updates are dispatched to the worker pool. While the workers are busy, the GL
+ thread updates the remaining targets, then helps out with any dot-patch updates not yet claimed and waits for the 
+ rest to finish. Only after that barrier are the dot-patch vertex data uploaded to the shared vertex array, since the 
+ upload is a GL call. Otherwise, all targets are updated serially on the GL thread, as before.
+
+ The outcome is deterministic regardless of how the jobs are scheduled across threads: each target is updated by
+ exactly one thread per frame, and each target owns its state, including the random number generators that govern
+ dot placement, coherence, lifetimes and noise. A given seed reproduces the same dot pattern as in a serial update.
+
+ The duration of each target's updateMotion() call, on whichever thread it runs, is stored for the frame telemetry.
+
+ @param tElapsed The elapsed time since the previous update (ie, the frame period) in milliseconds.
+ @return True if successful, false if a fatal error occurred (failed to retrieve a motion vector, or a target's 
+ updateMotion() failed).
+*/
+bool CRMVRenderer::updateTargets(float tElapsed)
+{
+   for(int i=0; i<m_nTargets; i++)
+   {
+      if(!m_pDisplay->getIOLink()->getMotionVector(i, m_pTgtVecs[i])) return(false);
+   }
+
+   bool bParallel = m_workerPool.isRunning() && (m_nOffGLTgts >= MINPARALLELTGTS);
+   if(bParallel)
+   {
+      m_fUpdateElapsedMS = tElapsed;
+      m_workerPool.dispatch(CRMVRenderer::updateTargetJob, this, m_nOffGLTgts);
+   }
+
+   bool bOk = true;
+   for(int i=0; i<m_nTargets && bOk; i++)
+   {
+      if(bParallel && m_pTargetList[i]->canUpdateOffGLThread()) continue;
+      CElapsedTime tUpdate;
+      bOk = m_pTargetList[i]->updateMotion(tElapsed, &(m_pTgtVecs[i]));
+      m_pTgtUpdateUS[i] = float(tUpdate.get() * 1.0e6);
+   }
+
+   if(bParallel)
+   {
+      m_workerPool.waitForCompletion();
+      for(int j=0; j<m_nOffGLTgts; j++)
+      {
+         int i = m_pOffGLTgts[j];
+         if(!m_pTgtUpdateOK[i]) bOk = false;
+         m_pTargetList[i]->uploadPendingVertexData();
+      }
+   }
+
+   return(bOk);
+}
+
+/**
+ Job function for the worker pool, invoked by updateTargets(). It updates the specified target in the list of targets
+ that can be updated off the GL thread, deferring the vertex data upload.
+
+ @param pArg The renderer object.
+ @param iJob Index into the list of targets that can be updated off the GL thread.
+*/
+void CRMVRenderer::updateTargetJob(void* pArg, int iJob)
+{
+   CRMVRenderer* pThis = (CRMVRenderer*) pArg;
+   int i = pThis->m_pOffGLTgts[iJob];
+   CElapsedTime tUpdate;
+   pThis->m_pTgtUpdateOK[i] = pThis->m_pTargetList[i]->updateMotion(pThis->m_fUpdateElapsedMS, 
+         &(pThis->m_pTgtVecs[i]), true);
+   pThis->m_pTgtUpdateUS[i] = float(tUpdate.get() * 1.0e6);
+}
+
 /**
  Recalculate the logical dimensions of the photodiode sync flash spot.
 
@@ -1699,7 +2894,7 @@ void CRMVRenderer::recalcSyncFlashGeometry()
 void CRMVRenderer::drawSyncFlashSpot()
 {
    // feature is disabled if the spot size is 0 or if shader program not available
-   if(m_syncSpot.size == 0 || m_pShader == NULL) return;
+   if(m_syncSpot.size == 0 || m_iCurrProg < 0) return;
 
    // transform scales primitive quad to "local" coordinates, then moves origin to the screen's top-left corner in 
    // "local" coordinates, then scales down to normalized coordinates [-1 .. 1] in both X and Y.  Note that, because
@@ -1710,20 +2905,175 @@ void CRMVRenderer::drawSyncFlashSpot()
    xfm = glm::translate(xfm, glm::vec3(-m_dspGeom.wDeg/2.0, m_dspGeom.hDeg/2.0, 0.0));
    xfm = glm::scale(xfm, glm::vec3(m_syncSpot.wDeg * 2.0, m_syncSpot.hDeg * 2.0, 1.0f));
 
-   // update the uniforms that our monolithic shader needs to render spot. 
-   m_pShader->setMat4("xfm", xfm);
-   m_pShader->setVec3("tgtC", glm::vec3(m_syncSpot.nFramesLeft > 0 ? 1.0f : 0.0f));
-   m_pShader->setInt("special", 0);
-   m_pShader->setInt("nGrats", 0);
+   // select the alpha mask program and update the uniforms it needs to render spot. 
+   selectTargetProgram(PROG_MASK);
+   glUniformMatrix4fv(m_tgtLoc[PROG_MASK].xfm, 1, GL_FALSE, &xfm[0][0]);
+   float c = (m_syncSpot.nFramesLeft > 0) ? 1.0f : 0.0f;
+   setTargetColorUniform(c, c, c);
+   setStereoDisparityUniform(0.0f);
 
    // render the sync spot
    bindTextureObject(m_NoOpAlphaMaskID);
-   glDrawArrays(GL_TRIANGLES, QUADINDEX, QUADCOUNT);
+   drawArraysPerEye(GL_TRIANGLES, QUADINDEX, QUADCOUNT);
 
    // if flash is on, decrement #frames remaining
    if(m_syncSpot.nFramesLeft > 0) --m_syncSpot.nFramesLeft;
 }
 
+/**
+ Render a frame on the backbuffer: clear it to the current background color (the "clear color" must already be set),
+ draw all targets in the animated target list in order (if requested), and draw the sync flash spot on top. 
+
+ In stereo mode, the frame is rendered for both eyes. Without single-pass stereo, the left and right backbuffers are 
+ each cleared and drawn in turn, with the targets drawn via CRMVTarget::draw(-0.5) and draw(0.5), respectively. In 
+ single-pass stereo mode, the frame is instead rendered in the offscreen stereo framebuffer: every target is drawn once
+ -- with one uniform update, texture bind and draw call serving both eyes -- and the result is then resolved to the 
+ backbuffers. See resolveStereoFrame().
+
+ @param bTargets If true, the targets are drawn; otherwise, only the background and sync flash spot.
+*/
+void CRMVRenderer::renderFrame(bool bTargets)
+{
+   if(m_iStereoPass != STEREO_TWOPASS)
+   {
+      int w = m_pDisplay->getScreenWidth();
+      glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_idStereoFBO);
+      glViewport(0, 0, (m_iStereoPass == STEREO_SIDEBYSIDE) ? 2*w : w, m_pDisplay->getScreenHeight());
+      glClear(GL_COLOR_BUFFER_BIT);
+      if(bTargets) for(int i = 0; i < m_nTargets; i++) m_pTargetList[i]->draw(0.0);
+      drawSyncFlashSpot();
+      resolveStereoFrame();
+   }
+   else if(!m_pDisplay->isStereoEnabled())
+   {
+      glClear(GL_COLOR_BUFFER_BIT);
+      if(bTargets) for(int i = 0; i < m_nTargets; i++) m_pTargetList[i]->draw(0.0);
+      drawSyncFlashSpot();
+   }
+   else
+   {
+      glDrawBuffer(GL_BACK_LEFT);
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      if(bTargets) for(int i = 0; i < m_nTargets; i++) m_pTargetList[i]->draw(-0.5);
+      drawSyncFlashSpot();
+      glDrawBuffer(GL_BACK_RIGHT);
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      if(bTargets) for(int i = 0; i < m_nTargets; i++) m_pTargetList[i]->draw(0.5);
+      drawSyncFlashSpot();
+   }
+}
+
+/**
+ Single-pass stereo mode: Copy the left and right eye views from the offscreen stereo framebuffer to the left and right
+ backbuffers, respectively, then restore the default framebuffer and viewport. If the display has no stereo 
+ backbuffers -- as in headless mode -- the two views are instead placed side by side in the one backbuffer, each 
+ squeezed to half the screen width, so that both are captured.
+*/
+void CRMVRenderer::resolveStereoFrame()
+{
+   int w = m_pDisplay->getScreenWidth();
+   int h = m_pDisplay->getScreenHeight();
+   bool bStereoBufs = m_pDisplay->hasStereoBuffers();
+
+   glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+   if(m_iStereoPass == STEREO_SIDEBYSIDE) glBindFramebuffer(GL_READ_FRAMEBUFFER, m_idStereoFBO);
+   for(int eye = 0; eye < 2; eye++)
+   {
+      int x0 = 0;
+      if(m_iStereoPass == STEREO_LAYERED) glBindFramebuffer(GL_READ_FRAMEBUFFER, m_idStereoReadFBO[eye]);
+      else x0 = eye * w;
+
+      if(bStereoBufs)
+      {
+         glDrawBuffer((eye == 0) ? GL_BACK_LEFT : GL_BACK_RIGHT);
+         glBlitFramebuffer(x0, 0, x0 + w, h, 0, 0, w, h, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+      }
+      else
+         glBlitFramebuffer(x0, 0, x0 + w, h, eye * w / 2, 0, (eye + 1) * w / 2, h, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+   }
+   glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+   glViewport(0, 0, w, h);
+}
+
+/**
+ Create the offscreen framebuffer in which both eyes are rendered in single-pass stereo mode. Its color buffer is a 
+ 2-layer texture array with the screen's dimensions in STEREO_LAYERED mode, along with a read framebuffer for each
+ layer (for resolving each eye); in STEREO_SIDEBYSIDE mode, it is a single texture twice the screen width. The mode
+ must be set before calling this method.
+
+ @return True if successful; false otherwise, in which case any GL objects created are released.
+*/
+bool CRMVRenderer::createStereoFramebuffer()
+{
+   int w = m_pDisplay->getScreenWidth();
+   int h = m_pDisplay->getScreenHeight();
+   bool bLayered = (m_iStereoPass == STEREO_LAYERED);
+
+   GLint maxTexSize = 0;
+   GLint maxVP[2] = {0, 0};
+   glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTexSize);
+   glGetIntegerv(GL_MAX_VIEWPORT_DIMS, maxVP);
+   if(!bLayered && (2*w > maxTexSize || 2*w > maxVP[0])) return(false);
+
+   glGenTextures(1, &m_idStereoTex);
+   if(bLayered)
+   {
+      glBindTexture(GL_TEXTURE_2D_ARRAY, m_idStereoTex);
+      glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, w, h, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*)NULL);
+      glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+   }
+   else
+   {
+      bindTextureObject(m_idStereoTex);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2*w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*)NULL);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      bindTextureObject(0);
+   }
+
+   glGenFramebuffers(1, &m_idStereoFBO);
+   glBindFramebuffer(GL_FRAMEBUFFER, m_idStereoFBO);
+   if(bLayered) glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_idStereoTex, 0);
+   else glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_idStereoTex, 0);
+   bool ok = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+
+   for(int eye = 0; ok && bLayered && eye < 2; eye++)
+   {
+      glGenFramebuffers(1, &(m_idStereoReadFBO[eye]));
+      glBindFramebuffer(GL_FRAMEBUFFER, m_idStereoReadFBO[eye]);
+      glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_idStereoTex, 0, eye);
+      ok = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+   }
+   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+   if(!ok) destroyStereoFramebuffer();
+   return(ok);
+}
+
+/** Release the offscreen framebuffer used in single-pass stereo mode, if it exists. */
+void CRMVRenderer::destroyStereoFramebuffer()
+{
+   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+   for(int eye = 0; eye < 2; eye++) if(m_idStereoReadFBO[eye] != 0)
+   {
+      glDeleteFramebuffers(1, &(m_idStereoReadFBO[eye]));
+      m_idStereoReadFBO[eye] = 0;
+   }
+   if(m_idStereoFBO != 0)
+   {
+      glDeleteFramebuffers(1, &m_idStereoFBO);
+      m_idStereoFBO = 0;
+   }
+   if(m_idStereoTex != 0)
+   {
+      if(m_currBoundTexID == m_idStereoTex) bindTextureObject(0);
+      glDeleteTextures(1, &m_idStereoTex);
+      m_idStereoTex = 0;
+   }
+}
+
 /**
  Helper method for createResources(): Creates and loads the "no-op" alpha mask texture, a 4x4 texture with alpha=1 for
  all texels. It is assigned to any target that is neither an image nor movie nor requires an alpha mask. We need it 
@@ -1801,7 +3151,27 @@ bool CRMVRenderer::allocateSharedVertexArray()
 
    glBindVertexArray(m_idVAO);
    glBindBuffer(GL_ARRAY_BUFFER, m_idVBO);
-   glBufferData(GL_ARRAY_BUFFER, sizeof(float)*MAXNUMVERTS*4, NULL, GL_DYNAMIC_DRAW);
+
+   // in pipelined mode, the buffer is allocated as immutable storage and persistently mapped, if possible.
+   m_pMappedVBO = NULL;
+   GLsizeiptr bufSize = sizeof(float) * MAXNUMVERTS * 4;
+   bool bAllocated = false;
+   if(m_bPipelined)
+   {
+      PFNGLBUFFERSTORAGEPROC pBufferStorage = NULL;
+      if(::atof((const char*) glGetString(GL_VERSION)) >= 4.4 || m_pDisplay->checkGLExtension("GL_ARB_buffer_storage"))
+         pBufferStorage = (PFNGLBUFFERSTORAGEPROC) m_pDisplay->getGLProcAddress("glBufferStorage");
+      if(pBufferStorage != NULL)
+      {
+         GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+         (*pBufferStorage)(GL_ARRAY_BUFFER, bufSize, NULL, flags | GL_DYNAMIC_STORAGE_BIT);
+         bAllocated = (glGetError() == GL_NO_ERROR);
+         if(bAllocated) m_pMappedVBO = (float*) glMapBufferRange(GL_ARRAY_BUFFER, 0, bufSize, flags);
+      }
+      if(m_pMappedVBO != NULL) fprintf(stderr, "Pipelined rendering enabled: vertex buffer persistently mapped.\n");
+      else fprintf(stderr, "WARNING(CRMVRenderer): Pipelined rendering unavailable; vertex buffer not mapped.\n");
+   }
+   if(!bAllocated) glBufferData(GL_ARRAY_BUFFER, bufSize, NULL, GL_DYNAMIC_DRAW);
 
    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
    glEnableVertexAttribArray(0);
@@ -1850,131 +3220,338 @@ bool CRMVRenderer::allocateSharedVertexArray()
 }
 
 
+/**
+ Compile and link the GPU dot engine program from the vertex shader source in DOTENGINESHADERSRC. The program has no
+ fragment shader; its per-dot outputs are captured in interleaved form by transform feedback. Since the transform 
+ feedback varyings must be specified before linking, we cannot use the Shader utility class here.
+
+ @return True if successful. Otherwise, a brief error message is printed and the program ID is left at 0.
+*/
+bool CRMVRenderer::createDotEngineProgram()
+{
+   if(m_idDotEngineProg != 0) return(true);
+
+   char infoLog[1024];
+   int success = 0;
+
+   unsigned int vs = glCreateShader(GL_VERTEX_SHADER);
+   glShaderSource(vs, 1, &DOTENGINESHADERSRC, NULL);
+   glCompileShader(vs);
+   glGetShaderiv(vs, GL_COMPILE_STATUS, &success);
+   if(!success)
+   {
+      glGetShaderInfoLog(vs, 1024, NULL, infoLog);
+      fprintf(stderr, "ERROR(CRMVRenderer): Failed to compile GPU dot engine shader:\n%s\n", infoLog);
+      glDeleteShader(vs);
+      return(false);
+   }
+
+   unsigned int prog = glCreateProgram();
+   glAttachShader(prog, vs);
+   const char* varyings[] = { "outPos", "outTexCoord", "outAux" };
+   glTransformFeedbackVaryings(prog, 3, varyings, GL_INTERLEAVED_ATTRIBS);
+   glLinkProgram(prog);
+   glDeleteShader(vs);
+   glGetProgramiv(prog, GL_LINK_STATUS, &success);
+   if(!success)
+   {
+      glGetProgramInfoLog(prog, 1024, NULL, infoLog);
+      fprintf(stderr, "ERROR(CRMVRenderer): Failed to link GPU dot engine program:\n%s\n", infoLog);
+      glDeleteProgram(prog);
+      return(false);
+   }
+
+   m_dotEngineLoc.mode = glGetUniformLocation(prog, "mode");
+   m_dotEngineLoc.seed = glGetUniformLocation(prog, "seed");
+   m_dotEngineLoc.pass = glGetUniformLocation(prog, "pass");
+   m_dotEngineLoc.aperture = glGetUniformLocation(prog, "aperture");
+   m_dotEngineLoc.outerDims = glGetUniformLocation(prog, "outerDims");
+   m_dotEngineLoc.innerDims = glGetUniformLocation(prog, "innerDims");
+   m_dotEngineLoc.gaussFac = glGetUniformLocation(prog, "gaussFac");
+   m_dotEngineLoc.patDisp = glGetUniformLocation(prog, "patDisp");
+   m_dotEngineLoc.winDisp = glGetUniformLocation(prog, "winDisp");
+   m_dotEngineLoc.pctCoherent = glGetUniformLocation(prog, "pctCoherent");
+   m_dotEngineLoc.dotLife = glGetUniformLocation(prog, "dotLife");
+   m_dotEngineLoc.dotLifeDelta = glGetUniformLocation(prog, "dotLifeDelta");
+   m_dotEngineLoc.noiseMode = glGetUniformLocation(prog, "noiseMode");
+   m_dotEngineLoc.noiseUpdate = glGetUniformLocation(prog, "noiseUpdate");
+   m_dotEngineLoc.noiseLimit = glGetUniformLocation(prog, "noiseLimit");
+   m_dotEngineLoc.log2Fac = glGetUniformLocation(prog, "log2Fac");
+   m_dotEngineLoc.flowB = glGetUniformLocation(prog, "flowB");
+   m_dotEngineLoc.flowRecycleRate = glGetUniformLocation(prog, "flowRecycleRate");
+   m_dotEngineLoc.flowRecycleDR = glGetUniformLocation(prog, "flowRecycleDR");
+
+   m_idDotEngineProg = prog;
+   return(true);
+}
+
 /**
  Destroy the managed pool of texture objects used to prepare alpha mask, RGBA image, and RGB movie frame textures for
  an RMVideo target. Call this method before RMVideo exits.
 */
 void CRMVRenderer::destroyTexturePool()
 {
-   while(m_texPoolHead != NULL)
+   for(int i=0; i<TEXHASHSIZE; i++)
    {
-      TexNode* pDead = m_texPoolHead;
-      m_texPoolHead = pDead->pNext;
+      while(m_texIDTable[i] != NULL)
+      {
+         TexNode* pDead = m_texIDTable[i];
+         m_texIDTable[i] = pDead->pNextByID;
 
-      glDeleteTextures(1, &(pDead->id));
-      delete pDead;
+         glDeleteTextures(1, &(pDead->id));
+         delete pDead;
+      }
+      while(m_texClassTable[i] != NULL)
+      {
+         TexClass* pDead = m_texClassTable[i];
+         m_texClassTable[i] = pDead->pNext;
+         delete pDead;
+      }
    }
+   m_texLRUHead = m_texLRUTail = NULL;
    m_texPoolSize = 0;
    m_texPoolBytes = 0.0;
+   m_bTexPoolSettled = true;
 }
 
 /**
  Find an unused OpenGL texture object in CRMVRenderer's texture pool that matches the requirements specified, or 
- allocate a new texture object and append it to the pool.
+ allocate a new texture object and add it to the pool.
 
- It is likely that the pool will not contain an existing texture object that matches the requested dimensions exactly
- -- particularly for the RGBAIMAGETEX and RGBIMAGETEX textures backing an RMV_IMAGE and RMV_MOVIE target, respectively.
- In that situation, the method checks the total bytes of texture memory in the pool. If that exceeds 50MB, then it
- will cull unused textures to bring the byte count below 45MB (if possible) before allocating the new texture object.
+ The request is looked up by hashing its size class (type, w, h). If the class has any unused textures, the least
+ recently released one is taken -- so that recently released alpha masks remain available for reuse as is; see
+ findPooledAlphaMask(). It is likely that the pool will not contain an unused texture object that matches the 
+ requested dimensions exactly -- particularly for the RGBAIMAGETEX and RGBIMAGETEX (or YUVIMAGETEX) textures backing an
+ RMV_IMAGE and RMV_MOVIE target, respectively. In that situation, a new texture object is allocated.
 
- @param type The requested texture type, one of ALPHAMASKTEX, RGBAIMAGETEX, and RGBIMAGETEX.
+ No textures are evicted here, even if the pool exceeds its budget, since this method is typically called while targets
+ are loading. Excess textures are evicted in idle time instead; see maintainTexturePool(). While targets are loading,
+ each request is also recorded in the size class, so that maintainTexturePool() can pre-warm the pool for the next
+ load of a similar target list.
+
+ @param type The requested texture type, one of ALPHAMASKTEX, RGBAIMAGETEX, RGBIMAGETEX, and YUVIMAGETEX.
  @param w,h The requested texture width and height in pixels/texels.
  @return A texture pool node containing information about an allocated OpenGL texture object that matches the type
- and dimensions specified. The node is marked as "in use".
+ and dimensions specified. The node is marked as "in use". Returns NULL if the texture could not be allocated.
 */
 CRMVRenderer::TexNode* CRMVRenderer::getTextureNodeFromPool(int type, int w, int h)
 {
-   // find an available texture object of the right type with dimensions matching those requested
-   TexNode* pNode = m_texPoolHead;
-   TexNode* pParent = NULL;
-   while(pNode != NULL && (pNode->inUse || pNode->type != type || pNode->width != w || pNode->height != h))
+   TexClass* pClass = getTextureClass(type, w, h, true);
+   if(pClass == NULL) return(NULL);
+
+   TexNode* pNode = pClass->pFreeTail;
+   if(pNode != NULL) ++m_nTexPoolHits;
+   else pNode = allocateTextureNode(pClass);
+
+   // if successful, mark the texture node as in use. Its content is about to be replaced, so it no longer holds any
+   // previously computed alpha mask.
+   if(pNode != NULL)
    {
-      pParent = pNode;
-      pNode = pParent->pNext;
+      claimTextureNode(pNode);
+      pNode->maskKey[0] = -1.0f;
    }
+   return(pNode);
+}
 
-   // if there was no available texture node matching the requirements, AND there's too much texture memory already
-   // allocated in the pool, delete some unused textures...
-   if(pNode == NULL && m_texPoolBytes > 5.0e7)
+/**
+ Find the specified size class in the texture pool's size class hash table, optionally creating it.
+ @param type The texture type, one of ALPHAMASKTEX, RGBAIMAGETEX, RGBIMAGETEX, and YUVIMAGETEX.
+ @param w,h The texture width and height in pixels/texels.
+ @param bCreate If true, the size class is created if it does not yet exist.
+ @return The size class, or NULL if not found (or if memory allocation failed).
+*/
+CRMVRenderer::TexClass* CRMVRenderer::getTextureClass(int type, int w, int h, bool bCreate)
+{
+   unsigned int hash = (unsigned int) type * 73856093u ^ (unsigned int) w * 19349663u ^ (unsigned int) h * 83492791u;
+   TexClass** ppBucket = &(m_texClassTable[hash % TEXHASHSIZE]);
+   TexClass* pClass = *ppBucket;
+   while(pClass != NULL && (pClass->type != type || pClass->width != w || pClass->height != h)) pClass = pClass->pNext;
+   if(pClass != NULL || !bCreate) return(pClass);
+
+   pClass = new TexClass;
+   if(pClass != NULL)
    {
-      TexNode* pCurr = m_texPoolHead;
-      pParent = NULL;
-      while(pCurr != NULL && m_texPoolBytes > 4.5e7)
+      pClass->type = type;
+      pClass->width = w;
+      pClass->height = h;
+      pClass->bytes = double(w) * double(h) * ((type==RGBAIMAGETEX) ? 4 : (type==RGBIMAGETEX ? 3 : 1));
+      pClass->nNodes = 0;
+      pClass->nWarm = 0;
+      pClass->pFreeHead = pClass->pFreeTail = NULL;
+      pClass->pNext = *ppBucket;
+      *ppBucket = pClass;
+   }
+   return(pClass);
+}
+
+/**
+ Allocate a new OpenGL texture object in the specified size class and add it to the texture pool. The new texture is
+ unused, and it becomes the most recently released texture in its class and in the pool.
+ @param pClass The size class.
+ @return The texture pool node, or NULL if the texture could not be allocated.
+*/
+CRMVRenderer::TexNode* CRMVRenderer::allocateTextureNode(TexClass* pClass)
+{
+   TexNode* pNode = new TexNode;
+   if(pNode == NULL) return(NULL);
+
+   int type = pClass->type;
+   int w = pClass->width;
+   int h = pClass->height;
+   unsigned int texID = 0;
+   glGenTextures(1, &texID);
+   bindTextureObject(texID);
+   GLint internFmt = (type==ALPHAMASKTEX) ? GL_RED : (type==YUVIMAGETEX ? GL_R8 : 
+         (type==RGBAIMAGETEX ? GL_RGBA8 : GL_RGB8));
+   GLenum fmt = (type==ALPHAMASKTEX || type==YUVIMAGETEX) ? GL_RED : (type==RGBAIMAGETEX ? GL_RGBA : GL_RGB);
+   GLint actualLen = 0;
+   glTexImage2D(GL_PROXY_TEXTURE_2D, 0, internFmt, w, h, 0, fmt, GL_UNSIGNED_BYTE, (GLvoid*)NULL);
+   glGetTexLevelParameteriv(GL_PROXY_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &actualLen);
+   if(actualLen == 0)
+   {
+      delete pNode;
+      bindTextureObject(0);
+      glDeleteTextures(1, &texID);
+      return(NULL);
+   }
+
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glTexImage2D(GL_TEXTURE_2D, 0, internFmt, w, h, 0, fmt, GL_UNSIGNED_BYTE, (GLvoid*)NULL);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+   bindTextureObject(0);
+
+   pNode->type = type;
+   pNode->id = texID;
+   pNode->width = w;
+   pNode->height = h;
+   pNode->inUse = false;
+   pNode->maskKey[0] = -1.0f;
+   pNode->pClass = pClass;
+
+   pNode->pNextByID = m_texIDTable[texID % TEXHASHSIZE];
+   m_texIDTable[texID % TEXHASHSIZE] = pNode;
+
+   pNode->pPrevFree = NULL;
+   pNode->pNextFree = pClass->pFreeHead;
+   if(pClass->pFreeHead != NULL) pClass->pFreeHead->pPrevFree = pNode;
+   else pClass->pFreeTail = pNode;
+   pClass->pFreeHead = pNode;
+
+   pNode->pNewer = NULL;
+   pNode->pOlder = m_texLRUHead;
+   if(m_texLRUHead != NULL) m_texLRUHead->pNewer = pNode;
+   else m_texLRUTail = pNode;
+   m_texLRUHead = pNode;
+
+   ++pClass->nNodes;
+   m_texPoolBytes += pClass->bytes;
+   ++m_texPoolSize;
+   ++m_nTexPoolAllocs;
+   m_bTexPoolSettled = false;
+   return(pNode);
+}
+
+/**
+ Mark an unused texture in the texture pool as in use, removing it from the unused texture lists. While targets are
+ being loaded, the texture is also counted among those needed by the target list (see maintainTexturePool()).
+ @param pNode The texture pool node. Must be unused.
+*/
+void CRMVRenderer::claimTextureNode(TexNode* pNode)
+{
+   unlinkFreeTextureNode(pNode);
+   pNode->inUse = true;
+   if(m_bTexPoolRecordWarm) ++pNode->pClass->nWarm;
+}
+
+/**
+ Remove an unused texture from the list of unused textures in its size class and from the pool's least-recently-
+ released list.
+ @param pNode The texture pool node. Must be unused.
+*/
+void CRMVRenderer::unlinkFreeTextureNode(TexNode* pNode)
+{
+   TexClass* pClass = pNode->pClass;
+   if(pNode->pPrevFree != NULL) pNode->pPrevFree->pNextFree = pNode->pNextFree;
+   else pClass->pFreeHead = pNode->pNextFree;
+   if(pNode->pNextFree != NULL) pNode->pNextFree->pPrevFree = pNode->pPrevFree;
+   else pClass->pFreeTail = pNode->pPrevFree;
+   pNode->pPrevFree = pNode->pNextFree = NULL;
+
+   if(pNode->pNewer != NULL) pNode->pNewer->pOlder = pNode->pOlder;
+   else m_texLRUHead = pNode->pOlder;
+   if(pNode->pOlder != NULL) pNode->pOlder->pNewer = pNode->pNewer;
+   else m_texLRUTail = pNode->pNewer;
+   pNode->pNewer = pNode->pOlder = NULL;
+}
+
+/**
+ Evict an unused texture from the texture pool, deleting the OpenGL texture object.
+ @param pNode The texture pool node. Must be unused. It is destroyed.
+*/
+void CRMVRenderer::evictTextureNode(TexNode* pNode)
+{
+   unlinkFreeTextureNode(pNode);
+
+   TexNode** ppPrev = &(m_texIDTable[pNode->id % TEXHASHSIZE]);
+   while(*ppPrev != NULL && *ppPrev != pNode) ppPrev = &((*ppPrev)->pNextByID);
+   if(*ppPrev != NULL) *ppPrev = pNode->pNextByID;
+
+   if(m_currBoundTexID == pNode->id) bindTextureObject(0);
+   glDeleteTextures(1, &(pNode->id));
+   --pNode->pClass->nNodes;
+   m_texPoolBytes -= pNode->pClass->bytes;
+   --m_texPoolSize;
+   ++m_nTexPoolEvictions;
+   delete pNode;
+}
+
+/**
+ Perform a small unit of maintenance on the texture pool. Call this method on the GL thread while RMVideo is idle and
+ no command is pending; it returns immediately if there is nothing to do.
+
+ Texture objects are never evicted while targets are loading, so the pool may grow beyond its budget (see 
+ setTexturePoolBudget()). Here, unused textures are evicted, least recently released first, until the pool is back
+ within budget. Textures needed by the most recently loaded target list are spared unless there is no other way to
+ meet the budget.
+
+ Then, if any of the textures needed by the most recently loaded target list have been evicted, one of them is 
+ allocated anew -- pre-warming the pool for the next target list, which is usually the same or similar (eg, in a trial
+ set), so that loadTargets() need not allocate it. Only one texture is allocated per call, so that a command arriving in
+ the meantime is not delayed; pre-warming never takes the pool over budget.
+
+ @return True if there is more work to do, in which case the caller should invoke the method again soon; else false.
+*/
+bool CRMVRenderer::maintainTexturePool()
+{
+   if(m_bTexPoolSettled) return(false);
+
+   for(int pass=0; pass<2 && m_texPoolBytes > m_texPoolBudget; pass++)
+   {
+      TexNode* pNode = m_texLRUTail;
+      while(pNode != NULL && m_texPoolBytes > m_texPoolBudget)
       {
-         if(!pCurr->inUse)
-         {
-            TexNode* pDead = pCurr;
-            pCurr = pDead->pNext;
-            if(pParent != NULL) pParent->pNext = pCurr;
-            else m_texPoolHead = pCurr;
-            
-            double byteCount = pDead->width * pDead->height;
-            byteCount *= (pDead->type==RGBAIMAGETEX) ? 4 : (pDead->type==RGBIMAGETEX ? 3 : 1);
-
-            glDeleteTextures(1, &(pDead->id));
-            delete pDead;
-            m_texPoolBytes -= byteCount;
-            --m_texPoolSize;
-         }
-         else
-         {
-            pParent = pCurr;
-            pCurr = pCurr->pNext;
-         }
+         TexNode* pNewer = pNode->pNewer;
+         if(pass == 1 || pNode->pClass->nNodes > pNode->pClass->nWarm) evictTextureNode(pNode);
+         pNode = pNewer;
       }
    }
 
-   // no available texture object matches the requirements, so allocate a new one that does and append it to the pool
-   if(pNode == NULL)
+   for(int i=0; i<TEXHASHSIZE; i++)
    {
-      pNode = new TexNode;
-      if(pNode != NULL)
+      for(TexClass* pClass = m_texClassTable[i]; pClass != NULL; pClass = pClass->pNext)
       {
-         unsigned int texID = 0;
-         glGenTextures(1, &texID);
-         bindTextureObject(texID);
-         GLint internFmt = (type==ALPHAMASKTEX) ? GL_RED : (type==RGBAIMAGETEX ? GL_RGBA8 : GL_RGB8);
-         GLenum fmt = (type==ALPHAMASKTEX) ? GL_RED : (type==RGBAIMAGETEX ? GL_RGBA : GL_RGB);
-         GLint actualLen = 0;
-         glTexImage2D(GL_PROXY_TEXTURE_2D, 0, internFmt, w, h, 0, fmt, GL_UNSIGNED_BYTE, (GLvoid*)NULL);
-         glGetTexLevelParameteriv(GL_PROXY_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &actualLen);
-         if(actualLen == 0)
+         if(pClass->nNodes < pClass->nWarm && m_texPoolBytes + pClass->bytes <= m_texPoolBudget)
          {
-            delete pNode;
-            pNode = NULL;
-            bindTextureObject(0);
-            glDeleteTextures(1, &texID);
-         }
-         else
-         {
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-            glTexImage2D(GL_TEXTURE_2D, 0, internFmt, w, h, 0, fmt, GL_UNSIGNED_BYTE, (GLvoid*)NULL);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            bindTextureObject(0);
-
-            pNode->type = type;
-            pNode->id = texID;
-            pNode->width = w;
-            pNode->height = h;
-            pNode->inUse = false;
-            pNode->pNext = NULL;
-
-            // append new node to end of singly linked list. The list could be empty!
-            if(pParent == NULL) m_texPoolHead = pNode;
-            else pParent->pNext = pNode;
-            double byteCount = pNode->width * pNode->height;
-            byteCount *= (pNode->type==RGBAIMAGETEX) ? 4 : (pNode->type==RGBIMAGETEX ? 3 : 1);
-            m_texPoolBytes += byteCount;
-            ++m_texPoolSize;
+            if(allocateTextureNode(pClass) != NULL) return(true);
+            pClass->nWarm = pClass->nNodes;
          }
       }
    }
 
-   // if successful, mark the texture node as in use
-   if(pNode != NULL) pNode->inUse = true;
-   return(pNode);
+   m_bTexPoolSettled = true;
+   return(false);
 }
 
@@ -10,11 +10,38 @@
 
 #include "shader.h"                    // shader program support
 #include "vidbuffer.h"                 // helper class buffers video on a background thread
+#include "workerpool.h"                // helper class manages a pool of worker threads
+#include "frametelemetry.h"            // helper class records per-frame timing during animation sequences
 #include "rmvideo_common.h"            // basic constants/definitions shared w/Maestro
 #include "rmvtarget.h"                 // CRMVTarget -- Defines a generic RMVideo target.
 
 class CRMVDisplay;                     // forward declaration
 
+// parameters for one pass of the GPU dot engine, which animates RMV_RANDOMDOTS and RMV_FLOWFIELD entirely on the GPU.
+// See CRMVRenderer::runGPUDotEngine().
+struct GPUDotPass
+{
+   int mode;                           // pass mode: GPUDOT_INITDOTS, _UPDATEDOTS, _INITFLOW, or _UPDATEFLOW
+   unsigned int seed;                  // seed and pass number form the key for the counter-based RNG
+   unsigned int pass;
+   int aperture;                       // RMV_RANDOMDOTS aperture type
+   float outerW, outerH;               // RMV_RANDOMDOTS: outer aperture dims; RMV_FLOWFIELD: outer radius in outerW
+   float innerW, innerH;               // RMV_RANDOMDOTS: inner aperture dims; RMV_FLOWFIELD: inner radius in innerW
+   float gaussX, gaussY;               // -1/(2*SX*SX) and -1/(2*SY*SY), or 0 if corresponding sigma is 0
+   float patX, patY;                   // pattern displacement for this update (deg)
+   float winX, winY;                   // window displacement subtracted from dot displacement (RMV_F_WRTSCREEN)
+   float pctCoherent;                  // percent coherence (feature disabled if >= 100)
+   float dotLife;                      // max dot life (feature disabled if 0) and the decrement for this update
+   float dotLifeDelta;
+   int noiseMode;                      // per-dot noise: 0 = none, 1 = direction, 2 = additive speed, 3 = 2^X speed
+   bool noiseUpdate;                   // if set, per-dot noise factors are re-chosen in this pass
+   float noiseLimit;                   // noise range limit N: noise factors chosen uniformly over (-N..N)
+   float log2Fac;                      // E(2^X) for the multiplicative speed noise
+   float flowB;                        // RMV_FLOWFIELD: animation factor B, recycle rate and ring for decel flows
+   float flowRecycleRate;
+   float flowRecycleDR;
+};
+
 
 class CRMVRenderer
 {
@@ -22,6 +49,8 @@ private:
    // the vertex and fragment shader source code in string form
    static const char* VERTEXSHADERSRC;
    static const char* FRAGMENTSHADERSRC;
+   // vertex shader source code for the GPU dot engine (transform feedback only, no fragment shader)
+   static const char* DOTENGINESHADERSRC;
 
 public:
    CRMVRenderer();
@@ -33,21 +62,76 @@ public:
    // release GLSL shader programs and other target rendering resources. Invoke at shutdown.
    void releaseResources();
 
+   // enable/disable pipelined vertex streaming. Takes effect the next time resources are created.
+   void setPipelinedMode(bool enable) { m_bPipelined = enable; }
+   bool isPipelinedMode() { return(m_bPipelined); }
+
+   // enable/disable the GPU dot engine for RMV_RANDOMDOTS and _FLOWFIELD. Takes effect the next time resources are 
+   // created. The engine is available only if its shader program was successfully built.
+   void setGPUDotEngineMode(bool enable) { m_bGPUDotsRequested = enable; }
+   bool isGPUDotEngineAvailable() { return(m_idDotEngineProg != 0); }
+
+   // enable/disable zero-copy streaming of RMV_MOVIE frames. Takes effect the next time resources are created. It is
+   // available only if persistently mapped buffers are supported (OpenGL 4.4 or GL_ARB_buffer_storage).
+   void setZeroCopyMovieMode(bool enable) { m_bZeroCopyRequested = enable; }
+   bool isZeroCopyMovieMode() { return(m_pfnBufferStorage != NULL); }
+
+   // enable/disable analytic apertures: the aperture and Gaussian window of RMV_SPOT, _GRATING and _PLAID targets are
+   // computed per fragment rather than by an alpha mask texture. Takes effect the next time resources are created.
+   void setAnalyticApertureMode(bool enable) { m_bAnalyticApertures = enable; }
+   bool isAnalyticApertureMode() { return(m_bAnalyticApertures); }
+
+   // single-pass stereo modes: in stereo mode, both eyes are rendered in one instanced pass into an offscreen 
+   // framebuffer -- two layers of a layered framebuffer, or the two halves of a double-wide framebuffer -- which is
+   // then resolved to the left and right backbuffers. With STEREO_TWOPASS, each eye is drawn directly in its own
+   // backbuffer.
+   static const int STEREO_TWOPASS = 0;
+   static const int STEREO_LAYERED = 1;
+   static const int STEREO_SIDEBYSIDE = 2;
+   // select the single-pass stereo mode. Takes effect the next time resources are created, and only if stereo mode is
+   // enabled. STEREO_LAYERED falls back to STEREO_SIDEBYSIDE if layered rendering is not supported.
+   void setSinglePassStereoMode(int mode) { m_iStereoPassRequested = mode; }
+   int getSinglePassStereoMode() { return(m_iStereoPass); }
+
+   // create/release a persistently mapped pixel buffer that holds a movie's entire frame queue (zero-copy mode only)
+   unsigned int createMovieFrameStore(int nBytes, unsigned char** ppMapped);
+   void releaseMovieFrameStore(unsigned int pboID);
+
+   // GPU dot engine pass modes
+   static const int GPUDOT_INITDOTS;
+   static const int GPUDOT_UPDATEDOTS;
+   static const int GPUDOT_INITFLOW;
+   static const int GPUDOT_UPDATEFLOW;
+
+   // create/release the pair of ping-pong vertex arrays and buffers holding a dot target's state for the GPU engine
+   bool createGPUDotBuffers(int nDots, unsigned int* pVAOs, unsigned int* pVBOs);
+   void releaseGPUDotBuffers(unsigned int* pVAOs, unsigned int* pVBOs);
+
+   // run one pass of the GPU dot engine, reading dot state from one buffer and writing it to the other
+   void runGPUDotEngine(const GPUDotPass& params, unsigned int srcVAO, unsigned int dstVBO, int nDots);
+
+   // draw a contiguous range of dots from a GPU dot engine vertex array
+   void drawGPUDots(unsigned int vao, int start, int n);
+
    // reserve a contiguous portion of the shared vertex array for streaming vertex attributes
    int reserveSharedVertexArraySegment(int n);
    
    // upload vertex attributes to a specified portion of the shared vertex array (dot targets only)
    void uploadVertexData(int start, int count, float* pSrc);
 
-   // prepare alpha mask texture object
+   // prepare alpha mask texture object, optionally from a mask precomputed off the GL thread
    unsigned int prepareAlphaMaskTexture(int aperture, double w, double h, double iw, double ih, 
-         double sigX, double sigY);
+         double sigX, double sigY, const unsigned char* pTexels = NULL);
+   unsigned char* precomputeAlphaMask(int aperture, double w, double h, double iw, double ih, double sigX, double sigY);
 
-   // retrieve image from a specified source file in the RMVideo media store
-   unsigned char* getImage(const char* folder, const char* file, int& w, int& h);
+   // retrieve image from a specified source file in the RMVideo media store, optionally pinning it in the image cache
+   unsigned char* getImage(const char* folder, const char* file, int& w, int& h, bool bPin = false);
+   void unpinImage(const char* folder, const char* file);
 
    // prepare texture object to hold image or movie frame
    unsigned int prepareImageTexture(bool rgba, int w, int h, unsigned char* pImg);
+   // prepare texture object to hold a movie frame in planar YUV 4:2:0 format
+   unsigned int prepareYUVFrameTexture(int w, int h);
 
    // release an OpenGL texture object previously prepared via one of the prepare***Texture() methods
    void releaseTexture(unsigned int texID);
@@ -56,15 +140,22 @@ public:
    double getTexturePoolKB() { return(m_texPoolBytes/1024.0); }
    // return total # of texture objects currently reserved in the renderer's texture object pool
    int getTexturePoolSize() { return(m_texPoolSize); }
+   // set the texture memory budget for the texture object pool, in MB (default 50MB); must call before start()
+   void setTexturePoolBudget(int nMB) { if(nMB > 0) m_texPoolBudget = double(nMB) * 1024.0 * 1024.0; }
+   // idle-time maintenance of the texture object pool: evict unused textures over budget, and pre-warm the textures
+   // needed by the most recently loaded target list. Returns true if there is more work to do.
+   bool maintainTexturePool();
 
-   // uploads a movie frame to the specified texture object
-   void uploadMovieFrameToTexture(unsigned int texID, int w, int h, unsigned char* pFrame);
+   // uploads a movie frame (RGB24 or YUV 4:2:0) to the specified texture object
+   void uploadMovieFrameToTexture(unsigned int texID, int w, int h, unsigned char* pFrame, bool isYUV = false);
 
    // obtain a precise measure of the monitor's vertical refresh period (over a 500-frame epoch)
    bool measureFramePeriod(int nomRateHz);
    
    // the monitor's vertical refresh period in seconds (with sub-microsec accuracy, hopefully!)
    double getFramePeriod() { return(m_dFramePeriod); }
+   // set the refresh period directly, in seconds. Headless mode only, since there is no vertical refresh to measure.
+   void setFramePeriod(double p) { if(p > 0.0) m_dFramePeriod = p; }
    
    // update the current display geometry
    void updateDisplayGeometry(int w, int h, int d);
@@ -96,11 +187,25 @@ public:
    // the runtime loop during an animation sequence
    int animate();
 
+   // summarize frame-timing telemetry for the most recent animation sequence and texture pool statistics, as specified
+   // for RMV_CMD_GETFRAMESTATS
+   void getFrameStats(int* pStats);
+   // enable/disable export of frame-timing telemetry to a CSV file (TELEMETRYFILE) after each animation sequence
+   void enableTelemetryExport(bool enable) { m_bTelemetryExport = enable; }
+   // enable/disable late latching of target updates: if the next RMV_CMD_UPDATEFRAME has not arrived when a frame
+   // starts, wait for it as long as the frame can still be rendered in time (see animate())
+   void setLateLatchMode(bool enable) { m_bLateLatch = enable; }
+   bool isLateLatchMode() { return(m_bLateLatch); }
+
    // helper methods called by CRMVTarget to render a target
-   void updateCommonUniforms(int type, float x, float y, float w, float h, float rot);
+   void useTargetProgram(int type, bool isYUV, bool isSine, bool isWindowed);
+   void updateCommonUniforms(float x, float y, float w, float h, float rot, float disp = 0.0f);
    void updateTargetColorUniform(double r, double g, double b);
-   void updateGratingUniforms(float x, float y, bool isSine, double* pMean0, double* pCon0, 
-      double* pMean1, double* pCon1, float* pAngle, float* pPeriodX, float *pPeriodY, float* pPhase);
+   void updateYUVFrameUniforms(int w, int h, bool fullRange);
+   void updateGratingUniforms(float x, float y, double* pMean0, double* pCon0, double* pMean1, double* pCon1, 
+      float* pAngle, float* pPeriodX, float *pPeriodY, float* pPhase);
+   void updateWindowUniforms(float x, float y, int aperture, float w, float h, float iw, float ih, 
+      float sigX, float sigY);
    void bindTextureObject(unsigned int texID);
    void setPointSize(int sz);
    void drawPrimitives(bool isPts, bool isLine, int start, int n);
@@ -109,8 +214,55 @@ private:
    // a reference to the RMVideo display manager (to access display info, comm link, perform front-back buffer swap)
    CRMVDisplay* m_pDisplay;
 
-   // the shader program used for all rendering in RMVideo 
-   Shader* m_pShader;
+   // the shader programs used for all target rendering in RMVideo: compile-time specializations of a single source,
+   // one per class of target (see FRAGMENTSHADERSRC). All share the same vertex shader.
+   static const int PROG_MASK = 0;        // RMV_POINT, _BAR, _SPOT, _FLOWFIELD: target color, alpha mask texture
+   static const int PROG_DOTS = 1;        // RMV_RANDOMDOTS: per-dot alpha
+   static const int PROG_IMAGE = 2;       // RMV_IMAGE, RGB(A) RMV_MOVIE: texture mapped onto target quad
+   static const int PROG_YUV = 3;         // YUV 4:2:0 RMV_MOVIE: texture holds Y,U,V planes, converted to RGB
+   static const int PROG_SQGRAT = 4;      // RMV_GRATING, RMV_PLAID, with squarewave or sinewave gratings
+   static const int PROG_SINEGRAT = 5;
+   static const int PROG_SQPLAID = 6;
+   static const int PROG_SINEPLAID = 7;
+   static const int PROG_WINSPOT = 8;     // RMV_SPOT, _GRATING, _PLAID with analytic aperture and Gaussian window
+   static const int PROG_WINSQGRAT = 9;
+   static const int PROG_WINSINEGRAT = 10;
+   static const int PROG_WINSQPLAID = 11;
+   static const int PROG_WINSINEPLAID = 12;
+   static const int NUMTGTPROGS = 13;
+   Shader* m_pShaders[NUMTGTPROGS];
+   int m_iCurrProg;                    // index of the target program currently in use, or -1 if none
+
+   // locations of each target program's uniforms, resolved once after the program is linked. A uniform that is not
+   // used by a given specialization has location -1 (uploads to it are silently ignored).
+   struct TargetUniforms
+   {
+      int xfm, tgtC, ctr, mean0, con0, mean1, con1, dx, dy, phase, yuvDims, yuvFullRange, aperture, apDims, gaussFac;
+      int eyeDx, eyeW;
+   };
+   TargetUniforms m_tgtLoc[NUMTGTPROGS];
+   // last value uploaded to the uniform "tgtC" in each target program, so that redundant uploads can be skipped
+   float m_currTgtC[NUMTGTPROGS][3];
+   // last value uploaded to the uniform "eyeDx" in each target program (single-pass stereo only)
+   float m_currEyeDx[NUMTGTPROGS];
+
+   // single-pass stereo: requested and actual mode; the framebuffer in which both eyes are rendered and its color 
+   // buffer (a 2-layer texture array, or a double-wide texture); in layered mode, a read framebuffer for each layer
+   int m_iStereoPassRequested;
+   int m_iStereoPass;
+   unsigned int m_idStereoTex;
+   unsigned int m_idStereoFBO;
+   unsigned int m_idStereoReadFBO[2];
+
+   // the GPU dot engine: program ID (0 if engine not available) and uniform locations
+   bool m_bGPUDotsRequested;
+   unsigned int m_idDotEngineProg;
+   struct DotEngineUniforms
+   {
+      int mode, seed, pass, aperture, outerDims, innerDims, gaussFac, patDisp, winDisp, pctCoherent;
+      int dotLife, dotLifeDelta, noiseMode, noiseUpdate, noiseLimit, log2Fac, flowB, flowRecycleRate, flowRecycleDR;
+   };
+   DotEngineUniforms m_dotEngineLoc;
 
    // texture ID for the default "no-op" alpha mask texture (4x4, alpha=1 for all texels)
    unsigned int m_NoOpAlphaMaskID;
@@ -118,12 +270,19 @@ private:
    static const int MAXTEXMASKDIM;     // limit to either dimension of an alpha mask texture
    GLubyte* m_pMaskTexels;             // buffer for computing alpha mask textures
 
-   // texture object pool intended to avoid frequent allocation/deallocation of texture objects. Implemented as a 
-   // singly-linked list. Note that there are 3 distinct kinds of texture objects: alpha mask textures, RGBA image
-   // textures, and RGB image textures for movie frames.
+   // texture object pool intended to avoid frequent allocation/deallocation of texture objects. Note that there are 4
+   // distinct kinds of texture objects: alpha mask textures, RGBA image textures, RGB image textures for movie frames,
+   // and single-component textures for YUV 4:2:0 movie frames. Textures of the same type and dimensions form a size
+   // class, found by hashing (type, w, h); each class keeps a list of its unused textures, so a request is satisfied 
+   // without scanning the pool. Another hash table maps texture ID to pool node for releaseTexture(). All unused 
+   // textures are also kept on a least-recently-released list, from which textures are evicted in idle time when the
+   // pool exceeds its budget. See maintainTexturePool().
    static const int ALPHAMASKTEX;
    static const int RGBAIMAGETEX;
    static const int RGBIMAGETEX;
+   static const int YUVIMAGETEX;
+   static const int TEXHASHSIZE = 64;  // # of buckets in the size class and texture ID hash tables
+   struct TexClass;
    struct TexNode
    {
       int type;
@@ -131,12 +290,45 @@ private:
       int height;
       unsigned int id;
       bool inUse;
-      TexNode* pNext;
+      float maskKey[7];                // ALPHAMASKTEX: {aperture, w, h, iw, ih, sigX, sigY} of mask currently loaded
+      TexClass* pClass;                // the node's size class
+      TexNode* pNextByID;              // next node in the same bucket of the texture ID hash table
+      TexNode* pPrevFree;              // unused nodes in the same size class, most recently released first
+      TexNode* pNextFree;
+      TexNode* pNewer;                 // all unused nodes in the pool, most recently released first
+      TexNode* pOlder;
    };
-   TexNode* m_texPoolHead;
+   struct TexClass
+   {
+      int type;
+      int width;
+      int height;
+      double bytes;                    // texture memory needed by one texture in this class
+      int nNodes;                      // # of textures in this class, in use or not
+      int nWarm;                       // # of textures in this class needed by the most recently loaded target list
+      TexNode* pFreeHead;              // unused textures in this class, most recently released first
+      TexNode* pFreeTail;
+      TexClass* pNext;                 // next class in the same bucket of the size class hash table
+   };
+   TexClass* m_texClassTable[TEXHASHSIZE];
+   TexNode* m_texIDTable[TEXHASHSIZE];
+   TexNode* m_texLRUHead;              // most recently released unused texture
+   TexNode* m_texLRUTail;              // least recently released unused texture
+
+   // alpha mask helpers: texture dimensions, lookup of a pooled texture already holding a mask, mask computation
+   void getAlphaMaskDims(double w, double h, int& texWPix, int& texHPix);
+   TexNode* findPooledAlphaMask(const float* key, int texWPix, int texHPix);
+   static void computeAlphaMask(int aperture, double w, double h, double iw, double ih, double sigX, double sigY,
+         int texWPix, int texHPix, unsigned char* pTexels);
    
    int m_texPoolSize;                  // total number of textures in pool
    double m_texPoolBytes;              // total number of bytes of texture memory reserved in pool
+   double m_texPoolBudget;             // pool budget in bytes; unused textures are evicted in idle time to honor it
+   bool m_bTexPoolSettled;             // set when idle-time maintenance of the pool has nothing left to do
+   bool m_bTexPoolRecordWarm;          // set while loading targets, to record the texture needs of the target list
+   int m_nTexPoolHits;                 // # of texture requests satisfied by an unused texture in pool, since startup
+   int m_nTexPoolAllocs;               // # of texture objects allocated, since startup (includes pre-warmed textures)
+   int m_nTexPoolEvictions;            // # of unused texture objects evicted from the pool, since startup
    
    // GL IDs for vertex array and backing buffer shared across all targets being animated
    unsigned int m_idVAO;
@@ -145,6 +337,18 @@ private:
    // starting index of the unused portion of the vertex array shared across all targets being animated.
    int m_idxVertexArrayFree;
 
+   // pipelined mode: when supported, the shared vertex buffer is persistently mapped so that dot vertex uploads are a
+   // simple memory copy. The GPU is idle at the start of each frame (glFinish() after every swap), so no fences needed.
+   bool m_bPipelined;                  // pipelined mode requested
+   float* m_pMappedVBO;                // persistent mapping of the shared vertex buffer, or NULL if not mapped
+
+   // zero-copy movie mode: RMV_MOVIE frames are decoded directly into persistently mapped pixel buffers
+   bool m_bZeroCopyRequested;          // zero-copy movie mode requested
+   bool m_bAnalyticApertures;          // analytic aperture mode enabled
+   int m_nMasksComputed;               // # of alpha masks computed, and # reused from texture pool, since last load
+   int m_nMasksReused;
+   PFNGLBUFFERSTORAGEPROC m_pfnBufferStorage;   // glBufferStorage(), or NULL if zero-copy mode unavailable
+
    static const int MAXNUMVERTS;       // maximum number of vertices than can be stored in shared vertex array
 public:
    static const int QUADINDEX;         // start index of fixed quad primitive in shared vertex array
@@ -201,22 +405,86 @@ private:
    int m_nTargets;
    CRMVTarget** m_pTargetList;
 
+   // pool of worker threads that parallelizes the target update stage of the animation loop, plus supporting state
+   CWorkerPool m_workerPool;
+   static const int MINPARALLELTGTS;   // min # of targets that can be updated off GL thread to engage worker pool
+   RMVTGTVEC* m_pTgtVecs;              // the motion vectors for the next frame, one per target
+   bool* m_pTgtUpdateOK;               // result of the last updateMotion() call, one per target
+   int* m_pOffGLTgts;                  // indices of targets that can be updated on a worker thread
+   int m_nOffGLTgts;
+   float m_fUpdateElapsedMS;           // elapsed time passed to updateMotion() for the update in progress
+   float* m_pTgtUpdateUS;              // duration of the last updateMotion() call in microseconds, one per target
+
+   // while targets are loaded: each target's definition, and the outcome and cost of its preparation stages
+   struct TgtLoadJob
+   {
+      RMVTGTDEF tgtDef;                // the target definition retrieved from the IO link
+      bool bOk;                        // result of CRMVTarget::prepare()
+      float prepUS;                    // duration of CRMVTarget::prepare() and completeInitialization(), in us
+      float glUS;
+   };
+   TgtLoadJob* m_pLoadJobs;
+
+   // per-frame timing telemetry for the current or most recent animation sequence, optionally exported to a file
+   CFrameTelemetry m_telemetry;
+   static const char* TELEMETRYFILE;   // telemetry export file (in current working directory)
+   bool m_bTelemetryExport;            // if set, telemetry is appended to export file after each animation sequence
+   int m_nAnimSeqs;                    // # of animation sequences run thus far
+
+   bool m_bLateLatch;                  // late latching of target updates enabled
+   static const double LATCHMARGINUS;  // late latch: safety margin before the latest time to start next frame, in us
+
 private:
+   // update all targets IAW the next set of motion vectors, using the worker pool when appropriate
+   bool updateTargets(float tElapsed);
+   // job function for the worker pool: update one of the targets that can be updated off the GL thread
+   static void updateTargetJob(void* pArg, int iJob);
+   // job function for the worker pool: prepare one of the targets being loaded
+   static void prepareTargetJob(void* pArg, int iJob);
+
    // recalculate logical dimensions of the photodiode sync flash spot
    void recalcSyncFlashGeometry();
 
    // render the photodiode sync flash spot
    void drawSyncFlashSpot();
 
+   // render a frame on the backbuffer (both backbuffers in stereo mode): clear to the current background color, draw
+   // all targets (if requested), then the sync flash spot
+   void renderFrame(bool bTargets);
+   // issue a draw call for the current target program -- for both eyes at once in single-pass stereo mode
+   void drawArraysPerEye(GLenum mode, int start, int n);
+   // single-pass stereo: create/destroy the offscreen framebuffer; resolve a rendered frame to the backbuffers
+   bool createStereoFramebuffer();
+   void destroyStereoFramebuffer();
+   void resolveStereoFrame();
+
    // create the default "no-op" alpha mask texture 
    bool generateNoOpAlphaMaskTexture();
 
    // allocate and initialize the vertex array and backing buffer shared across all targets being animated
    bool allocateSharedVertexArray();
 
+   // compile and link the GPU dot engine's transform feedback program
+   bool createDotEngineProgram();
+
+   // compile and link the specialized target programs; resolve their uniform locations
+   bool createTargetPrograms();
+   void resolveTargetUniforms(int iProg);
+   // make the specified target program current, if it is not already
+   void selectTargetProgram(int iProg);
+   // upload the "tgtC" uniform of the current target program only if its value has changed
+   void setTargetColorUniform(float r, float g, float b);
+   // single-pass stereo only: upload the "eyeDx" uniform of the current target program if its value has changed
+   void setStereoDisparityUniform(float dx);
+
    // manage a pool of texture objects used for alpha mask, RGBA image, and RGB movie frame textures
    void destroyTexturePool();
    TexNode* getTextureNodeFromPool(int type, int w, int h);
+   TexClass* getTextureClass(int type, int w, int h, bool bCreate);
+   TexNode* allocateTextureNode(TexClass* pClass);
+   void claimTextureNode(TexNode* pNode);
+   void unlinkFreeTextureNode(TexNode* pNode);
+   void evictTextureNode(TexNode* pNode);
 };
 
 
@@ -169,8 +169,8 @@ textures, more OGL state changes) that leads to poorer performance.
  RMV_SPOT, _GRATING, and _PLAID. Instead, on every frame, we compute each dot's alpha based on its current location and
  the aperture type. If a dot's center lies outside the aperture, its alpha is 0, else it is 1 (unless a Gaussian mask
  is specified, of course). The per-dot alpha is stored in the vertex attribute that normally holds the X-coordinate Tx
- of the dot's corresponding texel location. The monolithic fragment shader handles this special case, ignoring the 
- result of the texture operation and setting the fragment alpha to Tx.
+ of the dot's corresponding texel location. The fragment shader of the RMV_RANDOMDOTS target program handles this 
+ special case, skipping the texture operation and setting the fragment alpha to Tx.
 
 ==> Implementation Notes for RMV_FLOWFIELD
  The RMVideo target type RMV_FLOWFIELD represents a simple optical flow field of randomly located dots flowing radially
@@ -267,6 +267,44 @@ textures, more OGL state changes) that leads to poorer performance.
  16dec2024-- To support stereo experiments with the dot targets RMV_POINT, _FLOWFIELD, and _RANDOMDOTS, draw() now
  takes a parameter 'eye' such that the target center is horizontally offset by 'eye*RMVTGTDEF.fDotDisp'. For all other
  target types and for dot targets with fDotDisp = 0, this argument has no effect.
+ 16oct2026-- Reworked updateRandomDots() for performance, since several 9999-dot RMV_RANDOMDOTS patches at 144Hz were
+ causing duplicate frames. Per-dot state is now kept in structure-of-arrays lanes (new buffer m_pfBufDotLanes), and a
+ single blocked sweep fuses the motion, recycling and aperture/Gaussian alpha passes, using SSE2 where available with
+ a scalar fallback. The interleaved {x,y,Tx,Ty} buffer is written only as the upload layout. Per-dot noise is folded
+ into displacement coefficients that are recomputed only when the noise update interval expires, eliminating the
+ per-dot, per-frame trig and pow() calls. RNG consumption order is unchanged. See CRMVDotKernel::update() in
+ rmvdotkernel.cpp for a discussion of numerical equivalence with the previous implementation.
+ 16oct2026-- To support the parallel target update stage in CRMVRenderer::animate(), the vertex data upload for the
+ dot-patch targets was moved out of updateRandomDots() and updateFlowField() and into updateMotion(), which can now
+ defer it. Added canUpdateOffGLThread() and uploadPendingVertexData().
+ 16oct2026-- If the renderer's GPU dot engine is enabled, RMV_RANDOMDOTS and RMV_FLOWFIELD targets are animated on
+ the GPU instead: the dot state lives in a pair of target-owned vertex arrays and is advanced by a transform feedback
+ pass each frame (see runGPUDotPass()). The CPU implementation remains the default and the reference.
+ 16oct2026-- RMV_MOVIE: If CVidBuffer buffers the movie's frames in planar YUV 4:2:0 format, the frame texture is a
+ single-component YUV texture and the renderer's fragment shader converts each frame to RGB. The frame (and PBO) is
+ half the size of an RGB24 frame.
+ 16oct2026-- RMV_MOVIE: In the renderer's zero-copy movie mode, the round-robin PBO queue is replaced by a single
+ persistently mapped PBO holding the video stream's entire frame queue, and CVidBuffer decodes directly into it. Each 
+ frame is uploaded to the texture straight from its queue slot, so the per-frame memcpy() in updateMovie() is gone.
+ The slot is held until the next frame is needed; by then the upload has completed, because the renderer waits for
+ the GPU after every buffer swap.
+ 16oct2026-- RMV_MOVIE: Playback may start at any frame of the video, as specified by RMVTGTDEF.iSeed (unused by the
+ movie target otherwise). CVidBuffer seeks and pre-rolls to the start frame when the video stream is opened during
+ target loading, and a repeating movie wraps back to the start frame.
+ 16oct2026-- draw() now selects the renderer's target program for its target class (CRMVRenderer::useTargetProgram())
+ before updating any uniforms, since the renderer no longer uses a single monolithic shader program.
+ 16oct2026-- In the renderer's analytic aperture mode, RMV_SPOT, _GRATING and _PLAID targets no longer prepare an alpha
+ mask texture; the aperture and Gaussian window are computed in the fragment shader instead (m_bWindowed).
+ 16oct2026-- Target initialization is split into two stages so that CRMVRenderer::loadTargets() can prepare several
+ targets in parallel. prepare() does all the CPU-side work -- validating the definition, computing any alpha mask,
+ retrieving (and pinning) the source image, opening and pre-rolling the video stream, and generating the initial dot
+ pattern -- and may run on a worker thread. completeInitialization() then allocates and loads the GL resources on the
+ GL thread. initialize() simply runs both stages. The static dot buffer pool is now guarded by a mutex.
+ 16oct2026-- draw() passes the stereo dot disparity of a dot target to CRMVRenderer::updateCommonUniforms(), so that in
+ the renderer's single-pass stereo mode the target is drawn once and offset per eye in the vertex shader.
+ 16oct2026-- The RMV_RANDOMDOTS update kernel, formerly the body of updateRandomDots(), was moved to the GL-independent
+ class CRMVDotKernel (rmvdotkernel.cpp), so that its SSE2 and scalar paths can be checked against each other and
+ against the prior implementation by a standalone test, rmvdotstest.
 */
 
 #include "stdio.h"
@@ -278,9 +316,11 @@ textures, more OGL state changes) that leads to poorer performance.
 #include "rmvrenderer.h"
 #include "rmvmediamgr.h"            // CRMVMediaMgr -- With methods for handling image/video files.
 #include "vidbuffer.h"              // CVidBuffer -- Handles streaming of video frames on a background thread
+#include "rmvdotkernel.h"         // CRMVDotKernel -- The CPU update kernel for RMV_RANDOMDOTS
 #include "rmvtarget.h"
 
 CRMVTarget::FloatBufNode* CRMVTarget::g_FloatBufPool = NULL;
+pthread_mutex_t CRMVTarget::g_FloatBufPoolMutex = PTHREAD_MUTEX_INITIALIZER;
 
 /**
  Create a pool of memory buffers used to store per-dot vertex attributes, lifetimes and noise factors for the 
@@ -358,13 +398,18 @@ void CRMVTarget::destroyBufferPool()
 
 /**
  Get a buffer for dot storage from buffer pool, allocating new one if necessary. The static buffer pool is created if 
- it does not yet exist.
+ it does not yet exist. Since targets may be prepared in parallel (see prepare()), access to the pool is serialized.
  @param sz The buffer size required. 
  @return Pointer to the buffer node, or NULL on failure.
 */
 CRMVTarget::FloatBufNode* CRMVTarget::getBufferNodeFromPool(int sz)
 {
-   if(!createBufferPool()) return(NULL);
+   ::pthread_mutex_lock(&g_FloatBufPoolMutex);
+   if(!createBufferPool())
+   {
+      ::pthread_mutex_unlock(&g_FloatBufPoolMutex);
+      return(NULL);
+   }
 
    FloatBufNode* pNode = g_FloatBufPool;
    FloatBufNode* pParent = NULL;
@@ -398,6 +443,7 @@ CRMVTarget::FloatBufNode* CRMVTarget::getBufferNodeFromPool(int sz)
    // if successful, mark buffer node as in use
    if(pNode != NULL) pNode->inUse = true;
 
+   ::pthread_mutex_unlock(&g_FloatBufPoolMutex);
    return(pNode);
 }
 
@@ -408,6 +454,7 @@ CRMVTarget::FloatBufNode* CRMVTarget::getBufferNodeFromPool(int sz)
 void CRMVTarget::releaseBufferNodeToPool(CRMVTarget::FloatBufNode* pNode)
 {
    if(pNode == NULL) return;
+   ::pthread_mutex_lock(&g_FloatBufPoolMutex);
 
    // make sure this is a node in the pool. At the same time, get pool size and current number of unused buffers.
    int nNodes = 0;
@@ -447,6 +494,7 @@ void CRMVTarget::releaseBufferNodeToPool(CRMVTarget::FloatBufNode* pNode)
          }
       }
    }
+   ::pthread_mutex_unlock(&g_FloatBufPoolMutex);
 }
 
 
@@ -462,11 +510,17 @@ CRMVTarget::CRMVTarget()
    m_flickerFramesLeft = 0;
 
    m_texID = 0;
+   m_bWindowed = false;
+   m_pMaskTexels = NULL;
    m_vtxArrayStart = m_vtxArrayCount = 0;
 
-   m_pfBufDots = m_pfBufDotLives = m_pfBufDotNoise = (CRMVTarget::FloatBufNode*) NULL;
+   m_pfBufDots = m_pfBufDotLanes = m_pfBufDotLives = m_pfBufDotNoise = (CRMVTarget::FloatBufNode*) NULL;
    m_pDotRNG = m_pNoiseRNG = NULL;
    m_tUntilNoiseUpdate = 0.0f;
+   m_bGPUDots = false;
+   m_gpuDotVAOs[0] = m_gpuDotVAOs[1] = m_gpuDotVBOs[0] = m_gpuDotVBOs[1] = 0;
+   m_iGPUDotBuf = 0;
+   m_gpuDotPass = 0;
  
    for( int i=0; i<2; i++ )
    {
@@ -475,6 +529,9 @@ CRMVTarget::CRMVTarget()
       m_fCurrPhase[i] = 0.0f;
    }
 
+   m_pImgPixels = NULL;
+   m_wImgPix = m_hImgPix = 0;
+
    m_videoStreamID = -1;
    m_iMovieState = MOVIE_UNINITIALIZED;
    m_gotLastFrame = false;
@@ -484,6 +541,11 @@ CRMVTarget::CRMVTarget()
 
    for(int i=0; i<NUMPBOS; i++) m_pboIDs[i] = 0;
    m_iCurrPBOIdx = -1;
+   m_frameStoreID = 0;
+   m_pFrameStore = NULL;
+   m_bHoldingFrame = false;
+
+   m_bVtxUploadPending = false;
 }
 
 CRMVTarget::~CRMVTarget()
@@ -495,6 +557,10 @@ CRMVTarget::~CRMVTarget()
  Initialize RMVideo target IAW the target definition specified. Validate target definition, allocate any additional 
  OpenGL resources required to render the target, position target at the origin, and turn it off initially.
 
+ Initialization is done in two stages, prepare() and completeInitialization(), which this method simply invokes in 
+ turn. CRMVRenderer::loadTargets() calls the two stages separately, so that the CPU-side preparation of several targets
+ can proceed in parallel.
+
  Target initialization can include GL calls that draw on the current backbuffer. As long as the backbuffer is not
  swapped before it is cleared, there will be no visible effect onscreen. In fact, CRMVRenderer::loadTargets() will 
  call glFinish() after loading and initializing all targets in the animated target list; it then redraws the idle
@@ -511,6 +577,24 @@ CRMVTarget::~CRMVTarget()
  @return True if successful; false if target definition is invalid or a required OpenGL resource was not allocated.
 */
 bool CRMVTarget::initialize(CRMVRenderer* pRenderer, const RMVTGTDEF& tgtDef)
+{
+   return(prepare(pRenderer, tgtDef) && completeInitialization());
+}
+
+/**
+ First stage of target initialization: Validate the target definition, then do all of the CPU-side work required to
+ prepare the target for animation -- everything that does not involve the OpenGL context. See prepareResources().
+ The target is positioned at the origin and turned off initially.
+
+ This method makes no GL calls. It may be called on a worker thread, concurrently with the preparation of other
+ targets, but not while the GL thread is allocating target resources. The target cannot be used until the second
+ stage, completeInitialization(), has been called on the GL thread.
+
+ @param pRenderer [in] The RMVideo target renderer. A reference to the renderer is maintained internally for later use.
+ @param tgtDef [in] The target's definition. 
+ @return True if successful; false if target definition is invalid or a required resource could not be prepared.
+*/
+bool CRMVTarget::prepare(CRMVRenderer* pRenderer, const RMVTGTDEF& tgtDef)
 {
    if(pRenderer == NULL) return(false);
 
@@ -520,10 +604,25 @@ bool CRMVTarget::initialize(CRMVRenderer* pRenderer, const RMVTGTDEF& tgtDef)
 
    initTargetColors();
 
-   if(!allocateResources()) return(false);
+   if(!prepareResources()) return(false);
 
    m_centerPt.Zero(); 
    setOn(false); 
+   return(true);
+}
+
+/**
+ Second stage of target initialization, following a successful call to prepare(): Allocate and load any OpenGL 
+ resources required to render the target (see allocateResources()), then pre-draw the target if it uses a texture. 
+ Must be called on the GL thread.
+
+ @return True if successful; false if the target was not prepared or a required OpenGL resource was not allocated.
+*/
+bool CRMVTarget::completeInitialization()
+{
+   if(m_pRenderer == NULL) return(false);
+
+   if(!allocateResources()) return(false);
 
    // pre-draw all targets using a texture to force allocation of texture object on the GPU before animation starts
    if(m_texID != 0)
@@ -536,11 +635,18 @@ bool CRMVTarget::initialize(CRMVRenderer* pRenderer, const RMVTGTDEF& tgtDef)
       if(m_tgtDef.iType == RMV_MOVIE)
       {
          // NOTE: We use a round-robin pixel buffer object for upload while animating, rather than uploading from 
-         // a normal CPU-side array, as we do here.
+         // a normal CPU-side array, as we do here. In zero-copy mode, the frame is already in the frame store PBO.
          uint8_t* pDstBuf = m_pRenderer->m_vidBuffer.getCurrentFrameData(m_videoStreamID);
          int w = m_pRenderer->m_vidBuffer.getVideoWidth(m_videoStreamID);
          int h = m_pRenderer->m_vidBuffer.getVideoHeight(m_videoStreamID);
-         m_pRenderer->uploadMovieFrameToTexture(m_texID, w, h, pDstBuf);
+         if(m_frameStoreID != 0)
+         {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_frameStoreID);
+            pDstBuf = (uint8_t*) (pDstBuf - m_pFrameStore);
+         }
+         m_pRenderer->uploadMovieFrameToTexture(m_texID, w, h, pDstBuf, 
+               m_pRenderer->m_vidBuffer.isVideoYUV(m_videoStreamID));
+         if(m_frameStoreID != 0) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
          m_iMovieState = MOVIE_GOTFRAME;
       }
 
@@ -550,8 +656,14 @@ bool CRMVTarget::initialize(CRMVRenderer* pRenderer, const RMVTGTDEF& tgtDef)
       // special case: restore state of RMV_MOVIE to "not started". In addition, we use a round-robin queue of
       // pixel buffer objects to upload frames to the GPU texture object. During each updateMotion() call, we copy
       // frame N+1 to one PBO and upload frame N from PBO to texture. So, prior to animation start, we need to
-      // copy the very first frame to the current PBO, then advance to the next frame.
-      if(m_tgtDef.iType == RMV_MOVIE) 
+      // copy the very first frame to the current PBO, then advance to the next frame. In zero-copy mode, there's
+      // nothing to do: the first frame stays at the head of the stream's queue, in the frame store.
+      if(m_tgtDef.iType == RMV_MOVIE && m_frameStoreID != 0)
+      {
+         m_iMovieState = MOVIE_NOTSTARTED;
+         m_bHoldingFrame = false;
+      }
+      else if(m_tgtDef.iType == RMV_MOVIE) 
       {
          m_iMovieState = MOVIE_NOTSTARTED;
          uint8_t* pDstBuf = m_pRenderer->m_vidBuffer.getCurrentFrameData(m_videoStreamID);
@@ -583,11 +695,20 @@ bool CRMVTarget::initialize(CRMVRenderer* pRenderer, const RMVTGTDEF& tgtDef)
  (note that RMV_FLOWFIED is always centered on screen, however). For selected target types, some additional work is
  required. See the approriate helper methods for a description.
 
+ For the dot-patch targets RMV_RANDOMDOTS and RMV_FLOWFIELD, the updated per-dot vertex attributes are uploaded to
+ the target's segment in the renderer's shared vertex array. That upload is a GL call and must be made on the GL
+ thread. When the update is performed on a worker thread (see canUpdateOffGLThread()), the caller must request that
+ the upload be deferred, then call uploadPendingVertexData() on the GL thread once the update is complete.
+ When a dot-patch target is animated by the renderer's GPU dot engine, there is no vertex data to upload: the dot
+ state is advanced entirely on the GPU by runGPUDotPass(), which must be called on the GL thread.
+
  @param tElapsed [in] Time elapsed since the previous update, ie, the display refresh period. In milliseconds.
  @param pTgtVec [in] The target motion update vector. If NULL, no action taken.
+ @param bDeferUpload [in] If true, the vertex data upload for a dot-patch target is deferred until the next call to
+ uploadPendingVertexData(). Default is false.
  @return True if successful, false if a fatal error occurred. In the latter case, the ongoing animation is terminated.
 */
-bool CRMVTarget::updateMotion(float tElapsed, PRMVTGTVEC pVec)
+bool CRMVTarget::updateMotion(float tElapsed, PRMVTGTVEC pVec, bool bDeferUpload /* =false */)
 {
    if(pVec==NULL) return(true);
 
@@ -608,10 +729,12 @@ bool CRMVTarget::updateMotion(float tElapsed, PRMVTGTVEC pVec)
       updatePlaid(pVec);
       break;
    case RMV_RANDOMDOTS:
-      updateRandomDots(tElapsed, pVec);
+      if(m_bGPUDots) runGPUDotPass(false, tElapsed, pVec);
+      else updateRandomDots(tElapsed, pVec);
       break;
    case RMV_FLOWFIELD:
-      updateFlowField(pVec);
+      if(m_bGPUDots) runGPUDotPass(false, tElapsed, pVec);
+      else updateFlowField(pVec);
       break;
    case RMV_MOVIE:
       ok = updateMovie(tElapsed, pVec);
@@ -619,9 +742,44 @@ bool CRMVTarget::updateMotion(float tElapsed, PRMVTGTVEC pVec)
    default: 
       break;
    }
+
+   // for dot-patch targets, upload vertex data to the dedicated segment in the OpenGL shared vertex array -- unless
+   // the upload must be deferred because we're not on the GL thread
+   if((m_tgtDef.iType == RMV_RANDOMDOTS || m_tgtDef.iType == RMV_FLOWFIELD) && !m_bGPUDots)
+   {
+      m_bVtxUploadPending = true;
+      if(!bDeferUpload) uploadPendingVertexData();
+   }
    return(ok);
 }
 
+/**
+ Can this target's updateMotion() be safely invoked on a thread other than the GL thread, with the vertex data upload
+ deferred? Only the dot-patch targets RMV_RANDOMDOTS and RMV_FLOWFIELD qualify: their per-frame update is CPU-bound
+ and touches only state owned by the target, including its own random number generators. The RMV_MOVIE update makes
+ GL calls and interacts with CVidBuffer, so it must stay on the GL thread; the remaining target types are so cheap to
+ update that there's nothing to be gained by moving them off the GL thread. A dot-patch target animated by the GPU
+ dot engine does not qualify either, since its update is a sequence of GL calls.
+
+ @return True if target update may be performed on a worker thread.
+*/
+bool CRMVTarget::canUpdateOffGLThread()
+{
+   return((m_tgtDef.iType == RMV_RANDOMDOTS || m_tgtDef.iType == RMV_FLOWFIELD) && !m_bGPUDots);
+}
+
+/**
+ Upload the dot-patch target's vertex data to its dedicated segment in the renderer's shared vertex array, if an upload
+ was deferred during the last updateMotion() call. Must be called on the GL thread. No action taken otherwise.
+*/
+void CRMVTarget::uploadPendingVertexData()
+{
+   if(!m_bVtxUploadPending) return;
+   m_bVtxUploadPending = false;
+   if(m_pfBufDots != NULL)
+      m_pRenderer->uploadVertexData(m_vtxArrayStart, m_vtxArrayCount, m_pfBufDots->pBuf);
+}
+
 /**
  Helper method for updateMotion(): Update the target's flicker state.
 
@@ -737,234 +895,27 @@ void CRMVTarget::updatePlaid(PRMVTGTVEC pVec)
 /**
  Helper method for updateMotion(): Handles motion update tasks specific to the RMV_RANDOMDOTS target.
 
- For details, see implementation notes for RMV_RANDOMDOTS in the file header.
+ For details, see implementation notes for RMV_RANDOMDOTS in the file header. The work is done by the GL-independent
+ kernel CRMVDotKernel::update(), which operates on the target's per-dot buffers and random-number generators.
 */
 void CRMVTarget::updateRandomDots(float tElapsed, PRMVTGTVEC pVec)
 {
-   // which special features, if any, are enabled?
-   bool bEnaCoherence = (m_tgtDef.iPctCoherent < 100);
-   bool bEnaNoise = (m_tgtDef.iNoiseUpdIntv > 0 && m_tgtDef.iNoiseLimit > 0);
-   bool bEnaDotLife = (m_tgtDef.fDotLife != 0.0f);
-
-   // pattern velocity in polar form
-   double dPatVecAmpl = 0.0;
-   double dPatVecTheta = 0.0;
-
-   // aperture outer/inner half-width, half-height
-   float fOuterHalfW = m_tgtDef.fOuterW / 2.0f;
-   float fOuterHalfH = m_tgtDef.fOuterH / 2.0f;
-   float fInnerHalfW = m_tgtDef.fInnerW / 2.0f;
-   float fInnerHalfH = m_tgtDef.fInnerH / 2.0f;
-
-   // buffer pointers
-   float* pfDots = m_pfBufDots->pBuf;
-   float* pfDotNoise = bEnaNoise ? m_pfBufDotNoise->pBuf : NULL;
-   float* pfDotLives = bEnaDotLife ? m_pfBufDotLives->pBuf : NULL;
-
-   // if per-dot noise enabled: (1) calculate the polar form of pattern velocity vector, and (2) choose new random 
-   // noise factor for each dot whenever the noise update interval expires. We do this even if the target is off 
-   // and/or not moving!
-   if(bEnaNoise) 
-   { 
-      dPatVecAmpl = ::sqrt(pVec->hPat * pVec->hPat + pVec->vPat * pVec->vPat);
-      dPatVecTheta = cMath::atan2Deg(pVec->vPat, pVec->hPat);
-      m_tUntilNoiseUpdate -= tElapsed;
-      if(m_tUntilNoiseUpdate <= 0.0f)
-      {
-         m_tUntilNoiseUpdate += float(m_tgtDef.iNoiseUpdIntv);
-         for(int i = 0; i < m_tgtDef.nDots; i++)
-         {
-            double dNoise = m_pNoiseRNG->generate();              // (0..1)
-            dNoise *= 2.0 * double(m_tgtDef.iNoiseLimit);         // (0..2N), where N is the noise range limit
-            dNoise -= double(m_tgtDef.iNoiseLimit);               // (-N..N)
-            pfDotNoise[i] = float(dNoise);
-         }
-      }
-   }
-
-   // if finite dotlife enabled, determine the change in dotlife for this update -- either elasped time in ms or 
-   // distance travelled in degrees. We do this even if the target is off.
-   float fDotLifeDelta = 0.0f; 
-   if(bEnaDotLife) 
-   { 
-      if(m_tgtDef.iFlags & RMV_F_LIFEINMS) fDotLifeDelta = tElapsed;
-      else fDotLifeDelta = ::sqrt(pVec->hPat * pVec->hPat + pVec->vPat * pVec->vPat);
-   }
-
-   // UPDATE INDIVIDUAL DOT POSITIONS:
-   CFPoint fpDot; 
-   int xyIndex = 0;   // index into the per-dot vertex attributes array; stride of 4: {x,y,Tx,Ty} per dot
-   bool bIsDirNoise = bEnaNoise && ((m_tgtDef.iFlags & RMV_F_DIRNOISE) != 0);
-   bool bIsSpdLog2 = (!bIsDirNoise) && ((m_tgtDef.iFlags & RMV_F_SPDLOG2) != 0);
-   bool bWrtScreen = ((m_tgtDef.iFlags & RMV_F_WRTSCREEN) != 0);
-   
-   // this factor is the expected value of 2^X, where X is a uniform r.v chosen over (-N..N). It is needed only in 
-   // the implementation of multiplicative per-dot speed noise: Rdot = (Rpat * 2^X) / E(2^X).
-   double log2Fac = 1.0;
-   if(bIsSpdLog2)
-   {
-      log2Fac = pow(2.0, double(m_tgtDef.iNoiseLimit)) - pow(2.0, double(-m_tgtDef.iNoiseLimit));
-      log2Fac /= 2 * double(m_tgtDef.iNoiseLimit) * log(2.0);
-   }
-
-   for(int i = 0; i < m_tgtDef.nDots; i++)
-   {
-      // flag gets set if dot position was randomized on this frame
-      bool bWasDotLocRandomized = false;
-      
-      // if coherence feature in play, on each update we randomly select a percentage of dots to be randomly 
-      // repositioned w/in target window
-      if(bEnaCoherence) 
-      { 
-         double dTest = m_pDotRNG->generate() * 100.0; 
-         if(dTest >= m_tgtDef.iPctCoherent)
-         {
-            bWasDotLocRandomized = true;
-            randomizeDotPos(pfDots[xyIndex], pfDots[xyIndex+1]);
-         }
-      }
-
-      // if finite dotlife in play, decrement the dot's current lifetime and randomly repos dot if its lifetime expired
-      if(bEnaDotLife) 
-      { 
-         pfDotLives[i] -= fDotLifeDelta;
-         if(pfDotLives[i] < 0.0f)
-         {
-            pfDotLives[i] = m_tgtDef.fDotLife;
-            if(!bWasDotLocRandomized)
-            {
-               bWasDotLocRandomized = true;
-               randomizeDotPos(pfDots[xyIndex], pfDots[xyIndex+1]);
-            }
-         }
-      }
-
-      // if dot was not already randomly repositioned above, then move it appropriately
-      if(!bWasDotLocRandomized) 
-      { 
-         float fx = pfDots[xyIndex];
-         float fy = pfDots[xyIndex+1];
-         if(!bEnaNoise)
-         {
-            fx += pVec->hPat;
-            fy += pVec->vPat;
-         }
-         else if(bIsDirNoise)
-         {
-            // for dir noise, offset pat vel theta by noise factor in deg; then calc Cartesian cmpts
-            double dDir = dPatVecTheta + pfDotNoise[i];
-            fx += float( dPatVecAmpl * cMath::cosDeg(dDir) );
-            fy += float( dPatVecAmpl * cMath::sinDeg(dDir) );
-         }
-         else if(!bIsSpdLog2) 
-         { 
-            // for additive speed noise, offset pat vel R by a pct based noise factor
-            double dAmp = dPatVecAmpl * pfDotNoise[i] / 100.0f;
-            dAmp += dPatVecAmpl;
-            fx += float( dAmp * cMath::cosDeg(dPatVecTheta) );
-            fy += float( dAmp * cMath::sinDeg(dPatVecTheta) );
-         }
-         else
-         { 
-            // (as of v2.1.3) for multiplicative speed noise, Rdot = (R*2^X)/E, where E is the mean of 2^X when X is a
-            // uniform r.v. in (-N..N)
-            double dAmp = dPatVecAmpl*pow(2.0, pfDotNoise[i]);
-            dAmp /= log2Fac;
-            fx += float( dAmp * cMath::cosDeg(dPatVecTheta) );
-            fy += float( dAmp * cMath::sinDeg(dPatVecTheta) );
-         }
-         
-         // (as of v2.5.2) if target pattern displacement is WRT screen rather than target window, then we must 
-         // convert to window frame of reference by subtracting the window displacement during this update.
-         if(bWrtScreen)
-         {
-            fx -= pVec->hWin;
-            fy -= pVec->vWin;
-         }
-         
-         // The code below implements an algorithm for recycling a dot that has just moved out of "bounds", ie,
-         // beyond the outer bounds of the aperture. The idea here is to relocate the dot in a sensible way so that
-         // the target acts like a window on a random-dot pattern of infinite extent. Dots are "recycled" when they
-         // leave the aperture's bounding rectangle (which is larger than the visible window for all apertures
-         // except "rect"!). If the dot has just advanced past the right edge of the rectangle by X degrees, then the
-         // algorithm here will "recycle" the dot X degrees left of the window's left edge, with the y-coord
-         // randomized since we don't want the same pattern to "wrap" around the window edges.
-         float fRem;
-         if(cMath::abs(fx) > fOuterHalfW)
-         {
-            fRem = ::fmodf(cMath::abs(fx) - fOuterHalfW, fOuterHalfW);
-            if((fx - pfDots[xyIndex]) > 0)
-               fx = -fOuterHalfW + fRem;
-            else
-               fx = fOuterHalfW - fRem;
-
-            fy = float( m_pDotRNG->generate() * m_tgtDef.fOuterH ) - fOuterHalfH;
-         }
-         else if(cMath::abs(fy) > fOuterHalfH)
-         {
-            fRem = ::fmodf(cMath::abs(fy) - fOuterHalfH, fOuterHalfH);
-            if((fy - pfDots[xyIndex+1]) > 0)
-               fy = -fOuterHalfH + fRem;
-            else
-               fy = fOuterHalfH - fRem;
-
-            fx = float( m_pDotRNG->generate() * m_tgtDef.fOuterW ) - fOuterHalfW;
-         }
-
-         pfDots[xyIndex] = fx;
-         pfDots[xyIndex+1] = fy;
-      }
-
-      xyIndex += 4;  // remember: stride is 4 b/c vertex array includes 4 attributes per dot: x,y,Tx,Ty
-   }
-
-   // update alpha component of each dot's RGBA color IAW target aperture: If dot is outside aperture, A=0, else
-   // A=exp( -[x*x/(2*SX*SX) + y*y/(2*SY*SY)] ), where SX,SY are the standard deviations of the elliptical Gaussian
-   // window in X and Y (if SX=SY=0, A=1).  There's one situation where we can A=1 for all dots always: for the
-   // rectangular aperture when Gaussian window is disabled (rem that A was init'd to 1 for all dots).
-   double dInvTwoSigSqX = (m_tgtDef.fSigma[0]>0.0f) ? -1.0/(2.0 * m_tgtDef.fSigma[0] * m_tgtDef.fSigma[0]) : 0.0f;
-   double dInvTwoSigSqY = (m_tgtDef.fSigma[1]>0.0f) ? -1.0/(2.0 * m_tgtDef.fSigma[1] * m_tgtDef.fSigma[1]) : 0.0f;
-   bool bDoGauss = (m_tgtDef.fSigma[0] > 0.0f || m_tgtDef.fSigma[1] > 0.0f);
-   double dASq = fOuterHalfW*fOuterHalfW;
-   double dBSq = fOuterHalfH*fOuterHalfH;
-   double dCSq = fInnerHalfW*fInnerHalfW;
-   double dDSq = fInnerHalfH*fInnerHalfH;
-   if(m_tgtDef.iAperture != RMV_RECT || bDoGauss) for( int i=0; i<m_tgtDef.nDots; i++ )
-   {
-      double x = pfDots[4*i];
-      double y = pfDots[4*i+1];
-
-      // "inside aperture" test: A=1 for inside, A=0 otherwise.  Note that all dots are inside the RMV_RECT aperture!
-      bool isInside = false;
-      switch( m_tgtDef.iAperture )
-      {
-         case RMV_RECT :
-            isInside = true;
-            break;
-         case RMV_RECTANNU :
-            if((fabs(x)>fInnerHalfW) || (fabs(y)>fInnerHalfH))
-               isInside = true;
-            break;
-         case RMV_OVAL :
-            if( x*x/dASq + y*y/dBSq <= 1.0 )
-               isInside = true;
-            break;
-         case RMV_OVALANNU :
-            if( (x*x/dASq + y*y/dBSq <= 1.0) && (x*x/dCSq + y*y/dDSq > 1.0) )
-               isInside = true;
-            break;
-      }
-
-      // if dot is outside aperture, A=0.  Else, if Gaussian std dev > 0, then compute A accordingly
-      // NOTE: We store each dot's alpha in the vertex attribute "Tx", which otherwise represents the X-coordinate of 
-      // the texel location. We don't use an alpha texture with RMV_RANDOMDOTS. "Ty" is unused.
-      if(!isInside) pfDots[4*i+2] = 0.0f;
-      else if(!bDoGauss) pfDots[4*i+2] = 1.0f;
-      else pfDots[4*i+2] = (float) cMath::rangeLimit(exp(x*x*dInvTwoSigSqX + y*y*dInvTwoSigSqY), 0.0, 1.0);
-   }
-
-   // upload vertex data to the dedicated segment in the OpenGL shared vertex array
-   m_pRenderer->uploadVertexData(m_vtxArrayStart, m_vtxArrayCount, pfDots);
+   int n = m_tgtDef.nDots;
+   CRMVDotKernel::DotState st;
+   st.nDots = n;
+   st.pfDots = m_pfBufDots->pBuf;
+   st.pfX = m_pfBufDotLanes->pBuf;
+   st.pfY = st.pfX + n;
+   st.pfC = st.pfY + n;
+   st.pfS = st.pfC + n;
+   st.pfDotNoise = (m_pfBufDotNoise != NULL) ? m_pfBufDotNoise->pBuf : NULL;
+   st.pfDotLives = (m_pfBufDotLives != NULL) ? m_pfBufDotLives->pBuf : NULL;
+   st.tUntilNoiseUpdate = m_tUntilNoiseUpdate;
+   st.pDotRNG = m_pDotRNG;
+   st.pNoiseRNG = m_pNoiseRNG;
+
+   CRMVDotKernel::update(m_tgtDef, tElapsed, pVec, st);
+   m_tUntilNoiseUpdate = st.tUntilNoiseUpdate;
 }
 
 /**
@@ -1037,9 +988,92 @@ void CRMVTarget::updateFlowField(PRMVTGTVEC pVec)
       }
       else randomizeDotPosInFlowField(pfDots[j], pfDots[j+1]);
    }
+}
+
+/**
+ Helper method for updateMotion() and allocateResources(): Initialize or update the dot state of a RMV_RANDOMDOTS or
+ RMV_FLOWFIELD target that is animated by the renderer's GPU dot engine. Must be called on the GL thread.
+
+ The pass parameters are prepared exactly as in updateRandomDots() and updateFlowField() -- including the noise update 
+ countdown, the dotlife decrement, and the flow field animation factor B -- but the per-dot work is done in a single
+ transform feedback pass on the GPU (see CRMVRenderer::runGPUDotEngine()). The pass reads the current dot state from
+ one of the target's two vertex arrays and writes the new state into the other, which then becomes current.
+
+ @param bInit [in] If true, generate the initial dot pattern; the remaining arguments are ignored.
+ @param tElapsed [in] Time elapsed since the previous update, in milliseconds.
+ @param pVec [in] The target motion update vector. Must not be NULL unless bInit is set.
+*/
+void CRMVTarget::runGPUDotPass(bool bInit, float tElapsed, PRMVTGTVEC pVec)
+{
+   bool isFlow = (m_tgtDef.iType == RMV_FLOWFIELD);
+
+   GPUDotPass gp;
+   ::memset(&gp, 0, sizeof(GPUDotPass));
+   gp.seed = (unsigned int) m_tgtDef.iSeed;
+   gp.pass = m_gpuDotPass++;
+   gp.aperture = m_tgtDef.iAperture;
+   gp.outerW = m_tgtDef.fOuterW;
+   gp.outerH = m_tgtDef.fOuterH;
+   gp.innerW = m_tgtDef.fInnerW;
+   gp.innerH = m_tgtDef.fInnerH;
+   gp.gaussX = (m_tgtDef.fSigma[0]>0.0f) ? float(-1.0/(2.0 * m_tgtDef.fSigma[0] * m_tgtDef.fSigma[0])) : 0.0f;
+   gp.gaussY = (m_tgtDef.fSigma[1]>0.0f) ? float(-1.0/(2.0 * m_tgtDef.fSigma[1] * m_tgtDef.fSigma[1])) : 0.0f;
+   gp.pctCoherent = float(m_tgtDef.iPctCoherent);
+   gp.dotLife = isFlow ? 0.0f : m_tgtDef.fDotLife;
+   gp.log2Fac = 1.0f;
+
+   if(bInit) gp.mode = isFlow ? CRMVRenderer::GPUDOT_INITFLOW : CRMVRenderer::GPUDOT_INITDOTS;
+   else if(isFlow)
+   {
+      // see updateFlowField()
+      gp.mode = CRMVRenderer::GPUDOT_UPDATEFLOW;
+      gp.flowB = (float) (pVec->hPat / cMath::sincosDeg(0.5f*m_tgtDef.fOuterW));
+      gp.flowRecycleRate = (float) cMath::rangeLimit(cMath::abs(gp.flowB) / 30.0, 0.001, 0.4);
+      gp.flowRecycleDR = (float) (cMath::abs(gp.flowB)*cMath::sincosDeg(m_tgtDef.fOuterW));
+   }
+   else
+   {
+      // see updateRandomDots()
+      gp.mode = CRMVRenderer::GPUDOT_UPDATEDOTS;
+      gp.patX = pVec->hPat;
+      gp.patY = pVec->vPat;
+      if((m_tgtDef.iFlags & RMV_F_WRTSCREEN) != 0)
+      {
+         gp.winX = pVec->hWin;
+         gp.winY = pVec->vWin;
+      }
+
+      if(m_tgtDef.fDotLife != 0.0f)
+      {
+         if(m_tgtDef.iFlags & RMV_F_LIFEINMS) gp.dotLifeDelta = tElapsed;
+         else gp.dotLifeDelta = ::sqrt(pVec->hPat * pVec->hPat + pVec->vPat * pVec->vPat);
+      }
+
+      if(m_tgtDef.iNoiseUpdIntv > 0 && m_tgtDef.iNoiseLimit > 0)
+      {
+         bool bIsDirNoise = ((m_tgtDef.iFlags & RMV_F_DIRNOISE) != 0);
+         bool bIsSpdLog2 = (!bIsDirNoise) && ((m_tgtDef.iFlags & RMV_F_SPDLOG2) != 0);
+         gp.noiseMode = bIsDirNoise ? 1 : (bIsSpdLog2 ? 3 : 2);
+         gp.noiseLimit = float(m_tgtDef.iNoiseLimit);
+         if(bIsSpdLog2)
+         {
+            double log2Fac = pow(2.0, double(m_tgtDef.iNoiseLimit)) - pow(2.0, double(-m_tgtDef.iNoiseLimit));
+            log2Fac /= 2 * double(m_tgtDef.iNoiseLimit) * log(2.0);
+            gp.log2Fac = float(log2Fac);
+         }
+
+         m_tUntilNoiseUpdate -= tElapsed;
+         if(m_tUntilNoiseUpdate <= 0.0f)
+         {
+            m_tUntilNoiseUpdate += float(m_tgtDef.iNoiseUpdIntv);
+            gp.noiseUpdate = true;
+         }
+      }
+   }
 
-   // upload vertex data to the dedicated segment in the OpenGL shared vertex array
-   m_pRenderer->uploadVertexData(m_vtxArrayStart, m_vtxArrayCount, pfDots);
+   int iNext = 1 - m_iGPUDotBuf;
+   m_pRenderer->runGPUDotEngine(gp, m_gpuDotVAOs[m_iGPUDotBuf], m_gpuDotVBOs[iNext], m_tgtDef.nDots);
+   m_iGPUDotBuf = iNext;
 }
 
 /**
@@ -1092,6 +1126,14 @@ bool CRMVTarget::updateMovie(float tElapsed, PRMVTGTVEC pVec)
       return(true);
    }
 
+   // zero-copy mode: release the queue slot holding the frame uploaded in the previous call. The GPU is done reading
+   // it, since the renderer waits for the GPU to finish all commands after each buffer swap.
+   if(m_frameStoreID != 0 && m_bHoldingFrame)
+   {
+      m_pRenderer->m_vidBuffer.advanceToNextFrame(m_videoStreamID);
+      m_bHoldingFrame = false;
+   }
+
    // get next frame from video streamer. BLOCK if a frame is not ready, UNLESS we've reached EOF and movie is not
    // configured to repeat indefinitely. FAIL if video stream disabled.
    struct timespec tSpec;
@@ -1120,13 +1162,32 @@ bool CRMVTarget::updateMovie(float tElapsed, PRMVTGTVEC pVec)
    } 
    while(pDstBuf == NULL);
 
-   // upload frame data in current PBO slot to the assigned GL texture.
    int w = m_pRenderer->m_vidBuffer.getVideoWidth(m_videoStreamID);
    int h = m_pRenderer->m_vidBuffer.getVideoHeight(m_videoStreamID);
    int nBytes = m_pRenderer->m_vidBuffer.getVideoFrameSize(m_videoStreamID);
 
+   // zero-copy mode: the last frame was drawn in the previous call, so the movie is done once EOF is reached. 
+   // Otherwise, upload the frame straight from its slot in the frame store PBO, and hold the slot until next call.
+   if(m_frameStoreID != 0)
+   {
+      if(m_gotLastFrame)
+      {
+         m_iMovieState = MOVIE_DONE;
+         return(true);
+      }
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_frameStoreID);
+      m_pRenderer->uploadMovieFrameToTexture(m_texID, w, h, (unsigned char*) (pDstBuf - m_pFrameStore), 
+            m_pRenderer->m_vidBuffer.isVideoYUV(m_videoStreamID));
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      m_bHoldingFrame = true;
+      m_iMovieState = MOVIE_GOTFRAME;
+      return(true);
+   }
+
+   // upload frame data in current PBO slot to the assigned GL texture.
+
    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pboIDs[m_iCurrPBOIdx]);
-   m_pRenderer->uploadMovieFrameToTexture(m_texID, w, h, NULL);
+   m_pRenderer->uploadMovieFrameToTexture(m_texID, w, h, NULL, m_pRenderer->m_vidBuffer.isVideoYUV(m_videoStreamID));
 
    // if the movie does not loop and we detected EOF, then the last frame has now been queued for upload and
    // there are no more frames to get from the video stream
@@ -1177,7 +1238,8 @@ bool CRMVTarget::updateMovie(float tElapsed, PRMVTGTVEC pVec)
  to compute a horizontal offset in the target's position. Applicable ONLY to RMV_POINT, RMV_RANDOMDOTS, and
  RMV_FLOWFIELD. Typical usage during a stereo experiment: eye = -0.5 while drawing a dots target in the GL_LEFT
  backbuffer, and eye = +0.5 while drawing a dots target in the GL_RIGHT backbuffer. No offset if eye = 0 or the target's
- dot disparity is zero.
+ dot disparity is zero. In the renderer's single-pass stereo mode, eye = 0 and the target is drawn once for both eyes;
+ the disparity is then applied per eye by the vertex shader.
 */
 void CRMVTarget::draw(float eye)
 {
@@ -1188,15 +1250,26 @@ void CRMVTarget::draw(float eye)
    // set up uniform variables accessed in the vertex or fragment shaders
    bool isPts = (m_tgtDef.iType==RMV_POINT) || (m_tgtDef.iType==RMV_RANDOMDOTS) || (m_tgtDef.iType==RMV_FLOWFIELD);
    bool isLine = (m_tgtDef.iType==RMV_BAR) && (m_tgtDef.fOuterW <= 0.0f);
-   m_pRenderer->updateCommonUniforms(m_tgtDef.iType,
-      m_centerPt.GetH() + (isPts ? eye * m_tgtDef.fDotDisp : 0.0f), m_centerPt.GetV(),
+   bool isYUV = (m_tgtDef.iType==RMV_MOVIE) && m_pRenderer->m_vidBuffer.isVideoYUV(m_videoStreamID);
+   bool isSine = (m_tgtDef.iFlags & RMV_F_ISSQUARE) == 0;
+   m_pRenderer->useTargetProgram(m_tgtDef.iType, isYUV, isSine, m_bWindowed);
+   m_pRenderer->updateCommonUniforms(m_centerPt.GetH() + (isPts ? eye * m_tgtDef.fDotDisp : 0.0f), m_centerPt.GetV(),
       isLine ? 1.0f : (isPts ? 0.0f : m_tgtDef.fOuterW), isPts ? 0.0f : m_tgtDef.fOuterH,
-      m_tgtDef.iType == RMV_BAR ? m_tgtDef.fDriftAxis[0] : 0.0f);
+      m_tgtDef.iType == RMV_BAR ? m_tgtDef.fDriftAxis[0] : 0.0f, isPts ? m_tgtDef.fDotDisp : 0.0f);
    m_pRenderer->updateTargetColorUniform(m_rgb0[0], m_rgb0[1], m_rgb0[2]);
 
+   if(isYUV)
+      m_pRenderer->updateYUVFrameUniforms(m_pRenderer->m_vidBuffer.getVideoWidth(m_videoStreamID), 
+         m_pRenderer->m_vidBuffer.getVideoHeight(m_videoStreamID), 
+         m_pRenderer->m_vidBuffer.isVideoFullRange(m_videoStreamID));
+
+   if(m_bWindowed)
+      m_pRenderer->updateWindowUniforms(m_centerPt.GetH(), m_centerPt.GetV(), m_tgtDef.iAperture, m_tgtDef.fOuterW,
+         m_tgtDef.fOuterH, m_tgtDef.fInnerW, m_tgtDef.fInnerH, m_tgtDef.fSigma[0], m_tgtDef.fSigma[1]);
+
    if(m_tgtDef.iType==RMV_GRATING || m_tgtDef.iType==RMV_PLAID)
-      m_pRenderer->updateGratingUniforms(m_centerPt.GetH(), m_centerPt.GetV(), (m_tgtDef.iFlags & RMV_F_ISSQUARE) == 0,
-         m_rgb0, m_rgbCon0, m_rgb1, m_rgbCon1, m_fCurrOrient, m_fSpatialPerX, m_fSpatialPerY, m_fCurrPhase);
+      m_pRenderer->updateGratingUniforms(m_centerPt.GetH(), m_centerPt.GetV(), m_rgb0, m_rgbCon0, m_rgb1, m_rgbCon1, 
+         m_fCurrOrient, m_fSpatialPerX, m_fSpatialPerY, m_fCurrPhase);
 
    // bind the appropriate texture, set the point size (for dot targets), and draw the primitives (which are fixed
    // primitives in the shared array for most target types, else a set of point primitives that were updated in the
@@ -1205,7 +1278,19 @@ void CRMVTarget::draw(float eye)
    m_pRenderer->bindTextureObject(m_texID);
    if(isPts) m_pRenderer->setPointSize(m_tgtDef.nDotSize);
    
-   if(!m_isTwoColor)
+   if(m_bGPUDots)
+   {
+      // dot state for targets animated by the GPU dot engine lives in the target's own vertex arrays
+      unsigned int vao = m_gpuDotVAOs[m_iGPUDotBuf];
+      int n = m_isTwoColor ? m_vtxArrayCount / 2 : m_vtxArrayCount;
+      m_pRenderer->drawGPUDots(vao, 0, n);
+      if(m_isTwoColor)
+      {
+         m_pRenderer->updateTargetColorUniform(m_rgb1[0], m_rgb1[1], m_rgb1[2]);
+         m_pRenderer->drawGPUDots(vao, n, m_vtxArrayCount - n);
+      }
+   }
+   else if(!m_isTwoColor)
       m_pRenderer->drawPrimitives(isPts, isLine, m_vtxArrayStart, m_vtxArrayCount);
    else
    {
@@ -1316,10 +1401,12 @@ bool CRMVTarget::validateTargetDef()
       }
    }
 
-   // these 3 params apply only to the RMV_RANDOMDOTS and _FLOWFIELD targets; dot size applies to RMV_POINT.
+   // these 3 params apply only to the RMV_RANDOMDOTS and _FLOWFIELD targets; dot size applies to RMV_POINT. For
+   // RMV_MOVIE, the seed is the zero-based index of the first frame played.
    m_tgtDef.nDots = cMath::rangeLimit(m_tgtDef.nDots, 1, RMV_MAXNUMDOTS);
    m_tgtDef.nDotSize = cMath::rangeLimit(m_tgtDef.nDotSize, RMV_MINDOTSIZE, RMV_MAXDOTSIZE);
-   m_tgtDef.iSeed = (m_tgtDef.iSeed == 0) ? 1 : m_tgtDef.iSeed;
+   if(t == RMV_MOVIE) m_tgtDef.iSeed = (m_tgtDef.iSeed < 0) ? 0 : m_tgtDef.iSeed;
+   else m_tgtDef.iSeed = (m_tgtDef.iSeed == 0) ? 1 : m_tgtDef.iSeed;
 
    // these next 4 params apply only to RMV_RANDOMDOTS
    m_tgtDef.iPctCoherent = cMath::rangeLimit(m_tgtDef.iPctCoherent, 0, 100);
@@ -1465,58 +1552,21 @@ void CRMVTarget::initTargetColors()
 }
 
 /**
- Helper method for initialize(): Initialize any additional state information relevant to the target type implemented,
- and allocate any additional OpenGL resources required to render the target.
-
- 1) Alpha mask texture. RMV_SPOT, _GRATING, _PLAID and _RANDOMDOTS all support a non-rectangular aperture and a 2D
- Gaussian blur. Both aperture and blur are implemented by an alpha mask texture object generated here -- but NOT for
- the RMV_RANDOMDOTS target.
-
- For RMV_RANDOMDOTS, each dot is either inside or outside the aperture, regardless the dot size; it cannot be partly
- obscured at the aperture boundary). The per-dot alpha component is computed every frame based on the dot's location,
- which typically changes during an animation. That alpha component is transmitted to the fragment shader via the
- vertex attribute "Tx", the X-coordinate of the dot's texel location in the applied texture -- which will be the
- default "alpha=1" mask. In the fragment shader, the result of the texturing operation is ignored, and the fragment
- alpha is set to the value of Tx. Note that, if the aperture is RMV_RECT and there's no Gaussian window, then all
- dots have alpha = 1 always.
-
- 2) RMV_IMAGE. An RGBA texture object is allocated and loaded with the image data here.
-
- 3) RMV_MOVIE. The video source file is opened and all of the infrastructure for streaming video frames from the file
- is prepared. An RGB texture object is also allocated here to hold each movie frame image streamed from the file.
- Video streaming is handled by a utility class, CVidBuffer, on a background thread. When the video stream is opened
- here, a stream ID is assigned. CRMVTarget uses that ID to retrieve frames during playback. In addition, to get 
- better performance uploading frame data to the texture object, we employ a round-robin queue of pixel buffer objects.
- During frame N, we copy pixel data for frame N+1 to a PBO and while the data from frame N is being uploaded from 
- another PBO to the texture object.
-
- 4) Segment of shared vertex array in which target's vertices are stored. For all except the two random-dot target
- types, the target primitive is extremely simple: a single quad, a line segment, or a single point. CRMVRenderer 
- allocates a shared vertex array and backing buffer at startup that is large enough to hold 50K vertices. It stores 
- these fixed target primitives at the beginning of the array. The array segment defining a particular fixed primitive 
- is identified by a start index and vertex count, which are exposed as public constants of CRMVRenderer. Each vertex 
- has two attributes -- normalized location (x,y) and corresponding texel location (Tx, Ty) -- as required by the 
- monolithic OpenGL shader program that handles all rendering in RMVideo. The attributes of the fixed primitives never
- change, so they can be shared by multiple targets during an animation sequence. A target-specific transform converts
- each normalized vertex location to its rendered location in the vertex shader.
-
- 5) For RMV_RANDOMDOTS and RMV_FLOWFIELD, the target must query CRMVRenderer for a dedicated segment (start index and
- count) of the shared vertex array in which the individual dot attributes are stored. Furthermore, internal arrays
- are allocated to store per-dot vertex attributes (and, for RMV_RANDOMDOTS, possibly per-dot lifetimes and noise 
- factors). In updateMotion(), the vertex attributes are updated every frame and uploaded to the dedicated segment in
- the shared vertex array.
-
- 6) For RMV_RANDOMDOTS and RMV_FLOWFIELD, the pseudo random number generator used to randomize dot locations is 
- created and initialized here. Also, a second RNG is prepared for any RMV_RANDOMDOTS target using the dot speed or
- direction noise feature.
-
- 7) For RMV_GRATING and RMV_PLAID, the spatial period of each component grating is calculated. If the spatial period
- is too small, the target cannot be rendered and this method fails with an appropriate error message.
-
- @return True if resource allocation was successful; false otherwise. In the event of an error, a brief error
- message is written to the console via fprintf(stderr, ...).
+ Helper method for prepare(): Initialize any additional state information relevant to the target type implemented,
+ and prepare those additional resources required to render the target that do not involve the OpenGL context. This
+ includes computing the alpha mask (unless the renderer can reuse a texture that already holds it), retrieving the 
+ source image of an RMV_IMAGE target and pinning it in the media store's image cache, opening the video stream of an
+ RMV_MOVIE target (which buffers the first frames, pre-rolling to the start frame as needed), and acquiring and 
+ initializing the internal buffers and RNGs of RMV_RANDOMDOTS and RMV_FLOWFIELD targets not animated on the GPU. 
+ The OpenGL resources are allocated later, by allocateResources(). That method's description details the resources
+ required by each target type.
+
+ Like prepare(), this method may run on a worker thread.
+
+ @return True if successful; false otherwise. In the event of an error, a brief error message is written to the 
+ console via fprintf(stderr, ...).
 */
-bool CRMVTarget::allocateResources()
+bool CRMVTarget::prepareResources()
 {
    int t = m_tgtDef.iType;
 
@@ -1547,19 +1597,18 @@ bool CRMVTarget::allocateResources()
       break;
    }
 
-   // for the target types that define a non-rectangular aperture or Gaussian blur, prepare the alpha mask texture.
+   // for the target types that define a non-rectangular aperture or Gaussian blur, compute the alpha mask -- unless 
+   // the renderer computes the aperture and Gaussian window analytically in the fragment shader. If the renderer 
+   // already holds the mask in an unused texture, no mask is computed here.
    // REM: RMV_RANDOMDOTS calculates per-dot alpha and transmits to fragment shader via vertex attribute "Tx"; it
    // does not use the alpha mask texture.
    bool needAlphaMask = m_tgtDef.iAperture != RMV_RECT || m_tgtDef.fSigma[0] > 0.0f || m_tgtDef.fSigma[1] > 0.0f;
-   if(needAlphaMask && (t==RMV_SPOT || t==RMV_GRATING || t==RMV_PLAID))
+   if(needAlphaMask && (t==RMV_SPOT || t==RMV_GRATING || t==RMV_PLAID) && m_pRenderer->isAnalyticApertureMode())
+      m_bWindowed = true;
+   else if(needAlphaMask && (t==RMV_SPOT || t==RMV_GRATING || t==RMV_PLAID))
    {
-      m_texID = m_pRenderer->prepareAlphaMaskTexture(m_tgtDef.iAperture, m_tgtDef.fOuterW, m_tgtDef.fOuterH, 
+      m_pMaskTexels = m_pRenderer->precomputeAlphaMask(m_tgtDef.iAperture, m_tgtDef.fOuterW, m_tgtDef.fOuterH, 
             m_tgtDef.fInnerW, m_tgtDef.fInnerH, m_tgtDef.fSigma[0], m_tgtDef.fSigma[1]);
-      if(m_texID == 0)
-      {
-         ::fprintf(stderr, "ERROR(CRMVTarget): Failed to allocate and load alpha mask texture\n");
-         return(false);
-      }
    }
 
    // for grating/plaid targets, we need to set up some additional runtime state. We also need to make sure that
@@ -1585,11 +1634,11 @@ bool CRMVTarget::allocateResources()
       }
    }
 
-   // RMV_RANDOMDOTS, _FLOWFIELD: Acquire internal buffer maintaining current per-dot vertex attributes. Request
-   // section of shared GPU-side vertex array to which vertex attributes are streamed during animation. Create and
+   // RMV_RANDOMDOTS, _FLOWFIELD: Acquire internal buffer maintaining current per-dot vertex attributes. Create and
    // initialize any random-number generators needed. For _RANDOMDOTS, if applicable, acquire additional internal
-   // buffers that store per-dot lifetimes and noise factors.
-   if(t==RMV_RANDOMDOTS || t==RMV_FLOWFIELD)
+   // buffers that store per-dot lifetimes and noise factors. None of this is needed if the dots are animated by the
+   // renderer's GPU dot engine.
+   if((t==RMV_RANDOMDOTS || t==RMV_FLOWFIELD) && !m_pRenderer->isGPUDotEngineAvailable())
    {
       // allocate array for vertex data: (x,y), (Tx, Ty) -- 4 floats per vertex
       m_pfBufDots = CRMVTarget::getBufferNodeFromPool(m_tgtDef.nDots*4);
@@ -1599,16 +1648,6 @@ bool CRMVTarget::allocateResources()
          return(false);
       }
 
-      // reserve segment in shared vertex array for streaming per-dot vertex attributes for this target
-      int idx = m_pRenderer->reserveSharedVertexArraySegment(m_tgtDef.nDots);
-      if(idx < 0)
-      {
-         fprintf(stderr, "ERROR(CRMVTarget): Insufficient room in shared vertex attribute array\n");
-         return(false);
-      }
-      m_vtxArrayStart = idx;
-      m_vtxArrayCount = m_tgtDef.nDots;
-
       // the RNG for randomizing dot locations
       m_pDotRNG = new CUniformRNG;
       if(m_pDotRNG == NULL)
@@ -1617,6 +1656,18 @@ bool CRMVTarget::allocateResources()
          return(false);
       }
 
+      // the _RANDOMDOTS target keeps its per-dot state in structure-of-arrays form: X, Y, and the per-dot 
+      // displacement coefficients C,S. The interleaved vertex attribute array is only the upload layout.
+      if(t==RMV_RANDOMDOTS)
+      {
+         m_pfBufDotLanes = CRMVTarget::getBufferNodeFromPool(m_tgtDef.nDots*4);
+         if(m_pfBufDotLanes == NULL)
+         {
+            fprintf(stderr, "ERROR(CRMVTarget): Failed to allocate internal per-dot state array\n");
+            return(false);
+         }
+      }
+
       // the _RANDOMDOTS target may need additional arrays, RNG for certain features
       bool enaDotLife = (t==RMV_RANDOMDOTS) && (m_tgtDef.fDotLife != 0.0f);
       if(enaDotLife)
@@ -1669,10 +1720,17 @@ bool CRMVTarget::allocateResources()
       {
          // RMV_RANDOMDOTS does not use an alpha mask texture to implement the various apertures or the Gaussian window.
          // Instead, per-dot alpha is computed every frame and stored in Tx, which here is initialized to 1. When the
-         // aperture is RMV_RECT and there's no Gaussian window, alpha = 1 for all dots at all times.
-         for(int i = 0; i < m_tgtDef.nDots; i++)
+         // aperture is RMV_RECT and there's no Gaussian window, alpha = 1 for all dots at all times. The per-dot
+         // displacement coefficients are initialized to C=1, S=0 -- ie, no noise.
+         int n = m_tgtDef.nDots;
+         float* pfX = m_pfBufDotLanes->pBuf;
+         for(int i = 0; i < n; i++)
          {
-            randomizeDotPos(pfDots[i * 4], pfDots[i * 4 + 1]);
+            randomizeDotPos(pfX[i], pfX[n + i]);
+            pfX[2*n + i] = 1.0f;
+            pfX[3*n + i] = 0.0f;
+            pfDots[i * 4] = pfX[i];
+            pfDots[i * 4 + 1] = pfX[n + i];
             pfDots[i * 4 + 2] = pfDots[i * 4 + 3] = 1.0f;
          }
 
@@ -1689,65 +1747,47 @@ bool CRMVTarget::allocateResources()
       m_tUntilNoiseUpdate = 0.0f; 
    }
 
-   // RMV_IMAGE: Load image data from source file, then allocate RGBA texture object and load image data into it.
-   // Since all drawing is done in logical coordinates -- "visual degrees", convert image W,H in pixels to visual
-   // degrees and store in relevant members of the target definition. 
+   // RMV_IMAGE: Load image data from source file. Since all drawing is done in logical coordinates -- "visual 
+   // degrees", convert image W,H in pixels to visual degrees and store in relevant members of the target definition.
    if(t==RMV_IMAGE)
    {
       // load the image data in RGBA format. If source file is in another format (RGB, monochrome), it is converted to 
-      // RGBA format. NOTE: Image data buffer is cached by media store -- do not free and do not save reference!
-      int wPix = 0, hPix = 0;
-      unsigned char* pImg = m_pRenderer->getImage(m_tgtDef.strFolder, m_tgtDef.strFile, wPix, hPix);
-      if(pImg == NULL || wPix <= 0 || hPix <= 0)
+      // RGBA format. NOTE: Image data buffer is cached by media store -- do not free! We pin it in the cache so that it
+      // remains valid while other targets are prepared, until it is loaded into the texture by allocateResources().
+      m_pImgPixels = m_pRenderer->getImage(m_tgtDef.strFolder, m_tgtDef.strFile, m_wImgPix, m_hImgPix, true);
+      if(m_pImgPixels == NULL || m_wImgPix <= 0 || m_hImgPix <= 0)
       {
          ::fprintf(stderr, "ERROR(CRMVTarget): Failed to load image data from media file '%s/%s'\n", 
             m_tgtDef.strFolder, m_tgtDef.strFile);
          return(false);
       }
 
-      // generate texture object and load image data into it.
-      m_texID = m_pRenderer->prepareImageTexture(true, wPix, hPix, pImg);
-      if(m_texID == 0)
-      {
-         ::fprintf(stderr, "ERROR(CRMVTarget): Failed to allocate and load image texture\n");
-         return(false);
-      }
-
       // since drawing coordinates are in visual degrees, we compute the image's rectangular dimensions in those
       // coordinates and store them as the "target window" dimensions. 
-      double w = wPix;
-      double h = hPix;
+      double w = m_wImgPix;
+      double h = m_hImgPix;
       m_pRenderer->convertPixelDimsToDeg(w, h);
       m_tgtDef.fOuterW = (float) w;
       m_tgtDef.fOuterH = (float) h;
    }
 
-   // RMV_MOVIE: Open video source file and prepare infrastructure for streaming video frame. Allocate image
-   // texture object onto which video frames are blitted during playback. Initialize playback state.
+   // RMV_MOVIE: Open video source file and prepare infrastructure for streaming video frame. Initialize playback state.
    if(t==RMV_MOVIE)
    {
       char path[256];
       ::sprintf(path, "%s/%s/%s", CRMVMediaMgr::MEDIASTOREDIR, m_tgtDef.strFolder, m_tgtDef.strFile);
-      m_videoStreamID = m_pRenderer->m_vidBuffer.openVideoStream(path, false, (m_tgtDef.iFlags & RMV_F_REPEAT)==0);
+      m_videoStreamID = m_pRenderer->m_vidBuffer.openVideoStream(path, false, (m_tgtDef.iFlags & RMV_F_REPEAT)==0,
+            m_tgtDef.iSeed);
       if(m_videoStreamID < 0)
       {
          ::fprintf(stderr, "ERROR(CRMVTarget): Failed to open and buffer video stream\n");
          return(false);
       }
 
-      int wPix = m_pRenderer->m_vidBuffer.getVideoWidth(m_videoStreamID);
-      int hPix = m_pRenderer->m_vidBuffer.getVideoHeight(m_videoStreamID);
-      m_texID = m_pRenderer->prepareImageTexture(false, wPix, hPix, NULL);
-      if(m_texID == 0)
-      {
-         ::fprintf(stderr, "ERROR(CRMVTarget): Failed to allocate and load image texture for movie frames\n");
-         return(false);
-      }
-
       // since drawing coordinates are in visual degrees, we compute the movie frame's rectangular dimensions in those
       // coordinates and store them as the "target window" dimensions. 
-      double w = wPix;
-      double h = hPix;
+      double w = m_pRenderer->m_vidBuffer.getVideoWidth(m_videoStreamID);
+      double h = m_pRenderer->m_vidBuffer.getVideoHeight(m_videoStreamID);
       m_pRenderer->convertPixelDimsToDeg(w, h);
       m_tgtDef.fOuterW = (float) w;
       m_tgtDef.fOuterH = (float) h;
@@ -1763,27 +1803,208 @@ bool CRMVTarget::allocateResources()
          if(rateHz > 0) m_tPlaybackIntv = 1000.0/rateHz;
       }
       m_iMovieState = MOVIE_NOTSTARTED;
+   }
+
+   return(true);
+}
+
+/**
+ Helper method for completeInitialization(): Allocate any additional OpenGL resources required to render the target,
+ using the state and resources prepared by prepareResources(). Must be called on the GL thread. The resources needed by 
+ each target type are described below; some of them are prepared by prepareResources() instead, as noted.
+
+ 1) Alpha mask texture. RMV_SPOT, _GRATING, _PLAID and _RANDOMDOTS all support a non-rectangular aperture and a 2D
+ Gaussian blur. Both aperture and blur are implemented by an alpha mask texture object generated here -- but NOT for
+ the RMV_RANDOMDOTS target. The mask itself is usually computed in prepareResources().
+
+ For RMV_RANDOMDOTS, each dot is either inside or outside the aperture, regardless the dot size; it cannot be partly
+ obscured at the aperture boundary). The per-dot alpha component is computed every frame based on the dot's location,
+ which typically changes during an animation. That alpha component is transmitted to the fragment shader via the
+ vertex attribute "Tx", the X-coordinate of the dot's texel location in the applied texture -- which will be the
+ default "alpha=1" mask. In the fragment shader, the result of the texturing operation is ignored, and the fragment
+ alpha is set to the value of Tx. Note that, if the aperture is RMV_RECT and there's no Gaussian window, then all
+ dots have alpha = 1 always.
+
+ 2) RMV_IMAGE. An RGBA texture object is allocated and loaded with the image data here. The image data is retrieved
+ from the media store in prepareResources().
+
+ 3) RMV_MOVIE. The video source file is opened in prepareResources(), and all of the infrastructure for streaming 
+ video frames from the file is prepared. An RGB texture object is allocated here to hold each movie frame image 
+ streamed from the file. Video streaming is handled by a utility class, CVidBuffer, on a background thread. When the 
+ video stream is opened, a stream ID is assigned. CRMVTarget uses that ID to retrieve frames during playback. In 
+ addition, to get better performance uploading frame data to the texture object, we employ a round-robin queue of pixel
+ buffer objects. During frame N, we copy pixel data for frame N+1 to a PBO and while the data from frame N is being
+ uploaded from another PBO to the texture object.
+
+ 4) Segment of shared vertex array in which target's vertices are stored. For all except the two random-dot target
+ types, the target primitive is extremely simple: a single quad, a line segment, or a single point. CRMVRenderer 
+ allocates a shared vertex array and backing buffer at startup that is large enough to hold 50K vertices. It stores 
+ these fixed target primitives at the beginning of the array. The array segment defining a particular fixed primitive 
+ is identified by a start index and vertex count, which are exposed as public constants of CRMVRenderer. Each vertex 
+ has two attributes -- normalized location (x,y) and corresponding texel location (Tx, Ty) -- as required by the 
+ monolithic OpenGL shader program that handles all rendering in RMVideo. The attributes of the fixed primitives never
+ change, so they can be shared by multiple targets during an animation sequence. A target-specific transform converts
+ each normalized vertex location to its rendered location in the vertex shader.
+
+ 5) For RMV_RANDOMDOTS and RMV_FLOWFIELD, the target must query CRMVRenderer for a dedicated segment (start index and
+ count) of the shared vertex array in which the individual dot attributes are stored. Furthermore, internal arrays
+ are allocated in prepareResources() to store per-dot vertex attributes (and, for RMV_RANDOMDOTS, possibly per-dot 
+ lifetimes and noise factors). In updateMotion(), the vertex attributes are updated every frame and uploaded to the
+ dedicated segment in the shared vertex array.
+
+ 6) For RMV_RANDOMDOTS and RMV_FLOWFIELD, the pseudo random number generator used to randomize dot locations is 
+ created and initialized in prepareResources(). Also, a second RNG is prepared for any RMV_RANDOMDOTS target using the
+ dot speed or direction noise feature.
+
+ 7) For RMV_GRATING and RMV_PLAID, the spatial period of each component grating is calculated in prepareResources().
+ If the spatial period is too small, the target cannot be rendered and that method fails with an error message.
+
+ @return True if resource allocation was successful; false otherwise. In the event of an error, a brief error
+ message is written to the console via fprintf(stderr, ...).
+*/
+bool CRMVTarget::allocateResources()
+{
+   int t = m_tgtDef.iType;
 
-      // create a round-robin queue of pixel buffer objects used to upload video frames to the texture object
-      glGenBuffers(NUMPBOS, m_pboIDs);
-      for(int i=0; i<NUMPBOS; i++)
+   // prepare the alpha mask texture from the mask computed by prepareResources(), if any. If the mask was not computed
+   // because the renderer already held it in an unused texture, the renderer reuses that texture or computes the mask.
+   bool needAlphaMask = m_tgtDef.iAperture != RMV_RECT || m_tgtDef.fSigma[0] > 0.0f || m_tgtDef.fSigma[1] > 0.0f;
+   if(needAlphaMask && (t==RMV_SPOT || t==RMV_GRATING || t==RMV_PLAID) && !m_bWindowed)
+   {
+      m_texID = m_pRenderer->prepareAlphaMaskTexture(m_tgtDef.iAperture, m_tgtDef.fOuterW, m_tgtDef.fOuterH, 
+            m_tgtDef.fInnerW, m_tgtDef.fInnerH, m_tgtDef.fSigma[0], m_tgtDef.fSigma[1], m_pMaskTexels);
+      if(m_pMaskTexels != NULL)
       {
-         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pboIDs[i]);
-         glBufferData(GL_PIXEL_UNPACK_BUFFER, m_pRenderer->m_vidBuffer.getVideoFrameSize(m_videoStreamID), 
-               NULL, GL_STREAM_DRAW);
+         ::free(m_pMaskTexels);
+         m_pMaskTexels = NULL;
+      }
+      if(m_texID == 0)
+      {
+         ::fprintf(stderr, "ERROR(CRMVTarget): Failed to allocate and load alpha mask texture\n");
+         return(false);
+      }
+   }
+
+   // RMV_RANDOMDOTS, _FLOWFIELD animated by the renderer's GPU dot engine, if enabled: The dot state resides entirely
+   // in a pair of GPU-side vertex arrays owned by the target, and the initial dot pattern is generated on the GPU.
+   // No CPU-side buffers or RNGs are needed, and no segment of the shared vertex array is reserved.
+   if((t==RMV_RANDOMDOTS || t==RMV_FLOWFIELD) && m_pRenderer->isGPUDotEngineAvailable())
+   {
+      if(!m_pRenderer->createGPUDotBuffers(m_tgtDef.nDots, m_gpuDotVAOs, m_gpuDotVBOs))
+      {
+         fprintf(stderr, "ERROR(CRMVTarget): Failed to allocate GPU dot engine buffers\n");
+         return(false);
+      }
+      m_bGPUDots = true;
+      m_iGPUDotBuf = 0;
+      m_gpuDotPass = 0;
+      m_vtxArrayStart = 0;
+      m_vtxArrayCount = m_tgtDef.nDots;
+      runGPUDotPass(true, 0.0f, NULL);
+
+      // so dir/speed noise updated on first frame (if enabled)
+      m_tUntilNoiseUpdate = 0.0f;
+   }
+
+   // RMV_RANDOMDOTS, _FLOWFIELD: Request section of shared GPU-side vertex array to which the per-dot vertex 
+   // attributes are streamed during animation.
+   if((t==RMV_RANDOMDOTS || t==RMV_FLOWFIELD) && !m_bGPUDots)
+   {
+      int idx = m_pRenderer->reserveSharedVertexArraySegment(m_tgtDef.nDots);
+      if(idx < 0)
+      {
+         fprintf(stderr, "ERROR(CRMVTarget): Insufficient room in shared vertex attribute array\n");
+         return(false);
+      }
+      m_vtxArrayStart = idx;
+      m_vtxArrayCount = m_tgtDef.nDots;
+   }
+
+   // RMV_IMAGE: Allocate RGBA texture object and load the image data retrieved by prepareResources() into it. The 
+   // image is then unpinned in the media store's image cache; we do not keep a reference to it.
+   if(t==RMV_IMAGE)
+   {
+      m_texID = m_pRenderer->prepareImageTexture(true, m_wImgPix, m_hImgPix, m_pImgPixels);
+      m_pRenderer->unpinImage(m_tgtDef.strFolder, m_tgtDef.strFile);
+      m_pImgPixels = NULL;
+      if(m_texID == 0)
+      {
+         ::fprintf(stderr, "ERROR(CRMVTarget): Failed to allocate and load image texture\n");
+         return(false);
+      }
+   }
+
+   // RMV_MOVIE: Allocate image texture object onto which video frames are blitted during playback, and the pixel 
+   // buffer object(s) through which they are uploaded.
+   if(t==RMV_MOVIE)
+   {
+      int wPix = m_pRenderer->m_vidBuffer.getVideoWidth(m_videoStreamID);
+      int hPix = m_pRenderer->m_vidBuffer.getVideoHeight(m_videoStreamID);
+      if(m_pRenderer->m_vidBuffer.isVideoYUV(m_videoStreamID))
+         m_texID = m_pRenderer->prepareYUVFrameTexture(wPix, hPix);
+      else
+         m_texID = m_pRenderer->prepareImageTexture(false, wPix, hPix, NULL);
+      if(m_texID == 0)
+      {
+         ::fprintf(stderr, "ERROR(CRMVTarget): Failed to allocate and load image texture for movie frames\n");
+         return(false);
+      }
+
+      // in zero-copy mode, the video stream's frame queue is moved into a persistently mapped PBO, so that frames are
+      // decoded directly into memory from which they are uploaded to the texture object. If that fails, fall back on
+      // a round-robin queue of pixel buffer objects used to upload video frames to the texture object.
+      if(m_pRenderer->isZeroCopyMovieMode())
+      {
+         m_frameStoreID = m_pRenderer->createMovieFrameStore(
+               m_pRenderer->m_vidBuffer.getFrameStoreSize(m_videoStreamID), &m_pFrameStore);
+         if(m_frameStoreID != 0 && !m_pRenderer->m_vidBuffer.attachFrameStore(m_videoStreamID, m_pFrameStore))
+         {
+            m_pRenderer->releaseMovieFrameStore(m_frameStoreID);
+            m_frameStoreID = 0;
+            m_pFrameStore = NULL;
+         }
+         if(m_frameStoreID == 0)
+            ::fprintf(stderr, "WARNING(CRMVTarget): Zero-copy frame store unavailable; copying frames to PBOs\n");
+      }
+      if(m_frameStoreID == 0)
+      {
+         glGenBuffers(NUMPBOS, m_pboIDs);
+         for(int i=0; i<NUMPBOS; i++)
+         {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pboIDs[i]);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, m_pRenderer->m_vidBuffer.getVideoFrameSize(m_videoStreamID), 
+                  NULL, GL_STREAM_DRAW);
+         }
+         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
       }
-      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
    } 
 
    return(true);
 }
 
-/** Free any resources that were successfully allocated in a previous call to allocateResources(). */
+/** Free any resources that were successfully prepared or allocated by prepareResources() and allocateResources(). */
 void CRMVTarget::freeResources()
 {
    if(m_pRenderer != NULL && m_texID != 0) m_pRenderer->releaseTexture(m_texID);
+   if(m_pRenderer != NULL && m_frameStoreID != 0) m_pRenderer->releaseMovieFrameStore(m_frameStoreID);
+   m_frameStoreID = 0;
+   m_pFrameStore = NULL;
+   m_bHoldingFrame = false;
+   if(m_pRenderer != NULL && m_bGPUDots) m_pRenderer->releaseGPUDotBuffers(m_gpuDotVAOs, m_gpuDotVBOs);
+   m_bGPUDots = false;
+   m_iGPUDotBuf = 0;
+   m_gpuDotPass = 0;
+   if(m_pRenderer != NULL && m_pImgPixels != NULL) m_pRenderer->unpinImage(m_tgtDef.strFolder, m_tgtDef.strFile);
+   m_pImgPixels = NULL;
+   m_wImgPix = m_hImgPix = 0;
    m_pRenderer = NULL;
    m_texID = 0;
+   m_bWindowed = false;
+   if(m_pMaskTexels != NULL)
+   {
+      ::free(m_pMaskTexels);
+      m_pMaskTexels = NULL;
+   }
 
    m_vtxArrayStart = m_vtxArrayCount = 0;
 
@@ -1792,6 +2013,11 @@ void CRMVTarget::freeResources()
       CRMVTarget::releaseBufferNodeToPool(m_pfBufDots);
       m_pfBufDots = NULL;
    }
+   if(m_pfBufDotLanes != NULL)
+   {
+      CRMVTarget::releaseBufferNodeToPool(m_pfBufDotLanes);
+      m_pfBufDotLanes = NULL;
+   }
    if(m_pfBufDotLives != NULL)
    {
       CRMVTarget::releaseBufferNodeToPool(m_pfBufDotLives);
@@ -1841,14 +2067,7 @@ void CRMVTarget::freeResources()
 */
 void CRMVTarget::randomizeDotPos(float& x, float& y)
 {
-   double dH = m_pDotRNG->generate();                                      // pick random coords in (0..1)
-   double dV = m_pDotRNG->generate();
-
-   dH = (dH-0.5) * m_tgtDef.fOuterW;                                       // map to dims of bounding rectangle
-   dV = (dV-0.5) * m_tgtDef.fOuterH;
-
-   x = float(dH);                                                          // return coords by reference
-   y = float(dV);
+   CRMVDotKernel::randomizeDotPos(m_tgtDef, m_pDotRNG, x, y);
 }
 
 /**
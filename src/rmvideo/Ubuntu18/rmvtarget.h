@@ -8,6 +8,7 @@
 #if !defined(RMVTARGET_H_INCLUDED_)
 #define RMVTARGET_H_INCLUDED_
 
+#include <pthread.h>
 #include "utilities.h"                 // utility classes
 #include "rmvideo_common.h"            // basic constants/definitions shared w/Maestro
 
@@ -30,10 +31,11 @@ private:
       FloatBufNode* pNext;
    };
    static FloatBufNode* g_FloatBufPool;
+   static pthread_mutex_t g_FloatBufPoolMutex;     // guards the pool, since targets may be prepared in parallel
 
-   // get a buffer for dot storage from buffer pool, allocating new one if necessary.
+   // get a buffer for dot storage from buffer pool, allocating new one if necessary. Thread-safe.
    static FloatBufNode* getBufferNodeFromPool(int sz);
-   // release a buffer back to buffer pool
+   // release a buffer back to buffer pool. Thread-safe.
    static void releaseBufferNodeToPool(FloatBufNode* pNode);
 
 public:
@@ -42,9 +44,17 @@ public:
 
    // prepare target object for an animation sequence
    bool initialize(CRMVRenderer* pRenderer, const RMVTGTDEF& tgtDef);
+   // the two stages of initialize(): CPU-side preparation, which may run on a worker thread, then allocation of 
+   // OpenGL resources, which must run on the GL thread
+   bool prepare(CRMVRenderer* pRenderer, const RMVTGTDEF& tgtDef);
+   bool completeInitialization();
 
    // update target's internal rep IAW specified motion. Returns false if animation seq should terminate on error.
-   bool updateMotion(float tElapsed, PRMVTGTVEC pVec);
+   bool updateMotion(float tElapsed, PRMVTGTVEC pVec, bool bDeferUpload = false);
+   // can updateMotion() be called on a worker thread (with upload deferred)?
+   bool canUpdateOffGLThread();
+   // upload dot-patch vertex data deferred by the last updateMotion() call. Must be called on GL thread.
+   void uploadPendingVertexData();
 
 private:
    // updateMotion() helper methods
@@ -53,6 +63,7 @@ private:
    void updateRandomDots(float tElapsed, PRMVTGTVEC pVec);
    void updateFlowField(PRMVTGTVEC pVec);
    bool updateMovie(float tElapsed, PRMVTGTVEC pVec);
+   void runGPUDotPass(bool bInit, float tElapsed, PRMVTGTVEC pVec);
 
 public:
    // render target IAW current state
@@ -86,6 +97,11 @@ private:
    // RGB texture. For targets with non-rectangular aperture and/or Gaussian blur, it will be a single-component
    // texture defining the target's "alpha mask".
    unsigned int m_texID;
+   // RMV_SPOT, _GRATING, _PLAID: true if the aperture and Gaussian window are computed analytically in the fragment
+   // shader (renderer's analytic aperture mode), in which case no alpha mask texture is needed.
+   bool m_bWindowed;
+   // alpha mask computed by prepare(), if any, until it is loaded into the texture by completeInitialization()
+   unsigned char* m_pMaskTexels;
 
    // start index and size of segment in OpenGL renderer's shared vertex array that's dedicated to this target
    int m_vtxArrayStart;
@@ -93,11 +109,18 @@ private:
 
    // additional animation state information and resources for select target types...
    FloatBufNode* m_pfBufDots;             // RMV_RANDOMDOTS, _FLOWFIELD: vertex attrs {x, y, Tx, Ty}
+   FloatBufNode* m_pfBufDotLanes;         // RMV_RANDOMDOTS: per-dot state in SoA lanes {X[N], Y[N], C[N], S[N]}
+   bool m_bVtxUploadPending;              // RMV_RANDOMDOTS, _FLOWFIELD: vertex data upload deferred
    FloatBufNode* m_pfBufDotLives;         // RMV_RANDOMDOTS: current per-dot lifetimes, if applicable
    FloatBufNode* m_pfBufDotNoise;         // RMV_RANDOMDOTS: current per-dot noise factors, if applicable
    CRandomNG* m_pDotRNG;                  // RMV_RANDOMDOTS, _FLOWFIELD: for randomizing dot pos and other uses
    CRandomNG* m_pNoiseRNG;                // RMV_RANDOMDOTS: for speed/directional noise feature
    float m_tUntilNoiseUpdate;             // RMV_RANDOMDOTS: time until next noise update, in ms
+   bool m_bGPUDots;                       // RMV_RANDOMDOTS, _FLOWFIELD: animated by renderer's GPU dot engine
+   unsigned int m_gpuDotVAOs[2];          // GPU dot engine: ping-pong vertex arrays and buffers holding dot state
+   unsigned int m_gpuDotVBOs[2];
+   int m_iGPUDotBuf;                      // GPU dot engine: index of the vertex array holding the current dot state
+   unsigned int m_gpuDotPass;             // GPU dot engine: # of passes run so far (part of the RNG key)
  
    static const int MINGRATCYCLE = 8;     // minimum supported # pixels per grating cycle
    float m_fSpatialPerX[2];               // RMV_GRATING, _PLAID: grating spatial period along X axis
@@ -108,6 +131,12 @@ private:
    static const int NUMPBOS = 3;          // RMV_MOVIE: Pixel buffer objects for uploading video frames to texture
    unsigned int m_pboIDs[NUMPBOS];
    int m_iCurrPBOIdx;                     // index of PBO currently being uploaded to texture
+   unsigned int m_frameStoreID;           // RMV_MOVIE, zero-copy mode: persistently mapped PBO holding frame queue
+   unsigned char* m_pFrameStore;          //    (in lieu of the PBO queue above), its mapped address, and flag set
+   bool m_bHoldingFrame;                  //    while the current frame's queue slot is held for upload
+
+   unsigned char* m_pImgPixels;           // RMV_IMAGE: image data pinned in the media store's image cache by
+   int m_wImgPix, m_hImgPix;              //    prepare() until loaded into texture, and its dimensions in pixels
 
    int m_videoStreamID;                   // RMV_MOVIE: ID of open video stream
    int m_iMovieState;                     // RMV_MOVIE: playback state:
@@ -126,7 +155,8 @@ private:
    bool validateTargetDef();           // validate target definition and range-limit various parameters
    void initTargetColors();            // convert target colors from packed RGB to normalized R,G,B components
 
-   // allocate additional resources required to render/animate target (depends on target type)
+   // prepare, then allocate, additional resources required to render/animate target (depends on target type)
+   bool prepareResources();
    bool allocateResources();
    void freeResources();
 
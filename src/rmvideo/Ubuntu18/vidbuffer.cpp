@@ -178,9 +178,35 @@
  worker thread, so the main thread now runs with normal SCHED_OTHER priority. See DESCRIPTION and PERFORMANCE TESTING.
  28jan2020-- Suppress all log messages from FFMPEG library via call to av_log_set_level() in getVideoInfo(), which is
  called early during RMVideo start-up.
+ 16oct2026-- (1) A single worker thread, round-robining over all open streams, could not keep the frame queues full 
+ when two HD movies were played at once. CVidBuffer now launches one persistent worker thread per stream slot, so each
+ stream is decoded independently (in addition to FFMPEG's own frame/slice threading within each decoder). A worker
+ sleeps briefly whenever its stream's queue is full, rather than spinning. (2) For sources decoded to planar YUV 4:2:0
+ -- by far the most common case --, the sws_scale() colorspace conversion to RGB24 is skipped. The Y, U and V planes
+ are copied into the frame queue as is, at half the size of an RGB24 frame, and the renderer converts them to RGB on
+ the GPU. Other source formats are still converted to RGB24. See isVideoYUV(). (3) The per-frame memset() of the next
+ frame queue buffer was unnecessary, since every byte of the buffer is overwritten. Removed.
+ 16oct2026-- Added attachFrameStore(), which replaces a stream's frame queue buffers with caller-supplied storage --
+ in practice, a persistently mapped pixel buffer object owned by the renderer. The worker thread then decodes each
+ frame directly into memory the GPU uploads from, so a frame is written exactly once, and the per-frame memcpy() into
+ a PBO on the render thread disappears. Also added per-stream decode statistics (getDecodeStats()) and a standalone
+ benchmark(), which reports the bytes copied and time spent per frame with and without an attached frame store.
+ 16oct2026-- (1) openVideoStream() accepts a start frame. The stream seeks to the keyframe at or before that frame and
+ pre-rolls to it by decoding and discarding the intervening frames, all before the method returns; a looping stream
+ wraps back to the start frame rather than the beginning of the file. (2) Upon reaching EOF, the frames held in the
+ decoder's pipeline are now drained rather than discarded, so the last few frames of the video are no longer lost. (3)
+ A looping stream keeps a copy of the first frames buffered in a head cache. On wrap, the cached frames are queued
+ while the decoder seeks and pre-rolls past them, rather than stalling the stream's worker on a rewind and re-decode.
+ 16oct2026-- getVideoInfo() may now be called from several threads at once (CRMVMediaMgr probes new media files in 
+ parallel). Registration of FFMPEG formats and codecs and suppression of its log messages are done exactly once, in
+ initLibrary().
+ 16oct2026-- openVideoStream() may now be called from several threads at once, so that CRMVRenderer::loadTargets() can
+ open and pre-roll the video streams of several RMV_MOVIE targets in parallel. A stream slot is claimed atomically on
+ entry. If the open fails, the slot is left closed -- buffering skips it --, and is reclaimed by closeAllVideoStreams().
 //===================================================================================================================*/
 
 #include <stdio.h>
+#include <unistd.h>
 #include "time.h"
 #include "pthread.h"
 #include "utilities.h"
@@ -188,10 +214,32 @@
 #include "vidbuffer.h"
 
 
+/**
+ * Register all available FFMPEG formats and codecs, and suppress all log messages from the FFMPEG library. The work is
+ * done only on the first call; it is safe to call this method from multiple threads at once.
+ */
+void CVidBuffer::initLibrary()
+{
+   static pthread_once_t once = PTHREAD_ONCE_INIT;
+   ::pthread_once(&once, CVidBuffer::initLibraryOnce);
+}
+
+void CVidBuffer::initLibraryOnce()
+{
+   av_register_all();
+
+   int level = av_log_get_level();
+   if(level != AV_LOG_QUIET)
+   {
+      ::fprintf(stderr, "[NOTE: Suppressing all log messages from FFMPEG. Log level was %d.]\n", level);
+      av_log_set_level(AV_LOG_QUIET);
+   }
+}
+
 /**
  * Open the specified video file and retrieve information about the first video stream therein. This method is used
  * to verify that a file in the RMVideo media store can be read and processed as a video. If any problems are
- * encountered, the method optionally prints a brief error description to stderr.
+ * encountered, the method optionally prints a brief error description to stderr. It may be called from any thread.
  * @param path Pathname of the file to open.
  * @param w, h, r, d [out] Information returned about the video: frame width and height in pixels, frame rate in
  * milli-Hz, and the approximate movie duration (at specified frame rate) in milliseconds. Any unknown values will
@@ -202,16 +250,8 @@
  */
 bool CVidBuffer::getVideoInfo(const char* path, int& w, int& h, int& r, int& d, bool quiet)
 {
-   // make sure we've registered all available formats and codecs (after first invocation, method has no effect)
-   av_register_all();
-
-   // suppress all logging messages from FFMPEG library
-   int level = av_log_get_level();
-   if(level != AV_LOG_QUIET)
-   {
-      ::fprintf(stderr, "[NOTE: Suppressing all log messages from FFMPEG. Log level was %d.]\n", level);
-      av_log_set_level(AV_LOG_QUIET);
-   }
+   // make sure we've registered all available formats and codecs, and suppressed FFMPEG log messages
+   CVidBuffer::initLibrary();
 
    // open the source video file
    AVFormatContext* pFormatCtx = NULL;
@@ -296,10 +336,108 @@ bool CVidBuffer::getVideoInfo(const char* path, int& w, int& h, int& r, int& d,
    return(true);
 }
 
+/**
+ Benchmark the cost of streaming frames from the specified video file through CVidBuffer to a consumer, with and 
+ without an attached frame store (see attachFrameStore()). Intended to be run from the command line on the RMVideo
+ workstation, without a GL context; RMVideo is not running. The video is streamed twice, each time up to the first
+ nFrames frames (or until EOF), with the consumer taking each frame as soon as it is available:
+    "copy": CVidBuffer's own frame queue; the consumer copies each frame into a separate buffer, as CRMVTarget does 
+ when it copies each frame into a pixel buffer object.
+    "zero-copy": an external frame store is attached; the consumer reads the frame in place, as the GPU does when the
+ frame store is a persistently mapped pixel buffer.
+ For each pass, the method prints to stderr the frame count, the throughput, the average time the worker thread spent
+ decoding and storing each frame, the average time the consumer spent copying each frame, and the number of bytes 
+ written per frame by the worker thread and by the consumer. 
+
+ NOTE: The "pixel buffer" here is ordinary memory. In RMVideo, it is typically uncached, write-combined memory, so the
+ copy to it is usually slower than measured here.
+
+ @param path Pathname of the video file.
+ @param nFrames Maximum number of frames to stream in each pass. If non-positive, 600 frames are streamed.
+ @return True if successful; false otherwise.
+*/
+bool CVidBuffer::benchmark(const char* path, int nFrames)
+{
+   CVidBuffer vb;
+   if(!vb.initialize()) return(false);
+   if(nFrames <= 0) nFrames = 600;
+
+   struct timespec tSpec;
+   tSpec.tv_sec = (time_t) 0;
+   tSpec.tv_nsec = 100000;
+
+   bool ok = true;
+   for(int pass=0; ok && pass<2; pass++)
+   {
+      bool zeroCopy = (pass == 1);
+      int id = vb.openVideoStream(path, true, true);
+      if(id < 0) 
+      {
+         ok = false;
+         break;
+      }
+
+      int nBytes = vb.getVideoFrameSize(id);
+      uint8_t* pDst = (uint8_t*) ::malloc(zeroCopy ? vb.getFrameStoreSize(id) : nBytes);
+      if(pDst == NULL || (zeroCopy && !vb.attachFrameStore(id, pDst)))
+      {
+         ::fprintf(stderr, "ERROR(CVidBuffer): Benchmark failed to allocate or attach frame store\n");
+         vb.closeAllVideoStreams();
+         if(pDst != NULL) ::free(pDst);
+         ok = false;
+         break;
+      }
+
+      int n = 0;
+      double tCopy = 0;
+      volatile uint8_t touched = 0;
+      CElapsedTime tTotal;
+      vb.startBuffering();
+      while(n < nFrames)
+      {
+         uint8_t* pFrame = vb.getCurrentFrameData(id);
+         if(pFrame == NULL)
+         {
+            if(vb.isVideoDisabled(id) || vb.gotEOF(id)) break;
+            ::nanosleep(&tSpec, NULL);
+            continue;
+         }
+         if(zeroCopy) 
+            touched = pFrame[nBytes-1];
+         else
+         {
+            CElapsedTime tc;
+            ::memcpy(pDst, pFrame, nBytes);
+            tCopy += tc.get();
+         }
+         vb.advanceToNextFrame(id);
+         ++n;
+      }
+      double tElapsed = tTotal.get();
+      vb.stopBuffering();
+      (void) touched;
+
+      int nDecoded = 0;
+      double avgDecodeUS = 0;
+      vb.getDecodeStats(id, nDecoded, avgDecodeUS);
+      ::fprintf(stderr, "[CVidBuffer] Benchmark %dx%d %s, %s: %d frames in %.3f s (%.1f fps); decode+store = %.0f "
+            "us/frame, consumer copy = %.0f us/frame; bytes written/frame: worker = %d, consumer = %d\n", 
+            vb.getVideoWidth(id), vb.getVideoHeight(id), vb.isVideoYUV(id) ? "YUV420" : "RGB24", 
+            zeroCopy ? "zero-copy" : "copy", n, tElapsed, (tElapsed > 0) ? n/tElapsed : 0.0, avgDecodeUS, 
+            (n > 0) ? tCopy*1.0e6/n : 0.0, nBytes, zeroCopy ? 0 : nBytes);
+
+      vb.closeAllVideoStreams();
+      ::free(pDst);
+   }
+   return(ok);
+}
+
 
 CVidBuffer::CVidBuffer()
 {
-   m_bOn = m_bAlive = m_bBufferEna = m_bBuffering = false;
+   m_bOn = m_bBufferEna = false;
+   m_nAlive = m_nBuffering = 0;
+   m_nextWorker = 0;
 
    m_nStreams = 0;
    for(int i=0; i<CVidBuffer::MAXSTREAMS; i++)
@@ -314,12 +452,24 @@ CVidBuffer::CVidBuffer()
       pStream->pCodecCtx = NULL;
       pStream->pSwsCtx = NULL;
       pStream->pDstFrame = NULL;
+      pStream->isYUV = false;
+      pStream->isFullRange = false;
       for(int j=0; j<CVidBuffer::QSIZE; j++) pStream->frameQueue[j] = NULL;
+      pStream->isExtStore = false;
+      pStream->nDecoded = 0;
+      pStream->tDecodeUS = 0.0;
       pStream->iRead = 0;
       pStream->iWrite = 0;
       pStream->nBytes = 0;
       pStream->disabledOnError = true;
       pStream->gotEOF = false;
+      pStream->draining = false;
+      pStream->startFrame = 0;
+      pStream->skipToTS = AV_NOPTS_VALUE;
+      pStream->nSkipFrames = 0;
+      for(int j=0; j<CVidBuffer::QSIZE; j++) pStream->headCache[j] = NULL;
+      pStream->nHead = 0;
+      pStream->iHead = -1;
       pStream->width = 0;
       pStream->height = 0;
       pStream->rate = 0;
@@ -329,17 +479,17 @@ CVidBuffer::CVidBuffer()
 CVidBuffer::~CVidBuffer()
 {
    terminate();
-   m_bOn = m_bAlive = m_bBufferEna = m_bBuffering = false;
+   m_bOn = m_bBufferEna = false;
 }
 
 /**
  Initialize the video streamer object.
 
- On the first invocation of this method, the background buffering thread is launched with the same thread attributes
- as the calling thread, which should be RMVideo's main thread. [It is assumed both threads run with nomral 
- SCHED_OTHER priority and can run on any processor. Proper operation requires that RMVideo run on a multi-core
- machine (preferably 4 cores or more).] The buffering thread enters an idle state until there's at least one open
- video stream and buffering has been enabled.
+ On the first invocation of this method, the background buffering threads -- one per stream slot -- are launched with
+ the same thread attributes as the calling thread, which should be RMVideo's main thread. [It is assumed all threads
+ run with normal SCHED_OTHER priority and can run on any processor. Proper operation requires that RMVideo run on a
+ multi-core machine (preferably 4 cores or more).] Each buffering thread enters an idle state until its stream slot
+ holds an open video stream and buffering has been enabled.
 
  Later invocations of the method will simply call reset() to ensure buffering is disabled and any open video streams
  are closed. Testing found that repeatedly terminating and relaunching the buffering thread led to performance
@@ -353,37 +503,43 @@ bool CVidBuffer::initialize()
    // if the buffering thread is running, ensure buffering is disabled and all open video streams are closed
    reset();
 
-   // if buffering thread is alive, there's nothing more to do.
-   if(m_bAlive) return(true);
+   // if buffering threads are alive, there's nothing more to do.
+   if(m_nAlive > 0) return(true);
 
    int errCode = 0;
    bool ok = true;
 
-   // start the worker thread. It should set the "alive" flag and open the video file. Wait up to 1 second for
-   // this to happen.
+   // start the worker threads. Each should claim a stream slot and increment the "alive" count. Wait up to 1 second 
+   // for this to happen.
    pthread_t workerThrd;
-   if(ok)
+   m_bOn = true;
+   m_nextWorker = 0;
+   for(int i=0; ok && i<CVidBuffer::MAXSTREAMS; i++)
    {
-      m_bOn = true;
       ok = (0 == ::pthread_create(&workerThrd, NULL, CVidBuffer::runEntryPoint, this));
-      if(!ok) 
-         errCode = 3;
-      else
-      { 
-         CElapsedTime eTime;
-         volatile long count = 0;
-         while(eTime.get() < 1.0 && !m_bAlive) ++count;
-
-         if(!m_bAlive)
-         {
-            m_bOn = false;
-            ok = false;
-            errCode = 4;
-         }
+      if(!ok) errCode = 3;
+   }
+   if(ok)
+   { 
+      CElapsedTime eTime;
+      volatile long count = 0;
+      while(eTime.get() < 1.0 && m_nAlive < CVidBuffer::MAXSTREAMS) ++count;
+      if(m_nAlive < CVidBuffer::MAXSTREAMS)
+      {
+         ok = false;
+         errCode = 4;
       }
    }
+   if(!ok)
+   {
+      // tell any workers that did start to die
+      m_bOn = false;
+      CElapsedTime eTime;
+      volatile long count = 0;
+      while(m_nAlive > 0 && eTime.get() < 1.0) ++count;
+   }
 
-   if(!ok) ::fprintf(stderr, "[CVidBuffer] Failed to start background thread for video streaming, err=%d\n", errCode);
+   if(!ok) ::fprintf(stderr, "[CVidBuffer] Failed to start background threads for video streaming, err=%d\n", errCode);
    return(ok);
 
 
@@ -481,61 +637,84 @@ void CVidBuffer::reset()
 }
 
 /**
- Terminate the background buffering thread, close any open video files, and ensure any resources allocated by the video
- streamer object are released. Will wait up to 1 second for the worker thread to die.
+ Terminate the background buffering threads, close any open video files, and ensure any resources allocated by the 
+ video streamer object are released. Will wait up to 1 second for the worker threads to die.
 */
 void CVidBuffer::terminate()
 {
    reset();
 
-   // tell worker to die and wait up to 1 second for that to happen
+   // tell workers to die and wait up to 1 second for that to happen
    m_bOn = false;
    CElapsedTime eTime;
    volatile long count = 0;
-   while(m_bAlive && eTime.get() < 1.0) ++count;
+   while(m_nAlive > 0 && eTime.get() < 1.0) ++count;
 
-   if(m_bAlive) ::fprintf(stderr, "[CVidBuffer.reset()] WARNING: Worker thread failed to terminate!\n");
+   if(m_nAlive > 0) ::fprintf(stderr, "[CVidBuffer.reset()] WARNING: Worker thread failed to terminate!\n");
 }
 
 /**
- Open the video file specified and prepare to stream video content. The first 10 frames of the video are buffered and
- will be immediately available when this method returns. 
+ Open the video file specified and prepare to stream video content. The first 10 frames of the video, beginning at the
+ specified start frame, are buffered and will be immediately available when this method returns. 
+
+ Since a compressed video can only be decoded from a keyframe, positioning the stream at a start frame other than the
+ first is a two-step process: seek to the nearest keyframe at or before the start frame, then decode and discard the
+ intervening frames. This "pre-roll" happens here, during target loading, and not during the animation sequence.
+
+ For a looping stream, the first frames buffered here are also copied to a small "head cache". When the stream wraps
+ around at EOF, the worker thread immediately queues the cached head frames, while the decoder seeks and pre-rolls to 
+ the frame following them. Thus the wrap does not introduce a decoding stall in the playback timeline.
+
+ If the source decodes to planar YUV 4:2:0 (AV_PIX_FMT_YUV420P or _YUVJ420P), frames are buffered in that format and
+ must be converted to RGB by the consumer (the renderer does so on the GPU). Otherwise, they are converted to RGB24.
+
+ This method may be called from several threads at once, as long as no thread is buffering and none calls any other
+ CVidBuffer method in the meantime. Each call claims its own stream slot atomically. If the call fails with -4, that
+ slot remains claimed, but closed; it is reclaimed by closeAllVideoStreams().
 
  @param Full file system path to the video source file.
  @param preload If true, the entire video file will be read into memory. The idea here is to optimize performance by 
  (hopefully) avoiding any disk IO during streaming. Limitation: If the file size exceeds 30MB, this flag is ignored,
  and the file will NOT be preloaded into RAM.
  @param stopOnEOF. If true, the video stream is stopped once EOF is reached on the video source file. Otherwise, upon
- reaching EOF, the streamer will seek to the beginning of the file and resume streaming from there -- so that the video
+ reaching EOF, the streamer will seek back to the start frame and resume streaming from there -- so that the video
  "loops" indefinitely.
+ @param startFrame Zero-based index of the first frame to stream. Frame N is the frame presented N frame periods after
+ the first frame in the video source file. If the source lacks a valid frame rate, the intervening frames are counted
+ as they are decoded. Default = 0.
  @return A non-negative ID assigned to the buffered video stream -- used to access video stream information (width, 
  height, playback rate) and to retrieve buffered frames in sequence until stream is closed. If operation fails, a 
  negative error code is returned: -1 = video stream object is not initialized; -2 = buffering is in progress; 
  -3 = too many open video streams; -4 = failed to open stream for any other reason (file not found, memory allocation
- failure, video format or codec not supported). On failure, a brief error message is printed to stderr.
+ failure, video format or codec not supported, start frame beyond end of video). On failure, a brief error message is
+ printed to stderr.
 */
-int CVidBuffer::openVideoStream(const char* path, bool preload, bool stopOnEOF)
+int CVidBuffer::openVideoStream(const char* path, bool preload, bool stopOnEOF, int startFrame)
 {
-   if(!(m_bOn && m_bAlive)) 
+   if(!(m_bOn && isRunning())) 
    {
       ::fprintf(stderr, "ERROR(CVidBuffer): Video streamer is not initialized.\n");
       return(-1);
    }
-   if(m_bBuffering)
+   if(m_nBuffering > 0)
    {
       ::fprintf(stderr, "ERROR(CVidBuffer): Cannot open a new video stream while buffering is in progress.\n");
       return(-2);
    }
-   if(m_nStreams == CVidBuffer::MAXSTREAMS) 
+
+   // claim the next stream slot. Several threads may open streams at once, so the slot count is updated atomically.
+   int id = m_nStreams;
+   while(id < CVidBuffer::MAXSTREAMS && !__sync_bool_compare_and_swap(&m_nStreams, id, id+1)) id = m_nStreams;
+   if(id >= CVidBuffer::MAXSTREAMS) 
    {
       ::fprintf(stderr, "ERROR(CVidBuffer): Reached capacity. Cannot open any more video streams.\n");
       return(-3);
    }
 
-   VideoStream* pStream = &(m_streams[m_nStreams]);
+   VideoStream* pStream = &(m_streams[id]);
 
    // make sure we've registered all available formats and codecs (after first invocation, method has no effect)
-   av_register_all();
+   CVidBuffer::initLibrary();
 
    // if requested, attempt to preload source file into RAM, which requires specifying a custom IO context in order to
    // read packets from the in-memory file. If preload fails, revert to normal streaming from disk.
@@ -656,23 +835,31 @@ int CVidBuffer::openVideoStream(const char* path, bool preload, bool stopOnEOF)
       return(-4);
    }
 
-   // prepare software scaler context to handle src->dst pixel format conversion and scaling as needed
+   // YUV 4:2:0 sources are buffered as is and converted to RGB on the GPU. For all other sources, prepare software
+   // scaler context to handle src->dst pixel format conversion and scaling as needed
    int w = pStream->pCodecCtx->width;
    int h = pStream->pCodecCtx->height;
-   pStream->pSwsCtx = sws_getContext(w, h, pStream->pCodecCtx->pix_fmt, w, h, AV_PIX_FMT_RGB24, SWS_BICUBIC, 
-         NULL, NULL, NULL);
-   if(pStream->pSwsCtx == NULL) 
+   AVPixelFormat srcFmt = pStream->pCodecCtx->pix_fmt;
+   pStream->isYUV = (srcFmt == AV_PIX_FMT_YUV420P || srcFmt == AV_PIX_FMT_YUVJ420P);
+   pStream->isFullRange = 
+         pStream->isYUV && (srcFmt == AV_PIX_FMT_YUVJ420P || pStream->pCodecCtx->color_range == AVCOL_RANGE_JPEG);
+   if(!pStream->isYUV)
    {
-      ::fprintf(stderr, "ERROR(CVidBuffer): Cannot initialize the software scaler context for %s!\n", path);
-      closeVideoStream(pStream);
-      return(-4);
+      pStream->pSwsCtx = sws_getContext(w, h, srcFmt, w, h, AV_PIX_FMT_RGB24, SWS_BICUBIC, NULL, NULL, NULL);
+      if(pStream->pSwsCtx == NULL) 
+      {
+         ::fprintf(stderr, "ERROR(CVidBuffer): Cannot initialize the software scaler context for %s!\n", path);
+         closeVideoStream(pStream);
+         return(-4);
+      }
    }
 
    // allocate the "destination" video frame that we reuse to read in each frame from file and convert it to the 
    // desired RGB24 format. Also allocate the QSIZE pixel data buffers that hold the buffered frames.. 
    pStream->pDstFrame = av_frame_alloc();
    ok = (pStream->pDstFrame != NULL);
-   pStream->nBytes = av_image_get_buffer_size(AV_PIX_FMT_RGB24, w, h, 1);
+   pStream->nBytes = pStream->isYUV ? (w*h + 2*((w+1)/2)*((h+1)/2)) :
+         av_image_get_buffer_size(AV_PIX_FMT_RGB24, w, h, 1);
 
    for(int i=0; ok && i<CVidBuffer::QSIZE; i++)
    {
@@ -690,7 +877,13 @@ int CVidBuffer::openVideoStream(const char* path, bool preload, bool stopOnEOF)
    pStream->iRead = pStream->iWrite = 0;
    pStream->disabledOnError = false;
    pStream->gotEOF = false;
+   pStream->draining = false;
    pStream->stopOnEOF = stopOnEOF;
+   pStream->startFrame = (startFrame > 0) ? startFrame : 0;
+   pStream->skipToTS = AV_NOPTS_VALUE;
+   pStream->nSkipFrames = 0;
+   pStream->nHead = 0;
+   pStream->iHead = -1;
 
    // fill in video info; playback rate is 0 if we cannot find it in the file
    pStream->width = w;
@@ -706,7 +899,15 @@ int CVidBuffer::openVideoStream(const char* path, bool preload, bool stopOnEOF)
    else
       pStream->rate = 0;
 
-   // buffer the first QSIZE frames 
+   // position stream at the start frame, if it is not the first frame
+   if(pStream->startFrame > 0 && !seekToFrame(pStream, pStream->startFrame))
+   {
+      ::fprintf(stderr, "ERROR(CVidBuffer): Failed to seek to frame %d in %s!\n", pStream->startFrame, path);
+      closeVideoStream(pStream);
+      return(-4);
+   }
+
+   // buffer the first QSIZE frames (pre-rolling to the start frame as needed)
    while(ok && ((pStream->iWrite + 1) % CVidBuffer::QSIZE) != pStream->iRead)
    {
       readNextVideoFrame(pStream);
@@ -715,6 +916,11 @@ int CVidBuffer::openVideoStream(const char* path, bool preload, bool stopOnEOF)
       // if video does not loop and we've already reached EOF, then stop!
       if(ok && pStream->stopOnEOF && pStream->gotEOF) break;
    }
+   if(ok && pStream->iWrite == pStream->iRead)
+   {
+      ::fprintf(stderr, "ERROR(CVidBuffer): Start frame %d lies beyond the end of %s!\n", pStream->startFrame, path);
+      ok = false;
+   }
    if(!ok)
    {
       ::fprintf(stderr, "ERROR(CVidBuffer): Failed to buffer first 10 frames in %s!\n", path);
@@ -722,10 +928,28 @@ int CVidBuffer::openVideoStream(const char* path, bool preload, bool stopOnEOF)
       return(-4);
    }
 
-   // success! Return the ordinal ID of the initialized video stream
-   int id = m_nStreams;
-   ++m_nStreams;
+   // for a looping stream, cache copies of the frames just buffered so they can be queued without decoding each time
+   // the stream wraps around. Not needed if the stream already wrapped (a very short clip), in which case the wrap
+   // is handled by seeking back to the start frame. If memory allocation fails, we fall back on that approach.
+   if(!(pStream->stopOnEOF || pStream->gotEOF))
+   {
+      int n = pStream->iWrite;
+      for(int i=0; i<n; i++)
+      {
+         pStream->headCache[i] = (uint8_t*) av_malloc(pStream->nBytes*sizeof(uint8_t));
+         if(pStream->headCache[i] == NULL) break;
+         ::memcpy(pStream->headCache[i], pStream->frameQueue[i], pStream->nBytes);
+         ++pStream->nHead;
+      }
+      if(pStream->nHead < n)
+      {
+         ::fprintf(stderr, "WARNING(CVidBuffer): Failed to allocate head cache for %s; loop wrap may stall!\n", path);
+         for(int i=0; i<pStream->nHead; i++) { av_free(pStream->headCache[i]); pStream->headCache[i] = NULL; }
+         pStream->nHead = 0;
+      }
+   }
 
+   // success! Return the ordinal ID of the initialized video stream
    return(id);
 }
 
@@ -781,10 +1005,84 @@ double CVidBuffer::getVideoPlaybackRate(int videoID)
    return((videoID >= 0 && videoID < m_nStreams) ? m_streams[videoID].rate : 0);
 }
 
+/**
+ Return the format of the frames buffered for the specified open video stream. If the source decodes to planar YUV
+ 4:2:0, each frame buffer holds the W x H luma plane, followed by the U and V chroma planes, each ceil(W/2) x ceil(H/2).
+ All planes are tightly packed (no row padding). Otherwise, each frame buffer holds W x H pixels in RGB24 format.
+ @param videoID ID of open video stream
+ @return True if frames are in YUV 4:2:0 format; false if they are RGB24 or the stream ID is invalid.
+*/
+bool CVidBuffer::isVideoYUV(int videoID)
+{
+   return((videoID >= 0 && videoID < m_nStreams) ? m_streams[videoID].isYUV : false);
+}
+
+/**
+ Return the sample range of the YUV 4:2:0 frames buffered for the specified open video stream.
+ @param videoID ID of open video stream
+ @return True if samples span the full 8-bit range [0..255]; false if they span the MPEG range (Y in [16..235], U and
+ V in [16..240]). Also returns false if frames are RGB24 or the stream ID is invalid.
+*/
+bool CVidBuffer::isVideoFullRange(int videoID)
+{
+   return((videoID >= 0 && videoID < m_nStreams) ? m_streams[videoID].isFullRange : false);
+}
+
+/**
+ Return the size of the storage needed to hold the entire frame queue for the specified open video stream: QSIZE 
+ contiguous frame buffers, each getVideoFrameSize() bytes long. See attachFrameStore().
+ @param videoID ID of open video stream
+ @return Frame queue storage size in bytes; 0 if stream ID is invalid.
+*/
+int CVidBuffer::getFrameStoreSize(int videoID)
+{
+   return((videoID >= 0 && videoID < m_nStreams) ? CVidBuffer::QSIZE * m_streams[videoID].nBytes : 0);
+}
+
+/**
+ Replace the frame queue buffers of the specified open video stream with external storage. Frames already buffered 
+ are copied into the corresponding slots of the external store, and the internally allocated buffers are released. 
+ From then on, the worker thread decodes each frame directly into the external store, and getCurrentFrameData() 
+ returns pointers into it. The slot at offset N*getVideoFrameSize() in the store corresponds to the N-th queue entry.
+
+ The intended use is to let the worker thread decode directly into a persistently mapped pixel buffer object, from
+ which the renderer uploads each frame to a texture without any intervening copy. The caller retains ownership of the
+ store, which must remain valid until the stream is closed. Since the worker thread will write to any slot that is not
+ in use, the caller must not release a frame by calling advanceToNextFrame() until the GPU is done reading it.
+
+ This method must not be called while buffering is in progress.
+
+ @param videoID ID of open video stream.
+ @param pStore The external store. Must be at least getFrameStoreSize() bytes long.
+ @return True if successful; false if stream ID is invalid, the stream is disabled, the store is NULL, or buffering is
+ in progress.
+*/
+bool CVidBuffer::attachFrameStore(int videoID, uint8_t* pStore)
+{
+   if(videoID < 0 || videoID >= m_nStreams || pStore == NULL || m_nBuffering > 0) return(false);
+   VideoStream* pStream = &(m_streams[videoID]);
+   if(pStream->disabledOnError) return(false);
+
+   for(int i=0; i<CVidBuffer::QSIZE; i++)
+   {
+      uint8_t* pSlot = pStore + i * pStream->nBytes;
+      if(pStream->frameQueue[i] == pSlot) continue;
+
+      // copy the frames already buffered (from the read index up to, but excluding, the write index)
+      bool isFilled = (pStream->iRead <= pStream->iWrite) ? (i >= pStream->iRead && i < pStream->iWrite) :
+            (i >= pStream->iRead || i < pStream->iWrite);
+      if(isFilled) ::memcpy(pSlot, pStream->frameQueue[i], pStream->nBytes);
+      if(!pStream->isExtStore) av_free(pStream->frameQueue[i]);
+      pStream->frameQueue[i] = pSlot;
+   }
+   pStream->isExtStore = true;
+   return(true);
+}
+
 /**
  Get a reference to the buffer containing the pixel data for the current video frame, ie, the oldest buffered frame in
  the specified open video stream. The pixel data is stored in the RGB24 format, in the form required for uploading to 
- a OGL texture.
+ a OGL texture -- or in YUV 4:2:0 format, as described in isVideoYUV().
 
  This method is safe to call while the video buffering is in progress. Do NOT change buffer contents nor delete the 
  buffer. After copying or otherwise using the buffer, be sure to call advanceToNextFrame() to update the video stream 
@@ -852,96 +1150,139 @@ bool CVidBuffer::gotEOF(int videoID)
 
 
 /**
- Enable buffering of all open video streams on a background worker thread.
- @return True if buffering enabled; false if background thread is not running or there are no open video streams.
+ Get decoding statistics for the specified open video stream since it was opened: the number of frames decoded and
+ stored in the frame queue, and the average time it took the worker thread to decode one frame and store it (including
+ any colorspace conversion). The time spent reading packets from the source file is included.
+
+ @param videoID ID of open video stream.
+ @param nFrames [out] Number of frames decoded. Set to 0 if stream ID is invalid.
+ @param avgUS [out] Average time to decode and store a frame, in microseconds. Set to 0 if no frames decoded.
+*/
+void CVidBuffer::getDecodeStats(int videoID, int& nFrames, double& avgUS)
+{
+   nFrames = 0;
+   avgUS = 0.0;
+   if(videoID >= 0 && videoID < m_nStreams)
+   {
+      nFrames = m_streams[videoID].nDecoded;
+      if(nFrames > 0) avgUS = m_streams[videoID].tDecodeUS / nFrames;
+   }
+}
+
+/**
+ Enable buffering of all open video streams on the background worker threads.
+ @return True if buffering enabled; false if background threads are not running or there are no open video streams.
 */
 bool CVidBuffer::startBuffering()
 {
-   if(m_bBuffering) return(true);
-   if(m_nStreams <= 0 || !m_bAlive) return(false);
+   if(m_bBufferEna) return(true);
+   if(m_nStreams <= 0 || !isRunning()) return(false);
    m_bBufferEna = true;
    return(true);
 }
 
 /**
- Disable buffering of all open video streams. Waits up to 100ms for worker thread to return to idle wait state.
+ Disable buffering of all open video streams. Waits up to 100ms for worker threads to return to idle wait state.
 */
 void CVidBuffer::stopBuffering()
 {
    m_bBufferEna = false;
+   __sync_synchronize();         // flag must be visible before we check whether any worker is still buffering
    CElapsedTime eTime;
    long count = 0;
-   while(m_bBuffering && eTime.get() < 0.1) count++;
+   while(m_nBuffering > 0 && eTime.get() < 0.1) count++;
 }
 
 
 /**
- Background thread runtime function handles buffering of all open video streams defined in the video streamer object.
+ Background thread runtime function handles buffering of one of the open video streams defined in the video streamer
+ object -- the stream in the slot with the same index as the worker thread.
  
  When buffering is disabled, the worker thread simply waits until the next time it is enabled, checking the guard flag
- roughly once a millisecond. When buffering is enabled, the thread services each open stream in sequence, reading in a
- full frame and storing the pixel data in the stream's frame queue, then moving on to the next stream.
+ roughly once a millisecond. When buffering is enabled, the thread repeatedly reads in a full frame from its stream and
+ stores the pixel data in the stream's frame queue. Whenever there is nothing to do -- the queue is full, the stream is
+ disabled or has stopped on EOF, or there is no open stream in the thread's slot --, the thread sleeps for 250us.
 
  If an error occurs while reading in or processing an individual frame, an internal error code is set on that stream
  and no further buffering will occur.
 
  See file header for a discussion of the design strategy to keep CVidBuffer pseudo thread-safe, along with the key
- assumptions in that design.
+ assumptions in that design. Since each stream is touched by only one worker thread, those assumptions still hold.
+
+ @param idx Index of the stream slot serviced by the worker thread.
 */
-void CVidBuffer::run()
+void CVidBuffer::run(int idx)
 {
-   // this flag remains set while the worker thread is alive
-   m_bAlive = true;
+   // the alive count includes this thread while it is running
+   __sync_add_and_fetch(&m_nAlive, 1);
+
+   struct timespec tWait;
+   tWait.tv_sec = (time_t) 0;
+   tWait.tv_nsec = 1000000;
+   struct timespec tIdle;
+   tIdle.tv_sec = (time_t) 0;
+   tIdle.tv_nsec = 250000;
 
    while(m_bOn)
    {
       // wait until buffering is enabled, checking guard flag every 1ms
-      struct timespec tSpec;
-      tSpec.tv_sec = (time_t) 0;
-      tSpec.tv_nsec = 1000000;
       while(m_bOn && !m_bBufferEna)
-         ::nanosleep(&tSpec, NULL);
+         ::nanosleep(&tWait, NULL);
 
-      // while buffering is enabled, continuously cycle through the streams, reading in and buffering one frame from
-      // each (if there's room in the stream's buffer queue). Guard flags are checked after each completed frame read 
-      // to ensure the worker thread responds quickly to any requests from the "master thread".
-      m_bBuffering = true;
+      // while buffering is enabled, continuously read in and buffer frames from this thread's stream (if there's room
+      // in the stream's buffer queue). Guard flags are checked after each completed frame read to ensure the worker 
+      // thread responds quickly to any requests from the "master thread". NOTE: The master only opens or closes 
+      // streams while no worker is buffering, so the stream count cannot change inside this loop.
+      __sync_add_and_fetch(&m_nBuffering, 1);
       while(m_bOn && m_bBufferEna)
       {
-         for(int i=0; m_bOn && m_bBufferEna && i<m_nStreams; i++)
-         {
-            readNextVideoFrame( &(m_streams[i]) );
-         }
+         bool gotFrame = (idx < m_nStreams) && readNextVideoFrame( &(m_streams[idx]) );
+         if(!gotFrame) ::nanosleep(&tIdle, NULL);
       }
-      m_bBuffering = false;
+      __sync_sub_and_fetch(&m_nBuffering, 1);
    }
 
-   ::fprintf(stderr, "====> [CVidBuffer] Worker thread exiting.\n");
-   m_bAlive = false;
+   ::fprintf(stderr, "====> [CVidBuffer] Worker thread %d exiting.\n", idx);
+   __sync_sub_and_fetch(&m_nAlive, 1);
+}
+
+void* CVidBuffer::runEntryPoint(void* thisPtr)
+{
+   CVidBuffer* pThis = (CVidBuffer*) thisPtr;
+   pThis->run(__sync_fetch_and_add(&(pThis->m_nextWorker), 1));
+   return(NULL);
 }
 
 
 /**
  Helper method performs the work of reading in the next video frame from the source file for the specified video
- stream, converting it to the AV_PIX_FMT_RGB24 format, and storing it in the next available slot in the stream's buffer
- queue. It takes no action if the stream has been disabled by a previous error, if stream is configured to stop on EOF
- and EOF is reached, or if the stream's buffer queue is full. Otherwise, the method does not return until one complete
- frame has been read in; execution time will vary depending on the size of a video frame, the speed of the storage 
- medium, etc.
+ stream, converting it to the AV_PIX_FMT_RGB24 format (unless the stream is buffered in YUV 4:2:0 format), and storing
+ it in the next available slot in the stream's buffer queue. It takes no action if the stream has been disabled by a 
+ previous error, if stream is configured to stop on EOF and EOF is reached, or if the stream's buffer queue is full. 
+ Otherwise, the method does not return until one complete frame has been read in; execution time will vary depending on
+ the size of a video frame, the speed of the storage medium, etc.
+
+ Frames decoded while pre-rolling to a seek target (see seekToFrame()) are discarded. When the demuxer reaches EOF, the
+ frames still held in the decoder's reorder/threading pipeline are drained before EOF is declared, so no frames are 
+ lost at the end of the video. A looping stream then wraps back to its start frame; if it has a head cache, the cached
+ frames are queued first -- the first of them by this call -- and decoding resumes with the frame that follows them.
 
  @param Pointer to the video stream from which to read the next frame.
+ @return True if a frame was read in and buffered; false otherwise.
 */
-void CVidBuffer::readNextVideoFrame(VideoStream* pStream)
+bool CVidBuffer::readNextVideoFrame(VideoStream* pStream)
 {
    // abort on error condition, buffer queue full, or stop on EOF
-   if(pStream == NULL || pStream->disabledOnError) return;
-   if(((pStream->iWrite + 1) % CVidBuffer::QSIZE) == pStream->iRead) return;
-   if(pStream->stopOnEOF && pStream->gotEOF) return;
+   if(pStream == NULL || pStream->disabledOnError) return(false);
+   if(((pStream->iWrite + 1) % CVidBuffer::QSIZE) == pStream->iRead) return(false);
+   if(pStream->stopOnEOF && pStream->gotEOF) return(false);
+   CElapsedTime tDecode;
 
-   // clear the current write buffer and install it in the destination AVFrame
-   ::memset((void*)pStream->frameQueue[pStream->iWrite], 0, pStream->nBytes);
-   av_image_fill_arrays(pStream->pDstFrame->data, pStream->pDstFrame->linesize, 
-         pStream->frameQueue[pStream->iWrite], AV_PIX_FMT_RGB24, pStream->width, pStream->height, 1);
+   // install the current write buffer in the destination AVFrame. It need not be cleared, since every byte of the 
+   // buffer is overwritten when the frame is stored.
+   if(!pStream->isYUV)
+      av_image_fill_arrays(pStream->pDstFrame->data, pStream->pDstFrame->linesize, 
+            pStream->frameQueue[pStream->iWrite], AV_PIX_FMT_RGB24, pStream->width, pStream->height, 1);
 
    // allocate a source video frame; its pixel data buffer is allocated as packets are decoded into it
    AVFrame* pSrcFrame = av_frame_alloc();
@@ -949,69 +1290,247 @@ void CVidBuffer::readNextVideoFrame(VideoStream* pStream)
    {
       pStream->disabledOnError = true;
       ::fprintf(stderr, "ERROR(CVidBuffer): Memory allocation error while streaming %s\n", pStream->path);
-      return;
+      return(false);
    }
 
-   // read and decode packets until we've loaded the next movie frame...
+   // read and decode packets until we've loaded the next movie frame -- unless we're replaying the head cache after
+   // a loop wrap, in which case the next frame is simply copied from the cache
    AVPacket packet;
    av_init_packet(&packet);
    bool gotFrame = false;
-   while(!(pStream->disabledOnError || gotFrame))
+   bool fromCache = (pStream->iHead >= 0);
+   while(!(pStream->disabledOnError || gotFrame || fromCache))
    {
-      int res = av_read_frame(pStream->pFmtCtx, &packet);
-      if(res < 0)
+      bool frameDone = false;
+      if(pStream->draining)
       {
-         // no more frames available: we're either at EOF or an error occurred.
-         int err = pStream->pFmtCtx->pb->error;
-         bool eof = (pStream->pFmtCtx->pb->eof_reached != 0);
-         if(eof || (err == 0))
+         // demuxer is at EOF: retrieve any frames still held by the decoder. Once it is empty, we've reached EOF.
+         frameDone = (0 == avcodec_receive_frame(pStream->pCodecCtx, pSrcFrame));
+         if(!frameDone)
          {
-            // we've reached normal EOF. Seek to beginning of stream and start over.
-            avcodec_flush_buffers(pStream->pCodecCtx);
-            if(av_seek_frame(pStream->pFmtCtx, pStream->streamIdx, (int64_t) 0, AVSEEK_FLAG_BACKWARD) < 0)
+            pStream->draining = false;
+
+            // if we never reached the target of the last seek, the target lies beyond the end of the video. This is
+            // benign only if we were seeking past the head cache (the clip consists solely of the cached frames).
+            bool missedTarget = (pStream->skipToTS != AV_NOPTS_VALUE) || (pStream->nSkipFrames > 0);
+            if(missedTarget && pStream->nHead == 0)
             {
-               ::fprintf(stderr, "ERROR(CVidBuffer): Failed while rewinding video source %s\n", pStream->path);
+               ::fprintf(stderr, "ERROR(CVidBuffer): Seek target lies beyond the end of video source %s\n", 
+                     pStream->path);
                pStream->disabledOnError = true;
+               continue;
             }
+
             pStream->gotEOF = true;
             if(pStream->stopOnEOF) break;
+
+            // wrap back to the start frame. If there's a head cache, queue the first cached frame now.
+            if(!rewindVideoStream(pStream))
+            {
+               ::fprintf(stderr, "ERROR(CVidBuffer): Failed while rewinding video source %s\n", pStream->path);
+               pStream->disabledOnError = true;
+            }
+            fromCache = (pStream->iHead >= 0);
+            continue;
          }
-         else
+      }
+      else
+      {
+         int res = av_read_frame(pStream->pFmtCtx, &packet);
+         if(res < 0)
          {
-            // terminate playback on an error
-            ::fprintf(stderr, "ERROR(CVidBuffer): Error while retrieving next frame from %s (code=%d)\n", 
-                  pStream->path, err);
-            pStream->disabledOnError = true;
+            // no more frames available: we're either at EOF or an error occurred.
+            int err = pStream->pFmtCtx->pb->error;
+            bool eof = (pStream->pFmtCtx->pb->eof_reached != 0);
+            if(eof || (err == 0))
+            {
+               // we've reached normal EOF. Put decoder in draining mode to flush out any frames it still holds.
+               avcodec_send_packet(pStream->pCodecCtx, NULL);
+               pStream->draining = true;
+            }
+            else
+            {
+               // terminate playback on an error
+               ::fprintf(stderr, "ERROR(CVidBuffer): Error while retrieving next frame from %s (code=%d)\n", 
+                     pStream->path, err);
+               pStream->disabledOnError = true;
+            }
+            continue;
+         }
+
+         if(packet.stream_index == pStream->streamIdx) 
+         {
+            // decode the packet just received. Usually this contains a whole frame, but perhaps not.
+            // DEPRECATED: avcodec_decode_video2(pStream->pCodecCtx, pSrcFrame, &frameFinished, &packet);
+            frameDone = (0 == avcodec_send_packet(pStream->pCodecCtx, &packet));
+            if(frameDone) frameDone = (0 == avcodec_receive_frame(pStream->pCodecCtx, pSrcFrame));
          }
-         continue;
+         av_packet_unref(&packet);
       }
 
-      if(packet.stream_index == pStream->streamIdx) 
+      // discard frames preceding the target of the last seek. A frame within half a frame period of the target
+      // timestamp is the target frame. If the frame lacks a timestamp, assume we've reached the target.
+      if(frameDone && pStream->nSkipFrames > 0)
+      {
+         --pStream->nSkipFrames;
+         frameDone = false;
+      }
+      else if(frameDone && pStream->skipToTS != AV_NOPTS_VALUE)
       {
-         // decode the packet just received. Usually this contains a whole frame, but perhaps not.
-         // DEPRECATED: avcodec_decode_video2(pStream->pCodecCtx, pSrcFrame, &frameFinished, &packet);
-         bool frameDone = (0 == avcodec_send_packet(pStream->pCodecCtx, &packet));
-         if(frameDone) frameDone = (0 == avcodec_receive_frame(pStream->pCodecCtx, pSrcFrame));
+         int64_t ts = pSrcFrame->best_effort_timestamp;
+         if(ts != AV_NOPTS_VALUE && ts < pStream->skipToTS) frameDone = false;
+         else pStream->skipToTS = AV_NOPTS_VALUE;
+      }
 
-         // if we have a complete frame, do colorspace conversion and put results in destination frame buffer
-         if(frameDone) 
+      // if we have a complete frame, do colorspace conversion and put results in destination frame buffer -- or
+      // simply copy the planes as is if we're buffering in YUV 4:2:0 format
+      if(frameDone && pStream->isYUV)
+      {
+         if(pSrcFrame->format != AV_PIX_FMT_YUV420P && pSrcFrame->format != AV_PIX_FMT_YUVJ420P)
+         {
+            ::fprintf(stderr, "ERROR(CVidBuffer): Unexpected change in pixel format while streaming %s\n", 
+                  pStream->path);
+            pStream->disabledOnError = true;
+         }
+         else
          {
-           sws_scale(pStream->pSwsCtx, pSrcFrame->data, pSrcFrame->linesize, 0, pStream->height, 
-                  pStream->pDstFrame->data, pStream->pDstFrame->linesize);
+            CVidBuffer::storeYUVFrame(pSrcFrame, pStream->frameQueue[pStream->iWrite], pStream->width, 
+                  pStream->height);
             gotFrame = true;
          }
-
-         av_packet_unref(&packet);
       }
-         
+      else if(frameDone) 
+      {
+         sws_scale(pStream->pSwsCtx, pSrcFrame->data, pSrcFrame->linesize, 0, pStream->height, 
+               pStream->pDstFrame->data, pStream->pDstFrame->linesize);
+         gotFrame = true;
+      }
    }
    av_packet_unref(&packet);
 
+   // replaying the head cache: copy the next cached frame into the queue
+   if(fromCache && !pStream->disabledOnError)
+   {
+      ::memcpy(pStream->frameQueue[pStream->iWrite], pStream->headCache[pStream->iHead], pStream->nBytes);
+      ++pStream->iHead;
+      if(pStream->iHead >= pStream->nHead) pStream->iHead = -1;
+      gotFrame = true;
+   }
+
    // if we got the frame, increment the write index
    if(gotFrame) pStream->iWrite = (pStream->iWrite + 1) % CVidBuffer::QSIZE;
 
    // release allocated source video frame
    if(pSrcFrame != NULL) av_frame_free(&pSrcFrame);
+
+   if(gotFrame)
+   {
+      ++pStream->nDecoded;
+      pStream->tDecodeUS += tDecode.get() * 1.0e6;
+   }
+   return(gotFrame);
+}
+
+/**
+ Helper method positions the specified video stream at the specified frame. Only keyframes can be decoded without 
+ reference to prior frames, so the method seeks to the keyframe at or before the target frame's presentation 
+ timestamp, as located by the demuxer's keyframe index. Subsequent calls to readNextVideoFrame() will decode and 
+ discard frames until the target frame is reached.
+
+ The target timestamp is computed from the frame index, the stream's nominal frame rate, and its start time. If the
+ stream lacks a valid frame rate or time base, the method instead seeks to the beginning of the stream and discards the
+ required number of frames.
+
+ @param pStream The video stream.
+ @param iFrame Zero-based index of the target frame.
+ @return True if successful; false if the seek failed, in which case the stream should be disabled.
+*/
+bool CVidBuffer::seekToFrame(VideoStream* pStream, int iFrame)
+{
+   AVStream* pAVStream = pStream->pFmtCtx->streams[pStream->streamIdx];
+   AVRational fr = pAVStream->r_frame_rate;
+   if(fr.num <= 0 || fr.den <= 0) fr = pAVStream->avg_frame_rate;
+   AVRational tb = pAVStream->time_base;
+   bool useTS = (fr.num > 0 && fr.den > 0 && tb.num > 0 && tb.den > 0);
+
+   // discard any decoder state and any pending EOF drain
+   avcodec_flush_buffers(pStream->pCodecCtx);
+   pStream->draining = false;
+   pStream->skipToTS = AV_NOPTS_VALUE;
+   pStream->nSkipFrames = 0;
+
+   int64_t ts = 0;
+   if(useTS)
+   {
+      AVRational framePer = { fr.den, fr.num };
+      ts = av_rescale_q((int64_t) iFrame, framePer, tb);
+      if(pAVStream->start_time != AV_NOPTS_VALUE) ts += pAVStream->start_time;
+   }
+   else if(pAVStream->start_time != AV_NOPTS_VALUE)
+      ts = pAVStream->start_time;
+
+   if(av_seek_frame(pStream->pFmtCtx, pStream->streamIdx, ts, AVSEEK_FLAG_BACKWARD) < 0) return(false);
+
+   if(useTS)
+   {
+      // tolerate timestamps that are off by up to half a frame period
+      AVRational halfPer = { fr.den, 2*fr.num };
+      if(iFrame > 0) pStream->skipToTS = ts - av_rescale_q(1, halfPer, tb);
+   }
+   else
+      pStream->nSkipFrames = iFrame;
+   return(true);
+}
+
+/**
+ Helper method wraps a looping video stream back to its start frame after EOF is reached. If the stream has a head
+ cache, the decoder is positioned at the frame following the cached frames, and the head cache replay is armed so
+ that the cached frames are queued first.
+
+ @param pStream The video stream.
+ @return True if successful; false if the seek failed, in which case the stream should be disabled.
+*/
+bool CVidBuffer::rewindVideoStream(VideoStream* pStream)
+{
+   if(pStream->nHead > 0)
+   {
+      pStream->iHead = 0;
+      return(seekToFrame(pStream, pStream->startFrame + pStream->nHead));
+   }
+   return(seekToFrame(pStream, pStream->startFrame));
+}
+
+/**
+ Helper method copies a decoded YUV 4:2:0 frame into a frame queue buffer: the W x H luma plane, followed by the U and
+ V chroma planes, each ceil(W/2) x ceil(H/2). Unlike the decoder's frame, the planes in the buffer are tightly packed,
+ without any row padding, so that they can be uploaded to the GPU directly.
+
+ @param pSrcFrame The decoded frame, in AV_PIX_FMT_YUV420P or AV_PIX_FMT_YUVJ420P format.
+ @param pDst The frame queue buffer. Must be at least W*H + 2*ceil(W/2)*ceil(H/2) bytes long.
+ @param w, h Frame width and height in pixels.
+*/
+void CVidBuffer::storeYUVFrame(AVFrame* pSrcFrame, uint8_t* pDst, int w, int h)
+{
+   int cw = (w+1)/2;
+   int ch = (h+1)/2;
+   for(int iPlane=0; iPlane<3; iPlane++)
+   {
+      int pw = (iPlane == 0) ? w : cw;
+      int ph = (iPlane == 0) ? h : ch;
+      const uint8_t* pSrc = pSrcFrame->data[iPlane];
+      int stride = pSrcFrame->linesize[iPlane];
+      if(stride == pw)
+      {
+         ::memcpy(pDst, pSrc, pw*ph);
+         pDst += pw*ph;
+      }
+      else for(int j=0; j<ph; j++)
+      {
+         ::memcpy(pDst, pSrc, pw);
+         pDst += pw;
+         pSrc += stride;
+      }
+   }
 }
 
 /**
@@ -1026,6 +1545,8 @@ void CVidBuffer::closeVideoStream(VideoStream* pStream)
       sws_freeContext(pStream->pSwsCtx);
       pStream->pSwsCtx = NULL;
    }
+   pStream->isYUV = false;
+   pStream->isFullRange = false;
    if(pStream->pCodecCtx != NULL)
    {
       avcodec_close(pStream->pCodecCtx);
@@ -1045,11 +1566,22 @@ void CVidBuffer::closeVideoStream(VideoStream* pStream)
       pStream->pFmtCtx = NULL;
    }
 
+   // an external frame store belongs to the caller of attachFrameStore()
    for(int i=0; i<CVidBuffer::QSIZE; i++) if(pStream->frameQueue[i] != NULL)
    {
-      av_free(pStream->frameQueue[i]);
+      if(!pStream->isExtStore) av_free(pStream->frameQueue[i]);
       pStream->frameQueue[i] = NULL;
    }
+   pStream->isExtStore = false;
+   pStream->nDecoded = 0;
+   pStream->tDecodeUS = 0.0;
+   for(int i=0; i<pStream->nHead; i++) if(pStream->headCache[i] != NULL)
+   {
+      av_free(pStream->headCache[i]);
+      pStream->headCache[i] = NULL;
+   }
+   pStream->nHead = 0;
+   pStream->iHead = -1;
 
    if(pStream->pDstFrame != NULL)
    {
@@ -1072,6 +1604,10 @@ void CVidBuffer::closeVideoStream(VideoStream* pStream)
    pStream->iWrite = 0;
    pStream->disabledOnError = true;
    pStream->gotEOF = false;
+   pStream->draining = false;
+   pStream->startFrame = 0;
+   pStream->skipToTS = AV_NOPTS_VALUE;
+   pStream->nSkipFrames = 0;
    pStream->width = 0;
    pStream->height = 0;
    pStream->rate = 0;
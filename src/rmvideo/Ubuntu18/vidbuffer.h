@@ -29,12 +29,14 @@ class CVidBuffer
 public:
    // open video file and get basic info about the first video stream it contains
    static bool getVideoInfo(const char* path, int& w, int& h, int& r, int& d, bool quiet);
+   // stream frames from a video file with and without an attached frame store, reporting copy costs per frame
+   static bool benchmark(const char* path, int nFrames);
 
    CVidBuffer();
    ~CVidBuffer();
 
-   // on first call, start the worker thread that performs buffering. No videos are loaded and worker thread is in wait
-   // wait state. Subsequent calls are equivalent to calling reset().
+   // on first call, start the worker threads that perform buffering (one per stream slot). No videos are loaded and
+   // the worker threads are in the wait state. Subsequent calls are equivalent to calling reset().
    bool initialize();
 
    // stop any buffering in progress, ensure any open video files are closed, and release all resources allocated
@@ -42,18 +44,23 @@ public:
    void reset();
 
 private:
-   // stop buffering, ensure any open video files are closed, and terminate the buffering thread. Note that this method
+   // one-time, thread-safe registration of FFMPEG formats and codecs
+   static void initLibrary();
+   static void initLibraryOnce();
+
+   // stop buffering, ensure any open video files are closed, and terminate the buffering threads. Note that this method
    // will be invoked in the destructor.
    void terminate();
 
 public:
-   // is video buffering worker thread still alive?
-   bool isRunning() { return(m_bAlive); }
+   // are all video buffering worker threads still alive?
+   bool isRunning() { return(m_nAlive == MAXSTREAMS); }
 
-   // open video file specified and prepare to stream video content. Buffering thread must be in wait state.
-   int openVideoStream(const char* path, bool preload, bool stopOnEOF);
+   // open video file specified and prepare to stream video content, starting at the specified frame (0 = first frame
+   // in file). Buffering threads must be in wait state. May be called from several threads at once.
+   int openVideoStream(const char* path, bool preload, bool stopOnEOF, int startFrame = 0);
 
-   // close all open video streams. Worker thread will be idled if it is not already.
+   // close all open video streams. Worker threads will be idled if they are not already.
    void closeAllVideoStreams();
 
    // some video information determined when source file is first opened. Safe to access until video closed.
@@ -62,7 +69,20 @@ public:
    int getVideoFrameSize(int videoID);
    double getVideoPlaybackRate(int videoID);
 
-   // direct access to the RGB pixel data buffer containing the current video frame. Safe to call while buffering.
+   // frame format: if true, frames are stored as planar YUV 4:2:0 (to be converted on the GPU); else packed RGB24
+   bool isVideoYUV(int videoID);
+   // for YUV frames only: true if the luma and chroma samples span the full 8-bit range rather than the MPEG range
+   bool isVideoFullRange(int videoID);
+
+   // size of external storage for a stream's entire frame queue, and attach such storage (buffering must be off).
+   // The worker thread then decodes frames directly into that storage (eg, a persistently mapped pixel buffer).
+   int getFrameStoreSize(int videoID);
+   bool attachFrameStore(int videoID, uint8_t* pStore);
+
+   // # of frames decoded on stream since opened, and average time to decode and store each one (microseconds)
+   void getDecodeStats(int videoID, int& nFrames, double& avgUS);
+
+   // direct access to the pixel data buffer containing the current video frame. Safe to call while buffering.
    uint8_t* getCurrentFrameData(int videoID);
 
    // advance to next video frame. Safe to call while buffering.
@@ -74,16 +94,17 @@ public:
    // returns true once EOF has been reached on specified stream
    bool gotEOF(int videoID);
 
-   // enable buffering of all open video streams via the worker thread.
+   // enable buffering of all open video streams via the worker threads.
    bool startBuffering();
-   // disable buffering of all open video streams; worker thread reenters wait state.
+   // disable buffering of all open video streams; worker threads reenter wait state.
    void stopBuffering();
 
 private:
-   volatile bool m_bOn;         // master thread sets this before starting worker; resets it to tell worker to die
-   volatile bool m_bAlive;      // master monitors this flag to verify that worker thread is running
-   volatile bool m_bBufferEna;  // master sets/clears this flag to tell worker thread to start/stop buffering
-   volatile bool m_bBuffering;  // worker thread sets this flag while buffering, clears it while in wait state
+   volatile bool m_bOn;         // master thread sets this before starting workers; resets it to tell workers to die
+   volatile int m_nAlive;       // # of worker threads running (updated atomically)
+   volatile bool m_bBufferEna;  // master sets/clears this flag to tell worker threads to start/stop buffering
+   volatile int m_nBuffering;   // # of worker threads currently buffering, ie, not in wait state (updated atomically)
+   volatile int m_nextWorker;   // stream slot index assigned to next worker thread that starts (updated atomically)
 
    static const int MAXPATHSZ = 256;
    static const int MAXSTREAMS = 5;
@@ -112,33 +133,58 @@ private:
       AVFormatContext* pFmtCtx;        // video source file format I/O context
       int streamIdx;                   // index of source video stream
       AVCodecContext* pCodecCtx;       // codec context, etc for source video stream
-      struct SwsContext* pSwsCtx;      // software scaler context
+      struct SwsContext* pSwsCtx;      // software scaler context (NULL for YUV 4:2:0 sources)
       AVFrame* pDstFrame;              // structure used to read content from source into data buffer
+      bool isYUV;                      // if set, frames are stored as planar YUV 4:2:0 (Y, then U, then V); else RGB24
+      bool isFullRange;                // YUV only: if set, samples span full 8-bit range (else MPEG range)
 
-      uint8_t* frameQueue[QSIZE];      // circular queue of buffered video frames (pixel data in RGBA format)
+      uint8_t* frameQueue[QSIZE];      // circular queue of buffered video frames (pixel data in RGB24 or YUV format)
+      bool isExtStore;                 // if set, queue buffers lie in an external frame store (not freed on close)
       volatile int iRead;              // index of current frame being read from buffered stream (read-only to worker)
       volatile int iWrite;             // index of frame being written by worker (read-only to master)
       int nBytes;                      // size of each data buffer in the queue
 
       bool disabledOnError;            // if true, buffering on this stream has been disabled by a previoius error
       bool gotEOF;                     // flag set when EOF is reached on video stream
+      bool draining;                   // set once the demuxer hits EOF, while remaining frames are drained from decoder
+
+      int startFrame;                  // index of first frame streamed; looping streams wrap back to this frame
+      int64_t skipToTS;                // while set (not AV_NOPTS_VALUE), frames stamped earlier than this are discarded
+      int nSkipFrames;                 // # of frames to discard after a seek, if source lacks usable timestamps
+      uint8_t* headCache[QSIZE];       // looping streams: copies of the first frames streamed from the start frame
+      int nHead;                       // # of frames in the head cache (0 if there is no head cache)
+      int iHead;                       // index of next head cache frame to queue after a wrap; -1 if not replaying
 
       int width;                       // width of video frames, in pixels
       int height;                      // height of video frames, in pixels
       double rate;                     // video playback rate in Hz; 0 if playback rate not available in source file
+
+      int nDecoded;                    // # of frames decoded and stored since stream opened
+      double tDecodeUS;                // total time spent decoding and storing those frames, in microseconds
    };
 
-   // the currently buffered video streams
-   int m_nStreams;
+   // the currently buffered video streams (slot count is updated atomically, since streams may be opened in parallel)
+   volatile int m_nStreams;
    VideoStream m_streams[MAXSTREAMS];
 
 
-   // the worker thread function and its static entry point, which we need for pthread_create()
-   void run();
-   static void* runEntryPoint(void* thisPtr) { ((CVidBuffer*)thisPtr)->run(); }
+   // the worker thread function and its static entry point, which we need for pthread_create(). Each worker thread
+   // services the stream slot with the same index.
+   void run(int idx);
+   static void* runEntryPoint(void* thisPtr);
 
    // helper method performs the work of reading in the next video frame for the specified video stream
-   void readNextVideoFrame(VideoStream* pStream);
+   bool readNextVideoFrame(VideoStream* pStream);
+
+   // helper method seeks to the keyframe at or before the specified frame, then arranges to discard decoded frames up
+   // to that frame. Returns false if seek failed.
+   bool seekToFrame(VideoStream* pStream, int iFrame);
+
+   // helper method wraps a looping stream back to its start frame upon reaching EOF
+   bool rewindVideoStream(VideoStream* pStream);
+
+   // helper method stores a decoded YUV 4:2:0 frame in the specified frame queue buffer, with the planes packed
+   static void storeYUVFrame(AVFrame* pSrcFrame, uint8_t* pDst, int w, int h);
 
    // helper method closes an open video stream. Should not be called while buffering in progress.
    void closeVideoStream(VideoStream* pStream);
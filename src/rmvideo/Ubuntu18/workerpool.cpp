@@ -0,0 +1,230 @@
+/*=====================================================================================================================
+ workerpool.cpp : Helper class CWorkerPool, a small persistent pool of worker threads that execute batches of jobs.
+
+ AUTHOR:  saruffner.
+
+ BACKGROUND:
+ During an animation sequence, CRMVRenderer::animate() must update the state of every target in the animated target
+ list once per refresh period, then render and swap. When several large RMV_RANDOMDOTS or RMV_FLOWFIELD patches are
+ animated at a high refresh rate (eg, 144Hz), the serial target update stage alone can consume a significant fraction
+ of the ~7ms frame period on RMVideo's main thread, even though the per-target updates are completely independent of
+ one another and the workstation has several otherwise idle cores. CWorkerPool lets the renderer spread that work
+ across those cores.
+
+ DESCRIPTION:
+ CWorkerPool launches a fixed number of worker threads when started and keeps them alive until stopped, so there is
+ no thread creation cost during an animation sequence. Work is posted as a "batch" of N jobs, identified by the
+ indices 0..N-1 and executed by a single job function. Each worker claims the next unclaimed job with an atomic
+ compare-and-swap on a ticket counter, so each job is executed exactly once, by whichever thread claims it. dispatch()
+ posts a batch and returns immediately, so the caller can do other work -- such as updating targets that must be
+ updated on the GL thread -- while the workers are busy. waitForCompletion() is the barrier: the calling thread helps
+ execute any jobs that have not yet been claimed, then blocks until every job in the batch is done.
+
+ Idle workers block on a condition variable, so they consume no CPU time between batches. The latency to wake them
+ is on the order of tens of microseconds -- negligible compared to the work they're given, but enough that a caller
+ should not bother dispatching trivial batches.
+
+ Like CVidBuffer, the worker threads are created with the same attributes as the thread that starts the pool: normal
+ SCHED_OTHER priority, allowed to run on any processor in the caller's affinity mask.
+
+ USAGE:
+ Call start() once during startup, and stop() at shutdown (the destructor also calls stop()). Only one thread -- the
+ "master" -- may call dispatch() and waitForCompletion(), and every dispatch() must be followed by a call to
+ waitForCompletion() before the next dispatch(). The job function must be safe to call concurrently for different
+ job indices.
+
+ REVISION HISTORY:
+ 16oct2026-- Initial version, introduced to parallelize the target update stage in CRMVRenderer::animate().
+//===================================================================================================================*/
+
+#include <stdio.h>
+#include <unistd.h>
+#include "sched.h"
+#include "pthread.h"
+
+#include "workerpool.h"
+
+
+CWorkerPool::CWorkerPool()
+{
+   m_nWorkers = 0;
+   m_bQuit = false;
+   m_batchID = 0;
+   m_pFunc = NULL;
+   m_pArg = NULL;
+   m_nJobs = 0;
+   m_nextTicket = 0;
+   m_firstTicket = 0;
+   m_endTicket = 0;
+   m_nDone = 0;
+
+   ::pthread_mutex_init(&m_mutex, NULL);
+   ::pthread_cond_init(&m_condWork, NULL);
+   ::pthread_cond_init(&m_condDone, NULL);
+}
+
+CWorkerPool::~CWorkerPool()
+{
+   stop();
+   ::pthread_cond_destroy(&m_condDone);
+   ::pthread_cond_destroy(&m_condWork);
+   ::pthread_mutex_destroy(&m_mutex);
+}
+
+/**
+ Launch the worker threads in the pool. If the pool is already running, no action is taken.
+
+ When the requested pool size is not positive, the pool is sized IAW the number of processors on which the calling
+ thread is eligible to run, less two: one for the calling thread itself (which helps out in waitForCompletion()), and
+ one for CVidBuffer's streaming thread. The pool will always have at least one worker and no more than MAXWORKERS.
+
+ @param nWorkers The desired number of worker threads. If non-positive, pool size is determined automatically.
+ @return True if successful, false otherwise. In the latter case, a brief error message is printed to stderr and any
+ workers that were launched are terminated.
+*/
+bool CWorkerPool::start(int nWorkers)
+{
+   if(m_nWorkers > 0) return(true);
+
+   if(nWorkers <= 0)
+   {
+      cpu_set_t cpu;
+      CPU_ZERO(&cpu);
+      int count = 0;
+      if(0 == ::pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu))
+      {
+         for(int i=0; i<CPU_SETSIZE; i++) if(CPU_ISSET(i, &cpu)) ++count;
+      }
+      if(count < 1) count = (int) ::sysconf(_SC_NPROCESSORS_ONLN);
+      nWorkers = count - 2;
+   }
+   if(nWorkers < 1) nWorkers = 1;
+   else if(nWorkers > MAXWORKERS) nWorkers = MAXWORKERS;
+
+   m_bQuit = false;
+   m_nJobs = 0;
+   m_nDone = 0;
+   for(int i=0; i<nWorkers; i++)
+   {
+      if(0 != ::pthread_create(&(m_threads[i]), NULL, CWorkerPool::runEntryPoint, this))
+      {
+         ::fprintf(stderr, "ERROR(CWorkerPool): Failed to launch worker thread %d of %d\n", i+1, nWorkers);
+         stop();
+         return(false);
+      }
+      ++m_nWorkers;
+   }
+   return(true);
+}
+
+/**
+ Terminate all worker threads in the pool, blocking until each has exited. Must not be called while a batch of jobs
+ is in progress.
+*/
+void CWorkerPool::stop()
+{
+   if(m_nWorkers == 0) return;
+
+   ::pthread_mutex_lock(&m_mutex);
+   m_bQuit = true;
+   ::pthread_cond_broadcast(&m_condWork);
+   ::pthread_mutex_unlock(&m_mutex);
+
+   for(int i=0; i<m_nWorkers; i++) ::pthread_join(m_threads[i], NULL);
+   m_nWorkers = 0;
+   m_bQuit = false;
+}
+
+/**
+ Post a batch of jobs to the worker pool and return immediately. The caller must invoke waitForCompletion() before it
+ dispatches another batch or accesses any state modified by the jobs. If the pool is not running, the jobs are simply
+ queued and will be executed by the calling thread in waitForCompletion().
+
+ @param pFunc The job function. It is invoked once for each job index in [0..nJobs-1], possibly concurrently.
+ @param pArg The argument passed to each invocation of the job function.
+ @param nJobs The number of jobs in the batch. If non-positive, no action is taken.
+*/
+void CWorkerPool::dispatch(JobFunc pFunc, void* pArg, int nJobs)
+{
+   if(pFunc == NULL || nJobs <= 0) return;
+
+   ::pthread_mutex_lock(&m_mutex);
+   m_pFunc = pFunc;
+   m_pArg = pArg;
+   m_nJobs = nJobs;
+   m_nDone = 0;
+   m_firstTicket = m_nextTicket;
+   __sync_synchronize();         // batch must be fully defined before any job in it can be claimed
+   m_endTicket = m_firstTicket + nJobs;
+   ++m_batchID;
+   ::pthread_cond_broadcast(&m_condWork);
+   ::pthread_mutex_unlock(&m_mutex);
+}
+
+/**
+ The barrier for the current batch of jobs: The calling thread executes any jobs not yet claimed by a worker, then
+ blocks until all jobs in the batch have been completed. Returns immediately if no batch is in progress.
+*/
+void CWorkerPool::waitForCompletion()
+{
+   executeJobs();
+
+   ::pthread_mutex_lock(&m_mutex);
+   while(m_nDone < m_nJobs) ::pthread_cond_wait(&m_condDone, &m_mutex);
+   m_nJobs = 0;
+   m_nDone = 0;
+   ::pthread_mutex_unlock(&m_mutex);
+}
+
+/**
+ Claim and execute jobs from the current batch until all have been claimed. If the thread completes the last job in
+ the batch, it wakes up the master thread waiting in waitForCompletion().
+*/
+void CWorkerPool::executeJobs()
+{
+   int nDoneHere = 0;
+   while(true)
+   {
+      long ticket = m_nextTicket;
+      if(ticket >= m_endTicket) break;
+      if(!__sync_bool_compare_and_swap(&m_nextTicket, ticket, ticket + 1)) continue;
+      m_pFunc(m_pArg, int(ticket - m_firstTicket));
+      ++nDoneHere;
+   }
+
+   if(nDoneHere > 0 && __sync_add_and_fetch(&m_nDone, nDoneHere) == m_nJobs)
+   {
+      ::pthread_mutex_lock(&m_mutex);
+      ::pthread_cond_broadcast(&m_condDone);
+      ::pthread_mutex_unlock(&m_mutex);
+   }
+}
+
+/**
+ Runtime loop for each worker thread: Wait for a new batch to be dispatched, help execute it, and repeat until the
+ pool is stopped.
+*/
+void CWorkerPool::run()
+{
+   unsigned int lastBatchID = 0;
+
+   ::pthread_mutex_lock(&m_mutex);
+   lastBatchID = m_batchID;
+   while(true)
+   {
+      while(!m_bQuit && m_batchID == lastBatchID) ::pthread_cond_wait(&m_condWork, &m_mutex);
+      if(m_bQuit) break;
+      lastBatchID = m_batchID;
+
+      ::pthread_mutex_unlock(&m_mutex);
+      executeJobs();
+      ::pthread_mutex_lock(&m_mutex);
+   }
+   ::pthread_mutex_unlock(&m_mutex);
+}
+
+void* CWorkerPool::runEntryPoint(void* thisPtr)
+{
+   ((CWorkerPool*)thisPtr)->run();
+   return(NULL);
+}
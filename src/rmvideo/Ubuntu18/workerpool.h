@@ -0,0 +1,74 @@
+//=====================================================================================================================
+//
+// workerpool.h : Helper class CWorkerPool, a small persistent pool of worker threads that execute batches of jobs.
+//
+//=====================================================================================================================
+
+
+#if !defined(WORKERPOOL_H_INCLUDED_)
+#define WORKERPOOL_H_INCLUDED_
+
+#include "pthread.h"
+
+
+class CWorkerPool
+{
+public:
+   // a job function: executes job #iJob of the current batch; pArg is the argument passed to dispatch()
+   typedef void (*JobFunc)(void* pArg, int iJob);
+
+   CWorkerPool();
+   ~CWorkerPool();
+
+   // launch the worker threads. If nWorkers <= 0, pool size is based on the # of cores available to calling thread.
+   bool start(int nWorkers);
+
+   // terminate all worker threads. Invoked in the destructor.
+   void stop();
+
+   // is the pool running?
+   bool isRunning() { return(m_nWorkers > 0); }
+
+   // the number of worker threads in the pool (0 if not running)
+   int getNumWorkers() { return(m_nWorkers); }
+
+   // post a batch of jobs to the worker threads and return immediately. Any previous batch must be complete.
+   void dispatch(JobFunc pFunc, void* pArg, int nJobs);
+
+   // help execute any jobs not yet claimed in the current batch, then block until all jobs in the batch are done
+   void waitForCompletion();
+
+private:
+   static const int MAXWORKERS = 16;   // maximum number of worker threads in pool
+
+   pthread_t m_threads[MAXWORKERS];    // the worker threads
+   int m_nWorkers;                     // number of worker threads currently running
+
+   pthread_mutex_t m_mutex;            // guards the batch ID and quit flag, and the two condition variables below
+   pthread_cond_t m_condWork;          // signaled when a new batch is dispatched or the pool is stopping
+   pthread_cond_t m_condDone;          // signaled when the last job in the current batch is completed
+   bool m_bQuit;                       // set to terminate all worker threads
+   unsigned int m_batchID;             // incremented each time a batch is dispatched
+
+   JobFunc m_pFunc;                    // the current batch: job function and its argument, and # of jobs
+   void* m_pArg;
+   volatile int m_nJobs;
+
+   // jobs are claimed from a monotonically increasing ticket counter; the current batch owns tickets in the range
+   // [m_firstTicket .. m_endTicket). Since the counter is never reset, a worker that is late in waking for a batch
+   // that has already finished can never claim a job twice.
+   volatile long m_nextTicket;         // next unclaimed ticket (updated atomically)
+   volatile long m_firstTicket;
+   volatile long m_endTicket;
+   volatile int m_nDone;               // number of jobs in batch completed thus far (updated atomically)
+
+   // claim and execute unclaimed jobs in the current batch until there are none left
+   void executeJobs();
+
+   // runtime loop for each worker thread
+   void run();
+   static void* runEntryPoint(void* thisPtr);
+};
+
+
+#endif // !defined(WORKERPOOL_H_INCLUDED_)
@@ -0,0 +1,337 @@
+//=====================================================================================================================
+//
+// cxcatalog.c : Command-line front end for the Maestro/Cntrlx data file catalog in cxdatacat.c (Linux).
+//
+// AUTHOR:  saruffner
+//
+// DESCRIPTION:
+// Builds, updates and queries a catalog of the data files in one or more session directories, so that questions like
+// "which trials were 'pursuitA', earned a reward, and have a tagged section 'probe'?" are answered in milliseconds
+// without opening a single data file.
+//
+//    cxcatalog update [-j nthreads] catalog dir [dir ...]
+// Creates the catalog file, or brings it up to date: only files that are new or modified since the last update are
+// scanned, on all available cores. A one-line summary of what was done is written to STDERR.
+//
+//    cxcatalog query [-t trial] [-s set] [-u subset] [-x section] [-g target] [-f flags] [-v minver]
+//                    [-d from[:to]] [-c] [-l] catalog
+// Lists the cataloged data files satisfying every criterion given, as CSV on STDOUT:
+//
+//    file,trial,set,subset,version,date,flags,sections[,targets]
+//
+// where 'flags' is the CXHF_* header flag word in hex, 'sections' lists the tagged sections separated by ';', and
+// 'targets' (with -l) lists the targets as name:category:type, separated by ';'. With -c, only the number of matching
+// files is written. The query time and match count are written to STDERR.
+//    -t, -s, -u : trial, trial set, trial subset name. A name ending in '*' matches any name with that prefix.
+//    -x         : name of a tagged section the trial must have ('*' suffix allowed).
+//    -g         : name of a target the trial must use ('*' suffix allowed).
+//    -f         : comma-separated header flags that must be set; prefix a flag with '-' if it must be clear. Names:
+//                 cont, spikewave, earned, given, fix1, fix2, endselect, tagsects, rpdistro, rpdresp, search, st_ok,
+//                 st_distracted, eyelink, dupframe, st_2goal. Eg: -f earned,-dupframe
+//    -v         : minimum data file version.
+//    -d         : recording date range as YYYYMMDD[:YYYYMMDD].
+//
+// BUILD:  gcc -O2 -o cxcatalog cxcatalog.c cxdatacat.c cxdatalib.c -lpthread
+//
+// REVISION HISTORY:
+// 16oct2026-- Created.
+//=====================================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cxdatacat.h"
+
+
+//=====================================================================================================================
+// MODULE GLOBALS, CONSTANTS
+//=====================================================================================================================
+
+typedef struct tagFlagName          // a header flag bit, by name, for the -f option
+{
+   const char* name;
+   DWORD dwFlag;
+} FLAGNAME;
+
+const FLAGNAME G_flagNames[] =
+{
+   { "cont",            CXHF_ISCONTINUOUS },
+   { "spikewave",       CXHF_SAVEDSPIKES },
+   { "earned",          CXHF_REWARDEARNED },
+   { "given",           CXHF_REWARDGIVEN },
+   { "fix1",            CXHF_FIX1SELECTED },
+   { "fix2",            CXHF_FIX2SELECTED },
+   { "endselect",       CXHF_ENDSELECT },
+   { "tagsects",        CXHF_HASTAGSECTS },
+   { "rpdistro",        CXHF_ISRPDISTRO },
+   { "rpdresp",         CXHF_GOTRPDRESP },
+   { "search",          CXHF_ISSEARCHTSK },
+   { "st_ok",           CXHF_ST_OK },
+   { "st_distracted",   CXHF_ST_DISTRACTED },
+   { "eyelink",         CXHF_EYELINKUSED },
+   { "dupframe",        CXHF_DUPFRAME },
+   { "st_2goal",        CXHF_ST_2GOAL }
+};
+
+#define NUMFLAGNAMES       ((int) (sizeof(G_flagNames) / sizeof(FLAGNAME)))
+
+
+//=====================================================================================================================
+// FUNCTIONS DEFINED IN THIS MODULE
+//=====================================================================================================================
+void usage();
+int doUpdate( int argc, char* argv[] );
+int doQuery( int argc, char* argv[] );
+BOOL parseFlags( const char* str, DWORD* pdwOn, DWORD* pdwOff );
+void printEntry( PCXCATALOG pCat, int iEntry, BOOL bLong );
+double getElapsedSecs( const struct timespec* pStart );
+
+
+//=== main ============================================================================================================
+int main( int argc, char* argv[] )
+{
+   if( argc >= 2 && strcmp( argv[1], "update" ) == 0 ) return( doUpdate( argc - 1, argv + 1 ) );
+   if( argc >= 2 && strcmp( argv[1], "query" ) == 0 ) return( doQuery( argc - 1, argv + 1 ) );
+   usage();
+   return( 1 );
+}
+
+
+//=== usage ===========================================================================================================
+//
+//    Prints cxcatalog usage details to STDERR.
+//
+void usage()
+{
+   fprintf( stderr, "USAGE: cxcatalog update [-j nthreads] catalog dir [dir ...]\n" );
+   fprintf( stderr, "       cxcatalog query [-t trial] [-s set] [-u subset] [-x section] [-g target] [-f flags]\n" );
+   fprintf( stderr, "                       [-v minver] [-d from[:to]] [-c] [-l] catalog\n" );
+   fprintf( stderr, "   -j --> # of worker threads scanning new/modified files (default = # of CPUs)\n" );
+   fprintf( stderr, "   -t, -s, -u --> trial, set, subset name; a trailing '*' matches a prefix\n" );
+   fprintf( stderr, "   -x --> trial has tagged section by this name; -g --> trial uses target by this name\n" );
+   fprintf( stderr, "   -f --> comma-separated header flags required set ('-flag' = required clear):\n" );
+   fprintf( stderr, "          cont spikewave earned given fix1 fix2 endselect tagsects rpdistro rpdresp search\n" );
+   fprintf( stderr, "          st_ok st_distracted eyelink dupframe st_2goal\n" );
+   fprintf( stderr, "   -v --> minimum data file version; -d --> date recorded, YYYYMMDD[:YYYYMMDD]\n" );
+   fprintf( stderr, "   -c --> print # of matching files only; -l --> include targets in listing\n" );
+}
+
+
+//=== doUpdate ========================================================================================================
+//
+//    The 'update' command: create or update a catalog file.
+//
+//    ARGS:       argc, argv -- [in] the command line, starting with the command name.
+//
+//    RETURNS:    Program exit status: 0 if successful, 1 otherwise.
+//
+int doUpdate( int argc, char* argv[] )
+{
+   int opt, nThreads;
+   CXCUPDATESTATS stats;
+   struct timespec tStart;
+   char errMsg[256];
+
+   nThreads = (int) sysconf( _SC_NPROCESSORS_ONLN );
+   if( nThreads < 1 ) nThreads = 1;
+   while( (opt = getopt( argc, argv, "j:" )) != -1 )
+   {
+      if( opt == 'j' ) nThreads = atoi( optarg );
+      else
+      {
+         usage();
+         return( 1 );
+      }
+   }
+   if( argc - optind < 2 || nThreads < 1 )
+   {
+      usage();
+      return( 1 );
+   }
+
+   clock_gettime( CLOCK_MONOTONIC, &tStart );
+   if( !cxcUpdate( argv[optind], (const char**) &(argv[optind+1]), argc - optind - 1, nThreads, &stats, errMsg,
+                   sizeof(errMsg) ) )
+   {
+      fprintf( stderr, "ERROR: %s\n", errMsg );
+      return( 1 );
+   }
+   fprintf( stderr, "%s: %d files (%d scanned, %d unchanged, %d dropped, %d not data files) in %.3f s\n",
+            argv[optind], stats.nFiles, stats.nScanned, stats.nReused, stats.nDropped, stats.nUnreadable,
+            getElapsedSecs( &tStart ) );
+   return( 0 );
+}
+
+
+//=== doQuery =========================================================================================================
+//
+//    The 'query' command: list the cataloged data files satisfying the specified criteria.
+//
+//    ARGS:       argc, argv -- [in] the command line, starting with the command name.
+//
+//    RETURNS:    Program exit status: 0 if successful, 1 otherwise.
+//
+int doQuery( int argc, char* argv[] )
+{
+   CXCATALOG cat;
+   CXCQUERY query;
+   BOOL bCount, bLong;
+   int i, opt, nMatches;
+   int* piMatches;
+   char* pColon;
+   struct timespec tStart;
+   double dSecs;
+
+   cxcInitQuery( &query );
+   bCount = bLong = FALSE;
+   while( (opt = getopt( argc, argv, "t:s:u:x:g:f:v:d:cl" )) != -1 )
+   {
+      switch( opt )
+      {
+         case 't' : query.trial = optarg; break;
+         case 's' : query.set = optarg; break;
+         case 'u' : query.subset = optarg; break;
+         case 'x' : query.section = optarg; break;
+         case 'g' : query.target = optarg; break;
+         case 'f' :
+            if( !parseFlags( optarg, &(query.dwFlagsOn), &(query.dwFlagsOff) ) ) return( 1 );
+            break;
+         case 'v' : query.minVersion = atoi( optarg ); break;
+         case 'd' :
+            query.dateFrom = atoi( optarg );
+            pColon = strchr( optarg, ':' );
+            query.dateTo = (pColon != NULL) ? atoi( pColon + 1 ) : query.dateFrom;
+            break;
+         case 'c' : bCount = TRUE; break;
+         case 'l' : bLong = TRUE; break;
+         default :  usage(); return( 1 );
+      }
+   }
+   if( argc - optind != 1 )
+   {
+      usage();
+      return( 1 );
+   }
+
+   if( !cxcOpen( &cat, argv[optind] ) )
+   {
+      fprintf( stderr, "ERROR: %s\n", cat.errMsg );
+      return( 1 );
+   }
+   piMatches = (int*) malloc( sizeof(int) * (cat.pHdr->nEntries + 1) );
+   if( piMatches == NULL )
+   {
+      fprintf( stderr, "ERROR: Out of memory\n" );
+      cxcClose( &cat );
+      return( 1 );
+   }
+
+   clock_gettime( CLOCK_MONOTONIC, &tStart );
+   nMatches = cxcQuery( &cat, &query, piMatches, cat.pHdr->nEntries );
+   dSecs = getElapsedSecs( &tStart );
+
+   if( bCount )
+      printf( "%d\n", nMatches );
+   else
+   {
+      printf( "file,trial,set,subset,version,date,flags,sections%s\n", bLong ? ",targets" : "" );
+      for( i = 0; i < nMatches; i++ ) printEntry( &cat, piMatches[i], bLong );
+   }
+   fprintf( stderr, "%d of %d files matched in %.3f ms\n", nMatches, cat.pHdr->nEntries, dSecs * 1000.0 );
+
+   free( piMatches );
+   cxcClose( &cat );
+   return( 0 );
+}
+
+
+//=== parseFlags ======================================================================================================
+//
+//    Parse the argument of the -f option: a comma-separated list of header flag names, each optionally prefixed by
+//    '-' to indicate the flag must be clear rather than set.
+//
+//    ARGS:       str      -- [in] the option argument.
+//                pdwOn    -- [in/out] flags that must be set; flags listed are OR'd in.
+//                pdwOff   -- [in/out] flags that must be clear; flags listed with '-' prefix are OR'd in.
+//
+//    RETURNS:    TRUE if successful; FALSE if a flag name is not recognized (an error message is printed to STDERR).
+//
+BOOL parseFlags( const char* str, DWORD* pdwOn, DWORD* pdwOff )
+{
+   char name[32];
+   const char* p;
+   BOOL bClear;
+   int i, len;
+
+   p = str;
+   while( *p != '\0' )
+   {
+      bClear = (*p == '-');
+      if( bClear ) ++p;
+      len = (int) strcspn( p, "," );
+      for( i = 0; i < NUMFLAGNAMES; i++ )
+         if( (int) strlen( G_flagNames[i].name ) == len && strncmp( p, G_flagNames[i].name, len ) == 0 ) break;
+      if( i == NUMFLAGNAMES )
+      {
+         snprintf( name, sizeof(name), "%.*s", len, p );
+         fprintf( stderr, "ERROR: Unrecognized header flag '%s'\n", name );
+         return( FALSE );
+      }
+      if( bClear ) *pdwOff |= G_flagNames[i].dwFlag;
+      else *pdwOn |= G_flagNames[i].dwFlag;
+
+      p += len;
+      if( *p == ',' ) ++p;
+   }
+   return( TRUE );
+}
+
+
+//=== printEntry ======================================================================================================
+//
+//    Print one catalog entry as a CSV line on STDOUT (see file header).
+//
+//    ARGS:       pCat     -- [in] the open catalog.
+//                iEntry   -- [in] index of the entry.
+//                bLong    -- [in] if TRUE, include the target list.
+//
+void printEntry( PCXCATALOG pCat, int iEntry, BOOL bLong )
+{
+   const CXCENTRY* pEntry = &(pCat->pEntries[iEntry]);
+   const CXCTGT* pTgt;
+   int k;
+
+   printf( "%s,%s,%s,%s,%d,%d,0x%04x,", cxcGetString( pCat, pEntry->iPath ), cxcGetString( pCat, pEntry->iName ),
+           cxcGetString( pCat, pEntry->iSet ), cxcGetString( pCat, pEntry->iSubset ), pEntry->version, pEntry->date,
+           (unsigned int) pEntry->flags );
+   for( k = 0; k < pEntry->nSects; k++ )
+      printf( "%s%s", (k > 0) ? ";" : "", cxcGetString( pCat, pCat->pSects[pEntry->iFirstSect + k].iTag ) );
+   if( bLong )
+   {
+      printf( "," );
+      for( k = 0; k < pEntry->nTgts; k++ )
+      {
+         pTgt = &(pCat->pTgts[pEntry->iFirstTgt + k]);
+         printf( "%s%s:%d:%d", (k > 0) ? ";" : "", cxcGetString( pCat, pTgt->iName ), (int) pTgt->wType,
+                 (int) pTgt->wSubType );
+      }
+   }
+   printf( "\n" );
+}
+
+
+//=== getElapsedSecs ==================================================================================================
+//
+//    ARGS:       pStart -- [in] start time, from clock_gettime(CLOCK_MONOTONIC).
+//
+//    RETURNS:    Elapsed time since the start time, in seconds.
+//
+double getElapsedSecs( const struct timespec* pStart )
+{
+   struct timespec tNow;
+   clock_gettime( CLOCK_MONOTONIC, &tNow );
+   return( (tNow.tv_sec - pStart->tv_sec) + (tNow.tv_nsec - pStart->tv_nsec) * 1.0e-9 );
+}
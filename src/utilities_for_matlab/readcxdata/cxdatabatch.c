@@ -0,0 +1,494 @@
+//=====================================================================================================================
+//
+// cxdatabatch.c : Command-line batch reader for a directory of Maestro/Cntrlx data files (Linux).
+//
+// AUTHOR:  saruffner
+//
+// DESCRIPTION:
+// Re-analyzing a recording session means reading several thousand trial data files. This program ingests every data
+// file in one or more directories using all available cores, built on the standalone reader in cxdatalib.c. Each
+// worker thread claims the next unread file, opens (memory-maps) it, fully decodes the AI data, spike waveform and
+// DI<0>/DI<1> event streams, counts the records of each kind and the trial codes, and closes it. Decode buffers are
+// per-thread and reused from file to file.
+//
+// When all files are read, a one-line CSV summary of each file is written to STDOUT, in directory order:
+//
+//    file,version,records,nchans,scans,spikewave,spikes,events,others,codes,targets,sorted,status
+//
+// where 'scans' and 'spikewave' are the # of AI scans and spike waveform samples decompressed, 'spikes' and 'events'
+// are the # of events decoded on DI<0> and DI<1>, 'others' and 'targets' and 'sorted' are the # of DI<15..2> event,
+// target definition and sorted-spike train records, and 'codes' is the length of the trial code sequence. 'status' is
+// "ok" or an error description; a file that cannot be read does not stop the batch.
+//
+// A throughput summary -- files/s and MB/s over the wall-clock time spent reading -- is written to STDERR after each
+// pass. With the -r option, the directory is read repeatedly: the first pass is typically limited by the disk, later
+// passes by decoding (the files are then in the OS page cache).
+//
+// With the -b option, each AI and spike waveform stream is decompressed twice -- by cxdDecodeAI16() and by the
+// reference decoder cxdUncompressAI() -- and the two results are compared sample by sample. The decode rate of each,
+// in compressed MB/s and Msamples/s per thread, is added to the pass summary, along with the # of files for which the
+// two decoders disagreed (status "decode mismatch"). Run it with -j 1 on a mix of trial and long ContMode files.
+//
+// USAGE:  cxdatabatch [-j nthreads] [-r npasses] [-q] [-b] [-H nchans] dir [dir ...]
+//    -j : # of worker threads (default: # of online CPUs).
+//    -r : # of passes over the file set (default: 1). The CSV summary reflects the last pass.
+//    -q : suppress the per-file CSV summary (benchmark only).
+//    -b : benchmark the AI decompressor against the reference implementation.
+//    -H : # of AI channels recorded in headerless (pre-Dec2001) ContMode files. If not specified, AI data in such
+//         files is not decompressed.
+//
+// BUILD:  gcc -O2 -o cxdatabatch cxdatabatch.c cxdatalib.c -lpthread
+//
+// REVISION HISTORY:
+// 16oct2026-- Created.
+//          -- AI and spike waveform streams are now decompressed to 16-bit samples by cxdDecodeAI16(). Added -b option
+// to benchmark that decoder against the reference decoder, cxdUncompressAI().
+//=====================================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "cxdatalib.h"
+
+
+//=====================================================================================================================
+// MODULE GLOBALS, CONSTANTS
+//=====================================================================================================================
+
+typedef struct tagFileSummary       // summary of one data file, filled in by a worker thread
+{
+   char* path;                      //    the file's pathname
+   double dMB;                      //    file size in MB
+   int version;                     //    data file version (-1 if headerless)
+   int nRecords;                    //    # of records in file
+   int nChans;                      //    # of AI channels recorded
+   int nScans;                      //    # of AI scans decompressed
+   int nSpikeWave;                  //    # of spike waveform samples decompressed
+   int nSpikes;                     //    # of DI<0> events
+   int nEvents;                     //    # of DI<1> events
+   int nOtherRecs;                  //    # of DI<15..2> event records
+   int nCodes;                      //    length of trial code sequence
+   int nTgtRecs;                    //    # of target definition records
+   int nSortRecs;                   //    # of sorted-spike train records
+   char status[80];                 //    "ok" or error description
+   double dDecodedBytes;            //    (-b only) # of compressed AI/spike waveform bytes decoded
+   double dDecodedSamples;          //    (-b only) # of AI/spike waveform samples decoded
+   double dFastSecs;                //    (-b only) time spent in cxdDecodeAI16()
+   double dRefSecs;                 //    (-b only) time spent in cxdUncompressAI()
+   BOOL bMismatch;                  //    (-b only) TRUE if the two decoders disagreed
+} FILESUMMARY, *PFILESUMMARY;
+
+typedef struct tagWorkerBufs        // reusable per-thread decode buffers
+{
+   char* pcBytes;                   //    compressed AI or spike waveform stream
+   int nBytesSz;
+   short* pshSamples;               //    decompressed samples; capacity = nBytesSz
+   double* pdSamples;               //    event times, or decompressed samples from the reference decoder
+   int nSamplesSz;
+} WORKERBUFS;
+
+PFILESUMMARY G_pFiles = NULL;       // the file set
+int G_nFiles = 0;
+int G_nFilesSz = 0;
+volatile int G_iNextFile = 0;       // index of the next file to be claimed by a worker thread
+int G_nHeaderlessChans = 0;         // # of AI channels assumed for headerless ContMode files (0 = don't decompress)
+BOOL G_bBenchmark = FALSE;          // if TRUE, benchmark cxdDecodeAI16() against cxdUncompressAI()
+
+
+//=====================================================================================================================
+// FUNCTIONS DEFINED IN THIS MODULE
+//=====================================================================================================================
+void usage();
+BOOL addDirectory( const char* dir );
+int compareSummaries( const void* p1, const void* p2 );
+BOOL growBuffers( WORKERBUFS* pBufs, int nBytes, int nSamples );
+void readOneFile( PFILESUMMARY pSum, WORKERBUFS* pBufs );
+void decodeStream( PFILESUMMARY pSum, WORKERBUFS* pBufs, int nBytes, int nCh, int* pNScans );
+void* workerThread( void* pArg );
+double getElapsedSecs( const struct timespec* pStart );
+
+
+//=== main ============================================================================================================
+int main( int argc, char* argv[] )
+{
+   int i, opt, iPass, nThreads, nPasses, nCreated, nMismatch;
+   BOOL bQuiet;
+   double dTotalMB, dSecs, dBytes, dSamples, dFastSecs, dRefSecs;
+   pthread_t* pThreads;
+   struct timespec tStart;
+
+   nThreads = (int) sysconf( _SC_NPROCESSORS_ONLN );
+   if( nThreads < 1 ) nThreads = 1;
+   nPasses = 1;
+   bQuiet = FALSE;
+   while( (opt = getopt( argc, argv, "j:r:qbH:" )) != -1 )
+   {
+      switch( opt )
+      {
+         case 'j' : nThreads = atoi( optarg ); break;
+         case 'r' : nPasses = atoi( optarg ); break;
+         case 'q' : bQuiet = TRUE; break;
+         case 'b' : G_bBenchmark = TRUE; break;
+         case 'H' : G_nHeaderlessChans = atoi( optarg ); break;
+         default :  usage(); return( 1 );
+      }
+   }
+   if( optind >= argc || nThreads < 1 || nPasses < 1 || G_nHeaderlessChans < 0 || G_nHeaderlessChans > CXH_MAXAI )
+   {
+      usage();
+      return( 1 );
+   }
+
+   for( i = optind; i < argc; i++ ) if( !addDirectory( argv[i] ) ) return( 1 );
+   if( G_nFiles == 0 )
+   {
+      fprintf( stderr, "No files found.\n" );
+      return( 1 );
+   }
+   qsort( G_pFiles, G_nFiles, sizeof(FILESUMMARY), compareSummaries );
+   if( nThreads > G_nFiles ) nThreads = G_nFiles;
+
+   pThreads = (pthread_t*) malloc( sizeof(pthread_t) * nThreads );
+   if( pThreads == NULL )
+   {
+      fprintf( stderr, "ERROR: Out of memory\n" );
+      return( 1 );
+   }
+
+   for( iPass = 1; iPass <= nPasses; iPass++ )
+   {
+      G_iNextFile = 0;
+      clock_gettime( CLOCK_MONOTONIC, &tStart );
+      for( nCreated = 0; nCreated < nThreads; nCreated++ )
+         if( pthread_create( &(pThreads[nCreated]), NULL, workerThread, NULL ) != 0 ) break;
+      if( nCreated == 0 ) workerThread( NULL );                         // no threads? do it on this one
+      for( i = 0; i < nCreated; i++ ) pthread_join( pThreads[i], NULL );
+      dSecs = getElapsedSecs( &tStart );
+
+      dTotalMB = 0;
+      for( i = 0; i < G_nFiles; i++ ) dTotalMB += G_pFiles[i].dMB;
+      if( dSecs <= 0 ) dSecs = 1.0e-9;
+      fprintf( stderr, "pass %d: %d files, %.1f MB in %.3f s on %d threads: %.1f files/s, %.1f MB/s\n", iPass,
+               G_nFiles, dTotalMB, dSecs, (nCreated > 0) ? nCreated : 1, G_nFiles / dSecs, dTotalMB / dSecs );
+
+      if( G_bBenchmark )
+      {
+         dBytes = dSamples = dFastSecs = dRefSecs = 0;
+         nMismatch = 0;
+         for( i = 0; i < G_nFiles; i++ )
+         {
+            dBytes += G_pFiles[i].dDecodedBytes;
+            dSamples += G_pFiles[i].dDecodedSamples;
+            dFastSecs += G_pFiles[i].dFastSecs;
+            dRefSecs += G_pFiles[i].dRefSecs;
+            if( G_pFiles[i].bMismatch ) ++nMismatch;
+         }
+         if( dFastSecs <= 0 ) dFastSecs = 1.0e-9;
+         if( dRefSecs <= 0 ) dRefSecs = 1.0e-9;
+         fprintf( stderr, "   decode %.1f MB -> %.1f Msamples: int16 %.1f MB/s (%.1f Msamples/s), reference %.1f MB/s "
+                  "(%.1f Msamples/s), speedup %.2fx, %d mismatches\n", dBytes / 1.0e6, dSamples / 1.0e6,
+                  dBytes / 1.0e6 / dFastSecs, dSamples / 1.0e6 / dFastSecs, dBytes / 1.0e6 / dRefSecs,
+                  dSamples / 1.0e6 / dRefSecs, dRefSecs / dFastSecs, nMismatch );
+      }
+   }
+   free( pThreads );
+
+   if( !bQuiet )
+   {
+      printf( "file,version,records,nchans,scans,spikewave,spikes,events,others,codes,targets,sorted,status\n" );
+      for( i = 0; i < G_nFiles; i++ )
+      {
+         PFILESUMMARY p = &(G_pFiles[i]);
+         printf( "%s,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%s\n", p->path, p->version, p->nRecords, p->nChans, p->nScans,
+                 p->nSpikeWave, p->nSpikes, p->nEvents, p->nOtherRecs, p->nCodes, p->nTgtRecs, p->nSortRecs,
+                 p->status );
+      }
+   }
+
+   for( i = 0; i < G_nFiles; i++ ) free( G_pFiles[i].path );
+   free( G_pFiles );
+   return( 0 );
+}
+
+
+//=== usage ===========================================================================================================
+//
+//    Prints cxdatabatch usage details to STDERR.
+//
+void usage()
+{
+   fprintf( stderr, "USAGE: cxdatabatch [-j nthreads] [-r npasses] [-q] [-b] [-H nchans] dir [dir ...]\n" );
+   fprintf( stderr, "   -j --> # of worker threads (default = # of CPUs)\n" );
+   fprintf( stderr, "   -r --> # of passes over the file set, for benchmarking (default = 1)\n" );
+   fprintf( stderr, "   -q --> no per-file CSV summary on STDOUT; throughput only\n" );
+   fprintf( stderr, "   -b --> benchmark AI decompression against the reference decoder\n" );
+   fprintf( stderr, "   -H --> # of AI channels [0..16] recorded in headerless ContMode files (pre-Dec2001)\n" );
+}
+
+
+//=== addDirectory ====================================================================================================
+//
+//    Add all regular files in the specified directory to the file set. Subdirectories and hidden files are skipped.
+//    Maestro data files have no standard extension, so any file may be a data file; those that are not are reported
+//    as such when read.
+//
+//    ARGS:       dir   -- [in] the directory's pathname.
+//
+//    RETURNS:    TRUE if successful, FALSE otherwise (an error message is printed to STDERR).
+//
+BOOL addDirectory( const char* dir )
+{
+   DIR* pDir;
+   struct dirent* pEntry;
+   struct stat st;
+   char* path;
+   PFILESUMMARY pNew;
+
+   if( (pDir = opendir( dir )) == NULL )
+   {
+      fprintf( stderr, "ERROR: Could not open directory %s\n", dir );
+      return( FALSE );
+   }
+
+   while( (pEntry = readdir( pDir )) != NULL )
+   {
+      if( pEntry->d_name[0] == '.' ) continue;
+
+      path = (char*) malloc( strlen( dir ) + strlen( pEntry->d_name ) + 2 );
+      if( path == NULL ) break;
+      sprintf( path, "%s/%s", dir, pEntry->d_name );
+      if( stat( path, &st ) != 0 || !S_ISREG(st.st_mode) )
+      {
+         free( path );
+         continue;
+      }
+
+      if( G_nFiles == G_nFilesSz )
+      {
+         pNew = (PFILESUMMARY) realloc( G_pFiles, sizeof(FILESUMMARY) * (G_nFilesSz + 1024) );
+         if( pNew == NULL )
+         {
+            free( path );
+            break;
+         }
+         G_pFiles = pNew;
+         G_nFilesSz += 1024;
+      }
+      memset( &(G_pFiles[G_nFiles]), 0, sizeof(FILESUMMARY) );
+      G_pFiles[G_nFiles].path = path;
+      ++G_nFiles;
+   }
+   closedir( pDir );
+
+   if( pEntry != NULL )
+   {
+      fprintf( stderr, "ERROR: Out of memory listing directory %s\n", dir );
+      return( FALSE );
+   }
+   return( TRUE );
+}
+
+
+//=== compareSummaries ================================================================================================
+//
+//    qsort() comparator: orders the file set by pathname.
+//
+int compareSummaries( const void* p1, const void* p2 )
+{
+   return( strcmp( ((const FILESUMMARY*) p1)->path, ((const FILESUMMARY*) p2)->path ) );
+}
+
+
+//=== growBuffers =====================================================================================================
+//
+//    Ensure a worker thread's decode buffers have the specified capacities, reallocating as needed. Buffers only grow.
+//
+//    ARGS:       pBufs    -- [in/out] the worker's buffers.
+//                nBytes   -- [in] required capacity of the compressed byte stream and 16-bit sample buffers.
+//                nSamples -- [in] required capacity of the double-valued sample buffer.
+//
+//    RETURNS:    TRUE if successful, FALSE if memory allocation failed.
+//
+BOOL growBuffers( WORKERBUFS* pBufs, int nBytes, int nSamples )
+{
+   char* pc;
+   short* psh;
+   double* pd;
+
+   if( nBytes > pBufs->nBytesSz )
+   {
+      if( (pc = (char*) realloc( pBufs->pcBytes, nBytes )) == NULL ) return( FALSE );
+      pBufs->pcBytes = pc;
+      if( (psh = (short*) realloc( pBufs->pshSamples, sizeof(short) * nBytes )) == NULL ) return( FALSE );
+      pBufs->pshSamples = psh;
+      pBufs->nBytesSz = nBytes;
+   }
+   if( nSamples > pBufs->nSamplesSz )
+   {
+      if( (pd = (double*) realloc( pBufs->pdSamples, sizeof(double) * nSamples )) == NULL ) return( FALSE );
+      pBufs->pdSamples = pd;
+      pBufs->nSamplesSz = nSamples;
+   }
+   return( TRUE );
+}
+
+
+//=== readOneFile =====================================================================================================
+//
+//    Open a data file, decode its AI, spike waveform and DI<0..1> event streams, count its other records, and close
+//    it, filling in the file's summary.
+//
+//    ARGS:       pSum  -- [in/out] the file's summary. Only the pathname need be set on input.
+//                pBufs -- [in/out] the calling worker's decode buffers.
+//
+void readOneFile( PFILESUMMARY pSum, WORKERBUFS* pBufs )
+{
+   CXDFILE file;
+   CXFILEHDR* pHdr;
+   int n, nBytes;
+   char* path;
+
+   path = pSum->path;                                                   // reset the summary from any previous pass
+   memset( pSum, 0, sizeof(FILESUMMARY) );
+   pSum->path = path;
+   pSum->version = -1;
+   if( !cxdOpen( &file, pSum->path ) )
+   {
+      snprintf( pSum->status, sizeof(pSum->status), "%.79s", file.errMsg );
+      return;
+   }
+   pSum->dMB = ((double) file.nBytes) / 1.0e6;
+   pSum->nRecords = file.nRecords;
+
+   pHdr = cxdGetHeader( &file );
+   if( pHdr != NULL )
+   {
+      pSum->version = cxdIsBigEndianHost() ? cxdSwapInt( pHdr->version ) : pHdr->version;
+      pSum->nChans = cxdIsBigEndianHost() ? cxdSwapShort( pHdr->nchans ) : pHdr->nchans;
+   }
+   else
+      pSum->nChans = G_nHeaderlessChans;
+   if( pSum->nChans < 0 || pSum->nChans > CXH_MAXAI )
+   {
+      sprintf( pSum->status, "bad channel count %d", pSum->nChans );
+      cxdClose( &file );
+      return;
+   }
+
+   // decompress the AI stream, then the spike waveform stream. One decompressed sample per compressed byte suffices.
+   // The double-valued buffer also holds the event times.
+   strcpy( pSum->status, "ok" );
+   nBytes = cxdGetNumRecordsOfKind( &file, CXD_AI ) * CX_RECORDBYTES;
+   n = cxdGetNumRecordsOfKind( &file, CXD_SPIKEWAVE ) * CX_RECORDBYTES;
+   if( n > nBytes ) nBytes = n;
+   n = (cxdGetNumRecordsOfKind( &file, CXD_EVENT0 ) + cxdGetNumRecordsOfKind( &file, CXD_EVENT1 )) * CX_RECORDINTS;
+   if( n < nBytes ) n = nBytes;
+   if( !growBuffers( pBufs, nBytes, n ) )
+   {
+      strcpy( pSum->status, "out of memory" );
+      cxdClose( &file );
+      return;
+   }
+
+   if( pSum->nChans > 0 )
+   {
+      nBytes = cxdGatherBytes( &file, CXD_AI, pBufs->pcBytes );
+      decodeStream( pSum, pBufs, nBytes, pSum->nChans, &(pSum->nScans) );
+   }
+   nBytes = cxdGatherBytes( &file, CXD_SPIKEWAVE, pBufs->pcBytes );
+   if( nBytes > 0 )
+      decodeStream( pSum, pBufs, nBytes, 1, &(pSum->nSpikeWave) );
+   if( pSum->bMismatch ) strcpy( pSum->status, "decode mismatch" );
+
+   pSum->nSpikes = cxdDecodeEventTimes( &file, CXD_EVENT0, pBufs->pdSamples, pBufs->nSamplesSz );
+   pSum->nEvents = cxdDecodeEventTimes( &file, CXD_EVENT1, pBufs->pdSamples, pBufs->nSamplesSz );
+   pSum->nOtherRecs = cxdGetNumRecordsOfKind( &file, CXD_OTHEREVENT );
+   pSum->nCodes = cxdCountTrialCodes( &file );
+   pSum->nTgtRecs = cxdGetNumRecordsOfKind( &file, CXD_TARGET );
+   pSum->nSortRecs = cxdGetNumRecordsOfKind( &file, CXD_SORTSPIKE );
+
+   cxdClose( &file );
+}
+
+
+//=== decodeStream ====================================================================================================
+//
+//    Decompress an AI or spike waveform stream with cxdDecodeAI16(). In benchmark mode (-b), the stream is decoded
+//    again by the reference decoder cxdUncompressAI(), both decoders are timed, and the results are compared.
+//
+//    ARGS:       pSum     -- [in/out] the file's summary. In benchmark mode, the decode statistics are updated.
+//                pBufs    -- [in/out] the calling worker's decode buffers. The compressed stream is in pcBytes, and
+//                            the buffers must hold at least 'nBytes' samples.
+//                nBytes   -- [in] # of bytes in the compressed stream.
+//                nCh      -- [in] # of channels recorded in the stream.
+//                pNScans  -- [out] # of complete scans decompressed.
+//
+void decodeStream( PFILESUMMARY pSum, WORKERBUFS* pBufs, int nBytes, int nCh, int* pNScans )
+{
+   struct timespec tStart;
+   int i, nCompressed, nRefCompressed, nRefScans;
+
+   clock_gettime( CLOCK_MONOTONIC, &tStart );
+   cxdDecodeAI16( pBufs->pshSamples, nBytes, pBufs->pcBytes, nBytes, nCh, &nCompressed, pNScans );
+   if( !G_bBenchmark ) return;
+   pSum->dFastSecs += getElapsedSecs( &tStart );
+
+   clock_gettime( CLOCK_MONOTONIC, &tStart );
+   cxdUncompressAI( pBufs->pdSamples, nBytes, pBufs->pcBytes, nBytes, nCh, &nRefCompressed, &nRefScans );
+   pSum->dRefSecs += getElapsedSecs( &tStart );
+
+   pSum->dDecodedBytes += nCompressed;
+   pSum->dDecodedSamples += ((double) *pNScans) * nCh;
+   if( nRefCompressed != nCompressed || nRefScans != *pNScans )
+      pSum->bMismatch = TRUE;
+   else for( i = 0; i < nRefScans * nCh; i++ ) if( pBufs->pdSamples[i] != (double) pBufs->pshSamples[i] )
+   {
+      pSum->bMismatch = TRUE;
+      break;
+   }
+}
+
+
+//=== workerThread ====================================================================================================
+//
+//    Worker thread: repeatedly claims the next unread file in the file set and reads it, until none remain.
+//
+//    ARGS:       pArg -- [in] not used.
+//
+//    RETURNS:    NULL.
+//
+void* workerThread( void* pArg )
+{
+   int i;
+   WORKERBUFS bufs;
+
+   (void) pArg;
+   memset( &bufs, 0, sizeof(WORKERBUFS) );
+   while( (i = __sync_fetch_and_add( &G_iNextFile, 1 )) < G_nFiles )
+      readOneFile( &(G_pFiles[i]), &bufs );
+
+   if( bufs.pcBytes != NULL ) free( bufs.pcBytes );
+   if( bufs.pshSamples != NULL ) free( bufs.pshSamples );
+   if( bufs.pdSamples != NULL ) free( bufs.pdSamples );
+   return( NULL );
+}
+
+
+//=== getElapsedSecs ==================================================================================================
+//
+//    ARGS:       pStart -- [in] start time, from clock_gettime(CLOCK_MONOTONIC).
+//
+//    RETURNS:    Elapsed time since the start time, in seconds.
+//
+double getElapsedSecs( const struct timespec* pStart )
+{
+   struct timespec tNow;
+   clock_gettime( CLOCK_MONOTONIC, &tNow );
+   return( (tNow.tv_sec - pStart->tv_sec) + (tNow.tv_nsec - pStart->tv_nsec) * 1.0e-9 );
+}
@@ -0,0 +1,1022 @@
+//=====================================================================================================================
+//
+// cxdatacat.c : A catalog index over the Maestro/Cntrlx data files of one or more recording sessions (Linux).
+//
+// AUTHOR:  saruffner
+//
+// DESCRIPTION:
+// Questions like "which trials in this session were trial X, earned a reward, and had tagged section Y?" used to mean
+// running readcxdata() on every one of several thousand files. This module builds a compact catalog of a session's
+// data files once, keeps it current cheaply, and answers such questions from the catalog alone:
+//
+//    1) cxcUpdate() creates or updates a catalog file for one or more directories. Every regular, non-hidden file in
+// them is listed along with its modification time and size. Files unchanged since the last update keep their existing
+// catalog entries; the rest are scanned in parallel by a pool of worker threads, each of which opens the file with
+// cxdOpen() (cxdatalib.c) and extracts the CXFILEHDR fields of interest -- trial, set and subset names, data file
+// version, CXHF_* flags (recording mode and trial result), trial flags, date, scan counts -- plus the tagged sections
+// in the CX_TAGSECTRECORD and a summary (category, type, name) of each target defined in the CX_TGTRECORDs. Entries
+// for files no longer present are dropped. The new catalog is written to a temporary file and renamed over the old
+// one, so readers never see a partially written catalog.
+//    2) cxcOpen() maps a catalog file read-only into memory, and cxcQuery() filters its entries on any combination of
+// names, tagged section, target name, header flags, file version and recording date. All strings in the catalog are
+// stored once, in a string table, so a name criterion is resolved to a string table offset once per query and each
+// entry is then tested with integer comparisons; a query over tens of thousands of entries takes well under a
+// millisecond.
+//
+// See cxdatacat.h for the catalog file layout. The catalog records the header flags as saved in the data file; the
+// CX_FT_* trial result codes of the Maestro runtime are not persisted, but CXHF_REWARDEARNED, CXHF_REWARDGIVEN and
+// the "searchTask" result flags carry the trial outcome.
+//
+// The command-line front end is cxcatalog.c.
+//
+// REVISION HISTORY:
+// 16oct2026-- Created.
+//          -- cxcOpen() now rejects a catalog in which any entry's tagged sections or targets lie outside the section
+// or target table. Files are cataloged under canonical pathnames (see cxcListDirectory()), so an update from a
+// different working directory no longer rescans every file and adds a duplicate entry for each.
+//=====================================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "cxdatalib.h"
+#include "cxdatacat.h"
+
+
+//=====================================================================================================================
+// MODULE-PRIVATE TYPES, CONSTANTS
+//=====================================================================================================================
+
+typedef struct tagCxcScanSect       // a tagged section, as extracted from a data file
+{
+   char tag[SECTIONTAGSZ];
+   short iFirstSeg;
+   short iLastSeg;
+} CXCSCANSECT;
+
+typedef struct tagCxcScanTgt        // a target summary, as extracted from a data file
+{
+   char name[CX_MAXOBJNAMELEN];
+   WORD wType;
+   WORD wSubType;
+} CXCSCANTGT;
+
+typedef struct tagCxcItem           // one file in the catalog being built:
+{
+   char* path;                      //    pathname
+   int64_t tModified;               //    modification time and size, from stat()
+   int64_t nBytes;
+   int iOld;                        //    index of unchanged entry in previous catalog; -1 if file must be scanned
+   CXCENTRY entry;                  //    [scanned] the catalog entry; string fields are not yet set
+   char name[CXH_NAME_SZ];          //    [scanned] trial, set and subset names
+   char set[CXH_NAME_SZ];
+   char subset[CXH_NAME_SZ];
+   int nSects;                      //    [scanned] the tagged sections
+   CXCSCANSECT sects[CX_RECORDSECTS];
+   int nTgts;                       //    [scanned] the target summaries
+   CXCSCANTGT* pTgts;
+} CXCITEM, *PCXCITEM;
+
+typedef struct tagCxcItemList       // the files in the catalog being built, and the next file to be scanned
+{
+   PCXCITEM pItems;
+   int nItems;
+   int nItemsSz;
+   volatile int iNext;
+} CXCITEMLIST, *PCXCITEMLIST;
+
+typedef struct tagCxcStrTable       // string table under construction. Strings are interned: each distinct string is
+{                                   // stored once, found via an open-addressed hash table of string offsets.
+   char* pBuf;
+   int nBytes;
+   int nBytesSz;
+   int* piSlots;                    //    hash table slots: string offset, or -1 if empty
+   int nSlots;                      //    always a power of 2
+   int nStrings;
+} CXCSTRTABLE, *PCXCSTRTABLE;
+
+#define CXC_LISTGROW       1024     // file list grows by this many items at a time
+
+
+//=====================================================================================================================
+// MODULE-PRIVATE FUNCTION PROTOTYPES
+//=====================================================================================================================
+BOOL cxcListDirectory( PCXCITEMLIST pList, const char* dir, char* errMsg, int errSz );
+int cxcCompareItems( const void* p1, const void* p2 );
+int cxcFindOldEntry( PCXCATALOG pOld, const int* piOldSlots, int nOldSlots, const char* path );
+VOID cxcScanFile( PCXCITEM pItem );
+void* cxcScanThread( void* pArg );
+BOOL cxcWriteCatalog( const char* catPath, PCXCITEMLIST pList, PCXCATALOG pOld, char* errMsg, int errSz );
+DWORD cxcHash( const char* s );
+BOOL cxcInitStrTable( PCXCSTRTABLE pTable );
+VOID cxcFreeStrTable( PCXCSTRTABLE pTable );
+int cxcIntern( PCXCSTRTABLE pTable, const char* s );
+int cxcFindString( PCXCATALOG pCat, const char* s );
+BOOL cxcNameMatches( PCXCATALOG pCat, int iStr, const char* pattern, int iPatternStr );
+
+
+//=== cxcUpdate =======================================================================================================
+//
+//    Create or update the catalog of the data files in one or more directories (see file header). The catalog lists
+//    exactly the files found in the specified directories: files that are new or whose modification time or size
+//    changed since the last update are scanned, unchanged files keep their previous entries, and entries for files no
+//    longer found are dropped. Entries are ordered by pathname.
+//
+//    If the catalog file does not exist, or is not a valid catalog, it is built from scratch.
+//
+//    ARGS:       catPath  -- [in] pathname of the catalog file.
+//                dirs     -- [in] the directories to catalog.
+//                nDirs    -- [in] # of directories.
+//                nThreads -- [in] # of worker threads that scan files (at least 1).
+//                pStats   -- [out] what the update did. May be NULL.
+//                errMsg   -- [out] on failure, a description of the error.
+//                errSz    -- [in] size of the error message buffer.
+//
+//    RETURNS:    TRUE if successful, FALSE otherwise.
+//
+BOOL cxcUpdate( const char* catPath, const char** dirs, int nDirs, int nThreads, PCXCUPDATESTATS pStats,
+                char* errMsg, int errSz )
+{
+   CXCITEMLIST list;
+   CXCATALOG old;
+   BOOL bHaveOld, bOk;
+   int* piOldSlots;
+   int i, j, nOldSlots, nCreated, nScanned, nStale;
+   DWORD h;
+   pthread_t* pThreads;
+   const CXCENTRY* pOldEntry;
+
+   memset( &list, 0, sizeof(CXCITEMLIST) );
+   piOldSlots = NULL;
+   pThreads = NULL;
+   bOk = FALSE;
+   if( pStats != NULL ) memset( pStats, 0, sizeof(CXCUPDATESTATS) );
+
+   bHaveOld = cxcOpen( &old, catPath );                                 // previous catalog, if any
+   if( !bHaveOld ) memset( &old, 0, sizeof(CXCATALOG) );
+
+   for( i = 0; i < nDirs; i++ )                                         // list the files in the directories
+      if( !cxcListDirectory( &list, dirs[i], errMsg, errSz ) ) goto CLEANUP;
+   qsort( list.pItems, list.nItems, sizeof(CXCITEM), cxcCompareItems );
+   for( i = j = 1; i < list.nItems; i++ )                               // drop duplicates, in case the same directory
+   {                                                                    // was specified more than once
+      if( strcmp( list.pItems[i].path, list.pItems[j-1].path ) == 0 ) free( list.pItems[i].path );
+      else list.pItems[j++] = list.pItems[i];
+   }
+   if( list.nItems > 1 ) list.nItems = j;
+
+   if( bHaveOld && old.pHdr->nEntries > 0 )                             // hash the previous catalog's entries by
+   {                                                                    // pathname, then find each listed file's
+      nOldSlots = 1;                                                    // unchanged entry, if any
+      while( nOldSlots < 2 * old.pHdr->nEntries ) nOldSlots <<= 1;
+      piOldSlots = (int*) malloc( sizeof(int) * nOldSlots );
+      if( piOldSlots == NULL )
+      {
+         snprintf( errMsg, errSz, "Out of memory" );
+         goto CLEANUP;
+      }
+      for( j = 0; j < nOldSlots; j++ ) piOldSlots[j] = -1;
+      for( i = 0; i < old.pHdr->nEntries; i++ )
+      {
+         h = cxcHash( cxcGetString( &old, old.pEntries[i].iPath ) ) & (nOldSlots - 1);
+         while( piOldSlots[h] >= 0 ) h = (h + 1) & (nOldSlots - 1);
+         piOldSlots[h] = i;
+      }
+   }
+   else
+      nOldSlots = 0;
+
+   nScanned = nStale = 0;
+   for( i = 0; i < list.nItems; i++ )
+   {
+      list.pItems[i].iOld = -1;
+      if( piOldSlots != NULL )
+      {
+         j = cxcFindOldEntry( &old, piOldSlots, nOldSlots, list.pItems[i].path );
+         pOldEntry = (j >= 0) ? &(old.pEntries[j]) : NULL;
+         if( pOldEntry != NULL && pOldEntry->tModified == list.pItems[i].tModified &&
+             pOldEntry->nBytes == list.pItems[i].nBytes )
+            list.pItems[i].iOld = j;
+         else if( pOldEntry != NULL )
+            ++nStale;
+      }
+      if( list.pItems[i].iOld < 0 ) ++nScanned;
+   }
+
+   if( nThreads < 1 ) nThreads = 1;                                     // scan new and modified files in parallel
+   if( nThreads > nScanned ) nThreads = nScanned;
+   list.iNext = 0;
+   nCreated = 0;
+   if( nThreads > 0 )
+   {
+      pThreads = (pthread_t*) malloc( sizeof(pthread_t) * nThreads );
+      if( pThreads != NULL ) for( ; nCreated < nThreads; nCreated++ )
+         if( pthread_create( &(pThreads[nCreated]), NULL, cxcScanThread, &list ) != 0 ) break;
+      if( nCreated == 0 ) cxcScanThread( &list );                       // no threads? do it on this one
+      for( i = 0; i < nCreated; i++ ) pthread_join( pThreads[i], NULL );
+   }
+
+   if( !cxcWriteCatalog( catPath, &list, &old, errMsg, errSz ) ) goto CLEANUP;
+
+   if( pStats != NULL )
+   {
+      pStats->nFiles = list.nItems;
+      pStats->nScanned = nScanned;
+      pStats->nReused = list.nItems - nScanned;
+      pStats->nDropped = (bHaveOld ? old.pHdr->nEntries : 0) - pStats->nReused - nStale;
+      for( i = 0; i < list.nItems; i++ )
+      {
+         j = list.pItems[i].iOld;
+         if( (j < 0 ? list.pItems[i].entry.status : old.pEntries[j].status) == CXC_UNREADABLE )
+            ++pStats->nUnreadable;
+      }
+   }
+   bOk = TRUE;
+
+CLEANUP:
+   for( i = 0; i < list.nItems; i++ )
+   {
+      free( list.pItems[i].path );
+      if( list.pItems[i].pTgts != NULL ) free( list.pItems[i].pTgts );
+   }
+   if( list.pItems != NULL ) free( list.pItems );
+   if( piOldSlots != NULL ) free( piOldSlots );
+   if( pThreads != NULL ) free( pThreads );
+   if( bHaveOld ) cxcClose( &old );
+   return( bOk );
+}
+
+
+//=== cxcOpen =========================================================================================================
+//
+//    Open a catalog file: map it read-only into memory and validate its header, its table bounds, and the section and
+//    target ranges of every entry.
+//
+//    ARGS:       pCat  -- [out] the catalog object. Need not be initialized. On failure, it is left in the closed
+//                         state and pCat->errMsg describes the error.
+//                path  -- [in] the catalog's pathname.
+//
+//    RETURNS:    TRUE if successful, FALSE otherwise.
+//
+BOOL cxcOpen( PCXCATALOG pCat, const char* path )
+{
+   int fd;
+   struct stat st;
+   void* p;
+   const CXCHEADER* pHdr;
+   const CXCENTRY* pEntry;
+   int i;
+
+   memset( (VOID*) pCat, 0, sizeof(CXCATALOG) );
+   if( (fd = open( path, O_RDONLY )) < 0 )
+   {
+      snprintf( pCat->errMsg, sizeof(pCat->errMsg), "Could not open %s", path );
+      return( FALSE );
+   }
+   if( fstat( fd, &st ) != 0 || !S_ISREG(st.st_mode) || st.st_size < (off_t) sizeof(CXCHEADER) )
+   {
+      snprintf( pCat->errMsg, sizeof(pCat->errMsg), "Not a catalog file: %s", path );
+      close( fd );
+      return( FALSE );
+   }
+
+   pCat->nBytes = (size_t) st.st_size;
+   p = mmap( NULL, pCat->nBytes, PROT_READ, MAP_SHARED, fd, 0 );
+   close( fd );
+   if( p == MAP_FAILED )
+   {
+      snprintf( pCat->errMsg, sizeof(pCat->errMsg), "Could not map %s into memory", path );
+      pCat->nBytes = 0;
+      return( FALSE );
+   }
+   pCat->pBase = (BYTE*) p;
+   pCat->bMapped = TRUE;
+
+   pHdr = (const CXCHEADER*) pCat->pBase;                               // validate signature, version, and that
+   if( pHdr->magic != CXC_MAGIC || pHdr->version != CXC_VERSION ||    // every table lies within the file
+       pHdr->nEntries < 0 || pHdr->nSects < 0 || pHdr->nTgts < 0 || pHdr->nStrBytes < 1 ||
+       pHdr->offEntries < (int) sizeof(CXCHEADER) || pHdr->offSects < 0 || pHdr->offTgts < 0 ||
+       pHdr->offStrings < 0 ||
+       (size_t) pHdr->offEntries + sizeof(CXCENTRY) * (size_t) pHdr->nEntries > pCat->nBytes ||
+       (size_t) pHdr->offSects + sizeof(CXCSECT) * (size_t) pHdr->nSects > pCat->nBytes ||
+       (size_t) pHdr->offTgts + sizeof(CXCTGT) * (size_t) pHdr->nTgts > pCat->nBytes ||
+       (size_t) pHdr->offStrings + (size_t) pHdr->nStrBytes > pCat->nBytes ||
+       pCat->pBase[pHdr->offStrings + pHdr->nStrBytes - 1] != '\0' )
+   {
+      snprintf( pCat->errMsg, sizeof(pCat->errMsg), "Not a valid catalog file (or wrong version): %s", path );
+      cxcClose( pCat );
+      return( FALSE );
+   }
+
+   pEntry = (const CXCENTRY*) (pCat->pBase + pHdr->offEntries);        // validate that each entry's sections and
+   for( i = 0; i < pHdr->nEntries; i++, pEntry++ )                      // targets lie within the section and target
+   {                                                                    // tables, which cxcQuery() indexes directly
+      if( pEntry->iFirstSect < 0 || pEntry->nSects < 0 || pEntry->iFirstSect > pHdr->nSects - pEntry->nSects ||
+          pEntry->iFirstTgt < 0 || pEntry->nTgts < 0 || pEntry->iFirstTgt > pHdr->nTgts - pEntry->nTgts )
+      {
+         snprintf( pCat->errMsg, sizeof(pCat->errMsg), "Corrupted catalog file (bad entry %d): %s", i, path );
+         cxcClose( pCat );
+         return( FALSE );
+      }
+   }
+
+   pCat->pHdr = pHdr;
+   pCat->pEntries = (const CXCENTRY*) (pCat->pBase + pHdr->offEntries);
+   pCat->pSects = (const CXCSECT*) (pCat->pBase + pHdr->offSects);
+   pCat->pTgts = (const CXCTGT*) (pCat->pBase + pHdr->offTgts);
+   pCat->pStrings = (const char*) (pCat->pBase + pHdr->offStrings);
+   return( TRUE );
+}
+
+
+//=== cxcClose ========================================================================================================
+//
+//    Release all resources associated with an open catalog. No effect if the catalog is already closed.
+//
+//    ARGS:       pCat  -- [in/out] the catalog object.
+//
+VOID cxcClose( PCXCATALOG pCat )
+{
+   if( pCat->pBase != NULL )
+   {
+      if( pCat->bMapped ) munmap( pCat->pBase, pCat->nBytes );
+      else free( pCat->pBase );
+   }
+   pCat->pBase = NULL;
+   pCat->nBytes = 0;
+   pCat->bMapped = FALSE;
+   pCat->pHdr = NULL;
+   pCat->pEntries = NULL;
+   pCat->pSects = NULL;
+   pCat->pTgts = NULL;
+   pCat->pStrings = NULL;
+}
+
+
+//=== cxcGetString ====================================================================================================
+//
+//    ARGS:       pCat  -- [in] an open catalog.
+//                iStr  -- [in] a string table offset, from a catalog entry, section or target.
+//
+//    RETURNS:    The string. An empty string if the offset is invalid.
+//
+const char* cxcGetString( PCXCATALOG pCat, int iStr )
+{
+   if( pCat->pHdr == NULL || iStr < 0 || iStr >= pCat->pHdr->nStrBytes ) return( "" );
+   return( pCat->pStrings + iStr );
+}
+
+
+//=== cxcInitQuery ====================================================================================================
+//
+//    Initialize a catalog query so that it matches every cataloged data file.
+//
+//    ARGS:       pQuery   -- [out] the query.
+//
+VOID cxcInitQuery( PCXCQUERY pQuery )
+{
+   memset( (VOID*) pQuery, 0, sizeof(CXCQUERY) );
+}
+
+
+//=== cxcQuery ========================================================================================================
+//
+//    Find the catalog entries matching a query. Each exact name criterion is first resolved to its string table
+//    offset -- if the name does not appear in the catalog at all, nothing matches -- so the per-entry tests are integer
+//    comparisons, except for prefix ("name*") criteria.
+//
+//    ARGS:       pCat        -- [in] an open catalog.
+//                pQuery      -- [in] the query criteria (see CXCQUERY).
+//                piMatches   -- [out] indices of the matching entries, in catalog order. May be NULL.
+//                nMax        -- [in] capacity of the 'piMatches' array.
+//
+//    RETURNS:    The total # of matching entries, which may exceed 'nMax'.
+//
+int cxcQuery( PCXCATALOG pCat, const CXCQUERY* pQuery, int* piMatches, int nMax )
+{
+   int iTrial, iSet, iSubset, iSect, iTgt;
+   int i, k, nMatches;
+   BOOL bFound;
+   const CXCENTRY* pEntry;
+
+   if( pCat->pHdr == NULL ) return( 0 );
+
+   iTrial = cxcFindString( pCat, pQuery->trial );                       // resolve exact name criteria; -1 if not
+   iSet = cxcFindString( pCat, pQuery->set );                           // found: no entry can match
+   iSubset = cxcFindString( pCat, pQuery->subset );
+   iSect = cxcFindString( pCat, pQuery->section );
+   iTgt = cxcFindString( pCat, pQuery->target );
+   if( iTrial == -1 || iSet == -1 || iSubset == -1 || iSect == -1 || iTgt == -1 ) return( 0 );
+
+   nMatches = 0;
+   for( i = 0; i < pCat->pHdr->nEntries; i++ )
+   {
+      pEntry = &(pCat->pEntries[i]);
+      if( pEntry->status != CXC_OK ) continue;
+      if( (pEntry->flags & pQuery->dwFlagsOn) != pQuery->dwFlagsOn || (pEntry->flags & pQuery->dwFlagsOff) != 0 )
+         continue;
+      if( pEntry->version < pQuery->minVersion ) continue;
+      if( (pQuery->dateFrom > 0 && pEntry->date < pQuery->dateFrom) ||
+          (pQuery->dateTo > 0 && pEntry->date > pQuery->dateTo) )
+         continue;
+      if( !cxcNameMatches( pCat, pEntry->iName, pQuery->trial, iTrial ) ||
+          !cxcNameMatches( pCat, pEntry->iSet, pQuery->set, iSet ) ||
+          !cxcNameMatches( pCat, pEntry->iSubset, pQuery->subset, iSubset ) )
+         continue;
+
+      if( pQuery->section != NULL )
+      {
+         bFound = FALSE;
+         for( k = 0; k < pEntry->nSects && !bFound; k++ )
+            bFound = cxcNameMatches( pCat, pCat->pSects[pEntry->iFirstSect + k].iTag, pQuery->section, iSect );
+         if( !bFound ) continue;
+      }
+      if( pQuery->target != NULL )
+      {
+         bFound = FALSE;
+         for( k = 0; k < pEntry->nTgts && !bFound; k++ )
+            bFound = cxcNameMatches( pCat, pCat->pTgts[pEntry->iFirstTgt + k].iName, pQuery->target, iTgt );
+         if( !bFound ) continue;
+      }
+
+      if( piMatches != NULL && nMatches < nMax ) piMatches[nMatches] = i;
+      ++nMatches;
+   }
+   return( nMatches );
+}
+
+
+//=== cxcListDirectory ================================================================================================
+//
+//    Add all regular files in the specified directory to the list of files to be cataloged, with their modification
+//    times and sizes. Subdirectories and hidden files are skipped. Maestro data files have no standard extension, so
+//    any file may be a data file; those that are not are cataloged with status CXC_UNREADABLE. Each file is listed
+//    under the canonical (absolute, symbolic link-free) pathname of the directory, so that an update run from another
+//    working directory, or with the directory named differently, finds the files' existing catalog entries.
+//
+//    ARGS:       pList    -- [in/out] the file list.
+//                dir      -- [in] the directory's pathname.
+//                errMsg   -- [out] on failure, a description of the error.
+//                errSz    -- [in] size of the error message buffer.
+//
+//    RETURNS:    TRUE if successful, FALSE otherwise.
+//
+BOOL cxcListDirectory( PCXCITEMLIST pList, const char* dir, char* errMsg, int errSz )
+{
+   DIR* pDir;
+   struct dirent* pEntry;
+   struct stat st;
+   char* path;
+   char* canonDir;
+   PCXCITEM pNew;
+
+   canonDir = realpath( dir, NULL );                                    // list files by canonical pathname, so the
+   if( canonDir == NULL || (pDir = opendir( canonDir )) == NULL )       // catalog does not depend on the working
+   {                                                                    // directory or how the directory was named
+      snprintf( errMsg, errSz, "Could not open directory %s", dir );
+      if( canonDir != NULL ) free( canonDir );
+      return( FALSE );
+   }
+
+   while( (pEntry = readdir( pDir )) != NULL )
+   {
+      if( pEntry->d_name[0] == '.' ) continue;
+
+      path = (char*) malloc( strlen( canonDir ) + strlen( pEntry->d_name ) + 2 );
+      if( path == NULL ) break;
+      sprintf( path, "%s/%s", strcmp( canonDir, "/" ) == 0 ? "" : canonDir, pEntry->d_name );
+      if( stat( path, &st ) != 0 || !S_ISREG(st.st_mode) )
+      {
+         free( path );
+         continue;
+      }
+
+      if( pList->nItems == pList->nItemsSz )
+      {
+         pNew = (PCXCITEM) realloc( pList->pItems, sizeof(CXCITEM) * (pList->nItemsSz + CXC_LISTGROW) );
+         if( pNew == NULL )
+         {
+            free( path );
+            break;
+         }
+         pList->pItems = pNew;
+         pList->nItemsSz += CXC_LISTGROW;
+      }
+      pNew = &(pList->pItems[pList->nItems]);
+      memset( pNew, 0, sizeof(CXCITEM) );
+      pNew->path = path;
+      pNew->tModified = ((int64_t) st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+      pNew->nBytes = (int64_t) st.st_size;
+      ++pList->nItems;
+   }
+   closedir( pDir );
+   free( canonDir );
+
+   if( pEntry != NULL )
+   {
+      snprintf( errMsg, errSz, "Out of memory listing directory %s", dir );
+      return( FALSE );
+   }
+   return( TRUE );
+}
+
+
+//=== cxcCompareItems =================================================================================================
+//
+//    qsort() comparator: orders the file list by pathname.
+//
+int cxcCompareItems( const void* p1, const void* p2 )
+{
+   return( strcmp( ((const CXCITEM*) p1)->path, ((const CXCITEM*) p2)->path ) );
+}
+
+
+//=== cxcFindOldEntry =================================================================================================
+//
+//    Find a file's entry in the previous catalog.
+//
+//    ARGS:       pOld        -- [in] the previous catalog.
+//                piOldSlots  -- [in] hash table of its entries, keyed by pathname (see cxcUpdate()).
+//                nOldSlots   -- [in] # of hash table slots, a power of 2.
+//                path        -- [in] the file's pathname.
+//
+//    RETURNS:    Index of the file's entry in the previous catalog, or -1 if it is not there.
+//
+int cxcFindOldEntry( PCXCATALOG pOld, const int* piOldSlots, int nOldSlots, const char* path )
+{
+   DWORD h = cxcHash( path ) & (nOldSlots - 1);
+   while( piOldSlots[h] >= 0 )
+   {
+      if( strcmp( cxcGetString( pOld, pOld->pEntries[piOldSlots[h]].iPath ), path ) == 0 ) return( piOldSlots[h] );
+      h = (h + 1) & (nOldSlots - 1);
+   }
+   return( -1 );
+}
+
+
+//=== cxcScanFile =====================================================================================================
+//
+//    Open a data file and extract the information cataloged about it: header fields, tagged sections and target
+//    summaries. Header fields are converted to host byte order.
+//
+//    All versions of the target record format (CXFILETGT and its deprecated _V7, _V12, _V22 and _V24 variants) share
+//    the layout of the leading CXTARGET fields -- wType, name, and the parameter union, whose first member is the
+//    target type in both XYPARMS and RMVTGTDEF (and the old FBPARMS) -- and differ only in the size of each record, so
+//    the summaries are extracted with the version-appropriate stride.
+//
+//    ARGS:       pItem -- [in/out] the file to be scanned. On return, the item's entry, names, sections and targets
+//                         are filled in; entry.status is CXC_UNREADABLE if the file is not a readable data file.
+//
+VOID cxcScanFile( PCXCITEM pItem )
+{
+   CXDFILE file;
+   CXFILEHDR* pHdr;
+   CXFILEREC* pRec;
+   CXCENTRY* pEntry;
+   const BYTE* pTgt;
+   BOOL bSwap;
+   int i, k, nRecs, nPerRec, szTgt, iSubType;
+   WORD wType;
+
+   pEntry = &(pItem->entry);
+   memset( pEntry, 0, sizeof(CXCENTRY) );
+   pEntry->tModified = pItem->tModified;
+   pEntry->nBytes = pItem->nBytes;
+   pItem->nSects = 0;
+   pItem->nTgts = 0;
+
+   if( !cxdOpen( &file, pItem->path ) )
+   {
+      pEntry->status = CXC_UNREADABLE;
+      return;
+   }
+   pEntry->nRecords = file.nRecords;
+   pHdr = cxdGetHeader( &file );
+   if( pHdr == NULL )
+   {
+      pEntry->status = CXC_HEADERLESS;
+      cxdClose( &file );
+      return;
+   }
+
+   bSwap = cxdIsBigEndianHost();                                        // header fields
+   pEntry->version = bSwap ? cxdSwapInt( pHdr->version ) : pHdr->version;
+   pEntry->flags = (DWORD) (bSwap ? cxdSwapInt( (int) pHdr->flags ) : (int) pHdr->flags);
+   pEntry->dwTrialFlags = (DWORD) (bSwap ? cxdSwapInt( (int) pHdr->dwTrialFlags ) : (int) pHdr->dwTrialFlags);
+   pEntry->iSTSelected = bSwap ? cxdSwapInt( pHdr->iSTSelected ) : pHdr->iSTSelected;
+   pEntry->timestampMS = bSwap ? cxdSwapInt( pHdr->timestampMS ) : pHdr->timestampMS;
+   pEntry->nScansSaved = bSwap ? cxdSwapInt( pHdr->nScansSaved ) : pHdr->nScansSaved;
+   pEntry->nScanIntvUS = bSwap ? cxdSwapInt( pHdr->nScanIntvUS ) : pHdr->nScanIntvUS;
+   pEntry->nchans = bSwap ? cxdSwapShort( pHdr->nchans ) : pHdr->nchans;
+   if( pEntry->version >= 1 )
+   {
+      i = bSwap ? cxdSwapInt( pHdr->yearRecorded ) : pHdr->yearRecorded;
+      if( i > 0 )
+         pEntry->date = i * 10000 + (bSwap ? cxdSwapInt( pHdr->monthRecorded ) : pHdr->monthRecorded) * 100 +
+               (bSwap ? cxdSwapInt( pHdr->dayRecorded ) : pHdr->dayRecorded);
+   }
+
+   memcpy( pItem->name, pHdr->name, CXH_NAME_SZ );                      // names; set and subset as of V=21
+   pItem->name[CXH_NAME_SZ-1] = '\0';
+   pItem->set[0] = pItem->subset[0] = '\0';
+   if( pEntry->version >= 21 )
+   {
+      memcpy( pItem->set, pHdr->setName, CXH_NAME_SZ );
+      pItem->set[CXH_NAME_SZ-1] = '\0';
+      memcpy( pItem->subset, pHdr->subsetName, CXH_NAME_SZ );
+      pItem->subset[CXH_NAME_SZ-1] = '\0';
+   }
+
+   if( cxdGetNumRecordsOfKind( &file, CXD_TAGSECT ) > 0 )                // tagged sections: at most one record
+   {
+      pRec = cxdGetRecordOfKind( &file, CXD_TAGSECT, 0 );
+      for( i = 0; i < (int) CX_RECORDSECTS; i++ )
+      {
+         if( pRec->u.sects[i].tag[0] == '\0' ) break;
+         memcpy( pItem->sects[i].tag, pRec->u.sects[i].tag, SECTIONTAGSZ );
+         pItem->sects[i].tag[SECTIONTAGSZ-1] = '\0';
+         pItem->sects[i].iFirstSeg = (short) pRec->u.sects[i].cFirstSeg;
+         pItem->sects[i].iLastSeg = (short) pRec->u.sects[i].cLastSeg;
+         ++pItem->nSects;
+      }
+   }
+
+   if( pEntry->version >= 25 )                                          // target summaries
+   {
+      nPerRec = (int) CX_RECORDTARGETS;
+      szTgt = (int) sizeof(CXFILETGT);
+   }
+   else if( pEntry->version >= 23 )
+   {
+      nPerRec = (int) CX_RECORDTARGETS_V24;
+      szTgt = (int) sizeof(CXFILETGT_V24);
+   }
+   else if( pEntry->version >= 13 )
+   {
+      nPerRec = (int) CX_RECORDTARGETS_V22;
+      szTgt = (int) sizeof(CXFILETGT_V22);
+   }
+   else if( pEntry->version >= 8 )
+   {
+      nPerRec = (int) CX_RECORDTARGETS_V12;
+      szTgt = (int) sizeof(CXFILETGT_V12);
+   }
+   else
+   {
+      nPerRec = (int) CX_RECORDTARGETS_V7;
+      szTgt = (int) sizeof(CXFILETGT_V7);
+   }
+
+   nRecs = cxdGetNumRecordsOfKind( &file, CXD_TARGET );
+   if( nRecs > 0 ) pItem->pTgts = (CXCSCANTGT*) malloc( sizeof(CXCSCANTGT) * nRecs * nPerRec );
+   if( pItem->pTgts != NULL ) for( k = 0; k < nRecs; k++ )
+   {
+      pRec = cxdGetRecordOfKind( &file, CXD_TARGET, k );
+      for( i = 0; i < nPerRec; i++ )
+      {
+         pTgt = pRec->u.byteData + i * szTgt;
+         memcpy( &wType, pTgt + offsetof(CXTARGET, wType), sizeof(WORD) );
+         if( bSwap ) wType = (WORD) cxdSwapShort( (short) wType );
+         if( wType == 0 ) break;                                        // unused slots in last record are zeroed
+
+         memcpy( &iSubType, pTgt + offsetof(CXTARGET, u), sizeof(int) );
+         if( bSwap ) iSubType = cxdSwapInt( iSubType );
+         pItem->pTgts[pItem->nTgts].wType = wType;
+         pItem->pTgts[pItem->nTgts].wSubType = (WORD) ((wType == CX_XYTARG || wType == CX_RMVTARG) ? iSubType : 0);
+         memcpy( pItem->pTgts[pItem->nTgts].name, pTgt + offsetof(CXTARGET, name), CX_MAXOBJNAMELEN );
+         pItem->pTgts[pItem->nTgts].name[CX_MAXOBJNAMELEN-1] = '\0';
+         ++pItem->nTgts;
+      }
+   }
+
+   pEntry->status = CXC_OK;
+   cxdClose( &file );
+}
+
+
+//=== cxcScanThread ===================================================================================================
+//
+//    Worker thread: repeatedly claims the next file in the list that must be scanned, and scans it, until none remain.
+//
+//    ARGS:       pArg -- [in] the file list (PCXCITEMLIST).
+//
+//    RETURNS:    NULL.
+//
+void* cxcScanThread( void* pArg )
+{
+   PCXCITEMLIST pList = (PCXCITEMLIST) pArg;
+   int i;
+
+   while( (i = __sync_fetch_and_add( &(pList->iNext), 1 )) < pList->nItems )
+      if( pList->pItems[i].iOld < 0 ) cxcScanFile( &(pList->pItems[i]) );
+   return( NULL );
+}
+
+
+//=== cxcWriteCatalog =================================================================================================
+//
+//    Assemble the catalog from the file list -- scanned entries from the scan results, unchanged entries copied from
+//    the previous catalog -- and write it to a temporary file, which then replaces the catalog file.
+//
+//    ARGS:       catPath  -- [in] pathname of the catalog file.
+//                pList    -- [in] the file list, sorted and scanned.
+//                pOld     -- [in] the previous catalog (closed if there is none).
+//                errMsg   -- [out] on failure, a description of the error.
+//                errSz    -- [in] size of the error message buffer.
+//
+//    RETURNS:    TRUE if successful, FALSE otherwise.
+//
+BOOL cxcWriteCatalog( const char* catPath, PCXCITEMLIST pList, PCXCATALOG pOld, char* errMsg, int errSz )
+{
+   CXCHEADER hdr;
+   CXCSTRTABLE strs;
+   CXCENTRY* pEntries;
+   CXCSECT* pSects;
+   CXCTGT* pTgts;
+   PCXCITEM pItem;
+   const CXCENTRY* pOldEntry;
+   int i, k, nSects, nTgts;
+   char* tmpPath;
+   FILE* fp;
+   BOOL bOk;
+
+   memset( &strs, 0, sizeof(CXCSTRTABLE) );
+   nSects = nTgts = 0;                                                  // size the tables
+   for( i = 0; i < pList->nItems; i++ )
+   {
+      pItem = &(pList->pItems[i]);
+      pOldEntry = (pItem->iOld >= 0) ? &(pOld->pEntries[pItem->iOld]) : NULL;
+      nSects += (pOldEntry != NULL) ? pOldEntry->nSects : pItem->nSects;
+      nTgts += (pOldEntry != NULL) ? pOldEntry->nTgts : pItem->nTgts;
+   }
+
+   pEntries = (CXCENTRY*) malloc( sizeof(CXCENTRY) * (pList->nItems + 1) );
+   pSects = (CXCSECT*) malloc( sizeof(CXCSECT) * (nSects + 1) );
+   pTgts = (CXCTGT*) malloc( sizeof(CXCTGT) * (nTgts + 1) );
+   tmpPath = (char*) malloc( strlen( catPath ) + 8 );
+   bOk = (pEntries != NULL && pSects != NULL && pTgts != NULL && tmpPath != NULL && cxcInitStrTable( &strs ));
+   if( !bOk ) snprintf( errMsg, errSz, "Out of memory" );
+
+   nSects = nTgts = 0;                                                  // fill them in, interning all strings
+   for( i = 0; bOk && i < pList->nItems; i++ )
+   {
+      pItem = &(pList->pItems[i]);
+      if( pItem->iOld >= 0 )
+      {
+         pOldEntry = &(pOld->pEntries[pItem->iOld]);
+         pEntries[i] = *pOldEntry;
+         pEntries[i].iName = cxcIntern( &strs, cxcGetString( pOld, pOldEntry->iName ) );
+         pEntries[i].iSet = cxcIntern( &strs, cxcGetString( pOld, pOldEntry->iSet ) );
+         pEntries[i].iSubset = cxcIntern( &strs, cxcGetString( pOld, pOldEntry->iSubset ) );
+         for( k = 0; k < pOldEntry->nSects; k++ )
+         {
+            pSects[nSects + k] = pOld->pSects[pOldEntry->iFirstSect + k];
+            pSects[nSects + k].iTag = cxcIntern( &strs, cxcGetString( pOld, pSects[nSects + k].iTag ) );
+            if( pSects[nSects + k].iTag < 0 ) bOk = FALSE;
+         }
+         for( k = 0; k < pOldEntry->nTgts; k++ )
+         {
+            pTgts[nTgts + k] = pOld->pTgts[pOldEntry->iFirstTgt + k];
+            pTgts[nTgts + k].iName = cxcIntern( &strs, cxcGetString( pOld, pTgts[nTgts + k].iName ) );
+            if( pTgts[nTgts + k].iName < 0 ) bOk = FALSE;
+         }
+      }
+      else
+      {
+         pEntries[i] = pItem->entry;
+         pEntries[i].iName = cxcIntern( &strs, pItem->name );
+         pEntries[i].iSet = cxcIntern( &strs, pItem->set );
+         pEntries[i].iSubset = cxcIntern( &strs, pItem->subset );
+         pEntries[i].nSects = pItem->nSects;
+         pEntries[i].nTgts = pItem->nTgts;
+         for( k = 0; k < pItem->nSects; k++ )
+         {
+            pSects[nSects + k].iTag = cxcIntern( &strs, pItem->sects[k].tag );
+            pSects[nSects + k].iFirstSeg = pItem->sects[k].iFirstSeg;
+            pSects[nSects + k].iLastSeg = pItem->sects[k].iLastSeg;
+            if( pSects[nSects + k].iTag < 0 ) bOk = FALSE;
+         }
+         for( k = 0; k < pItem->nTgts; k++ )
+         {
+            pTgts[nTgts + k].iName = cxcIntern( &strs, pItem->pTgts[k].name );
+            pTgts[nTgts + k].wType = pItem->pTgts[k].wType;
+            pTgts[nTgts + k].wSubType = pItem->pTgts[k].wSubType;
+            if( pTgts[nTgts + k].iName < 0 ) bOk = FALSE;
+         }
+      }
+      pEntries[i].iPath = cxcIntern( &strs, pItem->path );
+      pEntries[i].iFirstSect = nSects;
+      pEntries[i].iFirstTgt = nTgts;
+      nSects += pEntries[i].nSects;
+      nTgts += pEntries[i].nTgts;
+      if( pEntries[i].iPath < 0 || pEntries[i].iName < 0 || pEntries[i].iSet < 0 || pEntries[i].iSubset < 0 )
+         bOk = FALSE;
+      if( !bOk ) snprintf( errMsg, errSz, "Out of memory" );
+   }
+
+   if( bOk )                                                            // write header and tables to temp file
+   {
+      memset( &hdr, 0, sizeof(CXCHEADER) );
+      hdr.magic = CXC_MAGIC;
+      hdr.version = CXC_VERSION;
+      hdr.nEntries = pList->nItems;
+      hdr.nSects = nSects;
+      hdr.nTgts = nTgts;
+      hdr.nStrBytes = strs.nBytes;
+      hdr.offEntries = (int) sizeof(CXCHEADER);
+      hdr.offSects = hdr.offEntries + (int) sizeof(CXCENTRY) * hdr.nEntries;
+      hdr.offTgts = hdr.offSects + (int) sizeof(CXCSECT) * hdr.nSects;
+      hdr.offStrings = hdr.offTgts + (int) sizeof(CXCTGT) * hdr.nTgts;
+
+      sprintf( tmpPath, "%s.tmp", catPath );
+      if( (fp = fopen( tmpPath, "wb" )) == NULL )
+      {
+         snprintf( errMsg, errSz, "Could not create %s", tmpPath );
+         bOk = FALSE;
+      }
+      else
+      {
+         bOk = (fwrite( &hdr, sizeof(CXCHEADER), 1, fp ) == 1) &&
+               (fwrite( pEntries, sizeof(CXCENTRY), hdr.nEntries, fp ) == (size_t) hdr.nEntries) &&
+               (fwrite( pSects, sizeof(CXCSECT), hdr.nSects, fp ) == (size_t) hdr.nSects) &&
+               (fwrite( pTgts, sizeof(CXCTGT), hdr.nTgts, fp ) == (size_t) hdr.nTgts) &&
+               (fwrite( strs.pBuf, 1, strs.nBytes, fp ) == (size_t) strs.nBytes);
+         if( fclose( fp ) != 0 ) bOk = FALSE;
+         if( bOk && rename( tmpPath, catPath ) != 0 )
+         {
+            snprintf( errMsg, errSz, "Could not replace %s", catPath );
+            bOk = FALSE;
+         }
+         else if( !bOk )
+            snprintf( errMsg, errSz, "Error writing %s", tmpPath );
+         if( !bOk ) remove( tmpPath );
+      }
+   }
+
+   if( pEntries != NULL ) free( pEntries );
+   if( pSects != NULL ) free( pSects );
+   if( pTgts != NULL ) free( pTgts );
+   if( tmpPath != NULL ) free( tmpPath );
+   cxcFreeStrTable( &strs );
+   return( bOk );
+}
+
+
+//=== cxcHash =========================================================================================================
+//
+//    RETURNS:    The 32-bit FNV-1a hash of a null-terminated string.
+//
+DWORD cxcHash( const char* s )
+{
+   DWORD h = 2166136261u;
+   while( *s != '\0' )
+   {
+      h ^= (BYTE) *s++;
+      h *= 16777619u;
+   }
+   return( h );
+}
+
+
+//=== cxcInitStrTable, cxcFreeStrTable ================================================================================
+//
+//    Initialize an empty string table -- containing only the empty string, at offset CXC_NOSTR -- or release one.
+//    cxcFreeStrTable() may be called on a table whose initialization failed, or that was zeroed.
+//
+//    ARGS:       pTable   -- [in/out] the string table.
+//
+//    RETURNS:    [cxcInitStrTable] TRUE if successful, FALSE if memory allocation failed.
+//
+BOOL cxcInitStrTable( PCXCSTRTABLE pTable )
+{
+   int i;
+
+   memset( pTable, 0, sizeof(CXCSTRTABLE) );
+   pTable->nBytesSz = 64 * 1024;
+   pTable->nSlots = 4096;
+   pTable->pBuf = (char*) malloc( pTable->nBytesSz );
+   pTable->piSlots = (int*) malloc( sizeof(int) * pTable->nSlots );
+   if( pTable->pBuf == NULL || pTable->piSlots == NULL ) return( FALSE );
+
+   for( i = 0; i < pTable->nSlots; i++ ) pTable->piSlots[i] = -1;
+   pTable->pBuf[CXC_NOSTR] = '\0';
+   pTable->nBytes = 1;
+   return( TRUE );
+}
+
+VOID cxcFreeStrTable( PCXCSTRTABLE pTable )
+{
+   if( pTable->pBuf != NULL ) free( pTable->pBuf );
+   if( pTable->piSlots != NULL ) free( pTable->piSlots );
+   memset( pTable, 0, sizeof(CXCSTRTABLE) );
+}
+
+
+//=== cxcIntern =======================================================================================================
+//
+//    Add a string to a string table, unless it is already there. The hash table is kept at most half full.
+//
+//    ARGS:       pTable   -- [in/out] the string table.
+//                s        -- [in] the string.
+//
+//    RETURNS:    The string's offset in the table; -1 if memory allocation failed.
+//
+int cxcIntern( PCXCSTRTABLE pTable, const char* s )
+{
+   DWORD h;
+   int i, len, nSlots;
+   int* piSlots;
+   char* pBuf;
+
+   if( *s == '\0' ) return( CXC_NOSTR );
+
+   h = cxcHash( s ) & (pTable->nSlots - 1);
+   while( pTable->piSlots[h] >= 0 )
+   {
+      if( strcmp( pTable->pBuf + pTable->piSlots[h], s ) == 0 ) return( pTable->piSlots[h] );
+      h = (h + 1) & (pTable->nSlots - 1);
+   }
+
+   len = (int) strlen( s ) + 1;
+   if( pTable->nBytes + len > pTable->nBytesSz )
+   {
+      i = pTable->nBytesSz * 2;
+      while( pTable->nBytes + len > i ) i *= 2;
+      if( (pBuf = (char*) realloc( pTable->pBuf, i )) == NULL ) return( -1 );
+      pTable->pBuf = pBuf;
+      pTable->nBytesSz = i;
+   }
+   memcpy( pTable->pBuf + pTable->nBytes, s, len );
+   pTable->piSlots[h] = pTable->nBytes;
+   pTable->nBytes += len;
+   ++pTable->nStrings;
+
+   if( 2 * pTable->nStrings > pTable->nSlots )                          // grow and rehash the hash table
+   {
+      nSlots = pTable->nSlots * 2;
+      if( (piSlots = (int*) malloc( sizeof(int) * nSlots )) == NULL ) return( -1 );
+      for( i = 0; i < nSlots; i++ ) piSlots[i] = -1;
+      for( i = 0; i < pTable->nSlots; i++ ) if( pTable->piSlots[i] >= 0 )
+      {
+         h = cxcHash( pTable->pBuf + pTable->piSlots[i] ) & (nSlots - 1);
+         while( piSlots[h] >= 0 ) h = (h + 1) & (nSlots - 1);
+         piSlots[h] = pTable->piSlots[i];
+      }
+      free( pTable->piSlots );
+      pTable->piSlots = piSlots;
+      pTable->nSlots = nSlots;
+   }
+   return( pTable->nBytes - len );
+}
+
+
+//=== cxcFindString ===================================================================================================
+//
+//    Resolve a query name criterion to its offset in an open catalog's string table. Since the strings are interned,
+//    an exact criterion is matched by comparing offsets.
+//
+//    ARGS:       pCat  -- [in] an open catalog.
+//                s     -- [in] the name criterion. May be NULL.
+//
+//    RETURNS:    The string's offset; -1 if it does not appear in the catalog; -2 if the criterion is not specified
+//                (NULL) or is a prefix ("name*"), which must be matched by string comparison.
+//
+int cxcFindString( PCXCATALOG pCat, const char* s )
+{
+   int i, len;
+
+   if( s == NULL ) return( -2 );
+   len = (int) strlen( s );
+   if( len > 0 && s[len-1] == '*' ) return( -2 );
+   if( len == 0 ) return( CXC_NOSTR );
+
+   for( i = 1; i < pCat->pHdr->nStrBytes; i += (int) strlen( pCat->pStrings + i ) + 1 )
+      if( strcmp( pCat->pStrings + i, s ) == 0 ) return( i );
+   return( -1 );
+}
+
+
+//=== cxcNameMatches ==================================================================================================
+//
+//    Does a name in the catalog satisfy a query name criterion?
+//
+//    ARGS:       pCat        -- [in] an open catalog.
+//                iStr        -- [in] the name (string table offset).
+//                pattern     -- [in] the name criterion. NULL matches any name.
+//                iPatternStr -- [in] the criterion's string table offset, from cxcFindString().
+//
+//    RETURNS:    TRUE if the name satisfies the criterion.
+//
+BOOL cxcNameMatches( PCXCATALOG pCat, int iStr, const char* pattern, int iPatternStr )
+{
+   if( pattern == NULL ) return( TRUE );
+   if( iPatternStr >= 0 ) return( iStr == iPatternStr );
+   return( strncmp( cxcGetString( pCat, iStr ), pattern, strlen( pattern ) - 1 ) == 0 );
+}
@@ -0,0 +1,150 @@
+//=====================================================================================================================
+//
+// cxdatacat.h : Constants, types and function declarations for CXDATACAT.C, a catalog index over the Maestro/Cntrlx
+//               data files of one or more recording sessions.
+//
+// ****** FOR DESCRIPTION, REVISION HISTORY, ETC, SEE IMPLEMENTATION FILE ******
+//
+//=====================================================================================================================
+
+#if !defined(CXDATACAT_H__INCLUDED_)
+#define CXDATACAT_H__INCLUDED_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "wintypes.h"                                    // some typical Windows typedefs that we need
+#include "cxfilefmt_mex.h"                               // Maestro/Cntrlx data file fmt (file modified for MEX build)
+
+
+#define CXC_MAGIC                0x54414358              // catalog file signature ("XCAT" on a little-endian host)
+#define CXC_VERSION              1                       // catalog file format version
+
+#define CXC_OK                   0                       // CXCENTRY.status: data file cataloged
+#define CXC_UNREADABLE           1                       //    file could not be opened, or is not a data file
+#define CXC_HEADERLESS           2                       //    headerless (pre-Dec2001) ContMode file; no info
+
+#define CXC_NOSTR                0                       // string table offset of the empty string
+
+
+//=====================================================================================================================
+// CATALOG FILE LAYOUT. A catalog file is the CXCHEADER, followed by the entry, tagged section and target tables and
+// the string table, each starting at the byte offset given in the header. The tables are arrays of fixed-size
+// structures; all strings -- file paths, trial/set/subset names, section tags, target names -- are stored once in
+// the string table and referenced by byte offset. Since equal strings share an offset, a query for a name compares
+// integers. The file is written in host byte order; a catalog written on a host of the other endianness fails the
+// signature check and is simply rebuilt.
+//=====================================================================================================================
+typedef struct tagCxcHeader
+{
+   DWORD magic;                                          // CXC_MAGIC
+   DWORD version;                                        // CXC_VERSION
+   int nEntries;                                         // # of data files cataloged
+   int nSects;                                           // total # of tagged sections, over all entries
+   int nTgts;                                            // total # of target definitions, over all entries
+   int nStrBytes;                                        // size of the string table in bytes
+   int offEntries;                                       // byte offsets of the tables from start of file
+   int offSects;
+   int offTgts;
+   int offStrings;
+   int reserved[6];                                      // always 0
+} CXCHEADER, *PCXCHEADER;
+
+typedef struct tagCxcEntry                               // one data file:
+{
+   int iPath;                                            //    file pathname (string table offset)
+   int status;                                           //    CXC_OK, CXC_UNREADABLE, CXC_HEADERLESS
+   int64_t tModified;                                    //    file modification time (ns since the epoch) and size
+   int64_t nBytes;                                       //    when cataloged -- to detect stale entries
+   int iName;                                            //    CXFILEHDR.name, setName, subsetName (string offsets)
+   int iSet;
+   int iSubset;
+   int version;                                          //    CXFILEHDR.version
+   DWORD flags;                                          //    CXFILEHDR.flags (CXHF_* bits): mode and trial result
+   DWORD dwTrialFlags;                                   //    CXFILEHDR.dwTrialFlags
+   int iSTSelected;                                      //    CXFILEHDR.iSTSelected
+   int date;                                             //    date recorded as YYYYMMDD; 0 if unknown
+   int timestampMS;                                      //    CXFILEHDR.timestampMS
+   int nScansSaved;                                      //    CXFILEHDR.nScansSaved, nScanIntvUS
+   int nScanIntvUS;
+   int nchans;                                           //    CXFILEHDR.nchans
+   int nRecords;                                         //    # of records in file
+   int iFirstSect;                                       //    the entry's tagged sections: CXCSECT[iFirstSect..+nSects)
+   int nSects;
+   int iFirstTgt;                                        //    the entry's targets: CXCTGT[iFirstTgt..+nTgts)
+   int nTgts;
+} CXCENTRY, *PCXCENTRY;
+
+typedef struct tagCxcSect                                // a tagged section:
+{
+   int iTag;                                             //    section tag (string offset)
+   short iFirstSeg;                                      //    first and last segment in section
+   short iLastSeg;
+} CXCSECT, *PCXCSECT;
+
+typedef struct tagCxcTgt                                 // a target definition, in summary:
+{
+   int iName;                                            //    target name (string offset)
+   WORD wType;                                           //    target category: CX_CHAIR ... CX_RMVTARG
+   WORD wSubType;                                        //    [CX_XYTARG, CX_RMVTARG] target type; else 0
+} CXCTGT, *PCXCTGT;
+
+
+//=====================================================================================================================
+// CXCATALOG: An open catalog file. The file is mapped read-only into memory; the table pointers point into it.
+//=====================================================================================================================
+typedef struct tagCxCatalog
+{
+   BYTE* pBase;                                          // start of the catalog's content in memory
+   size_t nBytes;                                        // catalog file size in bytes
+   BOOL bMapped;                                         // TRUE if mapped via mmap(); else content is malloc'd
+   const CXCHEADER* pHdr;
+   const CXCENTRY* pEntries;
+   const CXCSECT* pSects;
+   const CXCTGT* pTgts;
+   const char* pStrings;
+   char errMsg[256];                                     // description of the last error, if any
+} CXCATALOG, *PCXCATALOG;
+
+//=====================================================================================================================
+// CXCQUERY: Catalog query criteria. An entry matches if it satisfies every criterion specified. A name criterion
+// matches exactly, unless it ends in '*', in which case it matches any name with that prefix. Only entries with status
+// CXC_OK ever match.
+//=====================================================================================================================
+typedef struct tagCxcQuery
+{
+   const char* trial;                                    // trial name; NULL = any
+   const char* set;                                      // trial set name; NULL = any
+   const char* subset;                                   // trial subset name; NULL = any
+   const char* section;                                  // entry has a tagged section by this name; NULL = any
+   const char* target;                                   // entry has a target by this name; NULL = any
+   DWORD dwFlagsOn;                                      // CXHF_* header flags that must be set
+   DWORD dwFlagsOff;                                     // CXHF_* header flags that must be clear
+   int minVersion;                                       // minimum data file version; 0 = any
+   int dateFrom;                                         // recorded in [dateFrom..dateTo] (YYYYMMDD); 0 = no bound
+   int dateTo;
+} CXCQUERY, *PCXCQUERY;
+
+typedef struct tagCxcUpdateStats                         // what a catalog update did:
+{
+   int nFiles;                                           //    # of files now in the catalog
+   int nScanned;                                         //    # of files new or modified since last update, rescanned
+   int nReused;                                          //    # of files unchanged, whose entries were reused
+   int nDropped;                                         //    # of previously cataloged files no longer found
+   int nUnreadable;                                      //    # of files that are not readable data files
+} CXCUPDATESTATS, *PCXCUPDATESTATS;
+
+
+//=====================================================================================================================
+// FUNCTIONS
+//=====================================================================================================================
+BOOL cxcUpdate( const char* catPath, const char** dirs, int nDirs, int nThreads, PCXCUPDATESTATS pStats,
+                char* errMsg, int errSz );
+
+BOOL cxcOpen( PCXCATALOG pCat, const char* path );
+VOID cxcClose( PCXCATALOG pCat );
+const char* cxcGetString( PCXCATALOG pCat, int iStr );
+VOID cxcInitQuery( PCXCQUERY pQuery );
+int cxcQuery( PCXCATALOG pCat, const CXCQUERY* pQuery, int* piMatches, int nMax );
+
+#endif   // !defined(CXDATACAT_H__INCLUDED_)
@@ -0,0 +1,870 @@
+//=====================================================================================================================
+//
+// cxdatalib.c : A standalone, MATLAB-independent reader for Maestro/Cntrlx data files.
+//
+// AUTHOR:  saruffner
+//
+// DESCRIPTION:
+// The MEX function readcxdata() originally did all of its own file I/O, fread()'ing one CXFILEREC at a time into
+// realloc()-grown buffers. That ties data file parsing to MATLAB and to one file per call, which is a problem when an
+// entire session of several thousand trial files must be re-analyzed. This module factors out the file-level parsing
+// into a small portable C library that has no dependence on MATLAB:
+//
+//    1) cxdOpen() maps an entire data file into memory, validates its size, detects a headerless ContMode file, and
+// indexes the file's records by kind (CXD_AI, CXD_EVENT0, ...) in a single pass over the record tags. The index is
+// the only memory allocated. cxdClose() releases the file.
+//    2) cxdGetHeader(), cxdGetRecord() and cxdGetRecordOfKind() return zero-copy views into the mapped file: the
+// CXFILEHDR, or a CXFILEREC whose union member -- byteData, iData, tc, tgts*, sects -- is the typed view of the record
+// payload. cxdGetNumRecordsOfKind() gives the exact number of records of each kind, so callers can size their buffers
+// up front rather than grow them record by record.
+//    3) A few decoders that need nothing but the file itself: cxdGatherBytes() concatenates the compressed AI or
+// spike waveform stream, cxdDecodeAI16() decompresses it (cxdDecodeAIScans16() decompresses just a range of scans),
+// cxdDecodeEventTimes() converts the DI<0> or DI<1> interevent intervals to event times, and cxdCountTrialCodes()
+// finds the length of the trial code sequence. cxdSortSpikeEdits() and cxdMergeSpikeEdits() replay the sorted-spike
+// train edits recorded by JMWork in bulk.
+//
+// All interpretation that produces MATLAB output -- trial code processing, target definitions, edit actions and so
+// on -- remains in readcxdata.c, which uses this module for all of its file access.
+//
+// Every function is reentrant: all state is in the CXDFILE structure, so different threads may work on different
+// files at the same time. The batch reader cxdatabatch.c relies on this.
+//
+// Memory mapping uses the POSIX mmap(). On platforms without it (Windows), the file is instead read into memory in a
+// single fread(); the API is the same. Either way the content is a private copy-on-write image, so records may be
+// modified in place (eg, for endian conversion) without affecting the file.
+//
+// REVISION HISTORY:
+// 16oct2026-- Created. File-level parsing factored out of readcxdata.c.
+//          -- Added cxdDecodeAI16(), a faster AI/spike waveform decompressor that emits 16-bit samples rather than
+// doubles -- a 4x reduction in the memory needed to hold a long 25KHz spike waveform. cxdUncompressAI() is retained as
+// the reference implementation; editcxdata.c, which had its own copy, now uses this module too.
+//          -- Added cxdDecodeAIScans16() to decode a range of scans, for readcxdata()'s selective decode options.
+//          -- Added cxdSortSpikeEdits() and cxdMergeSpikeEdits(), which replace readcxdata()'s one-edit-at-a-time
+// replay of sorted-spike train edits with a single sort and one linear merge per channel.
+//=====================================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if !defined(_WIN32)
+   #include <fcntl.h>
+   #include <unistd.h>
+   #include <sys/mman.h>
+   #include <sys/stat.h>
+   #define CXD_HAVE_MMAP
+#endif
+
+#include "cxdatalib.h"
+
+
+//=====================================================================================================================
+// MODULE-PRIVATE FUNCTION PROTOTYPES
+//=====================================================================================================================
+BOOL cxdLoadContent( PCXDFILE pFile, const char* path );
+BOOL cxdBuildIndex( PCXDFILE pFile );
+int cxdCompareSpikeEdits( const void* p1, const void* p2 );
+
+
+//=== cxdIsBigEndianHost ==============================================================================================
+//
+//    Is the host machine big-endian? All Maestro/Cntrlx data files were written on little-endian machines.
+//
+//    RETURNS:    TRUE if host is big-endian, FALSE otherwise.
+//
+BOOL cxdIsBigEndianHost()
+{
+   int i = 1;
+   return( (((BYTE*) &i)[0] == 1) ? FALSE : TRUE );
+}
+
+
+//=== cxdOpen =========================================================================================================
+//
+//    Open a Maestro/Cntrlx data file: load its entire content into memory (see file header) and index its records by
+//    kind. The file must contain an integral number of CXD_RECORDSZ-byte records. A headerless ContMode file -- one
+//    whose first record is a data record rather than a CXFILEHDR -- is detected and flagged.
+//
+//    ARGS:       pFile -- [out] the file object. Need not be initialized. On failure, it is left in the closed state
+//                         and pFile->errMsg describes the error.
+//                path  -- [in] the file's pathname.
+//
+//    RETURNS:    TRUE if successful, FALSE otherwise.
+//
+BOOL cxdOpen( PCXDFILE pFile, const char* path )
+{
+   CXFILEREC* pRec;
+   BYTE recID;
+
+   memset( (VOID*) pFile, 0, sizeof(CXDFILE) );
+
+   if( sizeof(CXFILEHDR) != CXD_RECORDSZ || sizeof(CXFILEREC) != CXD_RECORDSZ )
+   {
+      sprintf( pFile->errMsg, "Bad record size: hdr = %d, generic rec = %d", (int) sizeof(CXFILEHDR),
+               (int) sizeof(CXFILEREC) );
+      return( FALSE );
+   }
+
+   if( !cxdLoadContent( pFile, path ) ) return( FALSE );
+
+   if( pFile->nBytes == 0 || (pFile->nBytes % CXD_RECORDSZ) != 0 )     // there should always be an integral # of
+   {                                                                    // data records in a data file!
+      sprintf( pFile->errMsg, "File does not have an integral # of %d-byte records; filesize = %lu", CXD_RECORDSZ,
+               (unsigned long) pFile->nBytes );
+      cxdClose( pFile );
+      return( FALSE );
+   }
+   pFile->nRecords = (int) (pFile->nBytes / CXD_RECORDSZ);
+
+   pRec = (CXFILEREC*) pFile->pBase;                                    // same test as the original readcxdata():
+   recID = pRec->idTag[0];                                              // a headerless ContMode file starts with a
+   pFile->bHeaderless = (pRec->idTag[1] == 0) &&                        // data record
+         (recID <= CX_XWORKACTIONREC || recID == CX_V1TGTRECORD);
+
+   if( !cxdBuildIndex( pFile ) )
+   {
+      cxdClose( pFile );
+      return( FALSE );
+   }
+   return( TRUE );
+}
+
+
+//=== cxdClose ========================================================================================================
+//
+//    Release all resources associated with an open data file. Any views previously obtained from it become invalid.
+//    No effect if the file is already closed.
+//
+//    ARGS:       pFile -- [in/out] the file object.
+//
+VOID cxdClose( PCXDFILE pFile )
+{
+   if( pFile->pBase != NULL )
+   {
+#if defined(CXD_HAVE_MMAP)
+      if( pFile->bMapped ) munmap( (void*) pFile->pBase, pFile->nBytes );
+      else free( pFile->pBase );
+#else
+      free( pFile->pBase );
+#endif
+      pFile->pBase = NULL;
+   }
+   if( pFile->piIndex != NULL ) { free( pFile->piIndex ); pFile->piIndex = NULL; }
+
+   pFile->nBytes = 0;
+   pFile->bMapped = FALSE;
+   pFile->nRecords = 0;
+   memset( pFile->iKindStart, 0, sizeof(pFile->iKindStart) );
+}
+
+
+//=== cxdGetRecordKind ================================================================================================
+//
+//    Classify a data file record by its ID tag.
+//
+//    ARGS:       pRec -- [in] the record. Must not be the header record.
+//
+//    RETURNS:    The record kind, CXD_AI .. CXD_UNKNOWN.
+//
+int cxdGetRecordKind( const CXFILEREC* pRec )
+{
+   switch( pRec->idTag[0] )
+   {
+      case CX_AIRECORD :         return( CXD_AI );
+      case CX_EVENT0RECORD :     return( CXD_EVENT0 );
+      case CX_EVENT1RECORD :     return( CXD_EVENT1 );
+      case CX_OTHEREVENTRECORD : return( CXD_OTHEREVENT );
+      case CX_TRIALCODERECORD :  return( CXD_TRIALCODE );
+      case CX_XWORKACTIONREC :   return( CXD_ACTION );
+      case CX_TGTRECORD :        return( CXD_TARGET );
+      case CX_SPIKEWAVERECORD :  return( CXD_SPIKEWAVE );
+      case CX_TAGSECTRECORD :    return( CXD_TAGSECT );
+      default :
+         if( pRec->idTag[0] >= CX_SPIKESORTREC_FIRST && pRec->idTag[0] <= CX_SPIKESORTREC_LAST )
+            return( CXD_SORTSPIKE );
+         return( CXD_UNKNOWN );
+   }
+}
+
+
+//=== cxdGetHeader ====================================================================================================
+//
+//    Get a view of the header record of an open data file. Multi-byte fields are as stored in the file (little-endian).
+//
+//    ARGS:       pFile -- [in] the open file.
+//
+//    RETURNS:    The header record, or NULL if the file is closed or headerless.
+//
+CXFILEHDR* cxdGetHeader( PCXDFILE pFile )
+{
+   if( pFile->pBase == NULL || pFile->bHeaderless ) return( NULL );
+   return( (CXFILEHDR*) pFile->pBase );
+}
+
+
+//=== cxdGetRecord ====================================================================================================
+//
+//    Get a view of the specified record in an open data file.
+//
+//    ARGS:       pFile -- [in] the open file.
+//                iRec  -- [in] the record's position in the file, in [0 .. pFile->nRecords-1]. Record 0 is the header
+//                         record unless the file is headerless.
+//
+//    RETURNS:    The record, or NULL if the record index is invalid.
+//
+CXFILEREC* cxdGetRecord( PCXDFILE pFile, int iRec )
+{
+   if( pFile->pBase == NULL || iRec < 0 || iRec >= pFile->nRecords ) return( NULL );
+   return( (CXFILEREC*) (pFile->pBase + ((size_t) iRec) * CXD_RECORDSZ) );
+}
+
+
+//=== cxdGetNumRecordsOfKind ==========================================================================================
+//
+//    ARGS:       pFile -- [in] the open file.
+//                kind  -- [in] the record kind, CXD_AI .. CXD_UNKNOWN.
+//
+//    RETURNS:    The number of records of the specified kind in the file (0 if kind is invalid).
+//
+int cxdGetNumRecordsOfKind( PCXDFILE pFile, int kind )
+{
+   if( pFile->piIndex == NULL || kind < 0 || kind >= CXD_NUMKINDS ) return( 0 );
+   return( pFile->iKindStart[kind+1] - pFile->iKindStart[kind] );
+}
+
+
+//=== cxdGetRecordOfKind ==============================================================================================
+//
+//    Get a view of the k-th record of the specified kind in an open data file. Records of a given kind are numbered in
+//    the order they appear in the file.
+//
+//    ARGS:       pFile -- [in] the open file.
+//                kind  -- [in] the record kind, CXD_AI .. CXD_UNKNOWN.
+//                k     -- [in] index of the record among those of the specified kind.
+//
+//    RETURNS:    The record, or NULL if kind or k is invalid.
+//
+CXFILEREC* cxdGetRecordOfKind( PCXDFILE pFile, int kind, int k )
+{
+   if( k < 0 || k >= cxdGetNumRecordsOfKind( pFile, kind ) ) return( NULL );
+   return( cxdGetRecord( pFile, pFile->piIndex[pFile->iKindStart[kind] + k] ) );
+}
+
+
+//=== cxdGatherBytes ==================================================================================================
+//
+//    Concatenate the payloads of all records of the specified kind, in file order. Intended for the compressed AI
+//    (CXD_AI) and spike waveform (CXD_SPIKEWAVE) data streams, which span as many records as needed. The stream may
+//    then be decompressed by cxdUncompressAI().
+//
+//    ARGS:       pFile -- [in] the open file.
+//                kind  -- [in] the record kind.
+//                pDst  -- [out] destination buffer. Must hold at least N*CX_RECORDBYTES bytes, where N is the number
+//                         of records of the specified kind.
+//
+//    RETURNS:    The number of bytes copied.
+//
+int cxdGatherBytes( PCXDFILE pFile, int kind, char* pDst )
+{
+   int k, n;
+
+   n = cxdGetNumRecordsOfKind( pFile, kind );
+   for( k = 0; k < n; k++ )
+      memcpy( pDst + k*CX_RECORDBYTES, cxdGetRecordOfKind( pFile, kind, k )->u.byteData, CX_RECORDBYTES );
+   return( n * CX_RECORDBYTES );
+}
+
+
+//=== cxdUncompressAI =================================================================================================
+//
+//    Uncompress a CNTRLX analog input byte stream sampling the specified number N of AI channels.  When more than one
+//    channel is recorded, the data are stored in the output buffer as [ch1(0), ..., chN(0), ch1(1), ..., ch1(N), ...].
+//    Uncompressed data is in the range of a 12bit analog-to-digital converter: [-2048..2047].
+//
+//    Compression algorithm:  Each compressed sample represents the DIFFERENCE from the previous sample.  If this
+//    difference is in [-63..63], it is encoded as a single byte in [0x01..0x7F].  Observe that bit 7 is NOT set.  To
+//    get back the sample, subtract 64 from the encoded byte, then add the result to the value of the last sample on
+//    the current channel.  If the difference is in [-2048..-64, 64..2047], it is encoded as two bytes in the range
+//    [0x8800..0x8FC0, 0x9040..0x97FF], with the high byte first.  In this case bit 7 is set in the high byte -- that's
+//    how we distinguish between a one-byte and two-byte compressed datum.  To uncompress the two-byte datum, we pack
+//    the two bytes into a 16bit int, clear bit 15, and subtract 4096 to recover the difference, which is then added
+//    to the value of the last sample to get the current sample value.  OBSERVE that, if a given sample is compressed
+//    as one byte, it will never have the value 0x00; for a 2-byte compressed sample, the high byte is never 0x00.  In
+//    fact, CNTRLX uses the zero byte to mark the end of the compressed data stream.  We stop as soon as we reach this
+//    end-of-stream marker -- thus we will know exactly how many bytes were compressed and how many scans of real data
+//    were saved.
+//
+//    When the # of compressed bytes is an integer multiple of CX_RECORDBYTES, there is no "end of data" marker (the
+//    zero byte) in the compressed data buffer; the last scan is still counted in that case.
+//
+//    Cntrlx uses the byte value 0xFF rather than 0 as the "endOfData" mark in Continuous mode files, while it uses 0
+//    for Trial mode files.  Maestro uses 0 as the "endOfData" mark always.  To decompress Cntrlx-generated Continuous
+//    mode files properly, we check for the presence of either of these markers.  The compression algorithm guarantees
+//    that 0xFF will never appear as the value of a 1-byte compressed sample, nor as the first byte of a 2-byte
+//    compressed sample.
+//
+//    [Moved here from readcxdata.c, where it was uncompressAIData(). This is the reference implementation; it
+//    decodes one byte at a time. Use cxdDecodeAI16() instead.]
+//
+//    ARGS:       pDst     -- [out] pre-allocated buffer to hold the uncompressed data stream in "channel-scan order".
+//                iDstSz   -- [in] total # of samples that can be stored in uncompressed data buffer.
+//                pSrc     -- [in] compressed data stream buffer.
+//                iSrcSz   -- [in] size of compressed data buffer.
+//                nCh      -- [in] # of AI channels that were recorded.
+//                pNC      -- [out] total # of compressed bytes found (zero byte marks end of stream!)
+//                pNScans  -- [out] total # of complete scans found in uncompressed data stream.  The total # of
+//                            samples is this # times the # of channels recorded.
+//
+//    RETURNS:    NONE.
+//
+VOID cxdUncompressAI( double* pDst, int iDstSz, const char* pSrc, int iSrcSz, int nCh, int* pNC, int* pNScans )
+{
+   int i;
+   int iLastSample[CXH_MAXAI];
+   char cByte;
+   short shTemp;
+   int nSrc;
+   int nScans;
+
+   memset( iLastSample, 0, CXH_MAXAI*sizeof(int) );                     // all channels read 0 at t = 0!
+
+   nScans = 0;                                                          // # of complete channel scans found
+   nSrc = 0;                                                            // # of compressed bytes processed
+
+   while( nSrc < iSrcSz )                                               // uncompress the data stream
+   {
+      if( (nScans+1)*nCh > iDstSz )                                     //    oops, not enough room left in output buf
+      {                                                                 //    for the next scan's worth of samples
+         *pNC = nSrc;
+         *pNScans = nScans;
+         return;
+      }
+
+      for( i = 0; i < nCh; i++ )                                        //    do one channel scan's worth at a time
+      {
+         if( nSrc == iSrcSz || pSrc[nSrc] == 0 || pSrc[nSrc] == -1 )    //    oops, we've either hit end of input
+         {                                                              //    buffer or got "endOfData" mark
+            *pNC = nSrc;
+            *pNScans = nScans;
+            return;
+         }
+
+         cByte = pSrc[nSrc++];                                          //    read in the next byte
+         if( cByte & 0x080 )                                            //    if bit7 set, next datum is 2 bytes
+         {
+            if( nSrc == iSrcSz )                                        //    should NEVER happen, but just in case...
+            {
+               *pNC = nSrc;
+               *pNScans = nScans;
+               return;
+            }
+            shTemp = (cByte & 0x7F);
+            shTemp <<= 8;
+            shTemp |= 0x00FF & ((short) pSrc[nSrc++]);
+            shTemp -= 4096;
+            iLastSample[i] += shTemp;                                   //    datum is difference from last sample!
+         }
+         else                                                           //    if bit 7 clear, next datum is 1 byte
+         {
+            shTemp = cByte - 64;
+            iLastSample[i] += shTemp;
+         }
+
+         pDst[nScans*nCh+i] = (double)iLastSample[i];                   //    save uncompressed sample in output buf
+      }
+      ++nScans;
+   }
+
+   *pNC = nSrc;
+   *pNScans = nScans;
+}
+
+
+//=== cxdDecodeAI16 ===================================================================================================
+//
+//    Uncompress a CNTRLX analog input byte stream sampling the specified number N of AI channels, storing the samples
+//    as 16-bit integers. The compression scheme, the end-of-data markers, the output order and the semantics of all
+//    arguments are exactly as for cxdUncompressAI(), but the decoder is considerably faster. See cxdDecodeAIScans16().
+//
+//    ARGS:       pDst     -- [out] pre-allocated buffer to hold the uncompressed data stream in "channel-scan order".
+//                iDstSz   -- [in] total # of samples that can be stored in uncompressed data buffer.
+//                pSrc     -- [in] compressed data stream buffer.
+//                iSrcSz   -- [in] size of compressed data buffer.
+//                nCh      -- [in] # of AI channels that were recorded, in [1..CXH_MAXAI].
+//                pNC      -- [out] total # of compressed bytes found (zero byte marks end of stream!)
+//                pNScans  -- [out] total # of complete scans found in uncompressed data stream.  The total # of
+//                            samples is this # times the # of channels recorded.
+//
+//    RETURNS:    NONE.
+//
+VOID cxdDecodeAI16( short* pDst, int iDstSz, const char* pSrc, int iSrcSz, int nCh, int* pNC, int* pNScans )
+{
+   *pNC = 0;
+   *pNScans = 0;
+   if( nCh < 1 || nCh > CXH_MAXAI || iDstSz < 0 ) return;
+   cxdDecodeAIScans16( pDst, pSrc, iSrcSz, nCh, 0, iDstSz / nCh, pNC, pNScans );
+}
+
+
+//=== cxdDecodeAIScans16 ==============================================================================================
+//
+//    Uncompress a contiguous range of scans from a CNTRLX analog input byte stream, storing the samples as 16-bit
+//    integers in "channel-scan order" (see cxdUncompressAI() for a description of the compression scheme). Because
+//    each sample is a difference from the previous sample on the same channel, the scans preceding the range must
+//    still be parsed, but they are only accumulated, not stored; and decoding stops as soon as the last scan in the
+//    range is complete, so the rest of the stream is never touched. Reading a short window early in a long ContMode
+//    recording thus costs a small fraction of decoding the entire stream.
+//
+//    The vast majority of samples in a typical stream are 1-byte differences, so the stream is decoded in runs. The
+//    length of the run of 1-byte samples starting at the current position is found 8 bytes at a time: a byte ends the
+//    run if bit 7 is set (the high byte of a 2-byte sample, or the 0xFF end mark) or if it is zero (the end mark), and
+//    both conditions are tested for all 8 bytes of a 64-bit word at once. The run is then accumulated into the
+//    per-channel sums in a tight loop with no per-sample branching on the byte's type; while skipping a single-channel
+//    stream, 8 samples are summed at once. The 2-byte sample or end mark that stopped the run is handled individually,
+//    and the process repeats.
+//
+//    ARGS:       pDst        -- [out] pre-allocated buffer to hold the uncompressed scans; capacity must be at least
+//                               nScans * nCh samples. Scan 'iFirstScan' is stored first.
+//                pSrc        -- [in] compressed data stream buffer.
+//                iSrcSz      -- [in] size of compressed data buffer.
+//                nCh         -- [in] # of AI channels that were recorded, in [1..CXH_MAXAI].
+//                iFirstScan  -- [in] index of first scan to store (0 = start of recording).
+//                nScans      -- [in] # of scans to store.
+//                pNC         -- [out] # of compressed bytes parsed. This is the total # of compressed bytes in the
+//                               stream only if the stream ended before the last scan in the range.
+//                pNScans     -- [out] # of complete scans stored; less than 'nScans' if the stream ended first.
+//
+//    RETURNS:    NONE.
+//
+VOID cxdDecodeAIScans16( short* pDst, const char* pSrc, int iSrcSz, int nCh, int iFirstScan, int nScans, int* pNC,
+                         int* pNScans )
+{
+   const uint64_t ONES = 0x0101010101010101ULL;
+   const uint64_t HIGHS = 0x8080808080808080ULL;
+   const uint64_t LANES = 0x00FF00FF00FF00FFULL;
+   const BYTE* pb = (const BYTE*) pSrc;
+   int iLastSample[CXH_MAXAI];
+   int nSrc, nSamp, nSkipSamp, nEndSamp, nLimit, nAvail, nRun, iCh, iAcc, i, k;
+   short* pOut;
+   BYTE c;
+   uint64_t w;
+
+   *pNC = 0;
+   *pNScans = 0;
+   if( nCh < 1 || nCh > CXH_MAXAI || iFirstScan < 0 || nScans <= 0 ) return;
+
+   memset( iLastSample, 0, CXH_MAXAI*sizeof(int) );                     // all channels read 0 at t = 0!
+   nSkipSamp = iFirstScan * nCh;                                        // samples before this are not stored
+   nEndSamp = nSkipSamp + nScans * nCh;                                 // decoding stops here
+   nSrc = 0;                                                            // # of compressed bytes processed
+   nSamp = 0;                                                           // # of samples decoded
+   iCh = 0;                                                             // channel to which next sample belongs
+
+   while( nSrc < iSrcSz && nSamp < nEndSamp )
+   {
+      nLimit = (nSamp < nSkipSamp) ? nSkipSamp : nEndSamp;              //    don't run past start or end of range
+
+      nAvail = iSrcSz - nSrc;                                           //    length of the run of 1-byte samples
+      if( nAvail > nLimit - nSamp ) nAvail = nLimit - nSamp;            //    here, 8 bytes at a time, then 1 at a
+      nRun = 0;                                                         //    time: no byte may be 0 or have bit 7 set
+      while( nRun + 8 <= nAvail )
+      {
+         memcpy( &w, pb + nSrc + nRun, 8 );
+         if( ((w | (w - ONES)) & HIGHS) != 0 ) break;
+         nRun += 8;
+      }
+      while( nRun < nAvail && pb[nSrc + nRun] != 0 && pb[nSrc + nRun] < 0x80 ) ++nRun;
+
+      if( nSamp < nSkipSamp )                                           //    before range: accumulate the run of
+      {                                                                 //    1-byte diffs without storing samples
+         if( nCh == 1 )
+         {
+            for( k = 0; k + 8 <= nRun; k += 8 )                         //    (sum of 8 bytes, each <= 0x7F)
+            {
+               memcpy( &w, pb + nSrc + k, 8 );
+               w = (w & LANES) + ((w >> 8) & LANES);
+               iLastSample[0] += ((int) ((w * 0x0001000100010001ULL) >> 48)) - 8*64;
+            }
+            for( ; k < nRun; k++ ) iLastSample[0] += ((int) pb[nSrc + k]) - 64;
+         }
+         else
+         {
+            for( k = 0; k < nRun && iCh != 0; k++ )                     //    (finish current scan, then whole scans)
+            {
+               iLastSample[iCh] += ((int) pb[nSrc + k]) - 64;
+               if( ++iCh == nCh ) iCh = 0;
+            }
+            for( ; k + nCh <= nRun; k += nCh )
+               for( i = 0; i < nCh; i++ ) iLastSample[i] += ((int) pb[nSrc + k + i]) - 64;
+            for( ; k < nRun; k++ ) iLastSample[iCh++] += ((int) pb[nSrc + k]) - 64;
+         }
+      }
+      else                                                              //    in range: accumulate and store
+      {
+         pOut = pDst + (nSamp - nSkipSamp);
+         if( nCh == 1 )
+         {
+            iAcc = iLastSample[0];
+            for( k = 0; k < nRun; k++ )
+            {
+               iAcc += ((int) pb[nSrc + k]) - 64;
+               pOut[k] = (short) iAcc;
+            }
+            iLastSample[0] = iAcc;
+         }
+         else
+         {
+            for( k = 0; k < nRun && iCh != 0; k++ )
+            {
+               iLastSample[iCh] += ((int) pb[nSrc + k]) - 64;
+               pOut[k] = (short) iLastSample[iCh];
+               if( ++iCh == nCh ) iCh = 0;
+            }
+            for( ; k + nCh <= nRun; k += nCh ) for( i = 0; i < nCh; i++ )
+            {
+               iLastSample[i] += ((int) pb[nSrc + k + i]) - 64;
+               pOut[k + i] = (short) iLastSample[i];
+            }
+            for( ; k < nRun; k++ )
+            {
+               iLastSample[iCh] += ((int) pb[nSrc + k]) - 64;
+               pOut[k] = (short) iLastSample[iCh++];
+            }
+         }
+      }
+      nSrc += nRun;
+      nSamp += nRun;
+      if( nSrc == iSrcSz || nSamp == nLimit ) continue;
+
+      c = pb[nSrc];                                                     //    the run ended at a 2-byte sample or at
+      if( c == 0 || c == 0xFF ) break;                                  //    the "endOfData" mark
+      if( ++nSrc == iSrcSz ) break;                                     //    should NEVER happen, but just in case...
+      iLastSample[iCh] += ((((int) (c & 0x7F)) << 8) | pb[nSrc++]) - 4096;
+      if( nSamp >= nSkipSamp ) pDst[nSamp - nSkipSamp] = (short) iLastSample[iCh];
+      ++nSamp;
+      if( ++iCh == nCh ) iCh = 0;
+   }
+
+   *pNC = nSrc;
+   *pNScans = (nSamp > nSkipSamp) ? (nSamp - nSkipSamp) / nCh : 0;
+}
+
+
+//=== cxdDecodeEventTimes =============================================================================================
+//
+//    Decode the digital events recorded on DI<0> (CXD_EVENT0) or DI<1> (CXD_EVENT1). These records hold interevent
+//    intervals in 10us ticks, the first interval being the time of the first event since recording began. The
+//    intervals are accumulated across records and converted to absolute event times in milliseconds. The last record
+//    may be only partially full, its unused entries set to the "end of data" marker EOD_EVENTRECORD; decoding stops
+//    at the first such marker. Endianness is converted as needed.
+//
+//    ARGS:       pFile  -- [in] the open file.
+//                kind   -- [in] CXD_EVENT0 or CXD_EVENT1.
+//                pDst   -- [out] buffer for the event times, in ms. May be NULL, in which case events are only
+//                          counted. Otherwise, it should hold N*CX_RECORDINTS values, where N is the number of records
+//                          of the specified kind.
+//                iDstSz -- [in] capacity of pDst. Ignored if pDst is NULL.
+//
+//    RETURNS:    The number of events decoded; -1 if kind is invalid.
+//
+int cxdDecodeEventTimes( PCXDFILE pFile, int kind, double* pDst, int iDstSz )
+{
+   int i, k, n, nEvents, iTime;
+   long tLast;
+   BOOL bSwap;
+   const CXFILEREC* pRec;
+
+   if( kind != CXD_EVENT0 && kind != CXD_EVENT1 ) return( -1 );
+
+   bSwap = cxdIsBigEndianHost();
+   n = cxdGetNumRecordsOfKind( pFile, kind );
+   nEvents = 0;
+   tLast = 0;
+   for( k = 0; k < n; k++ )
+   {
+      pRec = cxdGetRecordOfKind( pFile, kind, k );
+      for( i = 0; i < (int) CX_RECORDINTS; i++ )
+      {
+         iTime = bSwap ? cxdSwapInt( pRec->u.iData[i] ) : pRec->u.iData[i];
+         if( iTime == EOD_EVENTRECORD ) break;
+
+         tLast += iTime;
+         if( pDst != NULL )
+         {
+            if( nEvents == iDstSz ) return( nEvents );
+            pDst[nEvents] = ((double) tLast) / 100.0;
+         }
+         ++nEvents;
+      }
+   }
+   return( nEvents );
+}
+
+
+//=== cxdCountTrialCodes ==============================================================================================
+//
+//    Find the length of the trial code sequence in a Trial mode data file. The sequence always ends with ENDTRIAL; any
+//    unused trial codes in the last record are zero.
+//
+//    ARGS:       pFile  -- [in] the open file.
+//
+//    RETURNS:    The number of trial codes up to and including ENDTRIAL. If ENDTRIAL is missing, the total number of
+//                trial codes in all trial code records. 0 if there are no trial code records.
+//
+int cxdCountTrialCodes( PCXDFILE pFile )
+{
+   int i, k, n;
+   short code;
+   BOOL bSwap;
+   const CXFILEREC* pRec;
+
+   bSwap = cxdIsBigEndianHost();
+   n = cxdGetNumRecordsOfKind( pFile, CXD_TRIALCODE );
+   for( k = 0; k < n; k++ )
+   {
+      pRec = cxdGetRecordOfKind( pFile, CXD_TRIALCODE, k );
+      for( i = 0; i < (int) CX_RECORDCODES; i++ )
+      {
+         code = bSwap ? cxdSwapShort( pRec->u.tc[i].code ) : pRec->u.tc[i].code;
+         if( code == ENDTRIAL ) return( k * ((int) CX_RECORDCODES) + i + 1 );
+      }
+   }
+   return( n * ((int) CX_RECORDCODES) );
+}
+
+
+//=== cxdSortSpikeEdits ===============================================================================================
+//
+//    Sort a list of sorted-spike train edits by channel, then spike time, then ordinal position in the action list --
+//    so that each channel's edits are contiguous and ready for cxdMergeSpikeEdits(), and multiple edits of the same
+//    spike remain in the order they were made.
+//
+//    ARGS:       pEdits   -- [in/out] the edits. CXDSPIKEEDIT.seq must be unique.
+//                nEdits   -- [in] # of edits.
+//
+VOID cxdSortSpikeEdits( PCXDSPIKEEDIT pEdits, int nEdits )
+{
+   if( nEdits > 1 ) qsort( pEdits, nEdits, sizeof(CXDSPIKEEDIT), cxdCompareSpikeEdits );
+}
+
+
+//=== cxdMergeSpikeEdits ==============================================================================================
+//
+//    Apply a channel's sorted-spike train edits to its spike train in a single linear merge. The result is the same as
+//    replaying the edits one at a time in action list order, where adding a spike does nothing if there is already a
+//    spike at that time, and removing one does nothing if there is not.
+//
+//    As in the original replay, spike times are compared with a tolerance: the train holds times in ms accumulated
+//    from interspike intervals, while each edit time is in 10us ticks, so a spike "is at" the edit time if the two
+//    differ by no more than 0.001ms. Edit times are whole ticks, 0.01ms apart, so no spike in the train can match two
+//    different edit times, and the edits for each time can be resolved independently of all others: starting with the
+//    spikes in the train that match it (usually 0 or 1), a removal takes out the earliest remaining one, and an
+//    addition inserts a spike at the edit time if none remains.
+//
+//    ARGS:       pdSpikes -- [in] the spike train, in chronological order (ms).
+//                nSpikes  -- [in] # of spikes in the train.
+//                pEdits   -- [in] the channel's edits, sorted by cxdSortSpikeEdits(). The channel is not checked.
+//                nEdits   -- [in] # of edits.
+//                pdDst    -- [out] the edited spike train, in chronological order. Must hold at least nSpikes + A
+//                            values, where A is the # of edits that add a spike. Must not overlap the input train.
+//
+//    RETURNS:    # of spikes in the edited spike train.
+//
+int cxdMergeSpikeEdits( const double* pdSpikes, int nSpikes, const CXDSPIKEEDIT* pEdits, int nEdits, double* pdDst )
+{
+   int i, j, k, e, t, nLeft;
+   BOOL bAdded;
+   double tMS;
+
+   i = k = e = 0;
+   while( e < nEdits )
+   {
+      t = pEdits[e].t;
+      tMS = ((double) t) / 100.0;
+
+      while( i < nSpikes && tMS - pdSpikes[i] > 0.001 ) pdDst[k++] = pdSpikes[i++];
+      j = i;                                                            // spikes [i..j) are at the edit time
+      while( j < nSpikes && tMS - pdSpikes[j] >= -0.001 ) ++j;
+
+      nLeft = j - i;                                                    // replay all edits at this time, in order
+      bAdded = FALSE;
+      for( ; e < nEdits && pEdits[e].t == t; e++ )
+      {
+         if( pEdits[e].bAdd )
+         {
+            if( nLeft == 0 ) bAdded = TRUE;                             //    no-op if a spike is already there
+         }
+         else if( bAdded ) bAdded = FALSE;                              //    an added spike is the only one there
+         else if( nLeft > 0 ) --nLeft;                                  //    removes earliest matching spike
+      }
+
+      for( i = j - nLeft; i < j; i++ ) pdDst[k++] = pdSpikes[i];
+      if( bAdded ) pdDst[k++] = tMS;
+      i = j;
+   }
+   while( i < nSpikes ) pdDst[k++] = pdSpikes[i++];
+   return( k );
+}
+
+
+//=== cxdLoadContent ==================================================================================================
+//
+//    Load the entire content of a data file into memory: on platforms supporting mmap(), the file is mapped privately
+//    (copy-on-write) and the kernel is advised that the whole file will be needed; otherwise, it is read into a
+//    malloc'd buffer in one call. On success, pFile->pBase, nBytes and bMapped are set.
+//
+//    ARGS:       pFile -- [in/out] the file object, in the closed state.
+//                path  -- [in] the file's pathname.
+//
+//    RETURNS:    TRUE if successful; FALSE otherwise (pFile->errMsg describes the error).
+//
+BOOL cxdLoadContent( PCXDFILE pFile, const char* path )
+{
+#if defined(CXD_HAVE_MMAP)
+   int fd;
+   struct stat st;
+   void* p;
+
+   if( (fd = open( path, O_RDONLY )) < 0 )
+   {
+      snprintf( pFile->errMsg, sizeof(pFile->errMsg), "Could not open %s", path );
+      return( FALSE );
+   }
+   if( fstat( fd, &st ) != 0 || !S_ISREG(st.st_mode) )
+   {
+      snprintf( pFile->errMsg, sizeof(pFile->errMsg), "Not a regular file: %s", path );
+      close( fd );
+      return( FALSE );
+   }
+
+   pFile->nBytes = (size_t) st.st_size;
+   if( pFile->nBytes == 0 )                                             // cannot map an empty file; cxdOpen() will
+   {                                                                    // reject it anyway
+      close( fd );
+      pFile->pBase = (BYTE*) malloc( 1 );
+      return( pFile->pBase != NULL );
+   }
+
+   p = mmap( NULL, pFile->nBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+   close( fd );                                                         // the mapping persists after close
+   if( p == MAP_FAILED )
+   {
+      snprintf( pFile->errMsg, sizeof(pFile->errMsg), "Could not map %s into memory", path );
+      pFile->nBytes = 0;
+      return( FALSE );
+   }
+#if defined(MADV_WILLNEED)
+   madvise( p, pFile->nBytes, MADV_WILLNEED );                          // we'll touch every page; start reading now
+#endif
+   pFile->pBase = (BYTE*) p;
+   pFile->bMapped = TRUE;
+   return( TRUE );
+#else
+   FILE* fp;
+   long nBytes;
+
+   if( (fp = fopen( path, "rb" )) == NULL )
+   {
+      snprintf( pFile->errMsg, sizeof(pFile->errMsg), "Could not open %s", path );
+      return( FALSE );
+   }
+   if( fseek( fp, 0, SEEK_END ) != 0 || (nBytes = ftell( fp )) < 0 || fseek( fp, 0, SEEK_SET ) != 0 )
+   {
+      snprintf( pFile->errMsg, sizeof(pFile->errMsg), "Could not determine size of %s", path );
+      fclose( fp );
+      return( FALSE );
+   }
+
+   pFile->pBase = (BYTE*) malloc( (nBytes > 0) ? (size_t) nBytes : 1 );
+   if( pFile->pBase == NULL )
+   {
+      snprintf( pFile->errMsg, sizeof(pFile->errMsg), "Out of memory reading %s", path );
+      fclose( fp );
+      return( FALSE );
+   }
+   pFile->nBytes = (size_t) nBytes;
+   if( nBytes > 0 && fread( pFile->pBase, 1, pFile->nBytes, fp ) != pFile->nBytes )
+   {
+      snprintf( pFile->errMsg, sizeof(pFile->errMsg), "Error reading %s", path );
+      fclose( fp );
+      cxdClose( pFile );
+      return( FALSE );
+   }
+   fclose( fp );
+   return( TRUE );
+#endif
+}
+
+
+//=== cxdBuildIndex ===================================================================================================
+//
+//    Index the records of an open data file by kind: a counting pass over the record tags sizes each kind's section
+//    of the index, and a second pass fills it in, so records of each kind are listed in file order. The header record
+//    (if any) is excluded.
+//
+//    ARGS:       pFile -- [in/out] the file object, with content loaded.
+//
+//    RETURNS:    TRUE if successful; FALSE if memory allocation failed (pFile->errMsg describes the error).
+//
+BOOL cxdBuildIndex( PCXDFILE pFile )
+{
+   int i, kind, iFirst;
+   int iNext[CXD_NUMKINDS];
+
+   iFirst = pFile->bHeaderless ? 0 : 1;
+   pFile->piIndex = (int*) malloc( sizeof(int) * (pFile->nRecords + 1) );
+   if( pFile->piIndex == NULL )
+   {
+      sprintf( pFile->errMsg, "Out of memory indexing %d records", pFile->nRecords );
+      return( FALSE );
+   }
+
+   memset( pFile->iKindStart, 0, sizeof(pFile->iKindStart) );
+   for( i = iFirst; i < pFile->nRecords; i++ )
+      ++pFile->iKindStart[cxdGetRecordKind( cxdGetRecord( pFile, i ) ) + 1];
+   for( kind = 0; kind < CXD_NUMKINDS; kind++ )
+   {
+      pFile->iKindStart[kind+1] += pFile->iKindStart[kind];
+      iNext[kind] = pFile->iKindStart[kind];
+   }
+
+   for( i = iFirst; i < pFile->nRecords; i++ )
+      pFile->piIndex[iNext[cxdGetRecordKind( cxdGetRecord( pFile, i ) )]++] = i;
+   return( TRUE );
+}
+
+
+//=== cxdCompareSpikeEdits ============================================================================================
+//
+//    qsort() comparison function for cxdSortSpikeEdits(): orders CXDSPIKEEDITs by channel, spike time, and ordinal
+//    position in the action list.
+//
+int cxdCompareSpikeEdits( const void* p1, const void* p2 )
+{
+   const CXDSPIKEEDIT* pE1 = (const CXDSPIKEEDIT*) p1;
+   const CXDSPIKEEDIT* pE2 = (const CXDSPIKEEDIT*) p2;
+
+   if( pE1->ch != pE2->ch ) return( (pE1->ch < pE2->ch) ? -1 : 1 );
+   if( pE1->t != pE2->t ) return( (pE1->t < pE2->t) ? -1 : 1 );
+   if( pE1->seq != pE2->seq ) return( (pE1->seq < pE2->seq) ? -1 : 1 );
+   return( 0 );
+}
+
+
+//=== cxdSwapInt, cxdSwapShort ========================================================================================
+//
+//    Reverse the byte order of a 32-bit int or 16-bit short -- for converting multi-byte fields viewed in a data file
+//    on a big-endian host.
+//
+int cxdSwapInt( int i )
+{
+   DWORD dw = (DWORD) i;
+   return( (int) ((dw >> 24) | ((dw >> 8) & 0x0000FF00) | ((dw << 8) & 0x00FF0000) | (dw << 24)) );
+}
+
+short cxdSwapShort( short sh )
+{
+   WORD w = (WORD) sh;
+   return( (short) ((w >> 8) | (w << 8)) );
+}
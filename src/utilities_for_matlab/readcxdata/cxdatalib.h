@@ -0,0 +1,98 @@
+//=====================================================================================================================
+//
+// cxdatalib.h : Constants, types and function declarations for CXDATALIB.C, a standalone reader for Maestro/Cntrlx
+//               data files.
+//
+// ****** FOR DESCRIPTION, REVISION HISTORY, ETC, SEE IMPLEMENTATION FILE ******
+//
+//=====================================================================================================================
+
+#if !defined(CXDATALIB_H__INCLUDED_)
+#define CXDATALIB_H__INCLUDED_
+
+#include <stddef.h>
+
+#include "wintypes.h"                                    // some typical Windows typedefs that we need
+#include "cxfilefmt_mex.h"                               // Maestro/Cntrlx data file fmt (file modified for MEX build)
+
+
+#define CXD_RECORDSZ             1024                    // size of each record in a Maestro/Cntrlx data file
+
+// record kinds, by which the records of an open data file are indexed. The header record (if any) is not indexed.
+#define CXD_AI                   0                       // CX_AIRECORD: compressed, slow-sampled AI data
+#define CXD_EVENT0               1                       // CX_EVENT0RECORD: interevent intervals on DI<0>
+#define CXD_EVENT1               2                       // CX_EVENT1RECORD: interevent intervals on DI<1>
+#define CXD_OTHEREVENT           3                       // CX_OTHEREVENTRECORD: (mask, time) pairs on DI<15..2>
+#define CXD_TRIALCODE            4                       // CX_TRIALCODERECORD: trial codes
+#define CXD_ACTION               5                       // CX_XWORKACTIONREC: XWork/JMWork edit actions
+#define CXD_SORTSPIKE            6                       // CX_SPIKESORTREC_FIRST.._LAST: sorted spike trains
+#define CXD_TARGET               7                       // CX_TGTRECORD: target definitions
+#define CXD_SPIKEWAVE            8                       // CX_SPIKEWAVERECORD: compressed 25KHz spike waveform
+#define CXD_TAGSECT              9                       // CX_TAGSECTRECORD: trial tagged sections
+#define CXD_UNKNOWN              10                      // all other records (stimulus run, V1 target, unrecognized)
+#define CXD_NUMKINDS             11
+
+
+//=====================================================================================================================
+// CXDFILE: An open Maestro/Cntrlx data file. The entire file is mapped into memory (or, on platforms lacking mmap(),
+// read into memory in a single call), and its records are indexed by kind. All record accessors return pointers into
+// that memory -- no record is copied. The mapping is private (copy-on-write), so a caller may modify a record in
+// place (eg, to convert endianness) without affecting the file on disk.
+//
+// NOTE that all data files were written on little-endian machines. The record views are raw file content; on a
+// big-endian host, multi-byte fields must be converted by the caller -- except by the decoding functions, which do
+// so as needed.
+//=====================================================================================================================
+typedef struct tagCxdFile
+{
+   BYTE* pBase;                                          // start of the file's content in memory
+   size_t nBytes;                                        // file size in bytes
+   BOOL bMapped;                                         // TRUE if mapped via mmap(); else content is malloc'd
+   int nRecords;                                         // # of records in file (including header, if any)
+   BOOL bHeaderless;                                     // TRUE for a (pre-Dec2001) headerless ContMode file
+   int* piIndex;                                         // record indices grouped by kind, in file order per kind
+   int iKindStart[CXD_NUMKINDS+1];                       // records of kind K are piIndex[iKindStart[K]..[K+1]-1]
+   char errMsg[256];                                     // description of the last error, if any
+} CXDFILE, *PCXDFILE;
+
+
+//=====================================================================================================================
+// CXDSPIKEEDIT: One manual edit of a sorted-spike train, as recorded by JMWork in the edit action records
+// (ACTION_ADDSORTSPK or ACTION_REMOVESORTSPK). See cxdSortSpikeEdits() and cxdMergeSpikeEdits().
+//=====================================================================================================================
+typedef struct tagCxdSpikeEdit
+{
+   int ch;                                               // sorted-spike train channel
+   int t;                                                // spike time in 10us ticks since recording began
+   int seq;                                              // ordinal position of the edit in the action list
+   BOOL bAdd;                                            // TRUE to add the spike, FALSE to remove it
+} CXDSPIKEEDIT, *PCXDSPIKEEDIT;
+
+
+//=====================================================================================================================
+// FUNCTIONS
+//=====================================================================================================================
+BOOL cxdIsBigEndianHost();
+BOOL cxdOpen( PCXDFILE pFile, const char* path );
+VOID cxdClose( PCXDFILE pFile );
+int cxdGetRecordKind( const CXFILEREC* pRec );
+
+CXFILEHDR* cxdGetHeader( PCXDFILE pFile );
+CXFILEREC* cxdGetRecord( PCXDFILE pFile, int iRec );
+int cxdGetNumRecordsOfKind( PCXDFILE pFile, int kind );
+CXFILEREC* cxdGetRecordOfKind( PCXDFILE pFile, int kind, int k );
+
+int cxdGatherBytes( PCXDFILE pFile, int kind, char* pDst );
+VOID cxdUncompressAI( double* pDst, int iDstSz, const char* pSrc, int iSrcSz, int nCh, int* pNC, int* pNScans );
+VOID cxdDecodeAI16( short* pDst, int iDstSz, const char* pSrc, int iSrcSz, int nCh, int* pNC, int* pNScans );
+VOID cxdDecodeAIScans16( short* pDst, const char* pSrc, int iSrcSz, int nCh, int iFirstScan, int nScans, int* pNC,
+                         int* pNScans );
+int cxdDecodeEventTimes( PCXDFILE pFile, int kind, double* pDst, int iDstSz );
+int cxdCountTrialCodes( PCXDFILE pFile );
+VOID cxdSortSpikeEdits( PCXDSPIKEEDIT pEdits, int nEdits );
+int cxdMergeSpikeEdits( const double* pdSpikes, int nSpikes, const CXDSPIKEEDIT* pEdits, int nEdits, double* pdDst );
+
+int cxdSwapInt( int i );
+short cxdSwapShort( short sh );
+
+#endif   // !defined(CXDATALIB_H__INCLUDED_)
@@ -114,6 +114,8 @@
 // file record with id==CX_STIMRUNRECORD, regardless the data file version.***
 // 18dec2024 -- Update to sync with additional changes in CXFILEFMT.H for Maestro 5.0.2; new param RMVTGTDEF.fDotDisp,
 // affecting format of target definition record.
+// 16oct2026 -- CX_RECORDTARGETS_V24 is now #define'd like the other record capacities. As a "const int", it could not
+// dimension CXFILEREC.u.tgtsV24 when this file is compiled as C (see above).
 // 
 //=====================================================================================================================
 
@@ -564,7 +566,7 @@ typedef struct tagCxFileTgtRec_V24
    float fPosX, fPosY;
 } CXFILETGT_V24, * PCXFILETGT_V24;
 
-const int CX_RECORDTARGETS_V24 = CX_RECORDBYTES / sizeof(CXFILETGT_V24);
+#define CX_RECORDTARGETS_V24    (CX_RECORDBYTES/sizeof(CXFILETGT_V24))
 
 
 /* [deprecated a/o file version 25, Maestro 5.0.2]
@@ -91,6 +91,8 @@
 // 04jun2021-- Modified to support 200 sorted-spike train channels. The channel number is computed from the record
 //             tag ID N=8..57, combined with a "bank number" M=0..3 stored in byte 1 of the 8-byte record tag (the ID
 //             is in byte 0). Channel # = M*50 + N-8.
+// 16oct2026-- Removed this module's copy of uncompressAIData(); replaceSpikewave() now uses the 16-bit decoder
+//             cxdDecodeAI16() in cxdatalib.c, shared with READCXDATA. Build:  mex editcxdata.c cxdatalib.c
 //===================================================================================================================== 
 
 #include <stdio.h>
@@ -101,6 +103,7 @@
 #include "mex.h"
 
 #include "readcxdata.h"       // constants, structure definitions relevant to READCXDATA; we only use some of them
+#include "cxdatalib.h"        // standalone data file reader: AI/spike waveform decompression
 
 
 //===================================================================================================================== 
@@ -147,7 +150,6 @@ BOOL hasSpikeSortData(const mxArray* pChannels, int chNum);
 BOOL writeSortedSpikes( const mxArray* pChannels );
 BOOL readSpikewave(CXFILEREC* pRec);
 BOOL replaceSpikewave(const mxArray *pSpikewave);
-void uncompressAIData(double* pDst, int iDstSz, char* pSrc, int iSrcSz, int nCh, int* pNC, int* pNScans);
 BOOL writeSpikewave();
 
 
@@ -1526,6 +1528,7 @@ BOOL readSpikewave(CXFILEREC* pRec)
 BOOL replaceSpikewave(const mxArray *pSpikewave)
 {
    double* pdData;
+   short* pshData;
    int i, nBytes, nLen;
    short shNext, shLast, shTemp;
    char* pcNewBuf;                                                         // ptr to reallocated buffer, if needed
@@ -1541,14 +1544,14 @@ BOOL replaceSpikewave(const mxArray *pSpikewave)
    // uncompress data into a temp array so we can check length of original waveform
    nBytes = 0;
    nLen = 0;
-   pdData = (double*) malloc( sizeof(double) * m_nFastBytes ); 
-   if(pdData == NULL)
+   pshData = (short*) malloc( sizeof(short) * m_nFastBytes ); 
+   if(pshData == NULL)
    {
       printf("ERROR: Memory allocation failed while editing spike waveform data!\n");
       return(FALSE);
    }
-   uncompressAIData(pdData, m_nFastBytes, m_pcFastData, m_nFastBytes, 1, &nBytes, &nLen);
-   free(pdData);
+   cxdDecodeAI16(pshData, m_nFastBytes, m_pcFastData, m_nFastBytes, 1, &nBytes, &nLen);
+   free(pshData);
 
    i = (int) mxGetNumberOfElements(pSpikewave);
    if(nLen != i)
@@ -1603,112 +1606,6 @@ BOOL replaceSpikewave(const mxArray *pSpikewave)
    return(TRUE);
 }
 
-//=== uncompressAIData ================================================================================================
-//
-//    28nov06: COPIED FROM READCXDATA.C
-//
-//    Uncompress a CNTRLX analog input byte stream sampling the specified number N of AI channels.  When more than one
-//    channel is recorded, the data are stored in the output buffer as [ch1(0), ..., chN(0), ch1(1), ..., ch1(N), ...].
-//    Uncompressed data is in the range of a 12bit analog-to-digital converter: [-2048..2047].
-//
-//    Compression algorithm:  Each compressed sample represents the DIFFERENCE from the previous sample.  If this
-//    difference is in [-63..63], it is encoded as a single byte in [0x01..0x7F].  Observe that bit 7 is NOT set.  To
-//    get back the sample, subtract 64 from the encoded byte, then add the result to the value of the last sample on
-//    the current channel.  If the difference is in [-2048..-64, 64..2047], it is encoded as two bytes in the range
-//    [0x8800..0x8FC0, 0x9040..0x97FF], with the high byte first.  In this case bit 7 is set in the high byte -- that's
-//    how we distinguish between a one-byte and two-byte compressed datum.  To uncompress the two-byte datum, we pack
-//    the two bytes into a 16bit int, clear bit 15, and subtract 4096 to recover the difference, which is then added
-//    to the value of the last sample to get the current sample value.  OBSERVE that, if a given sample is compressed
-//    as one byte, it will never have the value 0x00; for a 2-byte compressed sample, the high byte is never 0x00.  In
-//    fact, CNTRLX uses the zero byte to mark the end of the compressed data stream.  We stop as soon as we reach this
-//    end-of-stream marker -- thus we will know exactly how many bytes were compressed and how many scans of real data
-//    were saved.
-//
-//    20jan2004: BUG FIX.  When the # of compressed bytes is an integer multiple of CX_RECORDBYTES, there is no "end of
-//    data" marker (the zero byte) in the compressed data buffer.  Prior to this fix, this method would abort
-//    before incrementing the scan counter for the last scan's worth of data.  As a result, readcxdata() warned that
-//    there was a mismatch between the #scans reported in the header and the actual number of scans read from file.
-//
-//    08jul2004: Cntrlx uses the byte value 0xFF rather than 0 as the "endOfData" mark in Continuous mode files, while
-//    it uses 0 for Trial mode files.  Maestro uses 0 as the "endOfData" mark always.  To decompress Cntrlx-generated
-//    Continuous mode files properly, we check for the presence of either of these markers.  The compression algorithm
-//    guarantees that 0xFF will never appear as the value of a 1-byte compressed sample, nor as the first byte of a
-//    2-byte compressed sample.
-//
-//    ARGS:       pDst     -- [out] pre-allocated buffer to hold the uncompressed data stream in "channel-scan order".
-//                iDstSz   -- [in] total # of samples that can be stored in uncompressed data buffer.
-//                pSrc     -- [in] compressed data stream buffer.
-//                iSrcSz   -- [in] size of compressed data buffer.
-//                nCh      -- [in] # of AI channels that were recorded.
-//                pNC      -- [out] total # of compressed bytes found (zero byte marks end of stream!)
-//                pNScans  -- [out] total # of complete scans found in uncompressed data stream.  The total # of
-//                            samples is this # times the # of channels recorded.
-//
-//    RETURNS:    NONE.
-//
-void uncompressAIData( double* pDst, int iDstSz, char* pSrc, int iSrcSz, int nCh, int* pNC, int* pNScans )
-{
-   int i;
-   int iLastSample[CXH_MAXAI];
-   char cByte;
-   short shTemp;
-   int nSrc;
-   int nScans;
-
-   memset( iLastSample, 0, CXH_MAXAI*sizeof(int) );                     // all channels read 0 at t = 0!
-
-   nScans = 0;                                                          // # of complete channel scans found
-   nSrc = 0;                                                            // # of compressed bytes processed
-
-   while( nSrc < iSrcSz )                                               // uncompress the data stream
-   {
-      if( (nScans+1)*nCh > iDstSz )                                     //    oops, not enough room left in output buf
-      {                                                                 //    for the next scan's worth of samples
-         *pNC = nSrc;
-         *pNScans = nScans;
-         return;
-      }
-
-      for( i = 0; i < nCh; i++ )                                        //    do one channel scan's worth at a time
-      {
-         if( nSrc == iSrcSz || pSrc[nSrc] == 0 || pSrc[nSrc] == -1 )    //    oops, we've either hit end of input
-         {                                                              //    buffer or got "endOfData" mark
-            *pNC = nSrc;
-            *pNScans = nScans;
-            return;
-         }
-
-         cByte = pSrc[nSrc++];                                          //    read in the next byte
-         if( cByte & 0x080 )                                            //    if bit7 set, next datum is 2 bytes
-         {
-            if( nSrc == iSrcSz )                                        //    should NEVER happen, but just in case...
-            {
-               *pNC = nSrc;
-               *pNScans = nScans;
-               return;
-            }
-            shTemp = (cByte & 0x7F);
-            shTemp <<= 8;
-            shTemp |= 0x00FF & ((short) pSrc[nSrc++]);
-            shTemp -= 4096;
-            iLastSample[i] += shTemp;                                   //    datum is difference from last sample!
-         }
-         else                                                           //    if bit 7 clear, next datum is 1 byte
-         {
-            shTemp = cByte - 64;
-            iLastSample[i] += shTemp;
-         }
-
-         pDst[nScans*nCh+i] = (double)iLastSample[i];                   //    save uncompressed sample in output buf
-      }
-      ++nScans;
-   }
-
-   *pNC = nSrc;
-   *pNScans = nScans;
-}
-
-
 //=== writeSpikewave ================================================================================================== 
 //
 //    Writes the new compressed 25KHz spike waveform from the internal buffer to the temporary file. It assumes that 
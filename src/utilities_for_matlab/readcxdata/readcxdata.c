@@ -202,6 +202,29 @@
 // 18dec2024-- Revised to handle data file format change for Maestro 5.0.2 (data file version 25). Target definition
 // record format was altered by the addition of the float-valued parameter 'fDotDisp' to the RMVTGTDEF structure
 // defined in rmvideo_common.h.
+// 16oct2026-- File access moved to the standalone reader in cxdatalib.c, which is shared with the command-line batch
+// reader CXDATABATCH. The data file is now memory-mapped (or read into memory in a single call) rather than read one
+// record at a time, and each record is processed in place. AI/spike waveform decompression, formerly done here by
+// uncompressAIData(), is now cxdUncompressAI(). Build:  mex readcxdata.c cxdatalib.c pertmgr.c noisyem.c
+//          -- AI and spike waveform data are now decompressed by cxdDecodeAI16() into a temporary array of 16-bit
+// samples, and converted to double only as they are copied into the MATLAB output arrays. Previously the temporary
+// array was itself double-valued, 4x the size -- a considerable load for a long 25KHz spike waveform.
+//          -- Added optional 4th argument 'opts' for selective decoding: a subset of AI channels ('chans'), a time
+// window in ms ('window') and/or a tagged section ('section'), and the output fields to build ('fields'). When a
+// window or channel subset is requested, the file has no edit actions and the trial codes need not be processed --
+// always the case for a ContMode file -- AI data is decoded only for the window, by cxdDecodeAIScans16(), and only
+// the AI records that could hold it are read. In that case the #AI bytes and scans reported in the file header are
+// not verified against the data; without a window or channel subset, the entire stream is decoded and the header
+// corrected as before, so the 'key' output is unchanged.
+// Otherwise, everything is decoded as before and the selection applied to the finished output (processTrialCodes()
+// and cutVelocityTraces() need the entire recording). The spike waveform is always decoded only for the window, and
+// processTrialCodes() is skipped entirely if none of the output fields it contributes to is requested. Added output
+// field 'window'. See applySelection().
+//          -- JMWork's sorted-spike train edits (ACTION_ADDSORTSPK, ACTION_REMOVESORTSPK) are no longer replayed one
+// at a time, each a search of the spike train plus a shift of everything after the edited spike -- which took minutes
+// for a heavily curated unit. processEdits() now collects them, and applySortedSpikeEdits() sorts them once and
+// rebuilds each edited train in a single merge pass, via cxdSortSpikeEdits() and cxdMergeSpikeEdits(). The edited
+// trains are identical to those produced by the one-at-a-time replay.
 //=====================================================================================================================
 
 #include <stdio.h>
@@ -214,6 +237,7 @@
 #include "pertmgr.h"          // this module handles most details of processing TARGET_PERTURB trial codes
 #include "noisyem.h"          // emulation of XYScope OR RMVideo "noisy dots" targets in trial mode
 #include "readcxdata.h"       // look here for all relevant constants, structure definitions
+#include "cxdatalib.h"        // standalone data file reader: file access, record indexing, AI decompression
 
 
 //=====================================================================================================================
@@ -223,6 +247,7 @@
 CXFILEDATA cxData;            // data & info records in Maestro/Cntrlx file are parsed into members of this data struct
 int iVerbose;                 // if nonzero, printf's inform user of progress in reading data file (for debug)
 BOOL isBigEndian;             // TRUE if system is big-endian, in which case endian conversions are necessary!
+SELECTOPTS selOpts;           // selective decode options, from the optional 'opts' argument
 
 MPERTMGR G_pertMgr;           // processes perturbations (TARGET_PERTURB) of trial target trajectories
 
@@ -238,7 +263,6 @@ const int RECORDSZ = 1024;    // size of each record in a Maestro/Cntrlx data fi
 // FUNCTIONS DEFINED IN THIS MODULE
 //=====================================================================================================================
 void usage();
-BOOL getNumRecordsInFile( FILE* pFile );
 void displayHeader();
 BOOL allocBuffers( BOOL bNoHeader );
 void freeBuffers();
@@ -251,7 +275,6 @@ void endianSwapTgtDefV24(CXFILETGT_V24* pTgt);
 void endianSwapTgtDef( CXFILETGT* pTgt );
 
 BOOL readAI( CXFILEREC* pRec );
-void uncompressAIData( double* pDst, int iDstSz, char* pSrc, int iSrcSz, int nCh, int* pNC, int* pNScans );
 
 BOOL readEvents( CXFILEREC* pRec );
 BOOL readOthers( CXFILEREC* pRec );
@@ -271,8 +294,7 @@ void setTrialInfo(mxArray* pOut);
 
 BOOL processEdits( mxArray* pOut );
 void unpackTagLabel(char* sbuf, int* pLabelInts);
-void removeSortedSpike(int ch, int tSpk);
-void addSortedSpike(int ch, int tSpk);
+void applySortedSpikeEdits( PCXDSPIKEEDIT pEdits, int nEdits );
 void cutVelocityTraces( mxArray* pOut );
 void initializeNoisyDotsEmulator();
 BOOL shouldAdjustPatternMotionAtSegStart(int pos);
@@ -281,18 +303,30 @@ BOOL processTrialCodes( mxArray* pOut );
 void prepareTgtIDs();
 int mapTargetID( short nID );
 
+BOOL parseSelectOpts( const mxArray* pOpts );
+BOOL isFieldSelected( const char* name );
+int getScanIntvUS();
+BOOL getTagSectionTimes( int iSect, int* pStart, int* pLen );
+BOOL resolveWindow();
+BOOL setSelectedData( mxArray* pOut );
+void replaceField( mxArray* pStruct, const char* name, mxArray* pNew );
+mxArray* selectByTime( const mxArray* pArr, BOOL bVector, int iCol, int iEndCol, double t0, double t1 );
+void applySelection( mxArray* pOut );
+
 
 
 //=== mexFunction (readcxdata) ========================================================================================
 //
 //    This is the method called from MATLAB to read in CNTRLX data files.
 //
-//       readcxdata( 'filename' [, verbose, nchans] )
+//       readcxdata( 'filename' [, verbose, nchans, opts] )
 //       where:
 //          'filename'  ==> pathname of the CNTRLX data file.
 //          verbose     ==> if nonzero, detailed progress msgs are written to STDOUT (for debugging).
 //          nchans      ==> for headerless ContMode data files, we need to know how many analog data channels were
-//                          recorded in order to properly parse the compressed analog data in the file.
+//                          recorded in order to properly parse the compressed analog data in the file. Otherwise
+//                          ignored; may be [].
+//          opts        ==> selective decode options (see usage() and parseSelectOpts()).
 //
 //    ARGS:       nlhs, plhs  -- [out] array output ("left-hand side") containing data/info in the file.  We EXPECT
 //                               nlhs==1, since readcxdata() returns everything in a single data structure as described
@@ -306,11 +340,13 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
 {
    int i,j;
    BOOL bOk, bNeedBlinkEnd;
-   BYTE recID;                                                          // first byte of a data file record is its "ID"
-   CXFILEREC fileRec;                                                   // a generic CNTRLX data file record
+   BOOL bNeedTrialCodes;                                                // FALSE if trial codes need not be processed
+   int iFirst, n;
+   CXFILEREC* pRec;                                                     // a generic CNTRLX data file record
    char strFileName[1024];                                              // data file's pathname
-   FILE* pFile;                                                         // pointer to open data file
+   CXDFILE cxdFile;                                                     // the open (memory-mapped) data file
    double* pdData;
+   short* pshData;
 
    BOOL bHeaderless;                                                    // TRUE for headerless ContMode data file
    CXFILEHDR* pHdr;                                                     // pointer to stored header record
@@ -327,7 +363,7 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
    memset( (VOID*) &cxData, 0, sizeof(CXFILEDATA) );                    // init internal representation of file content
    pHdr = &(cxData.fileHdr);                                            // ptr to data file header in internal storage
 
-   if( nrhs < 1 || nrhs > 3 || nlhs != 1 )                              // check input/output args
+   if( nrhs < 1 || nrhs > 4 || nlhs != 1 )                              // check input/output args
    {
       usage();
       return;
@@ -344,41 +380,33 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
    if( iVerbose )
       printf( "Host is %s-endian!\n", isBigEndian ? "big" : "little" );
 
-   mxGetString( prhs[0], strFileName, mxGetN(prhs[0])+1 );              // get file's pathname
-
-   if( (pFile = fopen( strFileName, "rb" )) == NULL )                   // open the data file
+   if( !parseSelectOpts( (nrhs >= 4) ? prhs[3] : NULL ) )              // get selective decode options, if any
    {
-      printf( "ERROR: Could not open %s\n", strFileName );
+      usage();
       return;
    }
-   if( iVerbose ) printf( "Opened %s\n", strFileName );
 
-   if( !getNumRecordsInFile( pFile ) )                                  // determine #records in the file
-   {
-      fclose( pFile );
+   mxGetString( prhs[0], strFileName, mxGetN(prhs[0])+1 );              // get file's pathname
+
+   if( !cxdOpen( &cxdFile, strFileName ) )                              // open (map) the data file and index its
+   {                                                                    // records
+      printf( "ERROR: %s (%s)\n", cxdFile.errMsg, strFileName );
       return;
    }
+   if( iVerbose ) printf( "Opened %s\n", strFileName );
 
+   cxData.nRecords = cxdFile.nRecords;
    if( iVerbose ) printf( "File contains %i records.\n", cxData.nRecords );
 
-   if( fread( (VOID*) &fileRec, RECORDSZ, 1, pFile ) == 0 )             // read header record into temporary buffer
-   {
-      printf( "ERROR: reading header record in file %s\n", strFileName );
-      fclose( pFile );
-      return;
-   }
-
-   bHeaderless = FALSE;
-   recID = fileRec.idTag[0];
-   if( (fileRec.idTag[1] == 0) &&                                       // if this is a headerless ContMode data file:
-       (recID <= CX_XWORKACTIONREC || recID == CX_V1TGTRECORD) )
+   bHeaderless = cxdFile.bHeaderless;
+   if( bHeaderless )                                                    // if this is a headerless ContMode data file:
    {
       bHeaderless = TRUE;
       if( iVerbose ) printf( "This is a headerless ContMode file.\n" );
-      if( nrhs < 3 )                                                    //    user MUST specify the # of AI channels
+      if( nrhs < 3 || mxIsEmpty( prhs[2] ) )                            //    user MUST specify the # of AI channels
       {                                                                 //    that were recorded!
          usage();
-         fclose( pFile );
+         cxdClose( &cxdFile );
          return;
       }
 
@@ -402,7 +430,7 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
    }
    else                                                                 // for data files possessing header record:
    {
-      memcpy( (VOID*) pHdr, (VOID*) &fileRec, RECORDSZ );               //    copy header into internal storage
+      memcpy( (VOID*) pHdr, (VOID*) cxdGetHeader( &cxdFile ), RECORDSZ );//    copy header into internal storage
       if( isBigEndian ) endianSwapHeader( pHdr );                       //    convert endianness if necessary
       if( pHdr->version < 1 )                                           //    for file versions < 1, the int-valued
       {                                                                 //    counters did not exist.  here we set them
@@ -416,7 +444,7 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
    if( pHdr->nchans < 0 || pHdr->nchans > CXH_MAXAI )                   // check for illegal # of recorded AI channels
    {
       printf( "ERROR: %i channels recorded (max = %i).\n", pHdr->nchans, CXH_MAXAI );
-      fclose( pFile );
+      cxdClose( &cxdFile );
       return;
    }
 
@@ -424,73 +452,92 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
        (pHdr->nScansSaved < 0 || pHdr->nBytesCompressed < 0) )
    {
       printf( "ERROR: bad data length (nScans = %i, nBytes = %i).\n", pHdr->nScansSaved, pHdr->nBytesCompressed );
-      fclose( pFile );
+      cxdClose( &cxdFile );
+      return;
+   }
+
+   bNeedTrialCodes =                                                    // trial codes are processed only if needed
+      (cxdGetNumRecordsOfKind( &cxdFile, CXD_TRIALCODE ) > 0) &&        // for a requested output field or to find
+      (selOpts.section[0] != '\0' || isFieldSelected( "targets" ) ||   // the tagged section defining the window
+       isFieldSelected( "tgtdefns" ) || isFieldSelected( "tagSections" ) || isFieldSelected( "trialInfo" ) ||
+       isFieldSelected( "xynoisy" ) || isFieldSelected( "xynoisytimes" ));
+
+   selOpts.bDirect = (selOpts.bWindow || selOpts.bChanSubset) &&       // if only part of the AI data is requested
+      (!bHeaderless) && (!bNeedTrialCodes) &&                           // and nothing else needs the entire stream,
+      (cxdGetNumRecordsOfKind( &cxdFile, CXD_ACTION ) == 0);            // decode only the selected part. otherwise
+                                                                        // decode it all, which also verifies the
+                                                                        // AI byte & scan counts in the file header
+
+   if( selOpts.section[0] != '\0' && cxdGetNumRecordsOfKind( &cxdFile, CXD_TAGSECT ) == 0 )
+   {
+      printf( "ERROR: Tagged section '%s' not found.\n", selOpts.section );
+      cxdClose( &cxdFile );
       return;
    }
+   if( selOpts.bWindow && selOpts.section[0] == '\0' )                 // a window in ms is resolved immediately;
+      resolveWindow();                                                  // a tagged section after trial code proc
 
    if( !allocBuffers( bHeaderless ) )                                   // alloc internal bufs to receive file data
    {
       printf( "ERROR:  Unable to allocate internal buffers.\n" );
       freeBuffers();
-      fclose( pFile );
+      cxdClose( &cxdFile );
       return;
    }
 
 
-   for( i = (bHeaderless) ? 0 : 1; i < cxData.nRecords; i++)            // read in & process one record at a time:
-   {
-      if( i > 0 )                                                       //    read record into byte buffer; we don't
-      {                                                                 //    need to do so for the first record in
-         if( fread( (VOID*) &fileRec, RECORDSZ, 1, pFile ) == 0 )       //    a headerless file, since we already read
-         {                                                              //    it in earlier!
-            printf( "ERROR: Reading record %i in file %s\n", i, strFileName );
-            freeBuffers();
-            fclose( pFile );
-            return;
-         }
-      }
+   for( i = (bHeaderless) ? 0 : 1; i < cxData.nRecords; i++)            // process one record at a time, in place.
+   {                                                                    // the mapping is private, so any endian
+      pRec = cxdGetRecord( &cxdFile, i );                               // conversion does not touch the file itself
 
       if( iVerbose )                                                    //    report record id tag (first 8 bytes)
       {
          printf( "ID tag for record %i: ", i );
-         for( j = 0; j < 8; j++ ) printf( "%i ", (UINT) fileRec.idTag[j] );
+         for( j = 0; j < 8; j++ ) printf( "%i ", (UINT) pRec->idTag[j] );
          printf( "\n" );
       }
 
       bOk = TRUE;
-      switch( fileRec.idTag[0] )                                        //    process record IAW data type...
+      switch( pRec->idTag[0] )                                        //    process record IAW data type...
       {
-         case CX_AIRECORD :
+         case CX_AIRECORD :                                             //    (if decoding directly, skip AI records
+            if( selOpts.bDirect && (!isFieldSelected( "data" ) ||       //    that are not needed: every sample takes
+                (selOpts.iEndScan >= 0 &&                               //    at least one byte, at most two)
+                 cxData.nAIBytes >= 2 * pHdr->nchans * selOpts.iEndScan)) )
+               break;
+            bOk = readAI( pRec );
+            break;
          case CX_SPIKEWAVERECORD :
-            bOk = readAI( &fileRec );
+            if( !isFieldSelected( "spikewave" ) ) break;
+            bOk = readAI( pRec );
             break;
          case CX_EVENT0RECORD :
          case CX_EVENT1RECORD :
-            bOk = readEvents( &fileRec );
+            bOk = readEvents( pRec );
             break;
          case CX_OTHEREVENTRECORD :
-            bOk = readOthers( &fileRec );
+            bOk = readOthers( pRec );
             break;
          case CX_TRIALCODERECORD :
-            bOk = readTrialCodes( &fileRec );
+            bOk = readTrialCodes( pRec );
             break;
          case CX_XWORKACTIONREC :
-            bOk = readEdits( &fileRec );
+            bOk = readEdits( pRec );
             break;
          case CX_TGTRECORD :
-            bOk = readTargets( &fileRec );
+            bOk = readTargets( pRec );
             break;
          case CX_STIMRUNRECORD :
             if(iVerbose)
                printf("Skipping stimulus run record! Not supported.\n");
             break;
          case CX_TAGSECTRECORD :
-            bOk = readTagSections( &fileRec );
+            bOk = readTagSections( pRec );
             break;
          default :                                                      //    sorted spike train records have
-            if( fileRec.idTag[0] >= CX_SPIKESORTREC_FIRST &&            //    a range of record id tags...
-                fileRec.idTag[0] <= CX_SPIKESORTREC_LAST )
-               bOk = readSortedSpikes( &fileRec );
+            if( pRec->idTag[0] >= CX_SPIKESORTREC_FIRST &&            //    a range of record id tags...
+                pRec->idTag[0] <= CX_SPIKESORTREC_LAST )
+               bOk = readSortedSpikes( pRec );
             else if( iVerbose)
                printf( "Skipped record!\n" );
             break;
@@ -499,12 +546,12 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
       if( !bOk )                                                        //    abort if an error (memory realloc)
       {                                                                 //    occurred while processing a record
          freeBuffers();
-         fclose( pFile );
+         cxdClose( &cxdFile );
          return;
       }
    }
 
-   fclose( pFile );                                                     // close the file
+   cxdClose( &cxdFile );                                                // close the file
 
    if( iVerbose )                                                       // report some results
    {
@@ -591,15 +638,23 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
       cxData.pdBlinks = NULL;
    }
 
-   if( pHdr->nchans > 0 && cxData.nAIBytes == 0 )                       // expected AI data in file but found none!
+   if( selOpts.bDirect )                                                // decode selected AI chans & window only
+   {
+      if( pHdr->nchans > 0 && cxData.nAIBytes > 0 && !setSelectedData( plhs[0] ) )
+      {
+         freeBuffers();
+         return;
+      }
+   }
+   else if( pHdr->nchans > 0 && cxData.nAIBytes == 0 )                  // expected AI data in file but found none!
    {
       if( iVerbose ) printf( "WARNING: Expected but found no AI data in file!\n" );
    }
    else if( pHdr->nchans > 0 )                                          // uncompress AI channel data into output array
    {
-      pdData =                                                          //    uncompress the data into a temp array so
-         (double*) malloc( sizeof(double) * cxData.nAIBytes );          //    we can verify #scans saved.  this is esp.
-      uncompressAIData( pdData, cxData.nAIBytes,                        //    important for headerless files, since we
+      pshData =                                                         //    uncompress the data into a temp array so
+         (short*) malloc( sizeof(short) * cxData.nAIBytes );            //    we can verify #scans saved.  this is esp.
+      cxdDecodeAI16( pshData, cxData.nAIBytes,                          //    important for headerless files, since we
          cxData.pcAIData, cxData.nAIBytes, pHdr->nchans, &i, &j );      //    have no idea how many scans were saved!
 
       if( bHeaderless )                                                 //    for such files we did not know #bytes
@@ -634,10 +689,10 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
       mxSetField( plhs[0], 0, "data",                                   //    create #ch x #scans output matrix
                   mxCreateDoubleMatrix( pHdr->nchans, pHdr->nScansSaved, mxREAL ) );
       i = ((int)pHdr->nchans) * pHdr->nScansSaved;
-      memcpy( (void*) mxGetPr( mxGetField( plhs[0], 0, "data" ) ),      //    and copy data from tmp array into matrix
-              (void*) pdData, sizeof(double) * i );
+      pdData = mxGetPr( mxGetField( plhs[0], 0, "data" ) );             //    and copy data from tmp array into matrix
+      for( j = 0; j < i; j++ ) pdData[j] = (double) pshData[j];
 
-      free( pdData );                                                   //    free the temp array
+      free( pshData );                                                  //    free the temp array
    }
 
 
@@ -657,14 +712,14 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
 
    // output all sorted spike train channel data. THIS MUST BE CALLED AFTER processEdits(), which will alter any sorted 
    // spike trains found IAW any "spike-edit" actions found among the action codes read from the file!!!
-   setSortedSpikesOutput( plhs[0] );
+   if( isFieldSelected( "sortedSpikes" ) ) setSortedSpikesOutput( plhs[0] );
 
    // before processing trial codes (if any), initialize the noisy-dots target emulator so that it is in a valid 
    // state. If this is not a trial data file, or if the trial did not use any noisy-dots targets, then the emulator
    // won't be used.
    initializeNoisyDotsEmulator();
    
-   if( cxData.nCodes > 0 )                                              // process trial codes, filling out relevant
+   if( cxData.nCodes > 0 && bNeedTrialCodes )                           // process trial codes, filling out relevant
    {                                                                    // fields in MATLAB output structure...
       if( iVerbose )
          printf( "Processing %i trial codes...\n", cxData.nCodes );
@@ -684,20 +739,37 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
    // AFTER processTrialCodes(), which may need the original eye velocity trajectories to do vel stab of targets!
    cutVelocityTraces( plhs[0] );
    
-   setTagSections( plhs[0] );                                           // store info on any tagged sections found
-   setTrialInfo(plhs[0]);                                               // store additional trial info (as of 20Jan09)
-   setTargetDefns( plhs[0] );                                           // store target defns
+   if( isFieldSelected( "tagSections" ) ) setTagSections( plhs[0] );    // store info on any tagged sections found
+   if( isFieldSelected( "trialInfo" ) ) setTrialInfo(plhs[0]);          // store additional trial info (as of 20Jan09)
+   if( isFieldSelected( "tgtdefns" ) ) setTargetDefns( plhs[0] );       // store target defns
+
+   if( selOpts.bWindow && selOpts.iFirstScan < 0 && !resolveWindow() )  // resolve window defined by tagged section
+   {
+      freeBuffers();
+      return;
+   }
 
    if( cxData.nFastBytes > 0 )                                          // uncompress spike waveform into output array:
    {
-      pdData =                                                          //    uncompress the data into a temp array so
-         (double*) malloc( sizeof(double) * cxData.nFastBytes );        //    we can determin #samples saved before
-      uncompressAIData( pdData, cxData.nFastBytes,                      //    allocating MATLAB array...
-               cxData.pcFastData, cxData.nFastBytes, 1, &i, &j );
+      iFirst = 0;                                                       //    the samples in the time window, if any;
+      n = cxData.nFastBytes;                                            //    else all of them (at most one per byte)
+      if( selOpts.bWindow )
+      {
+         j = (pHdr->nSpikeSampIntvUS > 0) ? pHdr->nSpikeSampIntvUS : 40;
+         iFirst = (int) floor( selOpts.t0 * 1000.0 / j );
+         if( selOpts.t1 >= 0 ) n = ((int) ceil( selOpts.t1 * 1000.0 / j )) - iFirst;
+         if( n > cxData.nFastBytes ) n = cxData.nFastBytes;
+         if( n < 0 ) n = 0;
+      }
+
+      pshData =                                                         //    uncompress the data into a temp array so
+         (short*) malloc( sizeof(short) * (n + 1) );                    //    we can determin #samples saved before
+      cxdDecodeAIScans16( pshData, cxData.pcFastData,                   //    allocating MATLAB array...
+               cxData.nFastBytes, 1, iFirst, n, &i, &j );
 
       free( cxData.pcFastData ); cxData.pcFastData = NULL;              //    free the original compressed data buffer
 
-      if( pHdr->nSpikeBytesCompressed != i )                            //    # "fast" bytes compressed incorrect in
+      if( !selOpts.bWindow && pHdr->nSpikeBytesCompressed != i )        //    # "fast" bytes compressed incorrect in
       {                                                                 //    header; inform user & correct.
          if( iVerbose )
             printf( "WARNING: File header misreported # spike waveform bytes compressed: reported = %i, actual = %i\n",
@@ -708,12 +780,14 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
 
       mxSetField( plhs[0], 0, "spikewave",                              //    create output array
                   mxCreateDoubleMatrix( 1, j, mxREAL ) );
-      memcpy( (void*) mxGetPr( mxGetField( plhs[0], 0, "spikewave" ) ), //    and copy data from tmp array into it
-              (void*) pdData, sizeof(double) * j );
+      pdData = mxGetPr( mxGetField( plhs[0], 0, "spikewave" ) );        //    and copy data from tmp array into it
+      for( i = 0; i < j; i++ ) pdData[i] = (double) pshData[i];
 
-      free( pdData );                                                   //    free the temp array
+      free( pshData );                                                  //    free the temp array
    }
 
+   applySelection( plhs[0] );                                           // apply selective decode options, if any
+
    freeBuffers();                                                       // make sure all alloc'd memory has been freed
 }
 
@@ -724,53 +798,15 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
 //
 void usage()
 {
-  printf( "USAGE: d = readcxdata( 'filename' [,verbose, nchans]) \n" );
+  printf( "USAGE: d = readcxdata( 'filename' [,verbose, nchans, opts]) \n" );
   printf( "   filename --> pathname of CNTRLX data file \n" );
   printf( "   verbose  --> if nonzero, fcn prints detailed progress messages \n" );
   printf( "   nchans   --> #AI chans recorded [0..16]; req'd only for *headerless* ContMode files (pre-Dec2001) \n" );
-}
-
-
-//=== getNumRecordsInFile =============================================================================================
-//
-//    Determines file length by seeking EOF and reading file position, then sets #records accordingly.  Assumes file
-//    is opened in binary (vs text) mode, and returns file ptr to the file's beginning upon successful return.
-//
-//    ARGS:       pFile -- [in] open file pointer.
-//
-//    RETURNS:    TRUE if successful, FALSE otherwise (a fatal error -- appropriate error msg printed to STDOUT).
-//
-BOOL getNumRecordsInFile( FILE* pFile )
-{
-   long nFileBytes;
-
-   if( fseek( pFile, 0, SEEK_END ) != 0 )                               // seek to end of file
-   {
-      printf( "ERROR: Could not seek to end of file.\n" );
-      return( FALSE );
-   }
-
-   nFileBytes = ftell( pFile );                                         // end of file pos = file len in bytes if it is
-   if( nFileBytes == -1L )                                              // opened in binary mode
-   {
-      printf( "ERROR: Unable to read file ptr position.\n" );
-      return( FALSE );
-   }
-
-   if( (nFileBytes % RECORDSZ) != 0 )                                   // there should always be an integral # of
-   {                                                                    // data records in a CNTRLX data file!
-      printf( "ERROR: File does not have an integral # of %i-byte records; filesize = %i.\n", RECORDSZ, nFileBytes );
-      return( FALSE );
-   }
-
-   if( fseek( pFile, 0, SEEK_SET ) != 0 )                               // restore file ptr to file's beginning
-   {
-      printf( "ERROR: Could not seek to beginning of file.\n" );
-      return( FALSE );
-   }
-
-   cxData.nRecords = (int) (nFileBytes/((long)RECORDSZ));               // calc #records in file
-   return( TRUE );
+  printf( "   opts     --> selective decode options, a struct with any of these fields: \n" );
+  printf( "      chans   : AI channel #s [0..15] to include in 'data' (key.nchans, key.chlist are adjusted) \n" );
+  printf( "      window  : [t0 t1] in ms since recording started; t1 = Inf for end of recording \n" );
+  printf( "      section : name of a tagged section; 'window', if given, is then relative to section start \n" );
+  printf( "      fields  : cell array of names of the output fields to build; all others are left empty \n" );
 }
 
 
@@ -1564,110 +1600,6 @@ BOOL readAI( CXFILEREC* pRec )
 }
 
 
-//=== uncompressAIData ================================================================================================
-//
-//    Uncompress a CNTRLX analog input byte stream sampling the specified number N of AI channels.  When more than one
-//    channel is recorded, the data are stored in the output buffer as [ch1(0), ..., chN(0), ch1(1), ..., ch1(N), ...].
-//    Uncompressed data is in the range of a 12bit analog-to-digital converter: [-2048..2047].
-//
-//    Compression algorithm:  Each compressed sample represents the DIFFERENCE from the previous sample.  If this
-//    difference is in [-63..63], it is encoded as a single byte in [0x01..0x7F].  Observe that bit 7 is NOT set.  To
-//    get back the sample, subtract 64 from the encoded byte, then add the result to the value of the last sample on
-//    the current channel.  If the difference is in [-2048..-64, 64..2047], it is encoded as two bytes in the range
-//    [0x8800..0x8FC0, 0x9040..0x97FF], with the high byte first.  In this case bit 7 is set in the high byte -- that's
-//    how we distinguish between a one-byte and two-byte compressed datum.  To uncompress the two-byte datum, we pack
-//    the two bytes into a 16bit int, clear bit 15, and subtract 4096 to recover the difference, which is then added
-//    to the value of the last sample to get the current sample value.  OBSERVE that, if a given sample is compressed
-//    as one byte, it will never have the value 0x00; for a 2-byte compressed sample, the high byte is never 0x00.  In
-//    fact, CNTRLX uses the zero byte to mark the end of the compressed data stream.  We stop as soon as we reach this
-//    end-of-stream marker -- thus we will know exactly how many bytes were compressed and how many scans of real data
-//    were saved.
-//
-//    20jan2004: BUG FIX.  When the # of compressed bytes is an integer multiple of CX_RECORDBYTES, there is no "end of
-//    data" marker (the zero byte) in the compressed data buffer.  Prior to this fix, this method would abort
-//    before incrementing the scan counter for the last scan's worth of data.  As a result, readcxdata() warned that
-//    there was a mismatch between the #scans reported in the header and the actual number of scans read from file.
-//
-//    08jul2004: Cntrlx uses the byte value 0xFF rather than 0 as the "endOfData" mark in Continuous mode files, while
-//    it uses 0 for Trial mode files.  Maestro uses 0 as the "endOfData" mark always.  To decompress Cntrlx-generated
-//    Continuous mode files properly, we check for the presence of either of these markers.  The compression algorithm
-//    guarantees that 0xFF will never appear as the value of a 1-byte compressed sample, nor as the first byte of a
-//    2-byte compressed sample.
-//
-//    ARGS:       pDst     -- [out] pre-allocated buffer to hold the uncompressed data stream in "channel-scan order".
-//                iDstSz   -- [in] total # of samples that can be stored in uncompressed data buffer.
-//                pSrc     -- [in] compressed data stream buffer.
-//                iSrcSz   -- [in] size of compressed data buffer.
-//                nCh      -- [in] # of AI channels that were recorded.
-//                pNC      -- [out] total # of compressed bytes found (zero byte marks end of stream!)
-//                pNScans  -- [out] total # of complete scans found in uncompressed data stream.  The total # of
-//                            samples is this # times the # of channels recorded.
-//
-//    RETURNS:    NONE.
-//
-void uncompressAIData( double* pDst, int iDstSz, char* pSrc, int iSrcSz, int nCh, int* pNC, int* pNScans )
-{
-   int i;
-   int iLastSample[CXH_MAXAI];
-   char cByte;
-   short shTemp;
-   int nSrc;
-   int nScans;
-
-   memset( iLastSample, 0, CXH_MAXAI*sizeof(int) );                     // all channels read 0 at t = 0!
-
-   nScans = 0;                                                          // # of complete channel scans found
-   nSrc = 0;                                                            // # of compressed bytes processed
-
-   while( nSrc < iSrcSz )                                               // uncompress the data stream
-   {
-      if( (nScans+1)*nCh > iDstSz )                                     //    oops, not enough room left in output buf
-      {                                                                 //    for the next scan's worth of samples
-         *pNC = nSrc;
-         *pNScans = nScans;
-         return;
-      }
-
-      for( i = 0; i < nCh; i++ )                                        //    do one channel scan's worth at a time
-      {
-         if( nSrc == iSrcSz || pSrc[nSrc] == 0 || pSrc[nSrc] == -1 )    //    oops, we've either hit end of input
-         {                                                              //    buffer or got "endOfData" mark
-            *pNC = nSrc;
-            *pNScans = nScans;
-            return;
-         }
-
-         cByte = pSrc[nSrc++];                                          //    read in the next byte
-         if( cByte & 0x080 )                                            //    if bit7 set, next datum is 2 bytes
-         {
-            if( nSrc == iSrcSz )                                        //    should NEVER happen, but just in case...
-            {
-               *pNC = nSrc;
-               *pNScans = nScans;
-               return;
-            }
-            shTemp = (cByte & 0x7F);
-            shTemp <<= 8;
-            shTemp |= 0x00FF & ((short) pSrc[nSrc++]);
-            shTemp -= 4096;
-            iLastSample[i] += shTemp;                                   //    datum is difference from last sample!
-         }
-         else                                                           //    if bit 7 clear, next datum is 1 byte
-         {
-            shTemp = cByte - 64;
-            iLastSample[i] += shTemp;
-         }
-
-         pDst[nScans*nCh+i] = (double)iLastSample[i];                   //    save uncompressed sample in output buf
-      }
-      ++nScans;
-   }
-
-   *pNC = nSrc;
-   *pNScans = nScans;
-}
-
-
 //=== readEvents ======================================================================================================
 //
 //    Read digital event data from a CX_EVENT0RECORD or CX_EVENT1RECORD data file record into the appropriate internal
@@ -2907,18 +2839,7 @@ void setTagSections( mxArray* pOut )
       mxSetField( pMXSections, i, "firstSeg", createInt32Scalar( iFirstSeg ) );
       mxSetField( pMXSections, i, "lastSeg", createInt32Scalar( iLastSeg ) );
 
-      tStart = -1;                                                         //    if trial's segment info is valid,
-      tLen = -1;                                                           //    report section start time and len
-      if( iFirstSeg <= iLastSeg && cxData.nSegments > iLastSeg &&          //    relative to when recording started;
-          cxData.tRecordStarted >= 0 && cxData.tTrialLen > 0 &&            //    otherwise, both are set to -1.
-          !cxData.bSkipOccurred )
-      {
-         tStart = cxData.segStart[iFirstSeg] - cxData.tRecordStarted;
-         if( (iLastSeg + 1) < cxData.nSegments )
-            tLen = cxData.segStart[iLastSeg+1] - cxData.segStart[iFirstSeg];
-         else
-            tLen = cxData.tTrialLen - cxData.segStart[iFirstSeg];
-      }
+      getTagSectionTimes( i, &tStart, &tLen );                             //    section start time and length
       mxSetField( pMXSections, i, "tStart", createInt32Scalar( tStart ) );
       mxSetField( pMXSections, i, "tLen", createInt32Scalar( tLen ) );
    }
@@ -3018,7 +2939,8 @@ void setTrialInfo(mxArray* pOut)
 //             These actions are processed by actually modifying the sequences of spike arrival times that should have 
 //          already been stored in CXFILEDATA.pdSortedSpikes[]. THUS, IT IS ESSENTIAL that this method be called AFTER
 //          the entire file has been parsed and BEFORE the method setSortedSpikesOutput() is called to copy the 
-//          (possibly edited) spike trains into the output structure. See also: addSortedSpike(), removeSortedSpike().
+//          (possibly edited) spike trains into the output structure. The spike edits are collected as they are found,
+//          and all applied at once after the action list has been parsed. See applySortedSpikeEdits().
 //       ACTION_DEFTAG ==> [Introduced in JMWork 1.4.0, Sep2010]. Action code group defines a "tag", ie, a user-defined 
 //          label attached to the recorded timeline. Code following action ID is the timestamp in milliseconds. This
 //          is followed by 4 32-bit ints containing 16-byte label field, packed in little-endian order and padded with
@@ -3053,6 +2975,8 @@ BOOL processEdits( mxArray* pOut )
    int nMark2;                                              // # of SETMARK2 mark points found in edit buf
    int nMarks;                                              // # of mark segments found in edit buf
    int nTags;                                               // # of labelled tags found in edit buf
+   PCXDSPIKEEDIT pSpkEdits;                                 // holds all sorted-spike train edits found in edit buf
+   int nSpkEdits;                                           // # of sorted-spike train edits found in edit buf
    
    int discarded;                                           // nonzero if we find a discard mark among edits -- any 
                                                             // of the three recognized discard mark styles
@@ -3070,6 +2994,8 @@ BOOL processEdits( mxArray* pOut )
    if( nMarks < 1 ) nMarks = 1;
    nTags = cxData.nEdits / 6;
    if( nTags < 1 ) nTags = 1;
+   nSpkEdits = cxData.nEdits / 3;
+   if( nSpkEdits < 1 ) nSpkEdits = 1;
 
    // allocate temporary buffers for each annotation type based on worst-case counts
    pdCutStart = (double*) malloc( nCuts * sizeof(double) ); 
@@ -3079,18 +3005,19 @@ BOOL processEdits( mxArray* pOut )
    pdMark2 = (double*) malloc( nMark2 * sizeof(double) );
    pdMarks = (double*) malloc( nMarks*2 * sizeof(double) ); 
    pdTags = (PTAGMARK) malloc( nTags * sizeof(TAGMARK) );
+   pSpkEdits = (PCXDSPIKEEDIT) malloc( nSpkEdits * sizeof(CXDSPIKEEDIT) );
 
    // abort if we failed to allocate any buffer
    if(pdCutStart == NULL || pdCutEnd == NULL || pdCutChan == NULL || pdMark1 == NULL ||
-       pdMark2 == NULL || pdMarks == NULL || pdTags == NULL)
+       pdMark2 == NULL || pdMarks == NULL || pdTags == NULL || pSpkEdits == NULL)
    {
       free( pdCutStart ); free( pdCutEnd ); free( pdCutChan );
-      free( pdMark1 ); free( pdMark2 ); free( pdMarks ); free(pdTags);
+      free( pdMark1 ); free( pdMark2 ); free( pdMarks ); free(pdTags); free( pSpkEdits );
       printf( "ERROR: Memory allocation failure.\n" );
       return( FALSE );
    }
 
-   nCuts = nMark1 = nMark2 = nMarks = nTags = 0;
+   nCuts = nMark1 = nMark2 = nMarks = nTags = nSpkEdits = 0;
    discarded = 0; 
    explicitDiscard = 0;
    
@@ -3165,12 +3092,12 @@ BOOL processEdits( mxArray* pOut )
          break;
 
       case ACTION_REMOVESORTSPK:                            //    ACTION_REMOVESORTSPK spkTrainCh# spkT_10us
-         removeSortedSpike(cxData.piEdits[i+1], cxData.piEdits[i+2]);
-         i += 3;
-         break;
-
       case ACTION_ADDSORTSPK:                               //    ACTION_ADDSORTSPK spkTrainCh# spkT_10us
-         addSortedSpike(cxData.piEdits[i+1], cxData.piEdits[i+2]);
+         pSpkEdits[nSpkEdits].ch = cxData.piEdits[i+1];     //    (applied later, all at once)
+         pSpkEdits[nSpkEdits].t = cxData.piEdits[i+2];
+         pSpkEdits[nSpkEdits].seq = nSpkEdits;
+         pSpkEdits[nSpkEdits].bAdd = (BOOL) (cxData.piEdits[i] == ACTION_ADDSORTSPK);
+         ++nSpkEdits;
          i += 3;
          break;
          
@@ -3179,6 +3106,10 @@ BOOL processEdits( mxArray* pOut )
          break;
    }
 
+   // apply any sorted-spike train edits, in the order they were made
+   applySortedSpikeEdits( pSpkEdits, nSpkEdits );
+   free( pSpkEdits );
+
    // free internal buf for edit actions; we no longer need it.
    free(cxData.piEdits);
    cxData.piEdits = NULL;
@@ -3294,126 +3225,69 @@ void unpackTagLabel(char* sbuf, int* pLabelInts)
    }
 }
 
-//=== removeSortedSpike, addSortedSpike =============================================================================== 
-// 
-//    Helper methods that handle action codes ACTION_REMOVESORTSPK and ACTION_ADDSORTSPK for processEdits(). They 
-//    modify the corresponding sorted-spike train buffer in CXFILEDATA.pdSortedSpikes[ch], either removing a spike or 
-//    adding one -- while keeping the spikes in chronological order.
+//=== applySortedSpikeEdits ===========================================================================================
+//
+//    Helper method that handles action codes ACTION_REMOVESORTSPK and ACTION_ADDSORTSPK for processEdits(). It modifies
+//    the corresponding sorted-spike train buffers in CXFILEDATA.pdSortedSpikes[], removing and adding spikes -- while
+//    keeping the spikes in chronological order. The result is the same as if the edits were applied one at a time, in
+//    the order listed: if a spike is to be added and there's already a spike there, the edit does nothing; if a spike
+//    is to be removed and there is no spike at that time, the edit does nothing.
 //
 //    NOTES:
-//    1) This is an inefficient approach, since each invocation involves searching the spike train array and copying a 
-//    portion of it shifted one element forward or backward. Spike edits are relatively rare, so we'll leave it this
-//    way for now.
-//    2) IMPORTANT: While processing sorted-spike train records, interspike intervals are converted from an integer 
-//    number of 10us ticks to a double-valued elapsed time in milliseconds. Each spike edit time is saved in the action 
-//    record as an integer-valued elapsed time in 10us ticks and here it is converted to a double-value in milliseconds 
-//    for comparison with the sorted spike times that are in CXFILEDATA.pdSortedSpikes[]. These operations can 
-//    introduce a very tiny error, so that the test for equality between double values might fail even though the two 
-//    times are much less than 1us apart. (I actually encountered this problem during testing!) Therefore, both methods 
-//    assume equality if the absolute value of the difference is less than 0.001ms (ie, 1us). 
-//
-//    ARGS:    ch -- The sorted-spike train channel, in [0..NUMSPIKESORTCH). If the corresponding buffer was not 
-//    allocated, then the file contains no data for that channel, and so no action is taken (this should not happen!).
-//             tSpk -- The time of the spike to be added or removed, in 10us ticks elapsed since recording began. If 
-//    spike is to be added and there's already a spike there, addSortedSpike() does nothing. If spike is to be removed 
-//    and there is no spike at that time, removeSortedSpike() does nothing.
-//                
-void removeSortedSpike(int ch, int tSpk)
+//    1) Applying each edit individually requires a search of the spike train and a shift of all spikes after the
+//    edited one, which is painfully slow for a long recording with thousands of edits. Instead, the edits are sorted
+//    by channel and time (preserving the order of multiple edits to the same spike), and each edited spike train is
+//    rebuilt in a single merge pass into a new buffer. See cxdSortSpikeEdits() and cxdMergeSpikeEdits().
+//    2) IMPORTANT: While processing sorted-spike train records, interspike intervals are converted from an integer
+//    number of 10us ticks to a double-valued elapsed time in milliseconds. Each spike edit time is saved in the action
+//    record as an integer-valued elapsed time in 10us ticks and is converted to a double-value in milliseconds for
+//    comparison with the sorted spike times that are in CXFILEDATA.pdSortedSpikes[]. These operations can introduce a
+//    very tiny error, so that the test for equality between double values might fail even though the two times are
+//    much less than 1us apart. Therefore, cxdMergeSpikeEdits() assumes equality if the absolute value of the
+//    difference is no more than 0.001ms (ie, 1us).
+//
+//    ARGS:    pEdits -- [in/out] the sorted-spike train edits, in the order listed in the action records. Each edit's
+//    channel # should lie in [0..NUMSPIKESORTCH); if not, or if the corresponding buffer was not allocated (the file
+//    contains no data for that channel -- this should not happen!), the edit is ignored. The array is sorted in place.
+//             nEdits -- [in] # of edits.
+//
+void applySortedSpikeEdits( PCXDSPIKEEDIT pEdits, int nEdits )
 {
-   int i, iRmv;
-   double tSpkMS, diff;
-   
-   int* pnSpikes;                                                       // ptrs to appropriate internal buf, its size,
-   int* pnBufSz;                                                        // and current count -- b/c the task is the
-   double** ppdBuf;                                                     // same for each sorted spike channel rec type.
+   int i, j, ch, nAdds;
+   double* pdNewBuf;
+
+   cxdSortSpikeEdits( pEdits, nEdits );
 
-   // abort if invalid ch# or if we did not find any data in the file for the specified channel
-   if(ch < 0 || ch >= NUMSPIKESORTCH) return;
-   if(cxData.nSortedBufSz[ch] == 0) return;
-   
-   // #spikes, buffer size, and buffer for the relevant sorted-spike train. Spike times are in ms in this buffer!
-   pnSpikes = &(cxData.nSortedSpikes[ch]);
-   pnBufSz = &(cxData.nSortedBufSz[ch]);
-   ppdBuf = &(cxData.pdSortedSpikes[ch]);
-   
-   // find index pos of spike to be removed. If not found, abort.
-   tSpkMS = ((double)tSpk) / 100.0;
-   iRmv = -1;
    i = 0;
-   while(i < *pnSpikes)
+   while( i < nEdits )
    {
-      // conversion to double causes inaccuracies. If times are less than 1us (0.001ms) apart, they're identical!
-      diff = tSpkMS - (*ppdBuf)[i];
-      if(-0.001 <= diff && diff <= 0.001)
+      // find the edits [i..j) for the next channel, and count the spikes added -- so we can size the new buffer
+      ch = pEdits[i].ch;
+      nAdds = 0;
+      for( j = i; j < nEdits && pEdits[j].ch == ch; j++ ) if( pEdits[j].bAdd ) ++nAdds;
+
+      // skip invalid ch# or if we did not find any data in the file for the specified channel
+      if( ch < 0 || ch >= NUMSPIKESORTCH || cxData.nSortedBufSz[ch] == 0 )
       {
-         iRmv = i;
-         break;
+         i = j;
+         continue;
       }
-      ++i;
-   }
-   if(iRmv < 0) return;
-   
-   // erase the removed spike by shifting later spikes back one
-   for(i = iRmv; i < *pnSpikes - 1; i++) (*ppdBuf)[i] = (*ppdBuf)[i+1];
-   
-   *pnSpikes = *pnSpikes - 1;
-}
 
-void addSortedSpike(int ch, int tSpk)
-{
-   int i, iAdd;
-   double tSpkMS, diff;
-   
-   int* pnSpikes;                                                       // ptrs to appropriate internal buf, its size,
-   int* pnBufSz;                                                        // and current count -- b/c the task is the
-   double** ppdBuf;                                                     // same for each sorted spike channel rec type.
-   double* pdNewBuf;                                                    // ptr to reallocated buffer, if needed
-   
-   
-   if(ch < 0 || ch >= NUMSPIKESORTCH) return;
-   if(cxData.nSortedBufSz[ch] == 0) return;
-   
-   // #spikes, buffer size, and buffer for the relevant sorted-spike train. Spike times are in ms in this buffer!
-   pnSpikes = &(cxData.nSortedSpikes[ch]);
-   pnBufSz = &(cxData.nSortedBufSz[ch]);
-   ppdBuf = &(cxData.pdSortedSpikes[ch]);
-   
-   // find insert pos of spike to be added, maintaining chronological order. If a spike is already at that time, abort.
-   tSpkMS = ((double)tSpk) / 100.0;
-   iAdd = 0;
-   while((iAdd < *pnSpikes) && ((*ppdBuf)[iAdd] < tSpkMS)) ++iAdd;
-   
-   // ensure that spike time is not within 1us of the two times between which it is being inserted. This means that the 
-   // spike is aleady there and does not need to be added! The conversions to double values cause inaccuracies -- see 
-   // comment header.
-   if(iAdd > 0)
-   {
-      diff = tSpkMS - (*ppdBuf)[iAdd-1];
-      if(-0.001 <= diff && diff <= 0.001) return;
-   }
-   if(iAdd < *pnSpikes)
-   {
-      diff = tSpkMS - (*ppdBuf)[iAdd];
-      if(-0.001 <= diff && diff <= 0.001) return;
-   }
-   
-   // make room for the spike to be added by shifting later spikes forward one spot. Might have to reallocate buffer!
-   if(*pnSpikes == *pnBufSz)
-   {
-      pdNewBuf = (double*) realloc( (void*) *ppdBuf, sizeof(double)*(100 + *pnBufSz) );
-      if(pdNewBuf == NULL)
+      pdNewBuf = (double*) malloc( sizeof(double) * (cxData.nSortedSpikes[ch] + nAdds + 1) );
+      if( pdNewBuf == NULL )
       {
-         printf( "ERROR: Internal buffer reallocation failed while adding a sorted spike; op failed!\n" );
-         return;
+         printf( "ERROR: Internal buffer allocation failed while editing sorted spike train %d; op failed!\n", ch );
+         i = j;
+         continue;
       }
-      *ppdBuf = pdNewBuf;
-      *pnBufSz += 100;
+
+      cxData.nSortedSpikes[ch] = cxdMergeSpikeEdits( cxData.pdSortedSpikes[ch], cxData.nSortedSpikes[ch],
+                                                     &(pEdits[i]), j - i, pdNewBuf );
+      free( cxData.pdSortedSpikes[ch] );
+      cxData.pdSortedSpikes[ch] = pdNewBuf;
+      cxData.nSortedBufSz[ch] = cxData.nSortedSpikes[ch] + nAdds + 1;
+      i = j;
    }
-   for(i = *pnSpikes; i > iAdd; i--) (*ppdBuf)[i] = (*ppdBuf)[i-1];
-   
-   // insert the spike time and increment spike count
-   (*ppdBuf)[iAdd] = tSpkMS;
-   *pnSpikes = *pnSpikes + 1;
 }
 
 
@@ -5124,3 +4998,438 @@ int mapTargetID( short nID )
    }
    return( iPos );
 }
+
+
+//=== parseSelectOpts =================================================================================================
+//
+//    Parse the selective decode options in the optional 'opts' argument of readcxdata() into module global selOpts.
+//    'opts' is a MATLAB structure; all of the following fields are optional:
+//
+//       chans    Vector of AI channel numbers in [0..15]. Only the recorded channels listed here are included in the
+//                'data' output, in the order recorded. The 'key' fields 'nchans' and 'chlist' are adjusted to match.
+//       window   [t0 t1]: Restrict the time-based outputs to this window, in ms since recording started; t1 = Inf
+//                means "to the end of the recording". The 'data' and 'spikewave' outputs start at t0, and the target
+//                trajectories in 'targets' are cropped likewise; the event times in 'spikes', 'events', 'other',
+//                'blinks' and 'sortedSpikes' are still relative to recording start, but only those in the window are
+//                included.
+//       section  Name of a tagged section (Trial mode only). The window is relative to the start of the section and,
+//                if 'window' is not specified, spans the section.
+//       fields   Cell array of names of the output fields to build; all other fields are left empty. Fields that are
+//                not needed are not computed at all when possible -- eg, the trial codes are not processed unless one
+//                of 'targets', 'tgtdefns', 'tagSections', 'trialInfo', 'xynoisy' or 'xynoisytimes' is requested.
+//
+//    ARGS:       pOpts -- [in] the 'opts' argument; NULL or empty if not specified.
+//
+//    RETURNS:    TRUE if successful; FALSE if an option is invalid (an error message is printed to STDOUT).
+//
+BOOL parseSelectOpts( const mxArray* pOpts )
+{
+   const mxArray* pField;
+   const mxArray* pName;
+   double* pdVals;
+   int i, j, n;
+   char name[64];
+
+   memset( (VOID*) &selOpts, 0, sizeof(SELECTOPTS) );                   // by default, build everything
+   selOpts.dwFields = 0xFFFFFFFF;
+   selOpts.t1 = -1.0;
+   selOpts.iFirstScan = -1;
+   selOpts.iEndScan = -1;
+   if( pOpts == NULL || mxIsEmpty( pOpts ) ) return( TRUE );
+   if( !mxIsStruct( pOpts ) )
+   {
+      printf( "ERROR: 'opts' must be a structure.\n" );
+      return( FALSE );
+   }
+
+   pField = mxGetField( pOpts, 0, "chans" );                            // subset of AI channels
+   if( pField != NULL && !mxIsEmpty( pField ) )
+   {
+      if( !mxIsDouble( pField ) )
+      {
+         printf( "ERROR: opts.chans must be a vector of AI channel numbers.\n" );
+         return( FALSE );
+      }
+      pdVals = mxGetPr( pField );
+      n = (int) mxGetNumberOfElements( pField );
+      for( i = 0; i < n; i++ )
+      {
+         j = (int) pdVals[i];
+         if( j < 0 || j >= CXH_MAXAI )
+         {
+            printf( "ERROR: opts.chans: AI channel # must be in [0..%d].\n", CXH_MAXAI - 1 );
+            return( FALSE );
+         }
+         selOpts.bChan[j] = TRUE;
+      }
+      selOpts.bChanSubset = TRUE;
+   }
+
+   pField = mxGetField( pOpts, 0, "window" );                           // time window
+   if( pField != NULL && !mxIsEmpty( pField ) )
+   {
+      pdVals = mxIsDouble( pField ) ? mxGetPr( pField ) : NULL;
+      if( pdVals == NULL || mxGetNumberOfElements( pField ) != 2 || pdVals[0] < 0 || pdVals[1] <= pdVals[0] )
+      {
+         printf( "ERROR: opts.window must be [t0 t1], with 0 <= t0 < t1 (ms).\n" );
+         return( FALSE );
+      }
+      selOpts.bWindow = TRUE;
+      selOpts.t0 = pdVals[0];
+      selOpts.t1 = mxIsInf( pdVals[1] ) ? -1.0 : pdVals[1];
+   }
+
+   pField = mxGetField( pOpts, 0, "section" );                          // tagged section
+   if( pField != NULL && !mxIsEmpty( pField ) )
+   {
+      if( !mxIsChar( pField ) || mxGetString( pField, selOpts.section, SECTIONTAGSZ ) != 0 )
+      {
+         printf( "ERROR: opts.section must be the name of a tagged section (max %d chars).\n", SECTIONTAGSZ - 1 );
+         return( FALSE );
+      }
+      selOpts.bWindow = TRUE;
+   }
+
+   pField = mxGetField( pOpts, 0, "fields" );                           // output fields to build
+   if( pField != NULL && !mxIsEmpty( pField ) )
+   {
+      if( !mxIsCell( pField ) && !mxIsChar( pField ) )
+      {
+         printf( "ERROR: opts.fields must be a cell array of output field names.\n" );
+         return( FALSE );
+      }
+      selOpts.dwFields = 0;
+      n = mxIsCell( pField ) ? (int) mxGetNumberOfElements( pField ) : 1;
+      for( i = 0; i < n; i++ )
+      {
+         pName = mxIsCell( pField ) ? mxGetCell( pField, i ) : pField;
+         name[0] = '\0';
+         if( pName != NULL && mxIsChar( pName ) ) mxGetString( pName, name, sizeof(name) );
+         for( j = 0; j < NUMOUTFIELDS; j++ ) if( strcmp( name, outputFields[j] ) == 0 ) break;
+         if( j == NUMOUTFIELDS )
+         {
+            printf( "ERROR: opts.fields: '%s' is not a readcxdata output field.\n", name );
+            return( FALSE );
+         }
+         selOpts.dwFields |= (((DWORD) 1) << j);
+      }
+      selOpts.dwFields |= (((DWORD) 1) << (NUMOUTFIELDS - 1));          // the 'window' field is always built
+   }
+
+   return( TRUE );
+}
+
+
+//=== isFieldSelected =================================================================================================
+//
+//    ARGS:       name  -- [in] name of a readcxdata() output field.
+//
+//    RETURNS:    TRUE if the output field is to be built, IAW the selective decode options.
+//
+BOOL isFieldSelected( const char* name )
+{
+   int i;
+   for( i = 0; i < NUMOUTFIELDS; i++ ) if( strcmp( name, outputFields[i] ) == 0 )
+      return( (selOpts.dwFields & (((DWORD) 1) << i)) != 0 );
+   return( FALSE );
+}
+
+
+//=== getScanIntvUS ===================================================================================================
+//
+//    RETURNS:    The AI scan interval in microseconds: from the data file header or, if it is not set there (older
+//                files), 2000 for a ContMode file and 1000 for a Trial mode file.
+//
+int getScanIntvUS()
+{
+   if( cxData.fileHdr.nScanIntvUS > 0 ) return( cxData.fileHdr.nScanIntvUS );
+   return( ((cxData.fileHdr.flags & CXHF_ISCONTINUOUS) != 0) ? 2000 : 1000 );
+}
+
+
+//=== getTagSectionTimes ==============================================================================================
+//
+//    Get the start time and length of a tagged section. These can be determined only after processTrialCodes() has
+//    prepared the trial segment information, and only if that information is valid.
+//
+//    ARGS:       iSect    -- [in] index of tagged section in CXFILEDATA.sections[].
+//                pStart   -- [out] section start time in trial ticks (ms), relative to when recording started; -1 if
+//                            it cannot be determined.
+//                pLen     -- [out] section length in trial ticks; -1 if it cannot be determined.
+//
+//    RETURNS:    TRUE if successful, FALSE if the start time and length could not be determined.
+//
+BOOL getTagSectionTimes( int iSect, int* pStart, int* pLen )
+{
+   int iFirstSeg, iLastSeg;
+
+   *pStart = -1;
+   *pLen = -1;
+   if( iSect < 0 || iSect >= cxData.nSections ) return( FALSE );
+
+   iFirstSeg = (int) cxData.sections[iSect].cFirstSeg;
+   iLastSeg = (int) cxData.sections[iSect].cLastSeg;
+   if( iFirstSeg > iLastSeg || cxData.nSegments <= iLastSeg || cxData.tRecordStarted < 0 || cxData.tTrialLen <= 0 ||
+       cxData.bSkipOccurred )
+      return( FALSE );
+
+   *pStart = cxData.segStart[iFirstSeg] - cxData.tRecordStarted;
+   if( (iLastSeg + 1) < cxData.nSegments )
+      *pLen = cxData.segStart[iLastSeg+1] - cxData.segStart[iFirstSeg];
+   else
+      *pLen = cxData.tTrialLen - cxData.segStart[iFirstSeg];
+   return( TRUE );
+}
+
+
+//=== resolveWindow ===================================================================================================
+//
+//    Resolve the time window selected via the 'opts' argument to a range of AI scans. If the window is defined by a
+//    tagged section, its bounds are first converted to times relative to recording start -- so this must be called
+//    after processTrialCodes() in that case.
+//
+//    RETURNS:    TRUE if successful; FALSE if the tagged section was not found or its timing could not be determined
+//                (an error message is printed to STDOUT).
+//
+BOOL resolveWindow()
+{
+   int i, tStart, tLen, iIntv;
+
+   if( selOpts.section[0] != '\0' )
+   {
+      for( i = 0; i < cxData.nSections; i++ )
+         if( strncmp( cxData.sections[i].tag, selOpts.section, SECTIONTAGSZ ) == 0 ) break;
+      if( !getTagSectionTimes( i, &tStart, &tLen ) )
+      {
+         printf( "ERROR: Tagged section '%s' not found, or its timing could not be determined.\n", selOpts.section );
+         return( FALSE );
+      }
+      selOpts.t1 = (selOpts.t1 < 0) ? (double) (tStart + tLen) : tStart + selOpts.t1;
+      selOpts.t0 += tStart;
+   }
+
+   iIntv = getScanIntvUS();
+   selOpts.iFirstScan = (int) floor( selOpts.t0 * 1000.0 / iIntv );
+   selOpts.iEndScan = (selOpts.t1 < 0) ? -1 : (int) ceil( selOpts.t1 * 1000.0 / iIntv );
+   return( TRUE );
+}
+
+
+//=== setSelectedData =================================================================================================
+//
+//    Decompress only the selected AI channels and time window from the internal compressed AI data buffer into the
+//    'data' field of the output structure; the internal buffer is released. Used instead of decompressing the entire
+//    stream when nothing else needs it (SELECTOPTS.bDirect). The scans preceding the window are parsed but not
+//    stored, and decoding stops at the end of the window.
+//
+//    ARGS:       pOut  -- [in/out] ptr to the MATLAB structure array prepared by readcxdata().
+//
+//    RETURNS:    TRUE if successful, FALSE if memory allocation failed (an error message is printed to STDOUT).
+//
+BOOL setSelectedData( mxArray* pOut )
+{
+   int i, k, nCh, nSel, iFirst, nScans, nBytes;
+   int iRow[CXH_MAXAI];
+   short* pshData;
+   double* pdData;
+   CXFILEHDR* pHdr = &(cxData.fileHdr);
+
+   nCh = (int) pHdr->nchans;
+   nSel = 0;
+   for( i = 0; i < nCh; i++ ) if( !selOpts.bChanSubset || selOpts.bChan[pHdr->chlist[i] & (CXH_MAXAI-1)] )
+      iRow[nSel++] = i;
+
+   iFirst = (selOpts.bWindow && selOpts.iFirstScan > 0) ? selOpts.iFirstScan : 0;
+   nScans = cxData.nAIBytes / nCh + 1 - iFirst;                         // every sample takes at least one byte
+   if( selOpts.bWindow && selOpts.iEndScan >= 0 && selOpts.iEndScan - iFirst < nScans )
+      nScans = selOpts.iEndScan - iFirst;
+   if( nScans < 0 ) nScans = 0;
+
+   pshData = (short*) malloc( sizeof(short) * (nScans * nCh + 1) );
+   if( pshData == NULL )
+   {
+      printf( "ERROR: Unable to allocate buffer for AI data.\n" );
+      return( FALSE );
+   }
+   cxdDecodeAIScans16( pshData, cxData.pcAIData, cxData.nAIBytes, nCh, iFirst, nScans, &nBytes, &nScans );
+   free( cxData.pcAIData ); cxData.pcAIData = NULL;
+   if( iVerbose ) printf( "Decoded %i scans starting at scan %i (%i compressed bytes)\n", nScans, iFirst, nBytes );
+
+   mxSetField( pOut, 0, "data", mxCreateDoubleMatrix( nSel, nScans, mxREAL ) );
+   pdData = mxGetPr( mxGetField( pOut, 0, "data" ) );
+   for( k = 0; k < nScans; k++ ) for( i = 0; i < nSel; i++ )
+      pdData[k*nSel + i] = (double) pshData[k*nCh + iRow[i]];
+
+   free( pshData );
+   return( TRUE );
+}
+
+
+//=== replaceField ====================================================================================================
+//
+//    Replace the value of a field in a MATLAB structure, destroying the previous value, if any.
+//
+//    ARGS:       pStruct  -- [in/out] a 1x1 MATLAB structure.
+//                name     -- [in] the field name.
+//                pNew     -- [in] the new value. May be NULL (empty).
+//
+void replaceField( mxArray* pStruct, const char* name, mxArray* pNew )
+{
+   mxArray* pOld = mxGetField( pStruct, 0, name );
+   if( pOld != NULL ) mxDestroyArray( pOld );
+   mxSetField( pStruct, 0, name, pNew );
+}
+
+
+//=== selectByTime ====================================================================================================
+//
+//    Create a copy of a vector of event times, or of a matrix with time values in one or two of its columns, that
+//    includes only the events (rows) in the time window [t0, t1).
+//
+//    ARGS:       pArr     -- [in] the original array: a 1xN vector of times, or an MxK matrix.
+//                bVector  -- [in] TRUE if the array is a vector of times.
+//                iCol     -- [in] (matrix only) the column holding the event time, or the start of an epoch.
+//                iEndCol  -- [in] (matrix only) the column holding the end of an epoch; same as 'iCol' for events.
+//                            An epoch is included if it overlaps the window at all.
+//                t0, t1   -- [in] the time window, in ms.
+//
+//    RETURNS:    The new array.
+//
+mxArray* selectByTime( const mxArray* pArr, BOOL bVector, int iCol, int iEndCol, double t0, double t1 )
+{
+   int i, j, k, nRows, nCols, nKept;
+   double* pdSrc;
+   double* pdDst;
+   mxArray* pNew;
+
+   pdSrc = mxGetPr( pArr );
+   if( bVector )
+   {
+      nRows = (int) mxGetNumberOfElements( pArr );
+      nCols = 1;
+      iCol = iEndCol = 0;
+   }
+   else
+   {
+      nRows = (int) mxGetM( pArr );
+      nCols = (int) mxGetN( pArr );
+   }
+
+   nKept = 0;
+   for( i = 0; i < nRows; i++ )
+      if( pdSrc[iCol*nRows + i] < t1 && pdSrc[iEndCol*nRows + i] >= t0 ) ++nKept;
+
+   pNew = bVector ? mxCreateDoubleMatrix( 1, nKept, mxREAL ) : mxCreateDoubleMatrix( nKept, nCols, mxREAL );
+   pdDst = mxGetPr( pNew );
+   for( i = 0, k = 0; i < nRows; i++ ) if( pdSrc[iCol*nRows + i] < t1 && pdSrc[iEndCol*nRows + i] >= t0 )
+   {
+      for( j = 0; j < nCols; j++ ) pdDst[j*nKept + k] = pdSrc[j*nRows + i];
+      ++k;
+   }
+   return( pNew );
+}
+
+
+//=== applySelection ==================================================================================================
+//
+//    Apply the selective decode options to the finished output structure of readcxdata(): restrict 'data' to the
+//    selected AI channels and time window (unless it was decoded that way in the first place), adjust 'key.nchans'
+//    and 'key.chlist' accordingly, restrict the other time-based outputs to the window, set the 'window' field, and
+//    finally empty all output fields that were not requested. No effect if no options were specified.
+//
+//    ARGS:       pOut  -- [in/out] ptr to the MATLAB structure array prepared by readcxdata().
+//
+void applySelection( mxArray* pOut )
+{
+   static const char* trajMatrices[] = { "hpos", "vpos", "hvel", "vvel", "patvelH", "patvelV" };
+   int i, j, k, nCh, nSel, nScans, nRows, iFirst, nKept;
+   int iRow[CXH_MAXAI];
+   double t1;
+   double* pdSrc;
+   double* pdDst;
+   int* piChans;
+   mxArray* pArr;
+   mxArray* pNew;
+   mxArray* pCells;
+   CXFILEHDR* pHdr = &(cxData.fileHdr);
+
+   nCh = (int) pHdr->nchans;                                            // positions of selected chans in chan list
+   nSel = 0;
+   for( i = 0; i < nCh; i++ ) if( !selOpts.bChanSubset || selOpts.bChan[pHdr->chlist[i] & (CXH_MAXAI-1)] )
+      iRow[nSel++] = i;
+
+   iFirst = (selOpts.bWindow && selOpts.iFirstScan > 0) ? selOpts.iFirstScan : 0;
+
+   pArr = mxGetField( pOut, 0, "data" );                                // restrict 'data' to selected chans and
+   if( !selOpts.bDirect && pArr != NULL && (nSel < nCh || selOpts.bWindow) )   // window
+   {
+      nScans = (int) mxGetN( pArr );
+      nKept = nScans - iFirst;
+      if( selOpts.bWindow && selOpts.iEndScan >= 0 && selOpts.iEndScan - iFirst < nKept )
+         nKept = selOpts.iEndScan - iFirst;
+      if( nKept < 0 ) nKept = 0;
+
+      pNew = mxCreateDoubleMatrix( nSel, nKept, mxREAL );
+      pdSrc = mxGetPr( pArr );
+      pdDst = mxGetPr( pNew );
+      for( k = 0; k < nKept; k++ ) for( i = 0; i < nSel; i++ )
+         pdDst[k*nSel + i] = pdSrc[(iFirst + k)*nCh + iRow[i]];
+      replaceField( pOut, "data", pNew );
+   }
+
+   pArr = mxGetField( pOut, 0, "key" );                                 // 'key' describes the channels in 'data'
+   if( selOpts.bChanSubset && pArr != NULL )
+   {
+      replaceField( pArr, "nchans", createInt32Scalar( nSel ) );
+      piChans = (int*) mxGetData( mxGetField( pArr, 0, "chlist" ) );
+      for( i = 0; i < CXH_MAXAI; i++ ) piChans[i] = (i < nSel) ? (int) pHdr->chlist[iRow[i]] : 0;
+   }
+
+   if( selOpts.bWindow )                                                // restrict other time-based outputs
+   {
+      t1 = (selOpts.t1 >= 0) ? selOpts.t1 : 1.0e30;
+
+      if( (pArr = mxGetField( pOut, 0, "spikes" )) != NULL )
+         replaceField( pOut, "spikes", selectByTime( pArr, TRUE, 0, 0, selOpts.t0, t1 ) );
+      if( (pArr = mxGetField( pOut, 0, "events" )) != NULL )
+         replaceField( pOut, "events", selectByTime( pArr, TRUE, 0, 0, selOpts.t0, t1 ) );
+      if( (pArr = mxGetField( pOut, 0, "other" )) != NULL )
+         replaceField( pOut, "other", selectByTime( pArr, FALSE, 1, 1, selOpts.t0, t1 ) );
+      if( (pArr = mxGetField( pOut, 0, "blinks" )) != NULL )
+         replaceField( pOut, "blinks", selectByTime( pArr, FALSE, 0, 1, selOpts.t0, t1 ) );
+
+      pCells = mxGetField( pOut, 0, "sortedSpikes" );
+      if( pCells != NULL ) for( i = 0; i < (int) mxGetNumberOfElements( pCells ); i++ )
+      {
+         if( (pArr = mxGetCell( pCells, i )) == NULL ) continue;
+         pNew = selectByTime( pArr, TRUE, 0, 0, selOpts.t0, t1 );
+         mxDestroyArray( pArr );
+         mxSetCell( pCells, i, pNew );
+      }
+
+      pArr = mxGetField( pOut, 0, "targets" );                          // target trajectories: one column per scan
+      if( pArr != NULL ) for( j = 0; j < 6; j++ )
+      {
+         if( (pNew = mxGetField( pArr, 0, trajMatrices[j] )) == NULL ) continue;
+         nRows = (int) mxGetM( pNew );
+         nScans = (int) mxGetN( pNew );
+         nKept = nScans - iFirst;
+         if( selOpts.iEndScan >= 0 && selOpts.iEndScan - iFirst < nKept ) nKept = selOpts.iEndScan - iFirst;
+         if( nKept < 0 ) nKept = 0;
+         pdSrc = mxGetPr( pNew );
+         pNew = mxCreateDoubleMatrix( nRows, nKept, mxREAL );
+         pdDst = mxGetPr( pNew );
+         if( nKept > 0 ) memcpy( pdDst, pdSrc + iFirst*nRows, sizeof(double) * nRows * nKept );
+         replaceField( pArr, trajMatrices[j], pNew );
+      }
+
+      pNew = mxCreateDoubleMatrix( 1, 2, mxREAL );                      // the window actually covered
+      pdDst = mxGetPr( pNew );
+      pdDst[0] = selOpts.t0;
+      pdDst[1] = (selOpts.t1 >= 0) ? selOpts.t1 : (((double) pHdr->nScansSaved) * getScanIntvUS()) / 1000.0;
+      replaceField( pOut, "window", pNew );
+   }
+
+   for( i = 0; i < NUMOUTFIELDS; i++ )                                  // empty all fields not requested
+      if( (selOpts.dwFields & (((DWORD) 1) << i)) == 0 ) replaceField( pOut, outputFields[i], NULL );
+}
@@ -209,6 +209,29 @@ typedef struct tagMark                       // a "tag" annotation as defined by
    char     label[20];                       //    null-terminated label for the tag
 } TAGMARK, *PTAGMARK;
 
+
+//=====================================================================================================================
+// Selective decode options
+//
+// By default, readcxdata() decompresses every AI channel for the whole recording, plus the entire spike waveform, and
+// builds every output field. The optional 'opts' argument restricts this; see the usage notes in readcxdata.c.
+//=====================================================================================================================
+
+typedef struct tagSelectOpts
+{
+   BOOL bChanSubset;                            // if TRUE, 'data' includes only the AI channels flagged in bChan[],
+   BOOL bChan[CXH_MAXAI];                       // which is indexed by AI channel # (NOT position in channel list)
+   BOOL bWindow;                                // if TRUE, time-based outputs are restricted to a time window
+   double t0, t1;                               // window bounds [t0, t1) in ms since recording started; if a tagged
+                                                // section is named, relative to section start. t1 < 0 means "to end"
+   char section[SECTIONTAGSZ];                  // name of tagged section defining the window; empty string if none
+   DWORD dwFields;                              // bit N set if output field outputFields[N] is to be built
+   BOOL bDirect;                                // TRUE if AI data is decoded directly for the selected channels and
+                                                // window; else all of it is decoded and the selection applied last
+   int iFirstScan;                              // once resolved, the window in AI scans: [iFirstScan, iEndScan).
+   int iEndScan;                                // iEndScan < 0 means "to end"; iFirstScan < 0 means "not resolved"
+} SELECTOPTS, *PSELECTOPTS;
+
 //
 // constants defining the fields in the output structure returned by MEX function readcxdata()
 //
@@ -260,9 +283,14 @@ const char* outputFields[] =  // the MATLAB-compatible output structure returned
    "trialInfo",               // additional info about a trial: #segments, seg start times, etcetera
    
    "xynoisy",                 // results from emulating XYScope OR RMVideo noisy-dots targets during a trial; available 
-   "xynoisytimes"             //    for Maestro data file w/version >= 12. See NOISYEM.H.
+   "xynoisytimes",            //    for Maestro data file w/version >= 12. See NOISYEM.H.
+
+   "window"                   // (as of Oct 2026) if a time window was selected via the 'opts' argument, the actual
+                              //    window [t0 t1] covered by 'data', in ms since recording started; else empty. 'data'
+                              //    starts at t0; all other time-based outputs keep their times relative to recording
+                              //    start, including only those within the window.
 };
-const int NUMOUTFIELDS = 22;  // the # of fields in the output structure
+const int NUMOUTFIELDS = 23;  // the # of fields in the output structure
 
 const char* headerFields[] =  // defines MATLAB structure mirroring the contents of the data file header record (the
 {                             // field names are the same as corresponding members of the CXFILEHDR structure 
@@ -122,6 +122,30 @@
 // visual degrees. It applies only to RMV_POINT, RMV_RANDOMDOTS, and RMV_FLOWFIELD.
 // -- Since RMVTGTDEF has changed, the previous version of the structure is preserved as RMVTGTDEF_V24 to parse Maestro
 // data files that contain RMVTGTDEF_V24 target records (data file versions 23-24).
+//
+// Oct 2026:
+// -- Introduced RMV_CMD_GETFRAMESTATS, which reports per-frame timing statistics for the most recent animation
+// sequence. It is intended for diagnosing duplicate frames. Maestro does not require it, so the official RMVideo 
+// version is unchanged.
+// -- RMV_MOVIE targets may start playback at any frame in the video. The start frame is specified by RMVTGTDEF.iSeed
+// (sent as RMV_TGTDEF_SEED), which is otherwise unused by the movie target, so the layout of RMVTGTDEF -- and hence the
+// Maestro data file format -- is unchanged. If not sent, it is 0 and the movie starts at the first frame as before.
+// The start position is a frame index rather than a time by design: with RMV_F_ATDISPRATE set, frames are presented at
+// the display rate rather than the source rate, so a time in the source's timebase would not correspond to elapsed
+// playback time; and a frame index is exact, even for sources with variable frame timing. A start time T in the
+// source's timebase is simply frame T*R for a movie with frame rate R.
+// -- Introduced RMV_CMD_GETIMGCACHESTATS, which reports the hit, miss and eviction counts of RMVideo's image cache. As
+// with RMV_CMD_GETFRAMESTATS, Maestro does not require it, so the official RMVideo version is unchanged.
+// -- Introduced RMV_CMD_GETCMDLATENCY, which reports how long Maestro commands waited in RMVideo between their arrival
+// and their retrieval during the most recent animation sequence. Again, Maestro does not require it.
+// -- RMVideo v12: Introduced RMV_CMD_UPDATEFRAMEC, a compact encoding of RMV_CMD_UPDATEFRAME that omits the motion
+// vectors of targets whose vector is unchanged from the previous frame and sends the rest in variable-width fields.
+// Maestro uses it only if RMVideo reports version 12 or later, and otherwise falls back on RMV_CMD_UPDATEFRAME, which
+// is unchanged and still supported by RMVideo. Maestro accepts RMVideo v11 as well as v12 (RMV_MINVERSION).
+// -- RMVideo v13: Introduced RMV_CMD_PUTFILEX, a faster way to download a media file. Maestro identifies the file's
+// content by its size and a 64-bit hash (RMV_CONTENTHASH). RMVideo skips the transfer if it already has that content,
+// and resumes an interrupted transfer where it left off. File chunks are sent with up to RMV_PUTX_WINDOW of them in
+// flight, rather than waiting for each chunk to be acknowledged. Maestro uses it only with RMVideo v13 or later.
 //=====================================================================================================================
 
 
@@ -167,7 +191,10 @@
 // DATA:  None.
 // REPLY: Single 32-bit positive integer, the RMVideo version number. Max wait = 250 ms.
 
-#define RMV_CURRENTVERSION    11           // current RMVideo version number (as of Dec 2024, Maestro v5.0.2)
+#define RMV_CURRENTVERSION    13           // current RMVideo version number (as of Oct 2026)
+#define RMV_MINVERSION        11           // oldest RMVideo version that Maestro will still work with
+#define RMV_COMPACTUPDVERSION 12           // oldest RMVideo version that supports RMV_CMD_UPDATEFRAMEC
+#define RMV_PUTFILEXVERSION   13           // oldest RMVideo version that supports RMV_CMD_PUTFILEX
 
 #define RMV_CMD_RESTART       2
 // Exit and restart. This command was issued as part of the procedure to automatically update an old version of RMVideo
@@ -269,6 +296,40 @@
 // REPLY: RMV_SIG_CMDACK if successful, RMV_SIG_CMDERR if any parameter is out of range or an error occurred. Max
 // wait = 250ms.
 
+#define RMV_CMD_GETFRAMESTATS   46
+#define RMV_FRAMESTATS_LEN          23
+#define RMV_FRAMESTATS_NFRAMES      0     // # of animation loop iterations recorded
+#define RMV_FRAMESTATS_NKEPT        1     // # of those retained (only the most recent 8192 are kept)
+#define RMV_FRAMESTATS_NSKIPS       2     // total # of duplicate frames due to a rendering delay
+#define RMV_FRAMESTATS_NMISSED      3     // # of frames for which the target update was not received in time
+#define RMV_FRAMESTATS_UPDAVG       4     // target update stage: average and maximum duration
+#define RMV_FRAMESTATS_UPDMAX       5
+#define RMV_FRAMESTATS_DRAWAVG      6     // render stage: average and maximum duration
+#define RMV_FRAMESTATS_DRAWMAX      7
+#define RMV_FRAMESTATS_SWAPAVG      8     // buffer swap and wait for vertical blank: average and maximum duration
+#define RMV_FRAMESTATS_SWAPMAX      9
+#define RMV_FRAMESTATS_CMDAVG       10    // command retrieval: average and maximum duration
+#define RMV_FRAMESTATS_CMDMAX       11
+#define RMV_FRAMESTATS_MAXDRIFT     12    // max abs difference between actual and expected elapsed time, T - N*P
+#define RMV_FRAMESTATS_WORSTFRAME   13    // elapsed frame count N at end of iteration with the longest update+draw
+#define RMV_FRAMESTATS_WORSTCOST    14    // the duration of update+draw in that iteration
+#define RMV_FRAMESTATS_SLOWTGT      15    // index of the target with the longest update in that iteration (-1 if none)
+#define RMV_FRAMESTATS_SLOWTGTCOST  16    // the duration of that target's update
+#define RMV_FRAMESTATS_TEXHITS      17    // # of texture requests satisfied by an unused texture in the texture pool
+#define RMV_FRAMESTATS_TEXALLOCS    18    // # of texture objects allocated (including those pre-warmed in idle time)
+#define RMV_FRAMESTATS_TEXEVICTS    19    // # of unused texture objects evicted from the texture pool
+#define RMV_FRAMESTATS_TEXCOUNT     20    // # of texture objects currently in the texture pool
+#define RMV_FRAMESTATS_TEXKB        21    // texture memory currently reserved in the texture pool, in KB
+#define RMV_FRAMESTATS_TEXBUDGETKB  22    // the texture pool's budget, in KB
+// Get frame-timing statistics for the most recent animation sequence. During each sequence, RMVideo records the 
+// duration of each stage of every iteration of its animation loop, the drift between actual and expected elapsed 
+// time, and the update cost of each target. This command summarizes those records. It also reports the state of the
+// renderer's texture object pool; the texture pool counters are cumulative since RMVideo started.
+// DATA:  None.
+// REPLY:  RMV_SIG_CMDACK followed by RMV_FRAMESTATS_LEN 32-bit integers, indexed by the RMV_FRAMESTATS_* constants
+// above. All durations are in microseconds. If no animation sequence has been run, all are zero (except the slowest
+// target index, which is -1). Max wait = 250ms.
+
 #define RMV_CMD_LOADTARGETS   60
 // Load definitions of targets to be animated.  This command can be invoked only when RMVideo is in the idle state.
 // DATA:  The first integer after the command ID is the number N of targets to be loaded.  This is followed by N
@@ -397,6 +458,35 @@
 // REPLY:  NONE. However, messages may be sent back to Maestro during an animation sequence, as already described. 
 // Maestro will check for any pending RMVideo message after sending each RMV_CMD_UPDATEFRAME command.
 
+#define RMV_CMD_UPDATEFRAMEC  81
+#define RMV_UPDC_W_ZERO       0     // field width codes in RMV_CMD_UPDATEFRAMEC: value is zero (no bytes sent)
+#define RMV_UPDC_W_16         1     //    value sent as a 16-bit signed integer
+#define RMV_UPDC_W_24         2     //    value sent as a 24-bit signed integer
+#define RMV_UPDC_W_32         3     //    value sent as a 32-bit signed integer
+// Update target motion for the next display frame -- compact encoding (RMVideo v12 or later).
+//
+// This command carries the same information as RMV_CMD_UPDATEFRAME and is handled by RMVideo in exactly the same way.
+// It exists because RMV_CMD_UPDATEFRAME sends 6 integers per target on every frame, even though most targets in a
+// typical scene are either static or moving at constant velocity, so that their motion vector does not change from
+// one frame to the next. Here, the motion vector of a target is sent only if it is different from the one sent for
+// the previous frame, and each of its 4 floating-point fields is sent in the smallest of 0, 2, 3 or 4 bytes that can
+// hold its scaled integer value (scaled by RMV_TGTVEC_F2I_F and rounded, exactly as in RMV_CMD_UPDATEFRAME). The
+// "previous frame" of the first update after RMV_CMD_STARTANIMATE is frame 1 of that command, and Maestro may mix
+// the two update encodings freely during an animation sequence.
+//
+// DATA:  SYNC?, N, ONMASK[M], CHGMASK[M], BYTES... Here SYNC? and N are as for RMV_CMD_UPDATEFRAME, and M = (N+31)/32.
+// Bit n%32 of ONMASK[n/32] is the "on" flag of target n (RMVTGTVEC.bOn), which is sent for every target on every 
+// frame. Bit n%32 of CHGMASK[n/32] is set if the other fields of target n's motion vector (hWin, vWin, hPat, vPat)
+// are sent; otherwise, they are the same as in the previous frame. The remaining integers of the command are treated
+// as a byte sequence. For each target n with its CHGMASK bit set, in increasing order of n, the byte sequence holds a
+// descriptor byte D, followed by the fields of the motion vector that are not zero. Bits 1..0 of D hold the width code
+// (RMV_UPDC_W_*) of hWin, bits 3..2 that of vWin, bits 5..4 that of hPat, and bits 7..6 that of vPat. The non-zero
+// fields follow in that order, each as a little-endian two's-complement integer of the indicated width. The byte 
+// sequence is padded with zeros to a multiple of 4 bytes. RMVideo rejects the command if the byte sequence is not
+// consumed exactly (not counting the padding) or any unused bit of the masks is set.
+//
+// REPLY:  Same as RMV_CMD_UPDATEFRAME.
+
 #define RMV_CMD_STOPANIMATE   90
 // Stop animation immediately and return to idle state.  All previously defined targets are "unloaded".
 // DATA:  None.
@@ -465,6 +555,42 @@
 // REPLY: RMV_SIG_CMDACK if successful, RMV_SIG_CMDERR otherwise. Possible reasons for error: file not found, or 
 // unable to delete file. Max wait = 5 seconds.
 
+#define RMV_CMD_GETIMGCACHESTATS    104
+#define RMV_IMGCACHESTATS_LEN       8
+#define RMV_IMGCACHESTATS_NIMAGES   0     // # of images currently in RMVideo's in-memory image cache
+#define RMV_IMGCACHESTATS_SIZEKB    1     // total size of the cached images, in KB
+#define RMV_IMGCACHESTATS_BUDGETKB  2     // capacity of the image cache, in KB
+#define RMV_IMGCACHESTATS_HITS      3     // # of image retrievals (target loads) satisfied by the cache since startup
+#define RMV_IMGCACHESTATS_MISSES    4     // # of image retrievals that required loading the image since startup
+#define RMV_IMGCACHESTATS_EVICTIONS 5     // # of images evicted from the cache to make room since startup
+#define RMV_IMGCACHESTATS_DISKHITS  6     // # of images loaded from the on-disk pixel cache rather than decoded
+#define RMV_IMGCACHESTATS_DISKENA   7     // 1 if the on-disk pixel cache is enabled, else 0
+// Get statistics on RMVideo's image cache. To speed up the loading of RMV_IMAGE targets, RMVideo caches decoded images
+// in memory, evicting the least recently used image when the cache is full. Optionally, decoded images are also cached
+// on disk so they need not be decoded again after eviction or an RMVideo restart.
+// DATA:  None.
+// REPLY: RMV_SIG_CMDACK followed by RMV_IMGCACHESTATS_LEN 32-bit integers, indexed by the RMV_IMGCACHESTATS_* 
+// constants above. Max wait = 1 second.
+
+#define RMV_CMD_GETCMDLATENCY       105
+#define RMV_CMDLATENCY_NBINS        16
+#define RMV_CMDLATENCY_LEN          (5 + RMV_CMDLATENCY_NBINS)
+#define RMV_CMDLATENCY_ENABLED      0     // 1 if RMVideo receives commands on a dedicated thread, else 0
+#define RMV_CMDLATENCY_NCMDS        1     // # of commands retrieved since the last animation sequence started
+#define RMV_CMDLATENCY_AVGUS        2     // mean receive-to-retrieval latency, in microseconds
+#define RMV_CMDLATENCY_MAXUS        3     // maximum receive-to-retrieval latency, in microseconds
+#define RMV_CMDLATENCY_MAXQUEUED    4     // maximum # of received commands waiting to be retrieved at any one time
+#define RMV_CMDLATENCY_HIST         5     // start of latency histogram (RMV_CMDLATENCY_NBINS bins)
+// Get statistics on the latency with which RMVideo retrieves Maestro commands. When RMVideo is started with the
+// "eventio" option, a dedicated thread receives each command as soon as it arrives and timestamps it; the latency is
+// the time from that arrival until the command is retrieved by the display or animation loop. Statistics cover the
+// commands retrieved since the start of the most recent animation sequence (including RMV_CMD_STARTANIMATE itself).
+// Histogram bin 0 counts latencies under 1us; bin K>0 counts latencies in [2^(K-1), 2^K) us, except the last bin,
+// which includes all longer latencies. If the receive thread is not in use, all statistics are zero.
+// DATA:  None.
+// REPLY: RMV_SIG_CMDACK followed by RMV_CMDLATENCY_LEN 32-bit integers, indexed by the RMV_CMDLATENCY_* constants
+// above. Max wait = 1 second.
+
 #define RMV_CMD_PUTFILE      110
 // Initiate the download of a media file from the Maestro client to a folder in the RMVideo media store. In response,
 // RMVideo opens the new file in the destination specified. It then enters a special state in which it accepts a
@@ -492,6 +618,43 @@
 // not cancelled and did not complete successfully. This could happen if the downloaded file could not be opened or was
 // not recognized as a supported video or image file. Max wait = 10 secs.
 
+#define RMV_CMD_PUTFILEX      113
+#define RMV_PUTX_SEND         0     // RMV_CMD_PUTFILEX reply status: send file content starting at the offset given
+#define RMV_PUTX_EXISTS       1     //    destination file already exists with the same content; nothing to send
+#define RMV_PUTX_COPIED       2     //    same content found elsewhere in media store and installed at destination
+#define RMV_PUTX_WINDOW       16    // max # of unacknowledged RMV_CMD_PUTFILECHUNK commands during RMV_CMD_PUTFILEX
+#define RMV_PUTX_CHUNKSZ      8192  // max # of file bytes in each RMV_CMD_PUTFILECHUNK during RMV_CMD_PUTFILEX
+// Initiate a windowed, resumable download of a media file to a folder in the RMVideo media store (RMVideo v13 or
+// later). This serves the same purpose as RMV_CMD_PUTFILE, but it identifies the file's content so that RMVideo can
+// avoid transferring content it already has, and the transfer does not wait for each file chunk to be acknowledged.
+// DATA: {SZLO, SZHI, HLO, HHI, folderName \0 fileName}. SZ is the file size in bytes and H is the file's content hash
+// (see RMV_CONTENTHASH), each an unsigned 64-bit integer sent as two 32-bit ints, low-order half first. The folder and
+// file names follow, formatted as in RMV_CMD_PUTFILE.
+// REPLY: RMV_SIG_CMDERR if RMVideo cannot accept the file; else {RMV_SIG_CMDACK, STATUS, OFFLO, OFFHI}. Max wait = 30
+// secs (RMVideo may have to compute the content hash of media files of the same size).
+//    STATUS = RMV_PUTX_EXISTS: The destination file already exists with identical size and hash. The operation is
+// complete. (If the destination file exists with different content, the command fails as in RMV_CMD_PUTFILE.)
+//    STATUS = RMV_PUTX_COPIED: Another file in the media store has identical size and hash. RMVideo installed a copy
+// of it at the destination, validated it and updated its table of contents. The operation is complete.
+//    STATUS = RMV_PUTX_SEND: Maestro must send the file content, starting at byte offset OFF, via a sequence of
+// RMV_CMD_PUTFILECHUNK commands (in order, each carrying at most RMV_PUTX_CHUNKSZ bytes), followed by a single
+// RMV_CMD_PUTFILEDONE. OFF is zero unless RMVideo holds the first OFF bytes from an earlier, interrupted transfer of
+// the same content. Maestro may send up to RMV_PUTX_WINDOW chunks before the first of them is acknowledged. RMVideo
+// acknowledges each chunk with RMV_SIG_CMDACK. If a chunk cannot be processed, RMVideo replies RMV_SIG_CMDERR instead,
+// then silently discards all chunks up to the RMV_CMD_PUTFILEDONE, to which it also replies RMV_SIG_CMDERR. Upon
+// seeing RMV_SIG_CMDERR, Maestro should stop sending chunks and send RMV_CMD_PUTFILEDONE with a zero argument. Upon 
+// a successful RMV_CMD_PUTFILEDONE, RMVideo verifies the size and content hash of the file, then installs and 
+// validates it as in RMV_CMD_PUTFILE. Max wait for that reply = 30 secs.
+//    If the connection is lost during the transfer, RMVideo keeps the bytes received so far, so the transfer can be
+// resumed by sending RMV_CMD_PUTFILEX again for the same file. If the transfer fails or is cancelled, they're removed.
+
+// RMV_CONTENTHASH: The content hash for RMV_CMD_PUTFILEX is the 64-bit FNV-1a hash of the file's content taken 8 bytes
+// at a time, then of the file size: Starting with H = RMV_CONTENTHASH_BASIS, for each 8-byte little-endian word W of
+// the file (the last word zero-padded if the file size is not a multiple of 8), H = (H ^ W) * RMV_CONTENTHASH_PRIME
+// (modulo 2^64). Finally, H = (H ^ SZ) * RMV_CONTENTHASH_PRIME, where SZ is the file size in bytes.
+#define RMV_CONTENTHASH_BASIS 0xcbf29ce484222325ULL
+#define RMV_CONTENTHASH_PRIME 0x00000100000001b3ULL
+
 
 //=====================================================================================================================
 // RMVideo messages sent to Maestro. Most messages are just a "signal code", a single 32-bit word. In some cases the 
@@ -600,6 +763,8 @@ typedef struct RMVTargetDef         // defining parameters for a video target
    int   nDotSize;                  //    [RMV_POINT, _RANDOMDOTS, _FLOWFIELD] dot size in pixels. Range= [1..10].
    int   iSeed;                     //    [RMV_RANDOMDOTS, _FLOWFIELD] seed for random# generator that determines
                                     //    initial dot locs (also seeds a separate RNG for dot direc or speed noise).
+                                    //    [RMV_MOVIE] zero-based index of the first frame to play (>= 0); if the 
+                                    //    movie repeats, each repetition starts at this frame.
    int   iPctCoherent;              //    [RMV_RANDOMDOTS] percent coherence in [0..100]
    int   iNoiseUpdIntv;             //    [RMV_RANDOMDOTS] noise update interval in ms.  If 0, no noise.
    int   iNoiseLimit;               //    [RMV_RANDOMDOTS] speed or direction noise range limit (see defined constants)
@@ -0,0 +1,635 @@
+//=====================================================================================================================
+//
+// spkeditbench.c : Benchmark for the replay of JMWork sorted-spike train edits (Linux).
+//
+// AUTHOR:  saruffner
+//
+// DESCRIPTION:
+// A data file re-sorted in JMWork may carry tens of thousands of ACTION_ADDSORTSPK and ACTION_REMOVESORTSPK edits in
+// its action records, and READCXDATA must replay all of them on the sorted-spike trains. It used to apply them one at
+// a time, each a linear search of the spike train plus a shift of all later spikes; it now sorts them once and
+// rebuilds each edited train in a single merge pass (cxdSortSpikeEdits(), cxdMergeSpikeEdits()). This program times
+// the two approaches on a synthetic data file and verifies that they produce identical spike trains.
+//
+// The synthetic file has a header record, the sorted-spike train records for the specified # of channels, and action
+// records holding the specified # of spike edits. The edits are spread at random over the channels: most remove an
+// existing spike or add a new one; the rest are edits that do nothing (adding a spike that is already there, removing
+// one that is not) and edits that are later undone -- so that the duplicate rule and the order of edits to the same
+// spike are exercised. The file is then read back with the standalone reader in cxdatalib.c, the spike trains and
+// edit list extracted exactly as READCXDATA does, and the edits replayed by:
+//    1) the original one-at-a-time algorithm of READCXDATA's removeSortedSpike() and addSortedSpike(), reproduced
+//       here as the reference; and
+//    2) the sort-and-merge algorithm of READCXDATA's applySortedSpikeEdits().
+// The time taken by each is written to STDOUT, along with whether or not the edited spike trains are identical. The
+// exit status is nonzero if they are not.
+//
+// USAGE:  spkeditbench [-n nedits] [-s nspikes] [-c nchans] [-r seed] [-k] file
+//    -n : # of spike edits (default: 100000).
+//    -s : # of spikes in each sorted-spike train before editing (default: 50000).
+//    -c : # of sorted-spike train channels (default: 4).
+//    -r : seed for the random # generator (default: 1).
+//    -k : keep the synthetic data file; otherwise it is removed when the benchmark finishes.
+//    file : pathname for the synthetic data file.
+//
+// BUILD:  gcc -O2 -o spkeditbench spkeditbench.c cxdatalib.c
+//
+// REVISION HISTORY:
+// 16oct2026-- Created.
+//=====================================================================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cxdatalib.h"
+#include "readcxdata.h"       // action codes; NUMSPIKESORTCH
+
+
+//=====================================================================================================================
+// MODULE GLOBALS, CONSTANTS
+//=====================================================================================================================
+
+typedef struct tagSpikeTrain        // a sorted-spike train, as READCXDATA stores it
+{
+   double* pdSpikes;                //    spike times in ms, in chronological order
+   int nSpikes;                     //    # of spikes in train
+   int nBufSz;                      //    allocated size of buffer (0 if the file had no data for the channel)
+   int tLast;                       //    elapsed time of last spike read from file, in 10us ticks
+} SPIKETRAIN, *PSPIKETRAIN;
+
+unsigned int G_rngState = 1;        // state of the xorshift random # generator
+
+
+//=====================================================================================================================
+// FUNCTIONS DEFINED IN THIS MODULE
+//=====================================================================================================================
+void usage();
+int nextRandom( int n );
+BOOL writeRecord( FILE* fp, BYTE tag0, BYTE tag1, const int* piData, int nInts, int iFill );
+BOOL writeSyntheticFile( const char* path, int nChans, int nSpikes, int nEdits );
+BOOL loadFile( const char* path, PSPIKETRAIN pTrains, PCXDSPIKEEDIT* ppEdits, int* pnEdits );
+BOOL copyTrains( PSPIKETRAIN pDst, const SPIKETRAIN* pSrc );
+void freeTrains( PSPIKETRAIN pTrains );
+void removeSortedSpike( PSPIKETRAIN pTrains, int ch, int tSpk );
+void addSortedSpike( PSPIKETRAIN pTrains, int ch, int tSpk );
+BOOL applySortedSpikeEdits( PSPIKETRAIN pTrains, PCXDSPIKEEDIT pEdits, int nEdits );
+double getElapsedSecs( const struct timespec* pStart );
+
+
+//=== main ============================================================================================================
+int main( int argc, char* argv[] )
+{
+   int i, opt, nEdits, nSpikes, nChans, nFileEdits, nSpikesBefore, nSpikesAfter, nDiffCh;
+   BOOL bKeep, bOk;
+   double dRefSecs, dMergeSecs;
+   struct timespec tStart;
+   SPIKETRAIN original[NUMSPIKESORTCH];
+   SPIKETRAIN reference[NUMSPIKESORTCH];
+   SPIKETRAIN merged[NUMSPIKESORTCH];
+   PCXDSPIKEEDIT pEdits;
+
+   nEdits = 100000;
+   nSpikes = 50000;
+   nChans = 4;
+   bKeep = FALSE;
+   while( (opt = getopt( argc, argv, "n:s:c:r:k" )) != -1 )
+   {
+      switch( opt )
+      {
+         case 'n' : nEdits = atoi( optarg ); break;
+         case 's' : nSpikes = atoi( optarg ); break;
+         case 'c' : nChans = atoi( optarg ); break;
+         case 'r' : G_rngState = (unsigned int) atoi( optarg ); break;
+         case 'k' : bKeep = TRUE; break;
+         default :  usage(); return( 1 );
+      }
+   }
+   if( optind != argc - 1 || nEdits < 1 || nSpikes < 1 || nChans < 1 || nChans > NUMSPIKESORTCH )
+   {
+      usage();
+      return( 1 );
+   }
+   if( G_rngState == 0 ) G_rngState = 1;
+
+   memset( original, 0, sizeof(original) );
+   memset( reference, 0, sizeof(reference) );
+   memset( merged, 0, sizeof(merged) );
+   pEdits = NULL;
+
+   if( !writeSyntheticFile( argv[optind], nChans, nSpikes, nEdits ) ) return( 1 );
+   bOk = loadFile( argv[optind], original, &pEdits, &nFileEdits );
+   if( !bKeep ) remove( argv[optind] );
+   if( !bOk ) return( 1 );
+   if( !(copyTrains( reference, original ) && copyTrains( merged, original )) )
+   {
+      fprintf( stderr, "ERROR: Out of memory\n" );
+      return( 1 );
+   }
+
+   clock_gettime( CLOCK_MONOTONIC, &tStart );                           // the original one-at-a-time replay
+   for( i = 0; i < nFileEdits; i++ )
+   {
+      if( pEdits[i].bAdd ) addSortedSpike( reference, pEdits[i].ch, pEdits[i].t );
+      else removeSortedSpike( reference, pEdits[i].ch, pEdits[i].t );
+   }
+   dRefSecs = getElapsedSecs( &tStart );
+
+   clock_gettime( CLOCK_MONOTONIC, &tStart );                           // sort-and-merge replay
+   bOk = applySortedSpikeEdits( merged, pEdits, nFileEdits );
+   dMergeSecs = getElapsedSecs( &tStart );
+   if( !bOk )
+   {
+      fprintf( stderr, "ERROR: Out of memory\n" );
+      return( 1 );
+   }
+
+   nSpikesBefore = nSpikesAfter = nDiffCh = 0;                          // compare the edited spike trains
+   for( i = 0; i < NUMSPIKESORTCH; i++ )
+   {
+      nSpikesBefore += original[i].nSpikes;
+      nSpikesAfter += reference[i].nSpikes;
+      if( reference[i].nSpikes != merged[i].nSpikes ||
+          (reference[i].nSpikes > 0 &&
+           memcmp( reference[i].pdSpikes, merged[i].pdSpikes, reference[i].nSpikes * sizeof(double) ) != 0) )
+         ++nDiffCh;
+   }
+
+   printf( "%d spike edits on %d channels; %d spikes before, %d after\n", nFileEdits, nChans, nSpikesBefore,
+           nSpikesAfter );
+   printf( "   one at a time:  %9.3f ms\n", dRefSecs * 1000.0 );
+   printf( "   sort and merge: %9.3f ms  (%.1fx)\n", dMergeSecs * 1000.0,
+           (dMergeSecs > 0.0) ? dRefSecs / dMergeSecs : 0.0 );
+   if( nDiffCh == 0 ) printf( "   edited spike trains are identical\n" );
+   else printf( "   MISMATCH: edited spike trains differ on %d channels!\n", nDiffCh );
+
+   freeTrains( original );
+   freeTrains( reference );
+   freeTrains( merged );
+   free( pEdits );
+   return( (nDiffCh == 0) ? 0 : 1 );
+}
+
+
+//=== usage ===========================================================================================================
+//
+//    Prints spkeditbench usage details to STDERR.
+//
+void usage()
+{
+   fprintf( stderr, "USAGE: spkeditbench [-n nedits] [-s nspikes] [-c nchans] [-r seed] [-k] file\n" );
+   fprintf( stderr, "   -n --> # of sorted-spike train edits (default = 100000)\n" );
+   fprintf( stderr, "   -s --> # of spikes per sorted-spike train before editing (default = 50000)\n" );
+   fprintf( stderr, "   -c --> # of sorted-spike train channels [1..%d] (default = 4)\n", NUMSPIKESORTCH );
+   fprintf( stderr, "   -r --> random # generator seed (default = 1)\n" );
+   fprintf( stderr, "   -k --> keep the synthetic data file\n" );
+}
+
+
+//=== nextRandom ======================================================================================================
+//
+//    A simple xorshift generator -- so the synthetic file depends only on the seed, not on the C library.
+//
+//    ARGS:       n -- [in] range of the random #. Must be positive.
+//
+//    RETURNS:    A pseudo-random integer in [0..n-1].
+//
+int nextRandom( int n )
+{
+   G_rngState ^= G_rngState << 13;
+   G_rngState ^= G_rngState >> 17;
+   G_rngState ^= G_rngState << 5;
+   return( (int) (G_rngState % (unsigned int) n) );
+}
+
+
+//=== writeRecord =====================================================================================================
+//
+//    Write one data record to the synthetic file. Data files are little-endian, so the ints are byte-swapped as
+//    needed.
+//
+//    ARGS:       fp     -- [in] the file, open for writing.
+//                tag0, tag1 -- [in] bytes 0 and 1 of the record tag.
+//                piData -- [in] the record's content, up to CX_RECORDINTS ints.
+//                nInts  -- [in] # of ints in piData.
+//                iFill  -- [in] value written to the remaining ints in the record.
+//
+//    RETURNS:    TRUE if successful, FALSE if the write failed.
+//
+BOOL writeRecord( FILE* fp, BYTE tag0, BYTE tag1, const int* piData, int nInts, int iFill )
+{
+   int i;
+   CXFILEREC rec;
+   BOOL bSwap = cxdIsBigEndianHost();
+
+   memset( &rec, 0, sizeof(CXFILEREC) );
+   rec.idTag[0] = tag0;
+   rec.idTag[1] = tag1;
+   for( i = 0; i < (int) CX_RECORDINTS; i++ )
+   {
+      rec.u.iData[i] = (i < nInts) ? piData[i] : iFill;
+      if( bSwap ) rec.u.iData[i] = cxdSwapInt( rec.u.iData[i] );
+   }
+   return( (BOOL) (fwrite( &rec, sizeof(CXFILEREC), 1, fp ) == 1) );
+}
+
+
+//=== writeSyntheticFile ==============================================================================================
+//
+//    Write the synthetic data file: a header record, then each channel's sorted-spike train records (interspike
+//    intervals in 10us ticks, terminated by EOD_EVENTRECORD), then the action records holding the spike edits as
+//    JMWork writes them -- the # of actions, followed by the codes for each action, with the last record padded with
+//    ACTION_ILLEGAL. Spike intervals are uniform in [1..20]ms. Of the edits, 45% remove a spike from the train as
+//    originally recorded (possibly one already removed), 35% add a spike at a random time, 10% add a spike where one
+//    was originally recorded, and 10% add a spike and then remove it again later in the list.
+//
+//    ARGS:       path    -- [in] pathname of the synthetic file.
+//                nChans  -- [in] # of sorted-spike train channels.
+//                nSpikes -- [in] # of spikes in each train.
+//                nEdits  -- [in] # of spike edits.
+//
+//    RETURNS:    TRUE if successful; FALSE otherwise (an error message is written to STDERR).
+//
+BOOL writeSyntheticFile( const char* path, int nChans, int nSpikes, int nEdits )
+{
+   int i, n, ch, t, nCodes, nPending, tEnd, iRec;
+   int* piISI;
+   int* piTimes;
+   int* piCodes;
+   int* piPending;
+   FILE* fp;
+   CXFILEHDR hdr;
+   BOOL bOk;
+
+   piISI = (int*) malloc( sizeof(int) * nChans * nSpikes );             // each channel's spike times, and the ISIs
+   piTimes = (int*) malloc( sizeof(int) * nChans * nSpikes );           // written to file
+   piCodes = (int*) malloc( sizeof(int) * (1 + 3 * nEdits) );
+   piPending = (int*) malloc( sizeof(int) * 2 * nEdits );               // (ch, t) of added spikes yet to be undone
+   if( piISI == NULL || piTimes == NULL || piCodes == NULL || piPending == NULL )
+   {
+      fprintf( stderr, "ERROR: Out of memory\n" );
+      free( piISI ); free( piTimes ); free( piCodes ); free( piPending );
+      return( FALSE );
+   }
+
+   for( ch = 0; ch < nChans; ch++ )
+   {
+      t = 0;
+      for( i = 0; i < nSpikes; i++ )
+      {
+         piISI[ch*nSpikes + i] = 100 + nextRandom( 1901 );
+         t += piISI[ch*nSpikes + i];
+         piTimes[ch*nSpikes + i] = t;
+      }
+   }
+   tEnd = 2000 * nSpikes;
+
+   piCodes[0] = nEdits;                                                 // the edits. Pending undo's are made at
+   nPending = 0;                                                        // random later points, but all are made
+   for( n = 0; n < nEdits; n++ )                                        // by the end of the list.
+   {
+      piCodes[1 + 3*n] = ACTION_ADDSORTSPK;
+      if( nPending > 0 && (nextRandom( 10 ) == 0 || nEdits - n <= nPending) )
+      {
+         i = nextRandom( nPending );
+         piCodes[1 + 3*n] = ACTION_REMOVESORTSPK;
+         piCodes[2 + 3*n] = piPending[2*i];
+         piCodes[3 + 3*n] = piPending[2*i + 1];
+         --nPending;
+         piPending[2*i] = piPending[2*nPending];
+         piPending[2*i + 1] = piPending[2*nPending + 1];
+         continue;
+      }
+
+      ch = nextRandom( nChans );
+      i = nextRandom( 100 );
+      piCodes[2 + 3*n] = ch;
+      if( i < 45 )
+      {
+         piCodes[1 + 3*n] = ACTION_REMOVESORTSPK;
+         piCodes[3 + 3*n] = piTimes[ch*nSpikes + nextRandom( nSpikes )];
+      }
+      else if( i < 80 ) piCodes[3 + 3*n] = 1 + nextRandom( tEnd );
+      else if( i < 90 ) piCodes[3 + 3*n] = piTimes[ch*nSpikes + nextRandom( nSpikes )];
+      else
+      {
+         piCodes[3 + 3*n] = 1 + nextRandom( tEnd );
+         if( nEdits - n - 1 > nPending )
+         {
+            piPending[2*nPending] = ch;
+            piPending[2*nPending + 1] = piCodes[3 + 3*n];
+            ++nPending;
+         }
+      }
+   }
+   nCodes = 1 + 3 * nEdits;
+
+   fp = fopen( path, "wb" );
+   if( fp == NULL )
+   {
+      fprintf( stderr, "ERROR: Unable to create %s\n", path );
+      free( piISI ); free( piTimes ); free( piCodes ); free( piPending );
+      return( FALSE );
+   }
+
+   memset( &hdr, 0, sizeof(CXFILEHDR) );
+   strcpy( hdr.name, "spkeditbench" );
+   hdr.version = CXH_CURRENTVERSION;
+   if( cxdIsBigEndianHost() ) hdr.version = cxdSwapInt( hdr.version );
+   bOk = (BOOL) (fwrite( &hdr, sizeof(CXFILEHDR), 1, fp ) == 1);
+
+   for( ch = 0; bOk && ch < nChans; ch++ )                              // EOD_EVENTRECORD follows the last ISI, so
+   {                                                                    // the train ends with a partial record
+      for( i = 0; bOk && i <= nSpikes; i += CX_RECORDINTS )
+      {
+         n = nSpikes - i;
+         if( n > (int) CX_RECORDINTS ) n = CX_RECORDINTS;
+         bOk = writeRecord( fp, (BYTE) (CX_SPIKESORTREC_FIRST + ch % 50), (BYTE) (ch / 50), &(piISI[ch*nSpikes + i]),
+                            n, EOD_EVENTRECORD );
+      }
+   }
+
+   for( iRec = 0; bOk && iRec * (int) CX_RECORDINTS < nCodes; iRec++ )
+   {
+      n = nCodes - iRec * CX_RECORDINTS;
+      if( n > (int) CX_RECORDINTS ) n = CX_RECORDINTS;
+      bOk = writeRecord( fp, CX_XWORKACTIONREC, 0, &(piCodes[iRec * CX_RECORDINTS]), n, ACTION_ILLEGAL );
+   }
+
+   if( fclose( fp ) != 0 ) bOk = FALSE;
+   if( !bOk ) fprintf( stderr, "ERROR: Failed writing %s\n", path );
+   free( piISI );
+   free( piTimes );
+   free( piCodes );
+   free( piPending );
+   return( bOk );
+}
+
+
+//=== loadFile ========================================================================================================
+//
+//    Read the sorted-spike trains and the spike edits from a data file, as READCXDATA does: the interspike intervals
+//    in each channel's records are accumulated and converted to ms, and the action list is parsed in order, collecting
+//    the spike edits and skipping over all other actions.
+//
+//    ARGS:       path    -- [in] the data file's pathname.
+//                pTrains -- [out] the spike trains, NUMSPIKESORTCH channels. Must be zeroed on entry.
+//                ppEdits -- [out] the spike edits, in the order listed. Caller must free.
+//                pnEdits -- [out] # of spike edits.
+//
+//    RETURNS:    TRUE if successful; FALSE otherwise (an error message is written to STDERR).
+//
+BOOL loadFile( const char* path, PSPIKETRAIN pTrains, PCXDSPIKEEDIT* ppEdits, int* pnEdits )
+{
+   int i, k, ch, nRecs, nCodes, iISI;
+   int* piCodes;
+   double* pdNewBuf;
+   CXFILEREC* pRec;
+   PSPIKETRAIN pTrain;
+   CXDFILE file;
+   BOOL bSwap = cxdIsBigEndianHost();
+
+   *ppEdits = NULL;
+   *pnEdits = 0;
+   if( !cxdOpen( &file, path ) )
+   {
+      fprintf( stderr, "ERROR: %s: %s\n", path, file.errMsg );
+      return( FALSE );
+   }
+
+   nRecs = cxdGetNumRecordsOfKind( &file, CXD_SORTSPIKE );
+   for( k = 0; k < nRecs; k++ )
+   {
+      pRec = cxdGetRecordOfKind( &file, CXD_SORTSPIKE, k );
+      ch = pRec->idTag[1] * 50 + pRec->idTag[0] - CX_SPIKESORTREC_FIRST;
+      if( ch < 0 || ch >= NUMSPIKESORTCH ) continue;
+      pTrain = &(pTrains[ch]);
+      if( pTrain->nSpikes + (int) CX_RECORDINTS > pTrain->nBufSz )
+      {
+         pdNewBuf = (double*) realloc( pTrain->pdSpikes, sizeof(double) * (pTrain->nBufSz + 2 * CX_RECORDINTS) );
+         if( pdNewBuf == NULL ) break;
+         pTrain->pdSpikes = pdNewBuf;
+         pTrain->nBufSz += 2 * CX_RECORDINTS;
+      }
+      for( i = 0; i < (int) CX_RECORDINTS; i++ )
+      {
+         iISI = bSwap ? cxdSwapInt( pRec->u.iData[i] ) : pRec->u.iData[i];
+         if( iISI == EOD_EVENTRECORD ) break;
+         pTrain->tLast += iISI;
+         pTrain->pdSpikes[pTrain->nSpikes++] = ((double) pTrain->tLast) / 100.0;
+      }
+   }
+
+   nCodes = cxdGetNumRecordsOfKind( &file, CXD_ACTION ) * (int) CX_RECORDINTS;
+   piCodes = (int*) malloc( sizeof(int) * (nCodes + 1) );
+   *ppEdits = (PCXDSPIKEEDIT) malloc( sizeof(CXDSPIKEEDIT) * (nCodes / 3 + 1) );
+   if( k < nRecs || piCodes == NULL || *ppEdits == NULL )
+   {
+      fprintf( stderr, "ERROR: Out of memory\n" );
+      free( piCodes );
+      cxdClose( &file );
+      return( FALSE );
+   }
+   cxdGatherBytes( &file, CXD_ACTION, (char*) piCodes );
+   cxdClose( &file );
+   if( bSwap ) for( i = 0; i < nCodes; i++ ) piCodes[i] = cxdSwapInt( piCodes[i] );
+
+   i = 1;                                                               // parse the action list as processEdits()
+   while( i < nCodes ) switch( piCodes[i] )                             // does, collecting the spike edits
+   {
+      case ACTION_SACCUT:     i += 10; break;
+      case ACTION_RMUNIT:
+      case ACTION_ADDUNIT:
+      case ACTION_SETMARK1:
+      case ACTION_SETMARK2:   i += 2; break;
+      case ACTION_RMALL:
+      case ACTION_EDITEVENT:
+      case ACTION_MARK:       i += 3; break;
+      case ACTION_CUTIT:      i += 5; break;
+      case ACTION_DEFTAG:     i += 6; break;
+      case ACTION_ILLEGAL:
+      case 0 :                i = nCodes; break;
+      case ACTION_REMOVESORTSPK:
+      case ACTION_ADDSORTSPK:
+         if( i + 2 < nCodes )
+         {
+            (*ppEdits)[*pnEdits].ch = piCodes[i+1];
+            (*ppEdits)[*pnEdits].t = piCodes[i+2];
+            (*ppEdits)[*pnEdits].seq = *pnEdits;
+            (*ppEdits)[*pnEdits].bAdd = (BOOL) (piCodes[i] == ACTION_ADDSORTSPK);
+            ++(*pnEdits);
+         }
+         i += 3;
+         break;
+      default :               ++i; break;
+   }
+
+   free( piCodes );
+   return( TRUE );
+}
+
+
+//=== copyTrains, freeTrains ==========================================================================================
+//
+//    Make a deep copy of a set of NUMSPIKESORTCH spike trains, or release one.
+//
+//    RETURNS:    (copyTrains) TRUE if successful; FALSE if out of memory.
+//
+BOOL copyTrains( PSPIKETRAIN pDst, const SPIKETRAIN* pSrc )
+{
+   int i;
+
+   for( i = 0; i < NUMSPIKESORTCH; i++ )
+   {
+      pDst[i] = pSrc[i];
+      if( pSrc[i].nBufSz == 0 ) continue;
+      pDst[i].pdSpikes = (double*) malloc( sizeof(double) * pSrc[i].nBufSz );
+      if( pDst[i].pdSpikes == NULL ) return( FALSE );
+      memcpy( pDst[i].pdSpikes, pSrc[i].pdSpikes, sizeof(double) * pSrc[i].nSpikes );
+   }
+   return( TRUE );
+}
+
+void freeTrains( PSPIKETRAIN pTrains )
+{
+   int i;
+
+   for( i = 0; i < NUMSPIKESORTCH; i++ )
+   {
+      free( pTrains[i].pdSpikes );
+      pTrains[i].pdSpikes = NULL;
+      pTrains[i].nSpikes = pTrains[i].nBufSz = 0;
+   }
+}
+
+
+//=== removeSortedSpike, addSortedSpike ===============================================================================
+//
+//    The reference: READCXDATA's original handling of ACTION_REMOVESORTSPK and ACTION_ADDSORTSPK, one edit at a time.
+//    Each edit searches the spike train for the time of the spike to be removed or added, then shifts all later
+//    spikes back or forward one element. Spike times within 0.001ms of the edit time are considered equal.
+//
+//    ARGS:       pTrains -- [in/out] the spike trains.
+//                ch      -- [in] the channel edited. No action is taken if it is invalid or has no data.
+//                tSpk    -- [in] the time of the spike to be added or removed, in 10us ticks.
+//
+void removeSortedSpike( PSPIKETRAIN pTrains, int ch, int tSpk )
+{
+   int i, iRmv;
+   double tSpkMS, diff;
+   PSPIKETRAIN pTrain;
+
+   if( ch < 0 || ch >= NUMSPIKESORTCH || pTrains[ch].nBufSz == 0 ) return;
+   pTrain = &(pTrains[ch]);
+
+   tSpkMS = ((double) tSpk) / 100.0;
+   iRmv = -1;
+   for( i = 0; i < pTrain->nSpikes; i++ )
+   {
+      diff = tSpkMS - pTrain->pdSpikes[i];
+      if( -0.001 <= diff && diff <= 0.001 )
+      {
+         iRmv = i;
+         break;
+      }
+   }
+   if( iRmv < 0 ) return;
+
+   for( i = iRmv; i < pTrain->nSpikes - 1; i++ ) pTrain->pdSpikes[i] = pTrain->pdSpikes[i+1];
+   --pTrain->nSpikes;
+}
+
+void addSortedSpike( PSPIKETRAIN pTrains, int ch, int tSpk )
+{
+   int i, iAdd;
+   double tSpkMS, diff;
+   double* pdNewBuf;
+   PSPIKETRAIN pTrain;
+
+   if( ch < 0 || ch >= NUMSPIKESORTCH || pTrains[ch].nBufSz == 0 ) return;
+   pTrain = &(pTrains[ch]);
+
+   tSpkMS = ((double) tSpk) / 100.0;
+   iAdd = 0;
+   while( iAdd < pTrain->nSpikes && pTrain->pdSpikes[iAdd] < tSpkMS ) ++iAdd;
+
+   if( iAdd > 0 )
+   {
+      diff = tSpkMS - pTrain->pdSpikes[iAdd-1];
+      if( -0.001 <= diff && diff <= 0.001 ) return;
+   }
+   if( iAdd < pTrain->nSpikes )
+   {
+      diff = tSpkMS - pTrain->pdSpikes[iAdd];
+      if( -0.001 <= diff && diff <= 0.001 ) return;
+   }
+
+   if( pTrain->nSpikes == pTrain->nBufSz )
+   {
+      pdNewBuf = (double*) realloc( pTrain->pdSpikes, sizeof(double) * (100 + pTrain->nBufSz) );
+      if( pdNewBuf == NULL ) return;
+      pTrain->pdSpikes = pdNewBuf;
+      pTrain->nBufSz += 100;
+   }
+   for( i = pTrain->nSpikes; i > iAdd; i-- ) pTrain->pdSpikes[i] = pTrain->pdSpikes[i-1];
+
+   pTrain->pdSpikes[iAdd] = tSpkMS;
+   ++pTrain->nSpikes;
+}
+
+
+//=== applySortedSpikeEdits ===========================================================================================
+//
+//    READCXDATA's current handling of the spike edits: sort them once, then rebuild each edited spike train in a
+//    single merge pass.
+//
+//    ARGS:       pTrains -- [in/out] the spike trains.
+//                pEdits  -- [in/out] the spike edits, in the order listed. Sorted in place.
+//                nEdits  -- [in] # of spike edits.
+//
+//    RETURNS:    TRUE if successful; FALSE if out of memory.
+//
+BOOL applySortedSpikeEdits( PSPIKETRAIN pTrains, PCXDSPIKEEDIT pEdits, int nEdits )
+{
+   int i, j, ch, nAdds;
+   double* pdNewBuf;
+   PSPIKETRAIN pTrain;
+
+   cxdSortSpikeEdits( pEdits, nEdits );
+
+   i = 0;
+   while( i < nEdits )
+   {
+      ch = pEdits[i].ch;
+      nAdds = 0;
+      for( j = i; j < nEdits && pEdits[j].ch == ch; j++ ) if( pEdits[j].bAdd ) ++nAdds;
+
+      if( ch >= 0 && ch < NUMSPIKESORTCH && pTrains[ch].nBufSz > 0 )
+      {
+         pTrain = &(pTrains[ch]);
+         pdNewBuf = (double*) malloc( sizeof(double) * (pTrain->nSpikes + nAdds + 1) );
+         if( pdNewBuf == NULL ) return( FALSE );
+         pTrain->nSpikes = cxdMergeSpikeEdits( pTrain->pdSpikes, pTrain->nSpikes, &(pEdits[i]), j - i, pdNewBuf );
+         free( pTrain->pdSpikes );
+         pTrain->pdSpikes = pdNewBuf;
+         pTrain->nBufSz = pTrain->nSpikes + nAdds + 1;
+      }
+      i = j;
+   }
+   return( TRUE );
+}
+
+
+//=== getElapsedSecs ==================================================================================================
+//
+//    ARGS:       pStart -- [in] start time, from clock_gettime(CLOCK_MONOTONIC).
+//
+//    RETURNS:    Elapsed time since the start time, in seconds.
+//
+double getElapsedSecs( const struct timespec* pStart )
+{
+   struct timespec tNow;
+   clock_gettime( CLOCK_MONOTONIC, &tNow );
+   return( (tNow.tv_sec - pStart->tv_sec) + (tNow.tv_nsec - pStart->tv_nsec) * 1.0e-9 );
+}